@@ -0,0 +1,217 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include <errno.h>
+#include <unistd.h>
+
+#include <poll.h>
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+
+#include <cerver/cerver.h>
+
+// how many wakeups are measured for each connections count
+#define ITERATIONS				10000
+
+static const unsigned int idle_connections[] = { 1000, 10000, 50000 };
+
+// used to represent an idle connection,
+// an eventfd is never readable unless written to
+// so it only costs a single fd
+typedef struct Idle {
+
+	int fd;
+
+} Idle;
+
+// tries to raise the max number of open fds
+// returns the limit we can use
+static rlim_t bench_raise_fds_limit (rlim_t needed) {
+
+	struct rlimit limit = { 0 };
+	if (!getrlimit (RLIMIT_NOFILE, &limit)) {
+		if (limit.rlim_cur < needed) {
+			limit.rlim_cur = (needed < limit.rlim_max) ? needed : limit.rlim_max;
+			(void) setrlimit (RLIMIT_NOFILE, &limit);
+			(void) getrlimit (RLIMIT_NOFILE, &limit);
+		}
+	}
+
+	return limit.rlim_cur;
+
+}
+
+static double bench_elapsed (
+	const struct timeval *start, const struct timeval *end
+) {
+
+	return (double) (end->tv_sec - start->tv_sec) +
+		(end->tv_usec - start->tv_usec) * 1e-6;
+
+}
+
+static void bench_results (
+	const char *name, const unsigned int n_connections, const double elapsed
+) {
+
+	(void) fprintf (
+		stdout,
+		"%-6s | %6u idle | %.2f us / wakeup | %.2f wakeups / sec\n",
+		name, n_connections,
+		(elapsed * 1e6) / ITERATIONS,
+		(double) ITERATIONS / elapsed
+	);
+
+}
+
+// same approach as cerver_poll ()
+// all the slots are passed to poll () and then every idx is checked
+static double bench_poll (
+	Idle *idle, const unsigned int n_idle, int active[2]
+) {
+
+	unsigned int n_fds = n_idle + 1;
+	struct pollfd *fds = (struct pollfd *) calloc (n_fds, sizeof (struct pollfd));
+
+	fds[0].fd = active[1];
+	fds[0].events = POLLIN;
+	for (unsigned int i = 0; i < n_idle; i++) {
+		fds[i + 1].fd = idle[i].fd;
+		fds[i + 1].events = POLLIN;
+	}
+
+	char byte = 0;
+	unsigned int handled = 0;
+
+	struct timeval start = { 0 };
+	struct timeval end = { 0 };
+
+	(void) gettimeofday (&start, NULL);
+
+	for (unsigned int it = 0; it < ITERATIONS; it++) {
+		(void) write (active[0], &byte, 1);
+
+		if (poll (fds, n_fds, -1) > 0) {
+			for (unsigned int idx = 0; idx < n_fds; idx++) {
+				if (fds[idx].revents & POLLIN) {
+					(void) read (fds[idx].fd, &byte, 1);
+					handled++;
+				}
+			}
+		}
+	}
+
+	(void) gettimeofday (&end, NULL);
+
+	free (fds);
+
+	if (handled != ITERATIONS) (void) fprintf (stderr, "poll () missed events!\n");
+
+	return bench_elapsed (&start, &end);
+
+}
+
+// same approach as cerver_epoll ()
+// only the ready fds are returned with their data ptr
+static double bench_epoll (
+	Idle *idle, const unsigned int n_idle, int active[2]
+) {
+
+	int epoll_fd = epoll_create1 (EPOLL_CLOEXEC);
+
+	struct epoll_event event = { 0 };
+	for (unsigned int i = 0; i < n_idle; i++) {
+		event.events = EPOLLIN | EPOLLET;
+		event.data.ptr = &idle[i];
+		(void) epoll_ctl (epoll_fd, EPOLL_CTL_ADD, idle[i].fd, &event);
+	}
+
+	Idle active_idle = { .fd = active[1] };
+	event.events = EPOLLIN | EPOLLET;
+	event.data.ptr = &active_idle;
+	(void) epoll_ctl (epoll_fd, EPOLL_CTL_ADD, active[1], &event);
+
+	struct epoll_event events[CERVER_DEFAULT_EPOLL_MAX_EVENTS];
+
+	char byte = 0;
+	unsigned int handled = 0;
+
+	struct timeval start = { 0 };
+	struct timeval end = { 0 };
+
+	(void) gettimeofday (&start, NULL);
+
+	int n_events = 0;
+	for (unsigned int it = 0; it < ITERATIONS; it++) {
+		(void) write (active[0], &byte, 1);
+
+		n_events = epoll_wait (
+			epoll_fd, events, CERVER_DEFAULT_EPOLL_MAX_EVENTS, -1
+		);
+
+		for (int idx = 0; idx < n_events; idx++) {
+			(void) read (((Idle *) events[idx].data.ptr)->fd, &byte, 1);
+			handled++;
+		}
+	}
+
+	(void) gettimeofday (&end, NULL);
+
+	(void) close (epoll_fd);
+
+	if (handled != ITERATIONS) (void) fprintf (stderr, "epoll () missed events!\n");
+
+	return bench_elapsed (&start, &end);
+
+}
+
+static void bench_run (const unsigned int n_idle) {
+
+	// the idle fds, the active pair, the epoll fd & stdio
+	rlim_t needed = (rlim_t) n_idle + 16;
+	if (bench_raise_fds_limit (needed) < needed) {
+		(void) fprintf (
+			stdout,
+			"skipping %u idle connections - fds limit is too low!\n",
+			n_idle
+		);
+
+		return;
+	}
+
+	Idle *idle = (Idle *) calloc (n_idle, sizeof (Idle));
+	for (unsigned int i = 0; i < n_idle; i++)
+		idle[i].fd = eventfd (0, EFD_NONBLOCK);
+
+	int active[2] = { -1, -1 };
+	(void) socketpair (AF_UNIX, SOCK_STREAM, 0, active);
+
+	bench_results ("poll", n_idle, bench_poll (idle, n_idle, active));
+	bench_results ("epoll", n_idle, bench_epoll (idle, n_idle, active));
+
+	(void) close (active[0]);
+	(void) close (active[1]);
+
+	for (unsigned int i = 0; i < n_idle; i++)
+		(void) close (idle[i].fd);
+
+	free (idle);
+
+}
+
+int main (int argc, char **argv) {
+
+	(void) fprintf (stdout, "Benchmark result:\n");
+
+	for (unsigned int i = 0; i < sizeof (idle_connections) / sizeof (unsigned int); i++)
+		bench_run (idle_connections[i]);
+
+	return 0;
+
+}
@@ -0,0 +1,191 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+
+#include <sys/time.h>
+
+#include <cerver/collections/htab.h>
+
+// the buckets the cerver used to create its sock fd map with
+#define CHAINED_BUCKETS				128
+
+// chaining gets too slow to measure with more keys
+#define CHAINED_MAX_KEYS			100000
+
+// the previous htab layout
+// a fixed number of buckets with a malloc per node
+// and a hash that sums the key bytes
+typedef struct ChainedNode {
+
+	struct ChainedNode *next;
+	int key;
+	void *val;
+
+} ChainedNode;
+
+typedef struct Chained {
+
+	ChainedNode *buckets[CHAINED_BUCKETS];
+
+} Chained;
+
+static size_t chained_hash (const void *key, size_t key_size) {
+
+	size_t sum = 0;
+	const unsigned char *k = (const unsigned char *) key;
+	for (size_t i = 0; i < key_size; i++)
+		sum = (sum + k[i]) % CHAINED_BUCKETS;
+
+	return sum;
+
+}
+
+static void chained_insert (Chained *chained, int key, void *val) {
+
+	ChainedNode *node = (ChainedNode *) malloc (sizeof (ChainedNode));
+	node->key = key;
+	node->val = val;
+
+	size_t idx = chained_hash (&key, sizeof (int));
+	node->next = chained->buckets[idx];
+	chained->buckets[idx] = node;
+
+}
+
+static void *chained_get (Chained *chained, int key) {
+
+	void *val = NULL;
+
+	ChainedNode *node = chained->buckets[chained_hash (&key, sizeof (int))];
+	while (node) {
+		if (node->key == key) {
+			val = node->val;
+			break;
+		}
+
+		node = node->next;
+	}
+
+	return val;
+
+}
+
+static void chained_delete (Chained *chained) {
+
+	ChainedNode *next = NULL;
+	for (unsigned int i = 0; i < CHAINED_BUCKETS; i++) {
+		while (chained->buckets[i]) {
+			next = chained->buckets[i]->next;
+			free (chained->buckets[i]);
+			chained->buckets[i] = next;
+		}
+	}
+
+	free (chained);
+
+}
+
+static double elapsed_secs (
+	const struct timeval *start, const struct timeval *end
+) {
+
+	return (double) (end->tv_sec - start->tv_sec) +
+		(end->tv_usec - start->tv_usec) * 1e-6;
+
+}
+
+static void bench_print (
+	const char *name, const unsigned int n_keys,
+	const double insert, const double lookup
+) {
+
+	(void) fprintf (
+		stdout,
+		"%-8s | %8u keys | insert %7.2f ns/op | lookup %7.2f ns/op\n",
+		name, n_keys,
+		(insert * 1e9) / n_keys, (lookup * 1e9) / n_keys
+	);
+
+}
+
+static void bench_htab (int *keys, const unsigned int n_keys) {
+
+	struct timeval start = { 0 };
+	struct timeval end = { 0 };
+
+	Htab *htab = htab_create (CHAINED_BUCKETS, NULL, NULL);
+
+	(void) gettimeofday (&start, NULL);
+	for (unsigned int i = 0; i < n_keys; i++)
+		(void) htab_insert (htab, &keys[i], sizeof (int), &keys[i], sizeof (int));
+	(void) gettimeofday (&end, NULL);
+
+	const double insert = elapsed_secs (&start, &end);
+
+	unsigned int found = 0;
+	(void) gettimeofday (&start, NULL);
+	for (unsigned int i = 0; i < n_keys; i++)
+		found += (htab_get (htab, &keys[i], sizeof (int)) != NULL);
+	(void) gettimeofday (&end, NULL);
+
+	const double lookup = elapsed_secs (&start, &end);
+
+	if (found != n_keys) (void) fprintf (stderr, "htab only found %u keys!\n", found);
+
+	bench_print ("htab", n_keys, insert, lookup);
+
+	htab_destroy (htab);
+
+}
+
+static void bench_chained (int *keys, const unsigned int n_keys) {
+
+	struct timeval start = { 0 };
+	struct timeval end = { 0 };
+
+	Chained *chained = (Chained *) calloc (1, sizeof (Chained));
+
+	(void) gettimeofday (&start, NULL);
+	for (unsigned int i = 0; i < n_keys; i++)
+		chained_insert (chained, keys[i], &keys[i]);
+	(void) gettimeofday (&end, NULL);
+
+	const double insert = elapsed_secs (&start, &end);
+
+	unsigned int found = 0;
+	(void) gettimeofday (&start, NULL);
+	for (unsigned int i = 0; i < n_keys; i++)
+		found += (chained_get (chained, keys[i]) != NULL);
+	(void) gettimeofday (&end, NULL);
+
+	const double lookup = elapsed_secs (&start, &end);
+
+	if (found != n_keys) (void) fprintf (stderr, "chained only found %u keys!\n", found);
+
+	bench_print ("chained", n_keys, insert, lookup);
+
+	chained_delete (chained);
+
+}
+
+int main (int argc, char **argv) {
+
+	const unsigned int n_keys[3] = { 1000, 100000, 1000000 };
+
+	(void) fprintf (stdout, "Benchmark result (sequential int keys, like sock fds):\n");
+
+	for (unsigned int i = 0; i < 3; i++) {
+		int *keys = (int *) malloc (n_keys[i] * sizeof (int));
+		for (unsigned int k = 0; k < n_keys[i]; k++) keys[k] = (int) k;
+
+		bench_htab (keys, n_keys[i]);
+
+		if (n_keys[i] <= CHAINED_MAX_KEYS) bench_chained (keys, n_keys[i]);
+		else (void) fprintf (stdout, "%-8s | %8u keys | skipped\n", "chained", n_keys[i]);
+
+		free (keys);
+	}
+
+	return 0;
+
+}
@@ -0,0 +1,142 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+
+#include <pthread.h>
+#include <sched.h>
+
+#include <sys/time.h>
+
+#include <cerver/threads/jobs.h>
+
+#define CONSUMERS				4
+
+// jobs pushed by every producer
+#define JOBS					200000
+
+typedef struct Producer {
+
+	JobQueue *job_queue;
+	Job *jobs;
+
+} Producer;
+
+static unsigned long consumed = 0;
+static unsigned int consumers_alive = 0;
+
+static void *producer_thread (void *producer_ptr) {
+
+	Producer *producer = (Producer *) producer_ptr;
+
+	for (unsigned int i = 0; i < JOBS; i++) {
+		// a full ring makes the producer wait for the consumers
+		while (job_queue_push (producer->job_queue, &producer->jobs[i]))
+			(void) sched_yield ();
+	}
+
+	return NULL;
+
+}
+
+static void *consumer_thread (void *job_queue_ptr) {
+
+	JobQueue *job_queue = (JobQueue *) job_queue_ptr;
+
+	while (job_queue->running) {
+		job_queue_wait (job_queue);
+
+		while (job_queue_pull (job_queue))
+			(void) __atomic_add_fetch (&consumed, 1, __ATOMIC_RELAXED);
+	}
+
+	(void) __atomic_sub_fetch (&consumers_alive, 1, __ATOMIC_RELAXED);
+
+	return NULL;
+
+}
+
+static void bench (
+	const char *name, const JobQueueType type, const unsigned int n_producers
+) {
+
+	JobQueue *job_queue = job_queue_create (type);
+	job_queue->running = true;
+
+	consumed = 0;
+	consumers_alive = CONSUMERS;
+
+	Producer *producers = (Producer *) calloc (n_producers, sizeof (Producer));
+	for (unsigned int i = 0; i < n_producers; i++) {
+		producers[i].job_queue = job_queue;
+		producers[i].jobs = (Job *) calloc (JOBS, sizeof (Job));
+	}
+
+	pthread_t consumers_ids[CONSUMERS] = { 0 };
+	pthread_t *producers_ids = (pthread_t *) calloc (n_producers, sizeof (pthread_t));
+
+	struct timeval start = { 0 };
+	struct timeval end = { 0 };
+
+	(void) gettimeofday (&start, NULL);
+
+	for (unsigned int i = 0; i < CONSUMERS; i++)
+		(void) pthread_create (&consumers_ids[i], NULL, consumer_thread, job_queue);
+
+	for (unsigned int i = 0; i < n_producers; i++)
+		(void) pthread_create (&producers_ids[i], NULL, producer_thread, &producers[i]);
+
+	for (unsigned int i = 0; i < n_producers; i++)
+		(void) pthread_join (producers_ids[i], NULL);
+
+	const unsigned long total = (unsigned long) n_producers * JOBS;
+	while (__atomic_load_n (&consumed, __ATOMIC_RELAXED) < total)
+		(void) sched_yield ();
+
+	(void) gettimeofday (&end, NULL);
+
+	// a jobs queue bsem only lets one consumer through every post
+	job_queue->running = false;
+	while (__atomic_load_n (&consumers_alive, __ATOMIC_RELAXED)) {
+		job_queue_signal_all (job_queue);
+		(void) sched_yield ();
+	}
+
+	for (unsigned int i = 0; i < CONSUMERS; i++)
+		(void) pthread_join (consumers_ids[i], NULL);
+
+	double elapsed = (double) (end.tv_sec - start.tv_sec) +
+		(end.tv_usec - start.tv_usec) * 1e-6;
+
+	(void) fprintf (
+		stdout,
+		"%-5s | %2u producers | %.2f jobs/sec | %.2f s\n",
+		name, n_producers, (double) total / elapsed, elapsed
+	);
+
+	job_queue_delete (job_queue);
+
+	for (unsigned int i = 0; i < n_producers; i++)
+		free (producers[i].jobs);
+
+	free (producers);
+	free (producers_ids);
+
+}
+
+int main (int argc, char **argv) {
+
+	const unsigned int n_producers[3] = { 1, 4, 16 };
+
+	(void) fprintf (
+		stdout, "Benchmark result (%u consumers, %u jobs per producer):\n",
+		CONSUMERS, JOBS
+	);
+
+	for (unsigned int i = 0; i < 3; i++) {
+		bench ("jobs", JOB_QUEUE_TYPE_JOBS, n_producers[i]);
+		bench ("ring", JOB_QUEUE_TYPE_RING, n_producers[i]);
+	}
+
+	return 0;
+
+}
@@ -0,0 +1,230 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include <pthread.h>
+#include <unistd.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+
+#include <sys/socket.h>
+#include <sys/time.h>
+
+#include <cerver/cerver.h>
+#include <cerver/packets.h>
+
+#define APP_REQUEST_MESSAGE		10
+
+// datagrams sent before waiting for their echoes
+#define WINDOW					CERVER_DEFAULT_UDP_BATCH_SIZE
+
+#define ITERATIONS				20000
+
+static const char *MESSAGE = {
+	"Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod tempor "
+	"incididunt ut labore et dolore magna aliqua. Ut enim ad minim veniam, quis nostrud "
+	"exercitation ullamco laboris nisi ut aliquip ex ea commodo consequat."
+};
+
+typedef struct Echo {
+
+	int sock;
+	bool batch;
+
+} Echo;
+
+// one recvfrom () & one sendto () for every datagram
+static void echo_single (int sock) {
+
+	char buffer[CERVER_DEFAULT_RECEIVE_BUFFER_SIZE];
+	struct sockaddr_storage address = { 0 };
+	socklen_t address_len = 0;
+
+	ssize_t received = 0;
+	do {
+		address_len = sizeof (struct sockaddr_storage);
+		received = recvfrom (
+			sock, buffer, sizeof (buffer), 0,
+			(struct sockaddr *) &address, &address_len
+		);
+
+		if (received > 0) {
+			(void) sendto (
+				sock, buffer, (size_t) received, 0,
+				(const struct sockaddr *) &address, address_len
+			);
+		}
+	} while (received > 0);
+
+}
+
+// same approach as cerver_udp ()
+// a whole batch is received with recvmmsg () & echoed with sendmmsg ()
+static void echo_batch (int sock) {
+
+	char *buffers = (char *) calloc (WINDOW, CERVER_DEFAULT_RECEIVE_BUFFER_SIZE);
+	struct iovec iovecs[WINDOW];
+	struct sockaddr_storage addresses[WINDOW];
+	struct mmsghdr msgs[WINDOW];
+
+	(void) memset (msgs, 0, sizeof (msgs));
+	for (unsigned int i = 0; i < WINDOW; i++) {
+		iovecs[i].iov_base = buffers + (i * CERVER_DEFAULT_RECEIVE_BUFFER_SIZE);
+		msgs[i].msg_hdr.msg_name = &addresses[i];
+		msgs[i].msg_hdr.msg_iov = &iovecs[i];
+		msgs[i].msg_hdr.msg_iovlen = 1;
+	}
+
+	bool running = true;
+	int n_msgs = 0;
+	while (running) {
+		for (unsigned int i = 0; i < WINDOW; i++) {
+			iovecs[i].iov_len = CERVER_DEFAULT_RECEIVE_BUFFER_SIZE;
+			msgs[i].msg_hdr.msg_namelen = sizeof (struct sockaddr_storage);
+		}
+
+		n_msgs = recvmmsg (sock, msgs, WINDOW, MSG_WAITFORONE, NULL);
+		if (n_msgs <= 0) break;
+
+		for (int i = 0; i < n_msgs; i++) {
+			// an empty datagram stops the echo
+			if (!msgs[i].msg_len) {
+				n_msgs = i;
+				running = false;
+				break;
+			}
+
+			iovecs[i].iov_len = msgs[i].msg_len;
+		}
+
+		if (n_msgs > 0) (void) sendmmsg (sock, msgs, (unsigned int) n_msgs, 0);
+	}
+
+	free (buffers);
+
+}
+
+static void *echo_thread (void *echo_ptr) {
+
+	Echo *echo = (Echo *) echo_ptr;
+
+	if (echo->batch) echo_batch (echo->sock);
+	else echo_single (echo->sock);
+
+	return NULL;
+
+}
+
+static int bench_socket (struct sockaddr_in *address) {
+
+	int sock = socket (AF_INET, SOCK_DGRAM, 0);
+
+	address->sin_family = AF_INET;
+	address->sin_addr.s_addr = htonl (INADDR_LOOPBACK);
+	address->sin_port = 0;
+
+	socklen_t len = sizeof (struct sockaddr_in);
+	(void) bind (sock, (const struct sockaddr *) address, len);
+	(void) getsockname (sock, (struct sockaddr *) address, &len);
+
+	return sock;
+
+}
+
+static void bench (const char *name, bool batch, const Packet *packet) {
+
+	struct sockaddr_in server_address = { 0 };
+	struct sockaddr_in client_address = { 0 };
+
+	Echo echo = { .sock = bench_socket (&server_address), .batch = batch };
+	int sock = bench_socket (&client_address);
+
+	(void) connect (
+		sock, (const struct sockaddr *) &server_address, sizeof (struct sockaddr_in)
+	);
+
+	// lost datagrams must not block the benchmark
+	struct timeval timeout = { .tv_sec = 0, .tv_usec = 100000 };
+	(void) setsockopt (sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof (struct timeval));
+
+	pthread_t thread_id = 0;
+	(void) pthread_create (&thread_id, NULL, echo_thread, &echo);
+
+	struct iovec iov = { .iov_base = packet->packet, .iov_len = packet->packet_size };
+	struct mmsghdr msgs[WINDOW];
+	(void) memset (msgs, 0, sizeof (msgs));
+	for (unsigned int i = 0; i < WINDOW; i++) {
+		msgs[i].msg_hdr.msg_iov = &iov;
+		msgs[i].msg_hdr.msg_iovlen = 1;
+	}
+
+	char buffer[CERVER_DEFAULT_RECEIVE_BUFFER_SIZE];
+	u64 echoed = 0;
+	u64 lost = 0;
+
+	struct timeval start = { 0 };
+	struct timeval end = { 0 };
+
+	(void) gettimeofday (&start, NULL);
+
+	for (unsigned int it = 0; it < ITERATIONS; it++) {
+		(void) sendmmsg (sock, msgs, WINDOW, 0);
+
+		for (unsigned int i = 0; i < WINDOW; i++) {
+			if (recv (sock, buffer, sizeof (buffer), 0) > 0) echoed++;
+			else {
+				lost += WINDOW - i;
+				break;
+			}
+		}
+	}
+
+	(void) gettimeofday (&end, NULL);
+
+	// stop the echo thread
+	(void) send (sock, buffer, 0, 0);
+	(void) pthread_join (thread_id, NULL);
+
+	(void) close (sock);
+	(void) close (echo.sock);
+
+	double elapsed = (double) (end.tv_sec - start.tv_sec) +
+		(end.tv_usec - start.tv_usec) * 1e-6;
+
+	double total = (double) echoed * packet->packet_size;
+
+	(void) fprintf (
+		stdout,
+		"%-6s | %.2f mb | %.2f mb/s | %.2f req/sec | %lu lost | %.2f s\n",
+		name,
+		total / (1024 * 1024),
+		(total / elapsed) / (1024 * 1024),
+		(double) echoed / elapsed,
+		lost,
+		elapsed
+	);
+
+}
+
+int main (int argc, char **argv) {
+
+	Packet *packet = packet_generate_request (
+		PACKET_TYPE_APP, APP_REQUEST_MESSAGE,
+		MESSAGE, strlen (MESSAGE)
+	);
+
+	(void) fprintf (
+		stdout, "Benchmark result (%u datagrams windows):\n", WINDOW
+	);
+
+	bench ("single", false, packet);
+
+	bench ("batch", true, packet);
+
+	packet_delete (packet);
+
+	return 0;
+
+}
@@ -15,6 +15,9 @@
 #include "cerver/config.h"
 #include "cerver/handler.h"
 #include "cerver/packets.h"
+#include "cerver/poll.h"
+
+#include "cerver/threads/wheel.h"
 
 #define ADMIN_CERVER_DEFAULT_MAX_ADMINS					1
 #define ADMIN_CERVER_DEFAULT_MAX_ADMIN_CONNECTIONS		2
@@ -134,7 +137,12 @@ CERVER_PUBLIC void admin_set_data (
 	Admin *admin, void *data, Action delete_data
 );
 
-// gets an admin by a matching connection in its client with the specified sock fd
+// gets the admin whose client is the one that was provided
+CERVER_PUBLIC Admin *admin_get_by_client (
+	struct _AdminCerver *admin_cerver, const struct _Client *client
+);
+
+// gets an admin by the client that is mapped to the sock fd in the cerver's fd table
 CERVER_PUBLIC Admin *admin_get_by_sock_fd (
 	struct _AdminCerver *admin_cerver, const i32 sock_fd
 );
@@ -193,7 +201,8 @@ struct _AdminCerver {
 
 	struct pollfd *fds;
 	u32 max_n_fds;                      // current max n fds in pollfd
-	u16 current_n_fds;                  // n of active fds in the pollfd array
+	u32 current_n_fds;                  // n of active fds in the pollfd array
+	PollFdsMap *fds_map;                // maps sock fds to their idx in the pollfd array
 	u32 poll_timeout;
 	pthread_mutex_t *poll_lock;
 
@@ -213,13 +222,13 @@ struct _AdminCerver {
 
 	bool check_packets;                     // enable / disbale packet checking
 
-	pthread_t update_thread_id;
+	WheelTimer *update_timer;
 	Action update;                          // method to be executed every tick
 	void *update_args;                      // args to pass to custom update method
 	void (*delete_update_args)(void *);     // method to delete update args at cerver teardown
 	u8 update_ticks;                        // like fps
 
-	pthread_t update_interval_thread_id;
+	WheelTimer *update_interval_timer;
 	Action update_interval;                 // the actual method to execute every x seconds
 	void *update_interval_args;             // args to pass to the update method
 	// method to delete update interval args at cerver teardown
@@ -329,7 +338,7 @@ CERVER_EXPORT void admin_cerver_set_check_packets (
 );
 
 // sets a custom update function to be executed every n ticks
-// a new thread will be created that will call your method each tick
+// a timer in the cerver's timers thread will call your method each tick
 // the update args will be passed to your method as a CerverUpdate &
 // will only be deleted at cerver teardown if you set the delete_update_args ()
 CERVER_EXPORT void admin_cerver_set_update (
@@ -339,7 +348,7 @@ CERVER_EXPORT void admin_cerver_set_update (
 );
 
 // sets a custom update method to be executed every x seconds (in intervals)
-// a new thread will be created that will call your method every x seconds
+// a timer in the cerver's timers thread will call your method every x seconds
 // the update args will be passed to your method as a CerverUpdate &
 // will only be deleted at cerver teardown if you set the delete_update_args ()
 CERVER_EXPORT void admin_cerver_set_update_interval (
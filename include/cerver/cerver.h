@@ -9,6 +9,7 @@
 #include "cerver/types/string.h"
 
 #include "cerver/collections/avl.h"
+#include "cerver/collections/dlist.h"
 #include "cerver/collections/htab.h"
 #include "cerver/collections/pool.h"
 
@@ -16,11 +17,17 @@
 #include "cerver/config.h"
 #include "cerver/events.h"
 #include "cerver/errors.h"
+#include "cerver/fdtable.h"
 #include "cerver/handler.h"
 #include "cerver/network.h"
 #include "cerver/packets.h"
+#include "cerver/poll.h"
+#include "cerver/registry.h"
+#include "cerver/send.h"
 
 #include "cerver/threads/thpool.h"
+#include "cerver/threads/thread.h"
+#include "cerver/threads/wheel.h"
 
 #include "cerver/game/game.h"
 
@@ -32,7 +39,12 @@
 #define CERVER_DEFAULT_CONNECTION_QUEUE				10
 
 #define CERVER_DEFAULT_RECEIVE_BUFFER_SIZE			4096
+#define CERVER_DEFAULT_RECEIVE_BUDGET_BYTES			65536
+#define CERVER_DEFAULT_RECEIVE_BUDGET_PACKETS		256
 #define CERVER_DEFAULT_MAX_RECEIVED_PACKET_SIZE		MAX_UDP_PACKET_SIZE
+#define CERVER_DEFAULT_ZERO_COPY_PACKETS			false
+
+#define CERVER_DEFAULT_CONNECTIONS_SEND_QUEUE		false
 
 #define CERVER_DEFAULT_REUSABLE_FLAGS				false
 
@@ -41,8 +53,17 @@
 #define CERVER_DEFAULT_SOCKETS_INIT					10
 
 #define CERVER_DEFAULT_POLL_FDS						128
+#define CERVER_DEFAULT_POLL_PENDING_FDS				16
 #define CERVER_DEFAULT_POLL_TIMEOUT					2000
 
+#define CERVER_DEFAULT_EPOLL_MAX_EVENTS				256
+
+#define CERVER_DEFAULT_REACTOR_THREADS				0
+
+#define CERVER_DEFAULT_UDP_BATCH_SIZE				32
+#define CERVER_DEFAULT_UDP_PEER_TIMEOUT				60
+#define CERVER_DEFAULT_UDP_MAX_PEERS				4096
+
 #define CERVER_DEFAULT_MAX_INACTIVE_TIME			60
 #define CERVER_DEFAULT_CHECK_INACTIVE_INTERVAL		30
 
@@ -58,6 +79,7 @@
 #define CERVER_DEFAULT_USE_SESSIONS					false
 
 #define CERVER_DEFAULT_MULTIPLE_HANDLERS			false
+#define CERVER_DEFAULT_HANDLER_DISPATCH				CERVER_HANDLER_DISPATCH_ID
 
 #define CERVER_DEFAULT_CHECK_PACKETS				false
 
@@ -72,6 +94,9 @@ struct _Cerver;
 struct _AdminCerver;
 struct _Client;
 struct _Connection;
+struct _CerverReactor;
+struct _CerverUdp;
+struct _CerverUring;
 struct _Packet;
 struct _PacketsPerType;
 struct _Handler;
@@ -110,7 +135,10 @@ CERVER_EXPORT const char *cerver_type_to_string (CerverType type);
 #define CERVER_HANDLER_TYPE_MAP(XX)																\
 	XX(0,	NONE, 		None, 		None)														\
 	XX(1,	POLL, 		Poll, 		Handle connections using a single thread & poll ())			\
-	XX(2,	THREADS, 	Threads, 	Handle each new connection in a dedicated thread)
+	XX(2,	THREADS, 	Threads, 	Handle each new connection in a dedicated thread)			\
+	XX(3,	EPOLL, 		Epoll, 		Handle connections using a single thread & epoll ())		\
+	XX(4,	REACTORS, 	Reactors, 	Handle connections using multiple threads & epoll ())		\
+	XX(5,	IO_URING, 	IO-Uring, 	Handle connections using a single thread & io_uring)
 
 typedef enum CerverHandlerType {
 
@@ -128,6 +156,28 @@ CERVER_EXPORT const char *cerver_handler_type_description (
 	CerverHandlerType type
 );
 
+// how packets are routed between multiple app handlers
+#define CERVER_HANDLER_DISPATCH_MAP(XX)																	\
+	XX(0,	ID, 			Id, 			Select the handler using the packet handler id)				\
+	XX(1,	CONNECTION, 	Connection, 	Hash the packet connection onto a handler)					\
+	XX(2,	CLIENT, 		Client, 		Hash the packet client onto a handler)
+
+typedef enum CerverHandlerDispatch {
+
+	#define XX(num, name, string, description) CERVER_HANDLER_DISPATCH_##name = num,
+	CERVER_HANDLER_DISPATCH_MAP (XX)
+	#undef XX
+
+} CerverHandlerDispatch;
+
+CERVER_EXPORT const char *cerver_handler_dispatch_to_string (
+	CerverHandlerDispatch dispatch
+);
+
+CERVER_EXPORT const char *cerver_handler_dispatch_description (
+	CerverHandlerDispatch dispatch
+);
+
 #pragma endregion
 
 #pragma region info
@@ -178,10 +228,47 @@ CERVER_PUBLIC u8 cerver_info_send_info_packet (
 
 #pragma region stats
 
+#define CERVER_STATS_SHARDS						16
+#define CERVER_STATS_CACHE_LINE					64
+
+// the counters that get updated in every receive & send
+// each thread updates the shard it was assigned to the first time
+// it updated any cerver stats, so concurrent receives & sends
+// don't keep invalidating each other's cache lines
+typedef struct CerverStatsShard {
+
+	u64 client_n_packets_received;
+	u64 client_receives_done;
+	u64 client_bytes_received;
+
+	u64 on_hold_n_packets_received;
+	u64 on_hold_receives_done;
+	u64 on_hold_bytes_received;
+
+	u64 total_n_packets_received;
+	u64 total_n_receives_done;
+	u64 total_bytes_received;
+	u64 receive_contexts_allocated;
+
+	u64 receive_wakeups;
+	u64 receive_wakeups_bytes;
+	u64 receive_budget_exhausted;
+
+	u64 n_packets_sent;
+	u64 total_bytes_sent;
+
+	PacketsPerType received_packets;
+	PacketsPerType sent_packets;
+
+} CERVER_ATTRS ((aligned (CERVER_STATS_CACHE_LINE))) CerverStatsShard;
+
 typedef struct CerverStats {
 
 	time_t threshold_time;                          // every time we want to reset cerver stats (like packets), defaults 24hrs
 
+	// receive & send values are only updated in the stats shards
+	// use cerver_stats_snapshot () to get their current values
+
 	u64 client_n_packets_received;                  // packets received from clients
 	u64 client_receives_done;                       // receives done to clients
 	u64 client_bytes_received;                      // bytes received from clients
@@ -193,10 +280,18 @@ typedef struct CerverStats {
 	u64 total_n_packets_received;                   // total number of cerver packets received (packet header + data)
 	u64 total_n_receives_done;                      // total amount of actual calls to recv ()
 	u64 total_bytes_received;                       // total amount of bytes received in the cerver
+	u64 receive_contexts_allocated;                 // receive contexts that had to be allocated (not reused by the cerver's loops)
+
+	u64 receive_wakeups;                            // times a connection was read after getting an event from it
+	u64 receive_wakeups_bytes;                      // bytes read in those wakeups, used to get the average per wakeup
+	u64 receive_budget_exhausted;                   // times a connection stopped being read because of the receive budget
 
 	u64 n_packets_sent;                             // total number of packets that were sent
 	u64 total_bytes_sent;                           // total amount of bytes sent by the cerver
 
+	PacketsPerType received_packets;
+	PacketsPerType sent_packets;
+
 	u64 current_active_client_connections;          // all of the current active connections for all current clients (active in main poll array)
 	u64 current_n_connected_clients;                // the current number of clients connected
 	u64 current_n_hold_connections;                 // current numbers of on hold connections (only if the cerver requires authentication)
@@ -204,9 +299,13 @@ typedef struct CerverStats {
 	u64 total_n_clients;                            // the total amount of clients that were registered to the cerver (no auth required)
 	u64 unique_clients;                             // n unique clients connected in a threshold time (check used authentication)
 	u64 total_client_connections;                   // the total amount of client connections that have been done to the cerver
+	u64 inactive_clients_dropped;                   // clients that were dropped for being inactive more than max_inactive_time
+
+	// the packets pool is shared by every cerver in the program
+	// these values get updated every time a stats snapshot is taken
+	PacketsPoolStats packets_pool;
 
-	struct _PacketsPerType *received_packets;
-	struct _PacketsPerType *sent_packets;
+	CerverStatsShard *shards;
 
 } CerverStats;
 
@@ -215,6 +314,17 @@ CERVER_EXPORT void cerver_stats_set_threshold_time (
 	struct _Cerver *cerver, time_t threshold_time
 );
 
+// returns the stats shard assigned to the calling thread
+CERVER_PRIVATE CerverStatsShard *cerver_stats_shard (
+	struct _Cerver *cerver
+);
+
+// aggregates every stats shard & copies the cerver stats into snapshot
+// the snapshot does not reference any of the cerver's data
+CERVER_EXPORT void cerver_stats_snapshot (
+	struct _Cerver *cerver, CerverStats *snapshot
+);
+
 // prints the cerver stats
 CERVER_EXPORT void cerver_stats_print (
 	struct _Cerver *cerver, bool received, bool sent
@@ -222,6 +332,30 @@ CERVER_EXPORT void cerver_stats_print (
 
 #pragma endregion
 
+#pragma region inactive
+
+#define CERVER_INACTIVE_MAX_SLOTS					4096
+
+// a hashed timing wheel with a slot for every second
+// clients are placed in the slot of the second in which they will
+// become inactive & are only moved when their slot is checked
+// if they have been active since they were placed
+struct _CerverInactive {
+
+	unsigned int n_slots;               // power of 2 that covers max_inactive_time
+	struct _Client **slots;
+
+	time_t current;                     // the last second that has been checked
+	unsigned int n_clients;
+
+	pthread_mutex_t *lock;
+
+};
+
+typedef struct _CerverInactive CerverInactive;
+
+#pragma endregion
+
 #pragma region main
 
 // this is the generic cerver struct, used to create different server types
@@ -250,11 +384,16 @@ struct _Cerver {
 	// 29/05/2020
 	// using this pool to avoid completely destroying connection's sockets
 	// as another thread might be blocked by the socket's mutex
+	// the oldest socket is reused first, so a dropped socket waits
+	// for all the other ones before it is used by a new connection
 	unsigned int sockets_pool_init;
-	Pool *sockets_pool;
+	DoubleList *sockets_pool;               // multiple reactors can push & pop at the same time
 
-	AVLTree *clients;                   // connected clients
-	Htab *client_sock_fd_map;           // direct indexing by sokcet fd as key
+	ClientRegistry *clients;            // connected clients by id & session id
+
+	// maps every sock fd to its client & connection
+	// used by the main, on hold & admin connections
+	FdTable *fd_table;
 
 	// 17/06/2020 - ability to check for inactive clients
 	// clients that have not been sent or received from a packet in x time
@@ -262,7 +401,8 @@ struct _Cerver {
 	bool inactive_clients;              // enable / disable checking
 	u32 max_inactive_time;              // max secs allowed for a client to be inactive
 	u32 check_inactive_interval;        // how often to check for inactive clients
-	pthread_t inactive_thread_id;
+	WheelTimer *inactive_timer;
+	struct _CerverInactive *inactive;   // clients placed by the second they become inactive
 
 	CerverHandlerType handler_type;
 
@@ -274,10 +414,43 @@ struct _Cerver {
 
 	struct pollfd *fds;
 	u32 max_n_fds;                      // current max n fds in pollfd
-	u16 current_n_fds;                  // n of active fds in the pollfd array
+	u32 current_n_fds;                  // n of active fds in the pollfd array
+	PollFdsMap *fds_map;                // maps sock fds to their idx in the pollfd array
 	u32 poll_timeout;
 	pthread_mutex_t *poll_lock;
 
+	// only the poll thread can grow the pollfd array, as poll () might be using it
+	// so sock fds registered while it is full wait here until it does
+	i32 *pending_fds;
+	u32 n_pending_fds;
+	u32 max_pending_fds;
+
+	// used when handler type is CERVER_HANDLER_TYPE_EPOLL
+	// each registered connection is stored as its event data
+	// so we never need to scan for the ready fds
+	int epoll_fd;
+
+	// used when handler type is CERVER_HANDLER_TYPE_REACTORS
+	// each reactor runs its own epoll () loop in a dedicated thread
+	// if n_reactors is 0, one reactor per online cpu will be used
+	unsigned int n_reactors;
+	struct _CerverReactor **reactors;
+	unsigned int next_reactor;          // the reactor that will get the next connection
+
+	// used when handler type is CERVER_HANDLER_TYPE_IO_URING
+	// only available if the library was built with IO_URING=1
+	// otherwise, the cerver will use CERVER_HANDLER_TYPE_EPOLL
+	struct _CerverUring *uring;
+
+	// used when protocol is PROTOCOL_UDP
+	// datagrams are received & sent in batches of udp_batch_size
+	// peers that have been idle for udp_peer_timeout secs are removed
+	// datagrams from new peers are ignored after reaching udp_max_peers
+	struct _CerverUdp *udp;
+	u32 udp_batch_size;
+	u32 udp_peer_timeout;
+	u32 udp_max_peers;
+
 	/*** auth ***/
 	bool auth_required;                 // does the server requires authentication?
 	struct _Packet *auth_packet;        // requests client authentication
@@ -285,11 +458,11 @@ struct _Cerver {
 	delegate authenticate;              // authentication function
 
 	AVLTree *on_hold_connections;       // hold on the connections until they authenticate
-	Htab *on_hold_connection_sock_fd_map;
 	struct pollfd *hold_fds;
 	u32 on_hold_poll_timeout;
 	u32 max_on_hold_connections;
-	u16 current_on_hold_nfds;
+	u32 current_on_hold_nfds;
+	PollFdsMap *hold_fds_map;
 	pthread_t on_hold_poll_thread_id;
 	pthread_mutex_t *on_hold_poll_lock;
 	u8 on_hold_max_bad_packets;
@@ -308,6 +481,22 @@ struct _Cerver {
 	u32 receive_buffer_size;
 	size_t max_received_packet_size;
 
+	// how much to read from a client connection every time
+	// the cerver gets an event from it, so that a flooding
+	// connection can't starve the others, 0 for no limit
+	size_t receive_budget_bytes;
+	u32 receive_budget_packets;
+
+	// complete packets inside the receive buffer are handled
+	// using a reference to it instead of copying their data
+	bool zero_copy_packets;
+
+	// client connections append the packets they send into a queue
+	// that is flushed when their socket is writable
+	bool connections_send_queue;
+	size_t connections_send_queue_high_water;
+	SendQueueOverflow connections_send_queue_overflow;
+
 	// 27/05/2020 - changed form Action to Handler
 	// custom packet hanlders
 	struct _Handler *app_packet_handler;
@@ -323,6 +512,7 @@ struct _Cerver {
 	// DoubleList *handlers;
 	struct _Handler **handlers;
 	unsigned int n_handlers;
+	CerverHandlerDispatch handler_dispatch;
 	unsigned int num_handlers_alive;       // handlers currently alive
 	unsigned int num_handlers_working;     // handlers currently working
 	pthread_mutex_t *handlers_lock;
@@ -331,13 +521,23 @@ struct _Cerver {
 
 	bool check_packets;                     // enable / disbale packet checking
 
-	pthread_t update_thread_id;
+	// where the cerver's internal threads run
+	// every thread gets the next cpu with spread & compact
+	ThreadAffinity affinity;
+	unsigned int affinity_threads;          // threads that have been placed
+
+	// executes the update, update interval & inactive checks
+	// timers of the cerver & its admin cerver
+	// in the poll & epoll loops or in its own thread
+	TimerWheel *timers;
+
+	WheelTimer *update_timer;
 	Action update;                          // method to be executed every tick
 	void *update_args;                      // args to pass to custom update method
 	void (*delete_update_args)(void *);     // method to delete update args at cerver teardown
 	u8 update_ticks;                        // like fps
 
-	pthread_t update_interval_thread_id;
+	WheelTimer *update_interval_timer;
 	Action update_interval;                 // the actual method to execute every x seconds
 	void *update_interval_args;             // args to pass to the update method
 	// method to delete update interval args at cerver teardown
@@ -378,6 +578,17 @@ CERVER_EXPORT void cerver_set_receive_buffer_size (
 	Cerver *cerver, const u32 size
 );
 
+// sets how much the cerver will read from a client connection
+// every time it gets an event from it before moving to the next one
+// client connections are read until there is no more data
+// or max_bytes have been read or max_packets have been handled
+// use 0 to not limit bytes or packets
+// the default values are CERVER_DEFAULT_RECEIVE_BUDGET_BYTES
+// and CERVER_DEFAULT_RECEIVE_BUDGET_PACKETS
+CERVER_EXPORT void cerver_set_receive_budget (
+	Cerver *cerver, const size_t max_bytes, const u32 max_packets
+);
+
 // sets the cerver's ability to use reusable flags in sock fd
 // if TRUE, this can prevent failing when trying to bind address
 // the default value is CERVER_DEFAULT_REUSABLE_FLAGS
@@ -419,10 +630,46 @@ CERVER_EXPORT void cerver_set_inactive_clients (
 // sets the cerver handler type
 // the default type is to handle connections using the poll () which requires only one thread
 // if threads type is selected, a new thread will be created for each new connection
+// if epoll type is selected, a single thread will handle only the connections that are ready
+// if reactors type is selected, connections will be split between multiple epoll () threads
+// if io_uring type is selected, a single thread will handle the completions of
+// every accept, receive & send, or epoll type will be used if io_uring is NOT available
 CERVER_EXPORT void cerver_set_handler_type (
 	Cerver *cerver, CerverHandlerType handler_type
 );
 
+// sets the number of reactors threads to use if cerver handler type is CERVER_HANDLER_TYPE_REACTORS
+// each reactor has its own epoll instance, packet buffer & stats
+// 0 to use one reactor per online cpu (default)
+// returns 0 on success, 1 on error
+CERVER_EXPORT u8 cerver_set_reactor_threads (
+	Cerver *cerver, unsigned int n_reactors
+);
+
+// sets the cpu in which the reactor with the matching idx will run
+// must be called after cerver_set_reactor_threads () & before the cerver starts
+// returns 0 on success, 1 on error
+CERVER_EXPORT u8 cerver_set_reactor_cpu (
+	Cerver *cerver, unsigned int reactor_idx, int cpu
+);
+
+// sets the udp options to be used if the cerver's protocol is PROTOCOL_UDP
+// batch_size - max number of datagrams to receive & send in a single call
+// peer_timeout - secs after an idle peer is removed, 0 to never remove peers
+// the default values are CERVER_DEFAULT_UDP_BATCH_SIZE
+// and CERVER_DEFAULT_UDP_PEER_TIMEOUT
+CERVER_EXPORT void cerver_set_udp_options (
+	Cerver *cerver, u32 batch_size, u32 peer_timeout
+);
+
+// sets the max number of udp peers that the cerver keeps at the same time
+// datagrams from new peers are ignored until others are removed
+// a max peers of 0 lets the cerver keep any number of peers
+// the default value is CERVER_DEFAULT_UDP_MAX_PEERS
+CERVER_EXPORT void cerver_set_udp_max_peers (
+	Cerver *cerver, u32 max_peers
+);
+
 // set the ability to handle new connections if cerver handler type is CERVER_HANDLER_TYPE_THREADS
 // by only creating new detachable threads for each connection
 // by default, this option is turned off to also use the thpool
@@ -505,6 +752,28 @@ CERVER_EXPORT void cerver_set_max_received_packet_size (
 	Cerver *cerver, size_t max_received_packet_size
 );
 
+// enables zero copy packets, by default, this option is turned off
+// complete packets in the receive buffer will reference the buffer itself
+// instead of copying their data, only split packets will be copied
+// the packet's data is only valid while the handler method executes,
+// so call packet_retain () to keep using it after the handler returns
+// packets pushed to a handler's job queue are always retained
+CERVER_EXPORT void cerver_set_zero_copy_packets (
+	Cerver *cerver, bool zero_copy_packets
+);
+
+// enables a send queue in every client connection, by default, this option is turned off
+// packets sent to a connection are appended to its queue without blocking
+// and are sent together when the connection's socket is writable
+// high_water & overflow are set to each connection's queue,
+// check connection_set_send_queue_high_water () for their values
+// only used with CERVER_HANDLER_TYPE_EPOLL, CERVER_HANDLER_TYPE_REACTORS
+// & CERVER_HANDLER_TYPE_IO_URING as other handlers never flush the queues
+CERVER_EXPORT void cerver_set_connections_send_queue (
+	Cerver *cerver,
+	const size_t high_water, const SendQueueOverflow overflow
+);
+
 // 27/05/2020 - changed form Action to Handler
 // sets customs PACKET_TYPE_APP and PACKET_TYPE_APP_ERROR packet types handlers
 CERVER_EXPORT void cerver_set_app_handlers (
@@ -546,6 +815,33 @@ CERVER_EXPORT int cerver_set_multiple_handlers (
 	Cerver *cerver, unsigned int n_handlers
 );
 
+// sets how packets are routed between multiple app handlers
+// CERVER_HANDLER_DISPATCH_ID lets the client select the handler
+// using the packet's header handler id (default)
+// CERVER_HANDLER_DISPATCH_CONNECTION & CERVER_HANDLER_DISPATCH_CLIENT
+// always send the packets of the same connection (or client)
+// to the same handler, so they are handled in the order they arrived
+CERVER_EXPORT void cerver_set_handler_dispatch_policy (
+	Cerver *cerver, CerverHandlerDispatch dispatch
+);
+
+// sets the cpus where the cerver's internal threads will run
+// handlers, thpool, reactors, on hold, admin & timers threads
+// with THREAD_AFFINITY_SPREAD & THREAD_AFFINITY_COMPACT
+// every thread gets its own cpu in the order they are started
+// handlers & reactors with their own affinity or cpu keep them
+// must be called before the cerver starts
+CERVER_EXPORT void cerver_set_affinity (
+	Cerver *cerver, const ThreadAffinity *affinity
+);
+
+// copies the cerver's affinity into affinity for a group of n threads
+// that will use their idx in the group to select their cpu
+CERVER_PRIVATE void cerver_get_affinity (
+	Cerver *cerver, const unsigned int n_threads,
+	ThreadAffinity *affinity
+);
+
 // set whether to check or not incoming packets
 // check packet's header protocol id & version compatibility
 // if packets do not pass the checks, won't be handled and will be inmediately destroyed
@@ -556,7 +852,7 @@ CERVER_EXPORT void cerver_set_check_packets (
 );
 
 // sets a custom cerver update function to be executed every n ticks
-// a new thread will be created that will call your method each tick
+// a timer in the cerver's timers thread will call your method each tick
 // the update args will be passed to your method as a CerverUpdate &
 // will only be deleted at cerver teardown if you set the delete_update_args ()
 CERVER_EXPORT void cerver_set_update (
@@ -567,7 +863,7 @@ CERVER_EXPORT void cerver_set_update (
 );
 
 // sets a custom cerver update method to be executed every x seconds (in intervals)
-// a new thread will be created that will call your method every x seconds
+// a timer in the cerver's timers thread will call your method every x seconds
 // the update args will be passed to your method as a CerverUpdate &
 // will only be deleted at cerver teardown if you set the delete_update_args ()
 CERVER_EXPORT void cerver_set_update_interval (
@@ -657,6 +953,26 @@ CERVER_PRIVATE CerverUpdate *cerver_update_new (
 
 CERVER_PUBLIC void cerver_update_delete (void *cerver_update_ptr);
 
+// places the client in the cerver's inactive clients wheel
+// using its last activity, if the cerver checks for inactive clients
+CERVER_PRIVATE void cerver_inactive_register (
+	Cerver *cerver, struct _Client *client
+);
+
+// removes the client from the cerver's inactive clients wheel
+CERVER_PRIVATE void cerver_inactive_unregister (
+	Cerver *cerver, struct _Client *client
+);
+
+// returns the wheel that executes the cerver's timers
+// it gets created the first time it is requested
+// tcp cervers with a CERVER_HANDLER_TYPE_POLL or CERVER_HANDLER_TYPE_EPOLL
+// handler wait for its timerfd in their loop, so the timers are executed
+// in the same thread that handles the connections,
+// any other cerver starts the wheel's own thread
+// returns NULL on error
+CERVER_PRIVATE TimerWheel *cerver_timers_get (Cerver *cerver);
+
 #pragma endregion
 
 #pragma region end
@@ -136,6 +136,19 @@ struct _Client {
 
 	time_t last_activity;	// the last time the client sent / receive data
 
+	// the client's place in the cerver's inactive clients wheel
+	bool inactive_placed;
+	unsigned int inactive_slot;
+	struct _Client *inactive_prev;
+	struct _Client *inactive_next;
+
+	// waits to be deleted by the cerver's clients registry
+	struct _Client *retired_next;
+
+	// set with the connections lock when the client starts to be removed
+	// from the cerver, so no new connection can be registered to him
+	bool removed;
+
 	bool drop_client;		// client failed to authenticate
 
 	void *data;
@@ -272,7 +285,8 @@ CERVER_EXPORT u8 client_disconnect (Client *client);
 CERVER_EXPORT void client_got_disconnected (Client *client);
 
 // drops a client form the cerver
-// unregisters the client from the cerver and the deletes him
+// unregisters the client from the cerver, closes its connections
+// moving their sockets to the cerver's sockets pool & then deletes him
 CERVER_EXPORT void client_drop (
 	struct _Cerver *cerver, Client *client
 );
@@ -347,13 +361,23 @@ CERVER_PRIVATE Client *client_unregister_from_cerver (
 	struct _Cerver *cerver, Client *client
 );
 
-// gets the client associated with a sock fd using the client-sock fd map
+// gets the client associated with a sock fd using the cerver's fd table
 CERVER_PUBLIC Client *client_get_by_sock_fd (
 	struct _Cerver *cerver, i32 sock_fd
 );
 
-// searches the avl tree to get the client associated with the session id
+// gets the client with the matching id from the cerver's clients registry
+// a dropped client is deleted once the registry's readers are done,
+// so the lookup & any use of the client must be done between
+// client_registry_read_start () & client_registry_read_end ()
+// if another thread might drop it meanwhile
+CERVER_PUBLIC Client *client_get_by_id (
+	struct _Cerver *cerver, const u64 id
+);
+
+// gets the client associated with the session id from the cerver's clients registry
 // the cerver must support sessions
+// the client is only kept alive inside a registry read like client_get_by_id ()
 CERVER_PUBLIC Client *client_get_by_session_id (
 	struct _Cerver *cerver, const char *session_id
 );
@@ -365,6 +389,12 @@ CERVER_PUBLIC void client_broadcast_to_all_avl (
 	struct _Packet *packet
 );
 
+// broadcast a packet to all the clients in the cerver's clients registry
+// the clients are visited without locking the registry
+CERVER_PUBLIC void client_broadcast_to_all (
+	struct _Cerver *cerver, struct _Packet *packet
+);
+
 #pragma endregion
 
 #pragma region events
@@ -387,7 +417,8 @@ CERVER_PUBLIC void client_broadcast_to_all_avl (
 	XX(14,	LOBBY_JOIN, 		Correctly joined a new lobby)																					\
 	XX(15,	LOBBY_LEAVE, 		Successfully exited a lobby)																					\
 	XX(16,	LOBBY_START, 		The game in the lobby has started)																				\
-	XX(17,	UNKNOWN, 			Unknown event)
+	XX(17,	SEND_HIGH_WATER, 	The connection send queue reached its high water mark)															\
+	XX(18,	UNKNOWN, 			Unknown event)
 
 typedef enum ClientEventType {
 
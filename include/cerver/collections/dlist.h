@@ -1,10 +1,18 @@
 #ifndef _COLLECTIONS_DLIST_H_
 #define _COLLECTIONS_DLIST_H_
 
+#include <stddef.h>
 #include <stdbool.h>
 
 #include <pthread.h>
 
+// elements of non intrusive lists are taken from chunks of this size
+// that are kept until the program exits
+#define DLIST_ELEMENTS_CHUNK_SIZE			256
+
+// max number of free elements that each thread keeps for itself
+#define DLIST_ELEMENTS_CACHE_SIZE			64
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -29,6 +37,11 @@ typedef struct DoubleList {
 
 	pthread_mutex_t *mutex;
 
+	// intrusive lists use the ListElement embedded in their data
+	// at link_offset instead of allocating a new one
+	bool intrusive;
+	size_t link_offset;
+
 } DoubleList;
 
 #define dlist_start(list) ((list)->start)
@@ -40,6 +53,13 @@ typedef struct DoubleList {
 #define dlist_for_each(dlist, le)					\
 	for (le = dlist->start; le; le = le->next)
 
+// gets the offset of the ListElement member inside the data's type
+// to be used with dlist_init_intrusive ()
+#define dlist_link_offset(type, member) offsetof (type, member)
+
+// returns true if the data's embedded ListElement is inside a list
+#define dlist_link_is_linked(link) ((link)->data != NULL)
+
 #define dlist_for_each_backwards(dlist, le)			\
 	for (le = dlist->end; le; le = le->prev)
 
@@ -81,6 +101,21 @@ extern DoubleList *dlist_init (
 	int (*compare)(const void *one, const void *two)
 );
 
+// creates a new intrusive double list
+// every element is the ListElement found in the data at link_offset
+// so inserts & removals never allocate or free any memory
+// the data can only be in one list per embedded ListElement at a time
+// and inserting data that is already linked fails
+extern DoubleList *dlist_init_intrusive (
+	void (*destroy)(void *data),
+	int (*compare)(const void *one, const void *two),
+	const size_t link_offset
+);
+
+// inits a ListElement that is embedded in other structure
+// it must be called before its data is inserted into an intrusive list
+extern void dlist_link_init (ListElement *link);
+
 // destroys all of the dlist's elements and their data but keeps the dlist
 extern void dlist_reset (DoubleList *dlist);
 
@@ -286,6 +321,7 @@ extern void **dlist_to_array (
 // creates the dlist's elements using the same data pointers as in the original dlist
 // be carefull which dlist you delete first, as the other should use dlist_clear first before delete
 // the new dlist's delete and comparator methods are set from the original
+// the copy always allocates its own elements, even if the original is intrusive
 extern DoubleList *dlist_copy (const DoubleList *dlist);
 
 // returns a exact clone of the dlist
@@ -332,6 +368,28 @@ extern DoubleList *dlist_merge_two_by_condition (
 	const void *match
 );
 
+// moves all the elements from source into dest AFTER the specified element
+// if element == NULL, they will be inserted at the start of dest
+// both lists must use the same kind of elements
+// this method is NOT thread safe & takes O(1)
+// returns 0 on success, 1 on error
+extern int dlist_splice_unsafe (
+	DoubleList *dest, ListElement *element,
+	DoubleList *source
+);
+
+// moves the elements from first to last (both included) from source
+// into dest AFTER the specified element
+// if element == NULL, they will be inserted at the start of dest
+// count must be the number of elements in the range
+// this method is NOT thread safe & takes O(1)
+// returns 0 on success, 1 on error
+extern int dlist_splice_range_unsafe (
+	DoubleList *dest, ListElement *element,
+	DoubleList *source,
+	ListElement *first, ListElement *last, const size_t count
+);
+
 // expects a dlist of dlists and creates a new dlist with all the elements
 // elements from original dlists are moved directly to the new list
 // the original dlists can be deleted after this operation
@@ -9,34 +9,67 @@
 
 #define HTAB_DEFAULT_INIT_SIZE				32
 
+// the htab always has a power of 2 number of slots
+#define HTAB_MIN_SIZE						8
+
+// the htab grows when more than 7/8 of its slots are used
+#define HTAB_MAX_LOAD_NUM					7
+#define HTAB_MAX_LOAD_DEN					8
+
+// keys up to this size are copied inside their slot
+// if no custom key create method has been set
+#define HTAB_INLINE_KEY_SIZE				16
+
+// slots that are moved from the old table to the new one
+// in every insert & remove while the htab is growing
+#define HTAB_RESIZE_STEP					32
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+// a slot in the htab's open addressing table
+// values are kept in their slots, so there are no nodes allocations
 typedef struct HtabNode {
 
-	struct HtabNode *next;
-	void *key;
+	size_t hash;
+
+	// probe distance from the slot that matches the hash + 1
+	// 0 marks an empty slot
+	unsigned int dist;
+
+	bool inline_key;
 	size_t key_size;
+	union {
+		void *ptr;
+		char bytes[HTAB_INLINE_KEY_SIZE];
+	} key;
+
 	void *val;
 	size_t val_size;
 
 } HtabNode;
 
-typedef struct HtabBucket {
-
-	struct HtabNode *start;
-	size_t count;
-
-} HtabBucket;
-
+// a robin hood hash table
+// elements that are further from their slot take the place of the closer ones,
+// so every probe sequence is short & lookups can stop early
+// when the htab grows, a new table is allocated & the elements
+// are moved from the old one a few at a time in every insert & remove
 typedef struct Htab {
 
-	HtabBucket **table;
+	HtabNode *table;
+	size_t size;                // number of slots in the current table
+	size_t count;               // elements in both tables
 
-	size_t size;
-	size_t count;
+	// the previous table while it is being moved
+	HtabNode *old_table;
+	size_t old_size;
+	size_t old_count;
+	size_t old_start;           // the slot after an empty one
+	size_t migrated;            // old slots that have been moved after start
 
+	// the htab calls this method with SIZE_MAX as the table size
+	// to get the full hash, and maps it to its own slots
 	size_t (*hash)(
 		const void *key, size_t key_size, size_t table_size
 	);
@@ -55,6 +88,10 @@ typedef struct Htab {
 
 } Htab;
 
+// the default htab hash method
+// returns a 64 bit hash of the key's bytes
+extern size_t htab_hash (const void *key, size_t key_size);
+
 // sets a method to correctly create (allocate) a new key
 // your original key data is passed as the argument to this method
 // if not set, a genreic internal method will be called instead
@@ -73,12 +110,12 @@ extern void htab_set_key_delete (
 // usefull if you want to compare your keys (data) by specific fields
 // if not set, a generic method will be used instead
 extern void htab_set_key_comparator (
-	Htab *htab, 
+	Htab *htab,
 	int (*key_compare)(const void *one, const void *two)
 );
 
 // creates a new htab
-// size - how many buckets do you want - more buckets = less collisions
+// size - how many slots to start with, it grows when needed
 // hash - custom method to hash the key for insertion, NULL for default
 // delete_data - custom method to delete your data, NULL for no delete when htab gets destroyed
 extern Htab *htab_create (
@@ -103,10 +140,10 @@ extern bool htab_contains_key (
 );
 
 // inserts a new value to the htab associated with its key
-// returns 0 on success, 1 on error
+// returns 0 on success, 1 on error or if the key already exists
 extern int htab_insert (
-	Htab *ht, 
-	const void *key, size_t key_size, 
+	Htab *ht,
+	const void *key, size_t key_size,
 	void *val, size_t val_size
 );
 
@@ -126,7 +163,7 @@ extern void *htab_remove (
 // destroys the htb and all of its data
 extern void htab_destroy (Htab *ht);
 
-// prints the htab - buckets - nodes
+// prints the htab - slots
 // currently only works if both keys and values are int
 // used for debugging and testing
 extern void htab_print (Htab *htab);
@@ -135,4 +172,4 @@ extern void htab_print (Htab *htab);
 }
 #endif
 
-#endif
\ No newline at end of file
+#endif
@@ -4,15 +4,109 @@
 #include <stdlib.h>
 #include <stdbool.h>
 
-#include "cerver/collections/dlist.h"
+#include <pthread.h>
+
+#include "cerver/types/types.h"
+
+#include "cerver/config.h"
+
+#define POOL_CACHE_LINE					64
+
+// number of objects that fit inside a magazine
+#define POOL_MAGAZINE_SIZE				16
+
+// threads are spread between this many caches
+// each one with its own lock & cache line
+#define POOL_CACHES						16
+
+// magazines are allocated in chunks that are kept until the pool is deleted
+#define POOL_CHUNK_MAGAZINES			64
+
+// chunks that fit in the first chunks table
+// the table doubles its size every time it gets full
+#define POOL_CHUNKS_TABLE_SIZE			16
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+// a fixed capacity stack of objects
+// that is moved as a whole between the caches & the depot
+typedef struct PoolMagazine {
+
+	u32 id;
+	u32 next;                       // the next magazine in the depot (id + 1)
+
+	unsigned int rounds;
+	void *objects[POOL_MAGAZINE_SIZE];
+
+} PoolMagazine;
+
+// indexes the chunks of magazines by their ids
+// the depot reads it without the lock, so when it gets full, its
+// chunks are copied into a new table, and it is kept until the pool is deleted
+typedef struct PoolChunks {
+
+	u32 size;
+
+	// used after the table has grown
+	struct PoolChunks *retired_next;
+
+	PoolMagazine *chunks[];
+
+} PoolChunks;
+
+typedef struct PoolStats {
+
+	u64 hits;                       // pops that were served from the pool
+	u64 misses;                     // pops that found the pool empty
+	u64 produced;                   // objects created after a miss
+	u64 dropped;                    // objects destroyed because the pool was full
+
+} PoolStats;
+
+// the loaded magazine can have any number of objects
+// the previous one is always either empty or full
+// so a thread that alternates pushes & pops
+// never needs to access the depot
+struct _PoolCache {
+
+	pthread_mutex_t lock;
+
+	PoolMagazine *loaded;
+	PoolMagazine *previous;
+
+	PoolStats stats;
+
+} CERVER_ATTRS ((aligned (POOL_CACHE_LINE)));
+
+typedef struct _PoolCache PoolCache;
+
+// lock free stacks of magazines
+// the heads keep a tag in their upper 32 bits
+// that changes with every update to prevent ABA problems
+struct _PoolDepot {
+
+	u64 full;
+	u64 empty;
+
+	size_t rounds;                  // objects inside the full magazines
+
+} CERVER_ATTRS ((aligned (POOL_CACHE_LINE)));
+
+typedef struct _PoolDepot PoolDepot;
+
 typedef struct Pool {
 
-	DoubleList *dlist;
+	PoolCache caches[POOL_CACHES];
+
+	PoolDepot depot;
+
+	PoolChunks *chunks;
+	u32 n_magazines;
+	pthread_mutex_t *magazines_lock;
+
+	size_t max_depot_size;
 
 	void (*destroy)(void *data);
 	void *(*create)(void);
@@ -31,9 +125,22 @@ extern void pool_set_create (Pool *pool, void *(*create)(void));
 // the pool will use its create method to allocate a new element and fullfil the request
 extern void pool_set_produce_if_empty (Pool *pool, bool produce);
 
+// sets the max number of objects that the pool keeps in its depot
+// pushed objects that don't fit are destroyed using the destroy method
+// the caches are not counted, so the pool can have up to
+// max depot size + (POOL_CACHES * 2 * POOL_MAGAZINE_SIZE) objects
+// a max depot size of 0 (default) lets the pool grow without any limit
+extern void pool_set_max_depot_size (
+	Pool *pool, const size_t max_depot_size
+);
+
 // returns how many elements are inside the pool
+// the value is only an estimate while other threads are using the pool
 extern size_t pool_size (Pool *pool);
 
+// copies the sum of all the pool's counters into stats
+extern void pool_get_stats (const Pool *pool, PoolStats *stats);
+
 // creates a new pool
 extern Pool *pool_create (void (*destroy)(void *data));
 
@@ -44,11 +151,15 @@ extern int pool_init (
 	void *(*create)(void), unsigned int n_elements
 );
 
-// inserts the new data at the end of the pool
-// returns 0 on success, 1 on error
+// inserts the data in the calling thread's cache
+// if the pool is full or a new magazine failed to be allocated
+// the data is destroyed using the pool's destroy method
+// returns 0 on success, 1 on error or if the data was not kept nor destroyed
 extern int pool_push (Pool *pool, void *data);
 
-// returns the data that is first in the pool
+// returns the last data that was inserted in the calling thread's cache
+// or a full magazine from the depot if the cache is empty
+// so the objects are reused in LIFO order
 extern void *pool_pop (Pool *pool);
 
 // only gets rid of the pool's elements, but the data is kept
@@ -65,4 +176,4 @@ extern void pool_delete (Pool *pool);
 }
 #endif
 
-#endif
\ No newline at end of file
+#endif
@@ -6,12 +6,15 @@
 #include "cerver/types/types.h"
 #include "cerver/types/string.h"
 
+#include "cerver/collections/dlist.h"
+
 #include "cerver/cerver.h"
 #include "cerver/config.h"
 #include "cerver/handler.h"
 #include "cerver/network.h"
 #include "cerver/packets.h"
 #include "cerver/receive.h"
+#include "cerver/send.h"
 #include "cerver/socket.h"
 
 #include "cerver/threads/jobs.h"
@@ -41,6 +44,9 @@
 #define CONNECTION_DEFAULT_USE_SEND_QUEUE			false
 #define CONNECTION_DEFAULT_SEND_FLAGS				0
 
+// max time in ms the send thread waits for the socket to be writable
+#define CONNECTION_SEND_POLL_TIMEOUT				100
+
 #define CONNECTION_DEFAULT_ATTEMPT_RECONNECT		false
 #define CONNECTION_DEFAULT_RECONNECT_WAIT_TIME		30
 
@@ -53,6 +59,8 @@ struct _Cerver;
 struct _CerverReport;
 struct _Client;
 struct _Connection;
+struct _CerverReactor;
+struct _CerverUringConnection;
 struct _PacketsPerType;
 struct _AdminCerver;
 
@@ -113,6 +121,10 @@ struct _Connection {
 
 	struct _Client *client;
 
+	// keeps the connection inside its client's connections
+	// without allocating a new list element
+	ListElement link;
+
 	char name[CONNECTION_NAME_SIZE];
 
 	struct _Socket *socket;
@@ -129,6 +141,9 @@ struct _Connection {
 	pthread_t connection_thread_id;
 	time_t connected_timestamp;             // when the connection started
 
+	struct _CerverReactor *reactor;         // the reactor that handles this connection
+	struct _CerverUringConnection *uring;   // its reference in the cerver's io_uring
+
 	struct _CerverReport *cerver_report;    // info about the cerver we are connecting to
 
 	u32 max_sleep;
@@ -142,6 +157,12 @@ struct _Connection {
 	u32 receive_packet_buffer_size;         // read packets into a buffer of this size in client_receive ()
 	
 	ReceiveHandle receive_handle;
+	u32 queued_packets;                     // packets waiting in a cerver handler's queue
+
+	// the handler whose full queue has stopped the connection's reads
+	// when using HANDLER_OVERFLOW_PAUSE
+	struct _Handler *paused_handler;
+	ListElement pause_link;
 
 	pthread_t request_thread_id;
 
@@ -164,10 +185,12 @@ struct _Connection {
 	void *custom_receive_args;              		// arguments to be passed to the custom receive method
 	void (*custom_receive_args_delete)(void *);		// method to delete the arguments when the connection gets deleted
 
+	// packets are appended to the send queue without blocking
+	// and are flushed when the connection's socket is writable
 	bool use_send_queue;
-	int send_flags;
-	pthread_t send_thread_id;
-	JobQueue *send_queue;
+	int send_flags;                         // flags passed to sendmsg () when flushing
+	pthread_t send_thread_id;               // flushes the queue if the connection has no reactor
+	SendQueue *send_queue;
 
 	bool authenticated;                     // the connection has been authenticated to the cerver
 	void *auth_data;                        // maybe auth credentials
@@ -290,11 +313,30 @@ CERVER_PUBLIC void connection_set_custom_receive (
 );
 
 // enables the ability to send packets using the connection's queue
-// a dedicated thread will be created to send queued packets
+// every packet sent to the connection will be appended to the queue
+// without blocking & queued packets will be sent together
+// when the connection's socket is writable
+// client connections use a dedicated thread to flush the queue
+// cerver connections can only use it with CERVER_HANDLER_TYPE_EPOLL,
+// CERVER_HANDLER_TYPE_REACTORS & CERVER_HANDLER_TYPE_IO_URING
+// and the queue must be set before they are registered to the cerver
+// methods that send directly to the socket like packet_send_to_socket ()
+// or file transfers should NOT be used with the queue
 CERVER_PUBLIC void connection_set_send_queue (
 	Connection *connection, int flags
 );
 
+// sets the max number of bytes that can be waiting in the connection's queue
+// and what to do when it is reached; SEND_QUEUE_OVERFLOW_EVENT keeps the data
+// and triggers the matching send high water event,
+// SEND_QUEUE_OVERFLOW_DROP discards the queue & drops the connection
+// use a high water of 0 to let the queue grow without any limit
+// the default values are SEND_QUEUE_DEFAULT_HIGH_WATER & SEND_QUEUE_DEFAULT_OVERFLOW
+CERVER_PUBLIC void connection_set_send_queue_high_water (
+	Connection *connection,
+	const size_t high_water, const SendQueueOverflow overflow
+);
+
 // sets the connection auth data to send whenever the cerver requires authentication
 // and a method to destroy it once the connection has ended,
 // if delete_auth_data is NULL, the auth data won't be deleted
@@ -351,7 +393,8 @@ CERVER_PRIVATE void connection_drop (
 	struct _Cerver *cerver, Connection *connection
 );
 
-// gets the connection from the on hold connections map in cerver
+// gets the on hold connection from the cerver's fd table
+// on hold connections are the ones without a client
 CERVER_PRIVATE Connection *connection_get_by_sock_fd_from_on_hold (
 	struct _Cerver *cerver, const i32 sock_fd
 );
@@ -377,6 +420,14 @@ CERVER_PRIVATE u8 connection_register_to_client (
 	struct _Client *client, Connection *connection
 );
 
+// registers a new connection to a client that is already in the cerver
+// & maps its sock fd to them in the cerver's fd table
+// fails if the client has started to be removed from the cerver
+// returns 0 on success, 1 on error
+CERVER_PRIVATE u8 connection_register_to_registered_client (
+	struct _Cerver *cerver, struct _Client *client, Connection *connection
+);
+
 // registers the client connection to the cerver's strcutures (like maps)
 // returns 0 on success, 1 on error
 CERVER_PRIVATE u8 connection_register_to_cerver (
@@ -392,6 +443,9 @@ CERVER_PRIVATE u8 connection_unregister_from_cerver (
 
 // wrapper function for easy access
 // registers a client connection to the cerver poll array
+// or to the cerver's epoll if handler type is CERVER_HANDLER_TYPE_EPOLL
+// or to its reactor if handler type is CERVER_HANDLER_TYPE_REACTORS
+// or to the cerver's io_uring if handler type is CERVER_HANDLER_TYPE_IO_URING
 // returns 0 on success, 1 on error
 CERVER_PRIVATE u8 connection_register_to_cerver_poll (
 	struct _Cerver *cerver, Connection *connection
@@ -399,6 +453,9 @@ CERVER_PRIVATE u8 connection_register_to_cerver_poll (
 
 // wrapper function for easy access
 // unregisters a client connection from the cerver poll array
+// or from the cerver's epoll if handler type is CERVER_HANDLER_TYPE_EPOLL
+// or from its reactor if handler type is CERVER_HANDLER_TYPE_REACTORS
+// or from the cerver's io_uring if handler type is CERVER_HANDLER_TYPE_IO_URING
 // returns 0 on success, 1 on error
 CERVER_PRIVATE u8 connection_unregister_from_cerver_poll (
 	struct _Cerver *cerver, Connection *connection
@@ -422,10 +479,35 @@ CERVER_PRIVATE u8 connection_remove_from_cerver (
 	struct _Cerver *cerver, Connection *connection
 );
 
+// appends the buffers into the connection's send queue as a single piece
+// the queue is flushed right away if it was empty & it is not corked
+// returns 0 on success, 1 if the data was NOT queued
+CERVER_PRIVATE u8 connection_send_queue_push (
+	struct _Cerver *cerver,
+	struct _Client *client, Connection *connection,
+	const struct iovec *iov, const int iovcnt
+);
+
+// sends the connection's queued data without blocking
+// returns 0 on success, 1 on error
+CERVER_PRIVATE u8 connection_send_queue_flush (Connection *connection);
+
+// data appended into the connection's queue won't be flushed
+// until connection_send_queue_uncork () gets called
+// used to send all the responses to a batch of packets together
+// returns true if the connection has a send queue
+CERVER_PRIVATE bool connection_send_queue_cork (Connection *connection);
+
+// flushes any data that was queued since the queue was corked
+CERVER_PRIVATE void connection_send_queue_uncork (Connection *connection);
+
+// appends the packet into the connection's send queue
+// the packet gets deleted after it has been queued
 CERVER_PUBLIC void connection_send_packet (
 	Connection *connection, Packet *packet
 );
 
+
 #ifdef __cplusplus
 }
 #endif
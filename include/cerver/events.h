@@ -30,6 +30,7 @@ struct _Connection;
 	XX(7,	CLIENT_FAILED_AUTH,			A client connection failed to authenticate)					\
 	XX(8,	CLIENT_CONNECTED, 			A new client has connected to the cerver)					\
 	XX(9,	CLIENT_NEW_CONNECTION, 		Added a connection to an existing client)					\
+	XX(10,	CLIENT_SEND_HIGH_WATER,		A client connection send queue reached its high water mark)	\
 	XX(11,	CLIENT_CLOSE_CONNECTION,	A connection from an existing client was closed)			\
 	XX(12,	CLIENT_DISCONNECTED, 		A client has disconnected from the cerver)					\
 	XX(13,	CLIENT_DROPPED, 			A client has been dropped from the cerver)					\
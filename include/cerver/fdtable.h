@@ -0,0 +1,98 @@
+#ifndef _CERVER_FDTABLE_H_
+#define _CERVER_FDTABLE_H_
+
+#include <stdbool.h>
+
+#include <pthread.h>
+
+#include "cerver/types/types.h"
+
+#include "cerver/config.h"
+
+#define FD_TABLE_CHUNK_SIZE					1024
+#define FD_TABLE_MAX_CHUNKS					1024
+
+// entries generations are always even after an update
+// so this value never matches any entry
+#define FD_TABLE_INVALID_GENERATION			1
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct _Client;
+struct _Connection;
+
+// the connection that is currently using a sock fd
+// on hold connections don't have a client yet
+struct _FdTableEntry {
+
+	// incremented before & after every update
+	// so it is odd while the entry is being updated
+	u32 generation;
+
+	struct _Client *client;
+	struct _Connection *connection;
+
+};
+
+typedef struct _FdTableEntry FdTableEntry;
+
+// maps sock fds directly to their client & connection
+// entries are stored in chunks that are allocated when a sock fd
+// needs them & are never moved, so the table can grow
+// while other threads are reading from it without any lock
+// updates are serialized by the table's lock, and readers
+// use each entry's generation to get a consistent copy of it
+struct _FdTable {
+
+	FdTableEntry *chunks[FD_TABLE_MAX_CHUNKS];
+	pthread_mutex_t *lock;
+
+};
+
+typedef struct _FdTable FdTable;
+
+CERVER_PRIVATE FdTable *fd_table_new (void);
+
+CERVER_PRIVATE void fd_table_delete (void *table_ptr);
+
+// creates a new table with the first chunk of entries
+// more chunks are allocated when bigger sock fds are set
+CERVER_PRIVATE FdTable *fd_table_create (void);
+
+// maps the sock fd to the client & connection
+// any previous values are replaced, as the sock fd has been reused
+// returns 0 on success, 1 on error
+CERVER_PRIVATE u8 fd_table_set (
+	FdTable *table, const i32 sock_fd,
+	struct _Client *client, struct _Connection *connection
+);
+
+// removes the sock fd only if it is still mapped
+// to the same client & connection
+// returns 0 on success, 1 if the sock fd has another owner
+CERVER_PRIVATE u8 fd_table_remove (
+	FdTable *table, const i32 sock_fd,
+	const struct _Client *client, const struct _Connection *connection
+);
+
+// copies the values mapped to the sock fd into entry
+// returns 0 if the sock fd has a connection, 1 if not
+CERVER_PRIVATE u8 fd_table_get (
+	const FdTable *table, const i32 sock_fd,
+	FdTableEntry *entry
+);
+
+// returns true if the sock fd has not been updated
+// since the generation was read with fd_table_get ()
+// used to check that the sock fd was not closed & reused by another connection
+CERVER_PRIVATE bool fd_table_check (
+	const FdTable *table, const i32 sock_fd, const u32 generation
+);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -12,6 +12,7 @@
 
 #include "cerver/cerver.h"
 #include "cerver/client.h"
+#include "cerver/poll.h"
 
 #include "cerver/threads/thread.h"
 
@@ -80,8 +81,9 @@ struct _Lobby {
 
 	Htab *sock_fd_player_map;           // maps a socket fd to a player
 	struct pollfd *players_fds;     			
-	u16 max_players_fds;
-	u16 current_players_fds;            // n of active fds in the pollfd array
+	u32 max_players_fds;
+	u32 current_players_fds;            // n of active fds in the pollfd array
+	PollFdsMap *players_fds_map;        // maps sock fds to their idx in the pollfd array
 	u32 poll_timeout;    
 
 	bool running;						// lobby is listening for player packets
@@ -3,8 +3,13 @@
 
 #include <stdlib.h>
 
+#include <sys/socket.h>
+
 #include "cerver/types/types.h"
 
+#include "cerver/collections/dlist.h"
+#include "cerver/collections/htab.h"
+
 #include "cerver/cerver.h"
 #include "cerver/config.h"
 #include "cerver/client.h"
@@ -12,6 +17,7 @@
 #include "cerver/receive.h"
 
 #include "cerver/threads/jobs.h"
+#include "cerver/threads/thread.h"
 
 #include "cerver/game/lobby.h"
 
@@ -29,8 +35,23 @@ struct _Lobby;
 
 struct _Packet;
 
+struct _Uring;
+struct _UringBufRing;
+struct _CerverUring;
+
 #pragma region handler
 
+// max number of jobs a handler takes from its queue in a single wakeup
+#define HANDLER_JOBS_BATCH				32
+
+#define HANDLER_DEFAULT_MAX_QUEUE_DEPTH		0
+#define HANDLER_DEFAULT_OVERFLOW			HANDLER_OVERFLOW_DROP_NEWEST
+
+// how long a paused producer waits before checking the queue again
+#define HANDLER_PAUSE_WAIT_MS				100
+
+#define HANDLER_LATENCY_BUCKETS			20
+
 typedef enum HandlerType {
 
 	HANDLER_TYPE_NONE         = 0,
@@ -51,6 +72,46 @@ typedef struct HandlerData {
 
 } HandlerData;
 
+// what to do with new jobs when the handler's queue is full
+#define HANDLER_OVERFLOW_MAP(XX)																		\
+	XX(0,	DROP_NEWEST, 	Drop-Newest, 	Discard the new packets)									\
+	XX(1,	DROP_OLDEST, 	Drop-Oldest, 	Discard the oldest packets waiting in the queue)			\
+	XX(2,	PAUSE, 			Pause, 			Stop reading until the handler drains its queue)			\
+	XX(3,	ERROR, 			Error, 			Discard the new packets & send an error packet)
+
+typedef enum HandlerOverflow {
+
+	#define XX(num, name, string, description) HANDLER_OVERFLOW_##name = num,
+	HANDLER_OVERFLOW_MAP (XX)
+	#undef XX
+
+} HandlerOverflow;
+
+CERVER_EXPORT const char *handler_overflow_to_string (
+	const HandlerOverflow overflow
+);
+
+CERVER_EXPORT const char *handler_overflow_description (
+	const HandlerOverflow overflow
+);
+
+typedef struct HandlerStats {
+
+	size_t queue_depth;                 // jobs currently waiting in the queue
+	size_t queue_high_water;            // max jobs that have been waiting at once
+
+	u64 jobs_pushed;                    // jobs that were added to the queue
+	u64 jobs_handled;                   // jobs that the handler has completed
+	u64 jobs_dropped;                   // jobs discarded by the overflow policy
+	u64 overflows;                      // times the queue was full
+
+	// time that the jobs waited in the queue before being handled
+	// bucket i counts the jobs that waited less than 2^i microseconds
+	// the last bucket counts every job that waited longer
+	u64 latency[HANDLER_LATENCY_BUCKETS];
+
+} HandlerStats;
+
 struct _Handler {
 
 	HandlerType type;
@@ -90,6 +151,24 @@ struct _Handler {
 	// passed as args to the handler method
 	JobQueue *job_queue;
 
+	// max number of jobs that can be waiting in the queue (0 for no limit)
+	// and what to do with new jobs when it has been reached
+	size_t max_queue_depth;
+	HandlerOverflow overflow;
+
+	// producers waiting for the queue to drain
+	// & connections that have stopped reading
+	// when using HANDLER_OVERFLOW_PAUSE
+	unsigned int paused;
+	DoubleList *paused_connections;
+	pthread_mutex_t *pause_mutex;
+	pthread_cond_t *pause_cond;
+
+	// the cpus where the handler's thread runs
+	ThreadAffinity affinity;
+
+	HandlerStats stats;
+
 	struct _Cerver *cerver;     // the cerver this handler belongs to
 	struct _Client *client;     // the client this handler belongs to
 
@@ -143,6 +222,65 @@ CERVER_EXPORT void handler_set_direct_handle (
 	Handler *handler, bool direct_handle
 );
 
+// sets the cpus where the handler's thread will run
+// the handler's id is used as the thread idx for spread & compact affinities
+// handlers without an affinity use the cerver's one (if any)
+// must be called before the handler gets started
+CERVER_EXPORT void handler_set_affinity (
+	Handler *handler, const ThreadAffinity *affinity
+);
+
+// sets the max number of jobs (packets) that can be waiting in the handler's queue
+// and what to do with new ones when it has been reached
+// HANDLER_OVERFLOW_PAUSE keeps the packets but stops reading from the connection
+// until the handler has drained half of its queue, so TCP pushes back to the client
+// connections of CERVER_HANDLER_TYPE_POLL, CERVER_HANDLER_TYPE_EPOLL
+// & CERVER_HANDLER_TYPE_REACTORS cervers are paused on their own,
+// any other reading thread waits until the queue has been drained
+// use a max queue depth of 0 to let the queue grow without any limit (default)
+CERVER_EXPORT void handler_set_max_queue_depth (
+	Handler *handler,
+	const size_t max_queue_depth, const HandlerOverflow overflow
+);
+
+// returns the number of jobs that are waiting in the handler's queue
+CERVER_EXPORT size_t handler_get_queue_depth (const Handler *handler);
+
+// copies the handler's stats into stats
+CERVER_EXPORT void handler_get_stats (
+	const Handler *handler, HandlerStats *stats
+);
+
+CERVER_EXPORT void handler_print_stats (const Handler *handler);
+
+// pushes the jobs to the handler's queue using its overflow policy
+// jobs that are not pushed get deleted alongside their packets
+// returns the number of jobs that were dropped
+CERVER_PRIVATE unsigned int handler_push_jobs (
+	Handler *handler, void **jobs, const unsigned int n_jobs
+);
+
+// works as handler_push_jobs () but with HANDLER_OVERFLOW_PAUSE
+// only the connection stops reading instead of waiting for the queue to drain
+// it is resumed by the handler after it has drained half of its queue
+// returns the number of jobs that were dropped
+CERVER_PRIVATE unsigned int handler_push_connection_jobs (
+	Handler *handler, struct _Connection *connection,
+	void **jobs, const unsigned int n_jobs
+);
+
+// returns true if the connection has stopped reading
+// because its handler's queue is full
+CERVER_PRIVATE bool handler_connection_is_paused (
+	const struct _Connection *connection
+);
+
+// removes the connection from its handler's paused connections
+// must be called before the connection is unregistered from the cerver
+CERVER_PRIVATE void handler_connection_unpause (
+	struct _Connection *connection
+);
+
 // starts the new handler by creating a dedicated thread for it
 // called by internal cerver methods
 CERVER_PRIVATE int handler_start (Handler *handler);
@@ -212,10 +350,37 @@ typedef struct CerverReceive {
 
 	struct _Lobby *lobby;
 
+	// the sock fd's generation in the cerver's fd table
+	// used to check that the connection was not dropped while handling it
+	u32 generation;
+
 } CerverReceive;
 
+CERVER_PRIVATE CerverReceive *cerver_receive_new (void);
+
 CERVER_PRIVATE void cerver_receive_delete (void *ptr);
 
+// clears the receive's values so it can be used again
+CERVER_PRIVATE void cerver_receive_reset (CerverReceive *cr);
+
+// sets the receive's values by searching the sock fd's connection
+// used to reuse the same receive for every event in a loop
+// without allocating a new one each time
+CERVER_PRIVATE void cerver_receive_init (
+	CerverReceive *cr,
+	ReceiveType receive_type,
+	struct _Cerver *cerver,
+	const i32 sock_fd
+);
+
+// sets the receive's values using the matching connection
+CERVER_PRIVATE void cerver_receive_init_full (
+	CerverReceive *cr,
+	ReceiveType receive_type,
+	struct _Cerver *cerver,
+	struct _Client *client, struct _Connection *connection
+);
+
 CERVER_PRIVATE CerverReceive *cerver_receive_create (
 	ReceiveType receive_type,
 	struct _Cerver *cerver,
@@ -249,8 +414,19 @@ CERVER_PRIVATE u8 cerver_register_new_connection_normal_default_select_handler (
 	struct _Client *client, struct _Connection *connection
 );
 
+// adds or removes the read interest of a connection
+// that is registered to a CERVER_HANDLER_TYPE_POLL, CERVER_HANDLER_TYPE_EPOLL
+// or CERVER_HANDLER_TYPE_REACTORS cerver
+// returns 0 on success, 1 on error
+CERVER_PRIVATE u8 cerver_handler_connection_set_reading (
+	struct _Cerver *cerver, struct _Connection *connection, const bool reading
+);
+
 // select how a connection will be handled
 // based on cerver's handler type
+// connections with a send queue are only allowed
+// with CERVER_HANDLER_TYPE_EPOLL, CERVER_HANDLER_TYPE_REACTORS
+// & CERVER_HANDLER_TYPE_IO_URING, any other handler discards it
 // returns 0 on success, 1 on error
 CERVER_PRIVATE u8 cerver_handler_register_connection (
 	struct _Cerver *cerver,
@@ -262,6 +438,7 @@ CERVER_PRIVATE u8 cerver_handler_register_connection (
 #pragma region poll
 
 // reallocs main cerver poll fds
+// must only be called by the poll thread while it is not inside poll ()
 // returns 0 on success, 1 on error
 CERVER_PRIVATE u8 cerver_realloc_main_poll_fds (
 	struct _Cerver *cerver
@@ -279,12 +456,15 @@ CERVER_PRIVATE i32 cerver_poll_get_idx_by_sock_fd (
 
 // regsiters a client connection to the cerver's mains poll structure
 // and maps the sock fd to the client
+// if the poll array is full, the sock fd is registered by the poll thread
+// after it has grown the array in its next loop
 // returns 0 on success, 1 on error
 CERVER_PRIVATE u8 cerver_poll_register_connection (
 	struct _Cerver *cerver, struct _Connection *connection
 );
 
 // removes a sock fd from the cerver's main poll array
+// its slot is freed right away but it is compacted by the poll thread
 // returns 0 on success, 1 on error
 CERVER_PRIVATE u8 cerver_poll_unregister_sock_fd (
 	struct _Cerver *cerver, const i32 sock_fd
@@ -301,6 +481,290 @@ CERVER_PRIVATE u8 cerver_poll (struct _Cerver *cerver);
 
 #pragma endregion
 
+#pragma region epoll
+
+// creates the cerver's epoll instance
+// returns 0 on success, 1 on error
+CERVER_PRIVATE u8 cerver_epoll_init (struct _Cerver *cerver);
+
+// closes the cerver's epoll instance
+CERVER_PRIVATE void cerver_epoll_end (struct _Cerver *cerver);
+
+// registers a client connection to the cerver's epoll instance
+// using its sock fd & its fd table generation as the event's data
+// the connection must have already been registered to the cerver
+// returns 0 on success, 1 on error
+CERVER_PRIVATE u8 cerver_epoll_register_connection (
+	struct _Cerver *cerver, struct _Connection *connection
+);
+
+// removes a client connection from the cerver's epoll instance
+// returns 0 on success, 1 on error
+CERVER_PRIVATE u8 cerver_epoll_unregister_connection (
+	struct _Cerver *cerver, struct _Connection *connection
+);
+
+// server epoll loop to handle events in the registered connections
+// using edge-triggered notifications
+CERVER_PRIVATE u8 cerver_epoll (struct _Cerver *cerver);
+
+#pragma endregion
+
+#pragma region reactors
+
+// each reactor keeps its own stats so they can be
+// updated without contention with the other reactors
+typedef struct CerverReactorStats {
+
+	u64 current_active_client_connections;  // connections currently handled by the reactor
+	u64 total_client_connections;           // all the connections handed to the reactor
+	u64 n_wakeups;                          // times epoll_wait () returned with events
+	u64 n_events;                           // total events handled
+	u64 bytes_received;                     // bytes received by the reactor
+
+} CerverReactorStats;
+
+// an independent event loop with its own epoll instance
+// the cerver's acceptor hands new connections to each reactor
+// in a round-robin fashion by writing them into its pipe
+struct _CerverReactor {
+
+	unsigned int id;
+	pthread_t thread_id;
+	bool running;
+
+	int cpu;                            // -1 to use the cerver's affinity
+	ThreadAffinity affinity;            // resolved when the reactor starts
+
+	int epoll_fd;
+	int pending_fds[2];                 // pipe used to receive new connections
+
+	char *packet_buffer;
+
+	struct _Cerver *cerver;
+
+	// protects the stats that can be updated
+	// from outside the reactor's thread
+	pthread_mutex_t *lock;
+	CerverReactorStats stats;
+
+};
+
+typedef struct _CerverReactor CerverReactor;
+
+CERVER_PRIVATE CerverReactor *cerver_reactor_new (void);
+
+CERVER_PRIVATE void cerver_reactor_delete (void *reactor_ptr);
+
+// creates the cerver's reactors structures
+// the reactors will be started when the cerver starts
+// returns 0 on success, 1 on error
+CERVER_PRIVATE u8 cerver_reactors_create (
+	struct _Cerver *cerver, unsigned int n_reactors
+);
+
+// stops every reactor thread & cleans up their structures
+CERVER_PRIVATE void cerver_reactors_end (struct _Cerver *cerver);
+
+// registers a client connection to its reactor's epoll instance
+// using its sock fd & its fd table generation as the event's data
+// the connection must have already been registered to the cerver
+// if the connection has no reactor, the next one will be used
+// returns 0 on success, 1 on error
+CERVER_PRIVATE u8 cerver_reactors_register_connection (
+	struct _Cerver *cerver, struct _Connection *connection
+);
+
+// removes a client connection from its reactor's epoll instance
+// returns 0 on success, 1 on error
+CERVER_PRIVATE u8 cerver_reactors_unregister_connection (
+	struct _Cerver *cerver, struct _Connection *connection
+);
+
+// starts the reactors threads & accepts new connections
+// handing them to the reactors in a round-robin fashion
+CERVER_PRIVATE u8 cerver_reactors (struct _Cerver *cerver);
+
+#pragma endregion
+
+#pragma region udp
+
+#define CERVER_UDP_PEERS_HTAB_SIZE					1024
+
+typedef struct CerverUdpStats {
+
+	u64 n_receive_batches;              // calls to recvmmsg () that returned datagrams
+	u64 n_datagrams_received;
+	u64 n_datagrams_truncated;          // bigger than the cerver's receive buffer size
+	u64 n_send_batches;                 // calls to sendmmsg ()
+	u64 n_datagrams_sent;
+
+	u64 current_peers;
+	u64 total_peers;
+	u64 n_peers_timeout;                // peers removed after being idle
+	u64 n_peers_refused;                // new peers ignored after reaching udp_max_peers
+
+} CerverUdpStats;
+
+// the state of a cerver using PROTOCOL_UDP
+// datagrams are received & sent in batches using recvmmsg () & sendmmsg ()
+// each peer address is mapped to a client with a single connection
+// that references the cerver's socket & the peer's address
+struct _CerverUdp {
+
+	pthread_t thread_id;                // the thread that runs the udp loop
+
+	unsigned int batch_size;
+	size_t buffer_size;
+
+	char *buffers;
+	struct iovec *iovecs;
+	struct sockaddr_storage *addresses;
+	struct mmsghdr *msgs;
+
+	// responses from the udp loop thread are sent together
+	// after handling every received datagram
+	unsigned int n_send;
+	char *send_buffers;
+	struct iovec *send_iovecs;
+	struct sockaddr_storage *send_addresses;
+	struct mmsghdr *send_msgs;
+
+	Htab *peers;                        // CerverUdpPeerKey -> client
+	DoubleList *peers_list;             // used to check for idle peers
+	time_t last_sweep;
+
+	CerverUdpStats stats;
+
+};
+
+typedef struct _CerverUdp CerverUdp;
+
+CERVER_PRIVATE CerverUdp *cerver_udp_new (void);
+
+CERVER_PRIVATE void cerver_udp_delete (void *udp_ptr);
+
+// removes every udp peer & deletes the cerver's udp structures
+CERVER_PRIVATE void cerver_udp_end (struct _Cerver *cerver);
+
+// sends a packet to the connection's address
+// if it is called from the udp loop thread,
+// the packet will be sent with the rest of the batch
+// returns 0 on success, 1 on error
+CERVER_PRIVATE u8 cerver_udp_send (
+	struct _Cerver *cerver, struct _Connection *connection,
+	const char *data, const size_t data_size, const int flags
+);
+
+// receives datagrams in batches & handles their packets
+// using each peer's own client & connection
+CERVER_PRIVATE u8 cerver_udp (struct _Cerver *cerver);
+
+#pragma endregion
+
+#pragma region io_uring
+
+#define CERVER_URING_ENTRIES						1024
+#define CERVER_URING_N_BUFFERS						512
+#define CERVER_URING_BUFFERS_GROUP					0
+
+typedef struct CerverUringStats {
+
+	u64 n_submits;                      // calls to io_uring_enter () that submitted sqes
+	u64 n_completions;                  // cqes that have been handled
+
+	u64 n_accepts;                      // connections accepted by the multishot accept
+	u64 n_receives;                     // receive cqes with data
+	u64 bytes_received;
+	u64 n_sends;                        // send cqes
+	u64 bytes_sent;
+
+	u64 n_no_buffers;                   // receives that found no provided buffer
+	u64 n_rearms;                       // multishot requests that had to be submitted again
+
+} CerverUringStats;
+
+// references a connection from the requests in the ring
+// it is kept alive until every one of its requests has completed
+// even if the connection has already been removed
+struct _CerverUringConnection {
+
+	struct _Connection *connection;     // NULL once it has been unregistered
+	struct _CerverUring *owner;
+	unsigned int refs;                  // registration + requests in the ring
+
+	// the send in flight uses the connection's send queue buffer
+	struct msghdr msg;
+	struct iovec iov[2];
+
+	struct _CerverUringConnection *prev;
+	struct _CerverUringConnection *next;
+
+};
+
+typedef struct _CerverUringConnection CerverUringConnection;
+
+// used when handler type is CERVER_HANDLER_TYPE_IO_URING
+// connections are accepted with a multishot accept
+// & their data is received with multishot receives into provided buffers
+// responses are sent from each connection's send queue
+struct _CerverUring {
+
+	struct _Uring *ring;
+	struct _UringBufRing *buffers;
+
+	// any thread can get & submit sqes, but only
+	// the ring thread handles the completions
+	pthread_mutex_t *lock;
+	pthread_t thread_id;
+
+	CerverUringConnection *connections;
+
+	CerverUringStats stats;
+
+};
+
+typedef struct _CerverUring CerverUring;
+
+CERVER_PRIVATE CerverUring *cerver_uring_new (void);
+
+CERVER_PRIVATE void cerver_uring_delete (void *uring_ptr);
+
+// creates the cerver's io_uring instance & its provided buffers
+// returns 0 on success, 1 if io_uring is not available
+// in that case, the cerver should use CERVER_HANDLER_TYPE_EPOLL instead
+CERVER_PRIVATE u8 cerver_uring_init (struct _Cerver *cerver);
+
+// closes the cerver's io_uring instance
+// any pending request gets cancelled
+CERVER_PRIVATE void cerver_uring_end (struct _Cerver *cerver);
+
+// starts receiving the connection's data with a multishot receive
+// the connection always gets a send queue to be flushed by the ring
+// returns 0 on success, 1 on error
+CERVER_PRIVATE u8 cerver_uring_register_connection (
+	struct _Cerver *cerver, struct _Connection *connection
+);
+
+// cancels the connection's requests in the ring
+// returns 0 on success, 1 on error
+CERVER_PRIVATE u8 cerver_uring_unregister_connection (
+	struct _Cerver *cerver, struct _Connection *connection
+);
+
+// submits a send with the connection's pending data
+// if there is no other send in flight
+// must be called with the connection's send queue mutex locked
+CERVER_PRIVATE void cerver_uring_send_queue_flush (
+	struct _Connection *connection
+);
+
+// server io_uring loop to handle the completions
+// of the accept, receive & send requests
+CERVER_PRIVATE u8 cerver_uring (struct _Cerver *cerver);
+
+#pragma endregion
+
 #pragma region threads
 
 // handle new connections in dedicated threads
@@ -8,6 +8,8 @@
 #include "cerver/config.h"
 #include "cerver/network.h"
 
+#include "cerver/collections/dlist.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -83,6 +85,16 @@ CERVER_PUBLIC void packet_version_print (
 #define PACKETS_MAX_TYPES					16
 #define PACKETS_CURRENT_TYPES				10
 
+// types that don't fit in the packets per type table
+#define PACKETS_UNKNOWN_TYPE				(PACKETS_MAX_TYPES - 1)
+
+// app packets request types that are counted by themselves
+// bigger request types share the last counter
+#define PACKETS_MAX_REQUEST_TYPES			32
+
+// the packets per type tables start in their own cache line
+#define PACKETS_CACHE_LINE					64
+
 #define PACKET_TYPE_MAP(XX)					\
 	XX(0, 	NONE)							\
 	XX(1, 	CERVER)							\
@@ -106,23 +118,15 @@ typedef enum PacketType {
 
 } PacketType;
 
+// packets counters indexed by their PacketType
+// app packets are also counted by their request type
+// to be able to tell which of them are the most used
 struct _PacketsPerType {
 
-	u64 n_cerver_packets;
-	u64 n_client_packets;
-	u64 n_error_packets;
-	u64 n_request_packets;
-	u64 n_auth_packets;
-	u64 n_game_packets;
-	u64 n_app_packets;
-	u64 n_app_error_packets;
-	u64 n_custom_packets;
-	u64 n_test_packets;
-	u64 n_unknown_packets;
+	u64 packets[PACKETS_MAX_TYPES];
+	u64 app_requests[PACKETS_MAX_REQUEST_TYPES];
 
-	u64 n_bad_packets;
-
-};
+} CERVER_ATTRS ((aligned (PACKETS_CACHE_LINE)));
 
 typedef struct _PacketsPerType PacketsPerType;
 
@@ -132,6 +136,37 @@ CERVER_PUBLIC void packets_per_type_delete (
 	void *packets_per_type_ptr
 );
 
+// adds value to a stats counter without loosing updates
+// when the same counter is updated from multiple threads
+#define STATS_ADD(counter, value)			\
+	(void) __atomic_add_fetch (&(counter), (value), __ATOMIC_RELAXED)
+
+#define STATS_SUB(counter, value)			\
+	(void) __atomic_sub_fetch (&(counter), (value), __ATOMIC_RELAXED)
+
+#define STATS_GET(counter)					\
+	__atomic_load_n (&(counter), __ATOMIC_RELAXED)
+
+// increments the counter that matches the packet type
+// & the request type counter if it is an app packet
+// types bigger than the table are counted as unknown
+// can be safely called from multiple threads
+CERVER_PUBLIC void packets_per_type_count (
+	PacketsPerType *packets_per_type,
+	const PacketType packet_type, const u32 request_type
+);
+
+// increments the bad packets counter
+// can be safely called from multiple threads
+CERVER_PUBLIC void packets_per_type_count_bad (
+	PacketsPerType *packets_per_type
+);
+
+// adds every counter in source to the ones in dest
+CERVER_PUBLIC void packets_per_type_add (
+	PacketsPerType *dest, const PacketsPerType *source
+);
+
 CERVER_PUBLIC void packets_per_type_print (
 	const PacketsPerType *packets_per_type
 );
@@ -190,6 +225,40 @@ CERVER_PUBLIC void packet_header_log (
 
 #pragma endregion
 
+#pragma region pool
+
+// size classes (in bytes) of the pool's data buffers
+// buffers bigger than the last class are allocated directly
+#define PACKETS_POOL_CLASS_MAP(XX)			\
+	XX(1,	64)								\
+	XX(2,	256)							\
+	XX(3,	1024)							\
+	XX(4,	4096)							\
+	XX(5,	65536)
+
+#define PACKETS_POOL_N_CLASSES				5
+
+// how many free items of each class a thread keeps for itself
+// half of them are moved from or to the shared pool at once
+#define PACKETS_POOL_CACHE_SIZE				64
+
+typedef struct PacketsPoolStats {
+
+	u64 hits;                           // requests served with a free item
+	u64 misses;                         // requests that had to allocate a new item
+
+} PacketsPoolStats;
+
+// gets the packets pool's hits & misses
+// adding the values of every thread cache
+CERVER_EXPORT void packets_pool_stats (PacketsPoolStats *stats);
+
+// frees all the items in the shared pool & in the calling thread's cache
+// should be called only once at the very end of the program
+CERVER_EXPORT void packets_pool_end (void);
+
+#pragma endregion
+
 #pragma region packets
 
 #define CERVER_PACKET_TYPE_MAP(XX)			\
@@ -281,6 +350,7 @@ struct _Packet {
 	char *data_ptr;
 	char *data_end;
 	bool data_ref;
+	u8 data_class;                      // pool size class, 0 if it was not taken from the pool
 
 	// used to handle big packets
 	// that don't fit inside a single buffer
@@ -294,6 +364,11 @@ struct _Packet {
 	size_t packet_size;
 	void *packet;
 	bool packet_ref;
+	u8 packet_class;                    // pool size class, 0 if it was not taken from the pool
+
+	// used to keep the packet in intrusive lists
+	// like queues of packets that are waiting to be handled
+	ListElement link;
 
 };
 
@@ -382,6 +457,12 @@ CERVER_EXPORT u8 packet_set_data_ref (
 	Packet *packet, void *data, size_t data_size
 );
 
+// makes the packet own a copy of its data if it was set using a reference
+// packets handled with cerver zero copy packets point to the receive buffer,
+// so you must call this method to keep using the data after the handler returns
+// returns 0 on success, 1 on error
+CERVER_EXPORT u8 packet_retain (Packet *packet);
+
 // sets a packet's packet by copying the passed data, so you will be able to free your data
 // this data is expected to already contain a header, otherwise, send with raw flag
 // deletes the previuos packet's packet
@@ -440,6 +521,8 @@ CERVER_PRIVATE u8 packet_send_actual (
 
 // sends a packet using its network values
 // raw flag to send a raw packet (only the data that was set to the packet, without any header)
+// if the connection has a send queue, the packet is appended to it instead
+// and flags are ignored in favor of the connection's send flags
 // returns 0 on success, 1 on error
 CERVER_EXPORT u8 packet_send (
 	const Packet *packet, int flags, size_t *total_sent, bool raw
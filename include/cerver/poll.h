@@ -0,0 +1,91 @@
+#ifndef _CERVER_POLL_H_
+#define _CERVER_POLL_H_
+
+#include <poll.h>
+
+#include "cerver/types/types.h"
+
+#include "cerver/config.h"
+
+#define POLL_FDS_MAP_DEFAULT_SIZE				1024
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// maps sock fds to their idx in a pollfd array
+// the free slots are the range [current_n_fds, max_n_fds)
+// and work as a stack of free slots whose top is current_n_fds
+// this way, registering & unregistering a sock fd are O(1)
+// and poll () only needs to check current_n_fds entries
+// unregistered fds leave a -1 slot until the poll thread compacts
+// the array, so fds never move while poll () is setting their events
+struct _PollFdsMap {
+
+	i32 *idxs;                  // sock fd -> idx, -1 if not registered
+	u32 size;                   // max sock fd (+ 1) that can be mapped
+
+	u32 n_removed;              // freed slots waiting to be compacted
+
+};
+
+typedef struct _PollFdsMap PollFdsMap;
+
+CERVER_PRIVATE PollFdsMap *poll_fds_map_new (void);
+
+CERVER_PRIVATE void poll_fds_map_delete (void *map_ptr);
+
+// creates a new map that can hold sock fds up to size
+// the map will grow if a bigger sock fd is registered
+CERVER_PRIVATE PollFdsMap *poll_fds_map_create (const u32 size);
+
+// returns the idx of the sock fd in the pollfd array
+// returns -1 if the sock fd has not been registered
+CERVER_PRIVATE i32 poll_fds_map_get (
+	const PollFdsMap *map, const i32 sock_fd
+);
+
+// sets the slots in the range [from, to) as free slots
+CERVER_PRIVATE void poll_fds_reset (
+	struct pollfd *fds, const u32 from, const u32 to
+);
+
+// registers the sock fd in the next free slot of the pollfd array
+// returns the idx where the sock fd was placed
+// returns -1 if the pollfd array is full or on error
+CERVER_PRIVATE i32 poll_fds_register (
+	struct pollfd *fds, const u32 max_n_fds, u32 *current_n_fds,
+	PollFdsMap *map,
+	const i32 sock_fd, const short events
+);
+
+// frees the sock fd's slot without moving any other registered fd
+// so the events that poll () might be setting still match their fds
+// the slot is set to -1, which poll () ignores, and it is only
+// reused after the array has been compacted by its poll thread
+// returns the idx that the sock fd used to have
+// returns -1 if the sock fd was not registered
+CERVER_PRIVATE i32 poll_fds_unregister (
+	struct pollfd *fds, PollFdsMap *map,
+	const i32 sock_fd
+);
+
+// returns the sock fd that is registered in the slot
+// returns -1 if the slot was freed after poll () set its events
+CERVER_PRIVATE i32 poll_fds_get (const struct pollfd *fds, const u32 idx);
+
+// fills the freed slots by moving the last registered fds into them
+// must only be called by the thread that calls poll ()
+// after it has handled the events, as registered fds can change their idx
+// slots before first are never moved
+CERVER_PRIVATE void poll_fds_compact (
+	struct pollfd *fds, u32 *current_n_fds,
+	PollFdsMap *map,
+	const u32 first
+);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
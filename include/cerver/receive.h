@@ -6,6 +6,9 @@
 #include "cerver/config.h"
 #include "cerver/packets.h"
 
+// max jobs collected for a handler before pushing them
+#define RECEIVE_HANDLE_JOBS_BATCH			32
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -19,6 +22,8 @@ struct _Admin;
 
 struct _Lobby;
 
+struct _Handler;
+
 #define RECEIVE_ERROR_MAP(XX)			\
 	XX(0,	NONE,		None)			\
 	XX(1,	TIMEOUT,	Timeoout)		\
@@ -102,6 +107,16 @@ struct _ReceiveHandle {
 
 	struct _Packet *spare_packet;
 
+	// packets handled since the last time the connection was read
+	// used to check the cerver's receive budget
+	u32 n_packets;
+
+	// jobs for the same handler collected while handling a buffer
+	// they are pushed to the handler's job queue at once
+	struct _Handler *jobs_handler;
+	void *jobs[RECEIVE_HANDLE_JOBS_BATCH];
+	unsigned int n_jobs;
+
 };
 
 typedef struct _ReceiveHandle ReceiveHandle;
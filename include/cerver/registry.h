@@ -0,0 +1,193 @@
+#ifndef _CERVER_REGISTRY_H_
+#define _CERVER_REGISTRY_H_
+
+#include <stdbool.h>
+
+#include <pthread.h>
+
+#include "cerver/types/types.h"
+
+#include "cerver/config.h"
+
+#define CLIENT_REGISTRY_CACHE_LINE				64
+
+// each index is split in this many shards with their own lock
+#define CLIENT_REGISTRY_SHARDS					16
+
+// the initial number of buckets in each shard
+#define CLIENT_REGISTRY_SHARD_INIT_SIZE			16
+
+// readers are counted in different cache lines
+// so they don't write to the same one
+#define CLIENT_REGISTRY_READ_SLOTS				16
+
+// memory that was removed in an epoch can be released
+// two epochs later, so only three are kept at a time
+#define CLIENT_REGISTRY_EPOCHS					3
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct _Client;
+
+// the keys are copied into the node, so readers never need
+// to access a client that is not the one they are searching for
+struct _ClientRegistryNode {
+
+	struct _ClientRegistryNode *next;
+
+	u64 hash;
+	u64 id;
+	char *session_id;
+
+	struct _Client *client;
+
+	// used after the node has been removed
+	// to wait until it can be released
+	struct _ClientRegistryNode *retired_next;
+
+};
+
+typedef struct _ClientRegistryNode ClientRegistryNode;
+
+struct _ClientRegistryTable {
+
+	size_t size;                // a power of 2
+
+	// used after the shard has grown
+	struct _ClientRegistryTable *retired_next;
+
+	ClientRegistryNode *buckets[];
+
+};
+
+typedef struct _ClientRegistryTable ClientRegistryTable;
+
+// readers traverse the table & its buckets without the lock
+// writers link new nodes only after they are complete, and when the
+// shard grows, its nodes are copied into a new table, as the
+// previous nodes might still be in use by a reader
+struct _ClientRegistryShard {
+
+	ClientRegistryTable *table;
+	size_t count;
+
+	pthread_mutex_t lock;
+
+} CERVER_ATTRS ((aligned (CLIENT_REGISTRY_CACHE_LINE)));
+
+typedef struct _ClientRegistryShard ClientRegistryShard;
+
+struct _ClientRegistryReaders {
+
+	u64 readers[CLIENT_REGISTRY_EPOCHS];
+
+} CERVER_ATTRS ((aligned (CLIENT_REGISTRY_CACHE_LINE)));
+
+typedef struct _ClientRegistryReaders ClientRegistryReaders;
+
+// the cerver's clients, indexed by their id & by their session id
+// lookups & iterations never take a lock: readers mark the epoch
+// they started in, and removed nodes, tables & retired clients
+// are only released after every reader that might have seen them has finished
+struct _ClientRegistry {
+
+	ClientRegistryShard ids[CLIENT_REGISTRY_SHARDS];
+	ClientRegistryShard sessions[CLIENT_REGISTRY_SHARDS];
+
+	size_t count;
+
+	u64 epoch;
+	ClientRegistryReaders readers[CLIENT_REGISTRY_READ_SLOTS];
+
+	// memory that is waiting for the readers of its epoch
+	pthread_mutex_t *retired_lock;
+	ClientRegistryNode *retired_nodes[CLIENT_REGISTRY_EPOCHS];
+	ClientRegistryTable *retired_tables[CLIENT_REGISTRY_EPOCHS];
+	struct _Client *retired_clients[CLIENT_REGISTRY_EPOCHS];
+
+	// called for every client when the registry is deleted
+	// & for every retired client when it is released
+	void (*delete_client)(void *client_ptr);
+
+};
+
+typedef struct _ClientRegistry ClientRegistry;
+
+// deletes the registry & every client that is still inside it
+// using the registry's delete client method
+CERVER_PRIVATE void client_registry_delete (void *registry_ptr);
+
+// creates a new registry
+// delete_client - method to delete the clients when the registry is deleted,
+// NULL to keep them
+CERVER_PRIVATE ClientRegistry *client_registry_create (
+	void (*delete_client)(void *client_ptr)
+);
+
+// returns the number of clients inside the registry
+CERVER_PRIVATE size_t client_registry_size (
+	const ClientRegistry *registry
+);
+
+// adds the client to the ids index, and to the sessions index
+// if it has a session id
+// returns 0 on success, 1 on error or if its id has already been registered
+CERVER_PRIVATE u8 client_registry_insert (
+	ClientRegistry *registry, struct _Client *client
+);
+
+// removes the client from both indexes
+// returns the client on success, NULL if it was not registered
+CERVER_PRIVATE struct _Client *client_registry_remove (
+	ClientRegistry *registry, struct _Client *client
+);
+
+// deletes a client that has been removed from the registry
+// using the registry's delete client method
+// after every reader that might have found it has finished
+CERVER_PRIVATE void client_registry_retire_client (
+	ClientRegistry *registry, struct _Client *client
+);
+
+// marks the start of a read in the current epoch
+// returns a token that must be passed to client_registry_read_end ()
+CERVER_PRIVATE unsigned int client_registry_read_start (
+	ClientRegistry *registry
+);
+
+// marks the end of a read started with client_registry_read_start ()
+CERVER_PRIVATE void client_registry_read_end (
+	ClientRegistry *registry, const unsigned int token
+);
+
+// returns the client with the matching id
+// the client can only be used until client_registry_read_end ()
+// if the lookup was done inside a read
+// returns NULL if no client was found
+CERVER_PRIVATE struct _Client *client_registry_get_by_id (
+	ClientRegistry *registry, const u64 id
+);
+
+// returns the client with the matching session id
+// the client can only be used until client_registry_read_end ()
+// if the lookup was done inside a read
+// returns NULL if no client was found
+CERVER_PRIVATE struct _Client *client_registry_get_by_session_id (
+	ClientRegistry *registry, const char *session_id
+);
+
+// calls the method with every client in the registry without taking any lock
+// clients that are added or removed meanwhile might not be visited,
+// but the visited ones are not deleted until the method returns
+CERVER_PRIVATE void client_registry_for_each (
+	ClientRegistry *registry,
+	void (*method)(struct _Client *client, void *args), void *args
+);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,165 @@
+#ifndef _CERVER_SEND_H_
+#define _CERVER_SEND_H_
+
+#include <stddef.h>
+#include <stdbool.h>
+
+#include <pthread.h>
+
+#include <sys/uio.h>
+
+#include "cerver/types/types.h"
+
+#include "cerver/config.h"
+
+#define SEND_QUEUE_DEFAULT_SIZE				16384
+#define SEND_QUEUE_DEFAULT_HIGH_WATER		1048576
+#define SEND_QUEUE_DEFAULT_OVERFLOW			SEND_QUEUE_OVERFLOW_EVENT
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// what happens when a send queue reaches its high water mark
+#define SEND_QUEUE_OVERFLOW_MAP(XX)			\
+	XX(0,	EVENT,		Event)				\
+	XX(1,	DROP,		Drop)
+
+typedef enum SendQueueOverflow {
+
+	#define XX(num, name, string) SEND_QUEUE_OVERFLOW_##name = num,
+	SEND_QUEUE_OVERFLOW_MAP (XX)
+	#undef XX
+
+} SendQueueOverflow;
+
+CERVER_PUBLIC const char *send_queue_overflow_to_string (
+	const SendQueueOverflow overflow
+);
+
+#define SEND_QUEUE_FLUSH_MAP(XX)			\
+	XX(0,	DONE,		Done)				\
+	XX(1,	PENDING,	Pending)			\
+	XX(2,	FAILED,		Failed)
+
+typedef enum SendQueueFlush {
+
+	#define XX(num, name, string) SEND_QUEUE_FLUSH_##name = num,
+	SEND_QUEUE_FLUSH_MAP (XX)
+	#undef XX
+
+} SendQueueFlush;
+
+CERVER_PUBLIC const char *send_queue_flush_to_string (
+	const SendQueueFlush flush
+);
+
+typedef struct SendQueueStats {
+
+	u64 n_packets;                  // packets that have been queued
+	u64 n_writes;                   // calls to sendmsg () to flush the queue
+	u64 bytes_written;              // bytes that have been flushed
+	u64 n_overflows;                // times the high water mark was reached
+	size_t max_pending;             // max bytes that have been waiting in the queue
+
+} SendQueueStats;
+
+// a ring buffer with the bytes waiting to be sent to a socket
+// packets are appended without blocking & flushed together
+// using a single sendmsg () call when the socket is writable
+// head & tail only grow, the buffer's size is always a power of two
+struct _SendQueue {
+
+	char *buffer;
+	size_t size;
+
+	size_t head;                    // bytes that have been sent
+	size_t tail;                    // bytes that have been queued
+
+	// 0 to let the queue grow without any limit
+	size_t high_water;
+	SendQueueOverflow overflow;
+	bool overflowed;                // set until the queue has been flushed
+	bool closed;                    // new data is discarded after a drop
+
+	// set while the queue's owner is going to flush it anyway
+	// so appended data is not flushed right away
+	bool corked;
+
+	// a dedicated thread is waiting for data to flush
+	bool threaded;
+	bool running;
+
+	// the pending bytes at the head have been handed to an asynchronous send
+	// if the buffer grows meanwhile, the old one is retired until it completes
+	bool in_flight;
+	char *retired;
+
+	pthread_mutex_t *mutex;
+	pthread_cond_t *has_data;
+
+	SendQueueStats stats;
+
+};
+
+typedef struct _SendQueue SendQueue;
+
+CERVER_PRIVATE SendQueue *send_queue_new (void);
+
+CERVER_PRIVATE void send_queue_delete (void *send_queue_ptr);
+
+// creates a new send queue with an initial buffer of at least size bytes
+// returns a new send queue on success, NULL on error
+CERVER_PRIVATE SendQueue *send_queue_create (
+	const size_t size,
+	const size_t high_water, const SendQueueOverflow overflow
+);
+
+// discards any queued data & clears the queue's state
+// the queue's buffer is kept to be used again
+CERVER_PRIVATE void send_queue_reset (SendQueue *queue);
+
+// returns the number of bytes that are waiting to be sent
+CERVER_PUBLIC size_t send_queue_pending (const SendQueue *queue);
+
+// the following methods must be called with the queue's mutex locked
+
+// copies the buffers at the end of the queue as a single piece
+// grows the queue's buffer if it is needed
+// high_water is set if this append made the queue reach its high water mark
+// with SEND_QUEUE_OVERFLOW_DROP, the data is discarded & the queue gets closed
+// returns 0 on success, 1 if the data was NOT queued
+CERVER_PRIVATE u8 send_queue_append (
+	SendQueue *queue,
+	const struct iovec *iov, const int iovcnt,
+	bool *high_water
+);
+
+// sends as many queued bytes as possible to the socket without blocking
+// using up to two iovecs in a single sendmsg () call
+// returns SEND_QUEUE_FLUSH_DONE once the queue is empty,
+// SEND_QUEUE_FLUSH_PENDING if the socket can't take more data
+// and SEND_QUEUE_FLUSH_FAILED on a socket error
+CERVER_PRIVATE SendQueueFlush send_queue_flush (
+	SendQueue *queue, const int sock_fd, const int flags
+);
+
+// sets iov with the pending bytes for an asynchronous send
+// the bytes stay in the queue until send_queue_complete () gets called
+// returns the number of iovecs that were set, 0 if there is nothing to send
+// or if there is already a send in flight
+CERVER_PRIVATE int send_queue_begin (
+	SendQueue *queue, struct iovec iov[2]
+);
+
+// marks the send in flight as completed with sent bytes
+// the rest of the bytes are kept to be sent again
+CERVER_PRIVATE void send_queue_complete (
+	SendQueue *queue, const size_t sent
+);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
\ No newline at end of file
@@ -14,6 +14,10 @@
 
 #define JOB_QUEUE_POOL_INIT				16
 
+#define JOB_QUEUE_RING_CAPACITY			4096
+
+#define JOB_QUEUE_CACHE_LINE			64
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -29,6 +33,10 @@ typedef struct Job {
 	void (*work) (void *args);
 	void *args;
 
+	u64 timestamp;              // when the job was queued (ns)
+
+	ListElement link;           // keeps the job inside a jobs queue
+
 } Job;
 
 CERVER_PUBLIC void *job_new (void);
@@ -91,7 +99,8 @@ CERVER_PUBLIC void job_handler_wait (
 #define JOB_QUEUE_TYPE_MAP(XX)				\
 	XX(0,	NONE, 		None)				\
 	XX(1,	JOBS, 		Jobs)				\
-	XX(2,	HANDLERS, 	Handlers)
+	XX(2,	HANDLERS, 	Handlers)			\
+	XX(3,	RING, 		Ring)
 
 typedef enum JobQueueType {
 
@@ -101,6 +110,42 @@ typedef enum JobQueueType {
 
 } JobQueueType;
 
+// a cell in the job queue ring
+// its sequence tells producers & consumers if it can be used
+typedef struct JobQueueCell {
+
+	size_t sequence;
+	void *data;
+
+} JobQueueCell;
+
+// bounded multi producers & multi consumers ring of jobs
+// used by JOB_QUEUE_TYPE_RING queues
+// positions are kept in their own cache lines
+// so producers & consumers don't invalidate each other
+typedef struct JobQueueRing {
+
+	JobQueueCell *cells;
+	size_t mask;
+
+	char pad_0[JOB_QUEUE_CACHE_LINE];
+
+	size_t enqueue_pos;
+
+	char pad_1[JOB_QUEUE_CACHE_LINE];
+
+	size_t dequeue_pos;
+
+	char pad_2[JOB_QUEUE_CACHE_LINE];
+
+	// idle consumers are parked in a futex on this word
+	unsigned int futex;
+	unsigned int sleepers;
+	unsigned int waking;
+	unsigned int signaled;
+
+} JobQueueRing;
+
 struct _JobQueue {
 
 	JobQueueType type;
@@ -108,6 +153,7 @@ struct _JobQueue {
 	Pool *pool;
 
 	DoubleList *queue;
+	JobQueueRing *ring;
 
 	pthread_mutex_t *rwmutex;		// used for queue r/w access
 	bsem *has_jobs;
@@ -132,16 +178,31 @@ CERVER_PUBLIC JobQueue *job_queue_create (
 	const JobQueueType type
 );
 
+// creates a new job queue with a custom capacity
+// that is only used by JOB_QUEUE_TYPE_RING queues
+// the capacity is rounded up to the next power of two
+CERVER_PUBLIC JobQueue *job_queue_create_with_capacity (
+	const JobQueueType type, const size_t capacity
+);
+
 CERVER_PUBLIC void job_queue_set_handler (
 	JobQueue *queue, void (*handler) (void *data)
 );
 
 // adds a new job to the queue
+// JOB_QUEUE_TYPE_JOBS queues link their data using the Job's link
+// so they only accept a Job, see job_queue_push_existing_job ()
 // returns 0 on success, 1 on error
 CERVER_PUBLIC unsigned int job_queue_push (
 	JobQueue *job_queue, void *job_ptr
 );
 
+// adds a job created with job_new () or job_create () to the queue
+// returns 0 on success, 1 on error
+CERVER_PUBLIC unsigned int job_queue_push_existing_job (
+	JobQueue *job_queue, Job *job
+);
+
 // creates & adds a new job to the queue
 // returns 0 on success, 1 on error
 CERVER_PUBLIC unsigned int job_queue_push_job (
@@ -149,6 +210,15 @@ CERVER_PUBLIC unsigned int job_queue_push_job (
 	void (*work) (void *args), void *args
 );
 
+// adds n jobs to the queue using a single lock & wakeup
+// JOB_QUEUE_TYPE_JOBS queues only accept Job structures
+// returns the number of jobs that were added
+// the remaining ones still belong to the caller
+CERVER_PUBLIC unsigned int job_queue_push_batch (
+	JobQueue *job_queue, void **jobs, const unsigned int n_jobs
+);
+
+// JOB_QUEUE_TYPE_RING queues don't support requests by id
 CERVER_PUBLIC unsigned int job_queue_push_job_with_id (
 	JobQueue *job_queue,
 	const u64 job_id,
@@ -167,6 +237,16 @@ CERVER_PUBLIC unsigned int job_queue_push_handler (
 // get the job at the start of the queue
 CERVER_PUBLIC void *job_queue_pull (JobQueue *job_queue);
 
+// gets up to max_jobs from the start of the queue
+// using a single lock
+// returns the number of jobs that were placed in jobs
+CERVER_PUBLIC unsigned int job_queue_pull_batch (
+	JobQueue *job_queue, void **jobs, const unsigned int max_jobs
+);
+
+// returns the number of jobs that are waiting in the queue
+CERVER_PUBLIC size_t job_queue_size (JobQueue *job_queue);
+
 // requests to get an specific job from the queue by matching id
 // blocks and waits until the requested job is available
 CERVER_PUBLIC void *job_queue_request (
@@ -181,6 +261,9 @@ CERVER_PUBLIC void job_queue_wait (JobQueue *job_queue);
 // signal a job queue
 CERVER_PUBLIC void job_queue_signal (JobQueue *job_queue);
 
+// signal every thread that is waiting on the job queue
+CERVER_PUBLIC void job_queue_signal_all (JobQueue *job_queue);
+
 CERVER_PUBLIC unsigned int job_queue_stop (JobQueue *job_queue);
 
 // clears the job queue -> destroys all jobs
@@ -5,16 +5,31 @@
 #include <pthread.h>
 
 #include "cerver/config.h"
+
+#include "cerver/types/types.h"
+
 #include "cerver/threads/jobs.h"
+#include "cerver/threads/thread.h"
 
 #define THPOOL_NAME_SIZE		64
 
+#define THPOOL_DEQUE_SIZE		256
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 struct _PoolThread;
 
+// stats that every pool thread keeps about itself
+typedef struct ThpoolThreadStats {
+
+	u64 executed;			// jobs executed by the thread
+	u64 stolen;				// jobs taken from other threads deques
+	u64 idle_time;			// time spent waiting for jobs (ns)
+
+} ThpoolThreadStats;
+
 typedef struct Thpool {
 
 	size_t namelen;
@@ -29,9 +44,19 @@ typedef struct Thpool {
 
 	pthread_mutex_t *mutex;
 	pthread_cond_t *threads_all_idle;
+	pthread_cond_t *threads_alive;      // signaled when a thread starts or ends
 
+	// with work stealing, this is the injector queue
+	// that receives jobs from outside the thpool
 	JobQueue *job_queue;
 
+	bool work_stealing;
+	volatile unsigned int num_threads_sleeping;
+	volatile unsigned int num_jobs_pending;
+
+	// the cpus where the threads run
+	ThreadAffinity affinity;
+
 } Thpool;
 
 // creates a new thpool with n threads
@@ -47,6 +72,22 @@ CERVER_EXPORT void thpool_set_name (
 	Thpool *thpool, const char *name
 );
 
+// enables work stealing between the thpool's threads
+// every thread gets its own deque where the jobs added
+// from inside the thpool are placed, jobs from outside are placed
+// in a global injector queue, and idle threads steal from the others
+// must be called before thpool_init ()
+CERVER_EXPORT void thpool_set_work_stealing (
+	Thpool *thpool, bool work_stealing
+);
+
+// sets the cpus where the thpool's threads will run
+// every thread uses its id as its idx for spread & compact affinities
+// must be called before thpool_init ()
+CERVER_EXPORT void thpool_set_affinity (
+	Thpool *thpool, const ThreadAffinity *affinity
+);
+
 // gets the current number of threads
 // that are alive (running) in the thpool
 CERVER_EXPORT unsigned int thpool_get_num_threads_alive (
@@ -74,6 +115,13 @@ CERVER_EXPORT int thpool_add_work (
 // wait until all jobs have finished
 CERVER_EXPORT void thpool_wait (Thpool *thpool);
 
+// copies the stats of the thread with the matching id
+// returns 0 on success, 1 on error
+CERVER_EXPORT unsigned int thpool_get_thread_stats (
+	const Thpool *thpool, const unsigned int thread_id,
+	ThpoolThreadStats *stats
+);
+
 // destroys the thpool and deletes all of its data
 CERVER_EXPORT void thpool_destroy (Thpool *thpool);
 
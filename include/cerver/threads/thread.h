@@ -2,6 +2,7 @@
 #define _CERVER_THREADS_H_
 
 #include <pthread.h>
+#include <sched.h>
 
 #include "cerver/types/types.h"
 
@@ -11,6 +12,8 @@
 
 #define THREAD_NAME_BUFFER_SIZE			64
 
+#define THREAD_AFFINITY_MAX_CPUS		CPU_SETSIZE
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -31,6 +34,82 @@ CERVER_PUBLIC unsigned int thread_set_name (
 
 #pragma endregion
 
+#pragma region affinity
+
+#define THREAD_AFFINITY_MAP(XX)																	\
+	XX(0,	NONE,		None,		Threads are not pinned to any cpu)								\
+	XX(1,	CPUS,		Cpus,		Threads are pinned to an explicit set of cpus)					\
+	XX(2,	SPREAD,		Spread,		Each thread is pinned to a cpu in the next numa node)			\
+	XX(3,	COMPACT,	Compact,	Each thread is pinned to the next cpu in the same numa node)
+
+typedef enum ThreadAffinityType {
+
+	#define XX(num, name, string, description) THREAD_AFFINITY_##name = num,
+	THREAD_AFFINITY_MAP (XX)
+	#undef XX
+
+} ThreadAffinityType;
+
+CERVER_PUBLIC const char *thread_affinity_type_to_string (
+	const ThreadAffinityType type
+);
+
+CERVER_PUBLIC const char *thread_affinity_type_description (
+	const ThreadAffinityType type
+);
+
+// where a group of threads should run
+// with THREAD_AFFINITY_CPUS every thread can run in any of the cpus
+// with spread & compact, every thread gets its own cpu based on
+// its idx in the group, plus the offset, that can be used
+// to keep different groups of threads in different cpus
+typedef struct ThreadAffinity {
+
+	ThreadAffinityType type;
+
+	cpu_set_t cpus;
+	unsigned int offset;
+
+} ThreadAffinity;
+
+// sets the affinity type & clears its cpus & offset
+CERVER_PUBLIC void thread_affinity_init (
+	ThreadAffinity *affinity, const ThreadAffinityType type
+);
+
+// adds a cpu to be used with THREAD_AFFINITY_CPUS
+CERVER_PUBLIC void thread_affinity_add_cpu (
+	ThreadAffinity *affinity, const int cpu
+);
+
+// returns the numa node of the cpu, 0 if it can't be found
+CERVER_PUBLIC int thread_cpu_get_node (const int cpu);
+
+// returns the cpu that matches the thread idx
+// when using spread or compact affinities, -1 on any other case
+CERVER_PUBLIC int thread_affinity_get_cpu (
+	const ThreadAffinity *affinity, const unsigned int idx
+);
+
+// sets in dest an explicit THREAD_AFFINITY_CPUS affinity
+// with the cpu that matches the thread idx in affinity
+// explicit & none affinities are copied as they are
+CERVER_PUBLIC void thread_affinity_resolve (
+	ThreadAffinity *dest,
+	const ThreadAffinity *affinity, const unsigned int idx
+);
+
+// pins the calling thread using the affinity & logs its placement
+// must be called from the thread before it allocates its own data,
+// so its memory pages are first touched in its numa node
+// returns 0 on success or if there is no affinity, 1 on error
+CERVER_PUBLIC unsigned int thread_affinity_apply (
+	const ThreadAffinity *affinity, const unsigned int idx,
+	const char *name
+);
+
+#pragma endregion
+
 #pragma region mutex
 
 // allocates & initializes a new mutex that should be deleted after use
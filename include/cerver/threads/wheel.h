@@ -0,0 +1,169 @@
+#ifndef _CERVER_THREADS_WHEEL_H_
+#define _CERVER_THREADS_WHEEL_H_
+
+#include <stdbool.h>
+
+#include <pthread.h>
+
+#include "cerver/types/types.h"
+
+#include "cerver/threads/thread.h"
+
+#include "cerver/config.h"
+
+#define TIMER_WHEEL_NAME_SIZE			64
+
+// the wheel resolution, every tick is 1 ms
+#define TIMER_WHEEL_TICK_NS				1000000
+
+// 4 levels of 64 slots cover 64^4 ticks (~4.6 hours)
+// longer timers are cascaded from the last level until they fit
+#define TIMER_WHEEL_LEVELS				4
+#define TIMER_WHEEL_SLOT_BITS			6
+#define TIMER_WHEEL_SLOTS				(1 << TIMER_WHEEL_SLOT_BITS)
+#define TIMER_WHEEL_SLOTS_MASK			(TIMER_WHEEL_SLOTS - 1)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define WHEEL_TIMER_STATE_MAP(XX)					\
+	XX(0,	NONE, 		None)						\
+	XX(1,	WAITING, 	Waiting)					\
+	XX(2,	RUNNING, 	Running)					\
+	XX(3,	CANCELLED, 	Cancelled)
+
+typedef enum WheelTimerState {
+
+	#define XX(num, name, string) WHEEL_TIMER_STATE_##name = num,
+	WHEEL_TIMER_STATE_MAP (XX)
+	#undef XX
+
+} WheelTimerState;
+
+CERVER_PUBLIC const char *wheel_timer_state_to_string (
+	const WheelTimerState state
+);
+
+struct _WheelTimer {
+
+	u64 deadline;               // absolute CLOCK_MONOTONIC time in ns
+	u64 interval;               // ns between runs, 0 for one-shot timers
+	u64 expires;                // the wheel tick that matches the deadline
+
+	Action callback;
+	void *args;
+
+	u64 runs;                   // how many times the callback was executed
+
+	WheelTimerState state;
+	bool waiting;               // someone is waiting for the callback to end
+
+	unsigned int level;
+	unsigned int slot;
+
+	struct _WheelTimer *prev;
+	struct _WheelTimer *next;
+
+};
+
+typedef struct _WheelTimer WheelTimer;
+
+// a hierarchical timing wheel driven by a timerfd
+// either its own thread sleeps until the next deadline
+// or an event loop waits for the timerfd with its other fds
+// and executes the callbacks of every expired timer
+struct _TimerWheel {
+
+	unsigned int name_len;
+	char name[TIMER_WHEEL_NAME_SIZE];
+
+	int timer_fd;
+
+	pthread_t thread_id;        // the thread that executes the callbacks
+	volatile bool running;
+	bool attached;              // driven by an event loop
+	bool handling;              // the loop is executing the expired timers
+
+	ThreadAffinity affinity;
+
+	u64 start;                  // the time in ns of the wheel's tick 0
+	u64 current;                // the last tick that has been handled
+	u64 armed;                  // the tick the timerfd is armed for
+
+	WheelTimer *slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+	unsigned int counts[TIMER_WHEEL_LEVELS];
+	unsigned int n_timers;
+
+	pthread_mutex_t *mutex;
+	pthread_cond_t *done;       // signaled when a cancelled callback
+	                            // or the loop's expired timers end
+
+};
+
+typedef struct _TimerWheel TimerWheel;
+
+// deletes the wheel & all of its timers
+// the wheel's thread gets stopped if it is still running
+CERVER_PUBLIC void timer_wheel_delete (void *wheel_ptr);
+
+// creates a new timer wheel with its own timerfd
+// returns a new wheel on success, NULL on error
+CERVER_PUBLIC TimerWheel *timer_wheel_create (void);
+
+CERVER_PUBLIC void timer_wheel_set_name (
+	TimerWheel *wheel, const char *name
+);
+
+// sets the cpus where the wheel's thread will run
+// must be called before timer_wheel_start ()
+CERVER_PUBLIC void timer_wheel_set_affinity (
+	TimerWheel *wheel, const ThreadAffinity *affinity
+);
+
+// returns the number of timers waiting in the wheel
+CERVER_PUBLIC unsigned int timer_wheel_size (TimerWheel *wheel);
+
+// starts the thread that executes the timers callbacks
+// returns 0 on success, 1 on error
+CERVER_PUBLIC unsigned int timer_wheel_start (TimerWheel *wheel);
+
+// lets an event loop drive the wheel instead of its own thread
+// the loop must wait for the returned timerfd to be readable
+// and then call timer_wheel_handle () to execute the expired timers
+// returns the wheel's timerfd on success, -1 on error
+CERVER_PUBLIC int timer_wheel_attach (TimerWheel *wheel);
+
+// executes the callbacks of the expired timers in the calling thread
+// must only be called by the event loop the wheel was attached to
+CERVER_PUBLIC void timer_wheel_handle (TimerWheel *wheel);
+
+// stops & joins the wheel's thread, or detaches it from its event loop
+// after the loop has executed the timers that had already expired
+// the timers are kept until the wheel gets deleted
+CERVER_PUBLIC void timer_wheel_stop (TimerWheel *wheel);
+
+// adds a timer that executes callback after delay ns
+// and then every interval ns if interval is not 0
+// periodic timers keep their deadlines in phase with the first one
+// and skip the runs that were missed by a slow callback
+// one-shot timers are deleted after their callback has been executed
+// returns the new timer on success, NULL on error
+CERVER_PUBLIC WheelTimer *timer_wheel_add (
+	TimerWheel *wheel,
+	const u64 delay, const u64 interval,
+	Action callback, void *args
+);
+
+// removes the timer from the wheel & deletes it
+// if its callback is running, waits for it to end,
+// unless it is called from inside the thread that executes the callbacks
+CERVER_PUBLIC void timer_wheel_cancel (
+	TimerWheel *wheel, WheelTimer *timer
+);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -8,6 +8,7 @@
 #include "cerver/config.h"
 
 #include "cerver/threads/jobs.h"
+#include "cerver/threads/thread.h"
 
 #define WORKER_NAME_SIZE		64
 
@@ -58,6 +59,8 @@ struct _Worker {
 	const void *reference;
 	void (*remove_reference) (const void *args);
 
+	ThreadAffinity affinity;
+
 	pthread_mutex_t mutex;
 
 };
@@ -76,6 +79,13 @@ CERVER_PUBLIC void worker_set_name (
 	Worker *worker, const char *name
 );
 
+// sets the cpus where the worker's thread will run
+// the worker's id is used as its idx for spread & compact affinities
+// must be called before the worker gets started
+CERVER_PUBLIC void worker_set_affinity (
+	Worker *worker, const ThreadAffinity *affinity
+);
+
 CERVER_PRIVATE WorkerState worker_get_state (
 	Worker *worker
 );
@@ -0,0 +1,163 @@
+#ifndef _CERVER_URING_H_
+#define _CERVER_URING_H_
+
+#include <stddef.h>
+#include <stdbool.h>
+
+#include "cerver/types/types.h"
+
+#include "cerver/config.h"
+
+// only available if the library was built with IO_URING=1
+#ifdef CERVER_IO_URING
+
+#include <linux/io_uring.h>
+
+#define URING_DEFAULT_ENTRIES				256
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// the submission queue as mapped from the kernel
+// head is moved by the kernel & tail by us
+typedef struct UringSq {
+
+	unsigned int *khead;
+	unsigned int *ktail;
+	unsigned int *kflags;
+	unsigned int *array;
+	unsigned int mask;
+	unsigned int entries;
+
+	// sqes that have been prepared but not yet published
+	unsigned int sqe_tail;
+
+	struct io_uring_sqe *sqes;
+
+	void *ring_ptr;
+	size_t ring_size;
+	size_t sqes_size;
+
+} UringSq;
+
+// the completion queue as mapped from the kernel
+// tail is moved by the kernel & head by us
+typedef struct UringCq {
+
+	unsigned int *khead;
+	unsigned int *ktail;
+	unsigned int mask;
+	unsigned int entries;
+
+	struct io_uring_cqe *cqes;
+
+	void *ring_ptr;
+	size_t ring_size;
+
+} UringCq;
+
+// a minimal io_uring instance using the raw syscalls
+// so we don't depend on liburing
+struct _Uring {
+
+	int ring_fd;
+
+	unsigned int features;
+
+	UringSq sq;
+	UringCq cq;
+
+};
+
+typedef struct _Uring Uring;
+
+// creates a new io_uring instance with at least entries sqes
+// and with cq_entries cqes (0 to use the kernel's default)
+// returns a new uring on success, NULL on error
+CERVER_PRIVATE Uring *uring_create (
+	const unsigned int entries, const unsigned int cq_entries
+);
+
+// unmaps the rings & closes the io_uring instance
+// every pending request gets cancelled by the kernel
+CERVER_PRIVATE void uring_delete (void *uring_ptr);
+
+// returns true if the kernel supports every one of the ops
+CERVER_PRIVATE bool uring_probe_ops (
+	const Uring *uring, const u8 *ops, const unsigned int n_ops
+);
+
+// returns the next free sqe cleared to zero
+// returns NULL if the submission queue is full
+CERVER_PRIVATE struct io_uring_sqe *uring_get_sqe (Uring *uring);
+
+// makes the prepared sqes visible to the kernel & submits them
+// returns the number of submitted sqes, -errno on error
+CERVER_PRIVATE int uring_submit (Uring *uring);
+
+// waits until wait_nr cqes are available
+// or until timeout_ms have passed (-1 to wait forever)
+// it doesn't submit any sqe, so it can be called
+// while other threads are preparing new ones
+// returns 0 on success, -errno on error (-ETIME on timeout)
+CERVER_PRIVATE int uring_wait (
+	Uring *uring, const unsigned int wait_nr, const int timeout_ms
+);
+
+// returns the next available cqe, NULL if there are none
+CERVER_PRIVATE struct io_uring_cqe *uring_peek_cqe (Uring *uring);
+
+// marks the last peeked cqe as consumed
+CERVER_PRIVATE void uring_cqe_seen (Uring *uring);
+
+// a ring of buffers provided to the kernel
+// the kernel selects one of them when a request needs to receive data
+// and returns its id in the cqe's flags
+struct _UringBufRing {
+
+	struct io_uring_buf_ring *ring;
+	size_t ring_size;
+
+	u16 bgid;                   // the group the requests select buffers from
+	u16 mask;
+	u16 tail;
+	unsigned int n_buffers;
+
+	char *buffers;
+	size_t buffer_size;
+
+};
+
+typedef struct _UringBufRing UringBufRing;
+
+// creates n_buffers (rounded up to a power of two) of buffer_size bytes
+// & registers them in the uring as the group bgid
+// returns a new buffers ring on success, NULL on error
+CERVER_PRIVATE UringBufRing *uring_buf_ring_create (
+	Uring *uring, const u16 bgid,
+	const unsigned int n_buffers, const size_t buffer_size
+);
+
+// unregisters the buffers ring from the uring & deletes it
+CERVER_PRIVATE void uring_buf_ring_delete (
+	Uring *uring, UringBufRing *buf_ring
+);
+
+// returns the buffer that matches the id
+CERVER_PRIVATE char *uring_buf_ring_get (
+	const UringBufRing *buf_ring, const u16 bid
+);
+
+// gives the buffer back to the kernel so it can be selected again
+CERVER_PRIVATE void uring_buf_ring_recycle (
+	UringBufRing *buf_ring, const u16 bid
+);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+#endif
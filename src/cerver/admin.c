@@ -20,12 +20,15 @@
 #include "cerver/cerver.h"
 #include "cerver/client.h"
 #include "cerver/connection.h"
+#include "cerver/fdtable.h"
 #include "cerver/handler.h"
 #include "cerver/packets.h"
+#include "cerver/poll.h"
 #include "cerver/events.h"
 
 #include "cerver/threads/thread.h"
 #include "cerver/threads/bsem.h"
+#include "cerver/threads/wheel.h"
 
 #include "cerver/utils/utils.h"
 #include "cerver/utils/log.h"
@@ -94,36 +97,18 @@ void admin_cerver_stats_print (AdminCerverStats *stats) {
 
 static void admin_cerver_packet_send_update_stats (
 	AdminCerverStats *stats,
-	PacketType packet_type, size_t sent
+	PacketType packet_type, u32 request_type, size_t sent
 ) {
 
-	stats->total_n_packets_sent += 1;
-	stats->total_bytes_sent += sent;
+	STATS_ADD (stats->total_n_packets_sent, 1);
+	STATS_ADD (stats->total_bytes_sent, sent);
 
 	switch (packet_type) {
-		case PACKET_TYPE_NONE: break;
-
-		case PACKET_TYPE_CERVER: stats->sent_packets->n_cerver_packets += 1; break;
-
-		case PACKET_TYPE_CLIENT: break;
-
-		case PACKET_TYPE_ERROR: stats->sent_packets->n_error_packets += 1; break;
-
-		case PACKET_TYPE_REQUEST: stats->sent_packets->n_request_packets += 1; break;
-
-		case PACKET_TYPE_AUTH: stats->sent_packets->n_auth_packets += 1; break;
-
-		case PACKET_TYPE_GAME: stats->sent_packets->n_game_packets += 1; break;
-
-		case PACKET_TYPE_APP: stats->sent_packets->n_app_packets += 1; break;
-
-		case PACKET_TYPE_APP_ERROR: stats->sent_packets->n_app_error_packets += 1; break;
-
-		case PACKET_TYPE_CUSTOM: stats->sent_packets->n_custom_packets += 1; break;
-
-		case PACKET_TYPE_TEST: stats->sent_packets->n_test_packets += 1; break;
+		case PACKET_TYPE_NONE:
+		case PACKET_TYPE_CLIENT:
+			break;
 
-		default: stats->sent_packets->n_unknown_packets += 1; break;
+		default: packets_per_type_count (stats->sent_packets, packet_type, request_type); break;
 	}
 
 }
@@ -246,23 +231,17 @@ void admin_set_data (
 
 }
 
+// gets the admin's connection from the cerver's fd table
 static Connection *admin_connection_get_by_sock_fd (
-	Admin *admin, const i32 sock_fd
+	AdminCerver *admin_cerver, Admin *admin, const i32 sock_fd
 ) {
 
 	Connection *retval = NULL;
 
-	if (admin) {
-		Connection *connection = NULL;
-		for (
-			ListElement *le_sub = dlist_start (admin->client->connections);
-			le_sub; le_sub = le_sub->next
-		) {
-			connection = (Connection *) le_sub->data;
-			if (connection->socket->sock_fd == sock_fd) {
-				retval = connection;
-				break;
-			}
+	if (admin_cerver && admin) {
+		FdTableEntry entry = { 0 };
+		if (!fd_table_get (admin_cerver->cerver->fd_table, sock_fd, &entry)) {
+			if (entry.client == admin->client) retval = entry.connection;
 		}
 	}
 
@@ -270,21 +249,19 @@ static Connection *admin_connection_get_by_sock_fd (
 
 }
 
-// gets an admin by a matching connection in its client with the specified sock fd
-Admin *admin_get_by_sock_fd (
-	AdminCerver *admin_cerver, const i32 sock_fd
+// gets the admin whose client is the one that was provided
+Admin *admin_get_by_client (
+	AdminCerver *admin_cerver, const Client *client
 ) {
 
 	Admin *retval = NULL;
 
-	if (admin_cerver) {
+	if (admin_cerver && client) {
 		for (
 			ListElement *le = dlist_start (admin_cerver->admins);
 			le; le = le->next
 		) {
-			if (admin_connection_get_by_sock_fd (
-				(Admin *) le->data, sock_fd)
-			) {
+			if (((Admin *) le->data)->client == client) {
 				retval = (Admin *) le->data;
 				break;
 			}
@@ -295,6 +272,23 @@ Admin *admin_get_by_sock_fd (
 
 }
 
+// gets an admin by the client that is mapped to the sock fd in the cerver's fd table
+Admin *admin_get_by_sock_fd (
+	AdminCerver *admin_cerver, const i32 sock_fd
+) {
+
+	Admin *retval = NULL;
+
+	if (admin_cerver) {
+		FdTableEntry entry = { 0 };
+		if (!fd_table_get (admin_cerver->cerver->fd_table, sock_fd, &entry))
+			retval = admin_get_by_client (admin_cerver, entry.client);
+	}
+
+	return retval;
+
+}
+
 // gets an admin by a matching client's session id
 Admin *admin_get_by_session_id (
 	AdminCerver *admin_cerver, const char *session_id
@@ -384,7 +378,10 @@ AdminConnectionsStatus admin_remove_connection_by_sock_fd (
 			} break;
 
 			default: {
-				connection = admin_connection_get_by_sock_fd (admin, sock_fd);
+				connection = admin_connection_get_by_sock_fd (
+					admin_cerver, admin, sock_fd
+				);
+
 				if (connection) {
 					if (!admin_cerver_poll_unregister_connection (
 						admin_cerver, connection
@@ -449,7 +446,7 @@ u8 admin_send_packet (Admin *admin, Packet *packet) {
 			// printf ("admin_send_packet () - Sent to admin: %ld\n", sent);
 
 			admin_cerver_packet_send_update_stats (
-				admin->admin_cerver->stats, packet->packet_type, sent
+				admin->admin_cerver->stats, packet->packet_type, packet->req_type, sent
 			);
 
 			retval = 0;
@@ -485,7 +482,7 @@ u8 admin_send_packet_split (Admin *admin, Packet *packet) {
 			// );
 
 			admin_cerver_packet_send_update_stats (
-				admin->admin_cerver->stats, packet->packet_type, sent
+				admin->admin_cerver->stats, packet->packet_type, packet->req_type, sent
 			);
 
 			retval = 0;
@@ -532,7 +529,7 @@ u8 admin_send_packet_pieces (
 			// );
 
 			admin_cerver_packet_send_update_stats (
-				admin->admin_cerver->stats, packet->packet_type, sent
+				admin->admin_cerver->stats, packet->packet_type, packet->req_type, sent
 			);
 
 			retval = 0;
@@ -571,6 +568,7 @@ AdminCerver *admin_cerver_new (void) {
 		admin_cerver->fds = NULL;
 		admin_cerver->max_n_fds = ADMIN_CERVER_DEFAULT_POLL_FDS;
 		admin_cerver->current_n_fds = 0;
+		admin_cerver->fds_map = NULL;
 		admin_cerver->poll_timeout = ADMIN_CERVER_DEFAULT_POLL_TIMEOUT;
 		admin_cerver->poll_lock = NULL;
 
@@ -588,13 +586,13 @@ AdminCerver *admin_cerver_new (void) {
 
 		admin_cerver->check_packets = ADMIN_CERVER_DEFAULT_CHECK_PACKETS;
 
-		admin_cerver->update_thread_id = 0;
+		admin_cerver->update_timer = NULL;
 		admin_cerver->update = NULL;
 		admin_cerver->update_args = NULL;
 		admin_cerver->delete_update_args = NULL;
 		admin_cerver->update_ticks = ADMIN_CERVER_DEFAULT_UPDATE_TICKS;
 
-		admin_cerver->update_interval_thread_id = 0;
+		admin_cerver->update_interval_timer = NULL;
 		admin_cerver->update_interval = NULL;
 		admin_cerver->update_interval_args = NULL;
 		admin_cerver->delete_update_interval_args = NULL;
@@ -613,6 +611,7 @@ void admin_cerver_delete (AdminCerver *admin_cerver) {
 		dlist_delete (admin_cerver->admins);
 
 		if (admin_cerver->fds) free (admin_cerver->fds);
+		poll_fds_map_delete (admin_cerver->fds_map);
 
 		if (admin_cerver->poll_lock) {
 			pthread_mutex_destroy (admin_cerver->poll_lock);
@@ -814,9 +813,9 @@ unsigned int admin_cerver_get_n_handlers_working (
 	unsigned int retval = 0;
 
 	if (admin_cerver) {
-		(void) pthread_mutex_lock (admin_cerver->handlers_lock);
-		retval = admin_cerver->num_handlers_working;
-		(void) pthread_mutex_unlock (admin_cerver->handlers_lock);
+		retval = __atomic_load_n (
+			&admin_cerver->num_handlers_working, __ATOMIC_RELAXED
+		);
 	}
 
 	return retval;
@@ -839,7 +838,7 @@ void admin_cerver_set_check_packets (
 }
 
 // sets a custom update function to be executed every n ticks
-// a new thread will be created that will call your method each tick
+// a timer in the cerver's timers thread will call your method each tick
 // the update args will be passed to your method as a CerverUpdate &
 // will only be deleted at cerver teardown if you set the delete_update_args ()
 void admin_cerver_set_update (
@@ -858,7 +857,7 @@ void admin_cerver_set_update (
 }
 
 // sets a custom update method to be executed every x seconds (in intervals)
-// a new thread will be created that will call your method every x seconds
+// a timer in the cerver's timers thread will call your method every x seconds
 // the update args will be passed to your method as a CerverUpdate &
 // will only be deleted at cerver teardown if you set the delete_update_args ()
 void admin_cerver_set_update_interval (
@@ -976,8 +975,8 @@ u8 admin_cerver_register_admin (
 
 			admin->admin_cerver = admin_cerver;
 
-			admin_cerver->stats->current_connected_admins += 1;
-			admin_cerver->stats->total_n_admins += 1;
+			STATS_ADD (admin_cerver->stats->current_connected_admins, 1);
+			STATS_ADD (admin_cerver->stats->total_n_admins, 1);
 
 			#ifdef CERVER_STATS
 			cerver_log (
@@ -1018,7 +1017,7 @@ u8 admin_cerver_unregister_admin (
 
 			admin->admin_cerver = NULL;
 
-			admin_cerver->stats->current_connected_admins -= 1;
+			STATS_SUB (admin_cerver->stats->current_connected_admins, 1);
 
 			#ifdef CERVER_STATS
 			cerver_log (
@@ -1060,125 +1059,115 @@ u8 admin_cerver_drop_admin (
 
 static void *admin_poll (void *cerver_ptr);
 
-// called in a dedicated thread only if a user method was set
+// executed by the cerver's timers only if a user method was set
 // executes methods every tick
-static void *admin_cerver_update (void *args) {
+static void admin_cerver_update (void *cerver_update_ptr) {
 
-	if (args) {
-		AdminCerver *admin_cerver = (AdminCerver *) args;
+	CerverUpdate *cu = (CerverUpdate *) cerver_update_ptr;
 
-		#ifdef ADMIN_DEBUG
-		cerver_log_success (
-			"Cerver's %s admin_cerver_update () has started!",
-			admin_cerver->cerver->info->name
-		);
-		#endif
+	if (cu->cerver->isRunning) cu->cerver->admin->update (cu);
 
-		CerverUpdate *cu = cerver_update_new (admin_cerver->cerver, admin_cerver->update_args);
+}
 
-		u32 time_per_frame = 1000000 / admin_cerver->update_ticks;
-		// printf ("time per frame: %d\n", time_per_frame);
-		u32 temp = 0;
-		i32 sleep_time = 0;
-		u64 delta_time = 0;
+// executed by the cerver's timers only if a user method was set
+// executes methods every x seconds
+static void admin_cerver_update_interval (void *cerver_update_ptr) {
 
-		u64 delta_ticks = 0;
-		u32 fps = 0;
-		struct timespec start = { 0 }, middle = { 0 }, end = { 0 };
+	CerverUpdate *cu = (CerverUpdate *) cerver_update_ptr;
 
-		while (admin_cerver->cerver->isRunning) {
-			(void) clock_gettime (CLOCK_MONOTONIC_RAW, &start);
+	if (cu->cerver->isRunning) cu->cerver->admin->update_interval (cu);
 
-			// do stuff
-			if (admin_cerver->update) admin_cerver->update (cu);
+}
 
-			// limit the fps
-			(void) clock_gettime (CLOCK_MONOTONIC_RAW, &middle);
-			temp = (middle.tv_nsec - start.tv_nsec) / 1000;
-			// printf ("temp: %d\n", temp);
-			sleep_time = time_per_frame - temp;
-			// printf ("sleep time: %d\n", sleep_time);
-			if (sleep_time > 0) {
-				(void) usleep (sleep_time);
-			}
+static u8 admin_cerver_update_start (AdminCerver *admin_cerver) {
 
-			// count fps
-			(void) clock_gettime (CLOCK_MONOTONIC_RAW, &end);
-			delta_time = (end.tv_nsec - start.tv_nsec) / 1000000;
-			delta_ticks += delta_time;
-			fps++;
-			// printf ("delta ticks: %ld\n", delta_ticks);
-			if (delta_ticks >= 1000) {
-				// printf ("cerver %s update fps: %i\n", cerver->info->name, fps);
-				delta_ticks = 0;
-				fps = 0;
-			}
-		}
+	u8 retval = 1;
 
-		cerver_update_delete (cu);
+	TimerWheel *timers = cerver_timers_get (admin_cerver->cerver);
+	CerverUpdate *cu = cerver_update_new (
+		admin_cerver->cerver, admin_cerver->update_args
+	);
 
-		if (admin_cerver->update_args) {
-			if (admin_cerver->delete_update_args) {
-				admin_cerver->delete_update_args (admin_cerver->update_args);
-			}
-		}
+	if (timers && cu) {
+		// every tick has an absolute deadline so they don't drift
+		const u64 time_per_frame = 1000000000 / admin_cerver->update_ticks;
 
-		#ifdef ADMIN_DEBUG
-		cerver_log_success (
-			"Cerver's %s admin_cerver_update () has ended!",
+		admin_cerver->update_timer = timer_wheel_add (
+			timers, 0, time_per_frame, admin_cerver_update, cu
+		);
+	}
+
+	if (admin_cerver->update_timer) {
+		retval = 0;
+	}
+
+	else {
+		cerver_log_error (
+			"Failed to create cerver %s ADMIN UPDATE timer!",
 			admin_cerver->cerver->info->name
 		);
-		#endif
+
+		cerver_update_delete (cu);
 	}
 
-	return NULL;
+	return retval;
 
 }
 
-// called in a dedicated thread only if a user method was set
-// executes methods every x seconds
-static void *admin_cerver_update_interval (void *args) {
+static u8 admin_cerver_update_interval_start (AdminCerver *admin_cerver) {
 
-	if (args) {
-		AdminCerver *admin_cerver = (AdminCerver *) args;
+	u8 retval = 1;
 
-		#ifdef ADMIN_DEBUG
-		cerver_log_success (
-			"Cerver's %s admin_cerver_update_interval () has started!",
-			admin_cerver->cerver->info->name
-		);
-		#endif
+	TimerWheel *timers = cerver_timers_get (admin_cerver->cerver);
+	CerverUpdate *cu = cerver_update_new (
+		admin_cerver->cerver, admin_cerver->update_interval_args
+	);
 
-		CerverUpdate *cu = cerver_update_new (
-			admin_cerver->cerver, admin_cerver->update_interval_args
+	if (timers && cu) {
+		admin_cerver->update_interval_timer = timer_wheel_add (
+			timers,
+			0, (u64) admin_cerver->update_interval_secs * 1000000000,
+			admin_cerver_update_interval, cu
 		);
+	}
 
-		while (admin_cerver->cerver->isRunning) {
-			if (admin_cerver->update_interval)
-				admin_cerver->update_interval (cu);
+	if (admin_cerver->update_interval_timer) {
+		retval = 0;
+	}
 
-			(void) sleep (admin_cerver->update_interval_secs);
-		}
+	else {
+		cerver_log_error (
+			"Failed to create cerver %s ADMIN UPDATE INTERVAL timer!",
+			admin_cerver->cerver->info->name
+		);
 
 		cerver_update_delete (cu);
+	}
 
-		if (admin_cerver->update_interval_args) {
-			if (admin_cerver->delete_update_interval_args) {
-				admin_cerver->delete_update_interval_args (
-					admin_cerver->update_interval_args
-				);
-			}
-		}
+	return retval;
 
-		#ifdef ADMIN_DEBUG
-		cerver_log_success (
-			"Cerver's %s admin_cerver_update_interval () has ended!",
-			admin_cerver->cerver->info->name
-		);
-		#endif
+}
+
+// the cerver's timers have already been stopped
+static void admin_cerver_update_end (AdminCerver *admin_cerver) {
+
+	if (admin_cerver->update_timer) {
+		cerver_update_delete (admin_cerver->update_timer->args);
+
+		if (admin_cerver->update_args && admin_cerver->delete_update_args)
+			admin_cerver->delete_update_args (admin_cerver->update_args);
+
+		admin_cerver->update_timer->args = NULL;
 	}
 
-	return NULL;
+	if (admin_cerver->update_interval_timer) {
+		cerver_update_delete (admin_cerver->update_interval_timer->args);
+
+		if (admin_cerver->update_interval_args && admin_cerver->delete_update_interval_args)
+			admin_cerver->delete_update_interval_args (admin_cerver->update_interval_args);
+
+		admin_cerver->update_interval_timer->args = NULL;
+	}
 
 }
 
@@ -1192,13 +1181,10 @@ static u8 admin_cerver_start_internal (AdminCerver *admin_cerver) {
 			admin_cerver->max_n_fds, sizeof (struct pollfd)
 		);
 
-		if (admin_cerver->fds) {
-			(void) memset (
-				admin_cerver->fds, 0, sizeof (struct pollfd) * admin_cerver->max_n_fds
-			);
+		admin_cerver->fds_map = poll_fds_map_create (POLL_FDS_MAP_DEFAULT_SIZE);
 
-			for (u32 i = 0; i < admin_cerver->max_n_fds; i++)
-				admin_cerver->fds[i].fd = -1;
+		if (admin_cerver->fds && admin_cerver->fds_map) {
+			poll_fds_reset (admin_cerver->fds, 0, admin_cerver->max_n_fds);
 
 			admin_cerver->current_n_fds = 0;
 
@@ -1397,29 +1383,11 @@ u8 admin_cerver_start (AdminCerver *admin_cerver) {
 	if (admin_cerver) {
 		if (!admin_cerver_start_internal (admin_cerver)) {
 			if (admin_cerver->update) {
-				if (thread_create_detachable (
-					&admin_cerver->update_thread_id,
-					admin_cerver_update,
-					admin_cerver
-				)) {
-					cerver_log_error (
-						"Failed to create cerver %s ADMIN UPDATE thread!",
-						admin_cerver->cerver->info->name
-					);
-				}
+				(void) admin_cerver_update_start (admin_cerver);
 			}
 
 			if (admin_cerver->update_interval) {
-				if (thread_create_detachable (
-					&admin_cerver->update_interval_thread_id,
-					admin_cerver_update_interval,
-					admin_cerver
-				)) {
-					cerver_log_error (
-						"Failed to create cerver %s ADMIN UPDATE INTERVAL thread!",
-						admin_cerver->cerver->info->name
-					);
-				}
+				(void) admin_cerver_update_interval_start (admin_cerver);
 			}
 
 			if (!admin_cerver_handlers_start (admin_cerver)) {
@@ -1460,8 +1428,8 @@ static u8 admin_cerver_app_handler_destroy (AdminCerver *admin_cerver) {
 		if (admin_cerver->app_packet_handler) {
 			if (!admin_cerver->app_packet_handler->direct_handle) {
 				// stop app handler
-				bsem_post_all (
-					admin_cerver->app_packet_handler->job_queue->has_jobs
+				job_queue_signal_all (
+					admin_cerver->app_packet_handler->job_queue
 				);
 			}
 		}
@@ -1479,8 +1447,8 @@ static u8 admin_cerver_app_error_handler_destroy (AdminCerver *admin_cerver) {
 		if (admin_cerver->app_error_packet_handler) {
 			if (!admin_cerver->app_error_packet_handler->direct_handle) {
 				// stop app error handler
-				bsem_post_all (
-					admin_cerver->app_error_packet_handler->job_queue->has_jobs
+				job_queue_signal_all (
+					admin_cerver->app_error_packet_handler->job_queue
 				);
 			}
 		}
@@ -1498,8 +1466,8 @@ static u8 admin_cerver_custom_handler_destroy (AdminCerver *admin_cerver) {
 		if (admin_cerver->custom_packet_handler) {
 			if (!admin_cerver->custom_packet_handler->direct_handle) {
 				// stop custom handler
-				bsem_post_all (
-					admin_cerver->custom_packet_handler->job_queue->has_jobs
+				job_queue_signal_all (
+					admin_cerver->custom_packet_handler->job_queue
 				);
 			}
 		}
@@ -1531,13 +1499,13 @@ static u8 admin_cerver_handlers_end (AdminCerver *admin_cerver) {
 		// poll remaining handlers
 		while (admin_cerver->num_handlers_alive) {
 			if (admin_cerver->app_packet_handler)
-				bsem_post_all (admin_cerver->app_packet_handler->job_queue->has_jobs);
+				job_queue_signal_all (admin_cerver->app_packet_handler->job_queue);
 
 			if (admin_cerver->app_error_packet_handler)
-				bsem_post_all (admin_cerver->app_error_packet_handler->job_queue->has_jobs);
+				job_queue_signal_all (admin_cerver->app_error_packet_handler->job_queue);
 
 			if (admin_cerver->custom_packet_handler)
-				bsem_post_all (admin_cerver->custom_packet_handler->job_queue->has_jobs);
+				job_queue_signal_all (admin_cerver->custom_packet_handler->job_queue);
 
 			sleep (1);
 		}
@@ -1582,6 +1550,8 @@ u8 admin_cerver_end (AdminCerver *admin_cerver) {
 
 		errors |= admin_cerver_disconnect_admins (admin_cerver);
 
+		admin_cerver_update_end (admin_cerver);
+
 		cerver_log_success (
 			"Cerver %s admin teardown was successful!",
 			admin_cerver->cerver->info->name
@@ -1736,9 +1706,9 @@ static void admin_app_packet_handler (Packet *packet) {
 		else {
 			// add the packet to the handler's job queueu to be handled
 			// as soon as the handler is available
-			if (job_queue_push (
-				packet->cerver->admin->app_packet_handler->job_queue,
-				job_create (NULL, packet)
+			void *job = job_create (NULL, packet);
+			if (!job || handler_push_jobs (
+				packet->cerver->admin->app_packet_handler, &job, 1
 			)) {
 				cerver_log_error (
 					"Failed to push a new job to cerver's %s ADMIN app_packet_handler!",
@@ -1773,9 +1743,9 @@ static void admin_app_error_packet_handler (Packet *packet) {
 		else {
 			// add the packet to the handler's job queueu to be handled
 			// as soon as the handler is available
-			if (job_queue_push (
-				packet->cerver->admin->app_error_packet_handler->job_queue,
-				job_create (NULL, packet)
+			void *job = job_create (NULL, packet);
+			if (!job || handler_push_jobs (
+				packet->cerver->admin->app_error_packet_handler, &job, 1
 			)) {
 				cerver_log_error (
 					"Failed to push a new job to cerver's %s ADMIN app_error_packet_handler!",
@@ -1810,9 +1780,9 @@ static void admin_custom_packet_handler (Packet *packet) {
 		else {
 			// add the packet to the handler's job queueu to be handled
 			// as soon as the handler is available
-			if (job_queue_push (
-				packet->cerver->admin->custom_packet_handler->job_queue,
-				job_create (NULL, packet)
+			void *job = job_create (NULL, packet);
+			if (!job || handler_push_jobs (
+				packet->cerver->admin->custom_packet_handler, &job, 1
 			)) {
 				cerver_log_error (
 					"Failed to push a new job to cerver's %s ADMIN custom_packet_handler!",
@@ -1841,47 +1811,47 @@ static AdminCerverHandlerError admin_packet_handler_actual (
 
 	switch (packet->header.packet_type) {
 		case PACKET_TYPE_CLIENT:
-			packet->cerver->admin->stats->received_packets->n_client_packets += 1;
-			packet->client->stats->received_packets->n_client_packets += 1;
-			packet->connection->stats->received_packets->n_client_packets += 1;
+			packets_per_type_count (packet->cerver->admin->stats->received_packets, PACKET_TYPE_CLIENT, packet->header.request_type);
+			packets_per_type_count (packet->client->stats->received_packets, PACKET_TYPE_CLIENT, packet->header.request_type);
+			packets_per_type_count (packet->connection->stats->received_packets, PACKET_TYPE_CLIENT, packet->header.request_type);
 			error = admin_cerver_client_packet_handler (packet);
 			packet_delete (packet);
 			break;
 
 		// handles a request made from the admin
 		case PACKET_TYPE_REQUEST:
-			packet->cerver->admin->stats->received_packets->n_request_packets += 1;
-			packet->client->stats->received_packets->n_request_packets += 1;
-			packet->connection->stats->received_packets->n_request_packets += 1;
+			packets_per_type_count (packet->cerver->admin->stats->received_packets, PACKET_TYPE_REQUEST, packet->header.request_type);
+			packets_per_type_count (packet->client->stats->received_packets, PACKET_TYPE_REQUEST, packet->header.request_type);
+			packets_per_type_count (packet->connection->stats->received_packets, PACKET_TYPE_REQUEST, packet->header.request_type);
 			admin_cerver_request_packet_handler (packet);
 			packet_delete (packet);
 			break;
 
 		case PACKET_TYPE_APP:
-			packet->cerver->admin->stats->received_packets->n_app_packets += 1;
-			packet->client->stats->received_packets->n_app_packets += 1;
-			packet->connection->stats->received_packets->n_app_packets += 1;
+			packets_per_type_count (packet->cerver->admin->stats->received_packets, PACKET_TYPE_APP, packet->header.request_type);
+			packets_per_type_count (packet->client->stats->received_packets, PACKET_TYPE_APP, packet->header.request_type);
+			packets_per_type_count (packet->connection->stats->received_packets, PACKET_TYPE_APP, packet->header.request_type);
 			admin_app_packet_handler (packet);
 			break;
 
 		case PACKET_TYPE_APP_ERROR:
-			packet->cerver->admin->stats->received_packets->n_app_error_packets += 1;
-			packet->client->stats->received_packets->n_app_error_packets += 1;
-			packet->connection->stats->received_packets->n_app_error_packets += 1;
+			packets_per_type_count (packet->cerver->admin->stats->received_packets, PACKET_TYPE_APP_ERROR, packet->header.request_type);
+			packets_per_type_count (packet->client->stats->received_packets, PACKET_TYPE_APP_ERROR, packet->header.request_type);
+			packets_per_type_count (packet->connection->stats->received_packets, PACKET_TYPE_APP_ERROR, packet->header.request_type);
 			admin_app_error_packet_handler (packet);
 			break;
 
 		case PACKET_TYPE_CUSTOM:
-			packet->cerver->admin->stats->received_packets->n_custom_packets += 1;
-			packet->client->stats->received_packets->n_custom_packets += 1;
-			packet->connection->stats->received_packets->n_custom_packets += 1;
+			packets_per_type_count (packet->cerver->admin->stats->received_packets, PACKET_TYPE_CUSTOM, packet->header.request_type);
+			packets_per_type_count (packet->client->stats->received_packets, PACKET_TYPE_CUSTOM, packet->header.request_type);
+			packets_per_type_count (packet->connection->stats->received_packets, PACKET_TYPE_CUSTOM, packet->header.request_type);
 			admin_custom_packet_handler (packet);
 			break;
 
 		default: {
-			packet->cerver->admin->stats->received_packets->n_bad_packets += 1;
-			packet->client->stats->received_packets->n_bad_packets += 1;
-			packet->connection->stats->received_packets->n_bad_packets += 1;
+			packets_per_type_count_bad (packet->cerver->admin->stats->received_packets);
+			packets_per_type_count_bad (packet->client->stats->received_packets);
+			packets_per_type_count_bad (packet->connection->stats->received_packets);
 			#ifdef ADMIN_DEBUG
 			cerver_log (
 				LOG_TYPE_WARNING, LOG_TYPE_PACKET,
@@ -1964,35 +1934,6 @@ u8 admin_packet_handler (Packet *packet) {
 
 #pragma region poll
 
-// get a free index in the admin cerver poll fds array
-static i32 admin_cerver_poll_get_free_idx (
-	AdminCerver *admin_cerver
-) {
-
-	if (admin_cerver) {
-		for (u32 i = 0; i < admin_cerver->max_n_fds; i++)
-			if (admin_cerver->fds[i].fd == -1) return i;
-
-	}
-
-	return -1;
-
-}
-
-// get the idx of the connection sock fd in the admin cerver poll fds
-static i32 admin_cerver_poll_get_idx_by_sock_fd (
-	AdminCerver *admin_cerver, i32 sock_fd
-) {
-
-	if (admin_cerver) {
-		for (u32 i = 0; i < admin_cerver->max_n_fds; i++)
-			if (admin_cerver->fds[i].fd == sock_fd) return i;
-	}
-
-	return -1;
-
-}
-
 // regsiters a client connection to the cerver's admin poll array
 // returns 0 on success, 1 on error
 u8 admin_cerver_poll_register_connection (
@@ -2004,14 +1945,17 @@ u8 admin_cerver_poll_register_connection (
 	if (admin_cerver && connection) {
 		(void) pthread_mutex_lock (admin_cerver->poll_lock);
 
-		i32 idx = admin_cerver_poll_get_free_idx (admin_cerver);
+		i32 idx = poll_fds_register (
+			admin_cerver->fds,
+			admin_cerver->max_n_fds, &admin_cerver->current_n_fds,
+			admin_cerver->fds_map,
+			connection->socket->sock_fd, POLLIN
+		);
+
 		if (idx >= 0) {
-			admin_cerver->fds[idx].fd = connection->socket->sock_fd;
-			admin_cerver->fds[idx].events = POLLIN;
-			admin_cerver->current_n_fds++;
 
-			admin_cerver->stats->current_connections++;
-			admin_cerver->stats->total_admin_connections++;
+			STATS_ADD (admin_cerver->stats->current_connections, 1);
+			STATS_ADD (admin_cerver->stats->total_admin_connections, 1);
 
 			#ifdef ADMIN_DEBUG
 			cerver_log (
@@ -2045,6 +1989,14 @@ u8 admin_cerver_poll_register_connection (
 		}
 
 		(void) pthread_mutex_unlock (admin_cerver->poll_lock);
+
+		// map the sock fd to the admin's client & connection
+		if (!retval) {
+			retval = fd_table_set (
+				admin_cerver->cerver->fd_table, connection->socket->sock_fd,
+				connection->client, connection
+			);
+		}
 	}
 
 	return retval;
@@ -2062,13 +2014,14 @@ u8 admin_cerver_poll_unregister_sock_fd (
 	if (admin_cerver) {
 		(void) pthread_mutex_lock (admin_cerver->poll_lock);
 
-		i32 idx = admin_cerver_poll_get_idx_by_sock_fd (admin_cerver, sock_fd);
+		// its slot is compacted by the admin poll thread
+		i32 idx = poll_fds_unregister (
+			admin_cerver->fds, admin_cerver->fds_map, sock_fd
+		);
+
 		if (idx >= 0) {
-			admin_cerver->fds[idx].fd = -1;
-			admin_cerver->fds[idx].events = -1;
-			admin_cerver->current_n_fds--;
 
-			admin_cerver->stats->current_connections--;
+			STATS_SUB (admin_cerver->stats->current_connections, 1);
 
 			#ifdef ADMIN_DEBUG
 			cerver_log (
@@ -2113,42 +2066,58 @@ static u8 admin_cerver_poll_unregister_connection (
 	AdminCerver *admin_cerver, Connection *connection
 ) {
 
-	return (admin_cerver && connection) ?
-		admin_cerver_poll_unregister_sock_fd (
+	u8 retval = 1;
+
+	if (admin_cerver && connection) {
+		(void) fd_table_remove (
+			admin_cerver->cerver->fd_table, connection->socket->sock_fd,
+			connection->client, connection
+		);
+
+		retval = admin_cerver_poll_unregister_sock_fd (
 			admin_cerver, connection->socket->sock_fd
-		) : 1;
+		);
+	}
+
+	return retval;
 
 }
 
 static inline void admin_poll_handle (
-	AdminCerver *admin_cerver, char *packet_buffer
+	AdminCerver *admin_cerver, const u32 n_fds,
+	CerverReceive *cr, char *packet_buffer
 ) {
 
 	// one or more fd(s) are readable, need to determine which ones they are
-	for (u32 idx = 0; idx < admin_cerver->max_n_fds; idx++) {
-		if (admin_cerver->fds[idx].fd > -1) {
-			CerverReceive *cr = cerver_receive_create (
-				RECEIVE_TYPE_ADMIN, admin_cerver->cerver, admin_cerver->fds[idx].fd
-			);
+	// fds are never moved until every event has been handled,
+	// but another thread might have freed their slot meanwhile
+	struct pollfd active_fd = { 0 };
+	for (u32 idx = 0; idx < n_fds; idx++) {
+		if (admin_cerver->fds[idx].revents) {
+			active_fd.fd = poll_fds_get (admin_cerver->fds, idx);
+			active_fd.revents = admin_cerver->fds[idx].revents;
+			admin_cerver->fds[idx].revents = 0;
+
+			if (active_fd.fd >= 0) {
+				cerver_receive_init (
+					cr, RECEIVE_TYPE_ADMIN, admin_cerver->cerver, active_fd.fd
+				);
 
-			if (cr) {
-				switch (admin_cerver->fds[idx].revents) {
-					case POLLIN: {
-						cerver_receive_internal (
-							cr,
-							packet_buffer,
-							admin_cerver->receive_buffer_size
-						);
-					} break;
+				if (cr->socket) {
+					switch (active_fd.revents) {
+						case POLLIN: {
+							cerver_receive_internal (
+								cr,
+								packet_buffer,
+								admin_cerver->receive_buffer_size
+							);
+						} break;
 
-					default: {
-						if (admin_cerver->fds[idx].revents != 0) {
+						default: {
 							cerver_receive_handle_failed (cr);
-						}
-					} break;
+						} break;
+					}
 				}
-
-				cerver_receive_delete (cr);
 			}
 		}
 	}
@@ -2168,7 +2137,18 @@ static void *admin_poll (void *cerver_ptr) {
 			cerver->info->name
 		);
 
-		(void) thread_set_name ("%s-admin", cerver->info->alias);
+		char thread_name[THREAD_NAME_BUFFER_SIZE] = { 0 };
+		(void) snprintf (
+			thread_name, THREAD_NAME_BUFFER_SIZE,
+			"%s-admin", cerver->info->alias
+		);
+
+		(void) thread_set_name ("%s", thread_name);
+
+		// pin the thread before allocating its packet buffer
+		ThreadAffinity affinity;
+		cerver_get_affinity (cerver, 1, &affinity);
+		(void) thread_affinity_apply (&affinity, 0, thread_name);
 
 		char *packet_buffer = (char *) calloc (
 			admin_cerver->receive_buffer_size, sizeof (char)
@@ -2182,12 +2162,19 @@ static void *admin_poll (void *cerver_ptr) {
 			);
 			#endif
 
+			CerverReceive cr = { 0 };
+
+			u32 n_fds = 0;
 			int poll_retval = 0;
 			while (cerver->isRunning) {
+				// other threads can only append new fds
+				// or free their slots while we are polling
+				(void) pthread_mutex_lock (admin_cerver->poll_lock);
+				n_fds = admin_cerver->current_n_fds;
+				(void) pthread_mutex_unlock (admin_cerver->poll_lock);
+
 				poll_retval = poll (
-					admin_cerver->fds,
-					admin_cerver->max_n_fds,
-					admin_cerver->poll_timeout
+					admin_cerver->fds, n_fds, admin_cerver->poll_timeout
 				);
 
 				switch (poll_retval) {
@@ -2214,10 +2201,17 @@ static void *admin_poll (void *cerver_ptr) {
 
 					default: {
 						admin_poll_handle (
-							admin_cerver, packet_buffer
+							admin_cerver, n_fds, &cr, packet_buffer
 						);
 					} break;
 				}
+
+				(void) pthread_mutex_lock (admin_cerver->poll_lock);
+				poll_fds_compact (
+					admin_cerver->fds, &admin_cerver->current_n_fds,
+					admin_cerver->fds_map, 0
+				);
+				(void) pthread_mutex_unlock (admin_cerver->poll_lock);
 			}
 
 			#ifdef ADMIN_DEBUG
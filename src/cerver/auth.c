@@ -1,4 +1,5 @@
 #include <stdlib.h>
+#include <stdio.h>
 #include <string.h>
 #include <poll.h>
 
@@ -8,6 +9,7 @@
 #include "cerver/socket.h"
 #include "cerver/network.h"
 #include "cerver/packets.h"
+#include "cerver/poll.h"
 #include "cerver/errors.h"
 #include "cerver/handler.h"
 #include "cerver/sessions.h"
@@ -16,6 +18,8 @@
 #include "cerver/connection.h"
 #include "cerver/auth.h"
 #include "cerver/events.h"
+#include "cerver/fdtable.h"
+#include "cerver/registry.h"
 
 #include "cerver/threads/thread.h"
 #include "cerver/threads/thpool.h"
@@ -346,6 +350,11 @@ static CerverAuthError auth_with_token_normal (
 	CerverAuthError error = CERVER_AUTH_ERROR_NONE;
 
 	if (packet && auth_data) {
+		// the client can't be deleted while we register the connection
+		const unsigned int token = client_registry_read_start (
+			packet->cerver->clients
+		);
+
 		// if we get a token, search for a client with the same token
 		Client *client = client_get_by_session_id (
 			packet->cerver, auth_data->token->str
@@ -361,14 +370,17 @@ static CerverAuthError auth_with_token_normal (
 			);
 			#endif
 
-			if (!connection_register_to_client (client, packet->connection)) {
-				(void) connection_register_to_cerver (
-					packet->cerver, client, packet->connection
-				);
+			// the client might have started to be dropped after we found him
+			if (connection_register_to_registered_client (
+				packet->cerver, client, packet->connection
+			)) {
+				client = NULL;
 			}
 		}
 
-		else {
+		client_registry_read_end (packet->cerver->clients, token);
+
+		if (!client) {
 			cerver_log_error (
 				"Failed to get CLIENT with matching session id <%s> in cerver %s",
 				auth_data->token->str, packet->cerver->info->name
@@ -776,8 +788,10 @@ static CerverAuthError admin_auth_try (Packet *packet) {
 
 				// added connection to client with matching id (token)
 				else {
-					Admin *admin = admin_get_by_sock_fd (
-						packet->cerver->admin, packet->connection->socket->sock_fd
+					// the connection is not in the fd table until
+					// it has been registered to the admin poll
+					Admin *admin = admin_get_by_client (
+						packet->cerver->admin, packet->connection->client
 					);
 
 					if (admin) {
@@ -1019,16 +1033,15 @@ u8 on_hold_connection (Cerver *cerver, Connection *connection) {
 			if (!on_hold_poll_register_connection (cerver, connection)) {
 				avl_insert_node (cerver->on_hold_connections, connection);
 
-				const void *key = &connection->socket->sock_fd;
-				if (!htab_insert (
-					cerver->on_hold_connection_sock_fd_map,
-					key, sizeof (i32),
-					connection, sizeof (Connection)
+				// on hold connections don't have a client yet
+				if (!fd_table_set (
+					cerver->fd_table, connection->socket->sock_fd,
+					NULL, connection
 				)) {
 					#ifdef AUTH_DEBUG
 					cerver_log_debug (
 						"on_hold_connection () - "
-						"inserted connection in on_hold_connection_sock_fd_map htab"
+						"inserted connection in cerver's fd table"
 					);
 					#endif
 
@@ -1038,7 +1051,7 @@ u8 on_hold_connection (Cerver *cerver, Connection *connection) {
 				else {
 					cerver_log_error (
 						"on_hold_connection () - "
-						"failed to insert connection in on_hold_connection_sock_fd_map htab!"
+						"failed to insert connection in cerver's fd table!"
 					);
 				}
 			}
@@ -1080,26 +1093,20 @@ static u8 on_hold_connection_remove (
 				);
 			}
 
-			// remove connection from on hold map
-			const void *key = &connection->socket->sock_fd;
-			if (htab_remove (
-				cerver->on_hold_connection_sock_fd_map, key, sizeof (i32))
-			) {
+			// remove the on hold connection from the fd table
+			// if it has already been registered to a client, its entry is kept
+			if (!fd_table_remove (
+				cerver->fd_table, connection->socket->sock_fd,
+				NULL, connection
+			)) {
 				#ifdef AUTH_DEBUG
 				cerver_log_debug (
 					"on_hold_connection_remove () - "
-					"removed connection from on_hold_connection_sock_fd_map htab"
+					"removed connection from cerver's fd table"
 				);
 				#endif
 			}
 
-			else {
-				cerver_log_error (
-					"on_hold_connection_remove () - "
-					"failed to remove connection from on_hold_connection_sock_fd_map htab!"
-				);
-			}
-
 			connection_delete (query);
 
 			retval = 0;
@@ -1141,30 +1148,6 @@ void on_hold_connection_drop (
 
 #pragma region poll
 
-static i32 on_hold_get_free_idx (Cerver *cerver) {
-
-	if (cerver) {
-		for (u32 i = 0; i < cerver->max_on_hold_connections; i++)
-			if (cerver->hold_fds[i].fd == -1) return i;
-	}
-
-	return -1;
-
-}
-
-static i32 on_hold_poll_get_idx_by_sock_fd (
-	const Cerver *cerver, i32 sock_fd
-) {
-
-	if (cerver) {
-		for (u32 i = 0; i < cerver->max_on_hold_connections; i++)
-			if (cerver->hold_fds[i].fd == sock_fd) return i;
-	}
-
-	return -1;
-
-}
-
 // regsiters a connection to the cerver's on hold poll array
 // returns 0 on success, 1 on error
 static u8 on_hold_poll_register_connection (
@@ -1174,15 +1157,18 @@ static u8 on_hold_poll_register_connection (
 	u8 retval = 1;
 
 	if (cerver && connection) {
-		// pthread_mutex_lock (cerver->on_hold_poll_lock);
+		pthread_mutex_lock (cerver->on_hold_poll_lock);
+
+		i32 idx = poll_fds_register (
+			cerver->hold_fds,
+			cerver->max_on_hold_connections, &cerver->current_on_hold_nfds,
+			cerver->hold_fds_map,
+			connection->socket->sock_fd, POLLIN
+		);
 
-		i32 idx = on_hold_get_free_idx (cerver);
 		if (idx >= 0) {
-			cerver->hold_fds[idx].fd = connection->socket->sock_fd;
-			cerver->hold_fds[idx].events = POLLIN;
-			cerver->current_on_hold_nfds++;
 
-			cerver->stats->current_n_hold_connections++;
+			STATS_ADD (cerver->stats->current_n_hold_connections, 1);
 
 			#ifdef AUTH_DEBUG
 			cerver_log (
@@ -1213,7 +1199,7 @@ static u8 on_hold_poll_register_connection (
 			#endif
 		}
 
-		// pthread_mutex_unlock (cerver->on_hold_poll_lock);
+		pthread_mutex_unlock (cerver->on_hold_poll_lock);
 	}
 
 	return retval;
@@ -1229,16 +1215,16 @@ u8 on_hold_poll_unregister_sock_fd (
 	u8 retval = 1;
 
 	if (cerver) {
-		// pthread_mutex_lock (cerver->on_hold_poll_lock);
+		pthread_mutex_lock (cerver->on_hold_poll_lock);
+
+		// its slot is compacted by the on hold poll thread
+		i32 idx = poll_fds_unregister (
+			cerver->hold_fds, cerver->hold_fds_map, sock_fd
+		);
 
-		i32 idx = on_hold_poll_get_idx_by_sock_fd (cerver, sock_fd);
 		if (idx >= 0) {
-			cerver->hold_fds[idx].fd = -1;
-			cerver->hold_fds[idx].events = -1;
-			cerver->hold_fds[idx].revents = -1;
-			cerver->current_on_hold_nfds--;
 
-			cerver->stats->current_n_hold_connections--;
+			STATS_SUB (cerver->stats->current_n_hold_connections, 1);
 
 			#ifdef AUTH_DEBUG
 			cerver_log (
@@ -1270,7 +1256,7 @@ u8 on_hold_poll_unregister_sock_fd (
 			// #endif
 		}
 
-		// pthread_mutex_unlock (cerver->on_hold_poll_lock);
+		pthread_mutex_unlock (cerver->on_hold_poll_lock);
 	}
 
 	return retval;
@@ -1289,34 +1275,40 @@ static u8 on_hold_poll_unregister_connection (
 }
 
 static inline void on_hold_poll_handle (
-	Cerver *cerver, char *packet_buffer
+	Cerver *cerver, const u32 n_fds,
+	CerverReceive *cr, char *packet_buffer
 ) {
 
 	// one or more fd(s) are readable, need to determine which ones they are
-	for (u32 idx = 0; idx < cerver->max_on_hold_connections; idx++) {
-		if (cerver->hold_fds[idx].fd > -1) {
-			CerverReceive *cr = cerver_receive_create (
-				RECEIVE_TYPE_ON_HOLD, cerver, cerver->hold_fds[idx].fd
-			);
+	// fds are never moved until every event has been handled,
+	// but another thread might have freed their slot meanwhile
+	struct pollfd active_fd = { 0 };
+	for (u32 idx = 0; idx < n_fds; idx++) {
+		if (cerver->hold_fds[idx].revents) {
+			active_fd.fd = poll_fds_get (cerver->hold_fds, idx);
+			active_fd.revents = cerver->hold_fds[idx].revents;
+			cerver->hold_fds[idx].revents = 0;
+
+			if (active_fd.fd >= 0) {
+				cerver_receive_init (
+					cr, RECEIVE_TYPE_ON_HOLD, cerver, active_fd.fd
+				);
 
-			if (cr) {
-				switch (cerver->hold_fds[idx].revents) {
-					case POLLIN: {
-						cerver_receive_internal (
-							cr,
-							packet_buffer,
-							cerver->on_hold_receive_buffer_size
-						);
-					} break;
+				if (cr->socket) {
+					switch (active_fd.revents) {
+						case POLLIN: {
+							cerver_receive_internal (
+								cr,
+								packet_buffer,
+								cerver->on_hold_receive_buffer_size
+							);
+						} break;
 
-					default: {
-						if (cerver->hold_fds[idx].revents != 0) {
+						default: {
 							cerver_receive_handle_failed (cr);
-						}
-					} break;
+						} break;
+					}
 				}
-
-				cerver_receive_delete (cr);
 			}
 		}
 	}
@@ -1335,7 +1327,18 @@ void *on_hold_poll (void *cerver_ptr) {
 			cerver->info->name
 		);
 
-		(void) thread_set_name ("%s-on-hold", cerver->info->alias);
+		char thread_name[THREAD_NAME_BUFFER_SIZE] = { 0 };
+		(void) snprintf (
+			thread_name, THREAD_NAME_BUFFER_SIZE,
+			"%s-on-hold", cerver->info->alias
+		);
+
+		(void) thread_set_name ("%s", thread_name);
+
+		// pin the thread before allocating its packet buffer
+		ThreadAffinity affinity;
+		cerver_get_affinity (cerver, 1, &affinity);
+		(void) thread_affinity_apply (&affinity, 0, thread_name);
 
 		char *packet_buffer = (char *) calloc (
 			cerver->on_hold_receive_buffer_size, sizeof (char)
@@ -1349,12 +1352,19 @@ void *on_hold_poll (void *cerver_ptr) {
 			);
 			#endif
 
+			CerverReceive cr = { 0 };
+
+			u32 n_fds = 0;
 			int poll_retval = 0;
 			while (cerver->isRunning) {
+				// other threads can only append new fds
+				// or free their slots while we are polling
+				(void) pthread_mutex_lock (cerver->on_hold_poll_lock);
+				n_fds = cerver->current_on_hold_nfds;
+				(void) pthread_mutex_unlock (cerver->on_hold_poll_lock);
+
 				poll_retval = poll (
-					cerver->hold_fds,
-					cerver->max_on_hold_connections,
-					cerver->on_hold_poll_timeout
+					cerver->hold_fds, n_fds, cerver->on_hold_poll_timeout
 				);
 
 				switch (poll_retval) {
@@ -1380,14 +1390,19 @@ void *on_hold_poll (void *cerver_ptr) {
 					} break;
 
 					default: {
-						if (cerver->current_on_hold_nfds) {
-							on_hold_poll_handle (
-								cerver,
-								packet_buffer
-							);
-						}
+						on_hold_poll_handle (
+							cerver, n_fds,
+							&cr, packet_buffer
+						);
 					} break;
 				}
+
+				(void) pthread_mutex_lock (cerver->on_hold_poll_lock);
+				poll_fds_compact (
+					cerver->hold_fds, &cerver->current_on_hold_nfds,
+					cerver->hold_fds_map, 0
+				);
+				(void) pthread_mutex_unlock (cerver->on_hold_poll_lock);
 			}
 
 			#ifdef AUTH_DEBUG
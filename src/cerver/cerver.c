@@ -10,6 +10,7 @@
 #include <unistd.h>
 
 #include <sys/poll.h>
+#include <sys/socket.h>
 
 #include "cerver/types/types.h"
 #include "cerver/types/string.h"
@@ -25,13 +26,17 @@
 #include "cerver/connection.h"
 #include "cerver/events.h"
 #include "cerver/errors.h"
+#include "cerver/fdtable.h"
 #include "cerver/files.h"
 #include "cerver/handler.h"
 #include "cerver/network.h"
 #include "cerver/packets.h"
+#include "cerver/poll.h"
+#include "cerver/registry.h"
 
 #include "cerver/threads/thread.h"
 #include "cerver/threads/thpool.h"
+#include "cerver/threads/wheel.h"
 
 #include "cerver/game/game.h"
 
@@ -54,6 +59,8 @@ void cerver_end (void) {
 
 	cerver_log_end ();
 
+	packets_pool_end ();
+
 }
 
 #pragma endregion
@@ -96,6 +103,30 @@ const char *cerver_handler_type_description (CerverHandlerType type) {
 
 }
 
+const char *cerver_handler_dispatch_to_string (CerverHandlerDispatch dispatch) {
+
+	switch (dispatch) {
+		#define XX(num, name, string, description) case CERVER_HANDLER_DISPATCH_##name: return #string;
+		CERVER_HANDLER_DISPATCH_MAP(XX)
+		#undef XX
+	}
+
+	return cerver_handler_dispatch_to_string (CERVER_HANDLER_DISPATCH_ID);
+
+}
+
+const char *cerver_handler_dispatch_description (CerverHandlerDispatch dispatch) {
+
+	switch (dispatch) {
+		#define XX(num, name, string, description) case CERVER_HANDLER_DISPATCH_##name: return #description;
+		CERVER_HANDLER_DISPATCH_MAP(XX)
+		#undef XX
+	}
+
+	return cerver_handler_dispatch_description (CERVER_HANDLER_DISPATCH_ID);
+
+}
+
 #pragma endregion
 
 #pragma region info
@@ -223,8 +254,24 @@ static CerverStats *cerver_stats_new (void) {
 	CerverStats *cerver_stats = (CerverStats *) malloc (sizeof (CerverStats));
 	if (cerver_stats) {
 		(void) memset (cerver_stats, 0, sizeof (CerverStats));
-		cerver_stats->received_packets = packets_per_type_new ();
-		cerver_stats->sent_packets = packets_per_type_new ();
+
+		// each shard is aligned to its own cache line
+		cerver_stats->shards = (CerverStatsShard *) aligned_alloc (
+			CERVER_STATS_CACHE_LINE,
+			CERVER_STATS_SHARDS * sizeof (CerverStatsShard)
+		);
+
+		if (cerver_stats->shards) {
+			(void) memset (
+				cerver_stats->shards, 0,
+				CERVER_STATS_SHARDS * sizeof (CerverStatsShard)
+			);
+		}
+
+		else {
+			free (cerver_stats);
+			cerver_stats = NULL;
+		}
 	}
 
 	return cerver_stats;
@@ -234,14 +281,88 @@ static CerverStats *cerver_stats_new (void) {
 static void cerver_stats_delete (CerverStats *cerver_stats) {
 
 	if (cerver_stats) {
-		packets_per_type_delete (cerver_stats->received_packets);
-		packets_per_type_delete (cerver_stats->sent_packets);
+		free (cerver_stats->shards);
 
 		free (cerver_stats);
 	}
 
 }
 
+// the idx of the shard that each thread updates, 0 if it has not been set
+static _Thread_local unsigned int cerver_stats_shard_idx = 0;
+static unsigned int cerver_stats_shards_next = 0;
+
+CerverStatsShard *cerver_stats_shard (Cerver *cerver) {
+
+	if (!cerver_stats_shard_idx) {
+		cerver_stats_shard_idx = __atomic_add_fetch (
+			&cerver_stats_shards_next, 1, __ATOMIC_RELAXED
+		);
+	}
+
+	return &cerver->stats->shards[
+		(cerver_stats_shard_idx - 1) & (CERVER_STATS_SHARDS - 1)
+	];
+
+}
+
+static void cerver_stats_shard_add (
+	CerverStats *snapshot, const CerverStatsShard *shard
+) {
+
+	snapshot->client_n_packets_received += STATS_GET (shard->client_n_packets_received);
+	snapshot->client_receives_done += STATS_GET (shard->client_receives_done);
+	snapshot->client_bytes_received += STATS_GET (shard->client_bytes_received);
+
+	snapshot->on_hold_n_packets_received += STATS_GET (shard->on_hold_n_packets_received);
+	snapshot->on_hold_receives_done += STATS_GET (shard->on_hold_receives_done);
+	snapshot->on_hold_bytes_received += STATS_GET (shard->on_hold_bytes_received);
+
+	snapshot->total_n_packets_received += STATS_GET (shard->total_n_packets_received);
+	snapshot->total_n_receives_done += STATS_GET (shard->total_n_receives_done);
+	snapshot->total_bytes_received += STATS_GET (shard->total_bytes_received);
+	snapshot->receive_contexts_allocated += STATS_GET (shard->receive_contexts_allocated);
+
+	snapshot->receive_wakeups += STATS_GET (shard->receive_wakeups);
+	snapshot->receive_wakeups_bytes += STATS_GET (shard->receive_wakeups_bytes);
+	snapshot->receive_budget_exhausted += STATS_GET (shard->receive_budget_exhausted);
+
+	snapshot->n_packets_sent += STATS_GET (shard->n_packets_sent);
+	snapshot->total_bytes_sent += STATS_GET (shard->total_bytes_sent);
+
+	packets_per_type_add (&snapshot->received_packets, &shard->received_packets);
+	packets_per_type_add (&snapshot->sent_packets, &shard->sent_packets);
+
+}
+
+// aggregates every stats shard & copies the cerver stats into snapshot
+// the snapshot does not reference any of the cerver's data
+void cerver_stats_snapshot (Cerver *cerver, CerverStats *snapshot) {
+
+	if (cerver && cerver->stats && snapshot) {
+		const CerverStats *stats = cerver->stats;
+
+		(void) memset (snapshot, 0, sizeof (CerverStats));
+
+		snapshot->threshold_time = stats->threshold_time;
+
+		for (unsigned int idx = 0; idx < CERVER_STATS_SHARDS; idx++)
+			cerver_stats_shard_add (snapshot, &stats->shards[idx]);
+
+		snapshot->current_active_client_connections = STATS_GET (stats->current_active_client_connections);
+		snapshot->current_n_connected_clients = STATS_GET (stats->current_n_connected_clients);
+		snapshot->current_n_hold_connections = STATS_GET (stats->current_n_hold_connections);
+		snapshot->total_on_hold_connections = STATS_GET (stats->total_on_hold_connections);
+		snapshot->total_n_clients = STATS_GET (stats->total_n_clients);
+		snapshot->unique_clients = STATS_GET (stats->unique_clients);
+		snapshot->total_client_connections = STATS_GET (stats->total_client_connections);
+		snapshot->inactive_clients_dropped = STATS_GET (stats->inactive_clients_dropped);
+
+		packets_pool_stats (&snapshot->packets_pool);
+	}
+
+}
+
 // sets the cerver stats threshold time (how often the stats get reset)
 void cerver_stats_set_threshold_time (
 	Cerver *cerver, time_t threshold_time
@@ -257,42 +378,98 @@ void cerver_stats_print (Cerver *cerver, bool received, bool sent) {
 
 	if (cerver) {
 		if (cerver->stats) {
+			CerverStats stats = { 0 };
+			cerver_stats_snapshot (cerver, &stats);
+
 			cerver_log_msg ("\nCerver's %s stats:\n", cerver->info->name);
-			cerver_log_msg ("Threshold time:                %ld\n", cerver->stats->threshold_time);
+			cerver_log_msg ("Threshold time:                %ld\n", stats.threshold_time);
 
 			if (cerver->auth_required) {
-				cerver_log_msg ("Client packets received:       %ld", cerver->stats->client_n_packets_received);
-				cerver_log_msg ("Client receives done:          %ld", cerver->stats->client_receives_done);
-				cerver_log_msg ("Client bytes received:         %ld\n", cerver->stats->client_bytes_received);
+				cerver_log_msg ("Client packets received:       %ld", stats.client_n_packets_received);
+				cerver_log_msg ("Client receives done:          %ld", stats.client_receives_done);
+				cerver_log_msg ("Client bytes received:         %ld\n", stats.client_bytes_received);
 
-				cerver_log_msg ("On hold packets received:      %ld", cerver->stats->on_hold_n_packets_received);
-				cerver_log_msg ("On hold receives done:         %ld", cerver->stats->on_hold_receives_done);
-				cerver_log_msg ("On hold bytes received:        %ld\n", cerver->stats->on_hold_bytes_received);
+				cerver_log_msg ("On hold packets received:      %ld", stats.on_hold_n_packets_received);
+				cerver_log_msg ("On hold receives done:         %ld", stats.on_hold_receives_done);
+				cerver_log_msg ("On hold bytes received:        %ld\n", stats.on_hold_bytes_received);
 			}
 
-			cerver_log_msg ("Total packets received:        %ld", cerver->stats->total_n_packets_received);
-			cerver_log_msg ("Total receives done:           %ld", cerver->stats->total_n_receives_done);
-			cerver_log_msg ("Total bytes received:          %ld\n", cerver->stats->total_bytes_received);
+			cerver_log_msg ("Total packets received:        %ld", stats.total_n_packets_received);
+			cerver_log_msg ("Total receives done:           %ld", stats.total_n_receives_done);
+			cerver_log_msg ("Total bytes received:          %ld", stats.total_bytes_received);
+			cerver_log_msg ("Receive contexts allocated:    %ld\n", stats.receive_contexts_allocated);
 
-			cerver_log_msg ("N packets sent:                %ld", cerver->stats->n_packets_sent);
-			cerver_log_msg ("Total bytes sent:              %ld\n", cerver->stats->total_bytes_sent);
+			cerver_log_msg ("Receive wakeups:               %ld", stats.receive_wakeups);
+			cerver_log_msg (
+				"Average bytes per wakeup:      %ld",
+				stats.receive_wakeups ?
+					stats.receive_wakeups_bytes / stats.receive_wakeups : 0
+			);
+			cerver_log_msg ("Receive budget exhausted:      %ld\n", stats.receive_budget_exhausted);
+
+			cerver_log_msg ("N packets sent:                %ld", stats.n_packets_sent);
+			cerver_log_msg ("Total bytes sent:              %ld\n", stats.total_bytes_sent);
+
+			cerver_log_msg ("Packets pool hits:             %ld", stats.packets_pool.hits);
+			cerver_log_msg ("Packets pool misses:           %ld\n", stats.packets_pool.misses);
+
+			cerver_log_msg ("Current active client connections:         %ld", stats.current_active_client_connections);
+			cerver_log_msg ("Current connected clients:                 %ld", stats.current_n_connected_clients);
+			cerver_log_msg ("Current on hold connections:               %ld", stats.current_n_hold_connections);
+			cerver_log_msg ("Total on hold connections:                 %ld", stats.total_on_hold_connections);
+			cerver_log_msg ("Total clients:                             %ld", stats.total_n_clients);
+			cerver_log_msg ("Unique clients:                            %ld", stats.unique_clients);
+			cerver_log_msg ("Total client connections:                  %ld", stats.total_client_connections);
+			cerver_log_msg ("Inactive clients dropped:                  %ld", stats.inactive_clients_dropped);
+
+			if (cerver->reactors) {
+				CerverReactor *reactor = NULL;
+				for (unsigned int i = 0; i < cerver->n_reactors; i++) {
+					reactor = cerver->reactors[i];
+
+					cerver_log_msg ("\nReactor %u:", reactor->id);
+					cerver_log_msg ("Current active client connections:         %ld", reactor->stats.current_active_client_connections);
+					cerver_log_msg ("Total client connections:                  %ld", reactor->stats.total_client_connections);
+					cerver_log_msg ("Wakeups:                                   %ld", reactor->stats.n_wakeups);
+					cerver_log_msg ("Events:                                    %ld", reactor->stats.n_events);
+					cerver_log_msg ("Bytes received:                            %ld", reactor->stats.bytes_received);
+				}
+			}
 
-			cerver_log_msg ("Current active client connections:         %ld", cerver->stats->current_active_client_connections);
-			cerver_log_msg ("Current connected clients:                 %ld", cerver->stats->current_n_connected_clients);
-			cerver_log_msg ("Current on hold connections:               %ld", cerver->stats->current_n_hold_connections);
-			cerver_log_msg ("Total on hold connections:                 %ld", cerver->stats->total_on_hold_connections);
-			cerver_log_msg ("Total clients:                             %ld", cerver->stats->total_n_clients);
-			cerver_log_msg ("Unique clients:                            %ld", cerver->stats->unique_clients);
-			cerver_log_msg ("Total client connections:                  %ld", cerver->stats->total_client_connections);
+			if (cerver->uring) {
+				cerver_log_msg ("\nIO-Uring:");
+				cerver_log_msg ("Submits:                                   %ld", cerver->uring->stats.n_submits);
+				cerver_log_msg ("Completions:                               %ld", cerver->uring->stats.n_completions);
+				cerver_log_msg ("Accepts:                                   %ld", cerver->uring->stats.n_accepts);
+				cerver_log_msg ("Receives:                                  %ld", cerver->uring->stats.n_receives);
+				cerver_log_msg ("Bytes received:                            %ld", cerver->uring->stats.bytes_received);
+				cerver_log_msg ("Sends:                                     %ld", cerver->uring->stats.n_sends);
+				cerver_log_msg ("Bytes sent:                                %ld", cerver->uring->stats.bytes_sent);
+				cerver_log_msg ("No buffers:                                %ld", cerver->uring->stats.n_no_buffers);
+				cerver_log_msg ("Re-arms:                                   %ld", cerver->uring->stats.n_rearms);
+			}
+
+			if (cerver->udp) {
+				cerver_log_msg ("\nUdp:");
+				cerver_log_msg ("Receive batches:                           %ld", cerver->udp->stats.n_receive_batches);
+				cerver_log_msg ("Datagrams received:                        %ld", cerver->udp->stats.n_datagrams_received);
+				cerver_log_msg ("Datagrams truncated:                       %ld", cerver->udp->stats.n_datagrams_truncated);
+				cerver_log_msg ("Send batches:                              %ld", cerver->udp->stats.n_send_batches);
+				cerver_log_msg ("Datagrams sent:                            %ld", cerver->udp->stats.n_datagrams_sent);
+				cerver_log_msg ("Current peers:                             %ld", cerver->udp->stats.current_peers);
+				cerver_log_msg ("Total peers:                               %ld", cerver->udp->stats.total_peers);
+				cerver_log_msg ("Peers timeout:                             %ld", cerver->udp->stats.n_peers_timeout);
+				cerver_log_msg ("Peers refused:                             %ld", cerver->udp->stats.n_peers_refused);
+			}
 
 			if (received) {
 				cerver_log_msg ("\nReceived packets:");
-				packets_per_type_print (cerver->stats->received_packets);
+				packets_per_type_print (&stats.received_packets);
 			}
 
 			if (sent) {
 				cerver_log_msg ("\nSent packets:");
-				packets_per_type_print (cerver->stats->sent_packets);
+				packets_per_type_print (&stats.sent_packets);
 			}
 
 			cerver_log_msg ("\n");
@@ -320,6 +497,8 @@ void cerver_stats_print (Cerver *cerver, bool received, bool sent) {
 
 #pragma region main
 
+static void cerver_inactive_delete (void *inactive_ptr);
+
 Cerver *cerver_new (void) {
 
 	Cerver *cerver = (Cerver *) malloc (sizeof (Cerver));
@@ -348,12 +527,13 @@ Cerver *cerver_new (void) {
 		cerver->sockets_pool = NULL;
 
 		cerver->clients = NULL;
-		cerver->client_sock_fd_map = NULL;
+		cerver->fd_table = NULL;
 
 		cerver->inactive_clients = false;
 		cerver->max_inactive_time = CERVER_DEFAULT_MAX_INACTIVE_TIME;
 		cerver->check_inactive_interval = CERVER_DEFAULT_CHECK_INACTIVE_INTERVAL;
-		cerver->inactive_thread_id = 0;
+		cerver->inactive_timer = NULL;
+		cerver->inactive = NULL;
 
 		cerver->handler_type = CERVER_HANDLER_TYPE_NONE;
 
@@ -362,20 +542,38 @@ Cerver *cerver_new (void) {
 		cerver->fds = NULL;
 		cerver->max_n_fds = CERVER_DEFAULT_POLL_FDS;
 		cerver->current_n_fds = 0;
+		cerver->fds_map = NULL;
 		cerver->poll_timeout = CERVER_DEFAULT_POLL_TIMEOUT;
 		cerver->poll_lock = NULL;
 
+		cerver->pending_fds = NULL;
+		cerver->n_pending_fds = 0;
+		cerver->max_pending_fds = 0;
+
+		cerver->epoll_fd = -1;
+
+		cerver->n_reactors = CERVER_DEFAULT_REACTOR_THREADS;
+		cerver->reactors = NULL;
+		cerver->next_reactor = 0;
+
+		cerver->uring = NULL;
+
+		cerver->udp = NULL;
+		cerver->udp_batch_size = CERVER_DEFAULT_UDP_BATCH_SIZE;
+		cerver->udp_peer_timeout = CERVER_DEFAULT_UDP_PEER_TIMEOUT;
+		cerver->udp_max_peers = CERVER_DEFAULT_UDP_MAX_PEERS;
+
 		cerver->auth_required = CERVER_DEFAULT_AUTH_REQUIRED;
 		cerver->auth_packet = NULL;
 		cerver->max_auth_tries = CERVER_DEFAULT_MAX_AUTH_TRIES;
 		cerver->authenticate = NULL;
 
 		cerver->on_hold_connections = NULL;
-		cerver->on_hold_connection_sock_fd_map = NULL;
 		cerver->hold_fds = NULL;
 		cerver->on_hold_poll_timeout = CERVER_DEFAULT_ON_HOLD_TIMEOUT;
 		cerver->max_on_hold_connections = CERVER_DEFAULT_ON_HOLD_POLL_FDS;
 		cerver->current_on_hold_nfds = 0;
+		cerver->hold_fds_map = NULL;
 		cerver->on_hold_poll_thread_id = 0;
 		cerver->on_hold_poll_lock = NULL;
 		cerver->on_hold_max_bad_packets = CERVER_DEFAULT_ON_HOLD_MAX_BAD_PACKETS;
@@ -388,7 +586,14 @@ Cerver *cerver_new (void) {
 		cerver->handle_received_buffer = NULL;
 
 		cerver->receive_buffer_size = CERVER_DEFAULT_RECEIVE_BUFFER_SIZE;
+		cerver->receive_budget_bytes = CERVER_DEFAULT_RECEIVE_BUDGET_BYTES;
+		cerver->receive_budget_packets = CERVER_DEFAULT_RECEIVE_BUDGET_PACKETS;
 		cerver->max_received_packet_size = CERVER_DEFAULT_MAX_RECEIVED_PACKET_SIZE;
+		cerver->zero_copy_packets = CERVER_DEFAULT_ZERO_COPY_PACKETS;
+
+		cerver->connections_send_queue = CERVER_DEFAULT_CONNECTIONS_SEND_QUEUE;
+		cerver->connections_send_queue_high_water = SEND_QUEUE_DEFAULT_HIGH_WATER;
+		cerver->connections_send_queue_overflow = SEND_QUEUE_DEFAULT_OVERFLOW;
 
 		cerver->app_packet_handler = NULL;
 		cerver->app_error_packet_handler = NULL;
@@ -401,19 +606,25 @@ Cerver *cerver_new (void) {
 		cerver->multiple_handlers = CERVER_DEFAULT_MULTIPLE_HANDLERS;
 		cerver->handlers = NULL;
 		cerver->n_handlers = 0;
+		cerver->handler_dispatch = CERVER_DEFAULT_HANDLER_DISPATCH;
 		cerver->num_handlers_alive = 0;
 		cerver->num_handlers_working = 0;
 		cerver->handlers_lock = NULL;
 
 		cerver->check_packets = CERVER_DEFAULT_CHECK_PACKETS;
 
-		cerver->update_thread_id = 0;
+		thread_affinity_init (&cerver->affinity, THREAD_AFFINITY_NONE);
+		cerver->affinity_threads = 0;
+
+		cerver->timers = NULL;
+
+		cerver->update_timer = NULL;
 		cerver->update = NULL;
 		cerver->update_args = NULL;
 		cerver->delete_update_args = NULL;
 		cerver->update_ticks = CERVER_DEFAULT_UPDATE_TICKS;
 
-		cerver->update_interval_thread_id = 0;
+		cerver->update_interval_timer = NULL;
 		cerver->update_interval = NULL;
 		cerver->update_interval_args = NULL;
 		cerver->delete_update_interval_args = NULL;
@@ -446,12 +657,17 @@ void cerver_delete (void *ptr) {
 			else free (cerver->cerver_data);
 		}
 
-		pool_delete (cerver->sockets_pool);
+		dlist_delete (cerver->sockets_pool);
 
-		if (cerver->clients) avl_delete (cerver->clients);
-		if (cerver->client_sock_fd_map) htab_destroy (cerver->client_sock_fd_map);
+		timer_wheel_delete (cerver->timers);
+		cerver_inactive_delete (cerver->inactive);
+
+		client_registry_delete (cerver->clients);
+		fd_table_delete (cerver->fd_table);
 
 		if (cerver->fds) free (cerver->fds);
+		poll_fds_map_delete (cerver->fds_map);
+		if (cerver->pending_fds) free (cerver->pending_fds);
 
 		// 28/05/2020
 		if (cerver->poll_lock) {
@@ -459,11 +675,19 @@ void cerver_delete (void *ptr) {
 			free (cerver->poll_lock);
 		}
 
+		cerver_epoll_end (cerver);
+
+		cerver_reactors_end (cerver);
+
+		cerver_uring_end (cerver);
+
+		cerver_udp_end (cerver);
+
 		packet_delete (cerver->auth_packet);
 
 		if (cerver->on_hold_connections) avl_delete (cerver->on_hold_connections);
-		if (cerver->on_hold_connection_sock_fd_map) htab_destroy (cerver->on_hold_connection_sock_fd_map);
 		if (cerver->hold_fds) free (cerver->hold_fds);
+		poll_fds_map_delete (cerver->hold_fds_map);
 
 		if (cerver->on_hold_poll_lock) {
 			pthread_mutex_destroy (cerver->on_hold_poll_lock);
@@ -539,6 +763,24 @@ void cerver_set_receive_buffer_size (
 
 }
 
+// sets how much the cerver will read from a client connection
+// every time it gets an event from it before moving to the next one
+// client connections are read until there is no more data
+// or max_bytes have been read or max_packets have been handled
+// use 0 to not limit bytes or packets
+// the default values are CERVER_DEFAULT_RECEIVE_BUDGET_BYTES
+// and CERVER_DEFAULT_RECEIVE_BUDGET_PACKETS
+void cerver_set_receive_budget (
+	Cerver *cerver, const size_t max_bytes, const u32 max_packets
+) {
+
+	if (cerver) {
+		cerver->receive_budget_bytes = max_bytes;
+		cerver->receive_budget_packets = max_packets;
+	}
+
+}
+
 // sets the cerver's ability to use reusable flags in sock fd
 // if TRUE, this can prevent failing when trying to bind address
 // the default value is CERVER_DEFAULT_REUSABLE_FLAGS
@@ -607,6 +849,10 @@ void cerver_set_inactive_clients (
 // sets the cerver handler type
 // the default type is to handle connections using the poll () which requires only one thread
 // if threads type is selected, a new thread will be created for each new connection
+// if epoll type is selected, a single thread will handle only the connections that are ready
+// if reactors type is selected, connections will be split between multiple epoll () threads
+// if io_uring type is selected, a single thread will handle the completions of
+// every accept, receive & send, or epoll type will be used if io_uring is NOT available
 void cerver_set_handler_type (
 	Cerver *cerver, CerverHandlerType handler_type
 ) {
@@ -615,6 +861,77 @@ void cerver_set_handler_type (
 
 }
 
+// sets the number of reactors threads to use if cerver handler type is CERVER_HANDLER_TYPE_REACTORS
+// each reactor has its own epoll instance, packet buffer & stats
+// 0 to use one reactor per online cpu (default)
+// returns 0 on success, 1 on error
+u8 cerver_set_reactor_threads (
+	Cerver *cerver, unsigned int n_reactors
+) {
+
+	u8 retval = 1;
+
+	if (cerver) {
+		if (!cerver->isRunning) {
+			cerver_reactors_end (cerver);
+
+			retval = cerver_reactors_create (cerver, n_reactors);
+		}
+	}
+
+	return retval;
+
+}
+
+// sets the cpu in which the reactor with the matching idx will run
+// must be called after cerver_set_reactor_threads () & before the cerver starts
+// returns 0 on success, 1 on error
+u8 cerver_set_reactor_cpu (
+	Cerver *cerver, unsigned int reactor_idx, int cpu
+) {
+
+	u8 retval = 1;
+
+	if (cerver) {
+		if (cerver->reactors && (reactor_idx < cerver->n_reactors)) {
+			cerver->reactors[reactor_idx]->cpu = cpu;
+
+			retval = 0;
+		}
+	}
+
+	return retval;
+
+}
+
+// sets the udp options to be used if the cerver's protocol is PROTOCOL_UDP
+// batch_size - max number of datagrams to receive & send in a single call
+// peer_timeout - secs after an idle peer is removed, 0 to never remove peers
+// the default values are CERVER_DEFAULT_UDP_BATCH_SIZE
+// and CERVER_DEFAULT_UDP_PEER_TIMEOUT
+void cerver_set_udp_options (
+	Cerver *cerver, u32 batch_size, u32 peer_timeout
+) {
+
+	if (cerver) {
+		if (batch_size) cerver->udp_batch_size = batch_size;
+		cerver->udp_peer_timeout = peer_timeout;
+	}
+
+}
+
+// sets the max number of udp peers that the cerver keeps at the same time
+// datagrams from new peers are ignored until others are removed
+// a max peers of 0 lets the cerver keep any number of peers
+// the default value is CERVER_DEFAULT_UDP_MAX_PEERS
+void cerver_set_udp_max_peers (
+	Cerver *cerver, u32 max_peers
+) {
+
+	if (cerver) cerver->udp_max_peers = max_peers;
+
+}
+
 // set the ability to handle new connections if cerver handler type is CERVER_HANDLER_TYPE_THREADS
 // by only creating new detachable threads for each connection
 // by default, this option is turned off to also use the thpool
@@ -760,6 +1077,40 @@ void cerver_set_max_received_packet_size (
 
 }
 
+// enables zero copy packets, by default, this option is turned off
+// complete packets in the receive buffer will reference the buffer itself
+// instead of copying their data, only split packets will be copied
+// the packet's data is only valid while the handler method executes,
+// so call packet_retain () to keep using it after the handler returns
+// packets pushed to a handler's job queue are always retained
+void cerver_set_zero_copy_packets (
+	Cerver *cerver, bool zero_copy_packets
+) {
+
+	if (cerver) cerver->zero_copy_packets = zero_copy_packets;
+
+}
+
+// enables a send queue in every client connection, by default, this option is turned off
+// packets sent to a connection are appended to its queue without blocking
+// and are sent together when the connection's socket is writable
+// high_water & overflow are set to each connection's queue,
+// check connection_set_send_queue_high_water () for their values
+// only used with CERVER_HANDLER_TYPE_EPOLL, CERVER_HANDLER_TYPE_REACTORS
+// & CERVER_HANDLER_TYPE_IO_URING as other handlers never flush the queues
+void cerver_set_connections_send_queue (
+	Cerver *cerver,
+	const size_t high_water, const SendQueueOverflow overflow
+) {
+
+	if (cerver) {
+		cerver->connections_send_queue = true;
+		cerver->connections_send_queue_high_water = high_water;
+		cerver->connections_send_queue_overflow = overflow;
+	}
+
+}
+
 // sets customs PACKET_TYPE_APP and PACKET_TYPE_APP_ERROR packet types handlers
 void cerver_set_app_handlers (
 	Cerver *cerver, Handler *app_handler, Handler *app_error_handler
@@ -858,6 +1209,50 @@ int cerver_set_multiple_handlers (
 
 }
 
+// sets how packets are routed between multiple app handlers
+// CERVER_HANDLER_DISPATCH_ID lets the client select the handler
+// using the packet's header handler id (default)
+// CERVER_HANDLER_DISPATCH_CONNECTION & CERVER_HANDLER_DISPATCH_CLIENT
+// always send the packets of the same connection (or client)
+// to the same handler, so they are handled in the order they arrived
+void cerver_set_handler_dispatch_policy (
+	Cerver *cerver, CerverHandlerDispatch dispatch
+) {
+
+	if (cerver) cerver->handler_dispatch = dispatch;
+
+}
+
+// sets the cpus where the cerver's internal threads will run
+// handlers, thpool, reactors, on hold, admin & timers threads
+// with THREAD_AFFINITY_SPREAD & THREAD_AFFINITY_COMPACT
+// every thread gets its own cpu in the order they are started
+// handlers & reactors with their own affinity or cpu keep them
+// must be called before the cerver starts
+void cerver_set_affinity (
+	Cerver *cerver, const ThreadAffinity *affinity
+) {
+
+	if (cerver && affinity) cerver->affinity = *affinity;
+
+}
+
+// copies the cerver's affinity into affinity for a group of n threads
+// that will use their idx in the group to select their cpu
+void cerver_get_affinity (
+	Cerver *cerver, const unsigned int n_threads,
+	ThreadAffinity *affinity
+) {
+
+	*affinity = cerver->affinity;
+	if (cerver->affinity.type != THREAD_AFFINITY_NONE) {
+		affinity->offset += __atomic_fetch_add (
+			&cerver->affinity_threads, n_threads, __ATOMIC_RELAXED
+		);
+	}
+
+}
+
 // set whether to check or not incoming packets
 // check packet's header protocol id & version compatibility
 // if packets do not pass the checks, won't be handled and will be inmediately destroyed
@@ -874,7 +1269,7 @@ void cerver_set_check_packets (
 }
 
 // sets a custom cerver update function to be executed every n ticks
-// a new thread will be created that will call your method each tick
+// a timer in the cerver's timers thread will call your method each tick
 // the update args will be passed to your method as a CerverUpdate &
 // will only be deleted at cerver teardown if you set the delete_update_args ()
 void cerver_set_update (
@@ -894,7 +1289,7 @@ void cerver_set_update (
 }
 
 // sets a custom cerver update method to be executed every x seconds (in intervals)
-// a new thread will be created that will call your method every x seconds
+// a timer in the cerver's timers thread will call your method every x seconds
 // the update args will be passed to your method as a CerverUpdate &
 // will only be deleted at cerver teardown if you set the delete_update_args ()
 void cerver_set_update_interval (
@@ -935,18 +1330,22 @@ u8 cerver_set_admin_enable (Cerver *cerver) {
 
 #pragma region sockets
 
+// the sockets are kept in FIFO order, unlike in a Pool
+// so a dropped socket is the last one to be reused
 static int cerver_sockets_pool_init (Cerver *cerver) {
 
 	int retval = 1;
 
 	if (cerver) {
-		cerver->sockets_pool = pool_create (socket_delete);
+		cerver->sockets_pool = dlist_init (socket_delete, NULL);
 		if (cerver->sockets_pool) {
-			retval = pool_init (
-				cerver->sockets_pool,
-				socket_create_empty,
-				cerver->sockets_pool_init
-			);
+			retval = 0;
+
+			for (unsigned int i = 0; i < cerver->sockets_pool_init; i++) {
+				retval |= dlist_insert_at_end (
+					cerver->sockets_pool, socket_create_empty ()
+				);
+			}
 		}
 	}
 
@@ -959,7 +1358,7 @@ int cerver_sockets_pool_push (Cerver *cerver, Socket *socket) {
 	int retval = 1;
 
 	if (cerver && socket) {
-		retval = pool_push (cerver->sockets_pool, socket);
+		retval = dlist_insert_at_end (cerver->sockets_pool, socket);
 		// printf ("push!\n");
 	}
 
@@ -972,7 +1371,8 @@ Socket *cerver_sockets_pool_pop (Cerver *cerver) {
 	Socket *retval = NULL;
 
 	if (cerver) {
-		void *value = pool_pop (cerver->sockets_pool);
+		void *value = dlist_remove_start (cerver->sockets_pool);
+
 		if (value) retval = (Socket *) value;
 		// printf ("pop!\n");
 	}
@@ -984,7 +1384,7 @@ Socket *cerver_sockets_pool_pop (Cerver *cerver) {
 static void cerver_sockets_pool_end (Cerver *cerver) {
 
 	if (cerver) {
-		pool_delete (cerver->sockets_pool);
+		dlist_delete (cerver->sockets_pool);
 		cerver->sockets_pool = NULL;
 	}
 
@@ -1069,9 +1469,9 @@ unsigned int cerver_get_n_handlers_working (Cerver *cerver) {
 	unsigned int retval = 0;
 
 	if (cerver) {
-		(void) pthread_mutex_lock (cerver->handlers_lock);
-		retval = cerver->num_handlers_working;
-		(void) pthread_mutex_unlock (cerver->handlers_lock);
+		retval = __atomic_load_n (
+			&cerver->num_handlers_working, __ATOMIC_RELAXED
+		);
 	}
 
 	return retval;
@@ -1103,7 +1503,7 @@ static u8 cerver_multiple_app_handlers_destroy (Cerver *cerver) {
 			time (&start);
 			while (time_passed < timeout && cerver->num_handlers_alive) {
 				for (unsigned int i = 0; i < cerver->n_handlers; i++) {
-					bsem_post_all (cerver->handlers[i]->job_queue->has_jobs);
+					job_queue_signal_all (cerver->handlers[i]->job_queue);
 					time (&end);
 					time_passed = difftime (end, start);
 				}
@@ -1112,7 +1512,7 @@ static u8 cerver_multiple_app_handlers_destroy (Cerver *cerver) {
 			// poll remaining handlers
 			while (cerver->num_handlers_alive) {
 				for (unsigned int i = 0; i < cerver->n_handlers; i++) {
-					bsem_post_all (cerver->handlers[i]->job_queue->has_jobs);
+					job_queue_signal_all (cerver->handlers[i]->job_queue);
 					sleep (1);
 				}
 			}
@@ -1154,7 +1554,7 @@ static u8 cerver_app_handlers_destroy (Cerver *cerver) {
 			if (cerver->app_packet_handler) {
 				if (!cerver->app_packet_handler->direct_handle) {
 					// stop app handler
-					bsem_post_all (cerver->app_packet_handler->job_queue->has_jobs);
+					job_queue_signal_all (cerver->app_packet_handler->job_queue);
 				}
 			}
 		}
@@ -1172,7 +1572,7 @@ static u8 cerver_app_error_handler_destroy (Cerver *cerver) {
 		if (cerver->app_error_packet_handler) {
 			if (!cerver->app_error_packet_handler->direct_handle) {
 				// stop app error handler
-				bsem_post_all (cerver->app_error_packet_handler->job_queue->has_jobs);
+				job_queue_signal_all (cerver->app_error_packet_handler->job_queue);
 			}
 		}
 	}
@@ -1189,7 +1589,7 @@ static u8 cerver_custom_handler_destroy (Cerver *cerver) {
 		if (cerver->custom_packet_handler) {
 			if (!cerver->custom_packet_handler->direct_handle) {
 				// stop custom handler
-				bsem_post_all (cerver->custom_packet_handler->job_queue->has_jobs);
+				job_queue_signal_all (cerver->custom_packet_handler->job_queue);
 			}
 		}
 	}
@@ -1221,13 +1621,13 @@ static u8 cerver_handlers_destroy (Cerver *cerver) {
 		// poll remaining handlers
 		while (cerver->num_handlers_alive) {
 			if (cerver->app_packet_handler)
-				bsem_post_all (cerver->app_packet_handler->job_queue->has_jobs);
+				job_queue_signal_all (cerver->app_packet_handler->job_queue);
 
 			if (cerver->app_error_packet_handler)
-				bsem_post_all (cerver->app_error_packet_handler->job_queue->has_jobs);
+				job_queue_signal_all (cerver->app_error_packet_handler->job_queue);
 
 			if (cerver->custom_packet_handler)
-				bsem_post_all (cerver->custom_packet_handler->job_queue->has_jobs);
+				job_queue_signal_all (cerver->custom_packet_handler->job_queue);
 
 			sleep (1);
 		}
@@ -1363,7 +1763,10 @@ static u8 cerver_network_init_block_socket (Cerver *cerver) {
 	switch (cerver->handler_type) {
 		case CERVER_HANDLER_TYPE_NONE: break;
 
-		case CERVER_HANDLER_TYPE_POLL: {
+		case CERVER_HANDLER_TYPE_POLL:
+		case CERVER_HANDLER_TYPE_EPOLL:
+		case CERVER_HANDLER_TYPE_REACTORS:
+		case CERVER_HANDLER_TYPE_IO_URING: {
 			// set the socket to non blocking mode
 			if (sock_set_blocking (cerver->sock, cerver->blocking)) {
 				cerver->blocking = false;
@@ -1461,10 +1864,10 @@ static u8 cerver_init_poll_fds (Cerver *cerver) {
 	u8 retval = 1;
 
 	cerver->fds = (struct pollfd *) calloc (CERVER_DEFAULT_POLL_FDS, sizeof (struct pollfd));
-	if (cerver->fds) {
-		memset (cerver->fds, 0, sizeof (struct pollfd) * CERVER_DEFAULT_POLL_FDS);
+	cerver->fds_map = poll_fds_map_create (POLL_FDS_MAP_DEFAULT_SIZE);
+	if (cerver->fds && cerver->fds_map) {
 		// set all fds as available spaces
-		for (u32 i = 0; i < CERVER_DEFAULT_POLL_FDS; i++) cerver->fds[i].fd = -1;
+		poll_fds_reset (cerver->fds, 0, CERVER_DEFAULT_POLL_FDS);
 
 		cerver->max_n_fds = CERVER_DEFAULT_POLL_FDS;
 		cerver->current_n_fds = 0;
@@ -1490,14 +1893,11 @@ static u8 cerver_init_data_structures (Cerver *cerver) {
 	u8 retval = 1;
 
 	if (cerver) {
-		cerver->clients = avl_init (
-			cerver->use_sessions ? client_comparator_session_id : client_comparator_client_id,
-			client_delete
-		);
+		cerver->clients = client_registry_create (client_delete);
 
 		if (cerver->clients) {
-			cerver->client_sock_fd_map = htab_create (CERVER_DEFAULT_POLL_FDS, NULL, NULL);
-			if (cerver->client_sock_fd_map) {
+			cerver->fd_table = fd_table_create ();
+			if (cerver->fd_table) {
 				u8 errors = 0;
 
 				// init cerver handler type based values
@@ -1511,6 +1911,33 @@ static u8 cerver_init_data_structures (Cerver *cerver) {
 
 					case CERVER_HANDLER_TYPE_THREADS: break;
 
+					case CERVER_HANDLER_TYPE_EPOLL: {
+						// create the main epoll instance
+						errors |= cerver_epoll_init (cerver);
+					} break;
+
+					case CERVER_HANDLER_TYPE_REACTORS: {
+						// the reactors might have been already configured
+						if (!cerver->reactors) {
+							errors |= cerver_reactors_create (
+								cerver, cerver->n_reactors
+							);
+						}
+					} break;
+
+					case CERVER_HANDLER_TYPE_IO_URING: {
+						if (cerver_uring_init (cerver)) {
+							cerver_log (
+								LOG_TYPE_WARNING, LOG_TYPE_CERVER,
+								"Cerver %s will use epoll instead of io_uring!",
+								cerver->info->name
+							);
+
+							cerver->handler_type = CERVER_HANDLER_TYPE_EPOLL;
+							errors |= cerver_epoll_init (cerver);
+						}
+					} break;
+
 					default: break;
 				}
 
@@ -1532,7 +1959,7 @@ static u8 cerver_init_data_structures (Cerver *cerver) {
 			#ifdef CERVER_DEBUG
 			cerver_log (
 				LOG_TYPE_ERROR, LOG_TYPE_CERVER,
-				"Failed to init clients avl in cerver %s",
+				"Failed to init clients registry in cerver %s",
 				cerver->info->name
 			);
 			#endif
@@ -1606,6 +2033,11 @@ static u8 cerver_one_time_init_thpool (Cerver *cerver) {
 
 			cerver->thpool = thpool_create (cerver->n_thpool_threads);
 			thpool_set_name (cerver->thpool, cerver->info->name);
+
+			ThreadAffinity affinity;
+			cerver_get_affinity (cerver, cerver->n_thpool_threads, &affinity);
+			thpool_set_affinity (cerver->thpool, &affinity);
+
 			if (thpool_init (cerver->thpool)) {
 				cerver_log (
 					LOG_TYPE_ERROR, LOG_TYPE_NONE,
@@ -1710,9 +2142,9 @@ static u8 cerver_one_time_init (Cerver *cerver) {
 
 #pragma region start
 
-static void *cerver_update (void *args);
+static void cerver_update (void *cerver_update_ptr);
 
-static void *cerver_update_interval (void *args);
+static void cerver_update_interval (void *cerver_update_ptr);
 
 // inits cerver's auth capabilities
 static u8 cerver_auth_start (Cerver *cerver) {
@@ -1724,14 +2156,11 @@ static u8 cerver_auth_start (Cerver *cerver) {
 
 		cerver->max_on_hold_connections = CERVER_DEFAULT_POLL_FDS / 2;
 		cerver->on_hold_connections = avl_init (connection_comparator, connection_delete);
-		cerver->on_hold_connection_sock_fd_map = htab_create (cerver->max_on_hold_connections / 4, NULL, NULL);
-		if (cerver->on_hold_connections && cerver->on_hold_connection_sock_fd_map) {
+		if (cerver->on_hold_connections) {
 			cerver->hold_fds = (struct pollfd *) calloc (cerver->max_on_hold_connections, sizeof (struct pollfd));
-			if (cerver->hold_fds) {
-				memset (cerver->hold_fds, 0, sizeof (struct pollfd) * cerver->max_on_hold_connections);
-
-				for (u32 i = 0; i < cerver->max_on_hold_connections; i++)
-					cerver->hold_fds[i].fd = -1;
+			cerver->hold_fds_map = poll_fds_map_create (POLL_FDS_MAP_DEFAULT_SIZE);
+			if (cerver->hold_fds && cerver->hold_fds_map) {
+				poll_fds_reset (cerver->hold_fds, 0, cerver->max_on_hold_connections);
 
 				cerver->current_on_hold_nfds = 0;
 
@@ -1990,15 +2419,22 @@ static u8 cerver_update_start (Cerver *cerver) {
 
 	u8 retval = 1;
 
-	if (!thread_create_detachable (
-		&cerver->update_thread_id,
-		cerver_update,
-		cerver
-	)) {
+	TimerWheel *timers = cerver_timers_get (cerver);
+	CerverUpdate *cu = cerver_update_new (cerver, cerver->update_args);
+	if (timers && cu) {
+		// every tick has an absolute deadline so they don't drift
+		const u64 time_per_frame = 1000000000 / cerver->update_ticks;
+
+		cerver->update_timer = timer_wheel_add (
+			timers, 0, time_per_frame, cerver_update, cu
+		);
+	}
+
+	if (cerver->update_timer) {
 		#ifdef CERVER_DEBUG
 		cerver_log (
 			LOG_TYPE_DEBUG, LOG_TYPE_CERVER,
-			"Created cerver %s UPDATE thread!",
+			"Created cerver %s UPDATE timer!",
 			cerver->info->name
 		);
 		#endif
@@ -2008,9 +2444,11 @@ static u8 cerver_update_start (Cerver *cerver) {
 
 	else {
 		cerver_log_error (
-			"Failed to create cerver %s UPDATE thread!",
+			"Failed to create cerver %s UPDATE timer!",
 			cerver->info->name
 		);
+
+		cerver_update_delete (cu);
 	}
 
 	return retval;
@@ -2021,15 +2459,21 @@ static u8 cerver_update_interval_start (Cerver *cerver) {
 
 	u8 retval = 1;
 
-	if (!thread_create_detachable (
-		&cerver->update_interval_thread_id,
-		cerver_update_interval,
-		cerver
-	)) {
+	TimerWheel *timers = cerver_timers_get (cerver);
+	CerverUpdate *cu = cerver_update_new (cerver, cerver->update_interval_args);
+	if (timers && cu) {
+		cerver->update_interval_timer = timer_wheel_add (
+			timers,
+			0, (u64) cerver->update_interval_secs * 1000000000,
+			cerver_update_interval, cu
+		);
+	}
+
+	if (cerver->update_interval_timer) {
 		#ifdef CERVER_DEBUG
 		cerver_log (
 			LOG_TYPE_DEBUG, LOG_TYPE_CERVER,
-			"Created cerver %s UPDATE INTERVAL thread!",
+			"Created cerver %s UPDATE INTERVAL timer!",
 			cerver->info->name
 		);
 		#endif
@@ -2039,67 +2483,267 @@ static u8 cerver_update_interval_start (Cerver *cerver) {
 
 	else {
 		cerver_log_error (
-			"Failed to create cerver %s UPDATE INTERVAL thread!",
+			"Failed to create cerver %s UPDATE INTERVAL timer!",
 			cerver->info->name
 		);
+
+		cerver_update_delete (cu);
 	}
 
 	return retval;
 
 }
 
-static void cerver_inactive_check (AVLNode *node, Cerver *cerver, time_t current_time) {
+static void cerver_inactive_delete (void *inactive_ptr) {
 
-	cerver_inactive_check (node->right, cerver, current_time);
+	if (inactive_ptr) {
+		CerverInactive *inactive = (CerverInactive *) inactive_ptr;
 
-	// check for client inactivity
-	if (node->id) {
-		Client *client = (Client *) node->id;
+		if (inactive->slots) free (inactive->slots);
 
-		if ((current_time - client->last_activity) >= cerver->max_inactive_time) {
-			// TODO: the client should be dropped
-			cerver_log_warning (
-				"Client %ld has been inactive more than %d secs and should be dropped",
-				client->id, cerver->max_inactive_time
+		thread_mutex_delete (inactive->lock);
+
+		free (inactive_ptr);
+	}
+
+}
+
+static CerverInactive *cerver_inactive_create (const u32 max_inactive_time) {
+
+	CerverInactive *inactive = (CerverInactive *) malloc (sizeof (CerverInactive));
+	if (inactive) {
+		// every client deadline fits in a single turn of the wheel
+		inactive->n_slots = 1;
+		while (
+			(inactive->n_slots <= max_inactive_time)
+			&& (inactive->n_slots < CERVER_INACTIVE_MAX_SLOTS)
+		) inactive->n_slots <<= 1;
+
+		inactive->slots = (Client **) calloc (inactive->n_slots, sizeof (Client *));
+
+		inactive->current = time (NULL);
+		inactive->n_clients = 0;
+
+		inactive->lock = thread_mutex_new ();
+
+		if (!inactive->slots) {
+			cerver_inactive_delete (inactive);
+			inactive = NULL;
+		}
+	}
+
+	return inactive;
+
+}
+
+static void cerver_inactive_place (
+	CerverInactive *inactive, Client *client, time_t deadline
+) {
+
+	// a deadline that has already passed is checked in the next second
+	if (deadline <= inactive->current) deadline = inactive->current + 1;
+
+	client->inactive_slot = (unsigned int) deadline & (inactive->n_slots - 1);
+
+	client->inactive_prev = NULL;
+	client->inactive_next = inactive->slots[client->inactive_slot];
+	if (client->inactive_next) client->inactive_next->inactive_prev = client;
+	inactive->slots[client->inactive_slot] = client;
+
+	client->inactive_placed = true;
+	inactive->n_clients += 1;
+
+}
+
+static void cerver_inactive_unlink (
+	CerverInactive *inactive, Client *client
+) {
+
+	if (client->inactive_prev) client->inactive_prev->inactive_next = client->inactive_next;
+	else inactive->slots[client->inactive_slot] = client->inactive_next;
+
+	if (client->inactive_next) client->inactive_next->inactive_prev = client->inactive_prev;
+
+	client->inactive_prev = NULL;
+	client->inactive_next = NULL;
+
+	client->inactive_placed = false;
+	inactive->n_clients -= 1;
+
+}
+
+// places the client in the cerver's inactive clients wheel
+// using its last activity, if the cerver checks for inactive clients
+void cerver_inactive_register (Cerver *cerver, Client *client) {
+
+	if (cerver->inactive) {
+		(void) pthread_mutex_lock (cerver->inactive->lock);
+
+		if (!client->last_activity) client->last_activity = time (NULL);
+
+		if (!client->inactive_placed) {
+			cerver_inactive_place (
+				cerver->inactive, client,
+				client->last_activity + (time_t) cerver->max_inactive_time
 			);
 		}
+
+		(void) pthread_mutex_unlock (cerver->inactive->lock);
 	}
 
-	cerver_inactive_check (node->left, cerver, current_time);
+}
+
+// removes the client from the cerver's inactive clients wheel
+void cerver_inactive_unregister (Cerver *cerver, Client *client) {
+
+	if (cerver->inactive) {
+		(void) pthread_mutex_lock (cerver->inactive->lock);
+
+		if (client->inactive_placed) {
+			cerver_inactive_unlink (cerver->inactive, client);
+		}
+
+		(void) pthread_mutex_unlock (cerver->inactive->lock);
+	}
 
 }
 
-// 17/06/2020 - thread to check for inactive clients
-static void *cerver_inactive_thread (void *args) {
+// checks the slots of every second until now
+// clients that have been active since they were placed are moved
+// to the slot of their new deadline, the rest are returned to be dropped
+static Client *cerver_inactive_expire (
+	CerverInactive *inactive, const time_t now, const time_t max_inactive_time
+) {
+
+	Client *expired = NULL;
 
-	if (args) {
-		Cerver *cerver = (Cerver *) args;
+	time_t second = inactive->current + 1;
+	if ((now - inactive->current) > (time_t) inactive->n_slots)
+		second = now - (time_t) inactive->n_slots + 1;
 
-		u32 count = 0;
-		while (cerver->isRunning) {
-			if (count == cerver->check_inactive_interval) {
-				count = 0;
+	Client *client = NULL;
+	Client *next = NULL;
+	time_t deadline = 0;
+	for (; second <= now; second++) {
+		client = inactive->slots[second & (inactive->n_slots - 1)];
+		while (client) {
+			next = client->inactive_next;
 
-				cerver_log_debug (
-					"Checking for inactive clients in cerver %s...",
-					cerver->info->name
-				);
+			cerver_inactive_unlink (inactive, client);
 
-				time_t current_time = time (NULL);
-				cerver_inactive_check (cerver->clients->root, cerver, current_time);
+			deadline = __atomic_load_n (&client->last_activity, __ATOMIC_RELAXED)
+				+ max_inactive_time;
 
-				cerver_log_debug (
-					"Done checking for inactive clients in cerver %s",
-					cerver->info->name
-				);
+			if (deadline <= now) {
+				client->inactive_next = expired;
+				expired = client;
 			}
 
-			sleep (1);
-			count++;
+			else {
+				cerver_inactive_place (inactive, client, deadline);
+			}
+
+			client = next;
 		}
 	}
 
-	return NULL;
+	inactive->current = now;
+
+	return expired;
+
+}
+
+// shuts down the sockets of the expired clients connections
+// so the threads that handle them drop the clients
+// as soon as they find their connections closed
+// must be called with the inactive lock, as the clients
+// can only be dropped after they have been unregistered
+// returns the number of clients that are going to be dropped
+static unsigned int cerver_inactive_shutdown (Cerver *cerver, Client *expired) {
+
+	unsigned int n_clients = 0;
+
+	Client *client = NULL;
+	Connection *connection = NULL;
+	while (expired) {
+		client = expired;
+		expired = client->inactive_next;
+		client->inactive_next = NULL;
+
+		cerver_log_warning (
+			"Client %ld has been inactive more than %d secs and will be dropped",
+			client->id, cerver->max_inactive_time
+		);
+
+		(void) pthread_mutex_lock (client->connections->mutex);
+
+		for (ListElement *le = dlist_start (client->connections); le; le = le->next) {
+			connection = (Connection *) le->data;
+			if (connection->socket) {
+				(void) shutdown (connection->socket->sock_fd, SHUT_RDWR);
+			}
+		}
+
+		(void) pthread_mutex_unlock (client->connections->mutex);
+
+		n_clients += 1;
+	}
+
+	return n_clients;
+
+}
+
+// 17/06/2020 - executed by the cerver's timers to drop inactive clients
+// poll & epoll cervers execute their timers in the same thread
+// that handles the connections, so the clients are dropped right away,
+// in any other cerver the threads that handle the connections drop them
+static void cerver_inactive_timer (void *cerver_ptr) {
+
+	Cerver *cerver = (Cerver *) cerver_ptr;
+
+	if (cerver->isRunning) {
+		unsigned int n_dropped = 0;
+
+		(void) pthread_mutex_lock (cerver->inactive->lock);
+
+		Client *expired = cerver_inactive_expire (
+			cerver->inactive, time (NULL), (time_t) cerver->max_inactive_time
+		);
+
+		// the clients can't be used once the lock has been released
+		if (!cerver->timers->attached) {
+			n_dropped = cerver_inactive_shutdown (cerver, expired);
+			expired = NULL;
+		}
+
+		(void) pthread_mutex_unlock (cerver->inactive->lock);
+
+		Client *client = NULL;
+		while (expired) {
+			client = expired;
+			expired = client->inactive_next;
+			client->inactive_next = NULL;
+
+			cerver_log_warning (
+				"Client %ld has been inactive more than %d secs and will be dropped",
+				client->id, cerver->max_inactive_time
+			);
+
+			client_drop (cerver, client);
+
+			n_dropped += 1;
+		}
+
+		for (unsigned int i = 0; i < n_dropped; i++) {
+			STATS_ADD (cerver->stats->inactive_clients_dropped, 1);
+
+			cerver_event_trigger (
+				CERVER_EVENT_CLIENT_DROPPED,
+				cerver,
+				NULL, NULL
+			);
+		}
+	}
 
 }
 
@@ -2115,13 +2759,19 @@ static u8 cerver_start_inactive (Cerver *cerver) {
 			cerver->check_inactive_interval
 		);
 
-		if (!thread_create_detachable (
-			&cerver->inactive_thread_id,
-			(void *(*) (void *)) cerver_inactive_thread,
-			cerver
-		)) {
+		TimerWheel *timers = cerver_timers_get (cerver);
+		cerver->inactive = cerver_inactive_create (cerver->max_inactive_time);
+		if (timers && cerver->inactive) {
+			const u64 interval = (u64) cerver->check_inactive_interval * 1000000000;
+
+			cerver->inactive_timer = timer_wheel_add (
+				timers, interval, interval, cerver_inactive_timer, cerver
+			);
+		}
+
+		if (cerver->inactive_timer) {
 			cerver_log_success (
-				"Created cerver %s INACTIVE thread!",
+				"Created cerver %s INACTIVE timer!",
 				cerver->info->name
 			);
 
@@ -2130,7 +2780,7 @@ static u8 cerver_start_inactive (Cerver *cerver) {
 
 		else {
 			cerver_log_error (
-				"Failed to create cerver %s INACTIVE thread!",
+				"Failed to create cerver %s INACTIVE timer!",
 				cerver->info->name
 			);
 		}
@@ -2160,9 +2810,21 @@ static u8 cerver_start_tcp (Cerver *cerver) {
 					time (&cerver->info->time_started);
 
 					// set up the initial listening socket
-					cerver->fds[cerver->current_n_fds].fd = cerver->sock;
-					cerver->fds[cerver->current_n_fds].events = POLLIN;
-					cerver->current_n_fds++;
+					// it will always be in the first idx
+					(void) poll_fds_register (
+						cerver->fds, cerver->max_n_fds, &cerver->current_n_fds,
+						cerver->fds_map,
+						cerver->sock, POLLIN
+					);
+
+					// followed by the cerver's timers
+					if (cerver->timers) {
+						(void) poll_fds_register (
+							cerver->fds, cerver->max_n_fds, &cerver->current_n_fds,
+							cerver->fds_map,
+							cerver->timers->timer_fd, POLLIN
+						);
+					}
 
 					cerver_event_trigger (
 						CERVER_EVENT_STARTED,
@@ -2228,6 +2890,111 @@ static u8 cerver_start_tcp (Cerver *cerver) {
 			}
 		} break;
 
+		case CERVER_HANDLER_TYPE_EPOLL: {
+			if (!cerver->blocking) {
+				if (!listen (cerver->sock, cerver->connection_queue)) {
+					// register the cerver start time
+					time (&cerver->info->time_started);
+
+					cerver_event_trigger (
+						CERVER_EVENT_STARTED,
+						cerver,
+						NULL, NULL
+					);
+
+					retval = cerver_epoll (cerver);
+				}
+
+				else {
+					cerver_log (
+						LOG_TYPE_ERROR, LOG_TYPE_CERVER,
+						"Failed to listen in cerver %s socket!",
+						cerver->info->name
+					);
+
+					close (cerver->sock);
+				}
+			}
+
+			else {
+				cerver_log (
+					LOG_TYPE_ERROR, LOG_TYPE_CERVER,
+					"Can't start cerver %s in CERVER_HANDLER_TYPE_EPOLL - socket is NOT set to non blocking!",
+					cerver->info->name
+				);
+			}
+		} break;
+
+		case CERVER_HANDLER_TYPE_REACTORS: {
+			if (!cerver->blocking) {
+				if (!listen (cerver->sock, cerver->connection_queue)) {
+					// register the cerver start time
+					time (&cerver->info->time_started);
+
+					cerver_event_trigger (
+						CERVER_EVENT_STARTED,
+						cerver,
+						NULL, NULL
+					);
+
+					retval = cerver_reactors (cerver);
+				}
+
+				else {
+					cerver_log (
+						LOG_TYPE_ERROR, LOG_TYPE_CERVER,
+						"Failed to listen in cerver %s socket!",
+						cerver->info->name
+					);
+
+					close (cerver->sock);
+				}
+			}
+
+			else {
+				cerver_log (
+					LOG_TYPE_ERROR, LOG_TYPE_CERVER,
+					"Can't start cerver %s in CERVER_HANDLER_TYPE_REACTORS - socket is NOT set to non blocking!",
+					cerver->info->name
+				);
+			}
+		} break;
+
+		case CERVER_HANDLER_TYPE_IO_URING: {
+			if (!cerver->blocking) {
+				if (!listen (cerver->sock, cerver->connection_queue)) {
+					// register the cerver start time
+					time (&cerver->info->time_started);
+
+					cerver_event_trigger (
+						CERVER_EVENT_STARTED,
+						cerver,
+						NULL, NULL
+					);
+
+					retval = cerver_uring (cerver);
+				}
+
+				else {
+					cerver_log (
+						LOG_TYPE_ERROR, LOG_TYPE_CERVER,
+						"Failed to listen in cerver %s socket!",
+						cerver->info->name
+					);
+
+					close (cerver->sock);
+				}
+			}
+
+			else {
+				cerver_log (
+					LOG_TYPE_ERROR, LOG_TYPE_CERVER,
+					"Can't start cerver %s in CERVER_HANDLER_TYPE_IO_URING - socket is NOT set to non blocking!",
+					cerver->info->name
+				);
+			}
+		} break;
+
 		default: {
 			cerver_log (
 				LOG_TYPE_ERROR, LOG_TYPE_CERVER,
@@ -2243,12 +3010,16 @@ static u8 cerver_start_tcp (Cerver *cerver) {
 
 static u8 cerver_start_udp (Cerver *cerver) {
 
-	cerver_log_warning (
-		"Cerver %s - udp server is not yet implemented!",
-		cerver->info->name
+	// register the cerver start time
+	time (&cerver->info->time_started);
+
+	cerver_event_trigger (
+		CERVER_EVENT_STARTED,
+		cerver,
+		NULL, NULL
 	);
 
-	return 1;
+	return cerver_udp (cerver);
 
 }
 
@@ -2303,8 +3074,8 @@ u8 cerver_start (Cerver *cerver) {
 			}
 
 			// 17/06/2020
-			// check for inactive will be handled in its own thread
-			// to avoid messing with other dedicated update threads timings
+			// check for inactive is handled by the cerver's timers
+			// with its own deadlines, so it doesn't mess with the updates timings
 			if (cerver->inactive_clients) {
 				errors |= cerver_start_inactive (cerver);
 			}
@@ -2373,125 +3144,106 @@ void cerver_update_delete (void *cerver_update_ptr) {
 
 }
 
-// called in a dedicated thread only if a user method was set
-// executes methods every tick
-static void *cerver_update (void *args) {
-
-	if (args) {
-		Cerver *cerver = (Cerver *) args;
-
-		#ifdef CERVER_DEBUG
-		cerver_log_success (
-			"Cerver's %s cerver_update () has started!",
-			cerver->info->name
-		);
-		#endif
+// the poll & epoll loops wait for the timerfd with the connections
+static inline bool cerver_timers_use_loop (const Cerver *cerver) {
 
-		CerverUpdate *cu = cerver_update_new (cerver, cerver->update_args);
+	return (cerver->protocol == PROTOCOL_TCP) && (
+		(cerver->handler_type == CERVER_HANDLER_TYPE_POLL)
+		|| (cerver->handler_type == CERVER_HANDLER_TYPE_EPOLL)
+	);
 
-		u32 time_per_frame = 1000000 / cerver->update_ticks;
-		// printf ("time per frame: %d\n", time_per_frame);
-		u32 temp = 0;
-		i32 sleep_time = 0;
-		u64 delta_time = 0;
+}
 
-		u64 delta_ticks = 0;
-		u32 fps = 0;
-		struct timespec start = { 0 }, middle = { 0 }, end = { 0 };
+// returns the wheel that executes the cerver's timers
+// it gets created the first time it is requested
+// & either attached to the cerver's loop or started in its own thread
+// returns NULL on error
+TimerWheel *cerver_timers_get (Cerver *cerver) {
 
-		while (cerver->isRunning) {
-			(void) clock_gettime (CLOCK_MONOTONIC_RAW, &start);
+	if (!cerver->timers) {
+		cerver->timers = timer_wheel_create ();
+		if (cerver->timers) {
+			timer_wheel_set_name (cerver->timers, cerver->info->name);
 
-			// do stuff
-			if (cerver->update) cerver->update (cu);
+			ThreadAffinity affinity;
+			cerver_get_affinity (cerver, 1, &affinity);
+			timer_wheel_set_affinity (cerver->timers, &affinity);
 
-			// limit the fps
-			(void) clock_gettime (CLOCK_MONOTONIC_RAW, &middle);
-			temp = (middle.tv_nsec - start.tv_nsec) / 1000;
-			// printf ("temp: %d\n", temp);
-			sleep_time = time_per_frame - temp;
-			// printf ("sleep time: %d\n", sleep_time);
-			if (sleep_time > 0) {
-				(void) usleep (sleep_time);
+			if (
+				cerver_timers_use_loop (cerver) ?
+					(timer_wheel_attach (cerver->timers) < 0) :
+					timer_wheel_start (cerver->timers)
+			) {
+				timer_wheel_delete (cerver->timers);
+				cerver->timers = NULL;
 			}
+		}
 
-			// count fps
-			(void) clock_gettime (CLOCK_MONOTONIC_RAW, &end);
-			delta_time = (end.tv_nsec - start.tv_nsec) / 1000000;
-			delta_ticks += delta_time;
-			fps++;
-			// printf ("delta ticks: %ld\n", delta_ticks);
-			if (delta_ticks >= 1000) {
-				// printf ("cerver %s update fps: %i\n", cerver->info->name, fps);
-				delta_ticks = 0;
-				fps = 0;
-			}
+		if (!cerver->timers) {
+			cerver_log_error (
+				"Failed to start cerver %s timers!",
+				cerver->info->name
+			);
 		}
+	}
 
-		cerver_update_delete (cu);
+	return cerver->timers;
 
-		if (cerver->update_args) {
-			if (cerver->delete_update_args) {
-				cerver->delete_update_args (cerver->update_args);
-			}
-		}
+}
 
-		#ifdef CERVER_DEBUG
-		cerver_log_success (
-			"Cerver's %s cerver_update () has ended!",
-			cerver->info->name
-		);
-		#endif
-	}
+// executed by the cerver's timers only if a user method was set
+// executes methods every tick
+static void cerver_update (void *cerver_update_ptr) {
+
+	CerverUpdate *cu = (CerverUpdate *) cerver_update_ptr;
 
-	return NULL;
+	if (cu->cerver->isRunning) cu->cerver->update (cu);
 
 }
 
-// called in a dedicated thread only if a user method was set
+// executed by the cerver's timers only if a user method was set
 // executes methods every x seconds
-static void *cerver_update_interval (void *args) {
+static void cerver_update_interval (void *cerver_update_ptr) {
 
-	if (args) {
-		Cerver *cerver = (Cerver *) args;
+	CerverUpdate *cu = (CerverUpdate *) cerver_update_ptr;
 
-		#ifdef CERVER_DEBUG
-		cerver_log_success (
-			"Cerver's %s cerver_update_interval () has started!",
-			cerver->info->name
-		);
-		#endif
+	if (cu->cerver->isRunning) cu->cerver->update_interval (cu);
 
-		CerverUpdate *cu = cerver_update_new (
-			cerver, cerver->update_interval_args
-		);
+}
+
+// stops the cerver's timers & deletes the updates args
+// the timers are deleted with the cerver
+static void cerver_timers_end (Cerver *cerver) {
+
+	if (cerver->timers) {
+		timer_wheel_stop (cerver->timers);
 
-		while (cerver->isRunning) {
-			if (cerver->update_interval) cerver->update_interval (cu);
+		if (cerver->update_timer) {
+			cerver_update_delete (cerver->update_timer->args);
 
-			(void) sleep (cerver->update_interval_secs);
+			if (cerver->update_args && cerver->delete_update_args)
+				cerver->delete_update_args (cerver->update_args);
+
+			cerver->update_timer->args = NULL;
 		}
 
-		cerver_update_delete (cu);
+		if (cerver->update_interval_timer) {
+			cerver_update_delete (cerver->update_interval_timer->args);
 
-		if (cerver->update_interval_args) {
-			if (cerver->delete_update_interval_args) {
-				cerver->delete_update_interval_args (
-					cerver->update_interval_args
-				);
-			}
+			if (cerver->update_interval_args && cerver->delete_update_interval_args)
+				cerver->delete_update_interval_args (cerver->update_interval_args);
+
+			cerver->update_interval_timer->args = NULL;
 		}
 
 		#ifdef CERVER_DEBUG
 		cerver_log_success (
-			"Cerver's %s cerver_update_interval () has ended!",
+			"Cerver %s timers have been stopped!",
 			cerver->info->name
 		);
 		#endif
 	}
 
-	return NULL;
-
 }
 
 #pragma endregion
@@ -2544,6 +3296,9 @@ static void cerver_destroy_on_hold_connections (Cerver *cerver) {
 				free (cerver->hold_fds);
 				cerver->hold_fds = NULL;
 			}
+
+			poll_fds_map_delete (cerver->hold_fds_map);
+			cerver->hold_fds_map = NULL;
 		}
 	}
 
@@ -2557,23 +3312,41 @@ static void cerver_destroy_clients (Cerver *cerver) {
 			// send a cerver teardown packet to all clients connected to cerver
 			Packet *packet = packet_generate_request (PACKET_TYPE_CERVER, CERVER_PACKET_TYPE_TEARDOWN, NULL, 0);
 			if (packet) {
-				client_broadcast_to_all_avl (cerver->clients->root, cerver, packet);
+				client_broadcast_to_all (cerver, packet);
 				packet_delete (packet);
 			}
 		}
 
-		// destroy the sock fd client map
-		htab_destroy (cerver->client_sock_fd_map);
-		cerver->client_sock_fd_map = NULL;
+		// the reactors must not handle any connection
+		// while the clients are being destroyed
+		cerver_reactors_end (cerver);
+
+		cerver_uring_end (cerver);
+
+		// udp peers are not registered as cerver clients
+		cerver_udp_end (cerver);
 
 		// this will end and delete client connections and then delete the client
-		avl_delete (cerver->clients);
+		client_registry_delete (cerver->clients);
 		cerver->clients = NULL;
 
 		if (cerver->fds) {
 			free (cerver->fds);
 			cerver->fds = NULL;
 		}
+
+		poll_fds_map_delete (cerver->fds_map);
+		cerver->fds_map = NULL;
+
+		if (cerver->pending_fds) {
+			free (cerver->pending_fds);
+			cerver->pending_fds = NULL;
+		}
+
+		cerver->n_pending_fds = 0;
+		cerver->max_pending_fds = 0;
+
+		cerver_epoll_end (cerver);
 	}
 
 }
@@ -2582,6 +3355,9 @@ static void cerver_destroy_clients (Cerver *cerver) {
 static void cerver_clean (Cerver *cerver) {
 
 	if (cerver) {
+		// no update should run while the cerver's data is cleaned
+		cerver_timers_end (cerver);
+
 		switch (cerver->type) {
 			case CERVER_TYPE_CUSTOM: break;
 
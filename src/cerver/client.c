@@ -2,6 +2,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdbool.h>
+#include <stdint.h>
 
 #include <time.h>
 #include <errno.h>
@@ -18,11 +19,13 @@
 #include "cerver/connection.h"
 #include "cerver/events.h"
 #include "cerver/errors.h"
+#include "cerver/fdtable.h"
 #include "cerver/files.h"
 #include "cerver/handler.h"
 #include "cerver/network.h"
 #include "cerver/packets.h"
 #include "cerver/receive.h"
+#include "cerver/registry.h"
 #include "cerver/sessions.h"
 
 #include "cerver/threads/thread.h"
@@ -231,6 +234,17 @@ Client *client_new (void) {
 
 		client->connections = NULL;
 
+		client->last_activity = 0;
+
+		client->inactive_placed = false;
+		client->inactive_slot = 0;
+		client->inactive_prev = NULL;
+		client->inactive_next = NULL;
+
+		client->retired_next = NULL;
+
+		client->removed = false;
+
 		client->drop_client = false;
 
 		client->data = NULL;
@@ -338,15 +352,17 @@ Client *client_create (void) {
 
 	Client *client = client_new ();
 	if (client) {
-		client->id = next_client_id;
-		next_client_id += 1;
+		// clients are created by multiple threads & their ids are registry keys
+		client->id = __atomic_fetch_add (&next_client_id, 1, __ATOMIC_RELAXED);
 
 		(void) strncpy (client->name, CLIENT_DEFAULT_NAME, CLIENT_NAME_SIZE - 1);
 
 		(void) time (&client->connected_timestamp);
 
-		client->connections = dlist_init (
-			connection_delete, connection_comparator
+		// connections are linked using their own list element
+		client->connections = dlist_init_intrusive (
+			connection_delete, connection_comparator,
+			dlist_link_offset (Connection, link)
 		);
 
 		client->lock = (pthread_mutex_t *) malloc (sizeof (pthread_mutex_t));
@@ -568,13 +584,48 @@ void client_got_disconnected (Client *client) {
 
 }
 
+// marks the client as removed if he has up to max connections
+// after that, no new connection can be registered to him
+// returns the number of connections that the client has
+static size_t client_mark_removed (
+	Client *client, const size_t max_connections
+) {
+
+	(void) pthread_mutex_lock (client->connections->mutex);
+
+	const size_t n_connections = client->connections->size;
+	if (n_connections <= max_connections) client->removed = true;
+
+	(void) pthread_mutex_unlock (client->connections->mutex);
+
+	return n_connections;
+
+}
+
+// the readers of the cerver's clients registry
+// might still be using a client that has been removed from it
+static void client_delete_removed (
+	Cerver *cerver, Client *client, Client *removed
+) {
+
+	if (removed) client_registry_retire_client (cerver->clients, client);
+	else client_delete (client);
+
+}
+
 // drops a client form the cerver
-// unregisters the client from the cerver and the deletes him
+// unregisters the client from the cerver, closes its connections
+// moving their sockets to the cerver's sockets pool & then deletes him
 void client_drop (Cerver *cerver, Client *client) {
 
 	if (cerver && client) {
-		client_unregister_from_cerver (cerver, client);
-		client_delete (client);
+		Client *removed = client_unregister_from_cerver (cerver, client);
+
+		Connection *connection = NULL;
+		while ((connection = (Connection *) dlist_remove_start (client->connections)))
+			connection_drop (cerver, connection);
+
+		client_delete_removed (cerver, client, removed);
 	}
 
 }
@@ -642,7 +693,9 @@ ClientConnectionsStatus client_remove_connection_by_sock_fd (
 
 	if (cerver && client) {
 		Connection *connection = NULL;
-		switch (client->connections->size) {
+
+		// the client is removed if this is his last connection
+		switch (client_mark_removed (client, 1)) {
 			case 0: {
 				#ifdef CLIENT_DEBUG
 				cerver_log (
@@ -653,8 +706,9 @@ ClientConnectionsStatus client_remove_connection_by_sock_fd (
 				);
 				#endif
 
-				(void) client_remove_from_cerver (cerver, client);
-				client_delete (client);
+				client_delete_removed (
+					cerver, client, client_remove_from_cerver (cerver, client)
+				);
 
 				status = CLIENT_CONNECTIONS_STATUS_DROPPED;
 			} break;
@@ -687,8 +741,9 @@ ClientConnectionsStatus client_remove_connection_by_sock_fd (
 					);
 
 					// no connections left in client, just remove and delete
-					client_remove_from_cerver (cerver, client);
-					client_delete (client);
+					client_delete_removed (
+						cerver, client, client_remove_from_cerver (cerver, client)
+					);
 
 					cerver_event_trigger (
 						CERVER_EVENT_CLIENT_DROPPED,
@@ -915,9 +970,12 @@ Client *client_remove_from_cerver (
 	Client *retval = NULL;
 
 	if (cerver && client) {
-		void *client_data = avl_remove_node (cerver->clients, client);
-		if (client_data) {
-			retval = (Client *) client_data;
+		(void) client_mark_removed (client, SIZE_MAX);
+
+		cerver_inactive_unregister (cerver, client);
+
+		retval = client_registry_remove (cerver->clients, client);
+		if (retval) {
 
 			#ifdef CLIENT_DEBUG
 			cerver_log (
@@ -926,7 +984,7 @@ Client *client_remove_from_cerver (
 			);
 			#endif
 
-			cerver->stats->current_n_connected_clients--;
+			STATS_SUB (cerver->stats->current_n_connected_clients, 1);
 			#ifdef CERVER_STATS
 			cerver_log (
 				LOG_TYPE_DEBUG, LOG_TYPE_CERVER,
@@ -940,7 +998,7 @@ Client *client_remove_from_cerver (
 			#ifdef CLIENT_DEBUG
 			cerver_log (
 				LOG_TYPE_ERROR, LOG_TYPE_CERVER,
-				"Received NULL ptr when attempting to remove a client from cerver's %s client tree.",
+				"Failed to remove a client from cerver's %s clients registry.",
 				cerver->info->name
 			);
 			#endif
@@ -955,7 +1013,15 @@ static void client_register_to_cerver_internal (
 	Cerver *cerver, Client *client
 ) {
 
-	(void) avl_insert_node (cerver->clients, client);
+	if (client_registry_insert (cerver->clients, client)) {
+		cerver_log (
+			LOG_TYPE_ERROR, LOG_TYPE_CLIENT,
+			"Failed to add client %ld to cerver %s clients registry!",
+			client->id, cerver->info->name
+		);
+	}
+
+	cerver_inactive_register (cerver, client);
 
 	#ifdef CLIENT_DEBUG
 	cerver_log (
@@ -965,8 +1031,8 @@ static void client_register_to_cerver_internal (
 	);
 	#endif
 
-	cerver->stats->total_n_clients++;
-	cerver->stats->current_n_connected_clients++;
+	STATS_ADD (cerver->stats->total_n_clients, 1);
+	STATS_ADD (cerver->stats->current_n_connected_clients, 1);
 
 	#ifdef CERVER_STATS
 	cerver_log (
@@ -993,7 +1059,10 @@ u8 client_register_to_cerver (
 			switch (cerver->handler_type) {
 				case CERVER_HANDLER_TYPE_NONE: break;
 
-				case CERVER_HANDLER_TYPE_POLL: {
+				case CERVER_HANDLER_TYPE_POLL:
+				case CERVER_HANDLER_TYPE_EPOLL:
+				case CERVER_HANDLER_TYPE_REACTORS:
+				case CERVER_HANDLER_TYPE_IO_URING: {
 					if (!client_register_connections_to_cerver_poll (cerver, client)) {
 						client_register_to_cerver_internal (cerver, client);
 
@@ -1024,6 +1093,9 @@ Client *client_unregister_from_cerver (
 	Client *retval = NULL;
 
 	if (cerver && client) {
+		// new connections are not unregistered
+		(void) client_mark_removed (client, SIZE_MAX);
+
 		if (client->connections->size > 0) {
 			// unregister the connections from the cerver
 			client_unregister_connections_from_cerver (cerver, client);
@@ -1045,47 +1117,64 @@ Client *client_unregister_from_cerver (
 
 }
 
-// gets the client associated with a sock fd using the client-sock fd map
+// gets the client associated with a sock fd using the cerver's fd table
 Client *client_get_by_sock_fd (Cerver *cerver, i32 sock_fd) {
 
 	Client *client = NULL;
 
 	if (cerver) {
-		const i32 *key = &sock_fd;
-		void *client_data = htab_get (
-			cerver->client_sock_fd_map,
-			key, sizeof (i32)
-		);
-
-		if (client_data) client = (Client *) client_data;
+		FdTableEntry entry = { 0 };
+		if (!fd_table_get (cerver->fd_table, sock_fd, &entry))
+			client = entry.client;
 	}
 
 	return client;
 
 }
 
-// searches the avl tree to get the client associated with the session id
+// gets the client with the matching id from the cerver's clients registry
+Client *client_get_by_id (Cerver *cerver, const u64 id) {
+
+	return cerver ? client_registry_get_by_id (cerver->clients, id) : NULL;
+
+}
+
+// gets the client associated with the session id from the cerver's clients registry
 // the cerver must support sessions
 Client *client_get_by_session_id (
 	Cerver *cerver, const char *session_id
 ) {
 
-	Client *client = NULL;
+	return cerver ?
+		client_registry_get_by_session_id (cerver->clients, session_id) : NULL;
 
-	if (session_id) {
-		// create our search query
-		Client *client_query = client_new ();
-		if (client_query) {
-			client_set_session_id (client_query, session_id);
+}
 
-			void *data = avl_get_node_data_safe (cerver->clients, client_query, NULL);
-			if (data) client = (Client *) data;     // found
+static void client_broadcast_to_client (Client *client, void *packet_ptr) {
 
-			client_delete (client_query);
-		}
+	Packet *packet = (Packet *) packet_ptr;
+
+	// send the packet to all of its active connections
+	Connection *connection = NULL;
+	for (ListElement *le = dlist_start (client->connections); le; le = le->next) {
+		connection = (Connection *) le->data;
+		packet_set_network_values (packet, packet->cerver, client, connection, NULL);
+		packet_send (packet, 0, NULL, false);
 	}
 
-	return client;
+}
+
+// broadcast a packet to all the clients in the cerver's clients registry
+// the clients are visited without locking the registry
+void client_broadcast_to_all (Cerver *cerver, Packet *packet) {
+
+	if (cerver && packet) {
+		packet->cerver = cerver;
+
+		client_registry_for_each (
+			cerver->clients, client_broadcast_to_client, packet
+		);
+	}
 
 }
 
@@ -1968,12 +2057,12 @@ static inline void client_connection_get_next_packet_handler (
 ) {
 
 	// update stats
-	client->stats->n_receives_done += 1;
-	client->stats->total_bytes_received += received;
+	STATS_ADD (client->stats->n_receives_done, 1);
+	STATS_ADD (client->stats->total_bytes_received, received);
 
 	#ifdef CONNECTION_STATS
-	connection->stats->n_receives_done += 1;
-	connection->stats->total_bytes_received += received;
+	STATS_ADD (connection->stats->n_receives_done, 1);
+	STATS_ADD (connection->stats->total_bytes_received, received);
 	#endif
 
 	// handle the actual packet
@@ -3105,9 +3194,9 @@ static void client_app_packet_handler (Packet *packet) {
 		else {
 			// add the packet to the handler's job queueu to be handled
 			// as soon as the handler is available
-			if (job_queue_push (
-				packet->client->app_packet_handler->job_queue,
-				job_create (NULL, packet)
+			void *job = job_create (NULL, packet);
+			if (!job || handler_push_jobs (
+				packet->client->app_packet_handler, &job, 1
 			)) {
 				cerver_log_error (
 					"Failed to push a new job to client's %s app_packet_handler!",
@@ -3139,9 +3228,9 @@ static void client_app_error_packet_handler (Packet *packet) {
 		else {
 			// add the packet to the handler's job queueu to be handled
 			// as soon as the handler is available
-			if (job_queue_push (
-				packet->client->app_error_packet_handler->job_queue,
-				job_create (NULL, packet)
+			void *job = job_create (NULL, packet);
+			if (!job || handler_push_jobs (
+				packet->client->app_error_packet_handler, &job, 1
 			)) {
 				cerver_log_error (
 					"Failed to push a new job to client's %s app_error_packet_handler!",
@@ -3173,9 +3262,9 @@ static void client_custom_packet_handler (Packet *packet) {
 		else {
 			// add the packet to the handler's job queueu to be handled
 			// as soon as the handler is available
-			if (job_queue_push (
-				packet->client->custom_packet_handler->job_queue,
-				job_create (NULL, packet)
+			void *job = job_create (NULL, packet);
+			if (!job || handler_push_jobs (
+				packet->client->custom_packet_handler, &job, 1
 			)) {
 				cerver_log_error (
 					"Failed to push a new job to client's %s custom_packet_handler!",
@@ -3206,8 +3295,8 @@ static ClientHandlerError client_packet_handler_actual (
 
 		// handles cerver type packets
 		case PACKET_TYPE_CERVER:
-			packet->client->stats->received_packets->n_cerver_packets += 1;
-			packet->connection->stats->received_packets->n_cerver_packets += 1;
+			packets_per_type_count (packet->client->stats->received_packets, PACKET_TYPE_CERVER, packet->header.request_type);
+			packets_per_type_count (packet->connection->stats->received_packets, PACKET_TYPE_CERVER, packet->header.request_type);
 			error = client_cerver_packet_handler (packet);
 			packet_delete (packet);
 			break;
@@ -3219,67 +3308,67 @@ static ClientHandlerError client_packet_handler_actual (
 
 		// handles an error from the server
 		case PACKET_TYPE_ERROR:
-			packet->client->stats->received_packets->n_error_packets += 1;
-			packet->connection->stats->received_packets->n_error_packets += 1;
+			packets_per_type_count (packet->client->stats->received_packets, PACKET_TYPE_ERROR, packet->header.request_type);
+			packets_per_type_count (packet->connection->stats->received_packets, PACKET_TYPE_ERROR, packet->header.request_type);
 			client_error_packet_handler (packet);
 			packet_delete (packet);
 			break;
 
 		// handles a request made from the server
 		case PACKET_TYPE_REQUEST:
-			packet->client->stats->received_packets->n_request_packets += 1;
-			packet->connection->stats->received_packets->n_request_packets += 1;
+			packets_per_type_count (packet->client->stats->received_packets, PACKET_TYPE_REQUEST, packet->header.request_type);
+			packets_per_type_count (packet->connection->stats->received_packets, PACKET_TYPE_REQUEST, packet->header.request_type);
 			client_request_packet_handler (packet);
 			packet_delete (packet);
 			break;
 
 		// handles authentication packets
 		case PACKET_TYPE_AUTH:
-			packet->client->stats->received_packets->n_auth_packets += 1;
-			packet->connection->stats->received_packets->n_auth_packets += 1;
+			packets_per_type_count (packet->client->stats->received_packets, PACKET_TYPE_AUTH, packet->header.request_type);
+			packets_per_type_count (packet->connection->stats->received_packets, PACKET_TYPE_AUTH, packet->header.request_type);
 			client_auth_packet_handler (packet);
 			packet_delete (packet);
 			break;
 
 		// handles a game packet sent from the server
 		case PACKET_TYPE_GAME:
-			packet->client->stats->received_packets->n_game_packets += 1;
-			packet->connection->stats->received_packets->n_game_packets += 1;
+			packets_per_type_count (packet->client->stats->received_packets, PACKET_TYPE_GAME, packet->header.request_type);
+			packets_per_type_count (packet->connection->stats->received_packets, PACKET_TYPE_GAME, packet->header.request_type);
 			packet_delete (packet);
 			break;
 
 		// user set handler to handler app specific packets
 		case PACKET_TYPE_APP:
-			packet->client->stats->received_packets->n_app_packets += 1;
-			packet->connection->stats->received_packets->n_app_packets += 1;
+			packets_per_type_count (packet->client->stats->received_packets, PACKET_TYPE_APP, packet->header.request_type);
+			packets_per_type_count (packet->connection->stats->received_packets, PACKET_TYPE_APP, packet->header.request_type);
 			client_app_packet_handler (packet);
 			break;
 
 		// user set handler to handle app specific errors
 		case PACKET_TYPE_APP_ERROR:
-			packet->client->stats->received_packets->n_app_error_packets += 1;
-			packet->connection->stats->received_packets->n_app_error_packets += 1;
+			packets_per_type_count (packet->client->stats->received_packets, PACKET_TYPE_APP_ERROR, packet->header.request_type);
+			packets_per_type_count (packet->connection->stats->received_packets, PACKET_TYPE_APP_ERROR, packet->header.request_type);
 			client_app_error_packet_handler (packet);
 			break;
 
 		// custom packet hanlder
 		case PACKET_TYPE_CUSTOM:
-			packet->client->stats->received_packets->n_custom_packets += 1;
-			packet->connection->stats->received_packets->n_custom_packets += 1;
+			packets_per_type_count (packet->client->stats->received_packets, PACKET_TYPE_CUSTOM, packet->header.request_type);
+			packets_per_type_count (packet->connection->stats->received_packets, PACKET_TYPE_CUSTOM, packet->header.request_type);
 			client_custom_packet_handler (packet);
 			break;
 
 		// handles a test packet form the cerver
 		case PACKET_TYPE_TEST:
-			packet->client->stats->received_packets->n_test_packets += 1;
-			packet->connection->stats->received_packets->n_test_packets += 1;
+			packets_per_type_count (packet->client->stats->received_packets, PACKET_TYPE_TEST, packet->header.request_type);
+			packets_per_type_count (packet->connection->stats->received_packets, PACKET_TYPE_TEST, packet->header.request_type);
 			cerver_log (LOG_TYPE_TEST, LOG_TYPE_NONE, "Got a test packet from cerver");
 			packet_delete (packet);
 			break;
 
 		default:
-			packet->client->stats->received_packets->n_bad_packets += 1;
-			packet->connection->stats->received_packets->n_bad_packets += 1;
+			packets_per_type_count_bad (packet->client->stats->received_packets);
+			packets_per_type_count_bad (packet->connection->stats->received_packets);
 			#ifdef CLIENT_DEBUG
 			cerver_log (
 				LOG_TYPE_WARNING, LOG_TYPE_NONE,
@@ -3331,7 +3420,7 @@ static u8 client_packet_handler (Packet *packet) {
 	u8 retval = 1;
 
 	// update general stats
-	packet->client->stats->n_packets_received += 1;
+	STATS_ADD (packet->client->stats->n_packets_received, 1);
 
 	ClientHandlerError error = CLIENT_HANDLER_ERROR_NONE;
 	if (packet->client->check_packets) {
@@ -3783,7 +3872,13 @@ static void client_receive_handle_failed (
 	Client *client, Connection *connection
 ) {
 
-	if (connection->active) {
+	// the cerver might close the connection right after receiving
+	// our close connection packet, in which case the connection
+	// is already being ended by the thread that sent it
+	if (
+		connection->active
+		&& (connection_get_state (connection) != CONNECTION_STATE_DISCONNECTING)
+	) {
 		if (!client_connection_end (client, connection)) {
 			// check if the client has any other active connection
 			if (client->connections->size <= 0) {
@@ -3946,12 +4041,12 @@ unsigned int client_receive_internal (
 		&received
 	);
 
-	client->stats->n_receives_done += 1;
-	client->stats->total_bytes_received += received;
+	STATS_ADD (client->stats->n_receives_done, 1);
+	STATS_ADD (client->stats->total_bytes_received, received);
 
 	#ifdef CONNECTION_STATS
-	connection->stats->n_receives_done += 1;
-	connection->stats->total_bytes_received += received;
+	STATS_ADD (connection->stats->n_receives_done, 1);
+	STATS_ADD (connection->stats->total_bytes_received, received);
 	#endif
 
 	switch (error) {
@@ -4027,6 +4122,8 @@ static void client_connection_terminate (
 
 	if (connection) {
 		if (connection->active) {
+			connection_set_state (connection, CONNECTION_STATE_DISCONNECTING);
+
 			if (connection->cerver_report) {
 				// send a close connection packet
 				Packet *packet = packet_generate_request (
@@ -4104,13 +4201,6 @@ int client_connection_end (Client *client, Connection *connection) {
 			(void) pthread_mutex_unlock (connection->mutex);
 		}
 
-		if (connection->use_send_queue) {
-			if (connection->send_queue) {
-				bsem_post (connection->send_queue->has_jobs);
-				(void) sleep (1);
-			}
-		}
-
 		connection_delete (connection);
 
 		retval = 0;
@@ -4126,7 +4216,7 @@ static void client_app_handler_destroy (Client *client) {
 		if (client->app_packet_handler) {
 			if (!client->app_packet_handler->direct_handle) {
 				// stop app handler
-				bsem_post_all (client->app_packet_handler->job_queue->has_jobs);
+				job_queue_signal_all (client->app_packet_handler->job_queue);
 			}
 		}
 	}
@@ -4139,7 +4229,7 @@ static void client_app_error_handler_destroy (Client *client) {
 		if (client->app_error_packet_handler) {
 			if (!client->app_error_packet_handler->direct_handle) {
 				// stop app error handler
-				bsem_post_all (client->app_error_packet_handler->job_queue->has_jobs);
+				job_queue_signal_all (client->app_error_packet_handler->job_queue);
 			}
 		}
 	}
@@ -4152,7 +4242,7 @@ static void client_custom_handler_destroy (Client *client) {
 		if (client->custom_packet_handler) {
 			if (!client->custom_packet_handler->direct_handle) {
 				// stop custom handler
-				bsem_post_all (client->custom_packet_handler->job_queue->has_jobs);
+				job_queue_signal_all (client->custom_packet_handler->job_queue);
 			}
 		}
 	}
@@ -4176,13 +4266,13 @@ static void client_handlers_destroy (Client *client) {
 		// poll remaining handlers
 		while (client->num_handlers_alive) {
 			if (client->app_packet_handler)
-				bsem_post_all (client->app_packet_handler->job_queue->has_jobs);
+				job_queue_signal_all (client->app_packet_handler->job_queue);
 
 			if (client->app_error_packet_handler)
-				bsem_post_all (client->app_error_packet_handler->job_queue->has_jobs);
+				job_queue_signal_all (client->app_error_packet_handler->job_queue);
 
 			if (client->custom_packet_handler)
-				bsem_post_all (client->custom_packet_handler->job_queue->has_jobs);
+				job_queue_signal_all (client->custom_packet_handler->job_queue);
 
 			sleep (1);
 		}
@@ -5,13 +5,167 @@
 
 #include "cerver/collections/dlist.h"
 
-static inline void list_element_delete (ListElement *le);
+#pragma region elements
 
-#pragma region internal
+// elements are linked using their next pointer while they are free
+typedef struct ListElementChunk {
+
+	struct ListElementChunk *next;
+	ListElement elements[DLIST_ELEMENTS_CHUNK_SIZE];
+
+} ListElementChunk;
+
+// every thread gets its own cache the first time it uses a list
+// so the common path does not need to take the shared lock
+typedef struct ListElementCache {
+
+	ListElement *head;
+	unsigned int count;
+
+} ListElementCache;
+
+static pthread_once_t list_elements_once = PTHREAD_ONCE_INIT;
+static pthread_key_t list_elements_key;
+
+static pthread_mutex_t list_elements_lock = PTHREAD_MUTEX_INITIALIZER;
+static ListElementChunk *list_elements_chunks = NULL;
+static ListElement *list_elements_free = NULL;
+
+static inline ListElement *list_element_pop (ListElement **head) {
+
+	ListElement *le = *head;
+	if (le) *head = le->next;
+
+	return le;
+
+}
+
+static inline void list_element_push (ListElement **head, ListElement *le) {
+
+	le->next = *head;
+	*head = le;
+
+}
+
+// moves up to n_elements from the cache into the shared list
+// must be called with the shared lock
+static void list_elements_release (
+	ListElementCache *cache, unsigned int n_elements
+) {
+
+	ListElement *le = NULL;
+	while (n_elements && (le = list_element_pop (&cache->head))) {
+		list_element_push (&list_elements_free, le);
+
+		cache->count -= 1;
+		n_elements -= 1;
+	}
+
+}
+
+// takes up to n_elements from the shared list
+// allocates a new chunk if there are no free elements
+// must be called with the shared lock
+static void list_elements_refill (
+	ListElementCache *cache, unsigned int n_elements
+) {
+
+	if (!list_elements_free) {
+		ListElementChunk *chunk = (ListElementChunk *) malloc (
+			sizeof (ListElementChunk)
+		);
+
+		if (chunk) {
+			chunk->next = list_elements_chunks;
+			list_elements_chunks = chunk;
+
+			for (unsigned int i = 0; i < DLIST_ELEMENTS_CHUNK_SIZE; i++)
+				list_element_push (&list_elements_free, &chunk->elements[i]);
+		}
+	}
+
+	ListElement *le = NULL;
+	while (n_elements && (le = list_element_pop (&list_elements_free))) {
+		list_element_push (&cache->head, le);
+
+		cache->count += 1;
+		n_elements -= 1;
+	}
+
+}
+
+// returns the thread's elements to the shared list when it exits
+static void list_elements_cache_delete (void *cache_ptr) {
+
+	if (cache_ptr) {
+		ListElementCache *cache = (ListElementCache *) cache_ptr;
+
+		(void) pthread_mutex_lock (&list_elements_lock);
+
+		list_elements_release (cache, cache->count);
+
+		(void) pthread_mutex_unlock (&list_elements_lock);
+
+		free (cache);
+	}
+
+}
+
+static void list_elements_init (void) {
+
+	(void) pthread_key_create (&list_elements_key, list_elements_cache_delete);
+
+}
+
+static ListElementCache *list_elements_cache_get (void) {
+
+	(void) pthread_once (&list_elements_once, list_elements_init);
+
+	ListElementCache *cache = (ListElementCache *) pthread_getspecific (
+		list_elements_key
+	);
+
+	if (!cache) {
+		cache = (ListElementCache *) calloc (1, sizeof (ListElementCache));
+		if (cache && pthread_setspecific (list_elements_key, cache)) {
+			free (cache);
+			cache = NULL;
+		}
+	}
+
+	return cache;
+
+}
 
 static ListElement *list_element_new (void) {
 
-	ListElement *le = (ListElement *) malloc (sizeof (ListElement));
+	ListElement *le = NULL;
+
+	ListElementCache *cache = list_elements_cache_get ();
+	if (cache) {
+		if (!cache->head) {
+			(void) pthread_mutex_lock (&list_elements_lock);
+
+			list_elements_refill (cache, DLIST_ELEMENTS_CACHE_SIZE / 2);
+
+			(void) pthread_mutex_unlock (&list_elements_lock);
+		}
+
+		if ((le = list_element_pop (&cache->head))) cache->count -= 1;
+	}
+
+	else {
+		ListElementCache single = { NULL, 0 };
+
+		(void) pthread_mutex_lock (&list_elements_lock);
+
+		list_elements_refill (&single, 1);
+
+		(void) pthread_mutex_unlock (&list_elements_lock);
+
+		le = single.head;
+	}
+
 	if (le) {
 		le->next = le->prev = NULL;
 		le->data = NULL;
@@ -21,7 +175,78 @@ static ListElement *list_element_new (void) {
 
 }
 
-static inline void list_element_delete (ListElement *le) { if (le) free (le); }
+static void list_element_delete (ListElement *le) {
+
+	if (le) {
+		ListElementCache *cache = list_elements_cache_get ();
+		if (cache) {
+			// move half of the cache to the shared list
+			if (cache->count >= DLIST_ELEMENTS_CACHE_SIZE) {
+				(void) pthread_mutex_lock (&list_elements_lock);
+
+				list_elements_release (cache, DLIST_ELEMENTS_CACHE_SIZE / 2);
+
+				(void) pthread_mutex_unlock (&list_elements_lock);
+			}
+
+			list_element_push (&cache->head, le);
+			cache->count += 1;
+		}
+
+		else {
+			(void) pthread_mutex_lock (&list_elements_lock);
+
+			list_element_push (&list_elements_free, le);
+
+			(void) pthread_mutex_unlock (&list_elements_lock);
+		}
+	}
+
+}
+
+#pragma endregion
+
+#pragma region internal
+
+// gets the element that will hold the data
+// returns NULL if the data's link is already in a list
+static inline ListElement *dlist_element_get (
+	const DoubleList *dlist, const void *data
+) {
+
+	ListElement *le = NULL;
+
+	if (dlist->intrusive) {
+		le = (ListElement *) ((char *) data + dlist->link_offset);
+		if (le->data) le = NULL;
+	}
+
+	else {
+		le = list_element_new ();
+	}
+
+	return le;
+
+}
+
+static inline void dlist_element_put (
+	const DoubleList *dlist, ListElement *le
+) {
+
+	if (dlist->intrusive) dlist_link_init (le);
+	else list_element_delete (le);
+
+}
+
+// returns true if elements can be moved between the lists
+static inline bool dlist_elements_match (
+	const DoubleList *one, const DoubleList *two
+) {
+
+	return (one->intrusive == two->intrusive)
+		&& (!one->intrusive || (one->link_offset == two->link_offset));
+
+}
 
 static DoubleList *dlist_new (void) {
 
@@ -34,6 +259,9 @@ static DoubleList *dlist_new (void) {
 		dlist->compare = NULL;
 
 		dlist->mutex = NULL;
+
+		dlist->intrusive = false;
+		dlist->link_offset = 0;
 	}
 
 	return dlist;
@@ -46,7 +274,7 @@ static int dlist_internal_insert_before (
 
 	int retval = 1;
 
-	ListElement *le = list_element_new ();
+	ListElement *le = dlist_element_get (dlist, data);
 	if (le) {
 		le->data = (void *) data;
 
@@ -104,7 +332,7 @@ static int dlist_internal_insert_after (
 
 	int retval = 1;
 
-	ListElement *le = list_element_new ();
+	ListElement *le = dlist_element_get (dlist, data);
 	if (le) {
 		le->data = (void *) data;
 
@@ -171,7 +399,8 @@ static void *dlist_internal_remove_element (
 
 	void *data = NULL;
 	if (dlist->size > 0) {
-		list_element_delete (
+		dlist_element_put (
+			dlist,
 			dlist_internal_remove_element_actual (
 				dlist, element, &data
 			)
@@ -252,6 +481,7 @@ static void dlist_internal_merge_two (
 	if (one->size) {
 		if (two->size) {
 			one->end->next = two->start;
+			two->start->prev = one->end;
 			one->end = two->end;
 		}
 		
@@ -270,6 +500,47 @@ static void dlist_internal_merge_two (
 
 }
 
+// unlinks the range from first to last from the list
+static void dlist_internal_unlink_range (
+	DoubleList *dlist,
+	ListElement *first, ListElement *last, const size_t count
+) {
+
+	if (first->prev) first->prev->next = last->next;
+	else dlist->start = last->next;
+
+	if (last->next) last->next->prev = first->prev;
+	else dlist->end = first->prev;
+
+	dlist->size -= count;
+
+	first->prev = NULL;
+	last->next = NULL;
+
+}
+
+// links the range from first to last after the element
+// if element == NULL, the range is linked at the start of the list
+static void dlist_internal_link_range (
+	DoubleList *dlist, ListElement *element,
+	ListElement *first, ListElement *last, const size_t count
+) {
+
+	ListElement *next = element ? element->next : dlist->start;
+
+	first->prev = element;
+	last->next = next;
+
+	if (element) element->next = first;
+	else dlist->start = first;
+
+	if (next) next->prev = last;
+	else dlist->end = last;
+
+	dlist->size += count;
+
+}
+
 static void dlist_internal_remove_elements (DoubleList *dlist) {
 
 	void *data = NULL;
@@ -447,6 +718,47 @@ DoubleList *dlist_init (
 
 }
 
+// creates a new intrusive double list
+// every element is the ListElement found in the data at link_offset
+// so inserts & removals never allocate or free any memory
+DoubleList *dlist_init_intrusive (
+	void (*destroy)(void *data),
+	int (*compare)(const void *one, const void *two),
+	const size_t link_offset
+) {
+
+	DoubleList *dlist = dlist_init (destroy, compare);
+
+	if (dlist) {
+		dlist->intrusive = true;
+		dlist->link_offset = link_offset;
+	}
+
+	return dlist;
+
+}
+
+// creates a new empty dlist that uses the same kind of elements
+// so elements can be moved from one list to the other
+static DoubleList *dlist_init_like (const DoubleList *dlist) {
+
+	return dlist->intrusive ?
+		dlist_init_intrusive (dlist->destroy, dlist->compare, dlist->link_offset) :
+		dlist_init (dlist->destroy, dlist->compare);
+
+}
+
+// inits a ListElement that is embedded in other structure
+void dlist_link_init (ListElement *link) {
+
+	if (link) {
+		link->prev = NULL;
+		link->data = NULL;
+		link->next = NULL;
+	}
+
+}
+
 // destroys all of the dlist's elements and their data but keeps the dlist
 void dlist_reset (DoubleList *dlist) {
 
@@ -1220,6 +1532,7 @@ void **dlist_to_array (const DoubleList *dlist, size_t *count) {
 // creates the dlist's elements using the same data pointers as in the original dlist
 // be carefull which dlist you delete first, as the other should use dlist_clear first before delete
 // the new dlist's delete and comparator methods are set from the original
+// the copy always allocates its own elements, even if the original is intrusive
 DoubleList *dlist_copy (const DoubleList *dlist) {
 
 	DoubleList *copy = NULL;
@@ -1278,7 +1591,7 @@ DoubleList *dlist_split_half (DoubleList *dlist) {
 
 	if (dlist) {
 		if (dlist->size > 1) {
-			half = dlist_init (dlist->destroy, dlist->compare);
+			half = dlist_init_like (dlist);
 
 			(void) pthread_mutex_lock (dlist->mutex);
 
@@ -1288,6 +1601,7 @@ DoubleList *dlist_split_half (DoubleList *dlist) {
 			size_t count = 0;
 			for (ListElement *le = dlist_start (dlist); le; le = le->next) {
 				if (count == half_count) {
+					half->end = dlist->end;
 					dlist->end = le->prev;
 					le->prev->next = NULL;
 					le->prev = NULL;
@@ -1325,7 +1639,7 @@ DoubleList *dlist_split_by_condition (
 	DoubleList *matches = NULL;
 
 	if (dlist && compare) {
-		matches = dlist_init (dlist->destroy, dlist->compare);
+		matches = dlist_init_like (dlist);
 		if (matches) {
 			(void) pthread_mutex_lock (dlist->mutex);
 
@@ -1349,7 +1663,7 @@ DoubleList *dlist_split_by_condition (
 // one should be of size = one->size + two->size
 void dlist_merge_two (DoubleList *one, DoubleList *two) {
 
-	if (one && two) {
+	if (one && two && dlist_elements_match (one, two)) {
 		if (one->size || two->size) {
 			dlist_internal_merge_two (one, two);
 		}
@@ -1369,8 +1683,8 @@ DoubleList *dlist_merge_two_by_condition (
 
 	DoubleList *merge = NULL;
 
-	if (one && two) {
-		merge = dlist_init (one->destroy, one->compare);
+	if (one && two && dlist_elements_match (one, two)) {
+		merge = dlist_init_like (one);
 		if (merge) {
 			dlist_internal_move_matches (
 				one, merge,
@@ -1388,6 +1702,70 @@ DoubleList *dlist_merge_two_by_condition (
 
 }
 
+// moves all the elements from source into dest AFTER the specified element
+// if element == NULL, they will be inserted at the start of dest
+// this method is NOT thread safe & takes O(1)
+// returns 0 on success, 1 on error
+int dlist_splice_unsafe (
+	DoubleList *dest, ListElement *element,
+	DoubleList *source
+) {
+
+	int retval = 1;
+
+	if (dest && source && (dest != source) && dlist_elements_match (dest, source)) {
+		if (source->size) {
+			ListElement *first = source->start;
+			ListElement *last = source->end;
+			const size_t count = source->size;
+
+			source->start = source->end = NULL;
+			source->size = 0;
+
+			dlist_internal_link_range (
+				dest, element, first, last, count
+			);
+		}
+
+		retval = 0;
+	}
+
+	return retval;
+
+}
+
+// moves the elements from first to last (both included) from source
+// into dest AFTER the specified element
+// if element == NULL, they will be inserted at the start of dest
+// count must be the number of elements in the range
+// this method is NOT thread safe & takes O(1)
+// returns 0 on success, 1 on error
+int dlist_splice_range_unsafe (
+	DoubleList *dest, ListElement *element,
+	DoubleList *source,
+	ListElement *first, ListElement *last, const size_t count
+) {
+
+	int retval = 1;
+
+	if (
+		dest && source && first && last
+		&& count && (count <= source->size)
+		&& dlist_elements_match (dest, source)
+	) {
+		dlist_internal_unlink_range (source, first, last, count);
+
+		dlist_internal_link_range (
+			dest, element, first, last, count
+		);
+
+		retval = 0;
+	}
+
+	return retval;
+
+}
+
 // expects a dlist of dlists and creates a new dlist with all the elements
 // elements from original dlists are moved directly to the new list
 // the original dlists can be deleted after this operation
@@ -1400,7 +1778,7 @@ DoubleList *dlist_merge_many (DoubleList *many_dlists) {
 		if (many_dlists->size) {
 			DoubleList *first = (DoubleList *) many_dlists->start->data;
 
-			merge = dlist_init (first->destroy, first->compare);
+			merge = dlist_init_like (first);
 			if (merge) {
 				ListElement *le = NULL;
 				dlist_for_each (many_dlists, le) {
@@ -1,24 +1,134 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include <stdbool.h>
 
 #include <pthread.h>
 
 #include "cerver/collections/htab.h"
 
+// multiplier used to map a hash to a slot (2^64 / golden ratio)
+#define HTAB_FIBONACCI						0x9E3779B97F4A7C15ULL
+
+#pragma region hash
+
+// wyhash constants
+#define HTAB_HASH_S0						0xa0761d6478bd642fULL
+#define HTAB_HASH_S1						0xe7037ed1a0b428dbULL
+#define HTAB_HASH_S2						0x8ebc6af09c88c6e3ULL
+#define HTAB_HASH_S3						0x589965cc75374cc3ULL
+
+__extension__ typedef unsigned __int128 htab_u128;
+
+static inline void htab_hash_mum (uint64_t *a, uint64_t *b) {
+
+	htab_u128 r = (htab_u128) *a * *b;
+
+	*a = (uint64_t) r;
+	*b = (uint64_t) (r >> 64);
+
+}
+
+static inline uint64_t htab_hash_mix (uint64_t a, uint64_t b) {
+
+	htab_hash_mum (&a, &b);
+
+	return a ^ b;
+
+}
+
+static inline uint64_t htab_hash_read8 (const unsigned char *p) {
+
+	uint64_t value = 0;
+	(void) memcpy (&value, p, sizeof (uint64_t));
+
+	return value;
+
+}
+
+static inline uint64_t htab_hash_read4 (const unsigned char *p) {
+
+	uint32_t value = 0;
+	(void) memcpy (&value, p, sizeof (uint32_t));
+
+	return value;
+
+}
+
+static inline uint64_t htab_hash_read3 (
+	const unsigned char *p, const size_t k
+) {
+
+	return (((uint64_t) p[0]) << 16) | (((uint64_t) p[k >> 1]) << 8) | p[k - 1];
+
+}
+
+// based on wyhash final version 4
+// a fast hash that mixes every byte of the key into the 64 bits
+size_t htab_hash (const void *key, size_t key_size) {
+
+	const unsigned char *p = (const unsigned char *) key;
+
+	uint64_t seed = htab_hash_mix (HTAB_HASH_S0, HTAB_HASH_S1);
+	uint64_t a = 0;
+	uint64_t b = 0;
+
+	if (key_size <= 16) {
+		if (key_size >= 4) {
+			a = (htab_hash_read4 (p) << 32) | htab_hash_read4 (p + ((key_size >> 3) << 2));
+			b = (htab_hash_read4 (p + key_size - 4) << 32)
+				| htab_hash_read4 (p + key_size - 4 - ((key_size >> 3) << 2));
+		}
+
+		else if (key_size > 0) {
+			a = htab_hash_read3 (p, key_size);
+		}
+	}
+
+	else {
+		size_t i = key_size;
+		if (i > 48) {
+			uint64_t see1 = seed;
+			uint64_t see2 = seed;
+			do {
+				seed = htab_hash_mix (htab_hash_read8 (p) ^ HTAB_HASH_S1, htab_hash_read8 (p + 8) ^ seed);
+				see1 = htab_hash_mix (htab_hash_read8 (p + 16) ^ HTAB_HASH_S2, htab_hash_read8 (p + 24) ^ see1);
+				see2 = htab_hash_mix (htab_hash_read8 (p + 32) ^ HTAB_HASH_S3, htab_hash_read8 (p + 40) ^ see2);
+				p += 48;
+				i -= 48;
+			} while (i > 48);
+
+			seed ^= see1 ^ see2;
+		}
+
+		while (i > 16) {
+			seed = htab_hash_mix (htab_hash_read8 (p) ^ HTAB_HASH_S1, htab_hash_read8 (p + 8) ^ seed);
+			i -= 16;
+			p += 16;
+		}
+
+		a = htab_hash_read8 (p + i - 16);
+		b = htab_hash_read8 (p + i - 8);
+	}
+
+	a ^= HTAB_HASH_S1;
+	b ^= seed;
+	htab_hash_mum (&a, &b);
+
+	return (size_t) htab_hash_mix (a ^ HTAB_HASH_S0 ^ key_size, b ^ HTAB_HASH_S1);
+
+}
+
+#pragma endregion
+
 #pragma region generic
 
 static size_t htab_generic_hash (
 	const void *key, size_t key_size, size_t table_size
 ) {
 
-	size_t i;
-	size_t sum = 0;
-	unsigned char *k = (unsigned char *) key;
-	for (i = 0; i < key_size; ++i)
-		sum = (sum + (int)k[i]) % table_size;
-	
-	return sum;
+	return htab_hash (key, key_size) % table_size;
+
 }
 
 static int htab_generic_compare (
@@ -36,64 +146,74 @@ static int htab_generic_compare (
 
 #pragma region internal
 
-static inline void *htab_internal_key_create (
-	void *(*key_create)(const void *), 
-	const void *key, size_t key_size
+static inline size_t htab_internal_hash (
+	const Htab *htab, const void *key, size_t key_size
 ) {
 
-	void *retval = NULL;
+	return htab->hash (key, key_size, SIZE_MAX);
 
-	if (key_create) retval = key_create (key);
-	else {
-		retval = malloc (key_size);
-		(void) memcpy (retval, key, key_size);
-	}
+}
 
-	return retval;
+// maps the hash to a slot using its high bits
+// so custom hash methods with weak low bits still spread
+static inline size_t htab_internal_slot (
+	const size_t hash, const size_t size
+) {
+
+	return (size_t) (
+		((uint64_t) hash * HTAB_FIBONACCI) >> (64 - __builtin_ctzll (size))
+	);
+
+}
+
+static inline const void *htab_node_key (const HtabNode *node) {
+
+	return node->inline_key ? (const void *) node->key.bytes : node->key.ptr;
 
 }
 
 static inline int htab_internal_key_compare (
-	Htab *htab,
+	const Htab *htab,
 	const void *k1, size_t s1, const void *k2, size_t s2
 ) {
 
-	return htab->key_compare ? 
+	return htab->key_compare ?
 		htab->key_compare (k1, k2) :
 		htab_generic_compare (k1, s1, k2, s2);
-	
-}
 
-static HtabNode *htab_node_new (void) {
+}
 
-	HtabNode *node = (HtabNode *) malloc (sizeof (HtabNode));
-	if (node) {
-		node->key = NULL;
-		node->val = NULL;
-		node->next = NULL;
-		node->key_size = 0;
-		node->val_size = 0;
-	}
+// copies the key into the node
+// small keys are kept inside the node itself
+// returns 0 on success, 1 on error
+static unsigned int htab_node_key_create (
+	const Htab *htab, HtabNode *node,
+	const void *key, size_t key_size
+) {
 
-	return node;
+	unsigned int retval = 1;
 
-}
+	node->key_size = key_size;
 
-static HtabNode *htab_node_create (
-	const void *key, size_t key_size, void *val, size_t val_size,
-	void *(*key_create)(void const *)
-) {
+	if (htab->key_create) {
+		node->inline_key = false;
+		node->key.ptr = htab->key_create (key);
+	}
 
-	HtabNode *node = htab_node_new ();
-	if (node) {
-		node->key_size = key_size;
-		node->key = htab_internal_key_create (key_create, key, key_size);
+	else if (key_size <= HTAB_INLINE_KEY_SIZE) {
+		node->inline_key = true;
+		(void) memcpy (node->key.bytes, key, key_size);
+	}
 
-		node->val = val;
-		node->val_size = val_size;
+	else {
+		node->inline_key = false;
+		node->key.ptr = malloc (key_size);
+		if (node->key.ptr) (void) memcpy (node->key.ptr, key, key_size);
 	}
 
-	return node;
+	if (node->inline_key || node->key.ptr) retval = 0;
+
+	return retval;
 
 }
 
@@ -103,58 +223,225 @@ static void htab_node_delete (
 	void (*delete_data)(void *data)
 ) {
 
-	if (node) {
-		if (node->val) {
-			if (delete_data) delete_data (node->val);
+	if (node->val) {
+		if (delete_data) delete_data (node->val);
+	}
+
+	if (!node->inline_key && node->key.ptr) {
+		if (key_delete) key_delete (node->key.ptr);
+		else free (node->key.ptr);
+	}
+
+	(void) memset (node, 0, sizeof (HtabNode));
+
+}
+
+// returns the idx of the slot with the key
+// or the table's size if it was not found
+// the first slots after start are known to be empty
+static size_t htab_table_find (
+	const Htab *htab,
+	const HtabNode *table, const size_t size,
+	const size_t start, const size_t first,
+	const size_t hash, const void *key, size_t key_size
+) {
+
+	size_t retval = size;
+
+	const size_t mask = size - 1;
+
+	size_t idx = htab_internal_slot (hash, size);
+	unsigned int dist = 1;
+
+	// the old table has already been moved up to first
+	const size_t moved = (idx - start) & mask;
+	if (moved < first) {
+		dist += (unsigned int) (first - moved);
+		idx = (start + first) & mask;
+	}
+
+	const HtabNode *node = NULL;
+	for (;;) {
+		node = &table[idx];
+
+		// an empty slot or an element that is closer to its own slot
+		if (node->dist < dist) break;
+
+		if (
+			(node->hash == hash)
+			&& !htab_internal_key_compare (
+				htab,
+				key, key_size, htab_node_key (node), node->key_size
+			)
+		) {
+			retval = idx;
+			break;
+		}
+
+		idx = (idx + 1) & mask;
+		dist += 1;
+	}
+
+	return retval;
+
+}
+
+// places the node in the table
+// taking the slots of the elements that are closer to their own slots
+// the table must have at least one empty slot
+static void htab_table_put (
+	HtabNode *table, const size_t size, HtabNode *node
+) {
+
+	const size_t mask = size - 1;
+
+	size_t idx = htab_internal_slot (node->hash, size);
+	node->dist = 1;
+
+	HtabNode temp;
+	for (;;) {
+		if (!table[idx].dist) {
+			table[idx] = *node;
+			break;
+		}
+
+		if (table[idx].dist < node->dist) {
+			temp = table[idx];
+			table[idx] = *node;
+			*node = temp;
 		}
 
-		if (node->key) {
-			if (key_delete) key_delete (node->key) ;
-			else free (node->key);
+		idx = (idx + 1) & mask;
+		node->dist += 1;
+	}
+
+}
+
+// empties the slot & shifts back the next elements
+// so there are no gaps in their probe sequences
+static void htab_table_erase (
+	HtabNode *table, const size_t size, size_t idx
+) {
+
+	const size_t mask = size - 1;
+
+	size_t next = (idx + 1) & mask;
+	while (table[next].dist > 1) {
+		table[idx] = table[next];
+		table[idx].dist -= 1;
+
+		idx = next;
+		next = (next + 1) & mask;
+	}
+
+	(void) memset (&table[idx], 0, sizeof (HtabNode));
+
+}
+
+// moves some of the old table's elements to the current one
+// starting after an empty slot, so no probe sequence
+// ever needs to cross the slots that have already been moved
+static void htab_migrate (Htab *htab, size_t steps) {
+
+	HtabNode moved;
+	while (htab->old_table && steps--) {
+		HtabNode *node = &htab->old_table[
+			(htab->old_start + htab->migrated) & (htab->old_size - 1)
+		];
+
+		if (node->dist) {
+			moved = *node;
+			(void) memset (node, 0, sizeof (HtabNode));
+
+			htab_table_put (htab->table, htab->size, &moved);
+
+			htab->old_count -= 1;
 		}
 
-		free (node);
+		htab->migrated += 1;
+
+		if (!htab->old_count || (htab->migrated == htab->old_size)) {
+			free (htab->old_table);
+			htab->old_table = NULL;
+			htab->old_size = 0;
+			htab->old_count = 0;
+			htab->old_start = 0;
+			htab->migrated = 0;
+		}
 	}
 
 }
 
-static HtabBucket *htab_bucket_new (void) {
+// starts moving the elements to a table with twice the slots
+// returns 0 on success, 1 on error
+static unsigned int htab_grow (Htab *htab) {
 
-	HtabBucket *bucket = (HtabBucket *) malloc (sizeof (HtabBucket));
-	if (bucket) {
-		bucket->start = NULL;
-		bucket->count = 0;
+	unsigned int retval = 1;
+
+	// there can only be one old table
+	htab_migrate (htab, htab->old_size);
+
+	HtabNode *table = (HtabNode *) calloc (htab->size * 2, sizeof (HtabNode));
+	if (table) {
+		htab->old_table = htab->table;
+		htab->old_size = htab->size;
+		htab->old_count = htab->count;
+		htab->migrated = 0;
+
+		// there is always at least one empty slot
+		htab->old_start = 0;
+		while (htab->old_table[htab->old_start].dist) htab->old_start += 1;
+		htab->old_start = (htab->old_start + 1) & (htab->old_size - 1);
+
+		htab->table = table;
+		htab->size *= 2;
+
+		retval = 0;
 	}
 
-	return bucket;
+	return retval;
 
 }
 
-static void htab_bucket_delete (
-	HtabBucket *bucket, 
-	void (*key_delete)(void *),
-	void (*delete_data)(void *data)
+// returns the slot with the key in any of the tables
+static HtabNode *htab_internal_find (
+	Htab *htab, const size_t hash, const void *key, size_t key_size,
+	bool *old
 ) {
 
-	if (bucket) {
-		while (bucket->count) {
-			HtabNode *node = bucket->start;
-			bucket->start = bucket->start->next;
+	HtabNode *node = NULL;
 
-			htab_node_delete (node, key_delete, delete_data);
+	size_t idx = htab_table_find (
+		htab, htab->table, htab->size, 0, 0, hash, key, key_size
+	);
 
-			bucket->count--;
-		}
+	if (idx < htab->size) {
+		node = &htab->table[idx];
+		*old = false;
+	}
 
-		free (bucket);
+	else if (htab->old_table) {
+		idx = htab_table_find (
+			htab, htab->old_table, htab->old_size,
+			htab->old_start, htab->migrated,
+			hash, key, key_size
+		);
+
+		if (idx < htab->old_size) {
+			node = &htab->old_table[idx];
+			*old = true;
+		}
 	}
 
+	return node;
+
 }
 
 static void htab_delete (Htab *htab) {
 
 	if (htab) {
 		if (htab->table) free (htab->table);
+		if (htab->old_table) free (htab->old_table);
 		free (htab);
 	}
 
@@ -165,10 +452,16 @@ static Htab *htab_new (void) {
 	Htab *htab = (Htab *) malloc (sizeof (Htab));
 	if (htab) {
 		htab->table = NULL;
-		
+
 		htab->size = 0;
 		htab->count = 0;
 
+		htab->old_table = NULL;
+		htab->old_size = 0;
+		htab->old_count = 0;
+		htab->old_start = 0;
+		htab->migrated = 0;
+
 		htab->hash = NULL;
 
 		htab->key_create = NULL;
@@ -176,6 +469,8 @@ static Htab *htab_new (void) {
 		htab->key_compare = NULL;
 
 		htab->delete_data = NULL;
+
+		htab->mutex = NULL;
 	}
 
 	return htab;
@@ -224,7 +519,7 @@ void htab_set_key_comparator (
 }
 
 // creates a new htab
-// size - how many buckets do you want - more buckets = less collisions
+// size - how many slots to start with, it grows when needed
 // hash - custom method to hash the key for insertion, NULL for default
 // delete_data - custom method to delete your data, NULL for no delete when htab gets destroyed
 Htab *htab_create (
@@ -236,13 +531,11 @@ Htab *htab_create (
 	Htab *htab = htab_new ();
 	if (htab) {
 		if (size > 0) {
-			htab->size = size;
-			
-			htab->table = (HtabBucket **) calloc (htab->size, sizeof (HtabBucket));
-			if (htab->table) {
-				for (size_t i = 0; i < htab->size; i++)
-					htab->table[i] = htab_bucket_new ();
+			htab->size = HTAB_MIN_SIZE;
+			while (htab->size < size) htab->size *= 2;
 
+			htab->table = (HtabNode *) calloc (htab->size, sizeof (HtabNode));
+			if (htab->table) {
 				htab->hash = hash ? hash : htab_generic_hash;
 				// htab->compare = compare ? compare : htab_generic_compare;
 
@@ -276,8 +569,8 @@ size_t htab_size (Htab *htab) {
 }
 
 // returns true if its empty (size == 0)
-bool htab_is_empty (Htab *htab) { 
-	
+bool htab_is_empty (Htab *htab) {
+
 	bool retval = true;
 
 	if (htab) {
@@ -289,7 +582,7 @@ bool htab_is_empty (Htab *htab) {
 	}
 
 	return retval;
-	
+
 }
 
 // returns true if its NOT empty (size > 0)
@@ -318,26 +611,12 @@ bool htab_contains_key (
 	bool retval = false;
 
 	if (ht && key && key_size) {
-		(void) pthread_mutex_lock (ht->mutex);
+		const size_t hash = htab_internal_hash (ht, key, key_size);
 
-		size_t index = ht->hash (key, key_size, ht->size);
-
-		HtabNode *node = ht->table[index]->start;
-		while (node && node->key && node->val) {
-			if (node->key_size == key_size) {
-				if (!htab_internal_key_compare (
-					ht, 
-					key, key_size, node->key, node->key_size
-				)) {
-					retval = true;
-					break;
-				}
+		(void) pthread_mutex_lock (ht->mutex);
 
-				else node = node->next;
-			}
-
-			else node = node->next;
-		}
+		bool old = false;
+		retval = (htab_internal_find (ht, hash, key, key_size, &old) != NULL);
 
 		(void) pthread_mutex_unlock (ht->mutex);
 	}
@@ -347,7 +626,7 @@ bool htab_contains_key (
 }
 
 // inserts a new value to the htab associated with its key
-// returns 0 on success, 1 on error
+// returns 0 on success, 1 on error or if the key already exists
 int htab_insert (
 	Htab *ht,
 	const void *key, size_t key_size,
@@ -357,55 +636,36 @@ int htab_insert (
 	int retval = 1;
 
 	if (ht && ht->hash && key && key_size && val && val_size) {
-		(void) pthread_mutex_lock (ht->mutex);
+		const size_t hash = htab_internal_hash (ht, key, key_size);
 
-		size_t index = ht->hash (key, key_size, ht->size);
-		// printf ("size: %ld\n", ht->size);
-		// printf ("index: %ld\n", index);
-
-		HtabBucket *bucket = ht->table[index];
-		HtabNode *node = bucket->start;
-		if (node) {
-			while (
-				node->next
-				&& htab_internal_key_compare (
-					ht, key, key_size, node->key, node->key_size
-				)
-			) node = node->next;
-
-			if (htab_internal_key_compare (
-				ht,
-				key, key_size, node->key, node->key_size
-			)) {
-				node->next = htab_node_create (
-					key, key_size, val, val_size,
-					ht->key_create
-				);
-				
-				if (node->next) {
-					node = node->next;
+		(void) pthread_mutex_lock (ht->mutex);
 
-					bucket->count += 1;
-					ht->count += 1;
+		htab_migrate (ht, HTAB_RESIZE_STEP);
 
-					retval = 0;
-				}
+		bool old = false;
+		if (!htab_internal_find (ht, hash, key, key_size, &old)) {
+			// the current table keeps its old elements count
+			// until they have been moved
+			if (
+				((ht->count + 1) * HTAB_MAX_LOAD_DEN) > (ht->size * HTAB_MAX_LOAD_NUM)
+			) {
+				(void) htab_grow (ht);
 			}
-		}
 
-		else {
-			node = htab_node_create (
-				key, key_size, val, val_size,
-				ht->key_create
-			);
+			// there must always be an empty slot
+			if ((ht->count + 1) < ht->size) {
+				HtabNode node = { 0 };
+				node.hash = hash;
+				node.val = val;
+				node.val_size = val_size;
 
-			if (node) {
-				bucket->start = node;
+				if (!htab_node_key_create (ht, &node, key, key_size)) {
+					htab_table_put (ht->table, ht->size, &node);
 
-				bucket->count += 1;
-				ht->count += 1;
+					ht->count += 1;
 
-				retval = 0;
+					retval = 0;
+				}
 			}
 		}
 
@@ -425,29 +685,13 @@ void *htab_get (
 	void *retval = NULL;
 
 	if (ht && key) {
-		(void) pthread_mutex_lock (ht->mutex);
+		const size_t hash = htab_internal_hash (ht, key, key_size);
 
-		size_t index = ht->hash (key, key_size, ht->size);
-		HtabNode *node = ht->table[index]->start;  
-		while (node && node->key && node->val) {
-			if (node->key_size == key_size) {
-				if (!htab_internal_key_compare (
-					ht,
-					key, key_size, node->key, node->key_size
-				)) {
-					retval = node->val;
-					break;
-				}
-
-				else {
-					node = node->next;
-				} 
-			}
+		(void) pthread_mutex_lock (ht->mutex);
 
-			else {
-				node = node->next;
-			}
-		}
+		bool old = false;
+		HtabNode *node = htab_internal_find (ht, hash, key, key_size, &old);
+		if (node) retval = node->val;
 
 		(void) pthread_mutex_unlock (ht->mutex);
 	}
@@ -466,35 +710,37 @@ void *htab_remove (
 	void *retval = NULL;
 
 	if (ht && key && ht->hash) {
+		const size_t hash = htab_internal_hash (ht, key, key_size);
+
 		(void) pthread_mutex_lock (ht->mutex);
 
-		size_t index = ht->hash (key, key_size, ht->size);
-		HtabBucket *bucket = ht->table[index];
-		HtabNode *node = bucket->start;
-		HtabNode *prev = NULL;
-		while (node) {
-			if (!htab_internal_key_compare (
-				ht, 
-				key, key_size, node->key, node->key_size
-			)) {
-				if (!prev) ht->table[index]->start = ht->table[index]->start->next;
-				else prev->next = node->next;
+		bool old = false;
+		HtabNode *node = htab_internal_find (ht, hash, key, key_size, &old);
+		if (node) {
+			retval = node->val;
 
-				retval = node->val;
+			node->val = NULL;
+			htab_node_delete (node, ht->key_delete, ht->delete_data);
 
-				node->val = NULL;
-				htab_node_delete (node, ht->key_delete, ht->delete_data);
+			if (old) {
+				htab_table_erase (
+					ht->old_table, ht->old_size, (size_t) (node - ht->old_table)
+				);
 
-				bucket->count--;
-				ht->count--;
+				ht->old_count -= 1;
+			}
 
-				break;
+			else {
+				htab_table_erase (
+					ht->table, ht->size, (size_t) (node - ht->table)
+				);
 			}
 
-			prev = node;
-			node = node->next;
+			ht->count -= 1;
 		}
 
+		htab_migrate (ht, HTAB_RESIZE_STEP);
+
 		(void) pthread_mutex_unlock (ht->mutex);
 	}
 
@@ -502,54 +748,57 @@ void *htab_remove (
 
 }
 
+static void htab_table_destroy (
+	HtabNode *table, const size_t size,
+	void (*key_delete)(void *),
+	void (*delete_data)(void *data)
+) {
+
+	for (size_t i = 0; i < size; i++) {
+		if (table[i].dist) {
+			htab_node_delete (&table[i], key_delete, delete_data);
+		}
+	}
+
+}
+
 void htab_destroy (Htab *ht) {
 
 	if (ht) {
 		(void) pthread_mutex_lock (ht->mutex);
 
 		if (ht->table) {
-			for (size_t i = 0; i < ht->size; i++) {
-				if (ht->table[i]) {
-					htab_bucket_delete (
-						ht->table[i], 
-						ht->key_delete, 
-						ht->delete_data
-					);
-				}
-			}
+			htab_table_destroy (
+				ht->table, ht->size,
+				ht->key_delete, ht->delete_data
+			);
+		}
+
+		if (ht->old_table) {
+			htab_table_destroy (
+				ht->old_table, ht->old_size,
+				ht->key_delete, ht->delete_data
+			);
 		}
 
 		(void) pthread_mutex_unlock (ht->mutex);
 		(void) pthread_mutex_destroy (ht->mutex);
 		free (ht->mutex);
-		
+
 		htab_delete (ht);
 	}
 
 }
 
-static void htab_node_print (HtabNode *node) {
+static void htab_node_print (const HtabNode *node, size_t idx) {
 
-	if (node) {
-		int *int_key = (int *) node->key;
-		int *int_value = (int *) node->val;
-		(void) printf ("\tKey %d - Value: %d\n", *int_key, *int_value);
-	}
-
-}
-
-static void htab_bucket_print (
-	HtabBucket *bucket, size_t idx
-) {
-
-	if (bucket) {
-		(void) printf ("Bucket <%lu> count: %lu\n", idx, bucket->count);
-		HtabNode *n = bucket->start;
-		while (n) {
-			htab_node_print (n);
-			
-			n = n->next;
-		}
+	if (node->dist) {
+		const int *int_key = (const int *) htab_node_key (node);
+		const int *int_value = (const int *) node->val;
+		(void) printf (
+			"Slot <%lu> dist: %u - Key %d - Value: %d\n",
+			idx, node->dist - 1, *int_key, *int_value
+		);
 	}
 
 }
@@ -562,10 +811,21 @@ void htab_print (Htab *htab) {
 		(void) printf ("Htab's count: %lu\n", htab->count);
 
 		for (size_t idx = 0; idx < htab->size; idx++) {
-			htab_bucket_print (htab->table[idx], idx);
+			htab_node_print (&htab->table[idx], idx);
+		}
+
+		if (htab->old_table) {
+			(void) printf ("Htab's old size: %lu\n", htab->old_size);
+			(void) printf ("Htab's old count: %lu\n", htab->old_count);
+
+			size_t idx = 0;
+			for (size_t i = htab->migrated; i < htab->old_size; i++) {
+				idx = (htab->old_start + i) & (htab->old_size - 1);
+				htab_node_print (&htab->old_table[idx], idx);
+			}
 		}
 
 		(void) printf ("\n\n");
 	}
 
-}
\ No newline at end of file
+}
@@ -1,15 +1,330 @@
 #include <stdlib.h>
+#include <stdbool.h>
+
+#include <pthread.h>
+
+#include "cerver/types/types.h"
 
 #include "cerver/collections/pool.h"
-#include "cerver/collections/dlist.h"
+
+static _Thread_local unsigned int pool_cache_idx = 0;
+static unsigned int pool_caches_next = 0;
+
+#pragma region magazines
+
+static inline PoolMagazine *pool_magazine_get (
+	const Pool *pool, const u32 id
+) {
+
+	const PoolChunks *table = __atomic_load_n (&pool->chunks, __ATOMIC_ACQUIRE);
+
+	PoolMagazine *chunk = __atomic_load_n (
+		&table->chunks[id / POOL_CHUNK_MAGAZINES], __ATOMIC_ACQUIRE
+	);
+
+	return &chunk[id % POOL_CHUNK_MAGAZINES];
+
+}
+
+// replaces the chunks table with one twice its size
+// must be called with the magazines lock
+// returns NULL if the new table failed to be allocated
+static PoolChunks *pool_chunks_grow (Pool *pool, PoolChunks *table) {
+
+	const u32 size = table ? (table->size * 2) : POOL_CHUNKS_TABLE_SIZE;
+
+	PoolChunks *grown = (PoolChunks *) malloc (
+		sizeof (PoolChunks) + (size * sizeof (PoolMagazine *))
+	);
+
+	if (grown) {
+		grown->size = size;
+		grown->retired_next = table;
+
+		for (u32 i = 0; i < size; i++)
+			grown->chunks[i] = (table && (i < table->size)) ? table->chunks[i] : NULL;
+
+		// the depot can only see the table after its chunks have been copied
+		__atomic_store_n (&pool->chunks, grown, __ATOMIC_RELEASE);
+	}
+
+	return grown;
+
+}
+
+// creates a new empty magazine
+// magazines are only released when the pool is deleted
+// returns NULL if the magazine failed to be allocated
+static PoolMagazine *pool_magazine_new (Pool *pool) {
+
+	PoolMagazine *magazine = NULL;
+
+	(void) pthread_mutex_lock (pool->magazines_lock);
+
+	const u32 id = pool->n_magazines;
+
+	PoolChunks *table = pool->chunks;
+	if (!table || ((id / POOL_CHUNK_MAGAZINES) >= table->size))
+		table = pool_chunks_grow (pool, table);
+
+	if (table) {
+		PoolMagazine *chunk = table->chunks[id / POOL_CHUNK_MAGAZINES];
+		if (!chunk) {
+			chunk = (PoolMagazine *) calloc (
+				POOL_CHUNK_MAGAZINES, sizeof (PoolMagazine)
+			);
+
+			// the depot can only see the chunk after it has been cleared
+			if (chunk) {
+				__atomic_store_n (
+					&table->chunks[id / POOL_CHUNK_MAGAZINES], chunk, __ATOMIC_RELEASE
+				);
+			}
+		}
+
+		if (chunk) {
+			magazine = &chunk[id % POOL_CHUNK_MAGAZINES];
+			magazine->id = id;
+
+			pool->n_magazines += 1;
+		}
+	}
+
+	(void) pthread_mutex_unlock (pool->magazines_lock);
+
+	return magazine;
+
+}
+
+// takes the remaining objects out of the magazine
+static void pool_magazine_drain (
+	const Pool *pool, PoolMagazine *magazine, const bool destroy
+) {
+
+	if (magazine) {
+		while (magazine->rounds) {
+			magazine->rounds -= 1;
+
+			if (destroy && pool->destroy)
+				pool->destroy (magazine->objects[magazine->rounds]);
+
+			magazine->objects[magazine->rounds] = NULL;
+		}
+	}
+
+}
+
+#pragma endregion
+
+#pragma region depot
+
+static void pool_depot_push (u64 *stack, PoolMagazine *magazine) {
+
+	u64 head = __atomic_load_n (stack, __ATOMIC_RELAXED);
+	u64 next = 0;
+
+	do {
+		__atomic_store_n (&magazine->next, (u32) head, __ATOMIC_RELAXED);
+
+		next = ((((head >> 32) + 1) << 32) | (u64) (magazine->id + 1));
+	} while (!__atomic_compare_exchange_n (
+		stack, &head, next, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED
+	));
+
+}
+
+// magazines are never released while the pool exists
+// so a magazine that was taken by another thread can still be read
+// and the tag makes the exchange fail if the head was updated meanwhile
+static PoolMagazine *pool_depot_pop (Pool *pool, u64 *stack) {
+
+	PoolMagazine *magazine = NULL;
+
+	u64 head = __atomic_load_n (stack, __ATOMIC_ACQUIRE);
+	u64 next = 0;
+
+	while ((u32) head) {
+		magazine = pool_magazine_get (pool, (u32) head - 1);
+
+		next = ((((head >> 32) + 1) << 32)
+			| (u64) __atomic_load_n (&magazine->next, __ATOMIC_RELAXED));
+
+		if (__atomic_compare_exchange_n (
+			stack, &head, next, true, __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE
+		)) {
+			break;
+		}
+
+		magazine = NULL;
+	}
+
+	return magazine;
+
+}
+
+// the rounds are counted before the magazine can be taken
+// so they never go below the ones inside the depot
+static inline void pool_depot_push_full (Pool *pool, PoolMagazine *magazine) {
+
+	(void) __atomic_add_fetch (
+		&pool->depot.rounds, POOL_MAGAZINE_SIZE, __ATOMIC_RELAXED
+	);
+
+	pool_depot_push (&pool->depot.full, magazine);
+
+}
+
+static inline PoolMagazine *pool_depot_pop_full (Pool *pool) {
+
+	PoolMagazine *magazine = pool_depot_pop (pool, &pool->depot.full);
+	if (magazine) {
+		(void) __atomic_sub_fetch (
+			&pool->depot.rounds, POOL_MAGAZINE_SIZE, __ATOMIC_RELAXED
+		);
+	}
+
+	return magazine;
+
+}
+
+// returns true if another full magazine would exceed the pool's max depot size
+static inline bool pool_depot_is_full (const Pool *pool) {
+
+	return pool->max_depot_size && (
+		(__atomic_load_n (&pool->depot.rounds, __ATOMIC_RELAXED) + POOL_MAGAZINE_SIZE)
+		> pool->max_depot_size
+	);
+
+}
+
+#pragma endregion
+
+#pragma region caches
+
+// every thread is assigned a cache the first time it uses a pool
+static inline PoolCache *pool_cache_get (Pool *pool) {
+
+	if (!pool_cache_idx) {
+		pool_cache_idx = __atomic_add_fetch (
+			&pool_caches_next, 1, __ATOMIC_RELAXED
+		);
+	}
+
+	return &pool->caches[(pool_cache_idx - 1) & (POOL_CACHES - 1)];
+
+}
+
+static inline void pool_cache_swap (PoolCache *cache) {
+
+	PoolMagazine *temp = cache->loaded;
+	cache->loaded = cache->previous;
+	cache->previous = temp;
+
+}
+
+// makes room in the cache's loaded magazine
+// must be called with the cache's lock
+// returns false if the full magazine does not fit in the depot
+// or if a new empty magazine failed to be allocated
+static bool pool_cache_reload_empty (Pool *pool, PoolCache *cache) {
+
+	bool retval = false;
+
+	if (cache->previous && !cache->previous->rounds) {
+		pool_cache_swap (cache);
+
+		retval = true;
+	}
+
+	else if (!cache->previous || !pool_depot_is_full (pool)) {
+		PoolMagazine *empty = pool_depot_pop (pool, &pool->depot.empty);
+		if (!empty) empty = pool_magazine_new (pool);
+
+		if (empty) {
+			if (cache->previous) pool_depot_push_full (pool, cache->previous);
+
+			cache->previous = cache->loaded;
+			cache->loaded = empty;
+
+			retval = true;
+		}
+	}
+
+	return retval;
+
+}
+
+// gets objects into the cache's loaded magazine
+// must be called with the cache's lock
+static void pool_cache_reload_full (Pool *pool, PoolCache *cache) {
+
+	if (cache->previous && (cache->previous->rounds == POOL_MAGAZINE_SIZE)) {
+		pool_cache_swap (cache);
+	}
+
+	else {
+		PoolMagazine *full = pool_depot_pop_full (pool);
+		if (full) {
+			if (cache->previous)
+				pool_depot_push (&pool->depot.empty, cache->previous);
+
+			cache->previous = cache->loaded;
+			cache->loaded = full;
+		}
+	}
+
+}
+
+// takes every object out of the caches & the depot
+static void pool_drain (Pool *pool, const bool destroy) {
+
+	PoolCache *cache = NULL;
+	for (unsigned int i = 0; i < POOL_CACHES; i++) {
+		cache = &pool->caches[i];
+
+		(void) pthread_mutex_lock (&cache->lock);
+
+		pool_magazine_drain (pool, cache->loaded, destroy);
+		pool_magazine_drain (pool, cache->previous, destroy);
+
+		(void) pthread_mutex_unlock (&cache->lock);
+	}
+
+	PoolMagazine *magazine = NULL;
+	while ((magazine = pool_depot_pop_full (pool))) {
+		pool_magazine_drain (pool, magazine, destroy);
+
+		pool_depot_push (&pool->depot.empty, magazine);
+	}
+
+}
+
+#pragma endregion
 
 #pragma region internal
 
 static Pool *pool_new (void) {
 
-	Pool *pool = (Pool *) malloc (sizeof (Pool));
+	Pool *pool = (Pool *) aligned_alloc (POOL_CACHE_LINE, sizeof (Pool));
 	if (pool) {
-		pool->dlist = NULL;
+		for (unsigned int i = 0; i < POOL_CACHES; i++) {
+			(void) pthread_mutex_init (&pool->caches[i].lock, NULL);
+
+			pool->caches[i].loaded = NULL;
+			pool->caches[i].previous = NULL;
+
+			pool->caches[i].stats = (PoolStats) { 0, 0, 0, 0 };
+		}
+
+		pool->depot.full = 0;
+		pool->depot.empty = 0;
+		pool->depot.rounds = 0;
+
+		pool->chunks = NULL;
+		pool->n_magazines = 0;
+		pool->magazines_lock = NULL;
+
+		pool->max_depot_size = 0;
 
 		pool->destroy = NULL;
 		pool->create = NULL;
@@ -45,10 +360,57 @@ void pool_set_produce_if_empty (Pool *pool, bool produce) {
 
 }
 
+// sets the max number of objects that the pool keeps in its depot
+// a max depot size of 0 (default) lets the pool grow without any limit
+void pool_set_max_depot_size (
+	Pool *pool, const size_t max_depot_size
+) {
+
+	if (pool) pool->max_depot_size = max_depot_size;
+
+}
+
 // returns how many elements are inside the pool
 size_t pool_size (Pool *pool) {
 
-	return pool ? dlist_size (pool->dlist) : 0;
+	size_t size = 0;
+
+	if (pool) {
+		PoolCache *cache = NULL;
+		for (unsigned int i = 0; i < POOL_CACHES; i++) {
+			cache = &pool->caches[i];
+
+			(void) pthread_mutex_lock (&cache->lock);
+
+			if (cache->loaded) size += cache->loaded->rounds;
+			if (cache->previous) size += cache->previous->rounds;
+
+			(void) pthread_mutex_unlock (&cache->lock);
+		}
+
+		size += __atomic_load_n (&pool->depot.rounds, __ATOMIC_RELAXED);
+	}
+
+	return size;
+
+}
+
+// copies the sum of all the pool's counters into stats
+void pool_get_stats (const Pool *pool, PoolStats *stats) {
+
+	if (pool && stats) {
+		*stats = (PoolStats) { 0, 0, 0, 0 };
+
+		const PoolStats *cache_stats = NULL;
+		for (unsigned int i = 0; i < POOL_CACHES; i++) {
+			cache_stats = &pool->caches[i].stats;
+
+			stats->hits += __atomic_load_n (&cache_stats->hits, __ATOMIC_RELAXED);
+			stats->misses += __atomic_load_n (&cache_stats->misses, __ATOMIC_RELAXED);
+			stats->produced += __atomic_load_n (&cache_stats->produced, __ATOMIC_RELAXED);
+			stats->dropped += __atomic_load_n (&cache_stats->dropped, __ATOMIC_RELAXED);
+		}
+	}
 
 }
 
@@ -56,8 +418,17 @@ Pool *pool_create (void (*destroy)(void *data)) {
 
 	Pool *pool = pool_new ();
 	if (pool) {
-		pool->dlist = dlist_init (destroy, NULL);
-		pool->destroy = destroy;
+		pool->magazines_lock = (pthread_mutex_t *) malloc (sizeof (pthread_mutex_t));
+		if (pool->magazines_lock) {
+			(void) pthread_mutex_init (pool->magazines_lock, NULL);
+
+			pool->destroy = destroy;
+		}
+
+		else {
+			pool_delete (pool);
+			pool = NULL;
+		}
 	}
 
 	return pool;
@@ -79,11 +450,7 @@ int pool_init (
 			int errors = 0;
 
 			for (unsigned int i = 0; i < n_elements; i++) {
-				errors |= dlist_insert_after (
-					pool->dlist,
-					dlist_end (pool->dlist),
-					produce ()
-				);
+				errors |= pool_push (pool, produce ());
 			}
 
 			retval = errors;
@@ -99,11 +466,36 @@ int pool_push (Pool *pool, void *data) {
 	int retval = 1;
 
 	if (pool && data) {
-		retval = dlist_insert_after (
-			pool->dlist,
-			dlist_end (pool->dlist),
-			data
-		);
+		PoolCache *cache = pool_cache_get (pool);
+
+		bool drop = false;
+
+		(void) pthread_mutex_lock (&cache->lock);
+
+		if (!cache->loaded || (cache->loaded->rounds == POOL_MAGAZINE_SIZE)) {
+			drop = !pool_cache_reload_empty (pool, cache);
+		}
+
+		if (
+			!drop && cache->loaded
+			&& (cache->loaded->rounds < POOL_MAGAZINE_SIZE)
+		) {
+			cache->loaded->objects[cache->loaded->rounds] = data;
+			cache->loaded->rounds += 1;
+
+			retval = 0;
+		}
+
+		(void) pthread_mutex_unlock (&cache->lock);
+
+		// the pool is full or out of magazines, so the data is not kept
+		if (drop && pool->destroy) {
+			pool->destroy (data);
+
+			(void) __atomic_add_fetch (&cache->stats.dropped, 1, __ATOMIC_RELAXED);
+
+			retval = 0;
+		}
 	}
 
 	return retval;
@@ -115,13 +507,33 @@ void *pool_pop (Pool *pool) {
 	void *retval = NULL;
 
 	if (pool) {
-		retval = dlist_remove_element (
-			pool->dlist,
-			NULL
-		);
+		PoolCache *cache = pool_cache_get (pool);
+
+		(void) pthread_mutex_lock (&cache->lock);
 
-		if (!retval && pool->produce) {
+		if (!cache->loaded || !cache->loaded->rounds) {
+			pool_cache_reload_full (pool, cache);
+		}
+
+		if (cache->loaded && cache->loaded->rounds) {
+			cache->loaded->rounds -= 1;
+			retval = cache->loaded->objects[cache->loaded->rounds];
+			cache->loaded->objects[cache->loaded->rounds] = NULL;
+
+			(void) __atomic_add_fetch (&cache->stats.hits, 1, __ATOMIC_RELAXED);
+		}
+
+		else {
+			(void) __atomic_add_fetch (&cache->stats.misses, 1, __ATOMIC_RELAXED);
+		}
+
+		(void) pthread_mutex_unlock (&cache->lock);
+
+		if (!retval && pool->produce && pool->create) {
 			retval = pool->create ();
+			if (retval) {
+				(void) __atomic_add_fetch (&cache->stats.produced, 1, __ATOMIC_RELAXED);
+			}
 		}
 	}
 
@@ -129,21 +541,21 @@ void *pool_pop (Pool *pool) {
 
 }
 
-// only gets rid of the list elements, but the data is kept
+// only gets rid of the pool's elements, but the data is kept
 // this is usefull if another structure points to the same data
 void pool_clear (Pool *pool) {
 
 	if (pool) {
-		dlist_clear (pool->dlist);
+		pool_drain (pool, false);
 	}
 
 }
 
-// destroys all of the dlist's elements and their data but keeps the pool
+// destroys all of the pool's elements and their data but keeps the pool
 void pool_reset (Pool *pool) {
 
 	if (pool) {
-		dlist_reset (pool->dlist);
+		pool_drain (pool, true);
 	}
 
 }
@@ -152,9 +564,32 @@ void pool_reset (Pool *pool) {
 void pool_delete (Pool *pool) {
 
 	if (pool) {
-		dlist_delete (pool->dlist);
+		if (pool->magazines_lock) {
+			pool_drain (pool, true);
+
+			(void) pthread_mutex_destroy (pool->magazines_lock);
+			free (pool->magazines_lock);
+		}
+
+		// the newest table has every chunk
+		if (pool->chunks) {
+			for (u32 i = 0; i < pool->chunks->size; i++) {
+				if (pool->chunks->chunks[i]) free (pool->chunks->chunks[i]);
+			}
+		}
+
+		PoolChunks *table = pool->chunks;
+		PoolChunks *retired_next = NULL;
+		while (table) {
+			retired_next = table->retired_next;
+			free (table);
+			table = retired_next;
+		}
+
+		for (unsigned int i = 0; i < POOL_CACHES; i++)
+			(void) pthread_mutex_destroy (&pool->caches[i].lock);
 
 		free (pool);
 	}
 
-}
\ No newline at end of file
+}
@@ -5,24 +5,29 @@
 
 #include <unistd.h>
 #include <time.h>
+#include <poll.h>
+
+#include <sys/socket.h>
+#include <sys/uio.h>
 
 #include "cerver/types/types.h"
 #include "cerver/types/string.h"
 
-#include "cerver/collections/htab.h"
 #include "cerver/collections/dlist.h"
 
 #include "cerver/admin.h"
 #include "cerver/auth.h"
 #include "cerver/cerver.h"
 #include "cerver/client.h"
+#include "cerver/events.h"
+#include "cerver/fdtable.h"
 #include "cerver/handler.h"
 #include "cerver/network.h"
 #include "cerver/packets.h"
 #include "cerver/receive.h"
+#include "cerver/send.h"
 #include "cerver/socket.h"
 
-#include "cerver/threads/jobs.h"
 #include "cerver/threads/thread.h"
 
 #include "cerver/utils/log.h"
@@ -138,6 +143,8 @@ Connection *connection_new (void) {
 	if (connection) {
 		connection->client = NULL;
 
+		dlist_link_init (&connection->link);
+
 		(void) memset (connection->name, 0, CONNECTION_NAME_SIZE);
 
 		connection->socket = NULL;
@@ -154,6 +161,9 @@ Connection *connection_new (void) {
 		connection->connection_thread_id = 0;
 		connection->connected_timestamp = 0;
 
+		connection->reactor = NULL;
+		connection->uring = NULL;
+
 		connection->cerver_report = NULL;
 
 		connection->max_sleep = CONNECTION_DEFAULT_MAX_SLEEP;
@@ -195,9 +205,19 @@ Connection *connection_new (void) {
 			.header_end = NULL,
 			.remaining_header = 0,
 
-			.spare_packet = NULL
+			.spare_packet = NULL,
+
+			.n_packets = 0,
+
+			.jobs_handler = NULL,
+			.n_jobs = 0
 		};
 
+		connection->queued_packets = 0;
+
+		connection->paused_handler = NULL;
+		dlist_link_init (&connection->pause_link);
+
 		connection->request_thread_id = 0;
 
 		connection->update_thread_id = 0;
@@ -246,13 +266,17 @@ void connection_delete (void *connection_ptr) {
 
 		connection->client = NULL;
 
+		// its handler must never resume it after it is gone
+		handler_connection_unpause (connection);
+
+		// the socket must be closed before it gets deleted
+		if (connection->active) connection_end (connection);
+
 		socket_delete (connection->socket);
 
 		if (connection->state_mutex)
 			thread_mutex_delete (connection->state_mutex);
 
-		if (connection->active) connection_end (connection);
-
 		cerver_report_delete (connection->cerver_report);
 
 		if (connection->received_data && connection->received_data_delete)
@@ -264,7 +288,7 @@ void connection_delete (void *connection_ptr) {
 			}
 		}
 
-		job_queue_delete (connection->send_queue);
+		send_queue_delete (connection->send_queue);
 
 		connection_remove_auth_data (connection);
 
@@ -504,16 +528,52 @@ void connection_set_custom_receive (
 }
 
 // enables the ability to send packets using the connection's queue
-// a dedicated thread will be created to send queued packets
+// every packet sent to the connection will be appended to the queue
+// without blocking & queued packets will be sent together
+// when the connection's socket is writable
+// client connections use a dedicated thread to flush the queue
+// cerver connections can only use it with CERVER_HANDLER_TYPE_EPOLL,
+// CERVER_HANDLER_TYPE_REACTORS & CERVER_HANDLER_TYPE_IO_URING
+// and the queue must be set before they are registered to the cerver
+// methods that send directly to the socket like packet_send_to_socket ()
+// or file transfers should NOT be used with the queue
 void connection_set_send_queue (
 	Connection *connection, int flags
 ) {
 
 	if (connection) {
-		connection->use_send_queue = true;
 		connection->send_flags = flags;
 
-		connection->send_queue = job_queue_create (JOB_QUEUE_TYPE_JOBS);
+		if (!connection->send_queue) {
+			connection->send_queue = send_queue_create (
+				SEND_QUEUE_DEFAULT_SIZE,
+				SEND_QUEUE_DEFAULT_HIGH_WATER, SEND_QUEUE_DEFAULT_OVERFLOW
+			);
+		}
+
+		connection->use_send_queue = (connection->send_queue != NULL);
+	}
+
+}
+
+// sets the max number of bytes that can be waiting in the connection's queue
+// and what to do when it is reached; SEND_QUEUE_OVERFLOW_EVENT keeps the data
+// and triggers the matching send high water event,
+// SEND_QUEUE_OVERFLOW_DROP discards the queue & drops the connection
+// use a high water of 0 to let the queue grow without any limit
+// the default values are SEND_QUEUE_DEFAULT_HIGH_WATER & SEND_QUEUE_DEFAULT_OVERFLOW
+void connection_set_send_queue_high_water (
+	Connection *connection,
+	const size_t high_water, const SendQueueOverflow overflow
+) {
+
+	if (connection && connection->send_queue) {
+		(void) pthread_mutex_lock (connection->send_queue->mutex);
+
+		connection->send_queue->high_water = high_water;
+		connection->send_queue->overflow = overflow;
+
+		(void) pthread_mutex_unlock (connection->send_queue->mutex);
 	}
 
 }
@@ -810,12 +870,16 @@ static unsigned int connection_start_update (Connection *connection) {
 
 }
 
+// the send thread is joined in connection_end ()
 static unsigned int connection_start_send (Connection *connection) {
 
 	unsigned int retval = 1;
 
-	if (!thread_create_detachable (
-		&connection->send_thread_id,
+	connection->send_queue->threaded = true;
+	connection->send_queue->running = true;
+
+	if (!pthread_create (
+		&connection->send_thread_id, NULL,
 		connection_send_thread,
 		(void *) connection
 	)) {
@@ -931,6 +995,9 @@ void connection_reset (Connection *connection) {
 		connection->connection_thread_id = 0;
 		connection->connected_timestamp = 0;
 
+		connection->reactor = NULL;
+		connection->uring = NULL;
+
 		cerver_report_delete (connection->cerver_report);
 		connection->cerver_report = NULL;
 
@@ -949,7 +1016,7 @@ void connection_reset (Connection *connection) {
 		connection_reset_received_data (connection);
 
 		connection->send_thread_id = 0;
-		job_queue_clear (connection->send_queue);
+		send_queue_reset (connection->send_queue);
 
 		connection_reset_authentication (connection);
 
@@ -960,10 +1027,30 @@ void connection_reset (Connection *connection) {
 
 }
 
+// stops the connection's send thread before the socket gets closed
+// so that it never writes into a sock fd that could have been reused
+static void connection_end_send (Connection *connection) {
+
+	if (connection->send_thread_id) {
+		(void) pthread_mutex_lock (connection->send_queue->mutex);
+		connection->send_queue->running = false;
+		(void) pthread_cond_signal (connection->send_queue->has_data);
+		(void) pthread_mutex_unlock (connection->send_queue->mutex);
+
+		if (!pthread_equal (connection->send_thread_id, pthread_self ()))
+			(void) pthread_join (connection->send_thread_id, NULL);
+
+		connection->send_thread_id = 0;
+	}
+
+}
+
 // ends a connection
 void connection_end (Connection *connection) {
 
 	if (connection) {
+		connection_end_send (connection);
+
 		if (connection->active) {
 			close (connection->socket->sock_fd);
 			connection->socket->sock_fd = -1;
@@ -991,7 +1078,8 @@ void connection_drop (Cerver *cerver, Connection *connection) {
 
 }
 
-// gets the connection from the on hold connections map in cerver
+// gets the on hold connection from the cerver's fd table
+// on hold connections are the ones without a client
 Connection *connection_get_by_sock_fd_from_on_hold (
 	Cerver *cerver, const i32 sock_fd
 ) {
@@ -999,13 +1087,10 @@ Connection *connection_get_by_sock_fd_from_on_hold (
 	Connection *connection = NULL;
 
 	if (cerver) {
-		const i32 *key = &sock_fd;
-		void *connection_data = htab_get (
-			cerver->on_hold_connection_sock_fd_map,
-			key, sizeof (i32)
-		);
-
-		if (connection_data) connection = (Connection *) connection_data;
+		FdTableEntry entry = { 0 };
+		if (!fd_table_get (cerver->fd_table, sock_fd, &entry)) {
+			if (!entry.client) connection = entry.connection;
+		}
 	}
 
 	return connection;
@@ -1042,15 +1127,10 @@ Connection *connection_get_by_sock_fd_from_admin (
 	Connection *retval = NULL;
 
 	if (admin_cerver) {
-		Connection *con = NULL;
-		for (ListElement *le = dlist_start (admin_cerver->admins); le; le = le->next) {
-			for (ListElement *le_sub = dlist_start (((Admin *) le->data)->client->connections); le_sub; le_sub = le_sub->next) {
-				con = (Connection *) le_sub->data;
-				if (con->socket->sock_fd == sock_fd) {
-					retval = con;
-					break;
-				}
-			}
+		FdTableEntry entry = { 0 };
+		if (!fd_table_get (admin_cerver->cerver->fd_table, sock_fd, &entry)) {
+			if (admin_get_by_client (admin_cerver, entry.client))
+				retval = entry.connection;
 		}
 	}
 
@@ -1107,6 +1187,38 @@ u8 connection_register_to_client (Client *client, Connection *connection) {
 
 }
 
+// registers a new connection to a client that is already in the cerver
+// & maps its sock fd to them in the cerver's fd table
+// fails if the client has started to be removed from the cerver
+// returns 0 on success, 1 on error
+u8 connection_register_to_registered_client (
+	Cerver *cerver, Client *client, Connection *connection
+) {
+
+	u8 retval = 1;
+
+	if (cerver && client && connection) {
+		// the client's removal unregisters his connections after marking him
+		(void) pthread_mutex_lock (client->connections->mutex);
+
+		if (
+			!client->removed
+			&& !dlist_insert_at_end_unsafe (client->connections, connection)
+		) {
+			connection->client = client;
+
+			(void) connection_register_to_cerver (cerver, client, connection);
+
+			retval = 0;
+		}
+
+		(void) pthread_mutex_unlock (client->connections->mutex);
+	}
+
+	return retval;
+
+}
+
 // registers the client connection to the cerver's strcutures (like maps)
 // returns 0 on success, 1 on error
 u8 connection_register_to_cerver (
@@ -1116,10 +1228,11 @@ u8 connection_register_to_cerver (
 	u8 retval = 1;
 
 	if (cerver && client && connection) {
-		// map the socket fd with the client
-		const void *key = &connection->socket->sock_fd;
-		retval = (u8) htab_insert (cerver->client_sock_fd_map, key, sizeof (i32),
-			client, sizeof (Client));
+		// map the socket fd with the client & the connection
+		retval = fd_table_set (
+			cerver->fd_table, connection->socket->sock_fd,
+			client, connection
+		);
 	}
 
 	return retval;
@@ -1135,14 +1248,11 @@ u8 connection_unregister_from_cerver (
 	u8 retval = 1;
 
 	if (cerver && connection) {
-		// remove the sock fd from each map
-		const void *key = &connection->socket->sock_fd;
-		if (htab_remove (cerver->client_sock_fd_map, key, sizeof (i32))) {
-			// cerver_log_success (
-			// 	"Removed sock fd %d from cerver's %s client sock map.",
-			//     connection->socket->sock_fd, cerver->info->name
-			// );
-
+		// the sock fd is only removed if it still belongs to the connection
+		if (!fd_table_remove (
+			cerver->fd_table, connection->socket->sock_fd,
+			connection->client, connection
+		)) {
 			retval = 0;
 		}
 
@@ -1150,7 +1260,7 @@ u8 connection_unregister_from_cerver (
 			#ifdef CERVER_DEBUG
 			cerver_log (
 				LOG_TYPE_ERROR, LOG_TYPE_CERVER,
-				"Failed to remove sock fd %d from cerver's %s client sock map.",
+				"Failed to remove sock fd %d from cerver's %s fd table.",
 				connection->socket->sock_fd, cerver->info->name
 			);
 			#endif
@@ -1163,25 +1273,76 @@ u8 connection_unregister_from_cerver (
 
 // wrapper function for easy access
 // registers a client connection to the cerver poll array
+// or to the cerver's epoll if handler type is CERVER_HANDLER_TYPE_EPOLL
+// or to its reactor if handler type is CERVER_HANDLER_TYPE_REACTORS
+// or to the cerver's io_uring if handler type is CERVER_HANDLER_TYPE_IO_URING
 // returns 0 on success, 1 on error
 u8 connection_register_to_cerver_poll (
 	Cerver *cerver, Connection *connection
 ) {
 
-	return (cerver && connection) ?
-		cerver_poll_register_connection (cerver, connection) : 1;
+	u8 retval = 1;
+
+	if (cerver && connection) {
+		switch (cerver->handler_type) {
+			case CERVER_HANDLER_TYPE_EPOLL:
+				retval = cerver_epoll_register_connection (cerver, connection);
+				break;
+
+			case CERVER_HANDLER_TYPE_REACTORS:
+				retval = cerver_reactors_register_connection (cerver, connection);
+				break;
+
+			case CERVER_HANDLER_TYPE_IO_URING:
+				retval = cerver_uring_register_connection (cerver, connection);
+				break;
+
+			default:
+				retval = cerver_poll_register_connection (cerver, connection);
+				break;
+		}
+	}
+
+	return retval;
 
 }
 
 // wrapper function for easy access
 // unregisters a client connection from the cerver poll array
+// or from the cerver's epoll if handler type is CERVER_HANDLER_TYPE_EPOLL
+// or from its reactor if handler type is CERVER_HANDLER_TYPE_REACTORS
+// or from the cerver's io_uring if handler type is CERVER_HANDLER_TYPE_IO_URING
 // returns 0 on success, 1 on error
 u8 connection_unregister_from_cerver_poll (
 	Cerver *cerver, Connection *connection
 ) {
 
-	return (cerver && connection) ?
-		cerver_poll_unregister_connection (cerver, connection) : 1;
+	u8 retval = 1;
+
+	if (cerver && connection) {
+		// a paused connection must never be resumed after this
+		handler_connection_unpause (connection);
+
+		switch (cerver->handler_type) {
+			case CERVER_HANDLER_TYPE_EPOLL:
+				retval = cerver_epoll_unregister_connection (cerver, connection);
+				break;
+
+			case CERVER_HANDLER_TYPE_REACTORS:
+				retval = cerver_reactors_unregister_connection (cerver, connection);
+				break;
+
+			case CERVER_HANDLER_TYPE_IO_URING:
+				retval = cerver_uring_unregister_connection (cerver, connection);
+				break;
+
+			default:
+				retval = cerver_poll_unregister_connection (cerver, connection);
+				break;
+		}
+	}
+
+	return retval;
 
 }
 
@@ -1218,6 +1379,9 @@ u8 connection_remove_from_cerver (
 	if (cerver && connection) {
 		switch (cerver->handler_type) {
 			case CERVER_HANDLER_TYPE_POLL:
+			case CERVER_HANDLER_TYPE_EPOLL:
+			case CERVER_HANDLER_TYPE_REACTORS:
+			case CERVER_HANDLER_TYPE_IO_URING:
 				errors |= connection_unregister_from_cerver_poll (cerver, connection);
 				break;
 
@@ -1367,19 +1531,171 @@ static void *connection_update_thread (void *connection_ptr) {
 
 #pragma region send
 
+static void connection_send_queue_high_water (
+	Cerver *cerver, Client *client, Connection *connection,
+	const SendQueueOverflow overflow
+) {
+
+	if (overflow == SEND_QUEUE_OVERFLOW_DROP) {
+		// the connection's loop will end the connection
+		// as soon as it gets the hang up from the socket
+		(void) shutdown (connection->socket->sock_fd, SHUT_RDWR);
+	}
+
+	if (cerver) {
+		cerver_event_trigger (
+			CERVER_EVENT_CLIENT_SEND_HIGH_WATER,
+			cerver, client, connection
+		);
+	}
+
+	else if (client) {
+		client_event_trigger (
+			CLIENT_EVENT_SEND_HIGH_WATER,
+			client, connection
+		);
+	}
+
+}
+
+// must be called with the queue's mutex locked
+// connections in the cerver's io_uring submit their data to the ring
+static inline void connection_send_queue_flush_internal (
+	Connection *connection
+) {
+
+	if (connection->uring) {
+		cerver_uring_send_queue_flush (connection);
+	}
+
+	else {
+		(void) send_queue_flush (
+			connection->send_queue,
+			connection->socket->sock_fd, connection->send_flags
+		);
+	}
+
+}
+
+// appends the buffers into the connection's send queue as a single piece
+// the queue is flushed right away if it was empty & it is not corked
+// returns 0 on success, 1 if the data was NOT queued
+u8 connection_send_queue_push (
+	Cerver *cerver,
+	Client *client, Connection *connection,
+	const struct iovec *iov, const int iovcnt
+) {
+
+	SendQueue *queue = connection->send_queue;
+
+	(void) pthread_mutex_lock (queue->mutex);
+
+	const bool was_empty = (queue->tail == queue->head);
+
+	bool high_water = false;
+	u8 retval = send_queue_append (queue, iov, iovcnt, &high_water);
+
+	const SendQueueOverflow overflow = queue->overflow;
+
+	if (!retval && was_empty) {
+		if (queue->threaded) {
+			(void) pthread_cond_signal (queue->has_data);
+		}
+
+		// any data that is left in the queue will be sent
+		// by the connection's loop when the socket is writable
+		else if (!queue->corked) {
+			connection_send_queue_flush_internal (connection);
+		}
+	}
+
+	(void) pthread_mutex_unlock (queue->mutex);
+
+	if (high_water) {
+		connection_send_queue_high_water (
+			cerver, client, connection, overflow
+		);
+	}
+
+	return retval;
+
+}
+
+// sends the connection's queued data without blocking
+// returns 0 on success, 1 on error
+u8 connection_send_queue_flush (Connection *connection) {
+
+	SendQueueFlush result = SEND_QUEUE_FLUSH_DONE;
+
+	(void) pthread_mutex_lock (connection->send_queue->mutex);
+
+	if (connection->send_queue->tail != connection->send_queue->head) {
+		result = send_queue_flush (
+			connection->send_queue,
+			connection->socket->sock_fd, connection->send_flags
+		);
+	}
+
+	(void) pthread_mutex_unlock (connection->send_queue->mutex);
+
+	return (result == SEND_QUEUE_FLUSH_FAILED) ? 1 : 0;
+
+}
+
+// data appended into the connection's queue won't be flushed
+// until connection_send_queue_uncork () gets called
+// used to send all the responses to a batch of packets together
+// returns true if the connection has a send queue
+bool connection_send_queue_cork (Connection *connection) {
+
+	bool retval = false;
+
+	if (connection->send_queue) {
+		(void) pthread_mutex_lock (connection->send_queue->mutex);
+		connection->send_queue->corked = true;
+		(void) pthread_mutex_unlock (connection->send_queue->mutex);
+
+		retval = true;
+	}
+
+	return retval;
+
+}
+
+// flushes any data that was queued since the queue was corked
+void connection_send_queue_uncork (Connection *connection) {
+
+	(void) pthread_mutex_lock (connection->send_queue->mutex);
+
+	connection->send_queue->corked = false;
+
+	if (connection->send_queue->tail != connection->send_queue->head) {
+		connection_send_queue_flush_internal (connection);
+	}
+
+	(void) pthread_mutex_unlock (connection->send_queue->mutex);
+
+}
+
+// appends the packet into the connection's send queue
+// the packet gets deleted after it has been queued
 void connection_send_packet (
 	Connection *connection, Packet *packet
 ) {
 
-	if (connection) {
-		(void) job_queue_push (
-			connection->send_queue,
-			job_create (NULL, packet)
+	if (connection && packet) {
+		(void) packet_send_to (
+			packet, NULL, false,
+			packet->cerver, packet->client, connection, packet->lobby
 		);
+
+		packet_delete (packet);
 	}
 
 }
 
+// waits for data in the connection's queue & flushes it
+// blocking in poll () until the socket is writable again
 static void *connection_send_thread (void *connection_ptr) {
 
 	char client_name[THREAD_NAME_BUFFER_SIZE] = { 0 };
@@ -1387,6 +1703,7 @@ static void *connection_send_thread (void *connection_ptr) {
 
 	Connection *connection = (Connection *) connection_ptr;
 	Client *client = (Client *) connection->client;
+	SendQueue *queue = connection->send_queue;
 
 	#ifdef CONNECTION_DEBUG
 	cerver_log (
@@ -1399,31 +1716,32 @@ static void *connection_send_thread (void *connection_ptr) {
 	(void) strncpy (client_name, client->name, THREAD_NAME_BUFFER_SIZE - 1);
 	(void) strncpy (connection_name, connection->name, THREAD_NAME_BUFFER_SIZE - 1);
 
-	Job *job = NULL;
-	size_t sent = 0;
-	Packet *packet = NULL;
-	u8 failed = 0;
-	while (connection->active && !failed) {
-		bsem_wait (connection->send_queue->has_jobs);
+	struct pollfd pfd = { 0 };
+	pfd.fd = connection->socket->sock_fd;
+	pfd.events = POLLOUT;
 
-		if (connection->active) {
-			job = job_queue_pull (connection->send_queue);
-			if (job) {
-				packet = (Packet *) job->args;
-
-				failed = packet_send_actual (
-					packet,
-					connection->send_flags, &sent,
-					client, connection
-				);
+	SendQueueFlush result = SEND_QUEUE_FLUSH_DONE;
 
-				packet_delete (packet);
+	(void) pthread_mutex_lock (queue->mutex);
 
-				job_delete (job);
-			}
+	while (queue->running && (result != SEND_QUEUE_FLUSH_FAILED)) {
+		while (queue->running && (queue->tail == queue->head))
+			(void) pthread_cond_wait (queue->has_data, queue->mutex);
+
+		result = send_queue_flush (
+			queue, pfd.fd, connection->send_flags
+		);
+
+		if (result == SEND_QUEUE_FLUSH_PENDING) {
+			// the socket is full, new data can still be queued
+			(void) pthread_mutex_unlock (queue->mutex);
+			(void) poll (&pfd, 1, CONNECTION_SEND_POLL_TIMEOUT);
+			(void) pthread_mutex_lock (queue->mutex);
 		}
 	}
 
+	(void) pthread_mutex_unlock (queue->mutex);
+
 	#ifdef CONNECTION_DEBUG
 	cerver_log (
 		LOG_TYPE_DEBUG, LOG_TYPE_CONNECTION,
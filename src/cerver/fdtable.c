@@ -0,0 +1,244 @@
+#include <stdlib.h>
+#include <stdbool.h>
+
+#include <pthread.h>
+
+#include "cerver/types/types.h"
+
+#include "cerver/fdtable.h"
+
+#include "cerver/threads/thread.h"
+
+FdTable *fd_table_new (void) {
+
+	FdTable *table = (FdTable *) malloc (sizeof (FdTable));
+	if (table) {
+		for (u32 i = 0; i < FD_TABLE_MAX_CHUNKS; i++)
+			table->chunks[i] = NULL;
+
+		table->lock = NULL;
+	}
+
+	return table;
+
+}
+
+void fd_table_delete (void *table_ptr) {
+
+	if (table_ptr) {
+		FdTable *table = (FdTable *) table_ptr;
+
+		for (u32 i = 0; i < FD_TABLE_MAX_CHUNKS; i++) {
+			if (table->chunks[i]) free (table->chunks[i]);
+		}
+
+		thread_mutex_delete (table->lock);
+
+		free (table_ptr);
+	}
+
+}
+
+// creates a new table with the first chunk of entries
+// more chunks are allocated when bigger sock fds are set
+FdTable *fd_table_create (void) {
+
+	FdTable *table = fd_table_new ();
+	if (table) {
+		table->chunks[0] = (FdTableEntry *) calloc (
+			FD_TABLE_CHUNK_SIZE, sizeof (FdTableEntry)
+		);
+
+		table->lock = thread_mutex_new ();
+
+		if (!table->chunks[0] || !table->lock) {
+			fd_table_delete (table);
+			table = NULL;
+		}
+	}
+
+	return table;
+
+}
+
+// returns the sock fd's entry
+// returns NULL if its chunk has not been allocated
+static inline FdTableEntry *fd_table_entry (
+	const FdTable *table, const i32 sock_fd
+) {
+
+	FdTableEntry *entry = NULL;
+
+	if ((sock_fd >= 0) && ((u32) sock_fd < (FD_TABLE_CHUNK_SIZE * FD_TABLE_MAX_CHUNKS))) {
+		FdTableEntry *chunk = __atomic_load_n (
+			&table->chunks[(u32) sock_fd / FD_TABLE_CHUNK_SIZE], __ATOMIC_ACQUIRE
+		);
+
+		if (chunk) entry = &chunk[(u32) sock_fd % FD_TABLE_CHUNK_SIZE];
+	}
+
+	return entry;
+
+}
+
+// gets the sock fd's entry, allocating its chunk if needed
+// must be called with the table's lock
+static FdTableEntry *fd_table_entry_create (
+	FdTable *table, const i32 sock_fd
+) {
+
+	FdTableEntry *entry = fd_table_entry (table, sock_fd);
+	if (!entry && (sock_fd >= 0) && ((u32) sock_fd < (FD_TABLE_CHUNK_SIZE * FD_TABLE_MAX_CHUNKS))) {
+		FdTableEntry *chunk = (FdTableEntry *) calloc (
+			FD_TABLE_CHUNK_SIZE, sizeof (FdTableEntry)
+		);
+
+		if (chunk) {
+			// readers can only see the chunk after it has been cleared
+			__atomic_store_n (
+				&table->chunks[(u32) sock_fd / FD_TABLE_CHUNK_SIZE], chunk, __ATOMIC_RELEASE
+			);
+
+			entry = &chunk[(u32) sock_fd % FD_TABLE_CHUNK_SIZE];
+		}
+	}
+
+	return entry;
+
+}
+
+// the generation is odd while the values are being written
+// so readers know they have to try again
+static void fd_table_entry_update (
+	FdTableEntry *entry,
+	struct _Client *client, struct _Connection *connection
+) {
+
+	const u32 generation = entry->generation;
+
+	__atomic_store_n (&entry->generation, generation + 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence (__ATOMIC_RELEASE);
+
+	__atomic_store_n (&entry->client, client, __ATOMIC_RELAXED);
+	__atomic_store_n (&entry->connection, connection, __ATOMIC_RELAXED);
+
+	__atomic_store_n (&entry->generation, generation + 2, __ATOMIC_RELEASE);
+
+}
+
+// maps the sock fd to the client & connection
+// any previous values are replaced, as the sock fd has been reused
+// returns 0 on success, 1 on error
+u8 fd_table_set (
+	FdTable *table, const i32 sock_fd,
+	struct _Client *client, struct _Connection *connection
+) {
+
+	u8 retval = 1;
+
+	if (table && connection) {
+		(void) pthread_mutex_lock (table->lock);
+
+		FdTableEntry *entry = fd_table_entry_create (table, sock_fd);
+		if (entry) {
+			fd_table_entry_update (entry, client, connection);
+
+			retval = 0;
+		}
+
+		(void) pthread_mutex_unlock (table->lock);
+	}
+
+	return retval;
+
+}
+
+// removes the sock fd only if it is still mapped
+// to the same client & connection
+// returns 0 on success, 1 if the sock fd has another owner
+u8 fd_table_remove (
+	FdTable *table, const i32 sock_fd,
+	const struct _Client *client, const struct _Connection *connection
+) {
+
+	u8 retval = 1;
+
+	if (table && connection) {
+		(void) pthread_mutex_lock (table->lock);
+
+		FdTableEntry *entry = fd_table_entry (table, sock_fd);
+		if (
+			entry
+			&& (entry->client == client)
+			&& (entry->connection == connection)
+		) {
+			fd_table_entry_update (entry, NULL, NULL);
+
+			retval = 0;
+		}
+
+		(void) pthread_mutex_unlock (table->lock);
+	}
+
+	return retval;
+
+}
+
+// copies the values mapped to the sock fd into entry
+// returns 0 if the sock fd has a connection, 1 if not
+u8 fd_table_get (
+	const FdTable *table, const i32 sock_fd,
+	FdTableEntry *entry
+) {
+
+	u8 retval = 1;
+
+	const FdTableEntry *current = table ? fd_table_entry (table, sock_fd) : NULL;
+	if (current && entry) {
+		u32 start = 0;
+		u32 end = 0;
+
+		do {
+			start = __atomic_load_n (&current->generation, __ATOMIC_ACQUIRE);
+
+			entry->client = __atomic_load_n (&current->client, __ATOMIC_RELAXED);
+			entry->connection = __atomic_load_n (&current->connection, __ATOMIC_RELAXED);
+
+			__atomic_thread_fence (__ATOMIC_ACQUIRE);
+			end = __atomic_load_n (&current->generation, __ATOMIC_RELAXED);
+		} while ((start & 1) || (start != end));
+
+		entry->generation = start;
+
+		if (entry->connection) retval = 0;
+	}
+
+	else if (entry) {
+		entry->generation = FD_TABLE_INVALID_GENERATION;
+		entry->client = NULL;
+		entry->connection = NULL;
+	}
+
+	return retval;
+
+}
+
+// returns true if the sock fd has not been updated
+// since the generation was read with fd_table_get ()
+// used to check that the sock fd was not closed & reused by another connection
+bool fd_table_check (
+	const FdTable *table, const i32 sock_fd, const u32 generation
+) {
+
+	bool retval = false;
+
+	const FdTableEntry *entry = table ? fd_table_entry (table, sock_fd) : NULL;
+	if (entry) {
+		retval = (
+			__atomic_load_n (&entry->generation, __ATOMIC_ACQUIRE) == generation
+		);
+	}
+
+	return retval;
+
+}
@@ -168,7 +168,7 @@ void game_cerver_register_lobby (GameCerver *game_cerver, Lobby *lobby) {
         // check if the lobby is already registered to the game cerver
         if (!dlist_search (game_cerver->current_lobbys, lobby, NULL)) {
             dlist_insert_after (game_cerver->current_lobbys, dlist_end (game_cerver->current_lobbys), lobby);
-            game_cerver->stats->current_active_lobbys += 1;
+            STATS_ADD (game_cerver->stats->current_active_lobbys, 1);
 
             #ifdef CERVER_DEBUG
             cerver_log (
@@ -207,7 +207,7 @@ void game_cerver_unregister_lobby (GameCerver *game_cerver, Lobby *lobby) {
             );
             #endif
 
-            game_cerver->stats->current_active_lobbys--;
+            STATS_SUB (game_cerver->stats->current_active_lobbys, 1);
 
             #ifdef CERVER_DEBUG
             cerver_log (
@@ -254,7 +254,7 @@ static void game_lobby_create (Packet *packet) {
                     // register the lobby to the cerver
                     game_cerver_register_lobby (game_cerver, lobby);
 
-                    game_cerver->stats->lobbys_created += 1;
+                    STATS_ADD (game_cerver->stats->lobbys_created, 1);
 
                     #ifdef CERVER_DEBUG
                     cerver_log (
@@ -19,6 +19,7 @@
 #include "cerver/client.h"
 #include "cerver/handler.h"
 #include "cerver/packets.h"
+#include "cerver/poll.h"
 
 #include "cerver/threads/thpool.h"
 #include "cerver/threads/thread.h"
@@ -162,6 +163,7 @@ Lobby *lobby_new (void) {
 
         lobby->sock_fd_player_map = NULL;
         lobby->players_fds = NULL;
+        lobby->players_fds_map = NULL;
         lobby->poll_timeout = LOBBY_DEFAULT_POLL_TIMEOUT;
 
         lobby->running = lobby->in_game = false;
@@ -200,6 +202,7 @@ void lobby_delete (void *lobby_ptr) {
         htab_destroy (lobby->sock_fd_player_map);
 
         if (lobby->players_fds) free (lobby->players_fds);
+        poll_fds_map_delete (lobby->players_fds_map);
 
         lobby->owner = NULL;
 
@@ -396,14 +399,12 @@ u8 lobby_poll_init (Lobby *lobby, unsigned int max_players_fds) {
 
     if (lobby) {
         lobby->players_fds = (struct pollfd *) calloc (max_players_fds, sizeof (struct pollfd));
-        if (lobby->players_fds) {
+        lobby->players_fds_map = poll_fds_map_create (POLL_FDS_MAP_DEFAULT_SIZE);
+        if (lobby->players_fds && lobby->players_fds_map) {
             lobby->max_players_fds = max_players_fds;
             lobby->current_players_fds = 0;
 
-            for (u32 i = 0; i < lobby->max_players_fds; i++) {
-                lobby->players_fds[i].fd = -1;
-                lobby->players_fds[i].events = -1;
-            }
+            poll_fds_reset (lobby->players_fds, 0, lobby->max_players_fds);
 
             retval = 0;
         }
@@ -420,40 +421,20 @@ static u8 lobby_realloc_poll_fds (Lobby *lobby) {
     u8 retval = 1;
 
     if (lobby) {
+        u32 current_max = lobby->max_players_fds;
         lobby->max_players_fds = lobby->max_players_fds * 2;
         lobby->players_fds = (struct pollfd *) realloc (lobby->players_fds,
             lobby->max_players_fds * sizeof (struct pollfd));
-        if (lobby->players_fds) retval = 0;
+        if (lobby->players_fds) {
+            poll_fds_reset (lobby->players_fds, current_max, lobby->max_players_fds);
+            retval = 0;
+        }
     }
 
     return retval;
 
 }
 
-// gets a free idx in the lobby poll structure
-static i32 lobby_poll_get_free_idx (const Lobby *lobby) {
-
-    if (lobby) {
-        for (i32 i = 0; i < lobby->max_players_fds; i++) 
-            if (lobby->players_fds[i].fd == -1) return i;
-    }
-
-    return -1;
-
-}
-
-// gets the idx of the connection fd in the poll fds
-static i32 lobby_poll_get_idx_by_sock_fd (const Lobby *lobby, const i32 sock_fd) {
-
-    if (lobby) {
-        for (u32 i = 0; i < lobby->max_players_fds; i++)
-            if (lobby->players_fds[i].fd == sock_fd) return i;
-    }
-
-    return -1;
-
-}
-
 // registers a player's client connection to the lobby poll
 // and maps the sock fd to the player
 u8 lobby_poll_register_connection (Lobby *lobby, Player *player, Connection *connection) {
@@ -461,11 +442,13 @@ u8 lobby_poll_register_connection (Lobby *lobby, Player *player, Connection *con
     u8 retval = 1;
 
     if (lobby && player && connection) {
-        i32 idx = lobby_poll_get_free_idx (lobby);
+        i32 idx = poll_fds_register (
+            lobby->players_fds, lobby->max_players_fds, &lobby->current_players_fds,
+            lobby->players_fds_map,
+            connection->socket->sock_fd, POLLIN
+        );
+
         if (idx >= 0) {
-            lobby->players_fds[idx].fd = connection->socket->sock_fd;
-            lobby->players_fds[idx].events = POLLIN;
-            lobby->current_players_fds++;
 
             #ifdef CERVER_DEBUG
             cerver_log (
@@ -515,12 +498,15 @@ u8 lobby_poll_unregister_connection (Lobby *lobby, Player *player, Connection *c
     u8 retval = 1;
 
     if (lobby && player && connection) {
-        // get the idx of the connection sock in the lobby poll fds
-        i32 idx = lobby_poll_get_idx_by_sock_fd (lobby, connection->socket->sock_fd);
+        // the slot is only reused after the lobby poll compacts its fds
+        i32 idx = poll_fds_unregister (
+            lobby->players_fds,
+            lobby->players_fds_map,
+            connection->socket->sock_fd
+        );
+
         if (idx >= 0) {
-            lobby->players_fds[idx].fd = -1;
-            lobby->players_fds[idx].events = -1;
-            lobby->current_players_fds--;
+            retval = 0;
 
             // const void *key = &connection->sock_fd;
             // retval = htab_remove (lobby->sock_fd_player_map, key, sizeof (i32));
@@ -553,7 +539,13 @@ void lobby_poll (void *ptr) {
 
         int poll_retval = 0;
         while (lobby->running) {
-            poll_retval = poll (lobby->players_fds, lobby->max_players_fds, lobby->poll_timeout);
+            // only the lobby poll moves fds inside its pollfd array
+            poll_fds_compact (
+                lobby->players_fds, &lobby->current_players_fds,
+                lobby->players_fds_map, 0
+            );
+
+            poll_retval = poll (lobby->players_fds, lobby->current_players_fds, lobby->poll_timeout);
 
             // poll failed
             if (poll_retval < 0) {
@@ -576,7 +568,7 @@ void lobby_poll (void *ptr) {
             }
 
             // one or more fd(s) are readable, need to determine which ones they are
-            for (u16 i = 0; i < lobby->current_players_fds; i++) {
+            for (u32 i = 0; i < lobby->current_players_fds; i++) {
                 if (lobby->players_fds[i].revents == 0) continue;
                 if (lobby->players_fds[i].revents != POLLIN) continue;
 
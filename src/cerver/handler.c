@@ -6,15 +6,23 @@
 #include "cerver/config.h"
 
 #include <errno.h>
+#include <fcntl.h>
 #include <pthread.h>
+#include <sched.h>
 #include <time.h>
 #include <unistd.h>
 
+#include <sys/epoll.h>
+#include <sys/socket.h>
 #include <sys/prctl.h>
 #include <sys/poll.h>
+#include <sys/utsname.h>
+
+#include <netinet/in.h>
 
 #include "cerver/types/types.h"
 
+#include "cerver/collections/dlist.h"
 #include "cerver/collections/htab.h"
 
 #include "cerver/admin.h"
@@ -24,15 +32,20 @@
 #include "cerver/connection.h"
 #include "cerver/errors.h"
 #include "cerver/events.h"
+#include "cerver/fdtable.h"
 #include "cerver/files.h"
 #include "cerver/handler.h"
 #include "cerver/network.h"
 #include "cerver/packets.h"
+#include "cerver/poll.h"
 #include "cerver/receive.h"
+#include "cerver/send.h"
 #include "cerver/socket.h"
+#include "cerver/uring.h"
 
 #include "cerver/threads/thread.h"
 #include "cerver/threads/jobs.h"
+#include "cerver/threads/wheel.h"
 
 #include "cerver/game/game.h"
 #include "cerver/game/lobby.h"
@@ -84,6 +97,20 @@ static Handler *handler_new (void) {
 
 		handler->job_queue = NULL;
 
+		handler->max_queue_depth = HANDLER_DEFAULT_MAX_QUEUE_DEPTH;
+		handler->overflow = HANDLER_DEFAULT_OVERFLOW;
+
+		thread_affinity_init (&handler->affinity, THREAD_AFFINITY_NONE);
+
+		handler->paused = 0;
+		handler->paused_connections = dlist_init_intrusive (
+			NULL, NULL, dlist_link_offset (Connection, pause_link)
+		);
+		handler->pause_mutex = thread_mutex_new ();
+		handler->pause_cond = thread_cond_new ();
+
+		(void) memset (&handler->stats, 0, sizeof (HandlerStats));
+
 		handler->cerver = NULL;
 		handler->client = NULL;
 	}
@@ -99,6 +126,10 @@ void handler_delete (void *handler_ptr) {
 
 		job_queue_delete (handler->job_queue);
 
+		dlist_clear_and_delete (handler->paused_connections);
+		thread_mutex_delete (handler->pause_mutex);
+		thread_cond_delete (handler->pause_cond);
+
 		free (handler_ptr);
 	}
 
@@ -175,2197 +206,6006 @@ void handler_set_direct_handle (Handler *handler, bool direct_handle) {
 
 }
 
-// while cerver is running, check for new jobs and handle them
-static void handler_do_while_cerver (Handler *handler) {
+// sets the cpus where the handler's thread will run
+// the handler's id is used as the thread idx for spread & compact affinities
+// must be called before the handler gets started
+void handler_set_affinity (
+	Handler *handler, const ThreadAffinity *affinity
+) {
 
-	Job *job = NULL;
-	Packet *packet = NULL;
-	PacketType packet_type = PACKET_TYPE_NONE;
-	HandlerData *handler_data = handler_data_new ();
-	while (handler->cerver->isRunning) {
-		bsem_wait (handler->job_queue->has_jobs);
+	if (handler && affinity) handler->affinity = *affinity;
 
-		if (handler->cerver->isRunning) {
-			(void) pthread_mutex_lock (handler->cerver->handlers_lock);
-			handler->cerver->num_handlers_working += 1;
-			(void) pthread_mutex_unlock (handler->cerver->handlers_lock);
+}
 
-			// read job from queue
-			job = job_queue_pull (handler->job_queue);
-			if (job) {
-				packet = (Packet *) job->args;
-				packet_type = packet->header.packet_type;
+const char *handler_overflow_to_string (const HandlerOverflow overflow) {
 
-				handler_data->handler_id = handler->id;
-				handler_data->data = handler->data;
-				handler_data->packet = packet;
+	switch (overflow) {
+		#define XX(num, name, string, description) case HANDLER_OVERFLOW_##name: return #string;
+		HANDLER_OVERFLOW_MAP(XX)
+		#undef XX
+	}
 
-				handler->handler (handler_data);
+	return handler_overflow_to_string (HANDLER_OVERFLOW_DROP_NEWEST);
 
-				job_delete (job);
+}
 
-				switch (packet_type) {
-					case PACKET_TYPE_APP: {
-						if (handler->cerver->app_packet_handler_delete_packet)
-							packet_delete (packet);
-					} break;
-					case PACKET_TYPE_APP_ERROR: {
-						if (handler->cerver->app_error_packet_handler_delete_packet)
-							packet_delete (packet);
-					} break;
-					case PACKET_TYPE_CUSTOM: {
-						if (handler->cerver->custom_packet_handler_delete_packet)
-							packet_delete (packet);
-					} break;
+const char *handler_overflow_description (const HandlerOverflow overflow) {
 
-					default: packet_delete (packet); break;
-				}
-			}
+	switch (overflow) {
+		#define XX(num, name, string, description) case HANDLER_OVERFLOW_##name: return #description;
+		HANDLER_OVERFLOW_MAP(XX)
+		#undef XX
+	}
 
-			(void) pthread_mutex_lock (handler->cerver->handlers_lock);
-			handler->cerver->num_handlers_working -= 1;
-			(void) pthread_mutex_unlock (handler->cerver->handlers_lock);
-		}
+	return handler_overflow_description (HANDLER_OVERFLOW_DROP_NEWEST);
+
+}
+
+// sets the max number of jobs (packets) that can be waiting in the handler's queue
+// and what to do with new ones when it has been reached
+void handler_set_max_queue_depth (
+	Handler *handler,
+	const size_t max_queue_depth, const HandlerOverflow overflow
+) {
+
+	if (handler) {
+		handler->max_queue_depth = max_queue_depth;
+		handler->overflow = overflow;
 	}
 
-	handler_data_delete (handler_data);
+}
+
+// returns the number of jobs that are waiting in the handler's queue
+size_t handler_get_queue_depth (const Handler *handler) {
+
+	return handler ? job_queue_size (handler->job_queue) : 0;
 
 }
 
-// while client is running, check for new jobs and handle them
-static void handler_do_while_client (Handler *handler) {
+// copies the handler's stats into stats
+void handler_get_stats (
+	const Handler *handler, HandlerStats *stats
+) {
 
-	Job *job = NULL;
-	Packet *packet = NULL;
-	HandlerData *handler_data = handler_data_new ();
-	while (handler->client->running) {
-		bsem_wait (handler->job_queue->has_jobs);
+	if (handler && stats) {
+		stats->queue_depth = job_queue_size (handler->job_queue);
+		stats->queue_high_water = __atomic_load_n (
+			&handler->stats.queue_high_water, __ATOMIC_RELAXED
+		);
 
-		if (handler->client->running) {
-			(void) pthread_mutex_lock (handler->client->handlers_lock);
-			handler->client->num_handlers_working += 1;
-			(void) pthread_mutex_unlock (handler->client->handlers_lock);
+		stats->jobs_pushed = __atomic_load_n (&handler->stats.jobs_pushed, __ATOMIC_RELAXED);
+		stats->jobs_handled = __atomic_load_n (&handler->stats.jobs_handled, __ATOMIC_RELAXED);
+		stats->jobs_dropped = __atomic_load_n (&handler->stats.jobs_dropped, __ATOMIC_RELAXED);
+		stats->overflows = __atomic_load_n (&handler->stats.overflows, __ATOMIC_RELAXED);
 
-			// read job from queue
-			job = job_queue_pull (handler->job_queue);
-			if (job) {
-				packet = (Packet *) job->args;
+		for (unsigned int i = 0; i < HANDLER_LATENCY_BUCKETS; i++) {
+			stats->latency[i] = __atomic_load_n (
+				&handler->stats.latency[i], __ATOMIC_RELAXED
+			);
+		}
+	}
 
-				handler_data->handler_id = handler->id;
-				handler_data->data = handler->data;
-				handler_data->packet = packet;
+}
 
-				handler->handler (handler_data);
+void handler_print_stats (const Handler *handler) {
 
-				job_delete (job);
-				packet_delete (packet);
+	if (handler) {
+		HandlerStats stats = { 0 };
+		handler_get_stats (handler, &stats);
+
+		cerver_log_msg ("\nHandler's <%d> stats:\n", handler->unique_id);
+		cerver_log_msg ("Queue depth:               %lu", stats.queue_depth);
+		cerver_log_msg ("Queue high water:          %lu", stats.queue_high_water);
+		cerver_log_msg ("Max queue depth:           %lu", handler->max_queue_depth);
+		cerver_log_msg ("Overflow policy:           %s\n", handler_overflow_to_string (handler->overflow));
+
+		cerver_log_msg ("Jobs pushed:               %lu", stats.jobs_pushed);
+		cerver_log_msg ("Jobs handled:              %lu", stats.jobs_handled);
+		cerver_log_msg ("Jobs dropped:              %lu", stats.jobs_dropped);
+		cerver_log_msg ("Overflows:                 %lu\n", stats.overflows);
+
+		cerver_log_msg ("Queue latency:");
+		for (unsigned int i = 0; i < (HANDLER_LATENCY_BUCKETS - 1); i++) {
+			if (stats.latency[i]) {
+				cerver_log_msg ("< %8lu us:               %lu", 1UL << i, stats.latency[i]);
 			}
+		}
 
-			(void) pthread_mutex_lock (handler->client->handlers_lock);
-			handler->client->num_handlers_working -= 1;
-			(void) pthread_mutex_unlock (handler->client->handlers_lock);
+		if (stats.latency[HANDLER_LATENCY_BUCKETS - 1]) {
+			cerver_log_msg (
+				">= %7lu us:               %lu",
+				1UL << (HANDLER_LATENCY_BUCKETS - 2),
+				stats.latency[HANDLER_LATENCY_BUCKETS - 1]
+			);
 		}
 	}
 
-	handler_data_delete (handler_data);
-
 }
 
-// while cerver is running, check for new jobs and handle them
-static void handler_do_while_admin (Handler *handler) {
+static u64 handler_time_ns (void) {
 
-	Job *job = NULL;
-	Packet *packet = NULL;
-	PacketType packet_type = PACKET_TYPE_NONE;
-	HandlerData *handler_data = handler_data_new ();
-	while (handler->cerver->isRunning) {
-		bsem_wait (handler->job_queue->has_jobs);
+	struct timespec now = { 0 };
+	(void) clock_gettime (CLOCK_MONOTONIC, &now);
 
-		if (handler->cerver->isRunning) {
-			(void) pthread_mutex_lock (handler->cerver->admin->handlers_lock);
-			handler->cerver->admin->num_handlers_working += 1;
-			(void) pthread_mutex_unlock (handler->cerver->admin->handlers_lock);
+	return ((u64) now.tv_sec * 1000000000) + (u64) now.tv_nsec;
 
-			// read job from queue
-			job = job_queue_pull (handler->job_queue);
-			if (job) {
-				packet = (Packet *) job->args;
-				packet_type = packet->header.packet_type;
+}
 
-				handler_data->handler_id = handler->id;
-				handler_data->data = handler->data;
-				handler_data->packet = packet;
+static bool handler_is_running (const Handler *handler) {
 
-				handler->handler (handler_data);
+	bool running = false;
 
-				job_delete (job);
+	switch (handler->type) {
+		case HANDLER_TYPE_CERVER:
+		case HANDLER_TYPE_ADMIN:
+			running = handler->cerver->isRunning;
+			break;
+		case HANDLER_TYPE_CLIENT:
+			running = handler->client->running;
+			break;
 
-				switch (packet_type) {
-					case PACKET_TYPE_APP: {
-						if (handler->cerver->admin->app_packet_handler_delete_packet)
-							packet_delete (packet);
-					} break;
-					case PACKET_TYPE_APP_ERROR: {
-						if (handler->cerver->admin->app_error_packet_handler_delete_packet)
-							packet_delete (packet);
-					} break;
-					case PACKET_TYPE_CUSTOM: {
-						if (handler->cerver->admin->custom_packet_handler_delete_packet)
-							packet_delete (packet);
-					} break;
+		default: break;
+	}
 
-					default: packet_delete (packet); break;
-				}
-			}
+	return running;
 
-			(void) pthread_mutex_lock (handler->cerver->admin->handlers_lock);
-			handler->cerver->admin->num_handlers_working -= 1;
-			(void) pthread_mutex_unlock (handler->cerver->admin->handlers_lock);
-		}
-	}
+}
 
-	handler_data_delete (handler_data);
+// counts the packets that udp peers have in the cerver handlers' queues
+// as peers share the cerver's socket, they are only deleted by the udp loop
+// after every one of their packets has been handled
+static inline void handler_job_connection_hold (Connection *connection) {
+
+	if (connection && (connection->protocol == PROTOCOL_UDP)) {
+		(void) __atomic_add_fetch (
+			&connection->queued_packets, 1, __ATOMIC_RELAXED
+		);
+	}
 
 }
 
-static void *handler_do (void *handler_ptr) {
+static inline void handler_job_connection_release (Connection *connection) {
 
-	if (handler_ptr) {
-		Handler *handler = (Handler *) handler_ptr;
+	if (connection && (connection->protocol == PROTOCOL_UDP)) {
+		(void) __atomic_sub_fetch (
+			&connection->queued_packets, 1, __ATOMIC_RELEASE
+		);
+	}
 
-		pthread_mutex_t *handlers_lock = NULL;
-		switch (handler->type) {
-			case HANDLER_TYPE_CERVER:
-				handlers_lock = handler->cerver->handlers_lock;
-				break;
-			case HANDLER_TYPE_CLIENT:
-				handlers_lock = handler->client->handlers_lock;
-				break;
-			case HANDLER_TYPE_ADMIN:
-				handlers_lock = handler->cerver->admin->handlers_lock;
-				break;
-			default: break;
-		}
+}
 
-		// set the thread name
-		if (handler->id >= 0) {
-			char thread_name[THREAD_NAME_BUFFER_SIZE] = { 0 };
+// deletes the jobs alongside the packets they reference
+static void handler_drop_jobs (
+	Handler *handler, void **jobs, const unsigned int n_jobs
+) {
 
-			switch (handler->type) {
-				case HANDLER_TYPE_CERVER:
-					(void) snprintf (
-						thread_name, THREAD_NAME_BUFFER_SIZE,
-						"cerver-handler-%d", handler->unique_id
-					);
-					break;
-				case HANDLER_TYPE_CLIENT:
-					(void) snprintf (
-						thread_name, THREAD_NAME_BUFFER_SIZE,
-						"client-handler-%d", handler->unique_id
-					);
-					break;
-				case HANDLER_TYPE_ADMIN:
-					(void) snprintf (
-						thread_name, THREAD_NAME_BUFFER_SIZE,
-						"admin-handler-%d", handler->unique_id
-					);
-					break;
-				default: break;
-			}
+	Job *job = NULL;
+	for (unsigned int i = 0; i < n_jobs; i++) {
+		job = (Job *) jobs[i];
 
-			// printf ("%s\n", thread_name);
-			(void) prctl (PR_SET_NAME, thread_name);
-		}
+		if (handler->type == HANDLER_TYPE_CERVER)
+			handler_job_connection_release (((Packet *) job->args)->connection);
 
-		// TODO: register to signals to handle multiple actions
+		packet_delete (job->args);
+		job_delete (job);
+	}
 
-		if (handler->data_create)
-			handler->data = handler->data_create (handler->data_create_args);
+	(void) __atomic_add_fetch (
+		&handler->stats.jobs_dropped, n_jobs, __ATOMIC_RELAXED
+	);
 
-		// mark the handler as alive and ready
-		(void) pthread_mutex_lock (handlers_lock);
-		switch (handler->type) {
-			case HANDLER_TYPE_CERVER: handler->cerver->num_handlers_alive += 1; break;
-			case HANDLER_TYPE_CLIENT: handler->client->num_handlers_alive += 1; break;
-			case HANDLER_TYPE_ADMIN: handler->cerver->admin->num_handlers_alive += 1; break;
-			default: break;
-		}
-		(void) pthread_mutex_unlock (handlers_lock);
+}
 
-		// while cerver / client is running, check for new jobs and handle them
-		switch (handler->type) {
-			case HANDLER_TYPE_CERVER: handler_do_while_cerver (handler); break;
-			case HANDLER_TYPE_CLIENT: handler_do_while_client (handler); break;
-			case HANDLER_TYPE_ADMIN: handler_do_while_admin (handler); break;
-			default: break;
-		}
+// removes up to n_jobs from the start of the handler's queue
+static void handler_drop_oldest_jobs (Handler *handler, size_t n_jobs) {
 
-		if (handler->data_delete)
-			handler->data_delete (handler->data);
+	void *oldest[HANDLER_JOBS_BATCH] = { 0 };
+	unsigned int pulled = 0;
 
-		(void) pthread_mutex_lock (handlers_lock);
-		switch (handler->type) {
-			case HANDLER_TYPE_CERVER: handler->cerver->num_handlers_alive -= 1; break;
-			case HANDLER_TYPE_CLIENT: handler->client->num_handlers_alive -= 1; break;
-			case HANDLER_TYPE_ADMIN: handler->cerver->admin->num_handlers_alive -= 1; break;
-			default: break;
-		}
-		(void) pthread_mutex_unlock (handlers_lock);
-	}
+	while (n_jobs) {
+		pulled = job_queue_pull_batch (
+			handler->job_queue, oldest,
+			(n_jobs < HANDLER_JOBS_BATCH) ? (unsigned int) n_jobs : HANDLER_JOBS_BATCH
+		);
 
-	return NULL;
+		if (!pulled) break;
+
+		handler_drop_jobs (handler, oldest, pulled);
+		n_jobs -= pulled;
+	}
 
 }
 
-// starts the new handler by creating a dedicated thread for it
-// called by internal cerver methods
-int handler_start (Handler *handler) {
+// waits until the handler has drained half of its queue
+// the timed wait makes sure we never get stuck if the handler ends
+static void handler_pause_wait (Handler *handler) {
 
-	int retval = 1;
+	const size_t resume_depth = handler->max_queue_depth / 2;
 
-	if (handler) {
-		if (handler->type != HANDLER_TYPE_NONE) {
-			if (!thread_create_detachable (
-				&handler->thread_id,
-				(void *(*)(void *)) handler_do,
-				(void *) handler
-			)) {
-				#ifdef HANDLER_DEBUG
-				cerver_log (
-					LOG_TYPE_DEBUG, LOG_TYPE_HANDLER,
-					"Created handler %d thread!",
-					handler->unique_id
-				);
-				#endif
+	struct timespec timeout = { 0 };
 
-				retval = 0;
-			}
-		}
+	(void) pthread_mutex_lock (handler->pause_mutex);
 
-		else {
-			cerver_log_error (
-				"handler_start () - Handler %d is of invalid type!",
-				handler->unique_id
-			);
+	handler->paused += 1;
+	while (
+		(job_queue_size (handler->job_queue) > resume_depth)
+		&& handler_is_running (handler)
+	) {
+		(void) clock_gettime (CLOCK_REALTIME, &timeout);
+		timeout.tv_nsec += HANDLER_PAUSE_WAIT_MS * 1000000L;
+		if (timeout.tv_nsec >= 1000000000L) {
+			timeout.tv_sec += 1;
+			timeout.tv_nsec -= 1000000000L;
 		}
+
+		(void) pthread_cond_timedwait (
+			handler->pause_cond, handler->pause_mutex, &timeout
+		);
 	}
 
-	return retval;
+	handler->paused -= 1;
+
+	(void) pthread_mutex_unlock (handler->pause_mutex);
 
 }
 
-#pragma endregion
+// stops reading from the connection until the handler has drained its queue
+// the queue is checked again while holding the lock, so the connection
+// is never paused after the handler has already resumed the others
+static void handler_pause_connection (Handler *handler, Connection *connection) {
 
-#pragma region handlers
+	(void) pthread_mutex_lock (handler->pause_mutex);
 
-const char *cerver_handler_error_to_string (
-	const CerverHandlerError error
-) {
+	if (
+		!connection->paused_handler
+		&& (job_queue_size (handler->job_queue) > (handler->max_queue_depth / 2))
+		&& !cerver_handler_connection_set_reading (handler->cerver, connection, false)
+	) {
+		(void) dlist_insert_at_end_unsafe (handler->paused_connections, connection);
+		__atomic_store_n (&connection->paused_handler, handler, __ATOMIC_RELEASE);
 
-	switch (error) {
-		#define XX(num, name, string, description) case CERVER_HANDLER_ERROR_##name: return #string;
-		CERVER_HANDLER_ERROR_MAP(XX)
-		#undef XX
+		handler->paused += 1;
 	}
 
-	return cerver_handler_error_to_string (CERVER_HANDLER_ERROR_NONE);
+	(void) pthread_mutex_unlock (handler->pause_mutex);
 
 }
 
-const char *cerver_handler_error_description (
-	const CerverHandlerError error
-) {
+// lets every paused connection read again
+// must be called while holding the handler's pause mutex
+static void handler_resume_connections (Handler *handler) {
 
-	switch (error) {
-		#define XX(num, name, string, description) case CERVER_HANDLER_ERROR_##name: return #description;
-		CERVER_HANDLER_ERROR_MAP(XX)
-		#undef XX
+	Connection *connection = NULL;
+	while ((connection = (Connection *) dlist_remove_start_unsafe (
+		handler->paused_connections
+	))) {
+		__atomic_store_n (&connection->paused_handler, NULL, __ATOMIC_RELEASE);
+
+		(void) cerver_handler_connection_set_reading (
+			handler->cerver, connection, true
+		);
+
+		handler->paused -= 1;
 	}
 
-	return cerver_handler_error_description (CERVER_HANDLER_ERROR_NONE);
+}
+
+// wakes up the producers that are waiting for the queue to drain
+// and resumes the connections that have stopped reading
+static void handler_pause_resume (Handler *handler) {
+
+	if (__atomic_load_n (&handler->paused, __ATOMIC_RELAXED)) {
+		(void) pthread_mutex_lock (handler->pause_mutex);
+
+		if (job_queue_size (handler->job_queue) <= (handler->max_queue_depth / 2)) {
+			(void) pthread_cond_broadcast (handler->pause_cond);
+
+			handler_resume_connections (handler);
+		}
+
+		(void) pthread_mutex_unlock (handler->pause_mutex);
+	}
 
 }
 
-// handles a packet of type PACKET_TYPE_CLIENT
-static CerverHandlerError cerver_client_packet_handler (
-	Packet *packet
-) {
+// returns true if the connection has stopped reading
+// because its handler's queue is full
+bool handler_connection_is_paused (const Connection *connection) {
 
-	CerverHandlerError error = CERVER_HANDLER_ERROR_NONE;
+	return __atomic_load_n (&connection->paused_handler, __ATOMIC_ACQUIRE) != NULL;
 
-	switch (packet->header.request_type) {
-		// the client is going to close its current connection
-		// but will remain in the cerver if it has another connection active
-		// if not, it will be dropped
-		case CLIENT_PACKET_TYPE_CLOSE_CONNECTION: {
-			#ifdef HANDLER_DEBUG
-			cerver_log_debug (
-				"Client %ld requested to close the connection",
-				packet->client->id
-			);
-			#endif
+}
 
-			// check if the client is inside a lobby
-			if (packet->lobby) {
-				#ifdef HANDLER_DEBUG
-				cerver_log (
-					LOG_TYPE_DEBUG, LOG_TYPE_GAME,
-					"Client %ld inside lobby %s wants to close the connection...",
-					packet->client->id, packet->lobby->id->str
-				);
-				#endif
+// removes the connection from its handler's paused connections
+// must be called before the connection is unregistered from the cerver
+void handler_connection_unpause (Connection *connection) {
 
-				// remove the player from the lobby
-				(void) player_unregister_from_lobby (
-					packet->lobby,
-					player_get_by_sock_fd_list (
-						packet->lobby, packet->connection->socket->sock_fd
-					)
-				);
-			}
+	Handler *handler = __atomic_load_n (&connection->paused_handler, __ATOMIC_ACQUIRE);
+	if (handler) {
+		(void) pthread_mutex_lock (handler->pause_mutex);
 
-			switch (client_remove_connection_by_sock_fd (
-				packet->cerver,
-				packet->client, packet->connection->socket->sock_fd
-			)) {
-				case CLIENT_CONNECTIONS_STATUS_DROPPED:
-					error = CERVER_HANDLER_ERROR_DROPPED;
-					break;
+		// the handler might have resumed it while we were waiting
+		if (connection->paused_handler == handler) {
+			(void) dlist_remove_element_unsafe (
+				handler->paused_connections, &connection->pause_link
+			);
 
-				default: break;
-			}
-		} break;
+			__atomic_store_n (&connection->paused_handler, NULL, __ATOMIC_RELEASE);
 
-		// the client is going to disconnect
-		// and will close all of its active connections
-		// so drop it from the server
-		case CLIENT_PACKET_TYPE_DISCONNECT: {
-			// check if the client is inside a lobby
-			if (packet->lobby) {
-				#ifdef HANDLER_DEBUG
-				cerver_log (
-					LOG_TYPE_DEBUG, LOG_TYPE_GAME,
-					"Client %ld inside lobby %s wants to close the connection...",
-					packet->client->id, packet->lobby->id->str
-				);
-				#endif
+			handler->paused -= 1;
+		}
 
-				// remove the player from the lobby
-				(void) player_unregister_from_lobby (
-					packet->lobby,
-					player_get_by_sock_fd_list (
-						packet->lobby, packet->connection->socket->sock_fd
-					)
-				);
-			}
+		(void) pthread_mutex_unlock (handler->pause_mutex);
+	}
 
-			client_drop (packet->cerver, packet->client);
+}
 
-			cerver_event_trigger (
-				CERVER_EVENT_CLIENT_DISCONNECTED,
-				packet->cerver,
-				NULL, NULL
-			);
-		} break;
+static void handler_update_high_water (Handler *handler, const size_t depth) {
 
-		default: {
-			#ifdef HANDLER_DEBUG
-			cerver_log (
-				LOG_TYPE_WARNING, LOG_TYPE_HANDLER,
-				"Got an unknown client packet in cerver %s",
-				packet->cerver->info->name
-			);
-			#endif
-		} break;
-	}
+	size_t high_water = __atomic_load_n (
+		&handler->stats.queue_high_water, __ATOMIC_RELAXED
+	);
 
-	return error;
+	while (
+		(depth > high_water)
+		&& !__atomic_compare_exchange_n (
+			&handler->stats.queue_high_water, &high_water, depth,
+			true, __ATOMIC_RELAXED, __ATOMIC_RELAXED
+		)
+	);
 
 }
 
-static inline void cerver_request_get_file_actual (Packet *packet) {
+// the handler's thread is the only one that writes these stats
+static inline void handler_stat_add (u64 *stat, const u64 value) {
 
-	FileCerver *file_cerver = (FileCerver *) packet->cerver->cerver_data;
+	__atomic_store_n (
+		stat, __atomic_load_n (stat, __ATOMIC_RELAXED) + value, __ATOMIC_RELAXED
+	);
 
-	file_cerver->stats->n_files_requests += 1;
+}
 
-	// get the necessary information to fulfil the request
-	if (packet->data_size >= sizeof (FileHeader)) {
-		char *end = (char *) packet->data;
-		FileHeader *file_header = (FileHeader *) end;
+// updates the stats of the jobs that the handler has taken from its queue
+// and lets paused producers continue if the queue has been drained
+static void handler_jobs_dispatched (
+	Handler *handler, void **jobs, const unsigned int n_jobs
+) {
 
-		// search for the requested file in the configured paths
-		String *actual_filename = file_cerver_search_file (
-			file_cerver, file_header->filename
-		);
+	const u64 now = handler_time_ns ();
 
-		if (actual_filename) {
-			#ifdef HANDLER_DEBUG
-			cerver_log_debug (
-				"cerver_request_get_file () - Sending %s...\n",
-				actual_filename->str
-			);
-			#endif
+	u64 waited = 0;
+	unsigned int bucket = 0;
+	for (unsigned int i = 0; i < n_jobs; i++) {
+		waited = (now - ((Job *) jobs[i])->timestamp) / 1000;
 
-			// if found, pipe the file contents to the client's socket fd
-			// the socket should be blocked during the entire operation
-			ssize_t sent = file_cerver_send_file (
-				packet->cerver, packet->client, packet->connection,
-				actual_filename->str
-			);
+		bucket = waited ? (unsigned int) (64 - __builtin_clzll (waited)) : 0;
+		if (bucket >= HANDLER_LATENCY_BUCKETS) bucket = HANDLER_LATENCY_BUCKETS - 1;
 
-			if (sent > 0) {
-				file_cerver->stats->n_success_files_requests += 1;
-				file_cerver->stats->n_files_sent += 1;
-				file_cerver->stats->n_bytes_sent += sent;
+		handler_stat_add (&handler->stats.latency[bucket], 1);
+	}
 
-				#ifdef HANDLER_DEBUG
-				cerver_log_success (
-					"Sent file %s", actual_filename->str
-				);
-				#endif
-			}
+	handler_stat_add (&handler->stats.jobs_handled, n_jobs);
 
-			else {
-				cerver_log_error (
-					"Failed to send file %s", actual_filename->str
-				);
+	if (handler->max_queue_depth) handler_pause_resume (handler);
 
-				file_cerver->stats->n_bad_files_sent += 1;
-			}
+}
 
-			str_delete (actual_filename);
-		}
+static unsigned int handler_push_jobs_internal (
+	Handler *handler, Connection *connection,
+	void **jobs, const unsigned int n_jobs
+) {
 
-		else {
-			#ifdef HANDLER_DEBUG
-			cerver_log_warning ("cerver_request_get_file () - file not found");
-			#endif
+	void **push = jobs;
+	unsigned int n_push = n_jobs;
+	bool pause = false;
 
-			// if not found, return an error to the client
-			(void) error_packet_generate_and_send (
-				CERVER_ERROR_FILE_NOT_FOUND, "File not found",
-				packet->cerver, packet->client, packet->connection
-			);
+	if (handler->max_queue_depth) {
+		const size_t depth = job_queue_size (handler->job_queue);
+		const size_t room = (depth < handler->max_queue_depth)
+			? handler->max_queue_depth - depth : 0;
 
-			file_cerver->stats->n_bad_files_requests += 1;
+		if (n_jobs > room) {
+			(void) __atomic_add_fetch (&handler->stats.overflows, 1, __ATOMIC_RELAXED);
+
+			switch (handler->overflow) {
+				case HANDLER_OVERFLOW_DROP_NEWEST:
+					n_push = (unsigned int) room;
+					break;
+
+				case HANDLER_OVERFLOW_DROP_OLDEST: {
+					// only the newest jobs of the batch fit in the queue
+					if (n_jobs > handler->max_queue_depth) {
+						n_push = (unsigned int) handler->max_queue_depth;
+						push = &jobs[n_jobs - n_push];
+					}
+
+					handler_drop_oldest_jobs (handler, n_push - room);
+				} break;
+
+				case HANDLER_OVERFLOW_PAUSE:
+					pause = true;
+					break;
+
+				case HANDLER_OVERFLOW_ERROR: {
+					n_push = (unsigned int) room;
+
+					Packet *packet = (Packet *) ((Job *) jobs[n_push])->args;
+					(void) error_packet_generate_and_send (
+						CERVER_ERROR_PACKET_ERROR, "Handler queue is full",
+						packet->cerver, packet->client, packet->connection
+					);
+				} break;
+
+				default: break;
+			}
 		}
+	}
+
+	const u64 now = handler_time_ns ();
+	for (unsigned int i = 0; i < n_push; i++)
+		((Job *) push[i])->timestamp = now;
 
+	const unsigned int pushed = n_push
+		? job_queue_push_batch (handler->job_queue, push, n_push) : 0;
+
+	if (pushed) {
+		(void) __atomic_add_fetch (&handler->stats.jobs_pushed, pushed, __ATOMIC_RELAXED);
+		handler_update_high_water (handler, job_queue_size (handler->job_queue));
 	}
 
-	else {
-		#ifdef HANDLER_DEBUG
-		cerver_log_warning ("cerver_request_get_file () - missing file header");
-		#endif
+	// jobs before & after the ones that were pushed
+	const unsigned int skipped = (unsigned int) (push - jobs);
+	if (skipped) handler_drop_jobs (handler, jobs, skipped);
 
-		// return a bad request error packet
-		(void) error_packet_generate_and_send (
-			CERVER_ERROR_GET_FILE, "Missing file header",
-			packet->cerver, packet->client, packet->connection
-		);
+	const unsigned int remaining = n_jobs - skipped - pushed;
+	if (remaining) handler_drop_jobs (handler, &push[pushed], remaining);
 
-		file_cerver->stats->n_bad_files_requests += 1;
+	if (pause) {
+		if (connection) handler_pause_connection (handler, connection);
+		else handler_pause_wait (handler);
 	}
 
+	return skipped + remaining;
+
 }
 
-// handles a request from a client to get a file
-void cerver_request_get_file (Packet *packet) {
+// pushes the jobs to the handler's queue using its overflow policy
+// jobs that are not pushed get deleted alongside their packets
+// returns the number of jobs that were dropped
+unsigned int handler_push_jobs (
+	Handler *handler, void **jobs, const unsigned int n_jobs
+) {
 
-	switch (packet->cerver->type) {
-		case CERVER_TYPE_CUSTOM:
-		case CERVER_TYPE_FILES: {
-			cerver_request_get_file_actual (packet);
-		} break;
+	return handler_push_jobs_internal (handler, NULL, jobs, n_jobs);
 
-		default: {
-			#ifdef HANDLER_DEBUG
-			cerver_log_warning (
-				"Cerver %s is not able to handle REQUEST_PACKET_TYPE_GET_FILE requests",
-				packet->cerver->info->name
-			);
-			#endif
+}
 
-			(void) error_packet_generate_and_send (
-				CERVER_ERROR_GET_FILE, "Unable to process request",
-				packet->cerver, packet->client, packet->connection
-			);
-		} break;
-	}
+// works as handler_push_jobs () but with HANDLER_OVERFLOW_PAUSE
+// only the connection stops reading instead of waiting for the queue to drain
+// it is resumed by the handler after it has drained half of its queue
+// returns the number of jobs that were dropped
+unsigned int handler_push_connection_jobs (
+	Handler *handler, Connection *connection,
+	void **jobs, const unsigned int n_jobs
+) {
+
+	return handler_push_jobs_internal (handler, connection, jobs, n_jobs);
 
 }
 
-static inline void cerver_request_send_file_actual (Packet *packet) {
+// while cerver is running, check for new jobs and handle them
+static void handler_do_while_cerver (Handler *handler) {
 
-	FileCerver *file_cerver = (FileCerver *) packet->cerver->cerver_data;
+	void *jobs[HANDLER_JOBS_BATCH] = { 0 };
+	unsigned int n_jobs = 0;
 
-	file_cerver->stats->n_files_upload_requests += 1;
+	Job *job = NULL;
+	Packet *packet = NULL;
+	PacketType packet_type = PACKET_TYPE_NONE;
+	Connection *connection = NULL;
+	HandlerData *handler_data = handler_data_new ();
+	while (handler->cerver->isRunning) {
+		job_queue_wait (handler->job_queue);
 
-	// get the necessary information to fulfil the request
-	if (packet->data_size >= sizeof (FileHeader)) {
-		char *end = (char *) packet->data;
-		FileHeader *file_header = (FileHeader *) end;
+		if (handler->cerver->isRunning) {
+			// handle every job that we can get in a single wakeup
+			n_jobs = job_queue_pull_batch (
+				handler->job_queue, jobs, HANDLER_JOBS_BATCH
+			);
 
-		const char *file_data = NULL;
-		size_t file_data_len = 0;
-		// printf (
-		// 	"\n\npacket->data_size %ld > sizeof (FileHeader) %ld\n\n",
-		// 	packet->data_size, sizeof (FileHeader)
-		// );
-		if (packet->data_size > sizeof (FileHeader)) {
-			file_data = end += sizeof (FileHeader);
-			file_data_len = packet->data_size - sizeof (FileHeader);
-		}
+			if (n_jobs) {
+				handler_jobs_dispatched (handler, jobs, n_jobs);
 
-		char *saved_filename = NULL;
-		if (!file_cerver->file_upload_handler (
-			packet->cerver, packet->client, packet->connection,
-			file_header,
-			file_data, file_data_len,
-			&saved_filename
-		)) {
-			file_cerver->stats->n_success_files_uploaded += 1;
+				(void) __atomic_add_fetch (
+					&handler->cerver->num_handlers_working, 1, __ATOMIC_RELAXED
+				);
 
-			file_cerver->stats->n_bytes_received += file_header->len;
+				for (unsigned int i = 0; i < n_jobs; i++) {
+					job = (Job *) jobs[i];
 
-			if (file_cerver->file_upload_cb) {
-				file_cerver->file_upload_cb (
-					packet->cerver, packet->client, packet->connection,
-					saved_filename
-				);
-			}
-			
-			if (saved_filename) free (saved_filename);
-		}
+					packet = (Packet *) job->args;
+					packet_type = packet->header.packet_type;
+					connection = packet->connection;
 
-		else {
-			cerver_log_error ("Failed to receive file");
+					handler_data->handler_id = handler->id;
+					handler_data->data = handler->data;
+					handler_data->packet = packet;
 
-			file_cerver->stats->n_bad_files_received += 1;
-		}
-	}
+					handler->handler (handler_data);
 
-	else {
-		// return a bad request error packet
-		(void) error_packet_generate_and_send (
-			CERVER_ERROR_SEND_FILE, "Missing file header",
-			packet->cerver, packet->client, packet->connection
-		);
+					job_delete (job);
 
-		file_cerver->stats->n_bad_files_upload_requests += 1;
+					switch (packet_type) {
+						case PACKET_TYPE_APP: {
+							if (handler->cerver->app_packet_handler_delete_packet)
+								packet_delete (packet);
+						} break;
+						case PACKET_TYPE_APP_ERROR: {
+							if (handler->cerver->app_error_packet_handler_delete_packet)
+								packet_delete (packet);
+						} break;
+						case PACKET_TYPE_CUSTOM: {
+							if (handler->cerver->custom_packet_handler_delete_packet)
+								packet_delete (packet);
+						} break;
+
+						default: packet_delete (packet); break;
+					}
+
+					handler_job_connection_release (connection);
+				}
+
+				(void) __atomic_sub_fetch (
+					&handler->cerver->num_handlers_working, 1, __ATOMIC_RELAXED
+				);
+			}
+		}
 	}
 
+	handler_data_delete (handler_data);
+
 }
 
-// handles a request from a client to upload a file
-void cerver_request_send_file (Packet *packet) {
+// while client is running, check for new jobs and handle them
+static void handler_do_while_client (Handler *handler) {
 
-	switch (packet->cerver->type) {
-		case CERVER_TYPE_CUSTOM:
-		case CERVER_TYPE_FILES: {
-			cerver_request_send_file_actual (packet);
-		} break;
+	void *jobs[HANDLER_JOBS_BATCH] = { 0 };
+	unsigned int n_jobs = 0;
 
-		default: {
-			#ifdef HANDLER_DEBUG
-			cerver_log_warning (
+	Job *job = NULL;
+	Packet *packet = NULL;
+	HandlerData *handler_data = handler_data_new ();
+	while (handler->client->running) {
+		job_queue_wait (handler->job_queue);
+
+		if (handler->client->running) {
+			// handle every job that we can get in a single wakeup
+			n_jobs = job_queue_pull_batch (
+				handler->job_queue, jobs, HANDLER_JOBS_BATCH
+			);
+
+			if (n_jobs) {
+				handler_jobs_dispatched (handler, jobs, n_jobs);
+
+				(void) __atomic_add_fetch (
+					&handler->client->num_handlers_working, 1, __ATOMIC_RELAXED
+				);
+
+				for (unsigned int i = 0; i < n_jobs; i++) {
+					job = (Job *) jobs[i];
+
+					packet = (Packet *) job->args;
+
+					handler_data->handler_id = handler->id;
+					handler_data->data = handler->data;
+					handler_data->packet = packet;
+
+					handler->handler (handler_data);
+
+					job_delete (job);
+					packet_delete (packet);
+				}
+
+				(void) __atomic_sub_fetch (
+					&handler->client->num_handlers_working, 1, __ATOMIC_RELAXED
+				);
+			}
+		}
+	}
+
+	handler_data_delete (handler_data);
+
+}
+
+// while cerver is running, check for new jobs and handle them
+static void handler_do_while_admin (Handler *handler) {
+
+	void *jobs[HANDLER_JOBS_BATCH] = { 0 };
+	unsigned int n_jobs = 0;
+
+	Job *job = NULL;
+	Packet *packet = NULL;
+	PacketType packet_type = PACKET_TYPE_NONE;
+	HandlerData *handler_data = handler_data_new ();
+	while (handler->cerver->isRunning) {
+		job_queue_wait (handler->job_queue);
+
+		if (handler->cerver->isRunning) {
+			// handle every job that we can get in a single wakeup
+			n_jobs = job_queue_pull_batch (
+				handler->job_queue, jobs, HANDLER_JOBS_BATCH
+			);
+
+			if (n_jobs) {
+				handler_jobs_dispatched (handler, jobs, n_jobs);
+
+				(void) __atomic_add_fetch (
+					&handler->cerver->admin->num_handlers_working, 1, __ATOMIC_RELAXED
+				);
+
+				for (unsigned int i = 0; i < n_jobs; i++) {
+					job = (Job *) jobs[i];
+
+					packet = (Packet *) job->args;
+					packet_type = packet->header.packet_type;
+
+					handler_data->handler_id = handler->id;
+					handler_data->data = handler->data;
+					handler_data->packet = packet;
+
+					handler->handler (handler_data);
+
+					job_delete (job);
+
+					switch (packet_type) {
+						case PACKET_TYPE_APP: {
+							if (handler->cerver->admin->app_packet_handler_delete_packet)
+								packet_delete (packet);
+						} break;
+						case PACKET_TYPE_APP_ERROR: {
+							if (handler->cerver->admin->app_error_packet_handler_delete_packet)
+								packet_delete (packet);
+						} break;
+						case PACKET_TYPE_CUSTOM: {
+							if (handler->cerver->admin->custom_packet_handler_delete_packet)
+								packet_delete (packet);
+						} break;
+
+						default: packet_delete (packet); break;
+					}
+				}
+
+				(void) __atomic_sub_fetch (
+					&handler->cerver->admin->num_handlers_working, 1, __ATOMIC_RELAXED
+				);
+			}
+		}
+	}
+
+	handler_data_delete (handler_data);
+
+}
+
+static void *handler_do (void *handler_ptr) {
+
+	if (handler_ptr) {
+		Handler *handler = (Handler *) handler_ptr;
+
+		pthread_mutex_t *handlers_lock = NULL;
+		switch (handler->type) {
+			case HANDLER_TYPE_CERVER:
+				handlers_lock = handler->cerver->handlers_lock;
+				break;
+			case HANDLER_TYPE_CLIENT:
+				handlers_lock = handler->client->handlers_lock;
+				break;
+			case HANDLER_TYPE_ADMIN:
+				handlers_lock = handler->cerver->admin->handlers_lock;
+				break;
+			default: break;
+		}
+
+		// set the thread name
+		char thread_name[THREAD_NAME_BUFFER_SIZE] = { 0 };
+		if (handler->id >= 0) {
+			switch (handler->type) {
+				case HANDLER_TYPE_CERVER:
+					(void) snprintf (
+						thread_name, THREAD_NAME_BUFFER_SIZE,
+						"cerver-handler-%d", handler->unique_id
+					);
+					break;
+				case HANDLER_TYPE_CLIENT:
+					(void) snprintf (
+						thread_name, THREAD_NAME_BUFFER_SIZE,
+						"client-handler-%d", handler->unique_id
+					);
+					break;
+				case HANDLER_TYPE_ADMIN:
+					(void) snprintf (
+						thread_name, THREAD_NAME_BUFFER_SIZE,
+						"admin-handler-%d", handler->unique_id
+					);
+					break;
+				default: break;
+			}
+
+			// printf ("%s\n", thread_name);
+			(void) prctl (PR_SET_NAME, thread_name);
+		}
+
+		// TODO: register to signals to handle multiple actions
+
+		// pin the thread before creating its data to first touch it in its node
+		(void) thread_affinity_apply (
+			&handler->affinity, (handler->id >= 0) ? (unsigned int) handler->id : 0,
+			thread_name
+		);
+
+		if (handler->data_create)
+			handler->data = handler->data_create (handler->data_create_args);
+
+		// mark the handler as alive and ready
+		(void) pthread_mutex_lock (handlers_lock);
+		switch (handler->type) {
+			case HANDLER_TYPE_CERVER: handler->cerver->num_handlers_alive += 1; break;
+			case HANDLER_TYPE_CLIENT: handler->client->num_handlers_alive += 1; break;
+			case HANDLER_TYPE_ADMIN: handler->cerver->admin->num_handlers_alive += 1; break;
+			default: break;
+		}
+		(void) pthread_mutex_unlock (handlers_lock);
+
+		// while cerver / client is running, check for new jobs and handle them
+		switch (handler->type) {
+			case HANDLER_TYPE_CERVER: handler_do_while_cerver (handler); break;
+			case HANDLER_TYPE_CLIENT: handler_do_while_client (handler); break;
+			case HANDLER_TYPE_ADMIN: handler_do_while_admin (handler); break;
+			default: break;
+		}
+
+		if (handler->data_delete)
+			handler->data_delete (handler->data);
+
+		(void) pthread_mutex_lock (handlers_lock);
+		switch (handler->type) {
+			case HANDLER_TYPE_CERVER: handler->cerver->num_handlers_alive -= 1; break;
+			case HANDLER_TYPE_CLIENT: handler->client->num_handlers_alive -= 1; break;
+			case HANDLER_TYPE_ADMIN: handler->cerver->admin->num_handlers_alive -= 1; break;
+			default: break;
+		}
+		(void) pthread_mutex_unlock (handlers_lock);
+	}
+
+	return NULL;
+
+}
+
+// starts the new handler by creating a dedicated thread for it
+// called by internal cerver methods
+int handler_start (Handler *handler) {
+
+	int retval = 1;
+
+	if (handler) {
+		if (handler->type != HANDLER_TYPE_NONE) {
+			// cerver & admin handlers without an affinity
+			// get the next cpu of the cerver's affinity
+			if (
+				(handler->affinity.type == THREAD_AFFINITY_NONE)
+				&& (handler->type != HANDLER_TYPE_CLIENT) && handler->cerver
+			) {
+				ThreadAffinity affinity;
+				cerver_get_affinity (handler->cerver, 1, &affinity);
+				thread_affinity_resolve (&handler->affinity, &affinity, 0);
+			}
+
+			if (!thread_create_detachable (
+				&handler->thread_id,
+				(void *(*)(void *)) handler_do,
+				(void *) handler
+			)) {
+				#ifdef HANDLER_DEBUG
+				cerver_log (
+					LOG_TYPE_DEBUG, LOG_TYPE_HANDLER,
+					"Created handler %d thread!",
+					handler->unique_id
+				);
+				#endif
+
+				retval = 0;
+			}
+		}
+
+		else {
+			cerver_log_error (
+				"handler_start () - Handler %d is of invalid type!",
+				handler->unique_id
+			);
+		}
+	}
+
+	return retval;
+
+}
+
+#pragma endregion
+
+#pragma region handlers
+
+const char *cerver_handler_error_to_string (
+	const CerverHandlerError error
+) {
+
+	switch (error) {
+		#define XX(num, name, string, description) case CERVER_HANDLER_ERROR_##name: return #string;
+		CERVER_HANDLER_ERROR_MAP(XX)
+		#undef XX
+	}
+
+	return cerver_handler_error_to_string (CERVER_HANDLER_ERROR_NONE);
+
+}
+
+const char *cerver_handler_error_description (
+	const CerverHandlerError error
+) {
+
+	switch (error) {
+		#define XX(num, name, string, description) case CERVER_HANDLER_ERROR_##name: return #description;
+		CERVER_HANDLER_ERROR_MAP(XX)
+		#undef XX
+	}
+
+	return cerver_handler_error_description (CERVER_HANDLER_ERROR_NONE);
+
+}
+
+// handles a packet of type PACKET_TYPE_CLIENT
+static CerverHandlerError cerver_client_packet_handler (
+	Packet *packet
+) {
+
+	CerverHandlerError error = CERVER_HANDLER_ERROR_NONE;
+
+	// udp peers share the cerver's socket,
+	// so they are only removed by the udp loop
+	if (packet->connection->protocol == PROTOCOL_UDP) {
+		switch (packet->header.request_type) {
+			case CLIENT_PACKET_TYPE_CLOSE_CONNECTION:
+			case CLIENT_PACKET_TYPE_DISCONNECT:
+				packet->client->drop_client = true;
+				return error;
+
+			default: break;
+		}
+	}
+
+	switch (packet->header.request_type) {
+		// the client is going to close its current connection
+		// but will remain in the cerver if it has another connection active
+		// if not, it will be dropped
+		case CLIENT_PACKET_TYPE_CLOSE_CONNECTION: {
+			#ifdef HANDLER_DEBUG
+			cerver_log_debug (
+				"Client %ld requested to close the connection",
+				packet->client->id
+			);
+			#endif
+
+			// check if the client is inside a lobby
+			if (packet->lobby) {
+				#ifdef HANDLER_DEBUG
+				cerver_log (
+					LOG_TYPE_DEBUG, LOG_TYPE_GAME,
+					"Client %ld inside lobby %s wants to close the connection...",
+					packet->client->id, packet->lobby->id->str
+				);
+				#endif
+
+				// remove the player from the lobby
+				(void) player_unregister_from_lobby (
+					packet->lobby,
+					player_get_by_sock_fd_list (
+						packet->lobby, packet->connection->socket->sock_fd
+					)
+				);
+			}
+
+			switch (client_remove_connection_by_sock_fd (
+				packet->cerver,
+				packet->client, packet->connection->socket->sock_fd
+			)) {
+				case CLIENT_CONNECTIONS_STATUS_DROPPED:
+					error = CERVER_HANDLER_ERROR_DROPPED;
+					break;
+
+				default: break;
+			}
+		} break;
+
+		// the client is going to disconnect
+		// and will close all of its active connections
+		// so drop it from the server
+		case CLIENT_PACKET_TYPE_DISCONNECT: {
+			// check if the client is inside a lobby
+			if (packet->lobby) {
+				#ifdef HANDLER_DEBUG
+				cerver_log (
+					LOG_TYPE_DEBUG, LOG_TYPE_GAME,
+					"Client %ld inside lobby %s wants to close the connection...",
+					packet->client->id, packet->lobby->id->str
+				);
+				#endif
+
+				// remove the player from the lobby
+				(void) player_unregister_from_lobby (
+					packet->lobby,
+					player_get_by_sock_fd_list (
+						packet->lobby, packet->connection->socket->sock_fd
+					)
+				);
+			}
+
+			client_drop (packet->cerver, packet->client);
+
+			cerver_event_trigger (
+				CERVER_EVENT_CLIENT_DISCONNECTED,
+				packet->cerver,
+				NULL, NULL
+			);
+		} break;
+
+		default: {
+			#ifdef HANDLER_DEBUG
+			cerver_log (
+				LOG_TYPE_WARNING, LOG_TYPE_HANDLER,
+				"Got an unknown client packet in cerver %s",
+				packet->cerver->info->name
+			);
+			#endif
+		} break;
+	}
+
+	return error;
+
+}
+
+static inline void cerver_request_get_file_actual (Packet *packet) {
+
+	FileCerver *file_cerver = (FileCerver *) packet->cerver->cerver_data;
+
+	file_cerver->stats->n_files_requests += 1;
+
+	// get the necessary information to fulfil the request
+	if (packet->data_size >= sizeof (FileHeader)) {
+		char *end = (char *) packet->data;
+		FileHeader *file_header = (FileHeader *) end;
+
+		// search for the requested file in the configured paths
+		String *actual_filename = file_cerver_search_file (
+			file_cerver, file_header->filename
+		);
+
+		if (actual_filename) {
+			#ifdef HANDLER_DEBUG
+			cerver_log_debug (
+				"cerver_request_get_file () - Sending %s...\n",
+				actual_filename->str
+			);
+			#endif
+
+			// if found, pipe the file contents to the client's socket fd
+			// the socket should be blocked during the entire operation
+			ssize_t sent = file_cerver_send_file (
+				packet->cerver, packet->client, packet->connection,
+				actual_filename->str
+			);
+
+			if (sent > 0) {
+				file_cerver->stats->n_success_files_requests += 1;
+				file_cerver->stats->n_files_sent += 1;
+				file_cerver->stats->n_bytes_sent += sent;
+
+				#ifdef HANDLER_DEBUG
+				cerver_log_success (
+					"Sent file %s", actual_filename->str
+				);
+				#endif
+			}
+
+			else {
+				cerver_log_error (
+					"Failed to send file %s", actual_filename->str
+				);
+
+				file_cerver->stats->n_bad_files_sent += 1;
+			}
+
+			str_delete (actual_filename);
+		}
+
+		else {
+			#ifdef HANDLER_DEBUG
+			cerver_log_warning ("cerver_request_get_file () - file not found");
+			#endif
+
+			// if not found, return an error to the client
+			(void) error_packet_generate_and_send (
+				CERVER_ERROR_FILE_NOT_FOUND, "File not found",
+				packet->cerver, packet->client, packet->connection
+			);
+
+			file_cerver->stats->n_bad_files_requests += 1;
+		}
+
+	}
+
+	else {
+		#ifdef HANDLER_DEBUG
+		cerver_log_warning ("cerver_request_get_file () - missing file header");
+		#endif
+
+		// return a bad request error packet
+		(void) error_packet_generate_and_send (
+			CERVER_ERROR_GET_FILE, "Missing file header",
+			packet->cerver, packet->client, packet->connection
+		);
+
+		file_cerver->stats->n_bad_files_requests += 1;
+	}
+
+}
+
+// handles a request from a client to get a file
+void cerver_request_get_file (Packet *packet) {
+
+	switch (packet->cerver->type) {
+		case CERVER_TYPE_CUSTOM:
+		case CERVER_TYPE_FILES: {
+			cerver_request_get_file_actual (packet);
+		} break;
+
+		default: {
+			#ifdef HANDLER_DEBUG
+			cerver_log_warning (
+				"Cerver %s is not able to handle REQUEST_PACKET_TYPE_GET_FILE requests",
+				packet->cerver->info->name
+			);
+			#endif
+
+			(void) error_packet_generate_and_send (
+				CERVER_ERROR_GET_FILE, "Unable to process request",
+				packet->cerver, packet->client, packet->connection
+			);
+		} break;
+	}
+
+}
+
+static inline void cerver_request_send_file_actual (Packet *packet) {
+
+	FileCerver *file_cerver = (FileCerver *) packet->cerver->cerver_data;
+
+	file_cerver->stats->n_files_upload_requests += 1;
+
+	// get the necessary information to fulfil the request
+	if (packet->data_size >= sizeof (FileHeader)) {
+		char *end = (char *) packet->data;
+		FileHeader *file_header = (FileHeader *) end;
+
+		const char *file_data = NULL;
+		size_t file_data_len = 0;
+		// printf (
+		// 	"\n\npacket->data_size %ld > sizeof (FileHeader) %ld\n\n",
+		// 	packet->data_size, sizeof (FileHeader)
+		// );
+		if (packet->data_size > sizeof (FileHeader)) {
+			file_data = end += sizeof (FileHeader);
+			file_data_len = packet->data_size - sizeof (FileHeader);
+		}
+
+		char *saved_filename = NULL;
+		if (!file_cerver->file_upload_handler (
+			packet->cerver, packet->client, packet->connection,
+			file_header,
+			file_data, file_data_len,
+			&saved_filename
+		)) {
+			file_cerver->stats->n_success_files_uploaded += 1;
+
+			file_cerver->stats->n_bytes_received += file_header->len;
+
+			if (file_cerver->file_upload_cb) {
+				file_cerver->file_upload_cb (
+					packet->cerver, packet->client, packet->connection,
+					saved_filename
+				);
+			}
+			
+			if (saved_filename) free (saved_filename);
+		}
+
+		else {
+			cerver_log_error ("Failed to receive file");
+
+			file_cerver->stats->n_bad_files_received += 1;
+		}
+	}
+
+	else {
+		// return a bad request error packet
+		(void) error_packet_generate_and_send (
+			CERVER_ERROR_SEND_FILE, "Missing file header",
+			packet->cerver, packet->client, packet->connection
+		);
+
+		file_cerver->stats->n_bad_files_upload_requests += 1;
+	}
+
+}
+
+// handles a request from a client to upload a file
+void cerver_request_send_file (Packet *packet) {
+
+	switch (packet->cerver->type) {
+		case CERVER_TYPE_CUSTOM:
+		case CERVER_TYPE_FILES: {
+			cerver_request_send_file_actual (packet);
+		} break;
+
+		default: {
+			#ifdef HANDLER_DEBUG
+			cerver_log_warning (
 				"Cerver %s is not able to handle REQUEST_PACKET_TYPE_SEND_FILE requests",
 				packet->cerver->info->name
 			);
 			#endif
 
-			(void) error_packet_generate_and_send (
-				CERVER_ERROR_GET_FILE, "Unable to process request",
-				packet->cerver, packet->client, packet->connection
-			);
-		} break;
-	}	
+			(void) error_packet_generate_and_send (
+				CERVER_ERROR_GET_FILE, "Unable to process request",
+				packet->cerver, packet->client, packet->connection
+			);
+		} break;
+	}	
+
+}
+
+// handles a request made from the client
+static void cerver_request_packet_handler (Packet *packet) {
+
+	switch (packet->header.request_type) {
+		// request from a client to get a file
+		case REQUEST_PACKET_TYPE_GET_FILE:
+			cerver_request_get_file (packet);
+			break;
+
+		// request from a client to upload a file
+		case REQUEST_PACKET_TYPE_SEND_FILE:
+			cerver_request_send_file (packet);
+			break;
+
+		default: {
+			#ifdef HANDLER_DEBUG
+			cerver_log (
+				LOG_TYPE_WARNING, LOG_TYPE_HANDLER,
+				"Got an unknown request packet in cerver %s",
+				packet->cerver->info->name
+			);
+			#endif
+		} break;
+	}
+
+}
+
+// sends back a test packet to the client!
+void cerver_test_packet_handler (Packet *packet) {
+
+	#ifdef HANDLER_DEBUG
+	cerver_log (
+		LOG_TYPE_DEBUG, LOG_TYPE_PACKET,
+		"Got a test packet in cerver %s.",
+		packet->cerver->info->name
+	);
+	#endif
+
+	Packet request = {
+		.cerver = packet->cerver,
+		.client = packet->client,
+		.connection = packet->connection,
+		.lobby = packet->lobby,
+
+		.packet_size = sizeof (PacketHeader),
+		.packet = (void *) &packet->header,
+		.packet_ref = true
+	};
+
+	(void) packet_send (&request, 0, NULL, false);
+
+}
+
+// the poll, epoll & reactors loops can stop reading
+// from a single tcp connection when a handler's queue is full
+static inline bool cerver_handler_pauses_connections (
+	const Cerver *cerver, const Connection *connection
+) {
+
+	return (connection->protocol == PROTOCOL_TCP)
+		&& (
+			(cerver->handler_type == CERVER_HANDLER_TYPE_POLL)
+			|| (cerver->handler_type == CERVER_HANDLER_TYPE_EPOLL)
+			|| (cerver->handler_type == CERVER_HANDLER_TYPE_REACTORS)
+		);
+
+}
+
+// pushes every job that was collected for the same handler at once
+// jobs that the handler's queue doesn't take are discarded
+static void cerver_receive_handle_jobs_flush (
+	ReceiveHandle *receive_handle
+) {
+
+	if (receive_handle->n_jobs) {
+		Handler *handler = receive_handle->jobs_handler;
+
+		// loops that handle many connections only pause this one
+		unsigned int dropped = cerver_handler_pauses_connections (
+			receive_handle->cerver, receive_handle->connection
+		) ? handler_push_connection_jobs (
+			handler, receive_handle->connection,
+			receive_handle->jobs, receive_handle->n_jobs
+		) : handler_push_jobs (
+			handler, receive_handle->jobs, receive_handle->n_jobs
+		);
+
+		// jobs discarded by the overflow policy are only counted in the stats
+		if (dropped && !handler->max_queue_depth) {
+			cerver_log_error (
+				"Failed to push %u jobs to cerver's %s handler <%d>!",
+				dropped, receive_handle->cerver->info->name, handler->unique_id
+			);
+		}
+
+		receive_handle->jobs_handler = NULL;
+		receive_handle->n_jobs = 0;
+	}
+
+}
+
+// collects the packet's job to be pushed with the next ones
+// that are handled from the same buffer for the same handler
+// returns 0 on success, 1 on error
+static u8 cerver_receive_handle_job (
+	ReceiveHandle *receive_handle, Handler *handler, Packet *packet
+) {
+
+	u8 retval = 1;
+
+	if (
+		(receive_handle->jobs_handler != handler)
+		|| (receive_handle->n_jobs == RECEIVE_HANDLE_JOBS_BATCH)
+	) {
+		cerver_receive_handle_jobs_flush (receive_handle);
+	}
+
+	Job *job = job_create (NULL, packet);
+	if (job) {
+		handler_job_connection_hold (packet->connection);
+
+		receive_handle->jobs_handler = handler;
+		receive_handle->jobs[receive_handle->n_jobs] = job;
+		receive_handle->n_jobs += 1;
+
+		retval = 0;
+	}
+
+	return retval;
+
+}
+
+// mixes the key bits so consecutive values
+// are spread between every handler
+static inline unsigned int cerver_handler_dispatch_hash (
+	u64 key, const unsigned int n_handlers
+) {
+
+	key ^= key >> 33;
+	key *= 0xff51afd7ed558ccdULL;
+	key ^= key >> 33;
+
+	return (unsigned int) (key % n_handlers);
+
+}
+
+// selects the handler that will handle the packet
+// based on the cerver's handler dispatch policy
+// returns NULL if there is no handler for the packet
+static Handler *cerver_app_packet_handler_select (Packet *packet) {
+
+	Cerver *cerver = packet->cerver;
+
+	unsigned int idx = 0;
+	switch (cerver->handler_dispatch) {
+		case CERVER_HANDLER_DISPATCH_ID:
+			return (packet->header.handler_id < cerver->n_handlers) ?
+				cerver->handlers[packet->header.handler_id] : NULL;
+
+		case CERVER_HANDLER_DISPATCH_CONNECTION:
+			idx = cerver_handler_dispatch_hash (
+				(u64) (uintptr_t) packet->connection, cerver->n_handlers
+			);
+			break;
+
+		case CERVER_HANDLER_DISPATCH_CLIENT:
+			idx = cerver_handler_dispatch_hash (
+				packet->client ? packet->client->id : (u64) (uintptr_t) packet->connection,
+				cerver->n_handlers
+			);
+			break;
+
+		default: return NULL;
+	}
+
+	// skip unregistered handlers, the same key
+	// always ends in the same handler to keep its packets in order
+	for (unsigned int i = 0; i < cerver->n_handlers; i++) {
+		if (cerver->handlers[idx]) return cerver->handlers[idx];
+		idx = (idx + 1) % cerver->n_handlers;
+	}
+
+	return NULL;
+
+}
+
+// handles an PACKET_TYPE_APP packet type
+static void cerver_app_packet_handler (
+	ReceiveHandle *receive_handle, Packet *packet
+) {
+
+	if (packet->cerver->multiple_handlers) {
+		// select which handler to use
+		Handler *handler = cerver_app_packet_handler_select (packet);
+		if (handler) {
+			// add the packet to the handler's job queueu to be handled
+			// as soon as the handler is available
+			// the packet must own its data as the receive buffer will be reused
+			if (packet_retain (packet) || cerver_receive_handle_job (
+				receive_handle, handler, packet
+			)) {
+				cerver_log_error (
+					"Failed to push a new job to cerver's %s <%d> handler!",
+					packet->cerver->info->name, handler->id
+				);
+			}
+		}
+	}
+
+	else {
+		if (packet->cerver->app_packet_handler) {
+			if (packet->cerver->app_packet_handler->direct_handle) {
+				// printf ("app_packet_handler - direct handle!\n");
+				packet->cerver->app_packet_handler->handler (packet);
+				if (packet->cerver->app_packet_handler_delete_packet)
+					packet_delete (packet);
+			}
+
+			else {
+				// add the packet to the handler's job queueu to be handled
+				// as soon as the handler is available
+				// the packet must own its data as the receive buffer will be reused
+				if (packet_retain (packet) || cerver_receive_handle_job (
+					receive_handle, packet->cerver->app_packet_handler, packet
+				)) {
+					cerver_log_error (
+						"Failed to push a new job to cerver's %s app_packet_handler!",
+						packet->cerver->info->name
+					);
+				}
+			}
+		}
+
+		else {
+			cerver_log_warning (
+				"Cerver %s does not have an app_packet_handler!",
+				packet->cerver->info->name
+			);
+		}
+	}
+
+}
+
+// handles an PACKET_TYPE_APP_ERROR packet type
+static void cerver_app_error_packet_handler (
+	ReceiveHandle *receive_handle, Packet *packet
+) {
+
+	if (packet->cerver->app_error_packet_handler) {
+		if (packet->cerver->app_error_packet_handler->direct_handle) {
+			// printf ("app_error_packet_handler - direct handle!\n");
+			packet->cerver->app_error_packet_handler->handler (packet);
+			if (packet->cerver->app_error_packet_handler_delete_packet)
+				packet_delete (packet);
+		}
+
+		else {
+			// add the packet to the handler's job queueu to be handled
+			// as soon as the handler is available
+			// the packet must own its data as the receive buffer will be reused
+			if (packet_retain (packet) || cerver_receive_handle_job (
+				receive_handle, packet->cerver->app_error_packet_handler, packet
+			)) {
+				cerver_log_error (
+					"Failed to push a new job to cerver's %s app_error_packet_handler!",
+					packet->cerver->info->name
+				);
+			}
+		}
+	}
+
+	else {
+		cerver_log_warning (
+			"Cerver %s does not have an app_error_packet_handler!",
+			packet->cerver->info->name
+		);
+	}
+
+}
+
+// handles a PACKET_TYPE_CUSTOM packet type
+static void cerver_custom_packet_handler (
+	ReceiveHandle *receive_handle, Packet *packet
+) {
+
+	if (packet->cerver->custom_packet_handler) {
+		if (packet->cerver->custom_packet_handler->direct_handle) {
+			// printf ("custom_packet_handler - direct handle!\n");
+			packet->cerver->custom_packet_handler->handler (packet);
+			if (packet->cerver->custom_packet_handler_delete_packet)
+				packet_delete (packet);
+		}
+
+		else {
+			// add the packet to the handler's job queueu to be handled
+			// as soon as the handler is available
+			// the packet must own its data as the receive buffer will be reused
+			if (packet_retain (packet) || cerver_receive_handle_job (
+				receive_handle, packet->cerver->custom_packet_handler, packet
+			)) {
+				cerver_log_error (
+					"Failed to push a new job to cerver's %s custom_packet_handler!",
+					packet->cerver->info->name
+				);
+			}
+		}
+	}
+
+	else {
+		cerver_log_warning (
+			"Cerver %s does not have a custom_packet_handler!",
+			packet->cerver->info->name
+		);
+	}
+
+}
+
+static CerverHandlerError cerver_packet_handler_check_version (
+	Packet *packet
+) {
+
+	CerverHandlerError error = CERVER_HANDLER_ERROR_NONE;
+
+	// we expect the packet version in the packet's data
+	if (packet->data) {
+		(void) memcpy (&packet->version, packet->data_ptr, sizeof (PacketVersion));
+		packet->data_ptr += sizeof (PacketVersion);
+		
+		// TODO: return errors to client
+		// TODO: drop client on max bad packets
+		if (packet_check (packet)) {
+			error = CERVER_HANDLER_ERROR_PACKET;
+		}
+	}
+
+	else {
+		cerver_log_error (
+			"cerver_packet_handler () - No packet version to check!"
+		);
+		
+		// TODO: add to bad packets count
+
+		error = CERVER_HANDLER_ERROR_PACKET;
+	}
+
+	return error;
+
+}
+
+static void cerver_packet_handler_update_stats (const Packet *packet) {
+
+	const PacketType packet_type = packet->header.packet_type;
+	const u32 request_type = packet->header.request_type;
+
+	switch (packet_type) {
+		case PACKET_TYPE_NONE:
+		case PACKET_TYPE_CERVER:
+			break;
+
+		case PACKET_TYPE_CLIENT:
+		case PACKET_TYPE_ERROR:
+		case PACKET_TYPE_REQUEST:
+		case PACKET_TYPE_AUTH:
+		case PACKET_TYPE_GAME:
+		case PACKET_TYPE_APP:
+		case PACKET_TYPE_APP_ERROR:
+		case PACKET_TYPE_CUSTOM:
+		case PACKET_TYPE_TEST:
+			packets_per_type_count (
+				&cerver_stats_shard (packet->cerver)->received_packets,
+				packet_type, request_type
+			);
+			#ifdef CLIENT_STATS
+			packets_per_type_count (packet->client->stats->received_packets, packet_type, request_type);
+			#endif
+			#ifdef CONNECTION_STATS
+			packets_per_type_count (packet->connection->stats->received_packets, packet_type, request_type);
+			#endif
+			if (packet->lobby) packets_per_type_count (packet->lobby->stats->received_packets, packet_type, request_type);
+			break;
+
+		default:
+			packets_per_type_count_bad (
+				&cerver_stats_shard (packet->cerver)->received_packets
+			);
+			#ifdef CLIENT_STATS
+			packets_per_type_count_bad (packet->client->stats->received_packets);
+			#endif
+			#ifdef CONNECTION_STATS
+			packets_per_type_count_bad (packet->connection->stats->received_packets);
+			#endif
+			if (packet->lobby) packets_per_type_count_bad (packet->lobby->stats->received_packets);
+			break;
+	}
+
+}
+
+static CerverHandlerError cerver_packet_handler_actual (
+	ReceiveHandle *receive_handle, Packet *packet
+) {
+
+	CerverHandlerError error = CERVER_HANDLER_ERROR_NONE;
+
+	// packets that are handled right away must not
+	// get ahead of the ones that are waiting to be pushed
+	switch (packet->header.packet_type) {
+		case PACKET_TYPE_APP:
+		case PACKET_TYPE_APP_ERROR:
+		case PACKET_TYPE_CUSTOM:
+			break;
+
+		default:
+			cerver_receive_handle_jobs_flush (receive_handle);
+			break;
+	}
+
+	cerver_packet_handler_update_stats (packet);
+
+	switch (packet->header.packet_type) {
+		case PACKET_TYPE_NONE: break;
+
+		case PACKET_TYPE_CERVER: break;
+
+		case PACKET_TYPE_CLIENT: {
+			error = cerver_client_packet_handler (packet);
+			packet_delete (packet);
+		} break;
+
+		// handles an error from the client
+		case PACKET_TYPE_ERROR: {
+			cerver_error_packet_handler (packet);
+			packet_delete (packet);
+		} break;
+
+		// handles a request made from the client
+		case PACKET_TYPE_REQUEST: {
+			cerver_request_packet_handler (packet);
+			packet_delete (packet);
+		} break;
+
+		// handles authentication packets
+		case PACKET_TYPE_AUTH: {
+			/* TODO: */
+			packet_delete (packet);
+		} break;
+
+		// handles a game packet sent from the client
+		case PACKET_TYPE_GAME: {
+			game_packet_handler (packet);
+		} break;
+
+		// user set handler to handle app specific packets
+		case PACKET_TYPE_APP: {
+			cerver_app_packet_handler (receive_handle, packet);
+		} break;
+
+		// user set handler to handle app specific errors
+		case PACKET_TYPE_APP_ERROR: {
+			cerver_app_error_packet_handler (receive_handle, packet);
+		} break;
+
+		// custom packet hanlder
+		case PACKET_TYPE_CUSTOM: {
+			cerver_custom_packet_handler (receive_handle, packet);
+		} break;
+
+		// acknowledge the client we have received his test packet
+		case PACKET_TYPE_TEST: {
+			cerver_test_packet_handler (packet);
+			packet_delete (packet);
+		} break;
+
+		default: {
+			#ifdef HANDLER_DEBUG
+			cerver_log (
+				LOG_TYPE_WARNING, LOG_TYPE_PACKET,
+				"Got a packet of unknown type in cerver %s.",
+				packet->cerver->info->name
+			);
+			#endif
+
+			packet_delete (packet);
+		} break;
+	}
+
+	return error;
+
+}
+
+// handle packet based on type
+static u8 cerver_packet_handler (
+	ReceiveHandle *receive_handle, Packet *packet
+) {
+
+	u8 retval = 1;
+
+	CerverHandlerError error = CERVER_HANDLER_ERROR_NONE;
+	if (packet->cerver->check_packets) {
+		if (!cerver_packet_handler_check_version (packet)) {
+			error = cerver_packet_handler_actual (receive_handle, packet);
+		}
+	}
+
+	else {
+		error = cerver_packet_handler_actual (receive_handle, packet);
+	}
+
+	switch (error) {
+		case CERVER_HANDLER_ERROR_NONE:
+			retval = 0;
+			break;
+
+		default: break;
+	}
+
+	return retval;
+
+}
+
+static u8 cerver_packet_select_handler (
+	ReceiveHandle *receive_handle, Packet *packet
+) {
+
+	u8 retval = 1;
+
+	receive_handle->n_packets += 1;
+
+	switch (receive_handle->type) {
+		case RECEIVE_TYPE_NONE: break;
+
+		case RECEIVE_TYPE_NORMAL: {
+			packet->cerver = receive_handle->cerver;
+			packet->client = receive_handle->client;
+			packet->connection = receive_handle->connection;
+
+			CerverStatsShard *shard = cerver_stats_shard (packet->cerver);
+			STATS_ADD (shard->client_n_packets_received, 1);
+			STATS_ADD (shard->total_n_packets_received, 1);
+
+			#ifdef CLIENT_STATS
+			STATS_ADD (packet->client->stats->n_packets_received, 1);
+			#endif
+			#ifdef CONNECTION_STATS
+			STATS_ADD (packet->connection->stats->n_packets_received, 1);
+			#endif
+
+			if (packet->lobby) STATS_ADD (packet->lobby->stats->n_packets_received, 1);
+
+			retval = cerver_packet_handler (receive_handle, packet);
+		} break;
+
+		case RECEIVE_TYPE_ON_HOLD: {
+			packet->cerver = receive_handle->cerver;
+			packet->connection = receive_handle->connection;
+
+			STATS_ADD (cerver_stats_shard (packet->cerver)->on_hold_n_packets_received, 1);
+			STATS_ADD (packet->connection->stats->n_packets_received, 1);
+
+			retval = on_hold_packet_handler (packet);
+		} break;
+
+		case RECEIVE_TYPE_ADMIN: {
+			packet->cerver = receive_handle->cerver;
+			packet->connection = receive_handle->connection;
+			packet->client = receive_handle->admin->client;
+
+			STATS_ADD (packet->cerver->admin->stats->total_n_packets_received, 1);
+
+			STATS_ADD (receive_handle->admin->client->stats->n_packets_received, 1);
+
+			STATS_ADD (packet->connection->stats->n_packets_received, 1);
+
+			retval = admin_packet_handler (packet);
+		} break;
+
+		default: break;
+	}
+
+	return retval;
+
+}
+
+#pragma endregion
+
+#pragma region receive
+
+u8 cerver_poll_unregister_sock_fd (Cerver *cerver, const i32 sock_fd);
+
+CerverReceive *cerver_receive_new (void) {
+
+	CerverReceive *cr = (CerverReceive *) malloc (sizeof (CerverReceive));
+	if (cr) {
+		cerver_receive_reset (cr);
+	}
+
+	return cr;
+
+}
+
+void cerver_receive_delete (void *ptr) { if (ptr) free (ptr); }
+
+// clears the receive's values so it can be used again
+void cerver_receive_reset (CerverReceive *cr) {
+
+	cr->type = RECEIVE_TYPE_NONE;
+
+	cr->cerver = NULL;
+
+	cr->socket = NULL;
+	cr->connection = NULL;
+	cr->client = NULL;
+	cr->admin = NULL;
+
+	cr->lobby = NULL;
+
+	cr->generation = FD_TABLE_INVALID_GENERATION;
+
+}
+
+static inline void cerver_receive_create_normal (
+	CerverReceive *cr,
+	Cerver *cerver, const i32 sock_fd
+) {
+
+	FdTableEntry entry = { 0 };
+	if (!fd_table_get (cerver->fd_table, sock_fd, &entry) && entry.client) {
+		cr->client = entry.client;
+		cr->connection = entry.connection;
+		cr->socket = cr->connection->socket;
+		cr->generation = entry.generation;
+	}
+
+	// for what ever reason we have a rogue connection
+	else {
+		// #ifdef CERVER_DEBUG
+		cerver_log_error (
+			"cerver_receive_create () - RECEIVE_TYPE_NORMAL - no client with sock fd <%d>",
+			sock_fd
+		);
+		// #endif
+
+		// remove the sock fd from the cerver's main poll array
+		cerver_poll_unregister_sock_fd (cerver, sock_fd);
+
+		close (sock_fd);        // just close the socket
+	}
+
+}
+
+static inline void cerver_receive_create_on_hold (
+	CerverReceive *cr,
+	Cerver *cerver, const i32 sock_fd
+) {
+
+	FdTableEntry entry = { 0 };
+	if (!fd_table_get (cerver->fd_table, sock_fd, &entry) && !entry.client) {
+		cr->connection = entry.connection;
+		cr->socket = cr->connection->socket;
+		cr->generation = entry.generation;
+	}
+
+	// for what ever reason we have a rogue connection
+	else {
+		// #ifdef CERVER_DEBUG
+		cerver_log_error (
+			"cerver_receive_create () - RECEIVE_TYPE_ON_HOLD - no connection with sock fd <%d>",
+			sock_fd
+		);
+		// #endif
+
+		// remove the sock fd from the cerver's on hold poll array
+		on_hold_poll_unregister_sock_fd (cerver, sock_fd);
+
+		close (sock_fd);        // just close the socket
+	}
+
+}
+
+static inline void cerver_receive_create_admin (
+	CerverReceive *cr,
+	Cerver *cerver, const i32 sock_fd
+) {
+
+	FdTableEntry entry = { 0 };
+	if (!fd_table_get (cerver->fd_table, sock_fd, &entry)) {
+		cr->admin = admin_get_by_client (cerver->admin, entry.client);
+	}
+
+	if (cr->admin) {
+		cr->client = cr->admin->client;
+		cr->connection = entry.connection;
+		cr->socket = cr->connection->socket;
+		cr->generation = entry.generation;
+	}
+
+	// for what ever reason we have a rogue connection
+	else {
+		// #ifdef ADMIN_DEBUG
+		cerver_log_error (
+			"cerver_receive_create () - RECEIVE_TYPE_ADMIN - no admin with sock fd <%d>",
+			sock_fd
+		);
+		// #endif
+
+		// remove the sock fd from the cerver's admin poll array
+		admin_cerver_poll_unregister_sock_fd (cerver->admin, sock_fd);
+
+		close (sock_fd);        // just close the socket
+	}
+
+}
+
+// sets the receive's values by searching the sock fd's connection
+// used to reuse the same receive for every event in a loop
+// without allocating a new one each time
+void cerver_receive_init (
+	CerverReceive *cr,
+	ReceiveType receive_type,
+	Cerver *cerver, const i32 sock_fd
+) {
+
+	cerver_receive_reset (cr);
+
+	cr->type = receive_type;
+
+	cr->cerver = cerver;
+
+	switch (cr->type) {
+		case RECEIVE_TYPE_NONE: break;
+
+		case RECEIVE_TYPE_NORMAL:
+			cerver_receive_create_normal (cr, cerver, sock_fd);
+			break;
+
+		case RECEIVE_TYPE_ON_HOLD:
+			cerver_receive_create_on_hold (cr, cerver, sock_fd);
+			break;
+
+		case RECEIVE_TYPE_ADMIN:
+			cerver_receive_create_admin (cr, cerver, sock_fd);
+			break;
+
+		default: break;
+	}
+
+}
+
+// sets the receive's values using the matching connection
+void cerver_receive_init_full (
+	CerverReceive *cr,
+	ReceiveType receive_type,
+	Cerver *cerver,
+	Client *client, Connection *connection
+) {
+
+	cerver_receive_reset (cr);
+
+	cr->type = receive_type;
+
+	cr->cerver = cerver;
+
+	cr->socket = connection ? connection->socket : NULL;
+	cr->connection = connection;
+	cr->client = client;
+
+	// only if the sock fd still belongs to the connection
+	FdTableEntry entry = { 0 };
+	if (
+		cerver && connection
+		&& !fd_table_get (cerver->fd_table, connection->socket->sock_fd, &entry)
+		&& (entry.connection == connection)
+	) {
+		cr->generation = entry.generation;
+	}
+
+}
+
+// keep track of every receive that needs to be allocated
+// the cerver's loops reuse their own receive instead
+static inline void cerver_receive_count_allocation (Cerver *cerver) {
+
+	if (cerver) {
+		if (cerver->stats) STATS_ADD (cerver_stats_shard (cerver)->receive_contexts_allocated, 1);
+	}
+
+}
+
+CerverReceive *cerver_receive_create (
+	ReceiveType receive_type,
+	Cerver *cerver, const i32 sock_fd
+) {
+
+	CerverReceive *cr = cerver_receive_new ();
+	if (cr) {
+		cerver_receive_count_allocation (cerver);
+
+		cerver_receive_init (cr, receive_type, cerver, sock_fd);
+	}
+
+	return cr;
+
+}
+
+CerverReceive *cerver_receive_create_full (
+	ReceiveType receive_type,
+	Cerver *cerver,
+	Client *client, Connection *connection
+) {
+
+	CerverReceive *cr = cerver_receive_new ();
+	if (cr) {
+		cerver_receive_count_allocation (cerver);
+
+		cerver_receive_init_full (cr, receive_type, cerver, client, connection);
+	}
+
+	return cr;
+
+}
+
+// creates a packet whose data references the receive buffer
+// used to handle complete packets without copying their data
+static inline Packet *cerver_receive_handle_buffer_packet_ref (
+	char *data, const size_t data_size
+) {
+
+	Packet *packet = packet_new ();
+	if (packet) {
+		packet->data = data;
+		packet->data_size = data_size;
+		packet->data_ptr = data;
+		packet->data_end = data + data_size;
+		packet->data_ref = true;
+	}
+
+	return packet;
+
+}
+
+static void cerver_receive_handle_buffer_actual (
+	ReceiveHandle *receive_handle,
+	char *end, size_t buffer_pos,
+	size_t remaining_buffer_size
+) {
+
+	PacketHeader *header = NULL;
+	size_t packet_size = 0;
+	size_t data_size = 0;
+
+	Packet *packet = NULL;
+
+	u8 stop_handler = 0;
+
+	#ifdef RECEIVE_DEBUG
+	(void) printf ("WHILE has started!\n\n");
+	#endif
+
+	do {
+		#ifdef RECEIVE_DEBUG
+		(void) printf ("[0] remaining_buffer_size: %lu\n", remaining_buffer_size);
+		(void) printf ("[0] buffer pos: %lu\n", buffer_pos);
+		#endif
+
+		switch (receive_handle->state) {
+			// check if we have a complete packet header in the buffer
+			case RECEIVE_HANDLE_STATE_NORMAL: {
+				if (remaining_buffer_size >= sizeof (PacketHeader)) {
+					#ifdef RECEIVE_DEBUG
+					(void) printf (
+						"Complete header in current buffer\n"
+					);
+					#endif
+
+					header = (PacketHeader *) end;
+					end += sizeof (PacketHeader);
+					buffer_pos += sizeof (PacketHeader);
+
+					#ifdef RECEIVE_DEBUG
+					packet_header_print (header);
+					(void) printf ("[1] buffer pos: %lu\n", buffer_pos);
+					#endif
+
+					packet_size = header->packet_size;
+					remaining_buffer_size -= sizeof (PacketHeader);
+				}
+
+				// we need to handle just a part of the header
+				else {
+					#ifdef RECEIVE_DEBUG
+					(void) printf (
+						"Only %lu of %lu header bytes left in buffer\n",
+						remaining_buffer_size, sizeof (PacketHeader)
+					);
+					#endif
+
+					// reset previous header
+					(void) memset (&receive_handle->header, 0, sizeof (PacketHeader));
+
+					// the remaining buffer must contain a part of the header
+					// so copy it to our aux structure
+					receive_handle->header_end = (char *) &receive_handle->header;
+					(void) memcpy (
+						receive_handle->header_end, (void *) end, remaining_buffer_size
+					);
+
+					// for (size_t i = 0; i < sizeof (PacketHeader); i++)
+					// 	printf ("%4x", (unsigned int) receive_handle->header_end[i]);
+
+					// printf ("\n");
+
+					// for (size_t i = 0; i < sizeof (PacketHeader); i++) {
+					// 	printf ("%4x", (unsigned int) *end);
+					// 	end += 1;
+					// }
+
+					// printf ("\n");
+
+					// packet_header_print (&receive_handle->header);
+
+					// pointer to the last byte of the new header
+					receive_handle->header_end += remaining_buffer_size;
+
+					// keep track of how much header's data we are missing
+					receive_handle->remaining_header =
+						sizeof (PacketHeader) - remaining_buffer_size;
+
+					buffer_pos += remaining_buffer_size;
+
+					#ifdef RECEIVE_DEBUG
+					(void) printf ("[1] buffer pos: %lu\n", buffer_pos);
+					#endif
+
+					receive_handle->state = RECEIVE_HANDLE_STATE_SPLIT_HEADER;
+
+					#ifdef RECEIVE_DEBUG
+					(void) printf ("while loop should end now!\n");
+					#endif
+				}
+			} break;
+
+			// we already have a complete header from the spare packet
+			// we just need to check if it is correct
+			case RECEIVE_HANDLE_STATE_COMP_HEADER: {
+				header = &receive_handle->header;
+				packet_size = header->packet_size;
+				// remaining_buffer_size -= buffer_pos;
+
+				receive_handle->state = RECEIVE_HANDLE_STATE_NORMAL;
+			} break;
+
+			default: break;
+		}
+
+		#ifdef RECEIVE_DEBUG
+		(void) printf (
+			"State BEFORE CHECKING for packet size: %s\n",
+			receive_handle_state_to_string (receive_handle->state)
+		);
+		#endif
+
+		if (
+			(receive_handle->state == RECEIVE_HANDLE_STATE_NORMAL)
+			|| (receive_handle->state == RECEIVE_HANDLE_STATE_LOST)
+		) {
+			// check that we have a valid packet size
+			if (
+				(packet_size > 0)
+				&& (packet_size <= receive_handle->cerver->max_received_packet_size)
+			) {
+				data_size = header->packet_size - sizeof (PacketHeader);
+
+				// we can safely process the complete packet
+				// by referencing its data in the receive buffer
+				if (
+					receive_handle->cerver->zero_copy_packets
+					&& (receive_handle->type == RECEIVE_TYPE_NORMAL)
+					&& (data_size > 0)
+					&& (data_size <= remaining_buffer_size)
+				) {
+					packet = cerver_receive_handle_buffer_packet_ref (
+						end, data_size
+					);
+				}
+
+				else {
+					packet = packet_create_with_data (data_size);
+				}
+
+				// the rest of the buffer can't be handled without a packet
+				if (!packet) {
+					cerver_log_error (
+						"cerver_receive_handle_buffer () - failed to create packet of size %lu",
+						packet_size
+					);
+
+					receive_handle->state = RECEIVE_HANDLE_STATE_LOST;
+
+					break;
+				}
+
+				// set packet's values
+				(void) memcpy (&packet->header, header, sizeof (PacketHeader));
+				packet->cerver = receive_handle->cerver;
+				packet->client = receive_handle->client;
+				packet->connection = receive_handle->connection;
+				packet->lobby = receive_handle->lobby;
+
+				packet->packet_size = packet->header.packet_size;
+
+				if (packet->data_size == 0) {
+					#ifdef RECEIVE_DEBUG
+					(void) printf (
+						"Packet has no more data\n"
+					);
+					#endif
+
+					// we can safely handle the packet
+					stop_handler = cerver_packet_select_handler (
+						receive_handle, packet
+					);
+
+					#ifdef RECEIVE_DEBUG
+					(void) printf ("[2] buffer pos: %lu\n", buffer_pos);
+					#endif
+				}
+
+				// check how much of the packet's data is in the current buffer
+				else if (packet->data_size <= remaining_buffer_size) {
+					#ifdef RECEIVE_DEBUG
+					(void) printf (
+						"Complete packet in current buffer\n"
+					);
+					#endif
+
+					// the full packet's data is in the current buffer
+					// so we can safely copy the complete packet
+					if (!packet->data_ref) {
+						(void) memcpy (packet->data, end, packet->data_size);
+					}
+
+					// we can safely handle the packet
+					stop_handler = cerver_packet_select_handler (
+						receive_handle, packet
+					);
+
+					// update buffer positions & values
+					end += packet->data_size;
+					buffer_pos += packet->data_size;
+					remaining_buffer_size -= packet->data_size;
+
+					#ifdef RECEIVE_DEBUG
+					(void) printf ("[2] buffer pos: %lu\n", buffer_pos);
+					#endif
+				}
+
+				else {
+					// just some part of the packet's data is in the current buffer
+					// we should copy all the remaining buffer and wait for the next read
+					#ifdef RECEIVE_DEBUG
+					(void) printf ("RECEIVE_HANDLE_STATE_SPLIT_PACKET\n");
+					#endif
+					
+					if (remaining_buffer_size > 0) {
+						#ifdef RECEIVE_DEBUG
+						(void) printf (
+							"We can only get %lu / %lu from the current buffer\n",
+							remaining_buffer_size, packet->data_size
+						);
+						#endif
+
+						// TODO: handle errors
+						(void) packet_add_data (
+							packet, end, remaining_buffer_size
+						);
+
+						// update buffer positions & values
+						end += packet->data_size;
+						buffer_pos += packet->data_size;
+						remaining_buffer_size -= packet->data_size;
+					}
+
+					else {
+						#ifdef RECEIVE_DEBUG
+						(void) printf (
+							"We have NO more data left in current buffer\n"
+						);
+						#endif
+					}
+
+					// set the newly created packet as spare
+					receive_handle->spare_packet = packet;
+
+					receive_handle->state = RECEIVE_HANDLE_STATE_SPLIT_PACKET;
+
+					#ifdef RECEIVE_DEBUG
+					(void) printf ("while loop should end now!\n");
+					#endif
+				}
+			}
+
+			else {
+				// we must likely have a bad packet
+				// we need to keep reading the buffer until we find
+				// the start of the next one and we can continue
+				#ifdef RECEIVE_DEBUG
+				cerver_log (
+					LOG_TYPE_WARNING, LOG_TYPE_PACKET,
+					"Got a packet of invalid size: %ld", packet_size
+				);
+				#endif
+
+				#ifdef RECEIVE_DEBUG
+				(void) printf ("\n\nWE ARE LOST!\n\n");
+				#endif
+
+				receive_handle->state = RECEIVE_HANDLE_STATE_LOST;
+
+				// FIXME: this is just for testing!
+				break;
+			}
+		}
+
+		// reset common loop values
+		header = NULL;
+		packet = NULL;
+	} while ((buffer_pos < receive_handle->received_size) && !stop_handler);
+
+	#ifdef RECEIVE_DEBUG
+	(void) printf ("WHILE has ended!\n\n");
+	#endif
+
+	// every packet from this buffer has been handled
+	// if the connection was dropped, the receive handle is gone
+	if (!stop_handler) {
+		cerver_receive_handle_jobs_flush (receive_handle);
+	}
+
+}
+
+void cerver_receive_handle_buffer (
+	void *receive_handle_ptr
+) {
+
+	ReceiveHandle *receive_handle = (ReceiveHandle *) receive_handle_ptr;
+
+	char *end = receive_handle->buffer;
+	size_t buffer_pos = 0;
+
+	size_t remaining_buffer_size = receive_handle->received_size;
+
+	u8 stop_handler = 0;
+
+	#ifdef RECEIVE_DEBUG
+	(void) printf ("Received size: %lu\n", receive_handle->received_size);
+
+	(void) printf (
+		"State BEFORE checking for SPARE PARTS: %s\n",
+		receive_handle_state_to_string (receive_handle->state)
+	);
+	#endif
+
+	// check if we have any spare parts 
+	switch (receive_handle->state) {
+		// check if we have a spare header
+		// that was incompleted from the last buffer
+		case RECEIVE_HANDLE_STATE_SPLIT_HEADER: {
+			// copy the remaining header size
+			(void) memcpy (
+				receive_handle->header_end,
+				(void *) end,
+				receive_handle->remaining_header
+			);
+
+			#ifdef RECEIVE_DEBUG
+			(void) printf (
+				"Copied %u missing header bytes\n",
+				receive_handle->remaining_header
+			);
+			#endif
+
+			// receive_handle->header_end = (char *) &receive_handle->header;
+			// for (size_t i = 0; i < receive_handle->remaining_header; i++)
+			// 	(void) printf ("%4x", (unsigned int) receive_handle->header_end[i]);
+
+			// (void) printf ("\n");
+			
+			#ifdef RECEIVE_DEBUG
+			packet_header_print (&receive_handle->header);
+			#endif
+
+			// update buffer positions
+			end += receive_handle->remaining_header;
+			buffer_pos += receive_handle->remaining_header;
+
+			// update how much we have still left to handle from the current buffer
+			remaining_buffer_size -= receive_handle->remaining_header;
+
+			// reset receive handler values
+			receive_handle->header_end = NULL;
+			receive_handle->remaining_header = 0;
+
+			// we can expect to get the packet's data from the current buffer
+			receive_handle->state = RECEIVE_HANDLE_STATE_COMP_HEADER;
+
+			#ifdef RECEIVE_DEBUG
+			(void) printf ("We have a COMPLETE HEADER!\n");
+			#endif
+		} break;
+
+		// check if we have a spare packet
+		case RECEIVE_HANDLE_STATE_SPLIT_PACKET: {
+			// check if the current buffer is big enough
+			if (
+				receive_handle->spare_packet->remaining_data <= receive_handle->received_size
+			) {
+				size_t to_copy_data_size = receive_handle->spare_packet->remaining_data; 
+				
+				// copy packet's remaining data
+				(void) packet_add_data (
+					receive_handle->spare_packet,
+					end,
+					receive_handle->spare_packet->remaining_data
+				);
+
+				#ifdef RECEIVE_DEBUG
+				(void) printf (
+					"Copied %lu missing packet bytes\n",
+					to_copy_data_size
+				);
+
+				(void) printf ("Spare packet is COMPLETED!\n");
+				#endif
+
+				// we can safely handle the packet
+				stop_handler = cerver_packet_select_handler (
+					receive_handle, receive_handle->spare_packet
+				);
+
+				// update buffer positions
+				end += to_copy_data_size;
+				buffer_pos += to_copy_data_size;
+
+				// update how much we have still left to handle from the current buffer
+				remaining_buffer_size -= to_copy_data_size;
+
+				// we still need to process more data from the buffer
+				receive_handle->state = RECEIVE_HANDLE_STATE_NORMAL;
+			}
+
+			else {
+				#ifdef RECEIVE_DEBUG
+				(void) printf (
+					"We can only get %lu / %lu of the remaining packet's data\n",
+					receive_handle->spare_packet->remaining_data,
+					receive_handle->received_size
+				);
+				#endif
+
+				// copy the complete buffer
+				(void) packet_add_data (
+					receive_handle->spare_packet,
+					end,
+					receive_handle->received_size
+				);
+
+				#ifdef RECEIVE_DEBUG
+				(void) printf (
+					"We are still missing %lu to complete the packet!\n",
+					receive_handle->spare_packet->remaining_data
+				);
+				#endif
+			}
+		} break;
+
+		default: break;
+	}
+
+	#ifdef RECEIVE_DEBUG
+	(void) printf (
+		"State BEFORE LOOP: %s\n",
+		receive_handle_state_to_string (receive_handle->state)
+	);
+	#endif
+
+	// the connection might have been dropped by the spare packet
+	if (!stop_handler) {
+		if (
+			(buffer_pos < receive_handle->received_size)
+			&& (
+				receive_handle->state == RECEIVE_HANDLE_STATE_NORMAL
+				|| receive_handle->state == RECEIVE_HANDLE_STATE_COMP_HEADER
+			)
+		) {
+			cerver_receive_handle_buffer_actual (
+				receive_handle,
+				end, buffer_pos,
+				remaining_buffer_size
+			);
+		}
+
+		// every packet from this buffer has been handled
+		else {
+			cerver_receive_handle_jobs_flush (receive_handle);
+		}
+	}
+
+}
+
+// handles a failed receive from a connection associatd with a client
+// ends the connection to prevent seg faults or signals for bad sock fd
+void cerver_receive_handle_failed (CerverReceive *cr) {
+
+	if (cr->socket) {
+		(void) pthread_mutex_lock (cr->socket->read_mutex);
+
+		if (cr->socket->sock_fd > 0) {
+			switch (cr->type) {
+				case RECEIVE_TYPE_NORMAL: {
+					// check if the socket belongs to a player inside a lobby
+					if (cr->lobby) {
+						if (cr->lobby->players->size > 0) {
+							(void) player_unregister_from_lobby (
+								cr->lobby,
+								player_get_by_sock_fd_list (
+									cr->lobby, cr->socket->sock_fd
+								)
+							);
+						}
+					}
+
+					(void) client_remove_connection_by_sock_fd (
+						cr->cerver, cr->client, cr->socket->sock_fd
+					);
+				} break;
+
+				case RECEIVE_TYPE_ON_HOLD: {
+					on_hold_connection_drop (cr->cerver, cr->connection);
+				} break;
+
+				case RECEIVE_TYPE_ADMIN: {
+					(void) admin_remove_connection_by_sock_fd (
+						cr->cerver->admin, cr->admin, cr->socket->sock_fd
+					);
+				} break;
+
+				default: break;
+			}
+		}
+
+		(void) pthread_mutex_unlock (cr->socket->read_mutex);
+	}
+
+}
+
+static inline void cerver_receive_success_receive_handle (
+	CerverReceive *cr,
+	const size_t received,
+	char *packet_buffer, const size_t packet_buffer_size
+) {
+
+	ReceiveHandle *receive_handle = &cr->connection->receive_handle;
+	receive_handle->type = cr->type;
+
+	receive_handle->cerver = cr->cerver;
+
+	receive_handle->socket = cr->socket;
+	receive_handle->connection = cr->connection;
+	receive_handle->client = cr->client;
+	receive_handle->admin = cr->admin;
+
+	receive_handle->lobby = cr->lobby;
+
+	receive_handle->buffer = packet_buffer;
+	receive_handle->buffer_size = packet_buffer_size;
+	receive_handle->received_size = received;
+
+	if (receive_handle->state == RECEIVE_HANDLE_STATE_NONE) {
+		receive_handle->state = RECEIVE_HANDLE_STATE_NORMAL;
+	}
+
+	cr->cerver->handle_received_buffer (receive_handle);
+
+}
+
+static void cerver_receive_success (
+	CerverReceive *cr,
+	const size_t received,
+	char *packet_buffer, const size_t packet_buffer_size
+) {
+
+	cr->socket->packet_buffer_size = received;
+
+	CerverStatsShard *shard = cerver_stats_shard (cr->cerver);
+
+	STATS_ADD (shard->total_n_receives_done, 1);
+	STATS_ADD (shard->total_bytes_received, received);
+
+	if (cr->lobby) {
+		STATS_ADD (cr->lobby->stats->n_receives_done, 1);
+		STATS_ADD (cr->lobby->stats->bytes_received, received);
+	}
+
+	switch (cr->type) {
+		case RECEIVE_TYPE_NORMAL: {
+			STATS_ADD (shard->client_receives_done, 1);
+			STATS_ADD (shard->client_bytes_received, received);
+
+			// the inactive clients wheel checks it lazily
+			if (cr->cerver->inactive_clients) {
+				__atomic_store_n (
+					&cr->client->last_activity, time (NULL), __ATOMIC_RELAXED
+				);
+			}
+
+			#ifdef CLIENT_STATS
+			STATS_ADD (cr->client->stats->n_receives_done, 1);
+			STATS_ADD (cr->client->stats->total_bytes_received, received);
+			#endif
+
+			#ifdef CONNECTION_STATS
+			STATS_ADD (cr->connection->stats->n_receives_done, 1);
+			STATS_ADD (cr->connection->stats->total_bytes_received, received);
+			#endif
+		} break;
+
+		case RECEIVE_TYPE_ON_HOLD: {
+			STATS_ADD (shard->on_hold_receives_done, 1);
+			STATS_ADD (shard->on_hold_bytes_received, received);
+
+			STATS_ADD (cr->connection->stats->n_receives_done, 1);
+			STATS_ADD (cr->connection->stats->total_bytes_received, received);
+		} break;
+
+		case RECEIVE_TYPE_ADMIN: {
+			STATS_ADD (cr->cerver->admin->stats->total_n_receives_done, 1);
+			STATS_ADD (cr->cerver->admin->stats->total_bytes_received, received);
+
+			#ifdef CLIENT_STATS
+			STATS_ADD (cr->client->stats->n_receives_done, 1);
+			STATS_ADD (cr->client->stats->total_bytes_received, received);
+			#endif
+
+			#ifdef CONNECTION_STATS
+			STATS_ADD (cr->connection->stats->n_receives_done, 1);
+			STATS_ADD (cr->connection->stats->total_bytes_received, received);
+			#endif
+		} break;
+
+		default: break;
+	}
+
+	cerver_receive_success_receive_handle (
+		cr,
+		received,
+		packet_buffer, packet_buffer_size
+	);
+
+}
+
+// performs a single recv () from the connection & handles the result
+// client sockets remain in blocking mode for sends,
+// so we use MSG_DONTWAIT to never block in here
+// returns the number of bytes received, 0 if there was nothing to read
+// or if the connection has failed
+static size_t cerver_receive_read (
+	CerverReceive *cr,
+	char *packet_buffer, const size_t packet_buffer_size
+) {
+
+	size_t received = 0;
+
+	ssize_t rc = recv (
+		cr->socket->sock_fd,
+		packet_buffer, packet_buffer_size,
+		MSG_DONTWAIT
+	);
+
+	switch (rc) {
+		case -1: {
+			// no more data to read
+			if ((errno != EWOULDBLOCK) && (errno != EAGAIN)) {
+				#ifdef HANDLER_DEBUG
+				cerver_log (
+					LOG_TYPE_ERROR, LOG_TYPE_CERVER,
+					"cerver_receive () - rc < 0 - sock fd: %d",
+					cr->socket->sock_fd
+				);
+
+				perror ("Error ");
+				#endif
+
+				cerver_receive_handle_failed (cr);
+			}
+		} break;
+
+		case 0: {
+			// man recv -> steam socket perfomed an orderly shutdown
+			// but in dgram it might mean something?
+			#ifdef HANDLER_DEBUG
+			cerver_log (
+				LOG_TYPE_DEBUG, LOG_TYPE_CERVER,
+				"cerver_recieve () - rc == 0 - sock fd: %d",
+				cr->socket->sock_fd
+			);
+
+			// perror ("Error ");
+			#endif
+
+			cerver_receive_handle_failed (cr);
+		} break;
+
+		default: {
+			#ifdef RECEIVE_DEBUG
+			cerver_log_debug (
+				"recv () - %ld bytes from %d sock fd",
+				rc, cr->socket->sock_fd
+			);
+			#endif
+
+			received = (size_t) rc;
+
+			cerver_receive_success (
+				cr, received,
+				packet_buffer, packet_buffer_size
+			);
+		} break;
+	}
+
+	return received;
+
+}
+
+// checks that handling the packets did not drop the connection
+// only client connections are read more than once in a wakeup
+static inline bool cerver_receive_is_alive (
+	CerverReceive *cr, const i32 sock_fd
+) {
+
+	bool alive = false;
+
+	switch (cr->type) {
+		case RECEIVE_TYPE_NORMAL:
+			alive = cr->client
+				&& fd_table_check (cr->cerver->fd_table, sock_fd, cr->generation);
+			break;
+
+		default: break;
+	}
+
+	return alive;
+
+}
+
+// reads from the connection until the socket has been drained
+// or until the cerver's receive budget has been used
+// exhausted is set to true if the connection may still have data to read
+// returns the number of bytes that were received
+static size_t cerver_receive_drain (
+	CerverReceive *cr,
+	char *packet_buffer, const size_t packet_buffer_size,
+	bool *exhausted
+) {
+
+	Cerver *cerver = cr->cerver;
+	const i32 sock_fd = cr->socket->sock_fd;
+
+	size_t received = 0;
+	size_t rc = 0;
+
+	*exhausted = false;
+
+	cr->connection->receive_handle.n_packets = 0;
+
+	do {
+		rc = cerver_receive_read (cr, packet_buffer, packet_buffer_size);
+		received += rc;
+
+		// a short read means the socket is empty
+		// the rest of the data is read after a paused connection is resumed
+		if (
+			(rc < packet_buffer_size)
+			|| !cerver_receive_is_alive (cr, sock_fd)
+			|| handler_connection_is_paused (cr->connection)
+		) break;
+
+		if (
+			(cerver->receive_budget_bytes && (received >= cerver->receive_budget_bytes))
+			|| (
+				cerver->receive_budget_packets
+				&& (cr->connection->receive_handle.n_packets >= cerver->receive_budget_packets)
+			)
+		) {
+			STATS_ADD (cerver_stats_shard (cerver)->receive_budget_exhausted, 1);
+			*exhausted = true;
+		}
+	} while (!*exhausted);
+
+	CerverStatsShard *shard = cerver_stats_shard (cerver);
+	STATS_ADD (shard->receive_wakeups, 1);
+	STATS_ADD (shard->receive_wakeups_bytes, received);
+
+	return received;
+
+}
+
+// only called after poll () reported the sock fd as readable,
+// so we should never block in here; MSG_DONTWAIT makes sure we don't
+// if the fd was moved inside the poll array while handling its event
+// client connections are drained until the receive budget has been used,
+// poll () will report them again in the next loop if they still have data
+void cerver_receive_internal (
+	CerverReceive *cr,
+	char *packet_buffer, const size_t packet_buffer_size
+) {
+
+	bool exhausted = false;
+	(void) cerver_receive_drain (
+		cr, packet_buffer, packet_buffer_size, &exhausted
+	);
+
+}
+
+// packet buffer only gets deleted if cerver_receive_handle_buffer () is used
+static inline u8 cerver_receive_threads_actual (
+	CerverReceive *cr,
+	char *buffer, const size_t buffer_size
+) {
+
+	u8 retval = 1;
+	
+	ssize_t rc = recv (cr->socket->sock_fd, buffer, buffer_size, 0);
+	switch (rc) {
+		case -1: {
+			if (errno == EAGAIN) {
+				#ifdef SOCKET_DEBUG
+				cerver_log_debug (
+					"cerver_receive_threads () - sock fd: %d timed out",
+					cr->socket->sock_fd
+				);
+				#endif
+
+				retval = 0;
+			}
+
+			else {
+				#ifdef HANDLER_DEBUG
+				cerver_log (
+					LOG_TYPE_ERROR, LOG_TYPE_CERVER,
+					"cerver_receive_threads () - rc < 0 - sock fd: %d",
+					cr->socket->sock_fd
+				);
+
+				perror ("Error ");
+				#endif
+			}
+		} break;
+
+		case 0: {
+			#ifdef HANDLER_DEBUG
+			cerver_log (
+				LOG_TYPE_DEBUG, LOG_TYPE_CERVER,
+				"cerver_receive_threads () - rc == 0 - sock fd: %d",
+				cr->socket->sock_fd
+			);
+
+			// perror ("Error ");
+			#endif
+		} break;
+
+		default: {
+			cerver_receive_success (
+				cr, (size_t) rc,
+				buffer, buffer_size
+			);
+
+			retval = 0;
+		} break;
+	}
+
+	return retval;
+
+}
+
+static void *cerver_receive_threads (void *cerver_receive_ptr) {
+
+	CerverReceive *cr = (CerverReceive *) cerver_receive_ptr;
+
+	i32 sock_fd = cr->socket->sock_fd;
+
+	#ifdef HANDLER_DEBUG
+	cerver_log (
+		LOG_TYPE_DEBUG, LOG_TYPE_HANDLER,
+		"cerver_receive_threads () - sock fd <%d> connection thread has started",
+		sock_fd
+	);
+	#endif
+
+	// set the socket's timeout to prevent thread from getting stuck if no more data to read
+	(void) sock_set_timeout (sock_fd, CERVER_DEFAULT_SOCKET_RECV_TIMEOUT);
+
+	const size_t buffer_size = cr->cerver->receive_buffer_size;
+	char *buffer = (char *) calloc (buffer_size, sizeof (char));
+	if (buffer) {
+		while (
+			(cr->socket->sock_fd > 0)
+			&& cr->cerver->isRunning
+			&& !cerver_receive_threads_actual (cr, buffer, buffer_size)
+		);
+
+		free (buffer);
+	}
+
+	else {
+		cerver_log (
+			LOG_TYPE_ERROR, LOG_TYPE_HANDLER,
+			"cerver_receive_threads () - "
+			"Failed to allocate packet buffer for sock fd <%d> connection!",
+			cr->connection->socket->sock_fd
+		);
+	}
+
+	// check if the connection has already ended
+	if (cr->socket->sock_fd > 0) {
+		client_remove_connection_by_sock_fd (
+			cr->cerver, cr->client, cr->socket->sock_fd
+		);
+	}
+
+	cerver_receive_delete (cr);
+
+	#ifdef HANDLER_DEBUG
+	cerver_log (
+		LOG_TYPE_DEBUG, LOG_TYPE_HANDLER,
+		"cerver_receive_threads () - loop has ended - "
+		"dropping sock fd <%d> connection...",
+		sock_fd
+	);
+	#endif
+
+	return NULL;
+
+}
+
+#pragma endregion
+
+#pragma region accept
+
+// create a new connection but check if we can use the cerver's socket pool first
+static Connection *cerver_connection_create (
+	Cerver *cerver,
+	const i32 new_fd, const struct sockaddr_storage *client_address
+) {
+
+	Connection *connection = NULL;
+
+	if (cerver->sockets_pool) {
+		// use a socket from the pool to create a new connection
+		Socket *socket = cerver_sockets_pool_pop (cerver);
+		if (socket) {
+			// manually create the connection
+			connection = connection_new ();
+			if (connection) {
+				// from connection_create_empty ()
+				// connection->socket = (Socket *) socket_create_empty ();
+				connection->socket = socket;
+
+				connection->stats = connection_stats_new ();
+
+				// from connection_create ()
+				connection->socket->sock_fd = new_fd;
+				(void) memcpy (
+					&connection->address,
+					client_address,
+					sizeof (struct sockaddr_storage)
+				);
+
+				connection->protocol = cerver->protocol;
+
+				connection_get_values (connection);
+			}
+		}
+
+		else {
+			connection = connection_create (
+				new_fd, client_address, cerver->protocol
+			);
+		}
+	}
+
+	else {
+		connection = connection_create (
+			new_fd, client_address, cerver->protocol
+		);
+	}
+
+	return connection;
+
+}
+
+// if the cerver requires auth, we put the connection on hold
+static u8 cerver_register_new_connection_auth_required (
+	Cerver *cerver, Connection *connection
+) {
+
+	u8 retval = 1;
+
+	if (!on_hold_connection (cerver, connection)) {
+		#ifdef CERVER_DEBUG
+		cerver_log (
+			LOG_TYPE_DEBUG, LOG_TYPE_CERVER,
+			"Connection is on hold on cerver %s!",
+			cerver->info->name
+		);
+		#endif
+
+		STATS_ADD (cerver->stats->total_on_hold_connections, 1);
+
+		connection->active = true;
+
+		cerver_info_send_info_packet (cerver, NULL, connection);
+
+		cerver_event_trigger (
+			CERVER_EVENT_ON_HOLD_CONNECTED,
+			cerver,
+			NULL, connection
+		);
+
+		retval = 0;
+	}
+
+	else {
+		cerver_log_error (
+			"Failed to put connection on hold in cerver %s",
+			cerver->info->name
+		);
+	}
+
+	return retval;
+
+}
+
+static u8 cerver_register_new_connection_normal_default_create_detachable (
+	CerverReceive *cr
+) {
+
+	u8 retval = 1;
+
+	pthread_t thread_id = 0;
+	if (!thread_create_detachable (
+		&thread_id,
+		cerver_receive_threads,
+		cr
+	)) {
+		#ifdef HANDLER_DEBUG
+		cerver_log (
+			LOG_TYPE_DEBUG, LOG_TYPE_HANDLER,
+			"Created detachable thread for sock fd <%d> connection",
+			cr->connection->socket->sock_fd
+		);
+		#endif
+
+		retval = 0;     // success
+	}
+
+	else {
+		cerver_log_error (
+			"cerver_register_new_connection_normal_default () - "
+			"Failed to create detachable thread for sock fd <%d> connection!",
+			cr->connection->socket->sock_fd
+		);
+
+		cerver_receive_delete (cr);
+	}
+
+	return retval;
+
+}
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wcast-function-type"
+
+static u8 cerver_register_new_connection_normal_default_select_handler_threads (
+	Cerver *cerver, Client *client, Connection *connection
+) {
+
+	u8 retval = 1;
+
+	CerverReceive *cr = cerver_receive_create_full (
+		RECEIVE_TYPE_NORMAL,
+		cerver,
+		client, connection
+	);
+
+	if (cr) {
+		// create a new detachable thread directly
+		if (cerver->handle_detachable_threads) {
+			retval = cerver_register_new_connection_normal_default_create_detachable (cr);
+		}
+
+		else {
+			if (thpool_is_full (cerver->thpool)) {
+				#ifdef HANDLER_DEBUG
+				cerver_log (
+					LOG_TYPE_DEBUG, LOG_TYPE_HANDLER,
+					"Cerver %s thpool is full! "
+					"Creating a detachable thread for sock fd <%d> connection...",
+					cerver->info->name, connection->socket->sock_fd
+				);
+				#endif
+
+				retval = cerver_register_new_connection_normal_default_create_detachable (cr);
+			}
+
+			else {
+				if (!thpool_add_work (
+					cerver->thpool,
+					(void (*) (void *)) cerver_receive_threads,
+					cr
+				)) {
+					#ifdef HANDLER_DEBUG
+					cerver_log (
+						LOG_TYPE_DEBUG, LOG_TYPE_HANDLER,
+						"Added work for sock fd <%d> connection to the thpool!",
+						connection->socket->sock_fd
+					);
+
+					cerver_log (
+						LOG_TYPE_DEBUG, LOG_TYPE_HANDLER,
+						"Cerver %s thpool - %d / %d threads working",
+						cerver->info->name,
+						thpool_get_num_threads_working (cerver->thpool),
+						cerver->thpool->num_threads_alive
+					);
+					#endif
+
+					retval = 0;     // success
+				}
+
+				else {
+					cerver_receive_delete (cr);
+				}
+			}
+		}
+	}
+
+	return retval;
+
+}
+
+#pragma GCC diagnostic pop
+
+// select how client connection will be handled based on cerver's handler type
+u8 cerver_register_new_connection_normal_default_select_handler (
+	Cerver *cerver, Client *client, Connection *connection
+) {
+
+	u8 retval = 1;
+
+	switch (cerver->handler_type) {
+		case CERVER_HANDLER_TYPE_NONE: break;
+
+		case CERVER_HANDLER_TYPE_POLL: {
+			// nothing to be done, as connection will be handled by poll ()
+			// after being registered to the cerver
+			retval = 0;     // success
+		} break;
+
+		case CERVER_HANDLER_TYPE_EPOLL:
+		case CERVER_HANDLER_TYPE_REACTORS: {
+			// nothing to be done, as connection will be handled by epoll ()
+			// after being registered to the cerver
+			retval = 0;     // success
+		} break;
+
+		case CERVER_HANDLER_TYPE_IO_URING: {
+			// nothing to be done, as connection's receive
+			// was submitted when it was registered to the cerver
+			retval = 0;     // success
+		} break;
+
+		// handle connection in dedicated thread
+		case CERVER_HANDLER_TYPE_THREADS: {
+			retval = cerver_register_new_connection_normal_default_select_handler_threads (
+				cerver, client, connection
+			);
+		} break;
+
+		default: break;
+	}
+
+	return retval;
+
+}
+
+static u8 cerver_register_new_connection_normal_default (
+	Cerver *cerver, Connection *connection
+) {
+
+	u8 retval = 1;
+
+	Client *client = client_create ();
+	if (client) {
+		(void) connection_register_to_client (client, connection);
+
+		if (!client_register_to_cerver (cerver, client)) {
+			connection->active = true;
+
+			(void) cerver_info_send_info_packet (cerver, client, connection);
+
+			// TODO: better error handling
+			if (!cerver_register_new_connection_normal_default_select_handler (
+				cerver, client, connection
+			)) {
+				cerver_event_trigger (
+					CERVER_EVENT_CLIENT_CONNECTED,
+					cerver,
+					client, connection
+				);
+
+				retval = 0;
+			}
+		}
+	}
+
+	else {
+		cerver_log_error (
+			"cerver_register_new_connection_normal_default () - "
+			"Failed to create new client for new connection with sock fd <%d>!",
+			connection->socket->sock_fd
+		);
+	}
+
+	return retval;
+
+}
+
+static u8 cerver_register_new_connection_normal (
+	Cerver *cerver, Connection *connection
+) {
+
+	u8 retval = 1;
+
+	switch (cerver->type) {
+		case CERVER_TYPE_WEB: break;
+
+		default: {
+			retval = cerver_register_new_connection_normal_default (
+				cerver, connection
+			);
+		} break;
+	}
+
+	return retval;
+
+}
+
+static inline u8 cerver_register_new_connection_select (
+	Cerver *cerver, Connection *connection
+) {
+
+	return cerver->auth_required ?
+		cerver_register_new_connection_auth_required (cerver, connection) :
+		cerver_register_new_connection_normal (cerver, connection);
+
+}
+
+static void cerver_register_new_connection_actual (
+	Cerver *cerver, Connection *connection
+) {
+
+	// #ifdef CERVER_DEBUG
+	cerver_log (
+		LOG_TYPE_DEBUG, LOG_TYPE_CLIENT,
+		"New connection from IP address: %s -- Port: %d",
+		connection->ip, connection->port
+	);
+	// #endif
+
+	connection->active = true;
+
+	if (!cerver_register_new_connection_select (cerver, connection)) {
+		#ifdef CERVER_DEBUG
+		cerver_log (
+			LOG_TYPE_SUCCESS, LOG_TYPE_CERVER,
+			"New connection to cerver %s!", cerver->info->name
+		);
+		#endif
+	}
+
+	// internal server error - failed to handle the new connection
+	else {
+		cerver_log_error (
+			"cerver_register_new_connection () "
+			"- internal error - dropping sock fd <%d> connection...",
+			connection->socket->sock_fd
+		);
+
+		connection_drop (cerver, connection);
+	}
+
+}
+
+static void cerver_register_new_connection (
+	Cerver *cerver,
+	const i32 new_fd, const struct sockaddr_storage *client_address
+) {
+
+	Connection *connection = cerver_connection_create (
+		cerver, new_fd, client_address
+	);
+	
+	if (connection) {
+		cerver_register_new_connection_actual (cerver, connection);
+	}
+
+	else {
+		// FIXME: close the socket and cleanup
+		// #ifdef CERVER_DEBUG
+		cerver_log (
+			LOG_TYPE_ERROR, LOG_TYPE_CLIENT,
+			"cerver_register_new_connection () - failed to create a new connection!"
+		);
+		// #endif
+	}
+
+}
+
+// accepst a new connection to the cerver
+static void cerver_accept (void *cerver_ptr) {
+
+	Cerver *cerver = (Cerver *) cerver_ptr;
+
+	struct sockaddr_storage client_address = { 0 };
+	// (void) memset (&client_address, 0, sizeof (struct sockaddr_storage));
+	socklen_t socklen = sizeof (struct sockaddr_storage);
+
+	// accept the new connection
+	i32 new_fd = accept (cerver->sock, (struct sockaddr *) &client_address, &socklen);
+	if (new_fd > 0) {
+		#ifdef HANDLER_DEBUG
+		cerver_log_debug ("Accepted fd: %d", new_fd);
+		#endif
+		cerver_register_new_connection (cerver, new_fd, &client_address);
+	}
+
+	else {
+		// if we get EWOULDBLOCK, we have accepted all connections
+		if (errno != EWOULDBLOCK) {
+			cerver_log (LOG_TYPE_ERROR, LOG_TYPE_CERVER, "Accept failed!");
+			perror ("Error");
+		}
+	}
+
+}
+
+#pragma endregion
+
+#pragma region register
+
+// only the handlers that wait for their sockets to be writable
+// are able to send the data that is left in a connection's send queue
+static inline bool cerver_handler_flushes_send_queues (
+	const Cerver *cerver
+) {
+
+	return (cerver->handler_type == CERVER_HANDLER_TYPE_EPOLL)
+		|| (cerver->handler_type == CERVER_HANDLER_TYPE_REACTORS)
+		|| (cerver->handler_type == CERVER_HANDLER_TYPE_IO_URING);
+
+}
+
+// removes a send queue that would never be flushed by the cerver's handler
+// so that packets are sent directly to the connection's socket
+static void cerver_handler_discard_send_queue (
+	Cerver *cerver, Connection *connection
+) {
+
+	cerver_log (
+		LOG_TYPE_WARNING, LOG_TYPE_CERVER,
+		"Cerver %s %s handler can't flush sock fd <%d> send queue!",
+		cerver->info->name,
+		cerver_handler_type_to_string (cerver->handler_type),
+		connection->socket->sock_fd
+	);
+
+	send_queue_delete (connection->send_queue);
+	connection->send_queue = NULL;
+	connection->use_send_queue = false;
+
+}
+
+// select how a connection will be handled
+// based on cerver's handler type
+// connections with a send queue are only allowed
+// with CERVER_HANDLER_TYPE_EPOLL, CERVER_HANDLER_TYPE_REACTORS
+// & CERVER_HANDLER_TYPE_IO_URING, any other handler discards it
+// returns 0 on success, 1 on error
+u8 cerver_handler_register_connection (
+	Cerver *cerver, Client *client, Connection *connection
+) {
+
+	u8 retval = 1;
+
+	if (cerver && connection) {
+		if (
+			connection->send_queue
+			&& !cerver_handler_flushes_send_queues (cerver)
+		) {
+			cerver_handler_discard_send_queue (cerver, connection);
+		}
+
+		switch (cerver->handler_type) {
+			case CERVER_HANDLER_TYPE_NONE: break;
+
+			// handle connection using the cerver's poll
+			case CERVER_HANDLER_TYPE_POLL: {
+				retval = cerver_poll_register_connection (
+					cerver, connection
+				);
+			} break;
+
+			// handle connection using the cerver's epoll
+			case CERVER_HANDLER_TYPE_EPOLL: {
+				retval = cerver_epoll_register_connection (
+					cerver, connection
+				);
+			} break;
+
+			// handle connection using its reactor's epoll
+			case CERVER_HANDLER_TYPE_REACTORS: {
+				retval = cerver_reactors_register_connection (
+					cerver, connection
+				);
+			} break;
+
+			// handle connection using the cerver's io_uring
+			case CERVER_HANDLER_TYPE_IO_URING: {
+				retval = cerver_uring_register_connection (
+					cerver, connection
+				);
+			} break;
+
+			// handle connection in dedicated thread
+			case CERVER_HANDLER_TYPE_THREADS: {
+				retval = cerver_register_new_connection_normal_default_select_handler_threads (
+					cerver, client, connection
+				);
+			} break;
+
+			default: break;
+		}
+	}
+
+	return retval;
+
+}
+
+#pragma endregion
+
+#pragma region poll
+
+// reallocs main cerver poll fds
+// must only be called by the poll thread while it is not inside poll ()
+// returns 0 on success, 1 on error
+u8 cerver_realloc_main_poll_fds (Cerver *cerver) {
+
+	u8 retval = 1;
+
+	if (cerver) {
+		const u32 current_max = cerver->max_n_fds;
+		struct pollfd *fds = (struct pollfd *) realloc (
+			cerver->fds, (current_max * 2) * sizeof (struct pollfd)
+		);
+
+		if (fds) {
+			cerver->fds = fds;
+			cerver->max_n_fds = current_max * 2;
+
+			poll_fds_reset (cerver->fds, current_max, cerver->max_n_fds);
+
+			retval = 0;
+		}
+	}
+
+	return retval;
+
+}
+
+// keeps the sock fd until the poll thread grows the pollfd array
+// must be called with the cerver's poll lock
+// returns 0 on success, 1 on error
+static u8 cerver_poll_pending_push (Cerver *cerver, const i32 sock_fd) {
+
+	if (cerver->n_pending_fds == cerver->max_pending_fds) {
+		const u32 max_pending_fds = cerver->max_pending_fds ?
+			cerver->max_pending_fds * 2 : CERVER_DEFAULT_POLL_PENDING_FDS;
+
+		i32 *pending_fds = (i32 *) realloc (
+			cerver->pending_fds, max_pending_fds * sizeof (i32)
+		);
+
+		if (pending_fds) {
+			cerver->pending_fds = pending_fds;
+			cerver->max_pending_fds = max_pending_fds;
+		}
+	}
+
+	u8 retval = 1;
+
+	if (cerver->n_pending_fds < cerver->max_pending_fds) {
+		cerver->pending_fds[cerver->n_pending_fds] = sock_fd;
+		cerver->n_pending_fds += 1;
+
+		retval = 0;
+	}
+
+	return retval;
+
+}
+
+// removes the sock fd if it was still waiting to be registered
+// must be called with the cerver's poll lock
+// returns 0 on success, 1 if the sock fd was not pending
+static u8 cerver_poll_pending_remove (Cerver *cerver, const i32 sock_fd) {
+
+	u8 retval = 1;
+
+	for (u32 i = 0; i < cerver->n_pending_fds; i++) {
+		if (cerver->pending_fds[i] == sock_fd) {
+			cerver->n_pending_fds -= 1;
+			cerver->pending_fds[i] = cerver->pending_fds[cerver->n_pending_fds];
+
+			retval = 0;
+			break;
+		}
+	}
+
+	return retval;
+
+}
+
+// the cerver's own sock fd is always in idx 0
+// followed by its timers in idx 1 if they have been created
+static inline u32 cerver_poll_first_connection_idx (const Cerver *cerver) {
+
+	return cerver->timers ? 2 : 1;
+
+}
+
+// compacts the pollfd array & registers the pending sock fds
+// only called by the poll thread after it has handled the events
+static void cerver_poll_update (Cerver *cerver) {
+
+	(void) pthread_mutex_lock (cerver->poll_lock);
+
+	// the cerver's own fds must always stay in their idxs
+	poll_fds_compact (
+		cerver->fds, &cerver->current_n_fds, cerver->fds_map,
+		cerver_poll_first_connection_idx (cerver)
+	);
+
+	while (cerver->n_pending_fds) {
+		if (
+			(cerver->current_n_fds == cerver->max_n_fds)
+			&& cerver_realloc_main_poll_fds (cerver)
+		) {
+			cerver_log (
+				LOG_TYPE_ERROR, LOG_TYPE_NONE,
+				"Failed to realloc cerver %s main poll fds!",
+				cerver->info->name
+			);
+
+			break;
+		}
+
+		cerver->n_pending_fds -= 1;
+		(void) poll_fds_register (
+			cerver->fds, cerver->max_n_fds, &cerver->current_n_fds,
+			cerver->fds_map,
+			cerver->pending_fds[cerver->n_pending_fds], POLLIN
+		);
+	}
+
+	(void) pthread_mutex_unlock (cerver->poll_lock);
+
+}
+
+// get a free index in the main cerver poll array
+// the array is kept compacted, so the next free idx
+// is always right after the last active fd
+i32 cerver_poll_get_free_idx (Cerver *cerver) {
+
+	if (cerver) {
+		if (cerver->current_n_fds < cerver->max_n_fds)
+			return (i32) cerver->current_n_fds;
+	}
+
+	return -1;
+
+}
+
+// get the idx of the connection sock fd in the cerver poll fds
+i32 cerver_poll_get_idx_by_sock_fd (Cerver *cerver, i32 sock_fd) {
+
+	return cerver ? poll_fds_map_get (cerver->fds_map, sock_fd) : -1;
+
+}
+
+static u8 cerver_poll_register_connection_internal (
+	Cerver *cerver, Connection *connection
+) {
+
+	u8 retval = 1;
+
+	// if the array is full, the poll thread will register the sock fd
+	// after it has grown the array, as poll () might be using it
+	i32 idx = poll_fds_register (
+		cerver->fds, cerver->max_n_fds, &cerver->current_n_fds,
+		cerver->fds_map,
+		connection->socket->sock_fd, POLLIN
+	);
+
+	if ((idx < 0) && !cerver_poll_pending_push (cerver, connection->socket->sock_fd)) {
+		idx = (i32) cerver->current_n_fds;
+	}
+
+	if (idx >= 0) {
+
+		STATS_ADD (cerver->stats->current_active_client_connections, 1);
+
+		#ifdef CERVER_DEBUG
+		cerver_log (
+			LOG_TYPE_DEBUG, LOG_TYPE_CERVER,
+			"Added sock fd <%d> to cerver %s MAIN poll, idx: %i",
+			connection->socket->sock_fd, cerver->info->name, idx
+		);
+		#endif
+
+		#ifdef CERVER_STATS
+		cerver_log (
+			LOG_TYPE_CERVER, LOG_TYPE_NONE,
+			"Cerver %s current active connections: %ld",
+			cerver->info->name,
+			cerver->stats->current_active_client_connections
+		);
+		#endif
+
+		retval = 0;
+	}
+
+	return retval;
+
+}
+
+// regsiters a client connection to the cerver's mains poll structure
+// and maps the sock fd to the client
+// if the poll array is full, the sock fd is registered by the poll thread
+// after it has grown the array in its next loop
+// returns 0 on success, 1 on error
+u8 cerver_poll_register_connection (
+	Cerver *cerver, Connection *connection
+) {
+
+	u8 retval = 1;
+
+	if (cerver && connection) {
+		pthread_mutex_lock (cerver->poll_lock);
+
+		if (!cerver_poll_register_connection_internal (
+			cerver, connection
+		)) {
+			retval = 0;
+		}
+
+		else {
+			cerver_log (
+				LOG_TYPE_ERROR, LOG_TYPE_NONE,
+				"Failed to register sock fd <%d> to cerver %s main poll!",
+				connection->socket->sock_fd, cerver->info->name
+			);
+		}
+
+		pthread_mutex_unlock (cerver->poll_lock);
+	}
+
+	return retval;
+
+}
+
+// only the connection's events are updated,
+// so the poll thread can keep moving it inside the array
+// returns 0 on success, 1 if the sock fd is not in the poll array
+static u8 cerver_poll_connection_set_reading (
+	Cerver *cerver, Connection *connection, const bool reading
+) {
+
+	u8 retval = 1;
+
+	pthread_mutex_lock (cerver->poll_lock);
+
+	i32 idx = cerver_poll_get_idx_by_sock_fd (cerver, connection->socket->sock_fd);
+	if (idx > 0) {
+		__atomic_store_n (
+			&cerver->fds[idx].events, (short) (reading ? POLLIN : 0), __ATOMIC_RELAXED
+		);
+
+		retval = 0;
+	}
+
+	pthread_mutex_unlock (cerver->poll_lock);
+
+	return retval;
+
+}
+
+// removes a sock fd from the cerver's main poll array
+// its slot is freed right away but it is compacted by the poll thread
+// returns 0 on success, 1 on error
+u8 cerver_poll_unregister_sock_fd (Cerver *cerver, const i32 sock_fd) {
+
+	u8 retval = 1;
+
+	if (cerver) {
+		pthread_mutex_lock (cerver->poll_lock);
+
+		// get the idx of the sock fd in the cerver poll fds
+		// the cerver's own sock fd must always stay in idx 0
+		i32 idx = cerver_poll_get_idx_by_sock_fd (cerver, sock_fd);
+		if ((idx > 0) || !cerver_poll_pending_remove (cerver, sock_fd)) {
+			// its slot is compacted by the poll thread
+			(void) poll_fds_unregister (
+				cerver->fds, cerver->fds_map, sock_fd
+			);
+
+			STATS_SUB (cerver->stats->current_active_client_connections, 1);
+
+			#ifdef CERVER_DEBUG
+			cerver_log (
+				LOG_TYPE_DEBUG, LOG_TYPE_CERVER,
+				"Removed sock fd <%d> from cerver %s MAIN poll, idx: %d",
+				sock_fd, cerver->info->name, idx
+			);
+			#endif
+
+			#ifdef CERVER_STATS
+			cerver_log (
+				LOG_TYPE_CERVER, LOG_TYPE_NONE,
+				"Cerver %s current active connections: %ld",
+				cerver->info->name,
+				cerver->stats->current_active_client_connections
+			);
+			#endif
+
+			retval = 0;     // removed the sock fd form the cerver poll
+		}
+
+		else {
+			// #ifdef CERVER_DEBUG
+			cerver_log (
+				LOG_TYPE_WARNING, LOG_TYPE_CERVER,
+				"Sock fd <%d> was NOT found in cerver %s MAIN poll!",
+				sock_fd, cerver->info->name
+			);
+			// #endif
+		}
+
+		pthread_mutex_unlock (cerver->poll_lock);
+	}
+
+	return retval;
+
+}
+
+// unregsiters a client connection from the cerver's main poll structure
+// returns 0 on success, 1 on error
+u8 cerver_poll_unregister_connection (Cerver *cerver, Connection *connection) {
+
+	return (cerver && connection) ?
+		cerver_poll_unregister_sock_fd (cerver, connection->socket->sock_fd) : 1;
+
+}
+
+static inline void cerver_poll_handle_actual_accept (Cerver *cerver) {
+
+	if (cerver->thpool) {
+		if (thpool_add_work (cerver->thpool, cerver_accept, cerver))  {
+			cerver_log_error (
+				"Failed to add cerver_accept () to cerver's %s thpool!",
+				cerver->info->name
+			);
+		}
+	}
+
+	else {
+		cerver_accept (cerver);
+	}
+
+}
+
+static inline void cerver_poll_handle_actual_receive (
+	Cerver *cerver,
+	struct pollfd *active_fd,
+	CerverReceive *cr, char *packet_buffer
+) {
+
+	// the same receive is used for every event
+	// so there are no allocations when handling a connection
+	cerver_receive_init (cr, RECEIVE_TYPE_NORMAL, cerver, active_fd->fd);
+
+	// the sock fd has already been closed if it was a rogue connection
+	if (cr->socket) {
+		switch (active_fd->revents) {
+			// A connection setup has been completed or new data arrived
+			case POLLIN: {
+				// printf ("Receive fd: %d\n", cerver->fds[i].fd);
+
+				// receive all incoming data from the socket
+				// and handle the packets in the same thread
+				cerver_receive_internal (
+					cr,
+					packet_buffer, cerver->receive_buffer_size
+				);
+			} break;
+
+			// A disconnection request has been initiated by the other end
+			// or a connection is broken (SIGPIPE is also set when we try to write to it)
+			// or The other end has shut down one direction
+			case POLLHUP: {
+				// printf ("POLLHUP\n");
+				cerver_receive_handle_failed (cr);
+			} break;
+
+			// An asynchronous error occurred
+			case POLLERR: {
+				// printf ("POLLERR\n");
+				cerver_receive_handle_failed (cr);
+			} break;
+
+			// Urgent data arrived. SIGURG is sent then.
+			case POLLPRI: break;
+
+			default: {
+				if (active_fd->revents != 0) {
+					cerver_receive_handle_failed (cr);
+				}
+			} break;
+		}
+	}
+
+}
+
+static inline void cerver_poll_handle (
+	Cerver *cerver, const u32 n_fds,
+	CerverReceive *cr, char *packet_buffer
+) {
+
+	// one or more fd(s) are readable, need to determine which ones they are
+	// fds are never moved until every event has been handled,
+	// but another thread might have freed their slot meanwhile
+	const u32 first = cerver_poll_first_connection_idx (cerver);
+
+	struct pollfd active_fd = { 0 };
+	for (u32 idx = 0; idx < n_fds; idx++) {
+		if (cerver->fds[idx].revents) {
+			active_fd.fd = poll_fds_get (cerver->fds, idx);
+			active_fd.revents = cerver->fds[idx].revents;
+			cerver->fds[idx].revents = 0;
+
+			// the cerver's sock fd has an event
+			if (idx == 0) {
+				cerver_poll_handle_actual_accept (cerver);
+			}
+
+			// some of the cerver's timers have expired
+			else if (idx < first) {
+				timer_wheel_handle (cerver->timers);
+			}
+
+			else if (active_fd.fd >= 0) {
+				cerver_poll_handle_actual_receive (
+					cerver,
+					&active_fd,
+					cr, packet_buffer
+				);
+			}
+		}
+	}
+
+}
+
+// cerver poll loop to handle events in the registered socket's fds
+u8 cerver_poll (Cerver *cerver) {
+
+	u8 retval = 1;
+
+	if (cerver) {
+		cerver_log (
+			LOG_TYPE_SUCCESS, LOG_TYPE_CERVER,
+			"Cerver %s is ready in port %d!",
+			cerver->info->name, cerver->port
+		);
+
+		#ifdef CERVER_DEBUG
+		cerver_log (
+			LOG_TYPE_DEBUG, LOG_TYPE_CERVER,
+			"Waiting for connections..."
+		);
+		#endif
+
+		char *packet_buffer = (char *) calloc (
+			cerver->receive_buffer_size, sizeof (char)
+		);
+
+		if (packet_buffer) {
+			CerverReceive cr = { 0 };
+
+			u32 n_fds = 0;
+			int poll_retval = 0;
+			while (cerver->isRunning) {
+				// other threads can only append new fds
+				// or free their slots while we are polling
+				(void) pthread_mutex_lock (cerver->poll_lock);
+				n_fds = cerver->current_n_fds;
+				(void) pthread_mutex_unlock (cerver->poll_lock);
+
+				poll_retval = poll (cerver->fds, n_fds, cerver->poll_timeout);
+
+				switch (poll_retval) {
+					case -1: {
+						cerver_log (
+							LOG_TYPE_ERROR, LOG_TYPE_CERVER,
+							"Cerver %s main poll has failed!",
+							cerver->info->name
+						);
+
+						perror ("Error");
+						cerver->isRunning = false;
+					} break;
+
+					case 0: {
+						// #ifdef CERVER_DEBUG
+						// cerver_log_debug (
+						// 	"Cerver %s MAIN poll timeout",
+						// 	cerver->info->name
+						// );
+						// #endif
+					} break;
+
+					default: {
+						cerver_poll_handle (cerver, n_fds, &cr, packet_buffer);
+					} break;
+				}
+
+				cerver_poll_update (cerver);
+			}
+
+			#ifdef CERVER_DEBUG
+			cerver_log (
+				LOG_TYPE_CERVER, LOG_TYPE_NONE,
+				"Cerver %s main poll has stopped!",
+				cerver->info->name
+			);
+			#endif
+
+			free (packet_buffer);
+
+			retval = 0;
+		}
+
+		else {
+			cerver_log_error (
+				"Failed to allocate cerver poll's packet buffer!"
+			);
+		}
+	}
+
+	else {
+		cerver_log (
+			LOG_TYPE_ERROR, LOG_TYPE_CERVER,
+			"Can't listen for connections on a NULL cerver!"
+		);
+	}
+
+	return retval;
+
+}
+
+#pragma endregion
+
+#pragma region epoll
+
+// creates the cerver's epoll instance
+// returns 0 on success, 1 on error
+u8 cerver_epoll_init (Cerver *cerver) {
+
+	u8 retval = 1;
+
+	if (cerver) {
+		cerver->epoll_fd = epoll_create1 (EPOLL_CLOEXEC);
+		if (cerver->epoll_fd >= 0) {
+			retval = 0;
+		}
+
+		else {
+			cerver_log (
+				LOG_TYPE_ERROR, LOG_TYPE_CERVER,
+				"Failed to create cerver %s epoll instance!",
+				cerver->info->name
+			);
+
+			perror ("Error");
+		}
+	}
+
+	return retval;
+
+}
+
+// closes the cerver's epoll instance
+void cerver_epoll_end (Cerver *cerver) {
+
+	if (cerver) {
+		if (cerver->epoll_fd >= 0) {
+			(void) close (cerver->epoll_fd);
+			cerver->epoll_fd = -1;
+		}
+	}
+
+}
+
+// the events keep the sock fd in their lower 32 bits
+// and the fd table generation of its connection in the upper ones
+// so events from connections that have been dropped
+// or whose sock fd is now used by another connection are discarded
+static inline u64 cerver_epoll_event_data (
+	const i32 sock_fd, const u32 generation
+) {
+
+	return ((u64) generation << 32) | (u64) (u32) sock_fd;
+
+}
+
+// fds without a connection use a generation that never matches an entry
+static inline bool cerver_epoll_event_is_internal (const u64 data) {
+
+	return ((u32) (data >> 32) == FD_TABLE_INVALID_GENERATION);
+
+}
+
+// gets the connection that generated the event from the cerver's fd table
+// returns NULL if the connection is no longer using the event's sock fd
+static Connection *cerver_epoll_event_connection (
+	Cerver *cerver, const u64 data
+) {
+
+	Connection *connection = NULL;
+
+	FdTableEntry entry = { 0 };
+	if (
+		!fd_table_get (cerver->fd_table, (i32) (u32) data, &entry)
+		&& entry.client
+		&& (entry.generation == (u32) (data >> 32))
+	) {
+		connection = entry.connection;
+	}
+
+	return connection;
+
+}
+
+// registers the cerver's listening socket
+// it is registered without a connection like the cerver's timers
+static u8 cerver_epoll_register_sock (Cerver *cerver) {
+
+	struct epoll_event event = { 0 };
+	event.events = EPOLLIN | EPOLLET;
+	event.data.u64 = cerver_epoll_event_data (
+		cerver->sock, FD_TABLE_INVALID_GENERATION
+	);
+
+	return epoll_ctl (
+		cerver->epoll_fd, EPOLL_CTL_ADD, cerver->sock, &event
+	) ? 1 : 0;
+
+}
+
+// registers the timerfd of the cerver's timers if they have been created
+// so they are executed by the epoll thread
+static u8 cerver_epoll_register_timers (Cerver *cerver) {
+
+	u8 retval = 0;
+
+	if (cerver->timers) {
+		struct epoll_event event = { 0 };
+		event.events = EPOLLIN;
+		event.data.u64 = cerver_epoll_event_data (
+			cerver->timers->timer_fd, FD_TABLE_INVALID_GENERATION
+		);
+
+		retval = epoll_ctl (
+			cerver->epoll_fd, EPOLL_CTL_ADD, cerver->timers->timer_fd, &event
+		) ? 1 : 0;
+	}
+
+	return retval;
+
+}
+
+// creates the connection's send queue if the cerver is configured to use them
+// connections with a send queue also wait for their socket to be writable
+static u32 cerver_epoll_connection_events (
+	Cerver *cerver, Connection *connection
+) {
+
+	if (cerver->connections_send_queue && !connection->send_queue) {
+		connection_set_send_queue (connection, 0);
+		connection_set_send_queue_high_water (
+			connection,
+			cerver->connections_send_queue_high_water,
+			cerver->connections_send_queue_overflow
+		);
+	}
+
+	return connection->send_queue
+		? (EPOLLIN | EPOLLOUT | EPOLLET) : (EPOLLIN | EPOLLET);
+
+}
+
+// sets the event of a connection that has been registered to the cerver
+// returns 0 on success, 1 if the connection is not in the cerver's fd table
+static u8 cerver_epoll_connection_event (
+	Cerver *cerver, Connection *connection, struct epoll_event *event
+) {
+
+	u8 retval = 1;
+
+	FdTableEntry entry = { 0 };
+	if (
+		!fd_table_get (cerver->fd_table, connection->socket->sock_fd, &entry)
+		&& (entry.connection == connection)
+	) {
+		event->events = cerver_epoll_connection_events (cerver, connection);
+		event->data.u64 = cerver_epoll_event_data (
+			connection->socket->sock_fd, entry.generation
+		);
+
+		retval = 0;
+	}
+
+	return retval;
+
+}
+
+// registers a client connection to the cerver's epoll instance
+// using its sock fd & its fd table generation as the event's data
+// the connection must have already been registered to the cerver
+// returns 0 on success, 1 on error
+u8 cerver_epoll_register_connection (
+	Cerver *cerver, Connection *connection
+) {
+
+	u8 retval = 1;
+
+	if (cerver && connection) {
+		struct epoll_event event = { 0 };
+		if (
+			!cerver_epoll_connection_event (cerver, connection, &event)
+			&& !epoll_ctl (
+				cerver->epoll_fd, EPOLL_CTL_ADD,
+				connection->socket->sock_fd, &event
+			)
+		) {
+			STATS_ADD (cerver->stats->current_active_client_connections, 1);
+
+			#ifdef HANDLER_DEBUG
+			cerver_log (
+				LOG_TYPE_DEBUG, LOG_TYPE_CERVER,
+				"Added sock fd <%d> to cerver %s epoll",
+				connection->socket->sock_fd, cerver->info->name
+			);
+			#endif
+
+			retval = 0;
+		}
+
+		else {
+			cerver_log (
+				LOG_TYPE_ERROR, LOG_TYPE_CERVER,
+				"Failed to add sock fd <%d> to cerver %s epoll!",
+				connection->socket->sock_fd, cerver->info->name
+			);
+		}
+	}
+
+	return retval;
+
+}
+
+// a paused connection keeps waiting for errors & for its socket to be writable
+// but it stops getting new edges for its pending data until it is resumed
+// returns 0 on success, 1 on error
+static u8 cerver_epoll_connection_set_reading (
+	Cerver *cerver, const int epoll_fd,
+	Connection *connection, const bool reading
+) {
+
+	u8 retval = 1;
+
+	struct epoll_event event = { 0 };
+	if (!cerver_epoll_connection_event (cerver, connection, &event)) {
+		if (!reading) event.events &= ~((u32) EPOLLIN);
+
+		retval = epoll_ctl (
+			epoll_fd, EPOLL_CTL_MOD, connection->socket->sock_fd, &event
+		) ? 1 : 0;
+	}
+
+	return retval;
+
+}
+
+// removes a client connection from the cerver's epoll instance
+// returns 0 on success, 1 on error
+u8 cerver_epoll_unregister_connection (
+	Cerver *cerver, Connection *connection
+) {
+
+	u8 retval = 1;
+
+	if (cerver && connection) {
+		if (connection->socket->sock_fd >= 0) {
+			if (!epoll_ctl (
+				cerver->epoll_fd, EPOLL_CTL_DEL,
+				connection->socket->sock_fd, NULL
+			)) {
+				STATS_SUB (cerver->stats->current_active_client_connections, 1);
+
+				#ifdef HANDLER_DEBUG
+				cerver_log (
+					LOG_TYPE_DEBUG, LOG_TYPE_CERVER,
+					"Removed sock fd <%d> from cerver %s epoll",
+					connection->socket->sock_fd, cerver->info->name
+				);
+				#endif
+
+				retval = 0;
+			}
+
+			else {
+				#ifdef HANDLER_DEBUG
+				cerver_log (
+					LOG_TYPE_WARNING, LOG_TYPE_CERVER,
+					"Sock fd <%d> was NOT found in cerver %s epoll!",
+					connection->socket->sock_fd, cerver->info->name
+				);
+				#endif
+			}
+		}
+	}
+
+	return retval;
 
 }
 
-// handles a request made from the client
-static void cerver_request_packet_handler (Packet *packet) {
+// with edge-triggered events we must accept
+// every pending connection until we get EAGAIN
+static inline void cerver_epoll_handle_accept (Cerver *cerver) {
 
-	switch (packet->header.request_type) {
-		// request from a client to get a file
-		case REQUEST_PACKET_TYPE_GET_FILE:
-			cerver_request_get_file (packet);
-			break;
+	struct sockaddr_storage client_address = { 0 };
+	socklen_t socklen = 0;
+	i32 new_fd = 0;
 
-		// request from a client to upload a file
-		case REQUEST_PACKET_TYPE_SEND_FILE:
-			cerver_request_send_file (packet);
-			break;
+	while (cerver->isRunning) {
+		socklen = sizeof (struct sockaddr_storage);
+		new_fd = accept (
+			cerver->sock, (struct sockaddr *) &client_address, &socklen
+		);
 
-		default: {
+		if (new_fd > 0) {
 			#ifdef HANDLER_DEBUG
-			cerver_log (
-				LOG_TYPE_WARNING, LOG_TYPE_HANDLER,
-				"Got an unknown request packet in cerver %s",
-				packet->cerver->info->name
-			);
+			cerver_log_debug ("Accepted fd: %d", new_fd);
 			#endif
-		} break;
+			cerver_register_new_connection (cerver, new_fd, &client_address);
+		}
+
+		else {
+			// if we get EWOULDBLOCK, we have accepted all connections
+			if ((errno != EWOULDBLOCK) && (errno != EAGAIN)) {
+				cerver_log (LOG_TYPE_ERROR, LOG_TYPE_CERVER, "Accept failed!");
+				perror ("Error");
+			}
+
+			break;
+		}
 	}
 
 }
 
-// sends back a test packet to the client!
-void cerver_test_packet_handler (Packet *packet) {
+// reads from the connection until the socket has been drained
+// if the receive budget has been used, the connection is modified
+// in the epoll instance so that a new edge is generated for its pending data
+// the connection's send queue is corked while reading so that
+// the responses to every packet are sent together afterwards
+// returns the number of bytes that were received
+static size_t cerver_epoll_handle_receive (
+	Cerver *cerver, const int epoll_fd, Connection *connection,
+	CerverReceive *cr, char *packet_buffer
+) {
 
-	#ifdef HANDLER_DEBUG
-	cerver_log (
-		LOG_TYPE_DEBUG, LOG_TYPE_PACKET,
-		"Got a test packet in cerver %s.",
-		packet->cerver->info->name
+	cerver_receive_init_full (
+		cr, RECEIVE_TYPE_NORMAL, cerver, connection->client, connection
 	);
-	#endif
 
-	Packet request = {
-		.cerver = packet->cerver,
-		.client = packet->client,
-		.connection = packet->connection,
-		.lobby = packet->lobby,
+	const i32 sock_fd = connection->socket->sock_fd;
+	const bool corked = connection_send_queue_cork (connection);
 
-		.packet_size = sizeof (PacketHeader),
-		.packet = (void *) &packet->header,
-		.packet_ref = true
-	};
+	bool exhausted = false;
+	size_t received = cerver_receive_drain (
+		cr, packet_buffer, cerver->receive_buffer_size, &exhausted
+	);
 
-	(void) packet_send (&request, 0, NULL, false);
+	// the connection might have been dropped while reading
+	if (corked && cerver_receive_is_alive (cr, sock_fd)) {
+		connection_send_queue_uncork (connection);
+	}
+
+	if (exhausted) {
+		struct epoll_event event = { 0 };
+		event.events = cerver_epoll_connection_events (cerver, connection);
+		event.data.u64 = cerver_epoll_event_data (sock_fd, cr->generation);
+
+		(void) epoll_ctl (
+			epoll_fd, EPOLL_CTL_MOD,
+			connection->socket->sock_fd, &event
+		);
+	}
+
+	return received;
 
 }
 
-// handles an PACKET_TYPE_APP packet type
-static void cerver_app_packet_handler (Packet *packet) {
+// handles an event from a registered client connection
+// returns the number of bytes that were received
+static size_t cerver_epoll_handle_connection (
+	Cerver *cerver, const int epoll_fd,
+	const struct epoll_event *event, Connection *connection,
+	CerverReceive *cr, char *packet_buffer
+) {
 
-	if (packet->cerver->multiple_handlers) {
-		// select which handler to use
-		if (packet->header.handler_id < packet->cerver->n_handlers) {
-			if (packet->cerver->handlers[packet->header.handler_id]) {
-				// add the packet to the handler's job queueu to be handled
-				// as soon as the handler is available
-				if (job_queue_push (
-					packet->cerver->handlers[packet->header.handler_id]->job_queue,
-					job_create (NULL, packet)
-				)) {
-					cerver_log_error (
-						"Failed to push a new job to cerver's %s <%d> handler!",
-						packet->cerver->info->name, packet->header.handler_id
-					);
-				}
-			}
-		}
+	size_t received = 0;
+
+	// a disconnection or an asynchronous error
+	// any pending data is discarded as the connection is broken
+	if (event->events & (EPOLLERR | EPOLLHUP)) {
+		cerver_receive_init_full (
+			cr, RECEIVE_TYPE_NORMAL, cerver, connection->client, connection
+		);
+
+		cerver_receive_handle_failed (cr);
 	}
 
 	else {
-		if (packet->cerver->app_packet_handler) {
-			if (packet->cerver->app_packet_handler->direct_handle) {
-				// printf ("app_packet_handler - direct handle!\n");
-				packet->cerver->app_packet_handler->handler (packet);
-				if (packet->cerver->app_packet_handler_delete_packet)
-					packet_delete (packet);
+		// the socket can take the data that is waiting in the queue
+		if ((event->events & EPOLLOUT) && connection->send_queue) {
+			(void) connection_send_queue_flush (connection);
+		}
+
+		if (event->events & EPOLLIN) {
+			received = cerver_epoll_handle_receive (
+				cerver, epoll_fd, connection, cr, packet_buffer
+			);
+		}
+	}
+
+	return received;
+
+}
+
+static inline void cerver_epoll_handle (
+	Cerver *cerver,
+	const struct epoll_event *events, const int n_events,
+	CerverReceive *cr, char *packet_buffer
+) {
+
+	// only the fds that are ready are returned
+	// a previous event might have dropped the connection
+	Connection *connection = NULL;
+	for (int idx = 0; idx < n_events; idx++) {
+		if (cerver_epoll_event_is_internal (events[idx].data.u64)) {
+			// the cerver's sock fd has an event
+			if ((i32) (u32) events[idx].data.u64 == cerver->sock) {
+				cerver_epoll_handle_accept (cerver);
 			}
 
+			// some of the cerver's timers have expired
 			else {
-				// add the packet to the handler's job queueu to be handled
-				// as soon as the handler is available
-				if (job_queue_push (
-					packet->cerver->app_packet_handler->job_queue,
-					job_create (NULL, packet)
-				)) {
-					cerver_log_error (
-						"Failed to push a new job to cerver's %s app_packet_handler!",
-						packet->cerver->info->name
-					);
-				}
+				timer_wheel_handle (cerver->timers);
 			}
 		}
 
 		else {
-			cerver_log_warning (
-				"Cerver %s does not have an app_packet_handler!",
-				packet->cerver->info->name
+			connection = cerver_epoll_event_connection (
+				cerver, events[idx].data.u64
 			);
+
+			if (connection) {
+				(void) cerver_epoll_handle_connection (
+					cerver, cerver->epoll_fd,
+					&events[idx], connection, cr, packet_buffer
+				);
+			}
 		}
 	}
 
 }
 
-// handles an PACKET_TYPE_APP_ERROR packet type
-static void cerver_app_error_packet_handler (Packet *packet) {
+// server epoll loop to handle events in the registered connections
+// using edge-triggered notifications
+u8 cerver_epoll (Cerver *cerver) {
 
-	if (packet->cerver->app_error_packet_handler) {
-		if (packet->cerver->app_error_packet_handler->direct_handle) {
-			// printf ("app_error_packet_handler - direct handle!\n");
-			packet->cerver->app_error_packet_handler->handler (packet);
-			if (packet->cerver->app_error_packet_handler_delete_packet)
-				packet_delete (packet);
-		}
+	u8 retval = 1;
 
-		else {
-			// add the packet to the handler's job queueu to be handled
-			// as soon as the handler is available
-			if (job_queue_push (
-				packet->cerver->app_error_packet_handler->job_queue,
-				job_create (NULL, packet)
-			)) {
+	if (cerver) {
+		if (
+			!cerver_epoll_register_sock (cerver)
+			&& !cerver_epoll_register_timers (cerver)
+		) {
+			cerver_log (
+				LOG_TYPE_SUCCESS, LOG_TYPE_CERVER,
+				"Cerver %s is ready in port %d!",
+				cerver->info->name, cerver->port
+			);
+
+			#ifdef CERVER_DEBUG
+			cerver_log (
+				LOG_TYPE_DEBUG, LOG_TYPE_CERVER,
+				"Waiting for connections..."
+			);
+			#endif
+
+			char *packet_buffer = (char *) calloc (
+				cerver->receive_buffer_size, sizeof (char)
+			);
+
+			if (packet_buffer) {
+				CerverReceive cr = { 0 };
+
+				struct epoll_event events[CERVER_DEFAULT_EPOLL_MAX_EVENTS];
+
+				int n_events = 0;
+				while (cerver->isRunning) {
+					n_events = epoll_wait (
+						cerver->epoll_fd,
+						events, CERVER_DEFAULT_EPOLL_MAX_EVENTS,
+						cerver->poll_timeout
+					);
+
+					switch (n_events) {
+						case -1: {
+							// interrupted by a signal, try again
+							if (errno == EINTR) break;
+
+							cerver_log (
+								LOG_TYPE_ERROR, LOG_TYPE_CERVER,
+								"Cerver %s main epoll has failed!",
+								cerver->info->name
+							);
+
+							perror ("Error");
+							cerver->isRunning = false;
+						} break;
+
+						case 0: break;
+
+						default: {
+							cerver_epoll_handle (
+								cerver,
+								events, n_events,
+								&cr, packet_buffer
+							);
+						} break;
+					}
+				}
+
+				#ifdef CERVER_DEBUG
+				cerver_log (
+					LOG_TYPE_CERVER, LOG_TYPE_NONE,
+					"Cerver %s main epoll has stopped!",
+					cerver->info->name
+				);
+				#endif
+
+				free (packet_buffer);
+
+				retval = 0;
+			}
+
+			else {
 				cerver_log_error (
-					"Failed to push a new job to cerver's %s app_error_packet_handler!",
-					packet->cerver->info->name
+					"Failed to allocate cerver epoll's packet buffer!"
 				);
 			}
 		}
+
+		else {
+			cerver_log (
+				LOG_TYPE_ERROR, LOG_TYPE_CERVER,
+				"Failed to register cerver %s socket & timers to epoll!",
+				cerver->info->name
+			);
+		}
 	}
 
 	else {
-		cerver_log_warning (
-			"Cerver %s does not have an app_error_packet_handler!",
-			packet->cerver->info->name
+		cerver_log (
+			LOG_TYPE_ERROR, LOG_TYPE_CERVER,
+			"Can't listen for connections on a NULL cerver!"
 		);
 	}
 
+	return retval;
+
 }
 
-// handles a PACKET_TYPE_CUSTOM packet type
-static void cerver_custom_packet_handler (Packet *packet) {
+// adds or removes the read interest of a connection
+// that is registered to a CERVER_HANDLER_TYPE_POLL, CERVER_HANDLER_TYPE_EPOLL
+// or CERVER_HANDLER_TYPE_REACTORS cerver
+// returns 0 on success, 1 on error
+u8 cerver_handler_connection_set_reading (
+	Cerver *cerver, Connection *connection, const bool reading
+) {
 
-	if (packet->cerver->custom_packet_handler) {
-		if (packet->cerver->custom_packet_handler->direct_handle) {
-			// printf ("custom_packet_handler - direct handle!\n");
-			packet->cerver->custom_packet_handler->handler (packet);
-			if (packet->cerver->custom_packet_handler_delete_packet)
-				packet_delete (packet);
-		}
+	u8 retval = 1;
 
-		else {
-			// add the packet to the handler's job queueu to be handled
-			// as soon as the handler is available
-			if (job_queue_push (
-				packet->cerver->custom_packet_handler->job_queue,
-				job_create (NULL, packet)
-			)) {
-				cerver_log_error (
-					"Failed to push a new job to cerver's %s custom_packet_handler!",
-					packet->cerver->info->name
+	switch (cerver->handler_type) {
+		case CERVER_HANDLER_TYPE_POLL:
+			retval = cerver_poll_connection_set_reading (
+				cerver, connection, reading
+			);
+			break;
+
+		case CERVER_HANDLER_TYPE_EPOLL:
+			retval = cerver_epoll_connection_set_reading (
+				cerver, cerver->epoll_fd, connection, reading
+			);
+			break;
+
+		case CERVER_HANDLER_TYPE_REACTORS:
+			if (connection->reactor) {
+				retval = cerver_epoll_connection_set_reading (
+					cerver, connection->reactor->epoll_fd, connection, reading
 				);
 			}
-		}
+			break;
+
+		default: break;
 	}
 
-	else {
-		cerver_log_warning (
-			"Cerver %s does not have a custom_packet_handler!",
-			packet->cerver->info->name
-		);
+	return retval;
+
+}
+
+#pragma endregion
+
+#pragma region reactors
+
+CerverReactor *cerver_reactor_new (void) {
+
+	CerverReactor *reactor = (CerverReactor *) malloc (sizeof (CerverReactor));
+	if (reactor) {
+		reactor->id = 0;
+		reactor->thread_id = 0;
+		reactor->running = false;
+
+		reactor->cpu = -1;
+		thread_affinity_init (&reactor->affinity, THREAD_AFFINITY_NONE);
+
+		reactor->epoll_fd = -1;
+		reactor->pending_fds[0] = -1;
+		reactor->pending_fds[1] = -1;
+
+		reactor->packet_buffer = NULL;
+
+		reactor->cerver = NULL;
+
+		reactor->lock = NULL;
+		(void) memset (&reactor->stats, 0, sizeof (CerverReactorStats));
+	}
+
+	return reactor;
+
+}
+
+void cerver_reactor_delete (void *reactor_ptr) {
+
+	if (reactor_ptr) {
+		CerverReactor *reactor = (CerverReactor *) reactor_ptr;
+
+		if (reactor->epoll_fd >= 0) (void) close (reactor->epoll_fd);
+		if (reactor->pending_fds[0] >= 0) (void) close (reactor->pending_fds[0]);
+		if (reactor->pending_fds[1] >= 0) (void) close (reactor->pending_fds[1]);
+
+		if (reactor->packet_buffer) free (reactor->packet_buffer);
+
+		thread_mutex_delete (reactor->lock);
+
+		free (reactor_ptr);
+	}
+
+}
+
+static CerverReactor *cerver_reactor_create (
+	Cerver *cerver, const unsigned int id
+) {
+
+	CerverReactor *reactor = cerver_reactor_new ();
+	if (reactor) {
+		reactor->id = id;
+		reactor->cerver = cerver;
+
+		reactor->lock = thread_mutex_new ();
 	}
 
+	return reactor;
+
 }
 
-static CerverHandlerError cerver_packet_handler_check_version (
-	Packet *packet
-) {
+// creates the cerver's reactors structures
+// the reactors will be started when the cerver starts
+// returns 0 on success, 1 on error
+u8 cerver_reactors_create (Cerver *cerver, unsigned int n_reactors) {
 
-	CerverHandlerError error = CERVER_HANDLER_ERROR_NONE;
+	u8 retval = 1;
 
-	// we expect the packet version in the packet's data
-	if (packet->data) {
-		(void) memcpy (&packet->version, packet->data_ptr, sizeof (PacketVersion));
-		packet->data_ptr += sizeof (PacketVersion);
-		
-		// TODO: return errors to client
-		// TODO: drop client on max bad packets
-		if (packet_check (packet)) {
-			error = CERVER_HANDLER_ERROR_PACKET;
+	if (cerver) {
+		// use one reactor per online cpu
+		if (!n_reactors) {
+			long n_cpus = sysconf (_SC_NPROCESSORS_ONLN);
+			n_reactors = (n_cpus > 0) ? (unsigned int) n_cpus : 1;
 		}
-	}
 
-	else {
-		cerver_log_error (
-			"cerver_packet_handler () - No packet version to check!"
+		cerver->reactors = (CerverReactor **) calloc (
+			n_reactors, sizeof (CerverReactor *)
 		);
-		
-		// TODO: add to bad packets count
 
-		error = CERVER_HANDLER_ERROR_PACKET;
+		if (cerver->reactors) {
+			cerver->n_reactors = n_reactors;
+			cerver->next_reactor = 0;
+
+			u8 errors = 0;
+			for (unsigned int idx = 0; idx < n_reactors; idx++) {
+				cerver->reactors[idx] = cerver_reactor_create (cerver, idx);
+				if (!cerver->reactors[idx]) errors |= 1;
+			}
+
+			retval = errors;
+		}
+
+		if (retval) {
+			cerver_log (
+				LOG_TYPE_ERROR, LOG_TYPE_CERVER,
+				"Failed to create cerver %s reactors!",
+				cerver->info->name
+			);
+		}
 	}
 
-	return error;
+	return retval;
 
 }
 
-static CerverHandlerError cerver_packet_handler_actual (
-	Packet *packet
+// closes the connection's socket & returns it to the cerver's pool
+// used for connections that never reached their reactor
+static void cerver_reactor_connection_discard (
+	Cerver *cerver, Connection *connection
 ) {
 
-	CerverHandlerError error = CERVER_HANDLER_ERROR_NONE;
+	(void) close (connection->socket->sock_fd);
+	connection->socket->sock_fd = -1;
 
-	switch (packet->header.packet_type) {
-		case PACKET_TYPE_NONE: break;
+	connection_drop (cerver, connection);
 
-		case PACKET_TYPE_CERVER: break;
+}
 
-		case PACKET_TYPE_CLIENT: {
-			packet->cerver->stats->received_packets->n_client_packets += 1;
-			#ifdef CLIENT_STATS
-			packet->client->stats->received_packets->n_client_packets += 1;
-			#endif
-			#ifdef CONNECTION_STATS
-			packet->connection->stats->received_packets->n_client_packets += 1;
-			#endif
-			if (packet->lobby) packet->lobby->stats->received_packets->n_client_packets += 1;
-			error = cerver_client_packet_handler (packet);
-			packet_delete (packet);
-		} break;
+// drops any connection that is still waiting in the reactor's pipe
+static void cerver_reactor_discard_pending (CerverReactor *reactor) {
 
-		// handles an error from the client
-		case PACKET_TYPE_ERROR: {
-			packet->cerver->stats->received_packets->n_error_packets += 1;
-			#ifdef CLIENT_STATS
-			packet->client->stats->received_packets->n_error_packets += 1;
-			#endif
-			#ifdef CONNECTION_STATS
-			packet->connection->stats->received_packets->n_error_packets += 1;
-			#endif
-			if (packet->lobby) packet->lobby->stats->received_packets->n_error_packets += 1;
-			cerver_error_packet_handler (packet);
-			packet_delete (packet);
-		} break;
+	if (reactor->pending_fds[0] >= 0) {
+		Connection *connection = NULL;
+		while (
+			read (
+				reactor->pending_fds[0], &connection, sizeof (Connection *)
+			) == sizeof (Connection *)
+		) {
+			cerver_reactor_connection_discard (reactor->cerver, connection);
+		}
+	}
 
-		// handles a request made from the client
-		case PACKET_TYPE_REQUEST: {
-			packet->cerver->stats->received_packets->n_request_packets += 1;
-			#ifdef CLIENT_STATS
-			packet->client->stats->received_packets->n_request_packets += 1;
-			#endif
-			#ifdef CONNECTION_STATS
-			packet->connection->stats->received_packets->n_request_packets += 1;
-			#endif
-			if (packet->lobby) packet->lobby->stats->received_packets->n_request_packets += 1;
-			cerver_request_packet_handler (packet);
-			packet_delete (packet);
-		} break;
+}
 
-		// handles authentication packets
-		case PACKET_TYPE_AUTH: {
-			packet->cerver->stats->received_packets->n_auth_packets += 1;
-			#ifdef CLIENT_STATS
-			packet->client->stats->received_packets->n_auth_packets += 1;
-			#endif
-			#ifdef CONNECTION_STATS
-			packet->connection->stats->received_packets->n_auth_packets += 1;
-			#endif
-			if (packet->lobby) packet->lobby->stats->received_packets->n_auth_packets += 1;
-			/* TODO: */
-			packet_delete (packet);
-		} break;
+// stops every reactor thread & cleans up their structures
+void cerver_reactors_end (Cerver *cerver) {
 
-		// handles a game packet sent from the client
-		case PACKET_TYPE_GAME: {
-			packet->cerver->stats->received_packets->n_game_packets += 1;
-			#ifdef CLIENT_STATS
-			packet->client->stats->received_packets->n_game_packets += 1;
-			#endif
-			#ifdef CONNECTION_STATS
-			packet->connection->stats->received_packets->n_game_packets += 1;
-			#endif
-			if (packet->lobby) packet->lobby->stats->received_packets->n_game_packets += 1;
-			game_packet_handler (packet);
-		} break;
+	if (cerver) {
+		if (cerver->reactors) {
+			CerverReactor *reactor = NULL;
 
-		// user set handler to handle app specific packets
-		case PACKET_TYPE_APP: {
-			packet->cerver->stats->received_packets->n_app_packets += 1;
-			#ifdef CLIENT_STATS
-			packet->client->stats->received_packets->n_app_packets += 1;
-			#endif
-			#ifdef CONNECTION_STATS
-			packet->connection->stats->received_packets->n_app_packets += 1;
-			#endif
-			if (packet->lobby) packet->lobby->stats->received_packets->n_app_packets += 1;
-			cerver_app_packet_handler (packet);
-		} break;
+			// first signal every reactor to stop
+			for (unsigned int idx = 0; idx < cerver->n_reactors; idx++) {
+				if (cerver->reactors[idx])
+					cerver->reactors[idx]->running = false;
+			}
 
-		// user set handler to handle app specific errors
-		case PACKET_TYPE_APP_ERROR: {
-			packet->cerver->stats->received_packets->n_app_error_packets += 1;
-			#ifdef CLIENT_STATS
-			packet->client->stats->received_packets->n_app_error_packets += 1;
-			#endif
-			#ifdef CONNECTION_STATS
-			packet->connection->stats->received_packets->n_app_error_packets += 1;
-			#endif
-			if (packet->lobby) packet->lobby->stats->received_packets->n_app_error_packets += 1;
-			cerver_app_error_packet_handler (packet);
-		} break;
+			for (unsigned int idx = 0; idx < cerver->n_reactors; idx++) {
+				reactor = cerver->reactors[idx];
+				if (reactor) {
+					if (reactor->thread_id) {
+						(void) pthread_join (reactor->thread_id, NULL);
+						reactor->thread_id = 0;
+					}
 
-		// custom packet hanlder
-		case PACKET_TYPE_CUSTOM: {
-			packet->cerver->stats->received_packets->n_custom_packets += 1;
-			#ifdef CLIENT_STATS
-			packet->client->stats->received_packets->n_custom_packets += 1;
-			#endif
-			#ifdef CONNECTION_STATS
-			packet->connection->stats->received_packets->n_custom_packets += 1;
-			#endif
-			if (packet->lobby) packet->lobby->stats->received_packets->n_custom_packets += 1;
-			cerver_custom_packet_handler (packet);
-		} break;
+					cerver_reactor_discard_pending (reactor);
 
-		// acknowledge the client we have received his test packet
-		case PACKET_TYPE_TEST: {
-			packet->cerver->stats->received_packets->n_test_packets += 1;
-			#ifdef CLIENT_STATS
-			packet->client->stats->received_packets->n_test_packets += 1;
-			#endif
-			#ifdef CONNECTION_STATS
-			packet->connection->stats->received_packets->n_test_packets += 1;
-			#endif
-			if (packet->lobby) packet->lobby->stats->received_packets->n_test_packets += 1;
-			cerver_test_packet_handler (packet);
-			packet_delete (packet);
-		} break;
+					cerver_reactor_delete (reactor);
+				}
+			}
 
-		default: {
-			packet->cerver->stats->received_packets->n_bad_packets += 1;
-			#ifdef CLIENT_STATS
-			packet->client->stats->received_packets->n_bad_packets += 1;
-			#endif
-			#ifdef CONNECTION_STATS
-			packet->connection->stats->received_packets->n_bad_packets += 1;
-			#endif
-			if (packet->lobby) packet->lobby->stats->received_packets->n_bad_packets += 1;
+			free (cerver->reactors);
+			cerver->reactors = NULL;
+		}
+	}
+
+}
+
+// registers a client connection to its reactor's epoll instance
+// using its sock fd & its fd table generation as the event's data
+// if the connection has no reactor, the next one will be used
+// returns 0 on success, 1 on error
+u8 cerver_reactors_register_connection (
+	Cerver *cerver, Connection *connection
+) {
+
+	u8 retval = 1;
+
+	if (cerver && connection && cerver->reactors) {
+		// connections that were not handed by the acceptor
+		// are always mapped to the same reactor by their sock fd
+		if (!connection->reactor) {
+			connection->reactor = cerver->reactors[
+				(u32) connection->socket->sock_fd % cerver->n_reactors
+			];
+		}
+
+		CerverReactor *reactor = connection->reactor;
+
+		struct epoll_event event = { 0 };
+		if (
+			!cerver_epoll_connection_event (cerver, connection, &event)
+			&& !epoll_ctl (
+				reactor->epoll_fd, EPOLL_CTL_ADD,
+				connection->socket->sock_fd, &event
+			)
+		) {
+			thread_mutex_lock (reactor->lock);
+			reactor->stats.current_active_client_connections++;
+			reactor->stats.total_client_connections++;
+			thread_mutex_unlock (reactor->lock);
 
 			#ifdef HANDLER_DEBUG
 			cerver_log (
-				LOG_TYPE_WARNING, LOG_TYPE_PACKET,
-				"Got a packet of unknown type in cerver %s.",
-				packet->cerver->info->name
+				LOG_TYPE_DEBUG, LOG_TYPE_CERVER,
+				"Added sock fd <%d> to cerver %s reactor %u",
+				connection->socket->sock_fd, cerver->info->name, reactor->id
 			);
 			#endif
 
-			packet_delete (packet);
-		} break;
+			retval = 0;
+		}
+
+		else {
+			cerver_log (
+				LOG_TYPE_ERROR, LOG_TYPE_CERVER,
+				"Failed to add sock fd <%d> to cerver %s reactor %u!",
+				connection->socket->sock_fd, cerver->info->name, reactor->id
+			);
+		}
 	}
 
-	return error;
+	return retval;
 
 }
 
-// handle packet based on type
-static u8 cerver_packet_handler (Packet *packet) {
+// removes a client connection from its reactor's epoll instance
+// returns 0 on success, 1 on error
+u8 cerver_reactors_unregister_connection (
+	Cerver *cerver, Connection *connection
+) {
 
 	u8 retval = 1;
 
-	CerverHandlerError error = CERVER_HANDLER_ERROR_NONE;
-	if (packet->cerver->check_packets) {
-		if (!cerver_packet_handler_check_version (packet)) {
-			error = cerver_packet_handler_actual (packet);
-		}
-	}
+	if (cerver && connection && cerver->reactors) {
+		CerverReactor *reactor = connection->reactor;
+		if (reactor && (connection->socket->sock_fd >= 0)) {
+			if (!epoll_ctl (
+				reactor->epoll_fd, EPOLL_CTL_DEL,
+				connection->socket->sock_fd, NULL
+			)) {
+				thread_mutex_lock (reactor->lock);
+				reactor->stats.current_active_client_connections--;
+				thread_mutex_unlock (reactor->lock);
 
-	else {
-		error = cerver_packet_handler_actual (packet);
-	}
+				#ifdef HANDLER_DEBUG
+				cerver_log (
+					LOG_TYPE_DEBUG, LOG_TYPE_CERVER,
+					"Removed sock fd <%d> from cerver %s reactor %u",
+					connection->socket->sock_fd, cerver->info->name, reactor->id
+				);
+				#endif
 
-	switch (error) {
-		case CERVER_HANDLER_ERROR_NONE:
-			retval = 0;
-			break;
+				retval = 0;
+			}
 
-		default: break;
+			else {
+				#ifdef HANDLER_DEBUG
+				cerver_log (
+					LOG_TYPE_WARNING, LOG_TYPE_CERVER,
+					"Sock fd <%d> was NOT found in cerver %s reactor %u!",
+					connection->socket->sock_fd, cerver->info->name, reactor->id
+				);
+				#endif
+			}
+		}
 	}
 
 	return retval;
 
 }
 
-static u8 cerver_packet_select_handler (
-	ReceiveHandle *receive_handle, Packet *packet
-) {
-
-	u8 retval = 1;
+// registers every connection that the acceptor has handed to the reactor
+static void cerver_reactor_handle_pending (CerverReactor *reactor) {
 
-	switch (receive_handle->type) {
-		case RECEIVE_TYPE_NONE: break;
+	Connection *connection = NULL;
+	while (
+		read (
+			reactor->pending_fds[0], &connection, sizeof (Connection *)
+		) == sizeof (Connection *)
+	) {
+		cerver_register_new_connection_actual (reactor->cerver, connection);
+	}
 
-		case RECEIVE_TYPE_NORMAL: {
-			packet->cerver = receive_handle->cerver;
-			packet->client = receive_handle->client;
-			packet->connection = receive_handle->connection;
+}
 
-			packet->cerver->stats->client_n_packets_received += 1;
-			packet->cerver->stats->total_n_packets_received += 1;
+// the reactor's own epoll loop
+// it only handles the connections that have been registered to it
+static void *cerver_reactor_loop (void *reactor_ptr) {
 
-			#ifdef CLIENT_STATS
-			packet->client->stats->n_packets_received += 1;
-			#endif
-			#ifdef CONNECTION_STATS
-			packet->connection->stats->n_packets_received += 1;
-			#endif
+	CerverReactor *reactor = (CerverReactor *) reactor_ptr;
+	Cerver *cerver = reactor->cerver;
 
-			if (packet->lobby) packet->lobby->stats->n_packets_received += 1;
+	char thread_name[THREAD_NAME_BUFFER_SIZE] = { 0 };
+	(void) snprintf (
+		thread_name, THREAD_NAME_BUFFER_SIZE,
+		"%s-reactor-%u", cerver->info->alias, reactor->id
+	);
 
-			retval = cerver_packet_handler (packet);
-		} break;
+	(void) thread_set_name ("%s", thread_name);
 
-		case RECEIVE_TYPE_ON_HOLD: {
-			packet->cerver = receive_handle->cerver;
-			packet->connection = receive_handle->connection;
+	// the packet buffer is first touched in the reactor's node
+	(void) thread_affinity_apply (&reactor->affinity, 0, thread_name);
+	reactor->packet_buffer = (char *) calloc (
+		cerver->receive_buffer_size, sizeof (char)
+	);
 
-			packet->cerver->stats->on_hold_n_packets_received += 1;
-			packet->connection->stats->n_packets_received += 1;
+	if (!reactor->packet_buffer) {
+		cerver_log (
+			LOG_TYPE_ERROR, LOG_TYPE_CERVER,
+			"Failed to allocate cerver %s reactor %u packet buffer!",
+			cerver->info->name, reactor->id
+		);
 
-			retval = on_hold_packet_handler (packet);
-		} break;
+		reactor->running = false;
+	}
 
-		case RECEIVE_TYPE_ADMIN: {
-			packet->cerver = receive_handle->cerver;
-			packet->connection = receive_handle->connection;
-			packet->client = receive_handle->admin->client;
+	struct epoll_event events[CERVER_DEFAULT_EPOLL_MAX_EVENTS];
 
-			packet->cerver->admin->stats->total_n_packets_received += 1;
+	CerverReceive cr = { 0 };
 
-			receive_handle->admin->client->stats->n_packets_received += 1;
+	Connection *connection = NULL;
+	size_t received = 0;
+	int n_events = 0;
+	while (cerver->isRunning && reactor->running) {
+		n_events = epoll_wait (
+			reactor->epoll_fd,
+			events, CERVER_DEFAULT_EPOLL_MAX_EVENTS,
+			cerver->poll_timeout
+		);
 
-			packet->connection->stats->n_packets_received += 1;
+		switch (n_events) {
+			case -1: {
+				// interrupted by a signal, try again
+				if (errno == EINTR) break;
 
-			retval = admin_packet_handler (packet);
-		} break;
+				cerver_log (
+					LOG_TYPE_ERROR, LOG_TYPE_CERVER,
+					"Cerver %s reactor %u epoll has failed!",
+					cerver->info->name, reactor->id
+				);
 
-		default: break;
-	}
+				perror ("Error");
+				reactor->running = false;
+			} break;
 
-	return retval;
+			case 0: break;
 
-}
+			default: {
+				received = 0;
+				for (int idx = 0; idx < n_events; idx++) {
+					// the acceptor has handed new connections
+					if (cerver_epoll_event_is_internal (events[idx].data.u64)) {
+						cerver_reactor_handle_pending (reactor);
+					}
 
-#pragma endregion
+					else {
+						// a previous event might have dropped the connection
+						connection = cerver_epoll_event_connection (
+							cerver, events[idx].data.u64
+						);
 
-#pragma region receive
+						if (connection) {
+							received += cerver_epoll_handle_connection (
+								cerver, reactor->epoll_fd,
+								&events[idx], connection,
+								&cr, reactor->packet_buffer
+							);
+						}
+					}
+				}
 
-u8 cerver_poll_unregister_sock_fd (Cerver *cerver, const i32 sock_fd);
+				// only updated by the reactor itself
+				reactor->stats.n_wakeups++;
+				reactor->stats.n_events += (u64) n_events;
+				reactor->stats.bytes_received += received;
+			} break;
+		}
+	}
 
-CerverReceive *cerver_receive_new (void) {
+	#ifdef CERVER_DEBUG
+	cerver_log (
+		LOG_TYPE_CERVER, LOG_TYPE_NONE,
+		"Cerver %s reactor %u has stopped!",
+		cerver->info->name, reactor->id
+	);
+	#endif
 
-	CerverReceive *cr = (CerverReceive *) malloc (sizeof (CerverReceive));
-	if (cr) {
-		cr->type = RECEIVE_TYPE_NONE;
+	return NULL;
 
-		cr->cerver = NULL;
+}
 
-		cr->socket = NULL;
-		cr->connection = NULL;
-		cr->client = NULL;
-		cr->admin = NULL;
+// creates the reactor's epoll instance & pipe
+// and starts its dedicated thread that allocates its packet buffer
+// returns 0 on success, 1 on error
+static u8 cerver_reactor_start (CerverReactor *reactor) {
 
-		cr->lobby = NULL;
-	}
+	u8 retval = 1;
 
-	return cr;
+	Cerver *cerver = reactor->cerver;
 
-}
+	reactor->epoll_fd = epoll_create1 (EPOLL_CLOEXEC);
 
-void cerver_receive_delete (void *ptr) { if (ptr) free (ptr); }
+	if (
+		(reactor->epoll_fd >= 0)
+		&& !pipe2 (reactor->pending_fds, O_CLOEXEC)
+	) {
+		// the acceptor blocks if the reactor falls behind,
+		// but the reactor must never block reading from the pipe
+		(void) fcntl (reactor->pending_fds[0], F_SETFL, O_NONBLOCK);
+
+		struct epoll_event event = { 0 };
+		event.events = EPOLLIN | EPOLLET;
+		event.data.u64 = cerver_epoll_event_data (
+			reactor->pending_fds[0], FD_TABLE_INVALID_GENERATION
+		);
 
-static inline void cerver_receive_create_normal (
-	CerverReceive *cr,
-	Cerver *cerver, const i32 sock_fd
-) {
+		if (!epoll_ctl (
+			reactor->epoll_fd, EPOLL_CTL_ADD, reactor->pending_fds[0], &event
+		)) {
+			reactor->running = true;
+			if (!pthread_create (
+				&reactor->thread_id, NULL, cerver_reactor_loop, reactor
+			)) {
+				retval = 0;
+			}
 
-	cr->client = client_get_by_sock_fd (cerver, sock_fd);
-	if (cr->client) {
-		cr->connection = connection_get_by_sock_fd_from_client (cr->client, sock_fd);
-		if (cr->connection) {
-			cr->socket = cr->connection->socket;
+			else {
+				reactor->running = false;
+				reactor->thread_id = 0;
+			}
 		}
 	}
 
-	// for what ever reason we have a rogue connection
-	else {
-		// #ifdef CERVER_DEBUG
-		cerver_log_error (
-			"cerver_receive_create () - RECEIVE_TYPE_NORMAL - no client with sock fd <%d>",
-			sock_fd
+	if (retval) {
+		cerver_log (
+			LOG_TYPE_ERROR, LOG_TYPE_CERVER,
+			"Failed to start cerver %s reactor %u!",
+			cerver->info->name, reactor->id
 		);
-		// #endif
-
-		// remove the sock fd from the cerver's main poll array
-		cerver_poll_unregister_sock_fd (cerver, sock_fd);
 
-		// try to remove the sock fd from the cerver's map
-		const void *key = &sock_fd;
-		htab_remove (cerver->client_sock_fd_map, key, sizeof (i32));
-
-		close (sock_fd);        // just close the socket
+		perror ("Error");
 	}
 
+	return retval;
+
 }
 
-static inline void cerver_receive_create_on_hold (
-	CerverReceive *cr,
-	Cerver *cerver, const i32 sock_fd
+// hands the new connection to the next reactor
+// returns 0 on success, 1 on error
+static u8 cerver_reactors_handoff (
+	Cerver *cerver,
+	const i32 new_fd, const struct sockaddr_storage *client_address
 ) {
 
-	cr->connection = connection_get_by_sock_fd_from_on_hold (cerver, sock_fd);
-	if (cr->connection) {
-		cr->socket = cr->connection->socket;
-	}
+	u8 retval = 1;
 
-	// for what ever reason we have a rogue connection
-	else {
-		// #ifdef CERVER_DEBUG
-		cerver_log_error (
-			"cerver_receive_create () - RECEIVE_TYPE_ON_HOLD - no connection with sock fd <%d>",
-			sock_fd
-		);
-		// #endif
+	Connection *connection = cerver_connection_create (
+		cerver, new_fd, client_address
+	);
 
-		// remove the sock fd from the cerver's on hold poll array
-		on_hold_poll_unregister_sock_fd (cerver, sock_fd);
+	if (connection) {
+		CerverReactor *reactor = cerver->reactors[
+			cerver->next_reactor++ % cerver->n_reactors
+		];
 
-		close (sock_fd);        // just close the socket
-	}
+		connection->reactor = reactor;
 
-}
+		if (write (
+			reactor->pending_fds[1], &connection, sizeof (Connection *)
+		) == sizeof (Connection *)) {
+			retval = 0;
+		}
 
-static inline void cerver_receive_create_admin (
-	CerverReceive *cr,
-	Cerver *cerver, const i32 sock_fd
-) {
+		else {
+			cerver_log (
+				LOG_TYPE_ERROR, LOG_TYPE_CERVER,
+				"Failed to hand sock fd <%d> to cerver %s reactor %u!",
+				new_fd, cerver->info->name, reactor->id
+			);
 
-	cr->admin = admin_get_by_sock_fd (cerver->admin, sock_fd);
-	if (cr->admin) {
-		cr->client = cr->admin->client;
-		cr->connection = connection_get_by_sock_fd_from_client (cr->client, sock_fd);
-		if (cr->connection) {
-			cr->socket = cr->connection->socket;
+			cerver_reactor_connection_discard (cerver, connection);
 		}
 	}
 
-	// for what ever reason we have a rogue connection
 	else {
-		// #ifdef ADMIN_DEBUG
-		cerver_log_error (
-			"cerver_receive_create () - RECEIVE_TYPE_ADMIN - no admin with sock fd <%d>",
-			sock_fd
+		cerver_log (
+			LOG_TYPE_ERROR, LOG_TYPE_CLIENT,
+			"cerver_reactors_handoff () - failed to create a new connection!"
 		);
-		// #endif
-
-		// remove the sock fd from the cerver's admin poll array
-		admin_cerver_poll_unregister_sock_fd (cerver->admin, sock_fd);
 
-		close (sock_fd);        // just close the socket
+		(void) close (new_fd);
 	}
 
-}
-
-CerverReceive *cerver_receive_create (
-	ReceiveType receive_type,
-	Cerver *cerver, const i32 sock_fd
-) {
+	return retval;
 
-	CerverReceive *cr = cerver_receive_new ();
-	if (cr) {
-		cr->type = receive_type;
+}
 
-		cr->cerver = cerver;
+// accepts every pending connection until we get EAGAIN
+static inline void cerver_reactors_handle_accept (Cerver *cerver) {
 
-		switch (cr->type) {
-			case RECEIVE_TYPE_NONE: break;
+	struct sockaddr_storage client_address = { 0 };
+	socklen_t socklen = 0;
+	i32 new_fd = 0;
 
-			case RECEIVE_TYPE_NORMAL:
-				cerver_receive_create_normal (cr, cerver, sock_fd);
-				break;
+	while (cerver->isRunning) {
+		socklen = sizeof (struct sockaddr_storage);
+		new_fd = accept (
+			cerver->sock, (struct sockaddr *) &client_address, &socklen
+		);
 
-			case RECEIVE_TYPE_ON_HOLD:
-				cerver_receive_create_on_hold (cr, cerver, sock_fd);
-				break;
+		if (new_fd > 0) {
+			#ifdef HANDLER_DEBUG
+			cerver_log_debug ("Accepted fd: %d", new_fd);
+			#endif
+			(void) cerver_reactors_handoff (cerver, new_fd, &client_address);
+		}
 
-			case RECEIVE_TYPE_ADMIN:
-				cerver_receive_create_admin (cr, cerver, sock_fd);
-				break;
+		else {
+			// if we get EWOULDBLOCK, we have accepted all connections
+			if ((errno != EWOULDBLOCK) && (errno != EAGAIN)) {
+				cerver_log (LOG_TYPE_ERROR, LOG_TYPE_CERVER, "Accept failed!");
+				perror ("Error");
+			}
 
-			default: break;
+			break;
 		}
 	}
 
-	return cr;
-
 }
 
-CerverReceive *cerver_receive_create_full (
-	ReceiveType receive_type,
-	Cerver *cerver,
-	Client *client, Connection *connection
-) {
-
-	CerverReceive *cr = cerver_receive_new ();
-	if (cr) {
-		cr->type = receive_type;
+// the acceptor loop that runs in the cerver's main thread
+static void cerver_reactors_acceptor (Cerver *cerver) {
 
-		cr->cerver = cerver;
+	struct pollfd sock_fd = { 0 };
+	sock_fd.fd = cerver->sock;
+	sock_fd.events = POLLIN;
 
-		cr->socket = connection ? connection->socket : NULL;
-		cr->connection = connection;
-		cr->client = client;
-	}
+	int poll_retval = 0;
+	while (cerver->isRunning) {
+		sock_fd.revents = 0;
+		poll_retval = poll (&sock_fd, 1, cerver->poll_timeout);
 
-	return cr;
+		switch (poll_retval) {
+			case -1: {
+				// interrupted by a signal, try again
+				if (errno == EINTR) break;
 
-}
+				cerver_log (
+					LOG_TYPE_ERROR, LOG_TYPE_CERVER,
+					"Cerver %s acceptor poll has failed!",
+					cerver->info->name
+				);
 
-static void cerver_receive_handle_buffer_actual (
-	ReceiveHandle *receive_handle,
-	char *end, size_t buffer_pos,
-	size_t remaining_buffer_size
-) {
+				perror ("Error");
+				cerver->isRunning = false;
+			} break;
 
-	PacketHeader *header = NULL;
-	size_t packet_size = 0;
+			case 0: break;
 
-	Packet *packet = NULL;
+			default: {
+				if (sock_fd.revents & POLLIN) {
+					cerver_reactors_handle_accept (cerver);
+				}
+			} break;
+		}
+	}
 
-	u8 stop_handler = 0;
+}
 
-	#ifdef RECEIVE_DEBUG
-	(void) printf ("WHILE has started!\n\n");
-	#endif
+// starts the reactors threads & accepts new connections
+// handing them to the reactors in a round-robin fashion
+u8 cerver_reactors (Cerver *cerver) {
 
-	do {
-		#ifdef RECEIVE_DEBUG
-		(void) printf ("[0] remaining_buffer_size: %lu\n", remaining_buffer_size);
-		(void) printf ("[0] buffer pos: %lu\n", buffer_pos);
-		#endif
+	u8 retval = 1;
 
-		switch (receive_handle->state) {
-			// check if we have a complete packet header in the buffer
-			case RECEIVE_HANDLE_STATE_NORMAL: {
-				if (remaining_buffer_size >= sizeof (PacketHeader)) {
-					#ifdef RECEIVE_DEBUG
-					(void) printf (
-						"Complete header in current buffer\n"
-					);
-					#endif
+	if (cerver) {
+		if (cerver->reactors) {
+			// reactors without a cpu use the cerver's affinity
+			ThreadAffinity affinity;
+			cerver_get_affinity (cerver, cerver->n_reactors, &affinity);
+
+			u8 errors = 0;
+			CerverReactor *reactor = NULL;
+			for (unsigned int idx = 0; idx < cerver->n_reactors; idx++) {
+				reactor = cerver->reactors[idx];
+				if (reactor->cpu >= 0) {
+					thread_affinity_init (&reactor->affinity, THREAD_AFFINITY_CPUS);
+					thread_affinity_add_cpu (&reactor->affinity, reactor->cpu);
+				}
 
-					header = (PacketHeader *) end;
-					end += sizeof (PacketHeader);
-					buffer_pos += sizeof (PacketHeader);
+				else {
+					thread_affinity_resolve (&reactor->affinity, &affinity, idx);
+				}
 
-					#ifdef RECEIVE_DEBUG
-					packet_header_print (header);
-					(void) printf ("[1] buffer pos: %lu\n", buffer_pos);
-					#endif
+				errors |= cerver_reactor_start (reactor);
+			}
 
-					packet_size = header->packet_size;
-					remaining_buffer_size -= sizeof (PacketHeader);
-				}
+			if (!errors) {
+				cerver_log (
+					LOG_TYPE_SUCCESS, LOG_TYPE_CERVER,
+					"Cerver %s is ready in port %d with %u reactors!",
+					cerver->info->name, cerver->port, cerver->n_reactors
+				);
 
-				// we need to handle just a part of the header
-				else {
-					#ifdef RECEIVE_DEBUG
-					(void) printf (
-						"Only %lu of %lu header bytes left in buffer\n",
-						remaining_buffer_size, sizeof (PacketHeader)
-					);
-					#endif
+				#ifdef CERVER_DEBUG
+				cerver_log (
+					LOG_TYPE_DEBUG, LOG_TYPE_CERVER,
+					"Waiting for connections..."
+				);
+				#endif
 
-					// reset previous header
-					(void) memset (&receive_handle->header, 0, sizeof (PacketHeader));
+				cerver_reactors_acceptor (cerver);
 
-					// the remaining buffer must contain a part of the header
-					// so copy it to our aux structure
-					receive_handle->header_end = (char *) &receive_handle->header;
-					(void) memcpy (
-						receive_handle->header_end, (void *) end, remaining_buffer_size
-					);
+				#ifdef CERVER_DEBUG
+				cerver_log (
+					LOG_TYPE_CERVER, LOG_TYPE_NONE,
+					"Cerver %s acceptor has stopped!",
+					cerver->info->name
+				);
+				#endif
 
-					// for (size_t i = 0; i < sizeof (PacketHeader); i++)
-					// 	printf ("%4x", (unsigned int) receive_handle->header_end[i]);
+				retval = 0;
+			}
 
-					// printf ("\n");
+			else {
+				// stop any reactor that was able to start
+				for (unsigned int idx = 0; idx < cerver->n_reactors; idx++) {
+					cerver->reactors[idx]->running = false;
+				}
+			}
+		}
 
-					// for (size_t i = 0; i < sizeof (PacketHeader); i++) {
-					// 	printf ("%4x", (unsigned int) *end);
-					// 	end += 1;
-					// }
+		else {
+			cerver_log (
+				LOG_TYPE_ERROR, LOG_TYPE_CERVER,
+				"Cerver %s reactors have NOT been created!",
+				cerver->info->name
+			);
+		}
+	}
 
-					// printf ("\n");
+	else {
+		cerver_log (
+			LOG_TYPE_ERROR, LOG_TYPE_CERVER,
+			"Can't listen for connections on a NULL cerver!"
+		);
+	}
 
-					// packet_header_print (&receive_handle->header);
+	return retval;
 
-					// pointer to the last byte of the new header
-					receive_handle->header_end += remaining_buffer_size;
+}
 
-					// keep track of how much header's data we are missing
-					receive_handle->remaining_header =
-						sizeof (PacketHeader) - remaining_buffer_size;
+#pragma endregion
 
-					buffer_pos += remaining_buffer_size;
+#pragma region udp
 
-					#ifdef RECEIVE_DEBUG
-					(void) printf ("[1] buffer pos: %lu\n", buffer_pos);
-					#endif
+// used to map each peer address to its client
+typedef struct CerverUdpPeerKey {
 
-					receive_handle->state = RECEIVE_HANDLE_STATE_SPLIT_HEADER;
+	sa_family_t family;
+	in_port_t port;
+	u8 address[16];
 
-					#ifdef RECEIVE_DEBUG
-					(void) printf ("while loop should end now!\n");
-					#endif
-				}
-			} break;
+} CerverUdpPeerKey;
 
-			// we already have a complete header from the spare packet
-			// we just need to check if it is correct
-			case RECEIVE_HANDLE_STATE_COMP_HEADER: {
-				header = &receive_handle->header;
-				packet_size = header->packet_size;
-				// remaining_buffer_size -= buffer_pos;
+static void cerver_udp_peer_key_init (
+	CerverUdpPeerKey *key, const struct sockaddr_storage *address
+) {
 
-				receive_handle->state = RECEIVE_HANDLE_STATE_NORMAL;
-			} break;
+	(void) memset (key, 0, sizeof (CerverUdpPeerKey));
 
-			default: break;
-		}
+	key->family = address->ss_family;
+	switch (address->ss_family) {
+		case AF_INET: {
+			const struct sockaddr_in *in = (const struct sockaddr_in *) address;
+			key->port = in->sin_port;
+			(void) memcpy (key->address, &in->sin_addr, sizeof (struct in_addr));
+		} break;
 
-		#ifdef RECEIVE_DEBUG
-		(void) printf (
-			"State BEFORE CHECKING for packet size: %s\n",
-			receive_handle_state_to_string (receive_handle->state)
-		);
-		#endif
+		case AF_INET6: {
+			const struct sockaddr_in6 *in6 = (const struct sockaddr_in6 *) address;
+			key->port = in6->sin6_port;
+			(void) memcpy (key->address, &in6->sin6_addr, sizeof (struct in6_addr));
+		} break;
 
-		if (
-			(receive_handle->state == RECEIVE_HANDLE_STATE_NORMAL)
-			|| (receive_handle->state == RECEIVE_HANDLE_STATE_LOST)
-		) {
-			// check that we have a valid packet size
-			if (
-				(packet_size > 0)
-				&& (packet_size <= receive_handle->cerver->max_received_packet_size)
-			) {
-				// we can safely process the complete packet
-				packet = packet_create_with_data (
-					header->packet_size - sizeof (PacketHeader)
-				);
+		default: break;
+	}
 
-				// set packet's values
-				(void) memcpy (&packet->header, header, sizeof (PacketHeader));
-				packet->cerver = receive_handle->cerver;
-				packet->client = receive_handle->client;
-				packet->connection = receive_handle->connection;
-				packet->lobby = receive_handle->lobby;
+}
 
-				packet->packet_size = packet->header.packet_size;
+// fnv-1a, the generic htab hash only sums the key bytes
+static size_t cerver_udp_peer_hash (
+	const void *key, size_t key_size, size_t table_size
+) {
 
-				if (packet->data_size == 0) {
-					#ifdef RECEIVE_DEBUG
-					(void) printf (
-						"Packet has no more data\n"
-					);
-					#endif
+	const u8 *bytes = (const u8 *) key;
 
-					// we can safely handle the packet
-					stop_handler = cerver_packet_select_handler (
-						receive_handle, packet
-					);
+	u64 hash = 14695981039346656037ULL;
+	for (size_t i = 0; i < key_size; i++) {
+		hash ^= bytes[i];
+		hash *= 1099511628211ULL;
+	}
 
-					#ifdef RECEIVE_DEBUG
-					(void) printf ("[2] buffer pos: %lu\n", buffer_pos);
-					#endif
-				}
+	return (size_t) (hash % table_size);
 
-				// check how much of the packet's data is in the current buffer
-				else if (packet->data_size <= remaining_buffer_size) {
-					#ifdef RECEIVE_DEBUG
-					(void) printf (
-						"Complete packet in current buffer\n"
-					);
-					#endif
+}
 
-					// the full packet's data is in the current buffer
-					// so we can safely copy the complete packet
-					(void) memcpy (packet->data, end, packet->data_size);
+static inline socklen_t cerver_udp_address_len (
+	const struct sockaddr_storage *address
+) {
 
-					// we can safely handle the packet
-					stop_handler = cerver_packet_select_handler (
-						receive_handle, packet
-					);
+	return (address->ss_family == AF_INET6)
+		? sizeof (struct sockaddr_in6) : sizeof (struct sockaddr_in);
 
-					// update buffer positions & values
-					end += packet->data_size;
-					buffer_pos += packet->data_size;
-					remaining_buffer_size -= packet->data_size;
+}
 
-					#ifdef RECEIVE_DEBUG
-					(void) printf ("[2] buffer pos: %lu\n", buffer_pos);
-					#endif
-				}
+CerverUdp *cerver_udp_new (void) {
 
-				else {
-					// just some part of the packet's data is in the current buffer
-					// we should copy all the remaining buffer and wait for the next read
-					#ifdef RECEIVE_DEBUG
-					(void) printf ("RECEIVE_HANDLE_STATE_SPLIT_PACKET\n");
-					#endif
-					
-					if (remaining_buffer_size > 0) {
-						#ifdef RECEIVE_DEBUG
-						(void) printf (
-							"We can only get %lu / %lu from the current buffer\n",
-							remaining_buffer_size, packet->data_size
-						);
-						#endif
+	CerverUdp *udp = (CerverUdp *) malloc (sizeof (CerverUdp));
+	if (udp) {
+		udp->thread_id = 0;
 
-						// TODO: handle errors
-						(void) packet_add_data (
-							packet, end, remaining_buffer_size
-						);
+		udp->batch_size = 0;
+		udp->buffer_size = 0;
 
-						// update buffer positions & values
-						end += packet->data_size;
-						buffer_pos += packet->data_size;
-						remaining_buffer_size -= packet->data_size;
-					}
+		udp->buffers = NULL;
+		udp->iovecs = NULL;
+		udp->addresses = NULL;
+		udp->msgs = NULL;
 
-					else {
-						#ifdef RECEIVE_DEBUG
-						(void) printf (
-							"We have NO more data left in current buffer\n"
-						);
-						#endif
-					}
+		udp->n_send = 0;
+		udp->send_buffers = NULL;
+		udp->send_iovecs = NULL;
+		udp->send_addresses = NULL;
+		udp->send_msgs = NULL;
 
-					// set the newly created packet as spare
-					receive_handle->spare_packet = packet;
+		udp->peers = NULL;
+		udp->peers_list = NULL;
+		udp->last_sweep = 0;
 
-					receive_handle->state = RECEIVE_HANDLE_STATE_SPLIT_PACKET;
+		(void) memset (&udp->stats, 0, sizeof (CerverUdpStats));
+	}
 
-					#ifdef RECEIVE_DEBUG
-					(void) printf ("while loop should end now!\n");
-					#endif
-				}
-			}
+	return udp;
 
-			else {
-				// we must likely have a bad packet
-				// we need to keep reading the buffer until we find
-				// the start of the next one and we can continue
-				#ifdef RECEIVE_DEBUG
-				cerver_log (
-					LOG_TYPE_WARNING, LOG_TYPE_PACKET,
-					"Got a packet of invalid size: %ld", packet_size
-				);
-				#endif
+}
 
-				#ifdef RECEIVE_DEBUG
-				(void) printf ("\n\nWE ARE LOST!\n\n");
-				#endif
+void cerver_udp_delete (void *udp_ptr) {
 
-				receive_handle->state = RECEIVE_HANDLE_STATE_LOST;
+	if (udp_ptr) {
+		CerverUdp *udp = (CerverUdp *) udp_ptr;
 
-				// FIXME: this is just for testing!
-				break;
-			}
-		}
+		if (udp->buffers) free (udp->buffers);
+		if (udp->iovecs) free (udp->iovecs);
+		if (udp->addresses) free (udp->addresses);
+		if (udp->msgs) free (udp->msgs);
 
-		// reset common loop values
-		header = NULL;
-		packet = NULL;
-	} while ((buffer_pos < receive_handle->received_size) && !stop_handler);
+		if (udp->send_buffers) free (udp->send_buffers);
+		if (udp->send_iovecs) free (udp->send_iovecs);
+		if (udp->send_addresses) free (udp->send_addresses);
+		if (udp->send_msgs) free (udp->send_msgs);
 
-	#ifdef RECEIVE_DEBUG
-	(void) printf ("WHILE has ended!\n\n");
-	#endif
+		// the peers list owns the clients
+		htab_destroy (udp->peers);
+		dlist_delete (udp->peers_list);
+
+		free (udp_ptr);
+	}
 
 }
 
-void cerver_receive_handle_buffer (
-	void *receive_handle_ptr
+// points every message header to its own buffer & address
+static void cerver_udp_msgs_init (
+	const unsigned int batch_size, const size_t buffer_size,
+	char *buffers, struct iovec *iovecs,
+	struct sockaddr_storage *addresses, struct mmsghdr *msgs
 ) {
 
-	ReceiveHandle *receive_handle = (ReceiveHandle *) receive_handle_ptr;
+	for (unsigned int i = 0; i < batch_size; i++) {
+		iovecs[i].iov_base = buffers + (i * buffer_size);
+		iovecs[i].iov_len = buffer_size;
 
-	char *end = receive_handle->buffer;
-	size_t buffer_pos = 0;
+		msgs[i].msg_hdr.msg_name = &addresses[i];
+		msgs[i].msg_hdr.msg_namelen = sizeof (struct sockaddr_storage);
+		msgs[i].msg_hdr.msg_iov = &iovecs[i];
+		msgs[i].msg_hdr.msg_iovlen = 1;
+	}
 
-	size_t remaining_buffer_size = receive_handle->received_size;
+}
 
-	u8 stop_handler = 0;
+static CerverUdp *cerver_udp_create (Cerver *cerver) {
 
-	#ifdef RECEIVE_DEBUG
-	(void) printf ("Received size: %lu\n", receive_handle->received_size);
+	CerverUdp *udp = cerver_udp_new ();
+	if (udp) {
+		udp->batch_size = cerver->udp_batch_size;
+		udp->buffer_size = cerver->receive_buffer_size;
 
-	(void) printf (
-		"State BEFORE checking for SPARE PARTS: %s\n",
-		receive_handle_state_to_string (receive_handle->state)
-	);
-	#endif
+		udp->buffers = (char *) calloc (udp->batch_size, udp->buffer_size);
+		udp->iovecs = (struct iovec *) calloc (udp->batch_size, sizeof (struct iovec));
+		udp->addresses = (struct sockaddr_storage *) calloc (
+			udp->batch_size, sizeof (struct sockaddr_storage)
+		);
+		udp->msgs = (struct mmsghdr *) calloc (udp->batch_size, sizeof (struct mmsghdr));
 
-	// check if we have any spare parts 
-	switch (receive_handle->state) {
-		// check if we have a spare header
-		// that was incompleted from the last buffer
-		case RECEIVE_HANDLE_STATE_SPLIT_HEADER: {
-			// copy the remaining header size
-			(void) memcpy (
-				receive_handle->header_end,
-				(void *) end,
-				receive_handle->remaining_header
-			);
+		udp->send_buffers = (char *) calloc (udp->batch_size, udp->buffer_size);
+		udp->send_iovecs = (struct iovec *) calloc (udp->batch_size, sizeof (struct iovec));
+		udp->send_addresses = (struct sockaddr_storage *) calloc (
+			udp->batch_size, sizeof (struct sockaddr_storage)
+		);
+		udp->send_msgs = (struct mmsghdr *) calloc (udp->batch_size, sizeof (struct mmsghdr));
 
-			#ifdef RECEIVE_DEBUG
-			(void) printf (
-				"Copied %u missing header bytes\n",
-				receive_handle->remaining_header
-			);
-			#endif
+		udp->peers = htab_create (CERVER_UDP_PEERS_HTAB_SIZE, cerver_udp_peer_hash, NULL);
+		udp->peers_list = dlist_init (client_delete, NULL);
 
-			// receive_handle->header_end = (char *) &receive_handle->header;
-			// for (size_t i = 0; i < receive_handle->remaining_header; i++)
-			// 	(void) printf ("%4x", (unsigned int) receive_handle->header_end[i]);
+		if (
+			udp->buffers && udp->iovecs && udp->addresses && udp->msgs
+			&& udp->send_buffers && udp->send_iovecs
+			&& udp->send_addresses && udp->send_msgs
+			&& udp->peers && udp->peers_list
+		) {
+			cerver_udp_msgs_init (
+				udp->batch_size, udp->buffer_size,
+				udp->buffers, udp->iovecs, udp->addresses, udp->msgs
+			);
 
-			// (void) printf ("\n");
-			
-			#ifdef RECEIVE_DEBUG
-			packet_header_print (&receive_handle->header);
-			#endif
+			cerver_udp_msgs_init (
+				udp->batch_size, udp->buffer_size,
+				udp->send_buffers, udp->send_iovecs,
+				udp->send_addresses, udp->send_msgs
+			);
+		}
 
-			// update buffer positions
-			end += receive_handle->remaining_header;
-			buffer_pos += receive_handle->remaining_header;
+		else {
+			cerver_udp_delete (udp);
+			udp = NULL;
+		}
+	}
 
-			// update how much we have still left to handle from the current buffer
-			remaining_buffer_size -= receive_handle->remaining_header;
+	return udp;
 
-			// reset receive handler values
-			receive_handle->header_end = NULL;
-			receive_handle->remaining_header = 0;
+}
 
-			// we can expect to get the packet's data from the current buffer
-			receive_handle->state = RECEIVE_HANDLE_STATE_COMP_HEADER;
+// removes every udp peer & deletes the cerver's udp structures
+void cerver_udp_end (Cerver *cerver) {
 
-			#ifdef RECEIVE_DEBUG
-			(void) printf ("We have a COMPLETE HEADER!\n");
-			#endif
-		} break;
+	if (cerver) {
+		if (cerver->udp) {
+			cerver_udp_delete (cerver->udp);
+			cerver->udp = NULL;
+		}
+	}
 
-		// check if we have a spare packet
-		case RECEIVE_HANDLE_STATE_SPLIT_PACKET: {
-			// check if the current buffer is big enough
-			if (
-				receive_handle->spare_packet->remaining_data <= receive_handle->received_size
-			) {
-				size_t to_copy_data_size = receive_handle->spare_packet->remaining_data; 
-				
-				// copy packet's remaining data
-				(void) packet_add_data (
-					receive_handle->spare_packet,
-					end,
-					receive_handle->spare_packet->remaining_data
-				);
+}
 
-				#ifdef RECEIVE_DEBUG
-				(void) printf (
-					"Copied %lu missing packet bytes\n",
-					to_copy_data_size
-				);
+// returns the client that matches the peer's address
+// a new client is created the first time we get a datagram from the peer
+// returns NULL if the cerver already has udp_max_peers
+static Client *cerver_udp_peer_get (
+	Cerver *cerver, CerverUdp *udp,
+	const struct sockaddr_storage *address, const time_t now
+) {
 
-				(void) printf ("Spare packet is COMPLETED!\n");
-				#endif
+	CerverUdpPeerKey key = { 0 };
+	cerver_udp_peer_key_init (&key, address);
 
-				// we can safely handle the packet
-				stop_handler = cerver_packet_select_handler (
-					receive_handle, receive_handle->spare_packet
-				);
+	Client *client = (Client *) htab_get (
+		udp->peers, &key, sizeof (CerverUdpPeerKey)
+	);
 
-				// update buffer positions
-				end += to_copy_data_size;
-				buffer_pos += to_copy_data_size;
+	// peers that are waiting to be deleted still count
+	// as their clients have not been released yet
+	if (
+		!client && cerver->udp_max_peers
+		&& (udp->stats.current_peers >= cerver->udp_max_peers)
+	) {
+		udp->stats.n_peers_refused += 1;
+	}
 
-				// update how much we have still left to handle from the current buffer
-				remaining_buffer_size -= to_copy_data_size;
+	else if (!client) {
+		// the connection references the cerver's socket
+		// and it is never set as active, so it never closes it
+		client = client_create_with_connection (cerver, cerver->sock, address);
+		if (client) {
+			client->last_activity = now;
+
+			if (!htab_insert (
+				udp->peers,
+				&key, sizeof (CerverUdpPeerKey),
+				client, sizeof (Client)
+			)) {
+				(void) dlist_insert_at_end_unsafe (udp->peers_list, client);
 
-				// we still need to process more data from the buffer
-				receive_handle->state = RECEIVE_HANDLE_STATE_NORMAL;
-			}
+				udp->stats.current_peers += 1;
+				udp->stats.total_peers += 1;
 
-			else {
-				#ifdef RECEIVE_DEBUG
-				(void) printf (
-					"We can only get %lu / %lu of the remaining packet's data\n",
-					receive_handle->spare_packet->remaining_data,
-					receive_handle->received_size
+				#ifdef HANDLER_DEBUG
+				cerver_log_debug (
+					"New udp peer %s:%u in cerver %s",
+					((Connection *) dlist_start (client->connections)->data)->ip,
+					((Connection *) dlist_start (client->connections)->data)->port,
+					cerver->info->name
 				);
 				#endif
 
-				// copy the complete buffer
-				(void) packet_add_data (
-					receive_handle->spare_packet,
-					end,
-					receive_handle->received_size
-				);
-
-				#ifdef RECEIVE_DEBUG
-				(void) printf (
-					"We are still missing %lu to complete the packet!\n",
-					receive_handle->spare_packet->remaining_data
+				cerver_event_trigger (
+					CERVER_EVENT_CLIENT_CONNECTED,
+					cerver,
+					client, (Connection *) dlist_start (client->connections)->data
 				);
-				#endif
 			}
-		} break;
 
-		default: break;
+			else {
+				client_delete (client);
+				client = NULL;
+			}
+		}
 	}
 
-	#ifdef RECEIVE_DEBUG
-	(void) printf (
-		"State BEFORE LOOP: %s\n",
-		receive_handle_state_to_string (receive_handle->state)
+	return client;
+
+}
+
+// removes the peer from the peers map
+// the client is deleted in the next sweep, so that
+// it is never deleted while its packets are being handled
+static void cerver_udp_peer_drop (CerverUdp *udp, Client *client) {
+
+	CerverUdpPeerKey key = { 0 };
+	cerver_udp_peer_key_init (
+		&key, &((Connection *) dlist_start (client->connections)->data)->address
 	);
-	#endif
 
-	if (
-		!stop_handler
-		&& (buffer_pos < receive_handle->received_size)
-		&& (
-			receive_handle->state == RECEIVE_HANDLE_STATE_NORMAL
-			|| receive_handle->state == RECEIVE_HANDLE_STATE_COMP_HEADER
-		)
-	) {
-		cerver_receive_handle_buffer_actual (
-			receive_handle,
-			end, buffer_pos,
-			remaining_buffer_size
-		);
-	}
+	(void) htab_remove (udp->peers, &key, sizeof (CerverUdpPeerKey));
+
+	client->drop_client = true;
 
 }
 
-// handles a failed receive from a connection associatd with a client
-// ends the connection to prevent seg faults or signals for bad sock fd
-void cerver_receive_handle_failed (CerverReceive *cr) {
+// dropped peers are kept until the cerver handlers
+// have handled every packet that they have in their queues
+static inline bool cerver_udp_peer_has_queued_packets (Client *client) {
 
-	if (cr->socket) {
-		(void) pthread_mutex_lock (cr->socket->read_mutex);
+	return __atomic_load_n (
+		&((Connection *) dlist_start (client->connections)->data)->queued_packets,
+		__ATOMIC_ACQUIRE
+	) != 0;
 
-		if (cr->socket->sock_fd > 0) {
-			switch (cr->type) {
-				case RECEIVE_TYPE_NORMAL: {
-					// check if the socket belongs to a player inside a lobby
-					if (cr->lobby) {
-						if (cr->lobby->players->size > 0) {
-							(void) player_unregister_from_lobby (
-								cr->lobby,
-								player_get_by_sock_fd_list (
-									cr->lobby, cr->socket->sock_fd
-								)
-							);
-						}
-					}
+}
 
-					(void) client_remove_connection_by_sock_fd (
-						cr->cerver, cr->client, cr->socket->sock_fd
-					);
-				} break;
+// deletes the peers that have been dropped
+// and the ones that have been idle for more than udp_peer_timeout
+static void cerver_udp_sweep (
+	Cerver *cerver, CerverUdp *udp, const time_t now
+) {
 
-				case RECEIVE_TYPE_ON_HOLD: {
-					on_hold_connection_drop (cr->cerver, cr->connection);
-				} break;
+	Client *client = NULL;
+	ListElement *next = NULL;
+	for (ListElement *le = dlist_start (udp->peers_list); le; le = next) {
+		next = le->next;
 
-				case RECEIVE_TYPE_ADMIN: {
-					(void) admin_remove_connection_by_sock_fd (
-						cr->cerver->admin, cr->admin, cr->socket->sock_fd
-					);
-				} break;
+		client = (Client *) le->data;
+		if (
+			!client->drop_client && cerver->udp_peer_timeout
+			&& ((now - client->last_activity) >= (time_t) cerver->udp_peer_timeout)
+		) {
+			cerver_udp_peer_drop (udp, client);
 
-				default: break;
-			}
+			udp->stats.n_peers_timeout += 1;
 		}
 
-		(void) pthread_mutex_unlock (cr->socket->read_mutex);
+		if (client->drop_client && !cerver_udp_peer_has_queued_packets (client)) {
+			(void) dlist_remove_element_unsafe (udp->peers_list, le);
+
+			udp->stats.current_peers -= 1;
+
+			cerver_event_trigger (
+				CERVER_EVENT_CLIENT_DROPPED,
+				cerver,
+				NULL, NULL
+			);
+
+			client_delete (client);
+		}
 	}
 
 }
 
-static inline void cerver_receive_success_receive_handle (
-	CerverReceive *cr,
-	const size_t received,
-	char *packet_buffer, const size_t packet_buffer_size
-) {
-
-	ReceiveHandle *receive_handle = &cr->connection->receive_handle;
-	receive_handle->type = cr->type;
+// sends every datagram in the batch using sendmmsg ()
+// datagrams that the socket can't take right now are discarded
+static void cerver_udp_flush (Cerver *cerver, CerverUdp *udp) {
+
+	unsigned int sent = 0;
+	int retval = 0;
+	while (sent < udp->n_send) {
+		retval = sendmmsg (
+			cerver->sock,
+			udp->send_msgs + sent, udp->n_send - sent,
+			MSG_NOSIGNAL
+		);
 
-	receive_handle->cerver = cr->cerver;
+		if (retval < 0) {
+			if (errno == EINTR) continue;
 
-	receive_handle->socket = cr->socket;
-	receive_handle->connection = cr->connection;
-	receive_handle->client = cr->client;
-	receive_handle->admin = cr->admin;
+			#ifdef HANDLER_DEBUG
+			cerver_log (
+				LOG_TYPE_WARNING, LOG_TYPE_CERVER,
+				"Cerver %s udp failed to send %u datagrams!",
+				cerver->info->name, udp->n_send - sent
+			);
+			#endif
 
-	receive_handle->lobby = cr->lobby;
+			break;
+		}
 
-	receive_handle->buffer = packet_buffer;
-	receive_handle->buffer_size = packet_buffer_size;
-	receive_handle->received_size = received;
+		sent += (unsigned int) retval;
 
-	if (receive_handle->state == RECEIVE_HANDLE_STATE_NONE) {
-		receive_handle->state = RECEIVE_HANDLE_STATE_NORMAL;
+		udp->stats.n_send_batches += 1;
+		udp->stats.n_datagrams_sent += (u64) retval;
 	}
 
-	cr->cerver->handle_received_buffer (receive_handle);
+	udp->n_send = 0;
 
 }
 
-static void cerver_receive_success (
-	CerverReceive *cr,
-	const size_t received,
-	char *packet_buffer, const size_t packet_buffer_size
+// sends a packet to the connection's address
+// if it is called from the udp loop thread,
+// the packet will be sent with the rest of the batch
+// returns 0 on success, 1 on error
+u8 cerver_udp_send (
+	Cerver *cerver, Connection *connection,
+	const char *data, const size_t data_size, const int flags
 ) {
 
-	cr->socket->packet_buffer_size = received;
-
-	cr->cerver->stats->total_n_receives_done += 1;
-	cr->cerver->stats->total_bytes_received += received;
-
-	if (cr->lobby) {
-		cr->lobby->stats->n_receives_done += 1;
-		cr->lobby->stats->bytes_received += received;
-	}
+	u8 retval = 1;
 
-	switch (cr->type) {
-		case RECEIVE_TYPE_NORMAL: {
-			cr->cerver->stats->client_receives_done += 1;
-			cr->cerver->stats->client_bytes_received += received;
+	CerverUdp *udp = cerver->udp;
+	if (
+		udp && (data_size <= udp->buffer_size)
+		&& pthread_equal (udp->thread_id, pthread_self ())
+	) {
+		if (udp->n_send == udp->batch_size) cerver_udp_flush (cerver, udp);
 
-			#ifdef CLIENT_STATS
-			cr->client->stats->n_receives_done += 1;
-			cr->client->stats->total_bytes_received += received;
-			#endif
+		(void) memcpy (udp->send_iovecs[udp->n_send].iov_base, data, data_size);
+		udp->send_iovecs[udp->n_send].iov_len = data_size;
 
-			#ifdef CONNECTION_STATS
-			cr->connection->stats->n_receives_done += 1;
-			cr->connection->stats->total_bytes_received += received;
-			#endif
-		} break;
+		(void) memcpy (
+			&udp->send_addresses[udp->n_send],
+			&connection->address, sizeof (struct sockaddr_storage)
+		);
 
-		case RECEIVE_TYPE_ON_HOLD: {
-			cr->cerver->stats->on_hold_receives_done += 1;
-			cr->cerver->stats->on_hold_bytes_received += received;
+		udp->send_msgs[udp->n_send].msg_hdr.msg_namelen =
+			cerver_udp_address_len (&connection->address);
 
-			cr->connection->stats->n_receives_done += 1;
-			cr->connection->stats->total_bytes_received += received;
-		} break;
+		udp->n_send += 1;
 
-		case RECEIVE_TYPE_ADMIN: {
-			cr->cerver->admin->stats->total_n_receives_done += 1;
-			cr->cerver->admin->stats->total_bytes_received += received;
+		retval = 0;
+	}
 
-			#ifdef CLIENT_STATS
-			cr->client->stats->n_receives_done += 1;
-			cr->client->stats->total_bytes_received += received;
-			#endif
+	else {
+		ssize_t sent = sendto (
+			cerver->sock,
+			data, data_size,
+			flags | MSG_NOSIGNAL,
+			(const struct sockaddr *) &connection->address,
+			cerver_udp_address_len (&connection->address)
+		);
 
-			#ifdef CONNECTION_STATS
-			cr->connection->stats->n_receives_done += 1;
-			cr->connection->stats->total_bytes_received += received;
-			#endif
-		} break;
+		if (sent == (ssize_t) data_size) {
+			if (udp) {
+				udp->stats.n_datagrams_sent += 1;
+			}
 
-		default: break;
+			retval = 0;
+		}
 	}
 
-	cerver_receive_success_receive_handle (
-		cr,
-		received,
-		packet_buffer, packet_buffer_size
-	);
+	return retval;
 
 }
 
-void cerver_receive_internal (
-	CerverReceive *cr,
-	char *packet_buffer, const size_t packet_buffer_size
+// handles the packets of every received datagram using its peer's connection
+static void cerver_udp_handle_batch (
+	Cerver *cerver, CerverUdp *udp,
+	CerverReceive *cr, const unsigned int n_msgs
 ) {
 
-	ssize_t rc = recv (
-		cr->socket->sock_fd,
-		packet_buffer, packet_buffer_size,
-		0
-	);
-
-	switch (rc) {
-		case -1: {
-			// no more data to read
-			if (errno != EWOULDBLOCK) {
-				#ifdef HANDLER_DEBUG
-				cerver_log (
-					LOG_TYPE_ERROR, LOG_TYPE_CERVER,
-					"cerver_receive () - rc < 0 - sock fd: %d",
-					cr->socket->sock_fd
-				);
-
-				perror ("Error ");
-				#endif
+	time_t now = time (NULL);
 
-				cerver_receive_handle_failed (cr);
-			}
-		} break;
+	Client *client = NULL;
+	Connection *connection = NULL;
+	ReceiveHandle *receive_handle = NULL;
+	for (unsigned int i = 0; i < n_msgs; i++) {
+		if (udp->msgs[i].msg_hdr.msg_flags & MSG_TRUNC) {
+			udp->stats.n_datagrams_truncated += 1;
+			continue;
+		}
 
-		case 0: {
-			// man recv -> steam socket perfomed an orderly shutdown
-			// but in dgram it might mean something?
-			#ifdef HANDLER_DEBUG
-			cerver_log (
-				LOG_TYPE_DEBUG, LOG_TYPE_CERVER,
-				"cerver_recieve () - rc == 0 - sock fd: %d",
-				cr->socket->sock_fd
-			);
+		if (!udp->msgs[i].msg_len) continue;
 
-			// perror ("Error ");
-			#endif
+		client = cerver_udp_peer_get (cerver, udp, &udp->addresses[i], now);
+		if (client && !client->drop_client) {
+			client->last_activity = now;
 
-			cerver_receive_handle_failed (cr);
-		} break;
+			connection = (Connection *) dlist_start (client->connections)->data;
 
-		default: {
-			#ifdef RECEIVE_DEBUG
-			cerver_log_debug (
-				"recv () - %ld bytes from %d sock fd",
-				rc, cr->socket->sock_fd
+			cerver_receive_init_full (
+				cr, RECEIVE_TYPE_NORMAL, cerver, client, connection
 			);
-			#endif
 
 			cerver_receive_success (
-				cr, rc,
-				packet_buffer, packet_buffer_size
+				cr, udp->msgs[i].msg_len,
+				(char *) udp->iovecs[i].iov_base, udp->buffer_size
 			);
-		} break;
+
+			// a datagram only contains complete packets,
+			// so an incomplete one is never going to be completed
+			receive_handle = &connection->receive_handle;
+			packet_delete (receive_handle->spare_packet);
+			receive_handle_reset (receive_handle);
+
+			if (client->drop_client) cerver_udp_peer_drop (udp, client);
+		}
 	}
 
 }
 
-// packet buffer only gets deleted if cerver_receive_handle_buffer () is used
-static inline u8 cerver_receive_threads_actual (
-	CerverReceive *cr,
-	char *buffer, const size_t buffer_size
+// receives datagrams until we get less than a complete batch
+static void cerver_udp_receive (
+	Cerver *cerver, CerverUdp *udp, CerverReceive *cr
 ) {
 
-	u8 retval = 1;
-	
-	ssize_t rc = recv (cr->socket->sock_fd, buffer, buffer_size, 0);
-	switch (rc) {
-		case -1: {
-			if (errno == EAGAIN) {
-				#ifdef SOCKET_DEBUG
-				cerver_log_debug (
-					"cerver_receive_threads () - sock fd: %d timed out",
-					cr->socket->sock_fd
-				);
-				#endif
+	int n_msgs = 0;
+	do {
+		for (unsigned int i = 0; i < udp->batch_size; i++)
+			udp->msgs[i].msg_hdr.msg_namelen = sizeof (struct sockaddr_storage);
 
-				retval = 0;
-			}
+		n_msgs = recvmmsg (
+			cerver->sock, udp->msgs, udp->batch_size, MSG_DONTWAIT, NULL
+		);
+
+		if (n_msgs > 0) {
+			udp->stats.n_receive_batches += 1;
+			udp->stats.n_datagrams_received += (u64) n_msgs;
+
+			cerver_udp_handle_batch (cerver, udp, cr, (unsigned int) n_msgs);
+
+			// send every response together
+			cerver_udp_flush (cerver, udp);
+		}
+	} while (cerver->isRunning && (n_msgs == (int) udp->batch_size));
+
+}
+
+static void cerver_udp_loop (Cerver *cerver, CerverUdp *udp) {
+
+	udp->thread_id = pthread_self ();
+	udp->last_sweep = time (NULL);
+
+	struct pollfd sock_fd = { 0 };
+	sock_fd.fd = cerver->sock;
+	sock_fd.events = POLLIN;
+
+	CerverReceive cr = { 0 };
+
+	time_t now = 0;
+	int poll_retval = 0;
+	while (cerver->isRunning) {
+		sock_fd.revents = 0;
+		poll_retval = poll (&sock_fd, 1, cerver->poll_timeout);
+
+		switch (poll_retval) {
+			case -1: {
+				// interrupted by a signal, try again
+				if (errno == EINTR) break;
 
-			else {
-				#ifdef HANDLER_DEBUG
 				cerver_log (
 					LOG_TYPE_ERROR, LOG_TYPE_CERVER,
-					"cerver_receive_threads () - rc < 0 - sock fd: %d",
-					cr->socket->sock_fd
+					"Cerver %s udp poll has failed!",
+					cerver->info->name
 				);
 
-				perror ("Error ");
-				#endif
-			}
-		} break;
+				perror ("Error");
+				cerver->isRunning = false;
+			} break;
+
+			case 0: break;
+
+			default: {
+				if (sock_fd.revents & POLLIN) {
+					cerver_udp_receive (cerver, udp, &cr);
+				}
+			} break;
+		}
+
+		// check for idle peers at most once per second
+		now = time (NULL);
+		if (now > udp->last_sweep) {
+			cerver_udp_sweep (cerver, udp, now);
+			udp->last_sweep = now;
+		}
+	}
+
+}
+
+// receives datagrams in batches & handles their packets
+// using each peer's own client & connection
+u8 cerver_udp (Cerver *cerver) {
+
+	u8 retval = 1;
 
-		case 0: {
-			#ifdef HANDLER_DEBUG
+	if (cerver) {
+		cerver_udp_end (cerver);
+
+		cerver->udp = cerver_udp_create (cerver);
+		if (cerver->udp) {
 			cerver_log (
-				LOG_TYPE_DEBUG, LOG_TYPE_CERVER,
-				"cerver_receive_threads () - rc == 0 - sock fd: %d",
-				cr->socket->sock_fd
+				LOG_TYPE_SUCCESS, LOG_TYPE_CERVER,
+				"Cerver %s is ready in port %d using udp!",
+				cerver->info->name, cerver->port
 			);
 
-			// perror ("Error ");
-			#endif
-		} break;
+			cerver_udp_loop (cerver, cerver->udp);
 
-		default: {
-			cerver_receive_success (
-				cr, (size_t) rc,
-				buffer, buffer_size
+			#ifdef CERVER_DEBUG
+			cerver_log (
+				LOG_TYPE_CERVER, LOG_TYPE_NONE,
+				"Cerver %s udp loop has stopped!",
+				cerver->info->name
 			);
+			#endif
 
 			retval = 0;
-		} break;
+		}
+
+		else {
+			cerver_log (
+				LOG_TYPE_ERROR, LOG_TYPE_CERVER,
+				"Failed to create cerver %s udp structures!",
+				cerver->info->name
+			);
+		}
+	}
+
+	else {
+		cerver_log (
+			LOG_TYPE_ERROR, LOG_TYPE_CERVER,
+			"Can't handle datagrams on a NULL cerver!"
+		);
 	}
 
 	return retval;
 
 }
 
-static void *cerver_receive_threads (void *cerver_receive_ptr) {
+#pragma endregion
 
-	CerverReceive *cr = (CerverReceive *) cerver_receive_ptr;
+#pragma region io_uring
 
-	i32 sock_fd = cr->socket->sock_fd;
+CerverUring *cerver_uring_new (void) {
 
-	#ifdef HANDLER_DEBUG
-	cerver_log (
-		LOG_TYPE_DEBUG, LOG_TYPE_HANDLER,
-		"cerver_receive_threads () - sock fd <%d> connection thread has started",
-		sock_fd
-	);
-	#endif
+	CerverUring *uring = (CerverUring *) malloc (sizeof (CerverUring));
+	if (uring) {
+		uring->ring = NULL;
+		uring->buffers = NULL;
 
-	// set the socket's timeout to prevent thread from getting stuck if no more data to read
-	(void) sock_set_timeout (sock_fd, CERVER_DEFAULT_SOCKET_RECV_TIMEOUT);
+		uring->lock = NULL;
+		uring->thread_id = 0;
 
-	const size_t buffer_size = cr->cerver->receive_buffer_size;
-	char *buffer = (char *) calloc (buffer_size, sizeof (char));
-	if (buffer) {
-		while (
-			(cr->socket->sock_fd > 0)
-			&& cr->cerver->isRunning
-			&& !cerver_receive_threads_actual (cr, buffer, buffer_size)
-		);
+		uring->connections = NULL;
 
-		free (buffer);
+		(void) memset (&uring->stats, 0, sizeof (CerverUringStats));
 	}
 
-	else {
-		cerver_log (
-			LOG_TYPE_ERROR, LOG_TYPE_HANDLER,
-			"cerver_receive_threads () - "
-			"Failed to allocate packet buffer for sock fd <%d> connection!",
-			cr->connection->socket->sock_fd
-		);
-	}
+	return uring;
 
-	// check if the connection has already ended
-	if (cr->socket->sock_fd > 0) {
-		client_remove_connection_by_sock_fd (
-			cr->cerver, cr->client, cr->socket->sock_fd
-		);
-	}
+}
 
-	cerver_receive_delete (cr);
+#ifdef CERVER_IO_URING
 
-	#ifdef HANDLER_DEBUG
-	cerver_log (
-		LOG_TYPE_DEBUG, LOG_TYPE_HANDLER,
-		"cerver_receive_threads () - loop has ended - "
-		"dropping sock fd <%d> connection...",
-		sock_fd
-	);
-	#endif
+// the requests' user data is the connection's reference
+// with the request type in its lower bits
+#define CERVER_URING_OP_ACCEPT						1
+#define CERVER_URING_OP_RECV						2
+#define CERVER_URING_OP_SEND						3
+#define CERVER_URING_OP_CANCEL						4
 
-	return NULL;
+#define CERVER_URING_OP_MASK						0x7
 
-}
+static inline u64 cerver_uring_user_data (
+	const CerverUringConnection *uring_connection, const u64 op
+) {
 
-#pragma endregion
+	return (u64) (uintptr_t) uring_connection | op;
 
-#pragma region accept
+}
 
-// create a new connection but check if we can use the cerver's socket pool first
-static Connection *cerver_connection_create (
-	Cerver *cerver,
-	const i32 new_fd, const struct sockaddr_storage *client_address
-) {
+// closes the ring & deletes the references that were still in use
+// the references' connections won't use the ring anymore
+void cerver_uring_delete (void *uring_ptr) {
 
-	Connection *connection = NULL;
+	if (uring_ptr) {
+		CerverUring *uring = (CerverUring *) uring_ptr;
 
-	if (cerver->sockets_pool) {
-		// use a socket from the pool to create a new connection
-		Socket *socket = cerver_sockets_pool_pop (cerver);
-		if (socket) {
-			// manually create the connection
-			connection = connection_new ();
-			if (connection) {
-				// from connection_create_empty ()
-				// connection->socket = (Socket *) socket_create_empty ();
-				connection->socket = socket;
+		CerverUringConnection *next = NULL;
+		for (
+			CerverUringConnection *uring_connection = uring->connections;
+			uring_connection;
+			uring_connection = next
+		) {
+			next = uring_connection->next;
 
-				connection->stats = connection_stats_new ();
+			if (uring_connection->connection)
+				uring_connection->connection->uring = NULL;
 
-				// from connection_create ()
-				connection->socket->sock_fd = new_fd;
-				(void) memcpy (
-					&connection->address,
-					client_address,
-					sizeof (struct sockaddr_storage)
-				);
+			free (uring_connection);
+		}
 
-				connection->protocol = cerver->protocol;
+		uring_buf_ring_delete (uring->ring, uring->buffers);
+		uring_delete (uring->ring);
 
-				connection_get_values (connection);
-			}
-		}
+		thread_mutex_delete (uring->lock);
 
-		else {
-			connection = connection_create (
-				new_fd, client_address, cerver->protocol
-			);
-		}
+		free (uring);
 	}
 
-	else {
-		connection = connection_create (
-			new_fd, client_address, cerver->protocol
-		);
+}
+
+static CerverUringConnection *cerver_uring_connection_new (
+	CerverUring *uring, Connection *connection
+) {
+
+	CerverUringConnection *uring_connection = (CerverUringConnection *) malloc (
+		sizeof (CerverUringConnection)
+	);
+
+	if (uring_connection) {
+		(void) memset (uring_connection, 0, sizeof (CerverUringConnection));
+
+		uring_connection->connection = connection;
+		uring_connection->owner = uring;
+		uring_connection->refs = 1;
+
+		uring_connection->msg.msg_iov = uring_connection->iov;
+
+		uring_connection->next = uring->connections;
+		if (uring->connections) uring->connections->prev = uring_connection;
+		uring->connections = uring_connection;
 	}
 
-	return connection;
+	return uring_connection;
 
 }
 
-// if the cerver requires auth, we put the connection on hold
-static u8 cerver_register_new_connection_auth_required (
-	Cerver *cerver, Connection *connection
+// must be called with the uring's lock
+static void cerver_uring_connection_release (
+	CerverUring *uring, CerverUringConnection *uring_connection
 ) {
 
-	u8 retval = 1;
-
-	if (!on_hold_connection (cerver, connection)) {
-		#ifdef CERVER_DEBUG
-		cerver_log (
-			LOG_TYPE_DEBUG, LOG_TYPE_CERVER,
-			"Connection is on hold on cerver %s!",
-			cerver->info->name
-		);
-		#endif
+	uring_connection->refs -= 1;
+	if (!uring_connection->refs) {
+		if (uring_connection->prev) uring_connection->prev->next = uring_connection->next;
+		else uring->connections = uring_connection->next;
 
-		cerver->stats->total_on_hold_connections += 1;
+		if (uring_connection->next) uring_connection->next->prev = uring_connection->prev;
 
-		connection->active = true;
+		free (uring_connection);
+	}
 
-		cerver_info_send_info_packet (cerver, NULL, connection);
+}
 
-		cerver_event_trigger (
-			CERVER_EVENT_ON_HOLD_CONNECTED,
-			cerver,
-			NULL, connection
-		);
+// must be called with the uring's lock
+// if the submission queue is full, the pending sqes are submitted first
+static struct io_uring_sqe *cerver_uring_get_sqe (CerverUring *uring) {
 
-		retval = 0;
-	}
+	struct io_uring_sqe *sqe = uring_get_sqe (uring->ring);
+	if (!sqe) {
+		if (uring_submit (uring->ring) > 0) uring->stats.n_submits += 1;
 
-	else {
-		cerver_log_error (
-			"Failed to put connection on hold in cerver %s",
-			cerver->info->name
-		);
+		sqe = uring_get_sqe (uring->ring);
 	}
 
-	return retval;
+	return sqe;
 
 }
 
-static u8 cerver_register_new_connection_normal_default_create_detachable (
-	CerverReceive *cr
-) {
+// must be called with the uring's lock
+// the ring thread submits every sqe together before waiting
+// but the sqes from any other thread are submitted right away
+static void cerver_uring_submit (CerverUring *uring) {
 
-	u8 retval = 1;
+	if (!pthread_equal (uring->thread_id, pthread_self ())) {
+		if (uring_submit (uring->ring) > 0) uring->stats.n_submits += 1;
+	}
 
-	pthread_t thread_id = 0;
-	if (!thread_create_detachable (
-		&thread_id,
-		cerver_receive_threads,
-		cr
-	)) {
-		#ifdef HANDLER_DEBUG
-		cerver_log (
-			LOG_TYPE_DEBUG, LOG_TYPE_HANDLER,
-			"Created detachable thread for sock fd <%d> connection",
-			cr->connection->socket->sock_fd
-		);
-		#endif
+}
 
-		retval = 0;     // success
-	}
+// must be called with the uring's lock
+static u8 cerver_uring_accept (Cerver *cerver, CerverUring *uring) {
 
-	else {
-		cerver_log_error (
-			"cerver_register_new_connection_normal_default () - "
-			"Failed to create detachable thread for sock fd <%d> connection!",
-			cr->connection->socket->sock_fd
-		);
+	u8 retval = 1;
 
-		cerver_receive_delete (cr);
+	struct io_uring_sqe *sqe = cerver_uring_get_sqe (uring);
+	if (sqe) {
+		sqe->opcode = IORING_OP_ACCEPT;
+		sqe->fd = cerver->sock;
+		sqe->ioprio = IORING_ACCEPT_MULTISHOT;
+		sqe->user_data = CERVER_URING_OP_ACCEPT;
+
+		retval = 0;
 	}
 
 	return retval;
 
 }
 
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wcast-function-type"
-
-static u8 cerver_register_new_connection_normal_default_select_handler_threads (
-	Cerver *cerver, Client *client, Connection *connection
+// must be called with the uring's lock
+static u8 cerver_uring_receive (
+	CerverUring *uring, CerverUringConnection *uring_connection
 ) {
 
 	u8 retval = 1;
 
-	CerverReceive *cr = cerver_receive_create_full (
-		RECEIVE_TYPE_NORMAL,
-		cerver,
-		client, connection
-	);
+	struct io_uring_sqe *sqe = cerver_uring_get_sqe (uring);
+	if (sqe) {
+		sqe->opcode = IORING_OP_RECV;
+		sqe->fd = uring_connection->connection->socket->sock_fd;
+		sqe->ioprio = IORING_RECV_MULTISHOT;
+		sqe->flags = IOSQE_BUFFER_SELECT;
+		sqe->buf_group = uring->buffers->bgid;
+		sqe->user_data = cerver_uring_user_data (
+			uring_connection, CERVER_URING_OP_RECV
+		);
 
-	if (cr) {
-		// create a new detachable thread directly
-		if (cerver->handle_detachable_threads) {
-			retval = cerver_register_new_connection_normal_default_create_detachable (cr);
-		}
+		uring_connection->refs += 1;
 
-		else {
-			if (thpool_is_full (cerver->thpool)) {
-				#ifdef HANDLER_DEBUG
-				cerver_log (
-					LOG_TYPE_DEBUG, LOG_TYPE_HANDLER,
-					"Cerver %s thpool is full! "
-					"Creating a detachable thread for sock fd <%d> connection...",
-					cerver->info->name, connection->socket->sock_fd
-				);
-				#endif
+		retval = 0;
+	}
 
-				retval = cerver_register_new_connection_normal_default_create_detachable (cr);
-			}
+	return retval;
 
-			else {
-				if (!thpool_add_work (
-					cerver->thpool,
-					(void (*) (void *)) cerver_receive_threads,
-					cr
-				)) {
-					#ifdef HANDLER_DEBUG
-					cerver_log (
-						LOG_TYPE_DEBUG, LOG_TYPE_HANDLER,
-						"Added work for sock fd <%d> connection to the thpool!",
-						connection->socket->sock_fd
-					);
+}
 
-					cerver_log (
-						LOG_TYPE_DEBUG, LOG_TYPE_HANDLER,
-						"Cerver %s thpool - %d / %d threads working",
-						cerver->info->name,
-						thpool_get_num_threads_working (cerver->thpool),
-						cerver->thpool->num_threads_alive
-					);
-					#endif
+// must be called with the uring's lock
+static void cerver_uring_cancel (
+	CerverUring *uring, CerverUringConnection *uring_connection, const u64 op
+) {
 
-					retval = 0;     // success
-				}
+	struct io_uring_sqe *sqe = cerver_uring_get_sqe (uring);
+	if (sqe) {
+		sqe->opcode = IORING_OP_ASYNC_CANCEL;
+		sqe->fd = -1;
+		sqe->addr = cerver_uring_user_data (uring_connection, op);
+		sqe->cancel_flags = IORING_ASYNC_CANCEL_ALL;
+		sqe->user_data = CERVER_URING_OP_CANCEL;
+	}
+
+}
+
+// multishot receives were added in linux 6.0
+static bool cerver_uring_kernel_supported (void) {
 
-				else {
-					cerver_receive_delete (cr);
-				}
-			}
+	bool retval = false;
+
+	struct utsname name = { 0 };
+	if (!uname (&name)) {
+		unsigned int major = 0;
+		unsigned int minor = 0;
+		if (sscanf (name.release, "%u.%u", &major, &minor) == 2) {
+			retval = (major >= 6);
 		}
 	}
 
@@ -2373,627 +6213,613 @@ static u8 cerver_register_new_connection_normal_default_select_handler_threads (
 
 }
 
-#pragma GCC diagnostic pop
-
-// select how client connection will be handled based on cerver's handler type
-u8 cerver_register_new_connection_normal_default_select_handler (
-	Cerver *cerver, Client *client, Connection *connection
-) {
+static CerverUring *cerver_uring_create (Cerver *cerver) {
 
-	u8 retval = 1;
+	CerverUring *uring = cerver_uring_new ();
+	if (uring) {
+		static const u8 ops[] = {
+			IORING_OP_ACCEPT, IORING_OP_RECV,
+			IORING_OP_SENDMSG, IORING_OP_ASYNC_CANCEL
+		};
 
-	switch (cerver->handler_type) {
-		case CERVER_HANDLER_TYPE_NONE: break;
+		uring->lock = thread_mutex_new ();
 
-		case CERVER_HANDLER_TYPE_POLL: {
-			// nothing to be done, as connection will be handled by poll ()
-			// after being registered to the cerver
-			retval = 0;     // success
-		} break;
+		uring->ring = uring_create (
+			CERVER_URING_ENTRIES, CERVER_URING_ENTRIES * 4
+		);
 
-		// handle connection in dedicated thread
-		case CERVER_HANDLER_TYPE_THREADS: {
-			retval = cerver_register_new_connection_normal_default_select_handler_threads (
-				cerver, client, connection
+		if (
+			uring->lock && uring->ring
+			&& (uring->ring->features & IORING_FEAT_EXT_ARG)
+			&& (uring->ring->features & IORING_FEAT_NODROP)
+			&& uring_probe_ops (uring->ring, ops, sizeof (ops))
+		) {
+			uring->buffers = uring_buf_ring_create (
+				uring->ring, CERVER_URING_BUFFERS_GROUP,
+				CERVER_URING_N_BUFFERS, cerver->receive_buffer_size
 			);
-		} break;
+		}
 
-		default: break;
+		if (!uring->buffers) {
+			cerver_uring_delete (uring);
+			uring = NULL;
+		}
+	}
+
+	return uring;
+
+}
+
+// creates the cerver's io_uring instance & its provided buffers
+// returns 0 on success, 1 if io_uring is not available
+// in that case, the cerver should use CERVER_HANDLER_TYPE_EPOLL instead
+u8 cerver_uring_init (Cerver *cerver) {
+
+	u8 retval = 1;
+
+	if (cerver) {
+		if (cerver_uring_kernel_supported ()) {
+			cerver->uring = cerver_uring_create (cerver);
+			if (cerver->uring) retval = 0;
+		}
+
+		if (retval) {
+			cerver_log (
+				LOG_TYPE_WARNING, LOG_TYPE_CERVER,
+				"io_uring is NOT available for cerver %s!",
+				cerver->info->name
+			);
+		}
 	}
 
 	return retval;
 
 }
 
-static u8 cerver_register_new_connection_normal_default (
+// closes the cerver's io_uring instance
+// any pending request gets cancelled
+void cerver_uring_end (Cerver *cerver) {
+
+	if (cerver) {
+		if (cerver->uring) {
+			// the last sends that were prepared by the ring thread
+			(void) uring_submit (cerver->uring->ring);
+
+			cerver_uring_delete (cerver->uring);
+			cerver->uring = NULL;
+		}
+	}
+
+}
+
+// starts receiving the connection's data with a multishot receive
+// the connection always gets a send queue to be flushed by the ring
+// returns 0 on success, 1 on error
+u8 cerver_uring_register_connection (
 	Cerver *cerver, Connection *connection
 ) {
 
 	u8 retval = 1;
 
-	Client *client = client_create ();
-	if (client) {
-		(void) connection_register_to_client (client, connection);
+	if (cerver && cerver->uring && connection) {
+		CerverUring *uring = cerver->uring;
 
-		if (!client_register_to_cerver (cerver, client)) {
-			connection->active = true;
+		if (!connection->send_queue) {
+			connection_set_send_queue (connection, 0);
+			connection_set_send_queue_high_water (
+				connection,
+				cerver->connections_send_queue_high_water,
+				cerver->connections_send_queue_overflow
+			);
+		}
 
-			(void) cerver_info_send_info_packet (cerver, client, connection);
+		if (connection->send_queue) {
+			(void) pthread_mutex_lock (uring->lock);
 
-			// TODO: better error handling
-			if (!cerver_register_new_connection_normal_default_select_handler (
-				cerver, client, connection
-			)) {
-				cerver_event_trigger (
-					CERVER_EVENT_CLIENT_CONNECTED,
-					cerver,
-					client, connection
-				);
+			CerverUringConnection *uring_connection = cerver_uring_connection_new (
+				uring, connection
+			);
 
-				retval = 0;
+			if (uring_connection) {
+				if (!cerver_uring_receive (uring, uring_connection)) {
+					cerver_uring_submit (uring);
+
+					connection->uring = uring_connection;
+
+					STATS_ADD (cerver->stats->current_active_client_connections, 1);
+
+					#ifdef HANDLER_DEBUG
+					cerver_log (
+						LOG_TYPE_DEBUG, LOG_TYPE_CERVER,
+						"Added sock fd <%d> to cerver %s io_uring",
+						connection->socket->sock_fd, cerver->info->name
+					);
+					#endif
+
+					retval = 0;
+				}
+
+				else {
+					cerver_uring_connection_release (uring, uring_connection);
+				}
 			}
+
+			(void) pthread_mutex_unlock (uring->lock);
 		}
-	}
 
-	else {
-		cerver_log_error (
-			"cerver_register_new_connection_normal_default () - "
-			"Failed to create new client for new connection with sock fd <%d>!",
-			connection->socket->sock_fd
-		);
+		if (retval) {
+			cerver_log (
+				LOG_TYPE_ERROR, LOG_TYPE_CERVER,
+				"Failed to add sock fd <%d> to cerver %s io_uring!",
+				connection->socket->sock_fd, cerver->info->name
+			);
+		}
 	}
 
 	return retval;
 
 }
 
-static u8 cerver_register_new_connection_normal (
+// cancels the connection's requests in the ring
+// returns 0 on success, 1 on error
+u8 cerver_uring_unregister_connection (
 	Cerver *cerver, Connection *connection
 ) {
 
 	u8 retval = 1;
 
-	switch (cerver->type) {
-		case CERVER_TYPE_WEB: break;
+	if (cerver && cerver->uring && connection && connection->uring) {
+		CerverUring *uring = cerver->uring;
+		CerverUringConnection *uring_connection = connection->uring;
 
-		default: {
-			retval = cerver_register_new_connection_normal_default (
-				cerver, connection
-			);
-		} break;
-	}
+		// no more sends will be submitted for this connection
+		(void) pthread_mutex_lock (connection->send_queue->mutex);
+		connection->uring = NULL;
+		(void) pthread_mutex_unlock (connection->send_queue->mutex);
 
-	return retval;
+		(void) pthread_mutex_lock (uring->lock);
 
-}
+		uring_connection->connection = NULL;
 
-static inline u8 cerver_register_new_connection_select (
-	Cerver *cerver, Connection *connection
-) {
+		// the sock fd is about to be closed & it might be reused
+		// so the requests are cancelled right away
+		cerver_uring_cancel (uring, uring_connection, CERVER_URING_OP_RECV);
+		cerver_uring_cancel (uring, uring_connection, CERVER_URING_OP_SEND);
+		if (uring_submit (uring->ring) > 0) uring->stats.n_submits += 1;
 
-	return cerver->auth_required ?
-		cerver_register_new_connection_auth_required (cerver, connection) :
-		cerver_register_new_connection_normal (cerver, connection);
+		cerver_uring_connection_release (uring, uring_connection);
 
-}
+		(void) pthread_mutex_unlock (uring->lock);
 
-static void cerver_register_new_connection (
-	Cerver *cerver,
-	const i32 new_fd, const struct sockaddr_storage *client_address
-) {
+		STATS_SUB (cerver->stats->current_active_client_connections, 1);
 
-	Connection *connection = cerver_connection_create (
-		cerver, new_fd, client_address
-	);
-	
-	if (connection) {
-		// #ifdef CERVER_DEBUG
+		#ifdef HANDLER_DEBUG
 		cerver_log (
-			LOG_TYPE_DEBUG, LOG_TYPE_CLIENT,
-			"New connection from IP address: %s -- Port: %d",
-			connection->ip, connection->port
+			LOG_TYPE_DEBUG, LOG_TYPE_CERVER,
+			"Removed sock fd <%d> from cerver %s io_uring",
+			connection->socket->sock_fd, cerver->info->name
 		);
-		// #endif
+		#endif
 
-		connection->active = true;
+		retval = 0;
+	}
 
-		if (!cerver_register_new_connection_select (cerver, connection)) {
-			#ifdef CERVER_DEBUG
-			cerver_log (
-				LOG_TYPE_SUCCESS, LOG_TYPE_CERVER,
-				"New connection to cerver %s!", cerver->info->name
-			);
-			#endif
-		}
+	return retval;
 
-		// internal server error - failed to handle the new connection
-		else {
-			cerver_log_error (
-				"cerver_register_new_connection () "
-				"- internal error - dropping sock fd <%d> connection...",
-				connection->socket->sock_fd
-			);
+}
 
-			connection_drop (cerver, connection);
-		}
-	}
+// submits a send with the connection's pending data
+// if there is no other send in flight
+// must be called with the connection's send queue mutex locked
+void cerver_uring_send_queue_flush (Connection *connection) {
 
-	else {
-		// FIXME: close the socket and cleanup
-		// #ifdef CERVER_DEBUG
-		cerver_log (
-			LOG_TYPE_ERROR, LOG_TYPE_CLIENT,
-			"cerver_register_new_connection () - failed to create a new connection!"
+	CerverUringConnection *uring_connection = connection->uring;
+	if (uring_connection) {
+		CerverUring *uring = uring_connection->owner;
+
+		int iovcnt = send_queue_begin (
+			connection->send_queue, uring_connection->iov
 		);
-		// #endif
+
+		if (iovcnt) {
+			uring_connection->msg.msg_iovlen = (size_t) iovcnt;
+
+			(void) pthread_mutex_lock (uring->lock);
+
+			struct io_uring_sqe *sqe = cerver_uring_get_sqe (uring);
+			if (sqe) {
+				// the kernel keeps sending until every byte has been sent
+				sqe->opcode = IORING_OP_SENDMSG;
+				sqe->fd = connection->socket->sock_fd;
+				sqe->addr = (u64) (uintptr_t) &uring_connection->msg;
+				sqe->len = 1;
+				sqe->msg_flags = (u32) (connection->send_flags | MSG_WAITALL | MSG_NOSIGNAL);
+				sqe->user_data = cerver_uring_user_data (
+					uring_connection, CERVER_URING_OP_SEND
+				);
+
+				uring_connection->refs += 1;
+
+				cerver_uring_submit (uring);
+			}
+
+			else {
+				send_queue_complete (connection->send_queue, 0);
+			}
+
+			(void) pthread_mutex_unlock (uring->lock);
+		}
 	}
 
 }
 
-// accepst a new connection to the cerver
-static void cerver_accept (void *cerver_ptr) {
+// the addresses are not reported by the multishot accept
+static inline void cerver_uring_handle_accept (
+	Cerver *cerver, CerverUring *uring,
+	const i32 res, const u32 flags
+) {
 
-	Cerver *cerver = (Cerver *) cerver_ptr;
+	if (res >= 0) {
+		uring->stats.n_accepts += 1;
 
-	struct sockaddr_storage client_address = { 0 };
-	// (void) memset (&client_address, 0, sizeof (struct sockaddr_storage));
-	socklen_t socklen = sizeof (struct sockaddr_storage);
+		struct sockaddr_storage client_address = { 0 };
+		socklen_t socklen = sizeof (struct sockaddr_storage);
+		(void) getpeername (res, (struct sockaddr *) &client_address, &socklen);
 
-	// accept the new connection
-	i32 new_fd = accept (cerver->sock, (struct sockaddr *) &client_address, &socklen);
-	if (new_fd > 0) {
 		#ifdef HANDLER_DEBUG
-		cerver_log_debug ("Accepted fd: %d", new_fd);
+		cerver_log_debug ("Accepted fd: %d", res);
 		#endif
-		cerver_register_new_connection (cerver, new_fd, &client_address);
+
+		cerver_register_new_connection (cerver, res, &client_address);
 	}
 
-	else {
-		// if we get EWOULDBLOCK, we have accepted all connections
-		if (errno != EWOULDBLOCK) {
-			cerver_log (LOG_TYPE_ERROR, LOG_TYPE_CERVER, "Accept failed!");
-			perror ("Error");
-		}
+	else if (res != -ECANCELED) {
+		cerver_log (
+			LOG_TYPE_ERROR, LOG_TYPE_CERVER,
+			"Cerver %s io_uring accept failed: %s",
+			cerver->info->name, strerror (-res)
+		);
 	}
 
-}
+	if (!(flags & IORING_CQE_F_MORE) && cerver->isRunning) {
+		uring->stats.n_rearms += 1;
 
-#pragma endregion
+		(void) pthread_mutex_lock (uring->lock);
+		(void) cerver_uring_accept (cerver, uring);
+		(void) pthread_mutex_unlock (uring->lock);
+	}
 
-#pragma region register
+}
 
-// select how a connection will be handled
-// based on cerver's handler type
-// returns 0 on success, 1 on error
-u8 cerver_handler_register_connection (
-	Cerver *cerver, Client *client, Connection *connection
+// the connection's send queue is corked while handling the received data
+// so that the responses to every packet are sent together afterwards
+static inline void cerver_uring_handle_receive_data (
+	Cerver *cerver, Connection *connection,
+	CerverReceive *cr, char *buffer, const size_t received
 ) {
 
-	u8 retval = 1;
+	cerver_receive_init_full (
+		cr, RECEIVE_TYPE_NORMAL, cerver, connection->client, connection
+	);
 
-	if (cerver && connection) {
-		switch (cerver->handler_type) {
-			case CERVER_HANDLER_TYPE_NONE: break;
+	const i32 sock_fd = connection->socket->sock_fd;
+	const bool corked = connection_send_queue_cork (connection);
 
-			// handle connection using the cerver's poll
-			case CERVER_HANDLER_TYPE_POLL: {
-				retval = cerver_poll_register_connection (
-					cerver, connection
-				);
-			} break;
+	connection->receive_handle.n_packets = 0;
 
-			// handle connection in dedicated thread
-			case CERVER_HANDLER_TYPE_THREADS: {
-				retval = cerver_register_new_connection_normal_default_select_handler_threads (
-					cerver, client, connection
-				);
-			} break;
+	cerver_receive_success (cr, received, buffer, cerver->receive_buffer_size);
 
-			default: break;
-		}
-	}
+	CerverStatsShard *shard = cerver_stats_shard (cerver);
+	STATS_ADD (shard->receive_wakeups, 1);
+	STATS_ADD (shard->receive_wakeups_bytes, received);
 
-	return retval;
+	// the connection might have been dropped while handling its packets
+	if (corked && cerver_receive_is_alive (cr, sock_fd)) {
+		connection_send_queue_uncork (connection);
+	}
 
 }
 
-#pragma endregion
+static inline void cerver_uring_handle_receive (
+	Cerver *cerver, CerverUring *uring,
+	CerverUringConnection *uring_connection,
+	CerverReceive *cr, const i32 res, const u32 flags
+) {
 
-#pragma region poll
+	Connection *connection = uring_connection->connection;
 
-// reallocs main cerver poll fds
-// returns 0 on success, 1 on error
-u8 cerver_realloc_main_poll_fds (Cerver *cerver) {
+	if (res > 0) {
+		const u16 bid = (u16) (flags >> IORING_CQE_BUFFER_SHIFT);
 
-	u8 retval = 1;
+		uring->stats.n_receives += 1;
+		uring->stats.bytes_received += (u64) res;
 
-	if (cerver) {
-		u32 current_max = cerver->max_n_fds;
-		cerver->max_n_fds *= 2;
-		cerver->fds = (struct pollfd *) realloc (
-			cerver->fds, cerver->max_n_fds * sizeof (struct pollfd)
-		);
+		if (connection) {
+			cerver_uring_handle_receive_data (
+				cerver, connection, cr,
+				uring_buf_ring_get (uring->buffers, bid), (size_t) res
+			);
+		}
 
-		if (cerver->fds) {
-			#pragma GCC diagnostic push
-			#pragma GCC diagnostic ignored "-Wunused-value"
+		uring_buf_ring_recycle (uring->buffers, bid);
+	}
 
-			for (u32 i = current_max; i < cerver->max_n_fds; i++)
-				cerver->fds[i].fd == -1;
+	else if (res == -ENOBUFS) {
+		uring->stats.n_no_buffers += 1;
+	}
 
-			#pragma GCC diagnostic pop
+	// an orderly shutdown or a socket error
+	else if ((res != -ECANCELED) && connection) {
+		cerver_receive_init_full (
+			cr, RECEIVE_TYPE_NORMAL, cerver, connection->client, connection
+		);
 
-			retval = 0;
-		}
+		cerver_receive_handle_failed (cr);
 	}
 
-	return retval;
+	if (!(flags & IORING_CQE_F_MORE)) {
+		(void) pthread_mutex_lock (uring->lock);
 
-}
+		// the receive has stopped but the connection is still registered
+		if (uring_connection->connection && ((res > 0) || (res == -ENOBUFS))) {
+			uring->stats.n_rearms += 1;
+			(void) cerver_uring_receive (uring, uring_connection);
+		}
 
-// get a free index in the main cerver poll array
-i32 cerver_poll_get_free_idx (Cerver *cerver) {
+		cerver_uring_connection_release (uring, uring_connection);
 
-	if (cerver) {
-		for (u32 i = 0; i < cerver->max_n_fds; i++)
-			if (cerver->fds[i].fd == -1) return i;
+		(void) pthread_mutex_unlock (uring->lock);
 	}
 
-	return -1;
-
 }
 
-// get the idx of the connection sock fd in the cerver poll fds
-i32 cerver_poll_get_idx_by_sock_fd (Cerver *cerver, i32 sock_fd) {
+// the rest of the data is sent if the send was short
+// or if more data was queued while the send was in flight
+static inline void cerver_uring_handle_send (
+	CerverUring *uring, CerverUringConnection *uring_connection,
+	const i32 res
+) {
+
+	uring->stats.n_sends += 1;
+
+	Connection *connection = uring_connection->connection;
+	if (connection) {
+		SendQueue *queue = connection->send_queue;
+
+		(void) pthread_mutex_lock (queue->mutex);
+
+		if (uring_connection->connection == connection) {
+			send_queue_complete (queue, (res > 0) ? (size_t) res : 0);
+
+			if (res > 0) {
+				uring->stats.bytes_sent += (u64) res;
+
+				if (!queue->corked) cerver_uring_send_queue_flush (connection);
+			}
+
+			// the receive will report the failure & end the connection
+			else if (res != -ECANCELED) {
+				(void) shutdown (connection->socket->sock_fd, SHUT_RDWR);
+			}
+		}
 
-	if (cerver) {
-		for (u32 i = 0; i < cerver->max_n_fds; i++)
-			if (cerver->fds[i].fd == sock_fd) return i;
+		(void) pthread_mutex_unlock (queue->mutex);
 	}
 
-	return -1;
+	(void) pthread_mutex_lock (uring->lock);
+	cerver_uring_connection_release (uring, uring_connection);
+	(void) pthread_mutex_unlock (uring->lock);
 
 }
 
-static u8 cerver_poll_register_connection_internal (
-	Cerver *cerver, Connection *connection
+static void cerver_uring_handle (
+	Cerver *cerver, CerverUring *uring, CerverReceive *cr
 ) {
 
-	u8 retval = 1;
+	struct io_uring_cqe *cqe = NULL;
+	u64 user_data = 0;
+	i32 res = 0;
+	u32 flags = 0;
 
-	i32 idx = cerver_poll_get_free_idx (cerver);
-	if (idx > 0) {
-		cerver->fds[idx].fd = connection->socket->sock_fd;
-		cerver->fds[idx].events = POLLIN;
-		cerver->current_n_fds++;
+	while ((cqe = uring_peek_cqe (uring->ring))) {
+		user_data = cqe->user_data;
+		res = cqe->res;
+		flags = cqe->flags;
 
-		cerver->stats->current_active_client_connections++;
+		uring_cqe_seen (uring->ring);
 
-		#ifdef CERVER_DEBUG
-		cerver_log (
-			LOG_TYPE_DEBUG, LOG_TYPE_CERVER,
-			"Added sock fd <%d> to cerver %s MAIN poll, idx: %i",
-			connection->socket->sock_fd, cerver->info->name, idx
-		);
-		#endif
+		uring->stats.n_completions += 1;
 
-		#ifdef CERVER_STATS
-		cerver_log (
-			LOG_TYPE_CERVER, LOG_TYPE_NONE,
-			"Cerver %s current active connections: %ld",
-			cerver->info->name,
-			cerver->stats->current_active_client_connections
+		CerverUringConnection *uring_connection = (CerverUringConnection *) (uintptr_t) (
+			user_data & ~((u64) CERVER_URING_OP_MASK)
 		);
-		#endif
 
-		retval = 0;
-	}
+		switch (user_data & CERVER_URING_OP_MASK) {
+			case CERVER_URING_OP_ACCEPT:
+				cerver_uring_handle_accept (cerver, uring, res, flags);
+				break;
 
-	return retval;
+			case CERVER_URING_OP_RECV:
+				cerver_uring_handle_receive (
+					cerver, uring, uring_connection, cr, res, flags
+				);
+				break;
 
-}
+			case CERVER_URING_OP_SEND:
+				cerver_uring_handle_send (uring, uring_connection, res);
+				break;
 
-// regsiters a client connection to the cerver's mains poll structure
-// and maps the sock fd to the client
-// returns 0 on success, 1 on error
-u8 cerver_poll_register_connection (
-	Cerver *cerver, Connection *connection
-) {
+			default: break;
+		}
+	}
 
-	u8 retval = 1;
+}
 
-	if (cerver && connection) {
-		pthread_mutex_lock (cerver->poll_lock);
+static void cerver_uring_loop (Cerver *cerver, CerverUring *uring) {
 
-		if (!cerver_poll_register_connection_internal (
-			cerver, connection
-		)) {
-			retval = 0;
-		}
+	CerverReceive cr = { 0 };
 
-		else {
-			#ifdef CERVER_DEBUG
-			cerver_log (
-				LOG_TYPE_WARNING, LOG_TYPE_NONE,
-				"Cerver %s main poll is full -- we need to realloc...",
-				cerver->info->name
-			);
-			#endif
+	int rc = 0;
+	while (cerver->isRunning) {
+		(void) pthread_mutex_lock (uring->lock);
+		if (uring_submit (uring->ring) > 0) uring->stats.n_submits += 1;
+		(void) pthread_mutex_unlock (uring->lock);
+
+		if (!uring_peek_cqe (uring->ring)) {
+			rc = uring_wait (uring->ring, 1, (int) cerver->poll_timeout);
 
-			if (cerver_realloc_main_poll_fds (cerver)) {
+			// interrupted by a signal or nothing happened
+			if (rc && (rc != -EINTR) && (rc != -ETIME)) {
 				cerver_log (
-					LOG_TYPE_ERROR, LOG_TYPE_NONE,
-					"Failed to realloc cerver %s main poll fds!",
-					cerver->info->name
+					LOG_TYPE_ERROR, LOG_TYPE_CERVER,
+					"Cerver %s io_uring has failed: %s",
+					cerver->info->name, strerror (-rc)
 				);
-			}
 
-			// try again to register the connection
-			else {
-				retval = cerver_poll_register_connection_internal (
-					cerver, connection
-				);
+				cerver->isRunning = false;
+				break;
 			}
 		}
 
-		pthread_mutex_unlock (cerver->poll_lock);
-	}
+		// the cerver might have been teardown while waiting
+		if (!cerver->uring) break;
 
-	return retval;
+		cerver_uring_handle (cerver, uring, &cr);
+	}
 
 }
 
-// removes a sock fd from the cerver's main poll array
-// returns 0 on success, 1 on error
-u8 cerver_poll_unregister_sock_fd (Cerver *cerver, const i32 sock_fd) {
+// server io_uring loop to handle the completions
+// of the accept, receive & send requests
+u8 cerver_uring (Cerver *cerver) {
 
 	u8 retval = 1;
 
-	if (cerver) {
-		pthread_mutex_lock (cerver->poll_lock);
+	if (cerver && cerver->uring) {
+		CerverUring *uring = cerver->uring;
+		uring->thread_id = pthread_self ();
 
-		// get the idx of the sock fd in the cerver poll fds
-		i32 idx = cerver_poll_get_idx_by_sock_fd (cerver, sock_fd);
-		if (idx > 0) {
-			cerver->fds[idx].fd = -1;
-			cerver->fds[idx].events = -1;
-			cerver->current_n_fds--;
+		(void) pthread_mutex_lock (uring->lock);
+		u8 errors = cerver_uring_accept (cerver, uring);
+		(void) pthread_mutex_unlock (uring->lock);
 
-			cerver->stats->current_active_client_connections--;
+		if (!errors) {
+			cerver_log (
+				LOG_TYPE_SUCCESS, LOG_TYPE_CERVER,
+				"Cerver %s is ready in port %d!",
+				cerver->info->name, cerver->port
+			);
 
 			#ifdef CERVER_DEBUG
 			cerver_log (
 				LOG_TYPE_DEBUG, LOG_TYPE_CERVER,
-				"Removed sock fd <%d> from cerver %s MAIN poll, idx: %d",
-				sock_fd, cerver->info->name, idx
+				"Waiting for connections..."
 			);
 			#endif
 
-			#ifdef CERVER_STATS
+			cerver_uring_loop (cerver, uring);
+
+			#ifdef CERVER_DEBUG
 			cerver_log (
 				LOG_TYPE_CERVER, LOG_TYPE_NONE,
-				"Cerver %s current active connections: %ld",
-				cerver->info->name,
-				cerver->stats->current_active_client_connections
+				"Cerver %s main io_uring has stopped!",
+				cerver->info->name
 			);
 			#endif
 
-			retval = 0;     // removed the sock fd form the cerver poll
+			retval = 0;
 		}
 
 		else {
-			// #ifdef CERVER_DEBUG
 			cerver_log (
-				LOG_TYPE_WARNING, LOG_TYPE_CERVER,
-				"Sock fd <%d> was NOT found in cerver %s MAIN poll!",
-				sock_fd, cerver->info->name
+				LOG_TYPE_ERROR, LOG_TYPE_CERVER,
+				"Failed to accept connections in cerver %s io_uring!",
+				cerver->info->name
 			);
-			// #endif
 		}
+	}
 
-		pthread_mutex_unlock (cerver->poll_lock);
+	else {
+		cerver_log (
+			LOG_TYPE_ERROR, LOG_TYPE_CERVER,
+			"Can't listen for connections on a cerver without io_uring!"
+		);
 	}
 
 	return retval;
 
 }
 
-// unregsiters a client connection from the cerver's main poll structure
-// returns 0 on success, 1 on error
-u8 cerver_poll_unregister_connection (Cerver *cerver, Connection *connection) {
+#else
 
-	return (cerver && connection) ?
-		cerver_poll_unregister_sock_fd (cerver, connection->socket->sock_fd) : 1;
+void cerver_uring_delete (void *uring_ptr) {
+
+	if (uring_ptr) free (uring_ptr);
 
 }
 
-static inline void cerver_poll_handle_actual_accept (Cerver *cerver) {
+// the library was built without IO_URING=1
+u8 cerver_uring_init (Cerver *cerver) {
 
-	if (cerver->thpool) {
-		if (thpool_add_work (cerver->thpool, cerver_accept, cerver))  {
-			cerver_log_error (
-				"Failed to add cerver_accept () to cerver's %s thpool!",
-				cerver->info->name
-			);
-		}
+	if (cerver) {
+		cerver_log (
+			LOG_TYPE_WARNING, LOG_TYPE_CERVER,
+			"Cerver %s was built without io_uring support!",
+			cerver->info->name
+		);
 	}
 
-	else {
-		cerver_accept (cerver);
-	}
+	return 1;
 
 }
 
-static inline void cerver_poll_handle_actual_receive (
-	Cerver *cerver,
-	struct pollfd *active_fd,
-	char *packet_buffer
-) {
-
-	// TODO: as we will not use threads anymore,
-	// there is no need of allocating a new structure each time
-	// we need to handle a connection
-	CerverReceive *cr = cerver_receive_create (
-		RECEIVE_TYPE_NORMAL, cerver, active_fd->fd
-	);
-
-	if (cr) {
-		switch (active_fd->revents) {
-			// A connection setup has been completed or new data arrived
-			case POLLIN: {
-				// printf ("Receive fd: %d\n", cerver->fds[i].fd);
-
-				// receive all incoming data from the socket
-				// and handle the packets in the same thread
-				cerver_receive_internal (
-					cr,
-					packet_buffer, cerver->receive_buffer_size
-				);
-			} break;
-
-			// A disconnection request has been initiated by the other end
-			// or a connection is broken (SIGPIPE is also set when we try to write to it)
-			// or The other end has shut down one direction
-			case POLLHUP: {
-				// printf ("POLLHUP\n");
-				cerver_receive_handle_failed (cr);
-			} break;
-
-			// An asynchronous error occurred
-			case POLLERR: {
-				// printf ("POLLERR\n");
-				cerver_receive_handle_failed (cr);
-			} break;
-
-			// Urgent data arrived. SIGURG is sent then.
-			case POLLPRI: break;
-
-			default: {
-				if (active_fd->revents != 0) {
-					cerver_receive_handle_failed (cr);
-				}
-			} break;
-		}
+void cerver_uring_end (Cerver *cerver) {
 
-		cerver_receive_delete (cr);
+	if (cerver) {
+		cerver_uring_delete (cerver->uring);
+		cerver->uring = NULL;
 	}
 
 }
 
-static inline void cerver_poll_handle (
-	Cerver *cerver, char *packet_buffer
+u8 cerver_uring_register_connection (
+	Cerver *cerver, Connection *connection
 ) {
 
-	// one or more fd(s) are readable, need to determine which ones they are
-	for (u32 idx = 0; idx < cerver->max_n_fds; idx++) {
-		if (cerver->fds[idx].fd > -1) {
-			if (idx == 0) {
-				// the cerver's sock fd has an event
-				cerver_poll_handle_actual_accept (cerver);
-			}
+	(void) cerver;
+	(void) connection;
 
-			else {
-				cerver_poll_handle_actual_receive (
-					cerver,
-					&cerver->fds[idx],
-					packet_buffer
-				);
-			}
-		}
-	}
+	return 1;
 
 }
 
-// cerver poll loop to handle events in the registered socket's fds
-u8 cerver_poll (Cerver *cerver) {
-
-	u8 retval = 1;
-
-	if (cerver) {
-		cerver_log (
-			LOG_TYPE_SUCCESS, LOG_TYPE_CERVER,
-			"Cerver %s is ready in port %d!",
-			cerver->info->name, cerver->port
-		);
-
-		#ifdef CERVER_DEBUG
-		cerver_log (
-			LOG_TYPE_DEBUG, LOG_TYPE_CERVER,
-			"Waiting for connections..."
-		);
-		#endif
-
-		char *packet_buffer = (char *) calloc (
-			cerver->receive_buffer_size, sizeof (char)
-		);
-
-		if (packet_buffer) {
-			int poll_retval = 0;
-			while (cerver->isRunning) {
-				poll_retval = poll (
-					cerver->fds,
-					cerver->max_n_fds,
-					cerver->poll_timeout
-				);
-
-				switch (poll_retval) {
-					case -1: {
-						cerver_log (
-							LOG_TYPE_ERROR, LOG_TYPE_CERVER,
-							"Cerver %s main poll has failed!",
-							cerver->info->name
-						);
+u8 cerver_uring_unregister_connection (
+	Cerver *cerver, Connection *connection
+) {
 
-						perror ("Error");
-						cerver->isRunning = false;
-					} break;
+	(void) cerver;
+	(void) connection;
 
-					case 0: {
-						// #ifdef CERVER_DEBUG
-						// cerver_log_debug (
-						// 	"Cerver %s MAIN poll timeout",
-						// 	cerver->info->name
-						// );
-						// #endif
-					} break;
+	return 1;
 
-					default: {
-						cerver_poll_handle (cerver, packet_buffer);
-					} break;
-				}
-			}
+}
 
-			#ifdef CERVER_DEBUG
-			cerver_log (
-				LOG_TYPE_CERVER, LOG_TYPE_NONE,
-				"Cerver %s main poll has stopped!",
-				cerver->info->name
-			);
-			#endif
+void cerver_uring_send_queue_flush (Connection *connection) {
 
-			free (packet_buffer);
+	(void) connection;
 
-			retval = 0;
-		}
+}
 
-		else {
-			cerver_log_error (
-				"Failed to allocate cerver poll's packet buffer!"
-			);
-		}
-	}
+u8 cerver_uring (Cerver *cerver) {
 
-	else {
-		cerver_log (
-			LOG_TYPE_ERROR, LOG_TYPE_CERVER,
-			"Can't listen for connections on a NULL cerver!"
-		);
-	}
+	(void) cerver;
 
-	return retval;
+	return 1;
 
 }
 
+#endif
+
 #pragma endregion
 
 #pragma region threads
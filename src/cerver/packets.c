@@ -9,14 +9,18 @@
 #include "cerver/config.h"
 
 #include <fcntl.h>
+#include <pthread.h>
 
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 
 #include "cerver/types/types.h"
 
 #include "cerver/cerver.h"
 #include "cerver/client.h"
+#include "cerver/connection.h"
+#include "cerver/handler.h"
 #include "cerver/network.h"
 #include "cerver/packets.h"
 
@@ -132,7 +136,10 @@ void packet_version_print (
 
 PacketsPerType *packets_per_type_new (void) {
 
-	PacketsPerType *packets_per_type = (PacketsPerType *) malloc (sizeof (PacketsPerType));
+	PacketsPerType *packets_per_type = (PacketsPerType *) aligned_alloc (
+		PACKETS_CACHE_LINE, sizeof (PacketsPerType)
+	);
+
 	if (packets_per_type) {
 		(void) memset (packets_per_type, 0, sizeof (PacketsPerType));
 	}
@@ -147,23 +154,82 @@ void packets_per_type_delete (void *packets_per_type_ptr) {
 
 }
 
+void packets_per_type_count (
+	PacketsPerType *packets_per_type,
+	const PacketType packet_type, const u32 request_type
+) {
+
+	const unsigned int type = (unsigned int) packet_type;
+
+	STATS_ADD (
+		packets_per_type->packets[
+			(type < PACKETS_MAX_TYPES) ? type : PACKETS_UNKNOWN_TYPE
+		], 1
+	);
+
+	if (packet_type == PACKET_TYPE_APP) {
+		STATS_ADD (
+			packets_per_type->app_requests[
+				(request_type < PACKETS_MAX_REQUEST_TYPES) ?
+					request_type : PACKETS_MAX_REQUEST_TYPES - 1
+			], 1
+		);
+	}
+
+}
+
+void packets_per_type_count_bad (PacketsPerType *packets_per_type) {
+
+	STATS_ADD (packets_per_type->packets[PACKET_TYPE_BAD], 1);
+
+}
+
+void packets_per_type_add (
+	PacketsPerType *dest, const PacketsPerType *source
+) {
+
+	for (unsigned int idx = 0; idx < PACKETS_MAX_TYPES; idx++)
+		dest->packets[idx] += STATS_GET (source->packets[idx]);
+
+	for (unsigned int idx = 0; idx < PACKETS_MAX_REQUEST_TYPES; idx++)
+		dest->app_requests[idx] += STATS_GET (source->app_requests[idx]);
+
+}
+
 void packets_per_type_print (
 	const PacketsPerType *packets_per_type
 ) {
 
 	if (packets_per_type) {
-		cerver_log_msg ("Cerver:            %lu", packets_per_type->n_cerver_packets);
-		cerver_log_msg ("Client:            %lu", packets_per_type->n_client_packets);
-		cerver_log_msg ("Error:             %lu", packets_per_type->n_error_packets);
-		cerver_log_msg ("Request:           %lu", packets_per_type->n_request_packets);
-		cerver_log_msg ("Auth:              %lu", packets_per_type->n_auth_packets);
-		cerver_log_msg ("Game:              %lu", packets_per_type->n_game_packets);
-		cerver_log_msg ("App:               %lu", packets_per_type->n_app_packets);
-		cerver_log_msg ("App Error:         %lu", packets_per_type->n_app_error_packets);
-		cerver_log_msg ("Custom:            %lu", packets_per_type->n_custom_packets);
-		cerver_log_msg ("Test:              %lu", packets_per_type->n_test_packets);
-		cerver_log_msg ("Unknown:           %lu", packets_per_type->n_unknown_packets);
-		cerver_log_msg ("Bad:               %lu", packets_per_type->n_bad_packets);
+		const u64 *packets = packets_per_type->packets;
+
+		u64 unknown = 0;
+		for (unsigned int idx = PACKET_TYPE_BAD + 1; idx < PACKETS_MAX_TYPES; idx++)
+			unknown += packets[idx];
+
+		cerver_log_msg ("Cerver:            %lu", packets[PACKET_TYPE_CERVER]);
+		cerver_log_msg ("Client:            %lu", packets[PACKET_TYPE_CLIENT]);
+		cerver_log_msg ("Error:             %lu", packets[PACKET_TYPE_ERROR]);
+		cerver_log_msg ("Request:           %lu", packets[PACKET_TYPE_REQUEST]);
+		cerver_log_msg ("Auth:              %lu", packets[PACKET_TYPE_AUTH]);
+		cerver_log_msg ("Game:              %lu", packets[PACKET_TYPE_GAME]);
+		cerver_log_msg ("App:               %lu", packets[PACKET_TYPE_APP]);
+		cerver_log_msg ("App Error:         %lu", packets[PACKET_TYPE_APP_ERROR]);
+		cerver_log_msg ("Custom:            %lu", packets[PACKET_TYPE_CUSTOM]);
+		cerver_log_msg ("Test:              %lu", packets[PACKET_TYPE_TEST]);
+		cerver_log_msg ("Unknown:           %lu", unknown);
+		cerver_log_msg ("Bad:               %lu", packets[PACKET_TYPE_BAD]);
+
+		// only the app requests that have been used
+		for (unsigned int idx = 0; idx < PACKETS_MAX_REQUEST_TYPES; idx++) {
+			if (packets_per_type->app_requests[idx]) {
+				cerver_log_msg (
+					"App request %2u%s     %lu",
+					idx, (idx == (PACKETS_MAX_REQUEST_TYPES - 1)) ? "+:" : ": ",
+					packets_per_type->app_requests[idx]
+				);
+			}
+		}
 	}
 
 }
@@ -283,6 +349,378 @@ void packet_header_log (const PacketHeader *header) {
 
 #pragma endregion
 
+#pragma region pool
+
+// the extra list is used to keep free packets structures
+#define PACKETS_POOL_N_LISTS				(PACKETS_POOL_N_CLASSES + 1)
+#define PACKETS_POOL_PACKETS_LIST			PACKETS_POOL_N_CLASSES
+
+static const size_t packets_pool_sizes[PACKETS_POOL_N_CLASSES] = {
+	#define XX(num, size) size,
+	PACKETS_POOL_CLASS_MAP (XX)
+	#undef XX
+};
+
+// max free items that the shared pool keeps for each list
+// bigger buffers are more expensive to keep around
+static const unsigned int packets_pool_limits[PACKETS_POOL_N_LISTS] = {
+	1024, 1024, 512, 256, 16, 1024
+};
+
+// free items are linked using their first bytes
+typedef struct PacketsPoolList {
+
+	void *head;
+	unsigned int count;
+
+} PacketsPoolList;
+
+// every thread gets its own cache the first time it uses the pool
+// so the common path does not need to take the shared lock
+typedef struct PacketsPoolCache {
+
+	PacketsPoolList lists[PACKETS_POOL_N_LISTS];
+	PacketsPoolStats stats;
+
+	struct PacketsPoolCache *prev;
+	struct PacketsPoolCache *next;
+
+} PacketsPoolCache;
+
+static pthread_once_t packets_pool_once = PTHREAD_ONCE_INIT;
+static pthread_key_t packets_pool_key;
+
+static pthread_mutex_t packets_pool_lock = PTHREAD_MUTEX_INITIALIZER;
+static PacketsPoolList packets_pool_lists[PACKETS_POOL_N_LISTS] = { { NULL, 0 } };
+static PacketsPoolCache *packets_pool_caches = NULL;
+
+// stats from threads that have already exited
+static PacketsPoolStats packets_pool_retired = { 0, 0 };
+
+static inline void *packets_pool_list_pop (PacketsPoolList *list) {
+
+	void *item = list->head;
+	if (item) {
+		list->head = *(void **) item;
+		list->count -= 1;
+	}
+
+	return item;
+
+}
+
+static inline void packets_pool_list_push (
+	PacketsPoolList *list, void *item
+) {
+
+	*(void **) item = list->head;
+	list->head = item;
+	list->count += 1;
+
+}
+
+// moves the items into the shared pool
+// frees the ones that do not fit in it
+// must be called with the shared lock
+static void packets_pool_list_release (
+	PacketsPoolList *list, const unsigned int idx, unsigned int n_items
+) {
+
+	void *item = NULL;
+	while (n_items && (item = packets_pool_list_pop (list))) {
+		if (packets_pool_lists[idx].count < packets_pool_limits[idx]) {
+			packets_pool_list_push (&packets_pool_lists[idx], item);
+		}
+
+		else {
+			free (item);
+		}
+
+		n_items -= 1;
+	}
+
+}
+
+static void packets_pool_list_free (PacketsPoolList *list) {
+
+	void *item = NULL;
+	while ((item = packets_pool_list_pop (list))) {
+		free (item);
+	}
+
+}
+
+// returns the thread's items to the shared pool when it exits
+static void packets_pool_cache_delete (void *cache_ptr) {
+
+	if (cache_ptr) {
+		PacketsPoolCache *cache = (PacketsPoolCache *) cache_ptr;
+
+		(void) pthread_mutex_lock (&packets_pool_lock);
+
+		for (unsigned int idx = 0; idx < PACKETS_POOL_N_LISTS; idx++) {
+			packets_pool_list_release (
+				&cache->lists[idx], idx, cache->lists[idx].count
+			);
+		}
+
+		packets_pool_retired.hits += cache->stats.hits;
+		packets_pool_retired.misses += cache->stats.misses;
+
+		if (cache->prev) cache->prev->next = cache->next;
+		else packets_pool_caches = cache->next;
+
+		if (cache->next) cache->next->prev = cache->prev;
+
+		(void) pthread_mutex_unlock (&packets_pool_lock);
+
+		free (cache);
+	}
+
+}
+
+static void packets_pool_init (void) {
+
+	(void) pthread_key_create (&packets_pool_key, packets_pool_cache_delete);
+
+}
+
+static PacketsPoolCache *packets_pool_cache_get (void) {
+
+	(void) pthread_once (&packets_pool_once, packets_pool_init);
+
+	PacketsPoolCache *cache = (PacketsPoolCache *) pthread_getspecific (
+		packets_pool_key
+	);
+
+	if (!cache) {
+		cache = (PacketsPoolCache *) calloc (1, sizeof (PacketsPoolCache));
+		if (cache) {
+			if (!pthread_setspecific (packets_pool_key, cache)) {
+				(void) pthread_mutex_lock (&packets_pool_lock);
+
+				cache->next = packets_pool_caches;
+				if (packets_pool_caches) packets_pool_caches->prev = cache;
+				packets_pool_caches = cache;
+
+				(void) pthread_mutex_unlock (&packets_pool_lock);
+			}
+
+			else {
+				free (cache);
+				cache = NULL;
+			}
+		}
+	}
+
+	return cache;
+
+}
+
+// gets the size class that fits the requested size
+// returns 0 if the size is bigger than the biggest class
+static inline u8 packets_pool_class_get (const size_t size) {
+
+	u8 data_class = 0;
+
+	for (u8 idx = 0; idx < PACKETS_POOL_N_CLASSES; idx++) {
+		if (size <= packets_pool_sizes[idx]) {
+			data_class = idx + 1;
+			break;
+		}
+	}
+
+	return data_class;
+
+}
+
+static void *packets_pool_get (const unsigned int idx, const size_t size) {
+
+	void *item = NULL;
+
+	PacketsPoolCache *cache = packets_pool_cache_get ();
+	if (cache) {
+		PacketsPoolList *list = &cache->lists[idx];
+
+		// refill the cache from the shared pool
+		if (!list->head) {
+			(void) pthread_mutex_lock (&packets_pool_lock);
+
+			unsigned int n_items = PACKETS_POOL_CACHE_SIZE / 2;
+			while (n_items && packets_pool_lists[idx].head) {
+				packets_pool_list_push (
+					list, packets_pool_list_pop (&packets_pool_lists[idx])
+				);
+
+				n_items -= 1;
+			}
+
+			(void) pthread_mutex_unlock (&packets_pool_lock);
+		}
+
+		if ((item = packets_pool_list_pop (list))) {
+			cache->stats.hits += 1;
+		}
+
+		else {
+			cache->stats.misses += 1;
+		}
+	}
+
+	if (!item) {
+		item = malloc (size);
+	}
+
+	return item;
+
+}
+
+static void packets_pool_release (const unsigned int idx, void *item) {
+
+	PacketsPoolCache *cache = packets_pool_cache_get ();
+	if (cache) {
+		PacketsPoolList *list = &cache->lists[idx];
+
+		// move half of the cache to the shared pool
+		if (list->count >= PACKETS_POOL_CACHE_SIZE) {
+			(void) pthread_mutex_lock (&packets_pool_lock);
+
+			packets_pool_list_release (
+				list, idx, PACKETS_POOL_CACHE_SIZE / 2
+			);
+
+			(void) pthread_mutex_unlock (&packets_pool_lock);
+		}
+
+		packets_pool_list_push (list, item);
+	}
+
+	else {
+		free (item);
+	}
+
+}
+
+// gets a buffer that can hold at least size bytes
+// the size class used is set in data_class
+static void *packets_pool_data_get (const size_t size, u8 *data_class) {
+
+	void *data = NULL;
+
+	*data_class = packets_pool_class_get (size);
+	if (*data_class) {
+		data = packets_pool_get (
+			*data_class - 1, packets_pool_sizes[*data_class - 1]
+		);
+
+		if (!data) *data_class = 0;
+	}
+
+	else {
+		data = malloc (size);
+	}
+
+	return data;
+
+}
+
+static void packets_pool_data_release (void *data, const u8 data_class) {
+
+	if (data) {
+		if (data_class) packets_pool_release (data_class - 1, data);
+		else free (data);
+	}
+
+}
+
+// grows the buffer to hold at least new_size bytes
+// keeping the same buffer if its size class is already big enough
+// the original buffer is kept if the new one fails to be allocated
+static void *packets_pool_data_realloc (
+	void *data, const size_t size, const size_t new_size, u8 *data_class
+) {
+
+	void *new_data = NULL;
+
+	if (*data_class) {
+		if (new_size <= packets_pool_sizes[*data_class - 1]) {
+			new_data = data;
+		}
+
+		else {
+			u8 new_class = 0;
+			new_data = packets_pool_data_get (new_size, &new_class);
+			if (new_data) {
+				(void) memcpy (new_data, data, size);
+				packets_pool_data_release (data, *data_class);
+				*data_class = new_class;
+			}
+		}
+	}
+
+	else {
+		new_data = realloc (data, new_size);
+	}
+
+	return new_data;
+
+}
+
+static inline Packet *packets_pool_packet_get (void) {
+
+	return (Packet *) packets_pool_get (
+		PACKETS_POOL_PACKETS_LIST, sizeof (Packet)
+	);
+
+}
+
+static inline void packets_pool_packet_release (Packet *packet) {
+
+	packets_pool_release (PACKETS_POOL_PACKETS_LIST, packet);
+
+}
+
+// gets the packets pool's hits & misses
+// adding the values of every thread cache
+void packets_pool_stats (PacketsPoolStats *stats) {
+
+	if (stats) {
+		(void) pthread_mutex_lock (&packets_pool_lock);
+
+		*stats = packets_pool_retired;
+		for (
+			PacketsPoolCache *cache = packets_pool_caches;
+			cache;
+			cache = cache->next
+		) {
+			stats->hits += cache->stats.hits;
+			stats->misses += cache->stats.misses;
+		}
+
+		(void) pthread_mutex_unlock (&packets_pool_lock);
+	}
+
+}
+
+// frees all the items in the shared pool & in the calling thread's cache
+// should be called only once at the very end of the program
+void packets_pool_end (void) {
+
+	PacketsPoolCache *cache = packets_pool_cache_get ();
+
+	(void) pthread_mutex_lock (&packets_pool_lock);
+
+	for (unsigned int idx = 0; idx < PACKETS_POOL_N_LISTS; idx++) {
+		if (cache) packets_pool_list_free (&cache->lists[idx]);
+		packets_pool_list_free (&packets_pool_lists[idx]);
+	}
+
+	(void) pthread_mutex_unlock (&packets_pool_lock);
+
+}
+
+#pragma endregion
+
 #pragma region packets
 
 u8 packet_append_data (
@@ -292,7 +730,7 @@ u8 packet_append_data (
 
 Packet *packet_new (void) {
 
-	Packet *packet = (Packet *) malloc (sizeof (Packet));
+	Packet *packet = packets_pool_packet_get ();
 	if (packet) {
 		packet->cerver = NULL;
 		packet->client = NULL;
@@ -307,6 +745,7 @@ Packet *packet_new (void) {
 		packet->data_ptr = NULL;
 		packet->data_end = NULL;
 		packet->data_ref = false;
+		packet->data_class = 0;
 
 		packet->remaining_data = 0;
 
@@ -329,6 +768,9 @@ Packet *packet_new (void) {
 		packet->packet_size = 0;
 		packet->packet = NULL;
 		packet->packet_ref = false;
+		packet->packet_class = 0;
+
+		dlist_link_init (&packet->link);
 	}
 
 	return packet;
@@ -346,14 +788,14 @@ void packet_delete (void *packet_ptr) {
 		packet->lobby = NULL;
 
 		if (!packet->data_ref) {
-			if (packet->data) free (packet->data);
+			packets_pool_data_release (packet->data, packet->data_class);
 		}
 
 		if (!packet->packet_ref) {
-			if (packet->packet) free (packet->packet);
+			packets_pool_data_release (packet->packet, packet->packet_class);
 		}
 
-		free (packet);
+		packets_pool_packet_release (packet);
 	}
 
 }
@@ -387,7 +829,7 @@ Packet *packet_create_with_data (
 	Packet *packet = packet_new ();
 	if (packet) {
 		if (data_size > 0) {
-			packet->data = malloc (data_size);
+			packet->data = packets_pool_data_get (data_size, &packet->data_class);
 			if (packet->data) {
 				packet->data_size = data_size;
 				packet->data_end = packet->data;
@@ -464,7 +906,7 @@ unsigned int packet_create_data (
 	unsigned int retval = 1;
 
 	if (packet && (data_size > 0)) {
-		packet->data = malloc (data_size);
+		packet->data = packets_pool_data_get (data_size, &packet->data_class);
 		if (packet->data) {
 			packet->data_size = data_size;
 			packet->data_end = packet->data;
@@ -491,11 +933,12 @@ u8 packet_set_data (
 	if (packet && data) {
 		// check if there was data in the packet before
 		if (!packet->data_ref) {
-			if (packet->data) free (packet->data);
+			packets_pool_data_release (packet->data, packet->data_class);
 		}
 
+		packet->data_ref = false;
 		packet->data_size = data_size;
-		packet->data = malloc (packet->data_size);
+		packet->data = packets_pool_data_get (packet->data_size, &packet->data_class);
 		if (packet->data) {
 			(void) memcpy (packet->data, data, data_size);
 			packet->data_end = (char *) packet->data;
@@ -553,7 +996,10 @@ u8 packet_append_data (
 		// append the data to the end if the packet already has data
 		if (packet->data) {
 			size_t new_size = packet->data_size + data_size;
-			void *new_data = realloc (packet->data, new_size);
+			void *new_data = packets_pool_data_realloc (
+				packet->data, packet->data_size, new_size, &packet->data_class
+			);
+
 			if (new_data) {
 				packet->data_end = (char *) new_data;
 				packet->data_end += packet->data_size;
@@ -586,7 +1032,7 @@ u8 packet_append_data (
 		// if the packet is empty, create a new buffer
 		else {
 			packet->data_size = data_size;
-			packet->data = malloc (packet->data_size);
+			packet->data = packets_pool_data_get (packet->data_size, &packet->data_class);
 			if (packet->data) {
 				// copy the data to the packet data buffer
 				(void) memcpy (packet->data, data, data_size);
@@ -628,12 +1074,13 @@ u8 packet_set_data_ref (
 
 	if (packet && data) {
 		if (!packet->data_ref) {
-			if (packet->data) free (packet->data);
+			packets_pool_data_release (packet->data, packet->data_class);
 		}
 
 		packet->data = data;
 		packet->data_size = data_size;
 		packet->data_ref = true;
+		packet->data_class = 0;
 
 		retval = 0;
 	}
@@ -642,6 +1089,55 @@ u8 packet_set_data_ref (
 
 }
 
+// makes the packet own a copy of its data if it was set using a reference
+// packets handled with cerver zero copy packets point to the receive buffer,
+// so you must call this method to keep using the data after the handler returns
+// returns 0 on success, 1 on error
+u8 packet_retain (Packet *packet) {
+
+	u8 retval = 1;
+
+	if (packet) {
+		if (packet->data_ref && packet->data) {
+			u8 data_class = 0;
+			char *data = (char *) packets_pool_data_get (packet->data_size, &data_class);
+			if (data) {
+				char *original = (char *) packet->data;
+				(void) memcpy (data, original, packet->data_size);
+
+				// keep the current read position in the new buffer
+				if (
+					packet->data_ptr
+					&& (packet->data_ptr >= original)
+					&& (packet->data_ptr <= (original + packet->data_size))
+				) {
+					packet->data_ptr = data + (packet->data_ptr - original);
+				}
+
+				else {
+					packet->data_ptr = data;
+				}
+
+				packet->data = data;
+				packet->data_end = data + packet->data_size;
+				packet->data_ref = false;
+				packet->data_class = data_class;
+
+				retval = 0;
+			}
+		}
+
+		else {
+			packet->data_ref = false;
+
+			retval = 0;
+		}
+	}
+
+	return retval;
+
+}
+
 // sets a the packet's packet using by copying the passed data
 // deletes the previuos packet's packet
 // returns 0 on succes, 1 on error
@@ -653,11 +1149,12 @@ u8 packet_set_packet (
 
 	if (packet && data) {
 		if (!packet->packet_ref) {
-			if (packet->packet) free (packet->packet);
+			packets_pool_data_release (packet->packet, packet->packet_class);
 		}
 
+		packet->packet_ref = false;
 		packet->packet_size = data_size;
-		packet->packet = malloc (packet->packet_size);
+		packet->packet = packets_pool_data_get (packet->packet_size, &packet->packet_class);
 		if (packet->packet) {
 			(void) memcpy (packet->packet, data, data_size);
 
@@ -680,12 +1177,13 @@ u8 packet_set_packet_ref (
 
 	if (packet && data) {
 		if (!packet->packet_ref) {
-			if (packet->packet) free (packet->packet);
+			packets_pool_data_release (packet->packet, packet->packet_class);
 		}
 
 		packet->packet = data;
 		packet->packet_size = packet_size;
 		packet->packet_ref = true;
+		packet->packet_class = 0;
 
 		retval = 0;
 	}
@@ -702,9 +1200,13 @@ u8 packet_generate (Packet *packet) {
 
 	if (packet) {
 		if (packet->packet) {
-			free (packet->packet);
+			if (!packet->packet_ref) {
+				packets_pool_data_release (packet->packet, packet->packet_class);
+			}
+
 			packet->packet = NULL;
 			packet->packet_size = 0;
+			packet->packet_ref = false;
 		}
 
 		packet->packet_size = sizeof (PacketHeader) + packet->data_size;
@@ -714,7 +1216,7 @@ u8 packet_generate (Packet *packet) {
 		packet->header.request_type = packet->req_type;
 
 		// create the packet buffer to be sent
-		packet->packet = malloc (packet->packet_size);
+		packet->packet = packets_pool_data_get (packet->packet_size, &packet->packet_class);
 		if (packet->packet) {
 			char *end = (char *) packet->packet;
 			(void) memcpy (end, &packet->header, sizeof (PacketHeader));
@@ -787,7 +1289,7 @@ Packet *packet_create_request (
 	const u32 request_type
 ) {
 
-	Packet *packet = (Packet *) malloc (sizeof (Packet));
+	Packet *packet = packets_pool_packet_get ();
 	if (packet) {
 		packet_init_request (
 			packet,
@@ -947,6 +1449,50 @@ static u8 packet_send_split_tcp (
 
 }
 
+// appends the packet into the connection's send queue
+// instead of sending it directly to the socket
+// returns 0 on success, 1 on error
+static u8 packet_send_queue (
+	const Packet *packet,
+	size_t *total_sent, bool raw, bool split,
+	Cerver *cerver,
+	Client *client, Connection *connection
+) {
+
+	struct iovec iov[2];
+	int iovcnt = 1;
+
+	if (split) {
+		iov[0].iov_base = (void *) &packet->header;
+		iov[0].iov_len = sizeof (PacketHeader);
+		iov[1].iov_base = packet->data;
+		iov[1].iov_len = packet->data ? packet->data_size : 0;
+		iovcnt = 2;
+	}
+
+	else if (raw) {
+		iov[0].iov_base = packet->data;
+		iov[0].iov_len = packet->data_size;
+	}
+
+	else {
+		iov[0].iov_base = packet->packet;
+		iov[0].iov_len = packet->packet_size;
+	}
+
+	size_t size = 0;
+	for (int i = 0; i < iovcnt; i++) size += iov[i].iov_len;
+
+	u8 retval = connection_send_queue_push (
+		cerver, client, connection, iov, iovcnt
+	);
+
+	*total_sent = retval ? 0 : size;
+
+	return retval;
+
+}
+
 // #pragma GCC diagnostic push
 // #pragma GCC diagnostic ignored "-Wunused-function"
 // static u8 packet_send_udp (const void *packet, size_t packet_size) {
@@ -962,157 +1508,37 @@ static u8 packet_send_split_tcp (
 #pragma GCC diagnostic ignored "-Wunused-parameter"
 
 static void packet_send_update_stats (
-	PacketType packet_type, size_t sent,
+	PacketType packet_type, u32 request_type, size_t sent,
 	Cerver *cerver,
 	Client *client, Connection *connection,
 	Lobby *lobby
 ) {
 
 	if (cerver) {
-		cerver->stats->n_packets_sent += 1;
-		cerver->stats->total_bytes_sent += sent;
+		CerverStatsShard *shard = cerver_stats_shard (cerver);
+		STATS_ADD (shard->n_packets_sent, 1);
+		STATS_ADD (shard->total_bytes_sent, sent);
+		packets_per_type_count (&shard->sent_packets, packet_type, request_type);
 	}
 
 	#ifdef CLIENT_STATS
 	if (client) {
-		client->stats->n_packets_sent += 1;
-		client->stats->total_bytes_sent += sent;
+		STATS_ADD (client->stats->n_packets_sent, 1);
+		STATS_ADD (client->stats->total_bytes_sent, sent);
+		packets_per_type_count (client->stats->sent_packets, packet_type, request_type);
 	}
 	#endif
 
 	#ifdef CONNECTION_STATS
-	connection->stats->n_packets_sent += 1;
-	connection->stats->total_bytes_sent += sent;
+	STATS_ADD (connection->stats->n_packets_sent, 1);
+	STATS_ADD (connection->stats->total_bytes_sent, sent);
+	packets_per_type_count (connection->stats->sent_packets, packet_type, request_type);
 	#endif
 
 	if (lobby) {
-		lobby->stats->n_packets_sent += 1;
-		lobby->stats->bytes_sent += sent;
-	}
-
-	switch (packet_type) {
-		case PACKET_TYPE_NONE: break;
-
-		case PACKET_TYPE_CERVER:
-			if (cerver) cerver->stats->sent_packets->n_cerver_packets += 1;
-			#ifdef CLIENT_STATS
-			if (client) client->stats->sent_packets->n_cerver_packets += 1;
-			#endif
-			#ifdef CONNECTION_STATS
-			connection->stats->sent_packets->n_cerver_packets += 1;
-			#endif
-			if (lobby) lobby->stats->sent_packets->n_cerver_packets += 1;
-			break;
-
-		case PACKET_TYPE_CLIENT:
-			if (cerver) cerver->stats->sent_packets->n_client_packets += 1;
-			#ifdef CLIENT_STATS
-			if (client) client->stats->sent_packets->n_client_packets += 1;
-			#endif
-			#ifdef CONNECTION_STATS
-			connection->stats->sent_packets->n_client_packets += 1;
-			#endif
-			if (lobby) lobby->stats->sent_packets->n_client_packets += 1;
-			break;
-
-		case PACKET_TYPE_ERROR:
-			if (cerver) cerver->stats->sent_packets->n_error_packets += 1;
-			#ifdef CLIENT_STATS
-			if (client) client->stats->sent_packets->n_error_packets += 1;
-			#endif
-			#ifdef CONNECTION_STATS
-			connection->stats->sent_packets->n_error_packets += 1;
-			#endif
-			if (lobby) lobby->stats->sent_packets->n_error_packets += 1;
-			break;
-
-		case PACKET_TYPE_REQUEST:
-			if (cerver) cerver->stats->sent_packets->n_request_packets += 1;
-			#ifdef CLIENT_STATS
-			if (client) client->stats->sent_packets->n_request_packets += 1;
-			#endif
-			#ifdef CONNECTION_STATS
-			connection->stats->sent_packets->n_request_packets += 1;
-			#endif
-			if (lobby) lobby->stats->sent_packets->n_request_packets += 1;
-			break;
-
-		case PACKET_TYPE_AUTH:
-			if (cerver) cerver->stats->sent_packets->n_auth_packets += 1;
-			#ifdef CLIENT_STATS
-			if (client) client->stats->sent_packets->n_auth_packets += 1;
-			#endif
-			#ifdef CONNECTION_STATS
-			connection->stats->sent_packets->n_auth_packets += 1;
-			#endif
-			if (lobby) lobby->stats->sent_packets->n_auth_packets += 1;
-			break;
-
-		case PACKET_TYPE_GAME:
-			if (cerver) cerver->stats->sent_packets->n_game_packets += 1;
-			#ifdef CLIENT_STATS
-			if (client) client->stats->sent_packets->n_game_packets += 1;
-			#endif
-			#ifdef CONNECTION_STATS
-			connection->stats->sent_packets->n_game_packets += 1;
-			#endif
-			if (lobby) lobby->stats->sent_packets->n_game_packets += 1;
-			break;
-
-		case PACKET_TYPE_APP:
-			if (cerver) cerver->stats->sent_packets->n_app_packets += 1;
-			#ifdef CLIENT_STATS
-			if (client) client->stats->sent_packets->n_app_packets += 1;
-			#endif
-			#ifdef CONNECTION_STATS
-			connection->stats->sent_packets->n_app_packets += 1;
-			#endif
-			if (lobby) lobby->stats->sent_packets->n_app_packets += 1;
-			break;
-
-		case PACKET_TYPE_APP_ERROR:
-			if (cerver) cerver->stats->sent_packets->n_app_error_packets += 1;
-			#ifdef CLIENT_STATS
-			if (client) client->stats->sent_packets->n_app_error_packets += 1;
-			#endif
-			#ifdef CONNECTION_STATS
-			connection->stats->sent_packets->n_app_error_packets += 1;
-			#endif
-			if (lobby) lobby->stats->sent_packets->n_app_error_packets += 1;
-			break;
-
-		case PACKET_TYPE_CUSTOM:
-			if (cerver) cerver->stats->sent_packets->n_custom_packets += 1;
-			#ifdef CLIENT_STATS
-			if (client) client->stats->sent_packets->n_custom_packets += 1;
-			#endif
-			#ifdef CONNECTION_STATS
-			connection->stats->sent_packets->n_custom_packets += 1;
-			#endif
-			if (lobby) lobby->stats->sent_packets->n_custom_packets += 1;
-			break;
-
-		case PACKET_TYPE_TEST:
-			if (cerver) cerver->stats->sent_packets->n_test_packets += 1;
-			#ifdef CLIENT_STATS
-			if (client) client->stats->sent_packets->n_test_packets += 1;
-			#endif
-			#ifdef CONNECTION_STATS
-			connection->stats->sent_packets->n_test_packets += 1;
-			#endif
-			if (lobby) lobby->stats->sent_packets->n_test_packets += 1;
-			break;
-
-		default:
-			if (cerver) cerver->stats->sent_packets->n_unknown_packets += 1;
-			#ifdef CLIENT_STATS
-			if (client) client->stats->sent_packets->n_unknown_packets += 1;
-			#endif
-			#ifdef CONNECTION_STATS
-			connection->stats->sent_packets->n_unknown_packets += 1;
-			#endif
-			if (lobby) lobby->stats->sent_packets->n_unknown_packets += 1;
-			break;
+		STATS_ADD (lobby->stats->n_packets_sent, 1);
+		STATS_ADD (lobby->stats->bytes_sent, sent);
+		packets_per_type_count (lobby->stats->sent_packets, packet_type, request_type);
 	}
 
 }
@@ -1131,7 +1557,7 @@ u8 packet_send_actual (
 		packet, connection, flags, total_sent, false
 	)) {
 		packet_send_update_stats (
-			packet->packet_type, *total_sent,
+			packet->packet_type, packet->req_type, *total_sent,
 			NULL, client, connection, NULL
 		);
 
@@ -1158,14 +1584,16 @@ static inline u8 packet_send_internal (
 			case PROTOCOL_TCP: {
 				size_t sent = 0;
 
-				if (!(split ? packet_send_split_tcp (packet, connection, flags, &sent)
+				if (!(connection->send_queue
+					? packet_send_queue (packet, &sent, raw, split, cerver, client, connection)
+					: split ? packet_send_split_tcp (packet, connection, flags, &sent)
 					: unsafe ? packet_send_tcp_actual (packet, connection, flags, &sent, raw) 
 						: packet_send_tcp (packet, connection, flags, &sent, raw))
 				) {
 					if (total_sent) *total_sent = sent;
 
 					packet_send_update_stats (
-						packet->packet_type, sent,
+						packet->packet_type, packet->req_type, sent,
 						cerver, client, connection, lobby
 					);
 
@@ -1179,22 +1607,41 @@ static inline u8 packet_send_internal (
 					printf ("\n");
 					#endif
 
-					if (cerver) cerver->stats->sent_packets->n_bad_packets += 1;
+					if (cerver) packets_per_type_count_bad (&cerver_stats_shard (cerver)->sent_packets);
 
 					#ifdef CLIENT_STATS
-					if (client) client->stats->sent_packets->n_bad_packets += 1;
+					if (client) packets_per_type_count_bad (client->stats->sent_packets);
 					#endif
 
 					#ifdef CONNECTION_STATS
-					if (connection) connection->stats->sent_packets->n_bad_packets += 1;
+					if (connection) packets_per_type_count_bad (connection->stats->sent_packets);
 					#endif
 
 					if (total_sent) *total_sent = 0;
 				}
 			} break;
 
-			case PROTOCOL_UDP:
-				break;
+			case PROTOCOL_UDP: {
+				const char *data = raw ? (const char *) packet->data : (const char *) packet->packet;
+				const size_t data_size = raw ? packet->data_size : packet->packet_size;
+
+				if (cerver && !cerver_udp_send (cerver, connection, data, data_size, flags)) {
+					if (total_sent) *total_sent = data_size;
+
+					packet_send_update_stats (
+						packet->packet_type, packet->req_type, data_size,
+						cerver, client, connection, lobby
+					);
+
+					retval = 0;
+				}
+
+				else {
+					if (cerver) packets_per_type_count_bad (&cerver_stats_shard (cerver)->sent_packets);
+
+					if (total_sent) *total_sent = 0;
+				}
+			} break;
 
 			default: break;
 		}
@@ -1206,6 +1653,8 @@ static inline u8 packet_send_internal (
 
 // sends a packet using its network values
 // raw flag to send a raw packet (only the data that was set to the packet, without any header)
+// if the connection has a send queue, the packet is appended to it instead
+// and flags are ignored in favor of the connection's send flags
 // returns 0 on success, 1 on error
 u8 packet_send (
 	const Packet *packet, int flags, size_t *total_sent, bool raw
@@ -1319,6 +1768,51 @@ static u8 packet_send_pieces_actual (
 
 }
 
+// appends the header & all the pieces into the connection's send queue
+static u8 packet_send_pieces_queue (
+	const Packet *packet,
+	void **pieces, size_t *sizes, u32 n_pieces,
+	size_t *total_sent
+) {
+
+	u8 retval = 1;
+
+	struct iovec *iov = (struct iovec *) malloc (
+		(n_pieces + 1) * sizeof (struct iovec)
+	);
+
+	if (iov) {
+		iov[0].iov_base = (void *) &packet->header;
+		iov[0].iov_len = sizeof (PacketHeader);
+
+		size_t size = sizeof (PacketHeader);
+		for (u32 i = 0; i < n_pieces; i++) {
+			iov[i + 1].iov_base = pieces[i];
+			iov[i + 1].iov_len = sizes[i];
+			size += sizes[i];
+		}
+
+		if (!connection_send_queue_push (
+			packet->cerver, packet->client, packet->connection,
+			iov, (int) n_pieces + 1
+		)) {
+			packet_send_update_stats (
+				packet->packet_type, packet->req_type, size,
+				packet->cerver, packet->client, packet->connection, packet->lobby
+			);
+
+			if (total_sent) *total_sent = size;
+
+			retval = 0;
+		}
+
+		free (iov);
+	}
+
+	return retval;
+
+}
+
 // sends a packet in pieces, taking the header from the packet's field
 // sends each buffer as they are with they respective sizes
 // socket mutex will be locked for the entire operation
@@ -1332,7 +1826,13 @@ u8 packet_send_pieces (
 
 	u8 retval = 1;
 
-	if (packet && pieces && sizes) {
+	if (packet && pieces && sizes && packet->connection->send_queue) {
+		retval = packet_send_pieces_queue (
+			packet, pieces, sizes, n_pieces, total_sent
+		);
+	}
+
+	else if (packet && pieces && sizes) {
 		(void) pthread_mutex_lock (packet->connection->socket->write_mutex);
 
 		size_t actual_sent = 0;
@@ -1358,7 +1858,7 @@ u8 packet_send_pieces (
 		}
 
 		packet_send_update_stats (
-			packet->packet_type, actual_sent,
+			packet->packet_type, packet->req_type, actual_sent,
 			packet->cerver, packet->client, packet->connection, packet->lobby
 		);
 
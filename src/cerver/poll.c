@@ -0,0 +1,208 @@
+#include <stdlib.h>
+
+#include <poll.h>
+
+#include "cerver/types/types.h"
+
+#include "cerver/poll.h"
+
+PollFdsMap *poll_fds_map_new (void) {
+
+	PollFdsMap *map = (PollFdsMap *) malloc (sizeof (PollFdsMap));
+	if (map) {
+		map->idxs = NULL;
+		map->size = 0;
+
+		map->n_removed = 0;
+	}
+
+	return map;
+
+}
+
+void poll_fds_map_delete (void *map_ptr) {
+
+	if (map_ptr) {
+		PollFdsMap *map = (PollFdsMap *) map_ptr;
+
+		if (map->idxs) free (map->idxs);
+
+		free (map_ptr);
+	}
+
+}
+
+// creates a new map that can hold sock fds up to size
+// the map will grow if a bigger sock fd is registered
+PollFdsMap *poll_fds_map_create (const u32 size) {
+
+	PollFdsMap *map = poll_fds_map_new ();
+	if (map) {
+		map->idxs = (i32 *) malloc (size * sizeof (i32));
+		if (map->idxs) {
+			for (u32 i = 0; i < size; i++) map->idxs[i] = -1;
+			map->size = size;
+		}
+
+		else {
+			poll_fds_map_delete (map);
+			map = NULL;
+		}
+	}
+
+	return map;
+
+}
+
+// grows the map until the sock fd can be mapped
+// returns 0 on success, 1 on error
+static u8 poll_fds_map_grow (PollFdsMap *map, const i32 sock_fd) {
+
+	u8 retval = 1;
+
+	u32 new_size = map->size ? map->size : POLL_FDS_MAP_DEFAULT_SIZE;
+	while (new_size <= (u32) sock_fd) new_size *= 2;
+
+	i32 *idxs = (i32 *) realloc (map->idxs, new_size * sizeof (i32));
+	if (idxs) {
+		for (u32 i = map->size; i < new_size; i++) idxs[i] = -1;
+
+		map->idxs = idxs;
+		map->size = new_size;
+
+		retval = 0;
+	}
+
+	return retval;
+
+}
+
+// returns the idx of the sock fd in the pollfd array
+// returns -1 if the sock fd has not been registered
+i32 poll_fds_map_get (const PollFdsMap *map, const i32 sock_fd) {
+
+	return (map && (sock_fd >= 0) && ((u32) sock_fd < map->size)) ?
+		map->idxs[sock_fd] : -1;
+
+}
+
+// sets the slots in the range [from, to) as free slots
+void poll_fds_reset (
+	struct pollfd *fds, const u32 from, const u32 to
+) {
+
+	for (u32 i = from; i < to; i++) {
+		fds[i].fd = -1;
+		fds[i].events = 0;
+		fds[i].revents = 0;
+	}
+
+}
+
+// registers the sock fd in the next free slot of the pollfd array
+// returns the idx where the sock fd was placed
+// returns -1 if the pollfd array is full or on error
+i32 poll_fds_register (
+	struct pollfd *fds, const u32 max_n_fds, u32 *current_n_fds,
+	PollFdsMap *map,
+	const i32 sock_fd, const short events
+) {
+
+	i32 idx = -1;
+
+	if (fds && current_n_fds && map && (sock_fd >= 0)) {
+		if (*current_n_fds < max_n_fds) {
+			if (((u32) sock_fd < map->size) || !poll_fds_map_grow (map, sock_fd)) {
+				// the top of the free slots stack
+				idx = (i32) *current_n_fds;
+
+				fds[idx].fd = sock_fd;
+				fds[idx].events = events;
+				fds[idx].revents = 0;
+
+				map->idxs[sock_fd] = idx;
+
+				*current_n_fds += 1;
+			}
+		}
+	}
+
+	return idx;
+
+}
+
+// frees the sock fd's slot without moving any other registered fd
+// so the events that poll () might be setting still match their fds
+// the slot is set to -1, which poll () ignores, and it is only
+// reused after the array has been compacted by its poll thread
+// returns the idx that the sock fd used to have
+// returns -1 if the sock fd was not registered
+i32 poll_fds_unregister (
+	struct pollfd *fds, PollFdsMap *map,
+	const i32 sock_fd
+) {
+
+	i32 idx = -1;
+
+	if (fds && map) {
+		idx = poll_fds_map_get (map, sock_fd);
+		if (idx >= 0) {
+			__atomic_store_n (&fds[idx].fd, -1, __ATOMIC_RELAXED);
+			fds[idx].events = 0;
+
+			map->idxs[sock_fd] = -1;
+			map->n_removed += 1;
+		}
+	}
+
+	return idx;
+
+}
+
+// returns the sock fd that is registered in the slot
+// returns -1 if the slot was freed after poll () set its events
+i32 poll_fds_get (const struct pollfd *fds, const u32 idx) {
+
+	return __atomic_load_n (&fds[idx].fd, __ATOMIC_RELAXED);
+
+}
+
+// fills the freed slots by moving the last registered fds into them
+// must only be called by the thread that calls poll ()
+// after it has handled the events, as registered fds can change their idx
+// slots before first are never moved
+void poll_fds_compact (
+	struct pollfd *fds, u32 *current_n_fds,
+	PollFdsMap *map,
+	const u32 first
+) {
+
+	if (fds && current_n_fds && map && map->n_removed) {
+		u32 last = *current_n_fds;
+		u32 idx = first;
+		while (idx < last) {
+			if (fds[idx].fd < 0) {
+				last -= 1;
+
+				// the last slot might have been freed too
+				if (fds[last].fd >= 0) {
+					fds[idx] = fds[last];
+					fds[idx].revents = 0;
+					map->idxs[fds[idx].fd] = (i32) idx;
+
+					idx += 1;
+				}
+
+				poll_fds_reset (fds, last, last + 1);
+			}
+
+			else {
+				idx += 1;
+			}
+		}
+
+		*current_n_fds = last;
+		map->n_removed = 0;
+	}
+
+}
@@ -91,6 +91,11 @@ void receive_handle_reset (ReceiveHandle *receive_handle) {
 		receive_handle->remaining_header = 0;
 
 		receive_handle->spare_packet = NULL;
+
+		receive_handle->n_packets = 0;
+
+		receive_handle->jobs_handler = NULL;
+		receive_handle->n_jobs = 0;
 	}
 
 }
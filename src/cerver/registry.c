@@ -0,0 +1,748 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include <pthread.h>
+
+#include "cerver/types/types.h"
+#include "cerver/types/string.h"
+
+#include "cerver/collections/htab.h"
+
+#include "cerver/client.h"
+#include "cerver/registry.h"
+
+#include "cerver/threads/thread.h"
+
+static _Thread_local unsigned int client_registry_slot_idx = 0;
+static unsigned int client_registry_slots_next = 0;
+
+#pragma region tables
+
+static ClientRegistryTable *client_registry_table_create (const size_t size) {
+
+	ClientRegistryTable *table = (ClientRegistryTable *) calloc (
+		1, sizeof (ClientRegistryTable) + (size * sizeof (ClientRegistryNode *))
+	);
+
+	if (table) table->size = size;
+
+	return table;
+
+}
+
+static ClientRegistryNode *client_registry_node_create (
+	const u64 hash, const u64 id, const char *session_id,
+	struct _Client *client
+) {
+
+	ClientRegistryNode *node = (ClientRegistryNode *) malloc (sizeof (ClientRegistryNode));
+	if (node) {
+		node->next = NULL;
+
+		node->hash = hash;
+		node->id = id;
+		node->session_id = session_id ? strdup (session_id) : NULL;
+
+		node->client = client;
+
+		node->retired_next = NULL;
+
+		if (session_id && !node->session_id) {
+			free (node);
+			node = NULL;
+		}
+	}
+
+	return node;
+
+}
+
+static void client_registry_node_delete (ClientRegistryNode *node) {
+
+	if (node->session_id) free (node->session_id);
+
+	free (node);
+
+}
+
+static inline u64 client_registry_hash_id (const u64 id) {
+
+	return (u64) htab_hash (&id, sizeof (u64));
+
+}
+
+static inline u64 client_registry_hash_session_id (const char *session_id) {
+
+	return (u64) htab_hash (session_id, strlen (session_id));
+
+}
+
+// the lowest bits select the shard, so the buckets use the next ones
+static inline ClientRegistryNode **client_registry_table_bucket (
+	ClientRegistryTable *table, const u64 hash
+) {
+
+	return &table->buckets[
+		(hash / CLIENT_REGISTRY_SHARDS) & (table->size - 1)
+	];
+
+}
+
+static inline bool client_registry_node_match (
+	const ClientRegistryNode *node,
+	const u64 hash, const u64 id, const char *session_id
+) {
+
+	return (node->hash == hash) && (
+		session_id ?
+			!strcmp (node->session_id, session_id) : (node->id == id)
+	);
+
+}
+
+static void client_registry_shards_init (ClientRegistryShard *shards) {
+
+	for (unsigned int i = 0; i < CLIENT_REGISTRY_SHARDS; i++) {
+		shards[i].table = NULL;
+		shards[i].count = 0;
+
+		(void) pthread_mutex_init (&shards[i].lock, NULL);
+	}
+
+}
+
+static u8 client_registry_shards_create (ClientRegistryShard *shards) {
+
+	u8 errors = 0;
+
+	for (unsigned int i = 0; i < CLIENT_REGISTRY_SHARDS; i++) {
+		shards[i].table = client_registry_table_create (
+			CLIENT_REGISTRY_SHARD_INIT_SIZE
+		);
+
+		if (!shards[i].table) errors = 1;
+	}
+
+	return errors;
+
+}
+
+// releases the shards tables & their nodes
+// calls delete_client with every client if it is set
+static void client_registry_shards_end (
+	ClientRegistryShard *shards,
+	void (*delete_client)(void *client_ptr)
+) {
+
+	ClientRegistryNode *node = NULL;
+	ClientRegistryNode *next = NULL;
+	for (unsigned int i = 0; i < CLIENT_REGISTRY_SHARDS; i++) {
+		if (shards[i].table) {
+			for (size_t b = 0; b < shards[i].table->size; b++) {
+				node = shards[i].table->buckets[b];
+				while (node) {
+					next = node->next;
+
+					if (delete_client) delete_client (node->client);
+					client_registry_node_delete (node);
+
+					node = next;
+				}
+			}
+
+			free (shards[i].table);
+		}
+
+		(void) pthread_mutex_destroy (&shards[i].lock);
+	}
+
+}
+
+#pragma endregion
+
+#pragma region epochs
+
+static inline ClientRegistryReaders *client_registry_slot (
+	ClientRegistry *registry, unsigned int *slot
+) {
+
+	if (!client_registry_slot_idx) {
+		client_registry_slot_idx = __atomic_add_fetch (
+			&client_registry_slots_next, 1, __ATOMIC_RELAXED
+		);
+	}
+
+	*slot = (client_registry_slot_idx - 1) & (CLIENT_REGISTRY_READ_SLOTS - 1);
+
+	return &registry->readers[*slot];
+
+}
+
+// marks the start of a read in the current epoch
+// returns a token that must be passed to client_registry_read_end ()
+unsigned int client_registry_read_start (ClientRegistry *registry) {
+
+	unsigned int slot = 0;
+	ClientRegistryReaders *readers = client_registry_slot (registry, &slot);
+
+	// the epoch is read again after the reader has been counted,
+	// so a writer that checks the epoch's readers always sees it
+	u64 epoch = 0;
+	for (;;) {
+		epoch = __atomic_load_n (&registry->epoch, __ATOMIC_SEQ_CST);
+		(void) __atomic_add_fetch (
+			&readers->readers[epoch % CLIENT_REGISTRY_EPOCHS], 1, __ATOMIC_SEQ_CST
+		);
+
+		if (__atomic_load_n (&registry->epoch, __ATOMIC_SEQ_CST) == epoch) break;
+
+		(void) __atomic_sub_fetch (
+			&readers->readers[epoch % CLIENT_REGISTRY_EPOCHS], 1, __ATOMIC_SEQ_CST
+		);
+	}
+
+	return (slot * CLIENT_REGISTRY_EPOCHS) + (unsigned int) (epoch % CLIENT_REGISTRY_EPOCHS);
+
+}
+
+// marks the end of a read started with client_registry_read_start ()
+void client_registry_read_end (
+	ClientRegistry *registry, const unsigned int token
+) {
+
+	(void) __atomic_sub_fetch (
+		&registry->readers[token / CLIENT_REGISTRY_EPOCHS].readers[token % CLIENT_REGISTRY_EPOCHS],
+		1, __ATOMIC_RELEASE
+	);
+
+}
+
+static void client_registry_release (
+	ClientRegistry *registry, const unsigned int idx
+) {
+
+	ClientRegistryNode *node = registry->retired_nodes[idx];
+	ClientRegistryNode *next_node = NULL;
+	while (node) {
+		next_node = node->retired_next;
+		client_registry_node_delete (node);
+		node = next_node;
+	}
+
+	ClientRegistryTable *table = registry->retired_tables[idx];
+	ClientRegistryTable *next_table = NULL;
+	while (table) {
+		next_table = table->retired_next;
+		free (table);
+		table = next_table;
+	}
+
+	struct _Client *client = registry->retired_clients[idx];
+	struct _Client *next_client = NULL;
+	while (client) {
+		next_client = client->retired_next;
+		client->retired_next = NULL;
+		if (registry->delete_client) registry->delete_client (client);
+		client = next_client;
+	}
+
+	registry->retired_nodes[idx] = NULL;
+	registry->retired_tables[idx] = NULL;
+	registry->retired_clients[idx] = NULL;
+
+}
+
+// moves to the next epoch if nobody is reading in the previous one
+// memory retired two epochs ago can't be reached by any reader
+// must be called with the retired lock
+static bool client_registry_advance (ClientRegistry *registry) {
+
+	bool advanced = false;
+
+	const u64 epoch = __atomic_load_n (&registry->epoch, __ATOMIC_SEQ_CST);
+	const unsigned int previous = (unsigned int) ((epoch + CLIENT_REGISTRY_EPOCHS - 1) % CLIENT_REGISTRY_EPOCHS);
+
+	u64 readers = 0;
+	for (unsigned int i = 0; i < CLIENT_REGISTRY_READ_SLOTS; i++)
+		readers += __atomic_load_n (&registry->readers[i].readers[previous], __ATOMIC_SEQ_CST);
+
+	if (!readers) {
+		__atomic_store_n (&registry->epoch, epoch + 1, __ATOMIC_SEQ_CST);
+
+		client_registry_release (
+			registry, (unsigned int) ((epoch + 2) % CLIENT_REGISTRY_EPOCHS)
+		);
+
+		advanced = true;
+	}
+
+	return advanced;
+
+}
+
+static void client_registry_retire (
+	ClientRegistry *registry,
+	ClientRegistryNode *node, ClientRegistryTable *table,
+	struct _Client *client
+) {
+
+	(void) pthread_mutex_lock (registry->retired_lock);
+
+	const unsigned int idx = (unsigned int) (registry->epoch % CLIENT_REGISTRY_EPOCHS);
+
+	while (node) {
+		ClientRegistryNode *next = node->retired_next;
+		node->retired_next = registry->retired_nodes[idx];
+		registry->retired_nodes[idx] = node;
+		node = next;
+	}
+
+	if (table) {
+		table->retired_next = registry->retired_tables[idx];
+		registry->retired_tables[idx] = table;
+	}
+
+	if (client) {
+		client->retired_next = registry->retired_clients[idx];
+		registry->retired_clients[idx] = client;
+	}
+
+	// without any readers, the memory is released right away
+	if (client_registry_advance (registry)) (void) client_registry_advance (registry);
+
+	(void) pthread_mutex_unlock (registry->retired_lock);
+
+}
+
+#pragma endregion
+
+#pragma region main
+
+static ClientRegistry *client_registry_new (void) {
+
+	ClientRegistry *registry = (ClientRegistry *) aligned_alloc (
+		CLIENT_REGISTRY_CACHE_LINE, sizeof (ClientRegistry)
+	);
+
+	if (registry) {
+		client_registry_shards_init (registry->ids);
+		client_registry_shards_init (registry->sessions);
+
+		registry->count = 0;
+
+		registry->epoch = 0;
+		(void) memset (registry->readers, 0, sizeof (registry->readers));
+
+		registry->retired_lock = NULL;
+		for (unsigned int i = 0; i < CLIENT_REGISTRY_EPOCHS; i++) {
+			registry->retired_nodes[i] = NULL;
+			registry->retired_tables[i] = NULL;
+			registry->retired_clients[i] = NULL;
+		}
+
+		registry->delete_client = NULL;
+	}
+
+	return registry;
+
+}
+
+// deletes the registry & every client that is still inside it
+// using the registry's delete client method
+void client_registry_delete (void *registry_ptr) {
+
+	if (registry_ptr) {
+		ClientRegistry *registry = (ClientRegistry *) registry_ptr;
+
+		client_registry_shards_end (registry->ids, registry->delete_client);
+		client_registry_shards_end (registry->sessions, NULL);
+
+		for (unsigned int i = 0; i < CLIENT_REGISTRY_EPOCHS; i++)
+			client_registry_release (registry, i);
+
+		thread_mutex_delete (registry->retired_lock);
+
+		free (registry_ptr);
+	}
+
+}
+
+// creates a new registry
+// delete_client - method to delete the clients when the registry is deleted,
+// NULL to keep them
+ClientRegistry *client_registry_create (
+	void (*delete_client)(void *client_ptr)
+) {
+
+	ClientRegistry *registry = client_registry_new ();
+	if (registry) {
+		registry->delete_client = delete_client;
+
+		registry->retired_lock = thread_mutex_new ();
+
+		u8 errors = 0;
+		errors |= client_registry_shards_create (registry->ids);
+		errors |= client_registry_shards_create (registry->sessions);
+
+		if (errors || !registry->retired_lock) {
+			registry->delete_client = NULL;
+			client_registry_delete (registry);
+			registry = NULL;
+		}
+	}
+
+	return registry;
+
+}
+
+// returns the number of clients inside the registry
+size_t client_registry_size (const ClientRegistry *registry) {
+
+	return registry ? __atomic_load_n (&registry->count, __ATOMIC_RELAXED) : 0;
+
+}
+
+// copies the shard's nodes into a table twice its size
+// readers that are still in the previous table keep their nodes
+// must be called with the shard's lock
+static void client_registry_shard_grow (
+	ClientRegistry *registry, ClientRegistryShard *shard
+) {
+
+	ClientRegistryTable *previous = shard->table;
+	ClientRegistryTable *table = client_registry_table_create (previous->size * 2);
+	if (table) {
+		ClientRegistryNode *retired = NULL;
+		ClientRegistryNode *copy = NULL;
+		bool errors = false;
+
+		for (size_t b = 0; (b < previous->size) && !errors; b++) {
+			for (ClientRegistryNode *node = previous->buckets[b]; node; node = node->next) {
+				copy = client_registry_node_create (
+					node->hash, node->id, node->session_id, node->client
+				);
+
+				if (copy) {
+					ClientRegistryNode **bucket = client_registry_table_bucket (table, node->hash);
+					copy->next = *bucket;
+					*bucket = copy;
+				}
+
+				else {
+					errors = true;
+					break;
+				}
+			}
+		}
+
+		if (!errors) {
+			__atomic_store_n (&shard->table, table, __ATOMIC_RELEASE);
+
+			for (size_t b = 0; b < previous->size; b++) {
+				for (ClientRegistryNode *node = previous->buckets[b]; node; node = node->next) {
+					node->retired_next = retired;
+					retired = node;
+				}
+			}
+
+			client_registry_retire (registry, retired, previous, NULL);
+		}
+
+		// keep using the current table
+		else {
+			for (size_t b = 0; b < table->size; b++) {
+				ClientRegistryNode *node = table->buckets[b];
+				while (node) {
+					copy = node->next;
+					client_registry_node_delete (node);
+					node = copy;
+				}
+			}
+
+			free (table);
+		}
+	}
+
+}
+
+// links a new node with the key at the head of its bucket
+// returns 0 on success, 1 on error or if the key already exists
+static u8 client_registry_shard_insert (
+	ClientRegistry *registry, ClientRegistryShard *shard,
+	const u64 hash, const u64 id, const char *session_id,
+	struct _Client *client
+) {
+
+	u8 retval = 1;
+
+	(void) pthread_mutex_lock (&shard->lock);
+
+	bool found = false;
+	for (
+		ClientRegistryNode *node = *client_registry_table_bucket (shard->table, hash);
+		node; node = node->next
+	) {
+		if (client_registry_node_match (node, hash, id, session_id)) {
+			found = true;
+			break;
+		}
+	}
+
+	if (!found) {
+		if ((shard->count + 1) > shard->table->size)
+			client_registry_shard_grow (registry, shard);
+
+		ClientRegistryNode *node = client_registry_node_create (
+			hash, id, session_id, client
+		);
+
+		if (node) {
+			ClientRegistryNode **bucket = client_registry_table_bucket (shard->table, hash);
+			node->next = *bucket;
+
+			// readers can only reach the node once it is complete
+			__atomic_store_n (bucket, node, __ATOMIC_RELEASE);
+
+			shard->count += 1;
+
+			retval = 0;
+		}
+	}
+
+	(void) pthread_mutex_unlock (&shard->lock);
+
+	return retval;
+
+}
+
+// unlinks the client's node, readers that are in the node can still move on
+// returns 0 on success, 1 if the client was not found
+static u8 client_registry_shard_remove (
+	ClientRegistry *registry, ClientRegistryShard *shard,
+	const u64 hash, const struct _Client *client
+) {
+
+	u8 retval = 1;
+
+	ClientRegistryNode *removed = NULL;
+
+	(void) pthread_mutex_lock (&shard->lock);
+
+	ClientRegistryNode **prev = client_registry_table_bucket (shard->table, hash);
+	for (ClientRegistryNode *node = *prev; node; node = node->next) {
+		if ((node->hash == hash) && (node->client == client)) {
+			__atomic_store_n (prev, node->next, __ATOMIC_RELEASE);
+			shard->count -= 1;
+
+			removed = node;
+			retval = 0;
+			break;
+		}
+
+		prev = &node->next;
+	}
+
+	(void) pthread_mutex_unlock (&shard->lock);
+
+	if (removed) client_registry_retire (registry, removed, NULL, NULL);
+
+	return retval;
+
+}
+
+// adds the client to the ids index, and to the sessions index
+// if it has a session id
+// returns 0 on success, 1 on error or if its id has already been registered
+u8 client_registry_insert (
+	ClientRegistry *registry, struct _Client *client
+) {
+
+	u8 retval = 1;
+
+	if (registry && client) {
+		const u64 hash = client_registry_hash_id (client->id);
+		if (!client_registry_shard_insert (
+			registry, &registry->ids[hash & (CLIENT_REGISTRY_SHARDS - 1)],
+			hash, client->id, NULL, client
+		)) {
+			retval = 0;
+
+			if (client->session_id) {
+				const u64 session_hash = client_registry_hash_session_id (
+					client->session_id->str
+				);
+
+				if (client_registry_shard_insert (
+					registry, &registry->sessions[session_hash & (CLIENT_REGISTRY_SHARDS - 1)],
+					session_hash, client->id, client->session_id->str, client
+				)) {
+					(void) client_registry_shard_remove (
+						registry, &registry->ids[hash & (CLIENT_REGISTRY_SHARDS - 1)],
+						hash, client
+					);
+
+					retval = 1;
+				}
+			}
+
+			if (!retval) (void) __atomic_add_fetch (&registry->count, 1, __ATOMIC_RELAXED);
+		}
+	}
+
+	return retval;
+
+}
+
+// removes the client from both indexes
+// returns the client on success, NULL if it was not registered
+struct _Client *client_registry_remove (
+	ClientRegistry *registry, struct _Client *client
+) {
+
+	struct _Client *retval = NULL;
+
+	if (registry && client) {
+		const u64 hash = client_registry_hash_id (client->id);
+		if (!client_registry_shard_remove (
+			registry, &registry->ids[hash & (CLIENT_REGISTRY_SHARDS - 1)],
+			hash, client
+		)) {
+			if (client->session_id) {
+				const u64 session_hash = client_registry_hash_session_id (
+					client->session_id->str
+				);
+
+				(void) client_registry_shard_remove (
+					registry, &registry->sessions[session_hash & (CLIENT_REGISTRY_SHARDS - 1)],
+					session_hash, client
+				);
+			}
+
+			(void) __atomic_sub_fetch (&registry->count, 1, __ATOMIC_RELAXED);
+
+			retval = client;
+		}
+	}
+
+	return retval;
+
+}
+
+// deletes a client that has been removed from the registry
+// using the registry's delete client method
+// after every reader that might have found it has finished
+void client_registry_retire_client (
+	ClientRegistry *registry, struct _Client *client
+) {
+
+	if (registry && client) {
+		client_registry_retire (registry, NULL, NULL, client);
+	}
+
+}
+
+static struct _Client *client_registry_get (
+	ClientRegistry *registry, ClientRegistryShard *shard,
+	const u64 hash, const u64 id, const char *session_id
+) {
+
+	struct _Client *client = NULL;
+
+	const unsigned int token = client_registry_read_start (registry);
+
+	ClientRegistryTable *table = __atomic_load_n (&shard->table, __ATOMIC_ACQUIRE);
+	for (
+		ClientRegistryNode *node = __atomic_load_n (
+			client_registry_table_bucket (table, hash), __ATOMIC_ACQUIRE
+		);
+		node; node = __atomic_load_n (&node->next, __ATOMIC_ACQUIRE)
+	) {
+		if (client_registry_node_match (node, hash, id, session_id)) {
+			client = node->client;
+			break;
+		}
+	}
+
+	client_registry_read_end (registry, token);
+
+	return client;
+
+}
+
+// returns the client with the matching id
+// the client can only be used until client_registry_read_end ()
+// if the lookup was done inside a read
+// returns NULL if no client was found
+struct _Client *client_registry_get_by_id (
+	ClientRegistry *registry, const u64 id
+) {
+
+	struct _Client *client = NULL;
+
+	if (registry) {
+		const u64 hash = client_registry_hash_id (id);
+		client = client_registry_get (
+			registry, &registry->ids[hash & (CLIENT_REGISTRY_SHARDS - 1)],
+			hash, id, NULL
+		);
+	}
+
+	return client;
+
+}
+
+// returns the client with the matching session id
+// the client can only be used until client_registry_read_end ()
+// if the lookup was done inside a read
+// returns NULL if no client was found
+struct _Client *client_registry_get_by_session_id (
+	ClientRegistry *registry, const char *session_id
+) {
+
+	struct _Client *client = NULL;
+
+	if (registry && session_id) {
+		const u64 hash = client_registry_hash_session_id (session_id);
+		client = client_registry_get (
+			registry, &registry->sessions[hash & (CLIENT_REGISTRY_SHARDS - 1)],
+			hash, 0, session_id
+		);
+	}
+
+	return client;
+
+}
+
+// calls the method with every client in the registry without taking any lock
+// clients that are added or removed meanwhile might not be visited,
+// but the visited ones are not deleted until the method returns
+void client_registry_for_each (
+	ClientRegistry *registry,
+	void (*method)(struct _Client *client, void *args), void *args
+) {
+
+	if (registry && method) {
+		const unsigned int token = client_registry_read_start (registry);
+
+		for (unsigned int i = 0; i < CLIENT_REGISTRY_SHARDS; i++) {
+			ClientRegistryTable *table = __atomic_load_n (
+				&registry->ids[i].table, __ATOMIC_ACQUIRE
+			);
+
+			for (size_t b = 0; b < table->size; b++) {
+				for (
+					ClientRegistryNode *node = __atomic_load_n (&table->buckets[b], __ATOMIC_ACQUIRE);
+					node; node = __atomic_load_n (&node->next, __ATOMIC_ACQUIRE)
+				) {
+					method (node->client, args);
+				}
+			}
+		}
+
+		client_registry_read_end (registry, token);
+	}
+
+}
+
+#pragma endregion
@@ -0,0 +1,376 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <errno.h>
+
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include "cerver/types/types.h"
+
+#include "cerver/send.h"
+
+#include "cerver/threads/thread.h"
+
+const char *send_queue_overflow_to_string (
+	const SendQueueOverflow overflow
+) {
+
+	switch (overflow) {
+		#define XX(num, name, string) case SEND_QUEUE_OVERFLOW_##name: return #string;
+		SEND_QUEUE_OVERFLOW_MAP(XX)
+		#undef XX
+	}
+
+	return send_queue_overflow_to_string (SEND_QUEUE_OVERFLOW_EVENT);
+
+}
+
+const char *send_queue_flush_to_string (
+	const SendQueueFlush flush
+) {
+
+	switch (flush) {
+		#define XX(num, name, string) case SEND_QUEUE_FLUSH_##name: return #string;
+		SEND_QUEUE_FLUSH_MAP(XX)
+		#undef XX
+	}
+
+	return send_queue_flush_to_string (SEND_QUEUE_FLUSH_DONE);
+
+}
+
+SendQueue *send_queue_new (void) {
+
+	SendQueue *queue = (SendQueue *) malloc (sizeof (SendQueue));
+	if (queue) {
+		queue->buffer = NULL;
+		queue->size = 0;
+
+		queue->head = 0;
+		queue->tail = 0;
+
+		queue->high_water = SEND_QUEUE_DEFAULT_HIGH_WATER;
+		queue->overflow = SEND_QUEUE_DEFAULT_OVERFLOW;
+		queue->overflowed = false;
+		queue->closed = false;
+
+		queue->corked = false;
+
+		queue->threaded = false;
+		queue->running = false;
+
+		queue->in_flight = false;
+		queue->retired = NULL;
+
+		queue->mutex = NULL;
+		queue->has_data = NULL;
+
+		(void) memset (&queue->stats, 0, sizeof (SendQueueStats));
+	}
+
+	return queue;
+
+}
+
+void send_queue_delete (void *send_queue_ptr) {
+
+	if (send_queue_ptr) {
+		SendQueue *queue = (SendQueue *) send_queue_ptr;
+
+		if (queue->buffer) free (queue->buffer);
+		if (queue->retired) free (queue->retired);
+
+		thread_mutex_delete (queue->mutex);
+		thread_cond_delete (queue->has_data);
+
+		free (queue);
+	}
+
+}
+
+static inline size_t send_queue_size_round (size_t size) {
+
+	size_t rounded = 64;
+	while (rounded < size) rounded <<= 1;
+
+	return rounded;
+
+}
+
+// creates a new send queue with an initial buffer of at least size bytes
+// returns a new send queue on success, NULL on error
+SendQueue *send_queue_create (
+	const size_t size,
+	const size_t high_water, const SendQueueOverflow overflow
+) {
+
+	SendQueue *queue = send_queue_new ();
+	if (queue) {
+		queue->size = send_queue_size_round (size);
+		queue->buffer = (char *) malloc (queue->size);
+
+		queue->high_water = high_water;
+		queue->overflow = overflow;
+
+		queue->mutex = thread_mutex_new ();
+		queue->has_data = thread_cond_new ();
+
+		if (!queue->buffer || !queue->mutex || !queue->has_data) {
+			send_queue_delete (queue);
+			queue = NULL;
+		}
+	}
+
+	return queue;
+
+}
+
+// discards any queued data & clears the queue's state
+// the queue's buffer is kept to be used again
+void send_queue_reset (SendQueue *queue) {
+
+	if (queue) {
+		queue->head = 0;
+		queue->tail = 0;
+
+		queue->overflowed = false;
+		queue->closed = false;
+
+		queue->corked = false;
+
+		queue->threaded = false;
+		queue->running = false;
+
+		queue->in_flight = false;
+		if (queue->retired) {
+			free (queue->retired);
+			queue->retired = NULL;
+		}
+
+		(void) memset (&queue->stats, 0, sizeof (SendQueueStats));
+	}
+
+}
+
+// returns the number of bytes that are waiting to be sent
+size_t send_queue_pending (const SendQueue *queue) {
+
+	return queue ? queue->tail - queue->head : 0;
+
+}
+
+// moves the pending bytes to the start of a bigger buffer
+static u8 send_queue_grow (SendQueue *queue, const size_t needed) {
+
+	u8 retval = 1;
+
+	size_t new_size = send_queue_size_round (needed);
+	char *new_buffer = (char *) malloc (new_size);
+	if (new_buffer) {
+		const size_t pending = queue->tail - queue->head;
+		const size_t start = queue->head & (queue->size - 1);
+		const size_t first = (pending < (queue->size - start))
+			? pending : queue->size - start;
+
+		(void) memcpy (new_buffer, queue->buffer + start, first);
+		(void) memcpy (new_buffer + first, queue->buffer, pending - first);
+
+		// the kernel might still be reading from the buffer
+		// only the first buffer that was grown while in flight is being used
+		if (queue->in_flight && !queue->retired) queue->retired = queue->buffer;
+		else free (queue->buffer);
+
+		queue->buffer = new_buffer;
+		queue->size = new_size;
+
+		queue->head = 0;
+		queue->tail = pending;
+
+		retval = 0;
+	}
+
+	return retval;
+
+}
+
+static void send_queue_copy (
+	SendQueue *queue, const char *data, size_t data_size
+) {
+
+	size_t start = 0;
+	size_t piece = 0;
+	while (data_size) {
+		start = queue->tail & (queue->size - 1);
+		piece = (data_size < (queue->size - start))
+			? data_size : queue->size - start;
+
+		(void) memcpy (queue->buffer + start, data, piece);
+
+		queue->tail += piece;
+		data += piece;
+		data_size -= piece;
+	}
+
+}
+
+// copies the buffers at the end of the queue as a single piece
+// grows the queue's buffer if it is needed
+// high_water is set if this append made the queue reach its high water mark
+// with SEND_QUEUE_OVERFLOW_DROP, the data is discarded & the queue gets closed
+// returns 0 on success, 1 if the data was NOT queued
+u8 send_queue_append (
+	SendQueue *queue,
+	const struct iovec *iov, const int iovcnt,
+	bool *high_water
+) {
+
+	*high_water = false;
+
+	if (queue->closed) return 1;
+
+	size_t total = 0;
+	for (int i = 0; i < iovcnt; i++) total += iov[i].iov_len;
+
+	const size_t pending = queue->tail - queue->head;
+	if (queue->high_water && ((pending + total) > queue->high_water)) {
+		if (!queue->overflowed) {
+			queue->overflowed = true;
+			queue->stats.n_overflows += 1;
+			*high_water = true;
+		}
+
+		if (queue->overflow == SEND_QUEUE_OVERFLOW_DROP) {
+			queue->head = queue->tail;
+			queue->closed = true;
+
+			return 1;
+		}
+	}
+
+	if ((pending + total) > queue->size) {
+		if (send_queue_grow (queue, pending + total)) return 1;
+	}
+
+	for (int i = 0; i < iovcnt; i++) {
+		send_queue_copy (
+			queue, (const char *) iov[i].iov_base, iov[i].iov_len
+		);
+	}
+
+	queue->stats.n_packets += 1;
+	if ((pending + total) > queue->stats.max_pending)
+		queue->stats.max_pending = pending + total;
+
+	return 0;
+
+}
+
+// sends as many queued bytes as possible to the socket without blocking
+// using up to two iovecs in a single sendmsg () call
+// returns SEND_QUEUE_FLUSH_DONE once the queue is empty,
+// SEND_QUEUE_FLUSH_PENDING if the socket can't take more data
+// and SEND_QUEUE_FLUSH_FAILED on a socket error
+SendQueueFlush send_queue_flush (
+	SendQueue *queue, const int sock_fd, const int flags
+) {
+
+	// the pending bytes must be sent in order
+	if (queue->in_flight) return SEND_QUEUE_FLUSH_PENDING;
+
+	struct iovec iov[2];
+	struct msghdr msg = { 0 };
+	msg.msg_iov = iov;
+
+	size_t pending = 0;
+	size_t start = 0;
+	ssize_t sent = 0;
+	while ((pending = queue->tail - queue->head)) {
+		start = queue->head & (queue->size - 1);
+
+		iov[0].iov_base = queue->buffer + start;
+		iov[0].iov_len = (pending < (queue->size - start))
+			? pending : queue->size - start;
+		msg.msg_iovlen = 1;
+
+		// the pending bytes wrap around the end of the buffer
+		if (pending > iov[0].iov_len) {
+			iov[1].iov_base = queue->buffer;
+			iov[1].iov_len = pending - iov[0].iov_len;
+			msg.msg_iovlen = 2;
+		}
+
+		sent = sendmsg (sock_fd, &msg, flags | MSG_DONTWAIT | MSG_NOSIGNAL);
+		if (sent < 0) {
+			if (errno == EINTR) continue;
+
+			return ((errno == EAGAIN) || (errno == EWOULDBLOCK))
+				? SEND_QUEUE_FLUSH_PENDING : SEND_QUEUE_FLUSH_FAILED;
+		}
+
+		queue->head += (size_t) sent;
+
+		queue->stats.n_writes += 1;
+		queue->stats.bytes_written += (size_t) sent;
+	}
+
+	// the queue is empty again so it can trigger a new overflow
+	queue->overflowed = false;
+
+	return SEND_QUEUE_FLUSH_DONE;
+
+}
+// sets iov with the pending bytes for an asynchronous send
+// the bytes stay in the queue until send_queue_complete () gets called
+// returns the number of iovecs that were set, 0 if there is nothing to send
+// or if there is already a send in flight
+int send_queue_begin (
+	SendQueue *queue, struct iovec iov[2]
+) {
+
+	int iovcnt = 0;
+
+	const size_t pending = queue->tail - queue->head;
+	if (pending && !queue->in_flight) {
+		const size_t start = queue->head & (queue->size - 1);
+
+		iov[0].iov_base = queue->buffer + start;
+		iov[0].iov_len = (pending < (queue->size - start))
+			? pending : queue->size - start;
+		iovcnt = 1;
+
+		if (pending > iov[0].iov_len) {
+			iov[1].iov_base = queue->buffer;
+			iov[1].iov_len = pending - iov[0].iov_len;
+			iovcnt = 2;
+		}
+
+		queue->in_flight = true;
+	}
+
+	return iovcnt;
+
+}
+
+// marks the send in flight as completed with sent bytes
+// the rest of the bytes are kept to be sent again
+void send_queue_complete (
+	SendQueue *queue, const size_t sent
+) {
+
+	queue->in_flight = false;
+	if (queue->retired) {
+		free (queue->retired);
+		queue->retired = NULL;
+	}
+
+	// the queue might have been discarded while the send was in flight
+	const size_t pending = queue->tail - queue->head;
+	queue->head += (sent < pending) ? sent : pending;
+
+	queue->stats.n_writes += 1;
+	queue->stats.bytes_written += sent;
+
+	if (queue->tail == queue->head) queue->overflowed = false;
+
+}
@@ -1,4 +1,12 @@
 #include <stdlib.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <limits.h>
+
+#include <unistd.h>
+
+#include <linux/futex.h>
+#include <sys/syscall.h>
 
 #include "cerver/collections/dlist.h"
 
@@ -19,6 +27,10 @@ void *job_new (void) {
 		job->id = 0;
 		job->work = NULL;
 		job->args = NULL;
+
+		job->timestamp = 0;
+
+		dlist_link_init (&job->link);
 	}
 
 	return job;
@@ -70,6 +82,8 @@ void job_reset (Job *job) {
 	job->work = NULL;
 	job->args = NULL;
 
+	job->timestamp = 0;
+
 }
 
 void job_return (
@@ -214,6 +228,235 @@ void job_handler_wait (
 
 }
 
+static long job_queue_futex (
+	unsigned int *futex, const int op, const unsigned int value
+) {
+
+	return syscall (SYS_futex, futex, op, value, NULL, NULL, 0);
+
+}
+
+static JobQueueRing *job_queue_ring_create (const size_t capacity) {
+
+	size_t size = 2;
+	while (size < capacity) size <<= 1;
+
+	JobQueueRing *ring = (JobQueueRing *) malloc (sizeof (JobQueueRing));
+	if (ring) {
+		ring->cells = (JobQueueCell *) malloc (size * sizeof (JobQueueCell));
+		if (ring->cells) {
+			for (size_t i = 0; i < size; i++) {
+				ring->cells[i].sequence = i;
+				ring->cells[i].data = NULL;
+			}
+
+			ring->mask = size - 1;
+
+			ring->enqueue_pos = 0;
+			ring->dequeue_pos = 0;
+
+			ring->futex = 0;
+			ring->sleepers = 0;
+			ring->waking = 0;
+			ring->signaled = 0;
+		}
+
+		else {
+			free (ring);
+			ring = NULL;
+		}
+	}
+
+	return ring;
+
+}
+
+static void job_queue_ring_delete (JobQueueRing *ring) {
+
+	if (ring) {
+		free (ring->cells);
+
+		free (ring);
+	}
+
+}
+
+// claims the cell at the enqueue position
+// & publishes the data by moving its sequence
+// returns 0 on success, 1 if the ring is full
+static unsigned int job_queue_ring_push (
+	JobQueueRing *ring, void *data
+) {
+
+	unsigned int retval = 1;
+
+	JobQueueCell *cell = NULL;
+	size_t pos = __atomic_load_n (&ring->enqueue_pos, __ATOMIC_RELAXED);
+	intptr_t diff = 0;
+	bool done = false;
+	while (!done) {
+		cell = &ring->cells[pos & ring->mask];
+		diff = (intptr_t) __atomic_load_n (&cell->sequence, __ATOMIC_ACQUIRE)
+			- (intptr_t) pos;
+
+		if (!diff) {
+			if (__atomic_compare_exchange_n (
+				&ring->enqueue_pos, &pos, pos + 1,
+				true, __ATOMIC_RELAXED, __ATOMIC_RELAXED
+			)) {
+				cell->data = data;
+				__atomic_store_n (&cell->sequence, pos + 1, __ATOMIC_RELEASE);
+
+				retval = 0;
+				done = true;
+			}
+		}
+
+		// the cell has not been consumed yet
+		else if (diff < 0) {
+			done = true;
+		}
+
+		// another producer claimed the cell
+		else {
+			pos = __atomic_load_n (&ring->enqueue_pos, __ATOMIC_RELAXED);
+		}
+	}
+
+	return retval;
+
+}
+
+// claims the cell at the dequeue position
+// & releases it for the next lap of producers
+// returns NULL if the ring is empty
+static void *job_queue_ring_pull (JobQueueRing *ring) {
+
+	void *data = NULL;
+
+	JobQueueCell *cell = NULL;
+	size_t pos = __atomic_load_n (&ring->dequeue_pos, __ATOMIC_RELAXED);
+	intptr_t diff = 0;
+	bool done = false;
+	while (!done) {
+		cell = &ring->cells[pos & ring->mask];
+		diff = (intptr_t) __atomic_load_n (&cell->sequence, __ATOMIC_ACQUIRE)
+			- (intptr_t) (pos + 1);
+
+		if (!diff) {
+			if (__atomic_compare_exchange_n (
+				&ring->dequeue_pos, &pos, pos + 1,
+				true, __ATOMIC_RELAXED, __ATOMIC_RELAXED
+			)) {
+				data = cell->data;
+				__atomic_store_n (
+					&cell->sequence, pos + ring->mask + 1, __ATOMIC_RELEASE
+				);
+
+				done = true;
+			}
+		}
+
+		// the cell has not been published yet
+		else if (diff < 0) {
+			done = true;
+		}
+
+		// another consumer claimed the cell
+		else {
+			pos = __atomic_load_n (&ring->dequeue_pos, __ATOMIC_RELAXED);
+		}
+	}
+
+	return data;
+
+}
+
+static bool job_queue_ring_ready (JobQueueRing *ring) {
+
+	size_t pos = __atomic_load_n (&ring->dequeue_pos, __ATOMIC_RELAXED);
+
+	return ((intptr_t) __atomic_load_n (
+		&ring->cells[pos & ring->mask].sequence, __ATOMIC_ACQUIRE
+	) - (intptr_t) (pos + 1)) >= 0;
+
+}
+
+static size_t job_queue_ring_size (JobQueueRing *ring) {
+
+	size_t dequeue_pos = __atomic_load_n (&ring->dequeue_pos, __ATOMIC_ACQUIRE);
+
+	return __atomic_load_n (&ring->enqueue_pos, __ATOMIC_ACQUIRE) - dequeue_pos;
+
+}
+
+// only enters the kernel if there are parked consumers
+// & none of them is already being woken up
+static void job_queue_ring_wake (JobQueueRing *ring) {
+
+	__atomic_thread_fence (__ATOMIC_SEQ_CST);
+
+	if (
+		__atomic_load_n (&ring->sleepers, __ATOMIC_RELAXED)
+		&& !__atomic_load_n (&ring->waking, __ATOMIC_RELAXED)
+		&& !__atomic_exchange_n (&ring->waking, 1, __ATOMIC_ACQ_REL)
+	) {
+		(void) __atomic_add_fetch (&ring->futex, 1, __ATOMIC_SEQ_CST);
+		(void) job_queue_futex (&ring->futex, FUTEX_WAKE_PRIVATE, 1);
+	}
+
+}
+
+// the signal is kept until a consumer takes it
+// just like posting to a bsem
+static void job_queue_ring_signal (
+	JobQueueRing *ring, const unsigned int n_consumers
+) {
+
+	__atomic_store_n (&ring->signaled, 1, __ATOMIC_SEQ_CST);
+
+	(void) __atomic_add_fetch (&ring->futex, 1, __ATOMIC_SEQ_CST);
+	(void) job_queue_futex (&ring->futex, FUTEX_WAKE_PRIVATE, n_consumers);
+
+}
+
+// parks the consumer until there is a job or a signal
+// any push or signal after reading the futex word
+// makes FUTEX_WAIT return right away
+static void job_queue_ring_wait (JobQueueRing *ring) {
+
+	unsigned int futex = __atomic_load_n (&ring->futex, __ATOMIC_SEQ_CST);
+
+	if (
+		!__atomic_exchange_n (&ring->signaled, 0, __ATOMIC_SEQ_CST)
+		&& !job_queue_ring_ready (ring)
+	) {
+		(void) __atomic_add_fetch (&ring->sleepers, 1, __ATOMIC_SEQ_CST);
+		__atomic_thread_fence (__ATOMIC_SEQ_CST);
+
+		if (
+			!job_queue_ring_ready (ring)
+			&& !__atomic_load_n (&ring->signaled, __ATOMIC_SEQ_CST)
+		) {
+			(void) job_queue_futex (&ring->futex, FUTEX_WAIT_PRIVATE, futex);
+		}
+
+		(void) __atomic_sub_fetch (&ring->sleepers, 1, __ATOMIC_SEQ_CST);
+
+		// let producers wake up another consumer
+		__atomic_store_n (&ring->waking, 0, __ATOMIC_RELEASE);
+	}
+
+}
+
+// deletes every job that is still in the ring
+static void job_queue_ring_clear (JobQueueRing *ring) {
+
+	void *job = NULL;
+	while ((job = job_queue_ring_pull (ring))) job_delete (job);
+
+}
+
 JobQueue *job_queue_new (void) {
 
 	JobQueue *job_queue = (JobQueue *) malloc (sizeof (JobQueue));
@@ -223,6 +466,7 @@ JobQueue *job_queue_new (void) {
 		job_queue->pool = NULL;
 
 		job_queue->queue = NULL;
+		job_queue->ring = NULL;
 
 		job_queue->rwmutex = NULL;
 		job_queue->has_jobs = NULL;
@@ -232,6 +476,7 @@ JobQueue *job_queue_new (void) {
 		job_queue->requested_job = NULL;
 
 		job_queue->running = false;
+		job_queue->handler_thread_id = 0;
 		job_queue->handler = NULL;
 	}
 
@@ -253,6 +498,11 @@ void job_queue_delete (void *job_queue_ptr) {
 		// job_queue_clear (job_queue);
 		dlist_delete (job_queue->queue);
 
+		if (job_queue->ring) {
+			job_queue_ring_clear (job_queue->ring);
+			job_queue_ring_delete (job_queue->ring);
+		}
+
 		if (job_queue->rwmutex) {
 			(void) pthread_mutex_unlock (job_queue->rwmutex);
 			(void) pthread_mutex_destroy (job_queue->rwmutex);
@@ -280,7 +530,10 @@ static void job_queue_create_jobs (JobQueue *job_queue) {
 		);
 	}
 
-	job_queue->queue = dlist_init (job_delete, NULL);
+	// jobs are linked using their own list element
+	job_queue->queue = dlist_init_intrusive (
+		job_delete, NULL, dlist_link_offset (Job, link)
+	);
 
 }
 
@@ -302,8 +555,41 @@ static void job_queue_create_handlers (JobQueue *job_queue) {
 
 }
 
+// ring queues hold jobs without any lock or bsem
+// idle consumers are parked using a futex
+static void job_queue_create_ring (
+	JobQueue *job_queue, const size_t capacity
+) {
+
+	job_queue->pool = pool_create (job_delete);
+	if (job_queue->pool) {
+		pool_set_create (job_queue->pool, job_new);
+		pool_set_produce_if_empty (job_queue->pool, true);
+
+		(void) pool_init (
+			job_queue->pool,
+			job_new,
+			JOB_QUEUE_POOL_INIT
+		);
+	}
+
+	job_queue->ring = job_queue_ring_create (capacity);
+
+}
+
 JobQueue *job_queue_create (const JobQueueType type) {
 
+	return job_queue_create_with_capacity (type, JOB_QUEUE_RING_CAPACITY);
+
+}
+
+// creates a new job queue with a custom capacity
+// that is only used by JOB_QUEUE_TYPE_RING queues
+// the capacity is rounded up to the next power of two
+JobQueue *job_queue_create_with_capacity (
+	const JobQueueType type, const size_t capacity
+) {
+
 	JobQueue *job_queue = job_queue_new ();
 	if (job_queue) {
 		job_queue->type = type;
@@ -317,14 +603,25 @@ JobQueue *job_queue_create (const JobQueueType type) {
 				job_queue_create_handlers (job_queue);
 				break;
 
+			case JOB_QUEUE_TYPE_RING:
+				job_queue_create_ring (job_queue, capacity);
+				break;
+
 			default: break;
 		}
 
-		job_queue->rwmutex = (pthread_mutex_t *) malloc (sizeof (pthread_mutex_t));
-		(void) pthread_mutex_init (job_queue->rwmutex, NULL);
+		if (job_queue->type != JOB_QUEUE_TYPE_RING) {
+			job_queue->rwmutex = (pthread_mutex_t *) malloc (sizeof (pthread_mutex_t));
+			(void) pthread_mutex_init (job_queue->rwmutex, NULL);
 
-		job_queue->has_jobs = bsem_new ();
-		bsem_init (job_queue->has_jobs, 0);
+			job_queue->has_jobs = bsem_new ();
+			bsem_init (job_queue->has_jobs, 0);
+		}
+
+		else if (!job_queue->ring) {
+			job_queue_delete (job_queue);
+			job_queue = NULL;
+		}
 	}
 
 	return job_queue;
@@ -345,17 +642,23 @@ static unsigned int job_queue_push_internal (
 
 	unsigned int retval = 1;
 
-	(void) pthread_mutex_lock (job_queue->rwmutex);
+	if (job_queue->ring) {
+		retval = job_queue_ring_push (job_queue->ring, job_ptr);
+		if (!retval) job_queue_ring_wake (job_queue->ring);
+	}
 
-	retval = dlist_insert_after (
-		job_queue->queue,
-		dlist_end (job_queue->queue),
-		job_ptr
-	);
+	else {
+		(void) pthread_mutex_lock (job_queue->rwmutex);
 
-	bsem_post (job_queue->has_jobs);
+		// the queue is only accessed with the rwmutex
+		retval = dlist_insert_at_end_unsafe (
+			job_queue->queue, job_ptr
+		);
 
-	(void) pthread_mutex_unlock (job_queue->rwmutex);
+		bsem_post (job_queue->has_jobs);
+
+		(void) pthread_mutex_unlock (job_queue->rwmutex);
+	}
 
 	return retval;
 
@@ -370,6 +673,15 @@ unsigned int job_queue_push (JobQueue *job_queue, void *job_ptr) {
 
 }
 
+// adds a job created with job_new () or job_create () to the queue
+// returns 0 on success, 1 on error
+unsigned int job_queue_push_existing_job (JobQueue *job_queue, Job *job) {
+
+	return (job_queue && job) ?
+		job_queue_push_internal (job_queue, job) : 1;
+
+}
+
 unsigned int job_queue_push_job (
 	JobQueue *job_queue,
 	void (*work) (void *args), void *args
@@ -388,6 +700,10 @@ unsigned int job_queue_push_job (
 			)) {
 				retval = 0;
 			}
+
+			else {
+				job_return (job_queue, job);
+			}
 		}
 	}
 
@@ -395,6 +711,49 @@ unsigned int job_queue_push_job (
 
 }
 
+// adds n jobs to the queue using a single lock & wakeup
+// returns the number of jobs that were added
+// the remaining ones still belong to the caller
+unsigned int job_queue_push_batch (
+	JobQueue *job_queue, void **jobs, const unsigned int n_jobs
+) {
+
+	unsigned int pushed = 0;
+
+	if (job_queue && jobs && n_jobs) {
+		if (job_queue->ring) {
+			while (
+				(pushed < n_jobs)
+				&& !job_queue_ring_push (job_queue->ring, jobs[pushed])
+			) {
+				pushed += 1;
+			}
+
+			if (pushed) job_queue_ring_wake (job_queue->ring);
+		}
+
+		else {
+			(void) pthread_mutex_lock (job_queue->rwmutex);
+
+			while (
+				(pushed < n_jobs)
+				&& !dlist_insert_at_end_unsafe (
+					job_queue->queue, jobs[pushed]
+				)
+			) {
+				pushed += 1;
+			}
+
+			if (pushed) bsem_post (job_queue->has_jobs);
+
+			(void) pthread_mutex_unlock (job_queue->rwmutex);
+		}
+	}
+
+	return pushed;
+
+}
+
 static unsigned int job_queue_push_job_with_id_internal (
 	JobQueue *job_queue, Job *job
 ) {
@@ -412,10 +771,8 @@ static unsigned int job_queue_push_job_with_id_internal (
 	}
 
 	else {
-		retval = dlist_insert_after (
-			job_queue->queue,
-			dlist_end (job_queue->queue),
-			job
+		retval = dlist_insert_at_end_unsafe (
+			job_queue->queue, job
 		);
 	}
 
@@ -433,7 +790,7 @@ unsigned int job_queue_push_job_with_id (
 
 	unsigned int retval = 1;
 
-	if (job_queue) {
+	if (job_queue && !job_queue->ring) {
 		Job *job = (Job *) pool_pop (job_queue->pool);
 		if (job) {
 			job->id = job_id;
@@ -486,37 +843,111 @@ void *job_queue_pull (JobQueue *job_queue) {
 	void *retval = NULL;
 
 	if (job_queue) {
-		(void) pthread_mutex_lock (job_queue->rwmutex);
+		if (job_queue->ring) {
+			// wake up another consumer if there are more jobs
+			// just like re-posting to the bsem
+			retval = job_queue_ring_pull (job_queue->ring);
+			if (retval && job_queue_ring_ready (job_queue->ring))
+				job_queue_ring_wake (job_queue->ring);
+		}
+
+		else {
+			(void) pthread_mutex_lock (job_queue->rwmutex);
 
-		switch (job_queue->queue->size) {
-			case 0: break;
+			switch (job_queue->queue->size) {
+				case 0: break;
 
-			case 1:
-				// remove at the start of the list
-				retval = dlist_remove_element (job_queue->queue, NULL);
-				break;
+				case 1:
+					// remove at the start of the list
+					retval = dlist_remove_start_unsafe (job_queue->queue);
+					break;
 
-			default:
-				// remove at the start of the list
-				retval = dlist_remove_element (job_queue->queue, NULL);
-				bsem_post (job_queue->has_jobs);
-				break;
-		}
+				default:
+					// remove at the start of the list
+					retval = dlist_remove_start_unsafe (job_queue->queue);
+					bsem_post (job_queue->has_jobs);
+					break;
+			}
 
-		(void) pthread_mutex_unlock (job_queue->rwmutex);
+			(void) pthread_mutex_unlock (job_queue->rwmutex);
+		}
 	}
 
 	return retval;
 
 }
 
+// gets up to max_jobs from the start of the queue
+// using a single lock
+// returns the number of jobs that were placed in jobs
+unsigned int job_queue_pull_batch (
+	JobQueue *job_queue, void **jobs, const unsigned int max_jobs
+) {
+
+	unsigned int pulled = 0;
+
+	if (job_queue && jobs) {
+		if (job_queue->ring) {
+			while (
+				(pulled < max_jobs)
+				&& (jobs[pulled] = job_queue_ring_pull (job_queue->ring))
+			) {
+				pulled += 1;
+			}
+
+			if (pulled && job_queue_ring_ready (job_queue->ring))
+				job_queue_ring_wake (job_queue->ring);
+		}
+
+		else {
+			(void) pthread_mutex_lock (job_queue->rwmutex);
+
+			while ((pulled < max_jobs) && job_queue->queue->size) {
+				jobs[pulled] = dlist_remove_start_unsafe (job_queue->queue);
+				pulled += 1;
+			}
+
+			// let another thread handle the remaining jobs
+			if (job_queue->queue->size) bsem_post (job_queue->has_jobs);
+
+			(void) pthread_mutex_unlock (job_queue->rwmutex);
+		}
+	}
+
+	return pulled;
+
+}
+
+// returns the number of jobs that are waiting in the queue
+size_t job_queue_size (JobQueue *job_queue) {
+
+	size_t size = 0;
+
+	if (job_queue) {
+		if (job_queue->ring) {
+			size = job_queue_ring_size (job_queue->ring);
+		}
+
+		else {
+			(void) pthread_mutex_lock (job_queue->rwmutex);
+
+			size = job_queue->queue->size;
+
+			(void) pthread_mutex_unlock (job_queue->rwmutex);
+		}
+	}
+
+	return size;
+
+}
+
 // requests to get an specific job from the queue by matching id
 // blocks and waits until the requested job is available
 void *job_queue_request (JobQueue *job_queue, const u64 job_id) {
 
 	void *match = NULL;
 
-	if (job_queue) {
+	if (job_queue && !job_queue->ring) {
 		(void) pthread_mutex_lock (job_queue->rwmutex);
 
 		// check if the job is already in the queue
@@ -562,7 +993,7 @@ static void *job_queue_jobs (void *job_queue_ptr) {
 
 	Job *job = NULL;
 	while (job_queue->running) {
-		bsem_wait (job_queue->has_jobs);
+		job_queue_wait (job_queue);
 
 		job = (Job *) job_queue_pull (job_queue);
 		if (job) {
@@ -588,7 +1019,7 @@ static void *job_queue_handlers (void *job_queue_ptr) {
 
 	JobHandler *job_handler = NULL;
 	while (job_queue->running) {
-		bsem_wait (job_queue->has_jobs);
+		job_queue_wait (job_queue);
 
 		job_handler = (JobHandler *) job_queue_pull (job_queue);
 		if (job_handler) {
@@ -623,6 +1054,7 @@ static unsigned int job_queue_start_internal (JobQueue *job_queue) {
 	job_queue->running = true;
 	switch (job_queue->type) {
 		case JOB_QUEUE_TYPE_JOBS:
+		case JOB_QUEUE_TYPE_RING:
 			retval = thread_create_detachable (
 				&job_queue->handler_thread_id,
 				job_queue_jobs,
@@ -663,14 +1095,24 @@ unsigned int job_queue_start (JobQueue *job_queue) {
 // wait for work or signal on the job queue
 void job_queue_wait (JobQueue *job_queue) {
 
-	bsem_wait (job_queue->has_jobs);
+	if (job_queue->ring) job_queue_ring_wait (job_queue->ring);
+	else bsem_wait (job_queue->has_jobs);
 
 }
 
 // signal a job queue
 void job_queue_signal (JobQueue *job_queue) {
 
-	bsem_post (job_queue->has_jobs);
+	if (job_queue->ring) job_queue_ring_signal (job_queue->ring, 1);
+	else bsem_post (job_queue->has_jobs);
+
+}
+
+// signal every thread that is waiting on the job queue
+void job_queue_signal_all (JobQueue *job_queue) {
+
+	if (job_queue->ring) job_queue_ring_signal (job_queue->ring, INT_MAX);
+	else bsem_post_all (job_queue->has_jobs);
 
 }
 
@@ -681,7 +1123,7 @@ unsigned int job_queue_stop (JobQueue *job_queue) {
 	if (job_queue) {
 		if (job_queue->running) {
 			job_queue->running = false;
-			bsem_post (job_queue->has_jobs);
+			job_queue_signal (job_queue);
 			retval = 0;
 		}
 	}
@@ -694,9 +1136,19 @@ unsigned int job_queue_stop (JobQueue *job_queue) {
 void job_queue_clear (JobQueue *job_queue) {
 
 	if (job_queue) {
-		dlist_reset (job_queue->queue);
+		if (job_queue->ring) {
+			job_queue_ring_clear (job_queue->ring);
+		}
 
-		bsem_reset (job_queue->has_jobs);
+		else {
+			(void) pthread_mutex_lock (job_queue->rwmutex);
+
+			dlist_reset (job_queue->queue);
+
+			bsem_reset (job_queue->has_jobs);
+
+			(void) pthread_mutex_unlock (job_queue->rwmutex);
+		}
 	}
 
 }
@@ -12,13 +12,221 @@
 #include <sys/prctl.h>
 #endif
 
+#include "cerver/types/types.h"
+
 #include "cerver/threads/bsem.h"
 #include "cerver/threads/jobs.h"
 #include "cerver/threads/thpool.h"
 #include "cerver/threads/thread.h"
 
+#define THPOOL_CACHE_LINE			64
+
+// how long to wait for threads to end before signaling them again
+#define THPOOL_DESTROY_WAIT_NS		10000000
+
 static void *thread_do (void *thread_ptr);
 
+#pragma region deque
+
+// Chase-Lev work stealing deque
+// the owner pushes & takes jobs at the bottom
+// while other threads steal them from the top
+
+typedef struct ThpoolDequeArray {
+
+	long size;
+
+	// arrays are only deleted with the deque
+	// as stealers might still be reading from them
+	struct ThpoolDequeArray *prev;
+
+	void *buffer[];
+
+} ThpoolDequeArray;
+
+typedef struct ThpoolDeque {
+
+	long top;
+
+	char pad_0[THPOOL_CACHE_LINE];
+
+	long bottom;
+
+	char pad_1[THPOOL_CACHE_LINE];
+
+	ThpoolDequeArray *array;
+
+} ThpoolDeque;
+
+static ThpoolDequeArray *thpool_deque_array_new (const long size) {
+
+	ThpoolDequeArray *array = (ThpoolDequeArray *) malloc (
+		sizeof (ThpoolDequeArray) + ((size_t) size * sizeof (void *))
+	);
+
+	if (array) {
+		array->size = size;
+		array->prev = NULL;
+	}
+
+	return array;
+
+}
+
+static unsigned int thpool_deque_init (ThpoolDeque *deque) {
+
+	deque->top = 0;
+	deque->bottom = 0;
+	deque->array = thpool_deque_array_new (THPOOL_DEQUE_SIZE);
+
+	return deque->array ? 0 : 1;
+
+}
+
+// deletes the jobs that were never executed & every array
+static void thpool_deque_end (ThpoolDeque *deque) {
+
+	if (deque->array) {
+		for (long i = deque->top; i < deque->bottom; i++)
+			job_delete (deque->array->buffer[i & (deque->array->size - 1)]);
+
+		ThpoolDequeArray *prev = NULL;
+		while (deque->array) {
+			prev = deque->array->prev;
+			free (deque->array);
+			deque->array = prev;
+		}
+	}
+
+}
+
+static long thpool_deque_size (ThpoolDeque *deque) {
+
+	long top = __atomic_load_n (&deque->top, __ATOMIC_ACQUIRE);
+
+	return __atomic_load_n (&deque->bottom, __ATOMIC_ACQUIRE) - top;
+
+}
+
+// only the owner grows the deque
+static ThpoolDequeArray *thpool_deque_grow (
+	ThpoolDeque *deque, ThpoolDequeArray *array,
+	const long top, const long bottom
+) {
+
+	ThpoolDequeArray *bigger = thpool_deque_array_new (array->size * 2);
+	if (bigger) {
+		for (long i = top; i < bottom; i++) {
+			bigger->buffer[i & (bigger->size - 1)] =
+				array->buffer[i & (array->size - 1)];
+		}
+
+		bigger->prev = array;
+
+		__atomic_store_n (&deque->array, bigger, __ATOMIC_RELEASE);
+	}
+
+	return bigger;
+
+}
+
+// called by the owner
+// returns 0 on success, 1 on error
+static unsigned int thpool_deque_push (ThpoolDeque *deque, void *job) {
+
+	unsigned int retval = 1;
+
+	long bottom = __atomic_load_n (&deque->bottom, __ATOMIC_RELAXED);
+	long top = __atomic_load_n (&deque->top, __ATOMIC_ACQUIRE);
+	ThpoolDequeArray *array = __atomic_load_n (&deque->array, __ATOMIC_RELAXED);
+
+	if ((bottom - top) > (array->size - 1))
+		array = thpool_deque_grow (deque, array, top, bottom);
+
+	if (array) {
+		__atomic_store_n (
+			&array->buffer[bottom & (array->size - 1)], job, __ATOMIC_RELAXED
+		);
+
+		__atomic_thread_fence (__ATOMIC_RELEASE);
+		__atomic_store_n (&deque->bottom, bottom + 1, __ATOMIC_RELAXED);
+
+		retval = 0;
+	}
+
+	return retval;
+
+}
+
+// called by the owner
+// returns NULL if the deque is empty
+static void *thpool_deque_take (ThpoolDeque *deque) {
+
+	void *job = NULL;
+
+	long bottom = __atomic_load_n (&deque->bottom, __ATOMIC_RELAXED) - 1;
+	ThpoolDequeArray *array = __atomic_load_n (&deque->array, __ATOMIC_RELAXED);
+	__atomic_store_n (&deque->bottom, bottom, __ATOMIC_RELAXED);
+
+	__atomic_thread_fence (__ATOMIC_SEQ_CST);
+
+	long top = __atomic_load_n (&deque->top, __ATOMIC_RELAXED);
+	if (top <= bottom) {
+		job = __atomic_load_n (
+			&array->buffer[bottom & (array->size - 1)], __ATOMIC_RELAXED
+		);
+
+		// the last job can also be taken by a stealer
+		if (top == bottom) {
+			if (!__atomic_compare_exchange_n (
+				&deque->top, &top, top + 1,
+				false, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED
+			)) {
+				job = NULL;
+			}
+
+			__atomic_store_n (&deque->bottom, bottom + 1, __ATOMIC_RELAXED);
+		}
+	}
+
+	else {
+		__atomic_store_n (&deque->bottom, bottom + 1, __ATOMIC_RELAXED);
+	}
+
+	return job;
+
+}
+
+// called by any other thread
+// returns NULL if the deque is empty or if another thread won the job
+static void *thpool_deque_steal (ThpoolDeque *deque) {
+
+	void *job = NULL;
+
+	long top = __atomic_load_n (&deque->top, __ATOMIC_ACQUIRE);
+	__atomic_thread_fence (__ATOMIC_SEQ_CST);
+	long bottom = __atomic_load_n (&deque->bottom, __ATOMIC_ACQUIRE);
+
+	if (top < bottom) {
+		ThpoolDequeArray *array = __atomic_load_n (&deque->array, __ATOMIC_ACQUIRE);
+		job = __atomic_load_n (
+			&array->buffer[top & (array->size - 1)], __ATOMIC_RELAXED
+		);
+
+		if (!__atomic_compare_exchange_n (
+			&deque->top, &top, top + 1,
+			false, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED
+		)) {
+			job = NULL;
+		}
+	}
+
+	return job;
+
+}
+
+#pragma endregion
+
 #pragma region thread
 
 struct _PoolThread {
@@ -27,10 +235,26 @@ struct _PoolThread {
 	pthread_t thread_id;
 	Thpool *thpool;
 
+	// only used with work stealing
+	ThpoolDeque deque;
+	unsigned int next_victim;
+
+	ThpoolThreadStats stats;
+
 };
 
 typedef struct _PoolThread PoolThread;
 
+// the pool thread that is running in the current thread
+static pthread_once_t pool_thread_once = PTHREAD_ONCE_INIT;
+static pthread_key_t pool_thread_key;
+
+static void pool_thread_key_create (void) {
+
+	(void) pthread_key_create (&pool_thread_key, NULL);
+
+}
+
 static PoolThread *pool_thread_new (void) {
 
 	PoolThread *thread = (PoolThread *) malloc (sizeof (PoolThread));
@@ -38,6 +262,13 @@ static PoolThread *pool_thread_new (void) {
 		thread->id = -1;
 		thread->thread_id = 0;
 		thread->thpool = NULL;
+
+		thread->deque.top = 0;
+		thread->deque.bottom = 0;
+		thread->deque.array = NULL;
+		thread->next_victim = 0;
+
+		(void) memset (&thread->stats, 0, sizeof (ThpoolThreadStats));
 	}
 
 	return thread;
@@ -46,7 +277,11 @@ static PoolThread *pool_thread_new (void) {
 
 static void pool_thread_delete (void *thread_ptr) {
 
-	if (thread_ptr) free (thread_ptr);
+	if (thread_ptr) {
+		thpool_deque_end (&((PoolThread *) thread_ptr)->deque);
+
+		free (thread_ptr);
+	}
 
 }
 
@@ -56,6 +291,10 @@ static PoolThread *pool_thread_create (int id, Thpool *thpool) {
 	if (thread) {
 		thread->id = id;
 		thread->thpool = thpool;
+
+		// the deque is allocated by the thread itself
+		if (thpool->work_stealing)
+			thread->next_victim = (unsigned int) id + 1;
 	}
 
 	return thread;
@@ -100,8 +339,15 @@ static Thpool *thpool_new (void) {
 
 		thpool->mutex = NULL;
 		thpool->threads_all_idle = NULL;
+		thpool->threads_alive = NULL;
 
 		thpool->job_queue = NULL;
+
+		thpool->work_stealing = false;
+		thpool->num_threads_sleeping = 0;
+		thpool->num_jobs_pending = 0;
+
+		thread_affinity_init (&thpool->affinity, THREAD_AFFINITY_NONE);
 	}
 
 	return thpool;
@@ -131,6 +377,8 @@ static void thpool_delete (void *thpool_ptr) {
 			free (thpool->threads_all_idle);
 		}
 
+		thread_cond_delete (thpool->threads_alive);
+
 		job_queue_delete (thpool->job_queue);
 
 		free (thpool_ptr);
@@ -142,12 +390,183 @@ static void thpool_delete (void *thpool_ptr) {
 
 #pragma region internal
 
+static u64 thpool_time_ns (void) {
+
+	struct timespec now = { 0 };
+	(void) clock_gettime (CLOCK_MONOTONIC, &now);
+
+	return ((u64) now.tv_sec * 1000000000) + (u64) now.tv_nsec;
+
+}
+
+// the owner is the only one that writes its stats
+static inline void pool_thread_stat_add (u64 *stat, const u64 value) {
+
+	__atomic_store_n (
+		stat, __atomic_load_n (stat, __ATOMIC_RELAXED) + value, __ATOMIC_RELAXED
+	);
+
+}
+
+static void thpool_job_done (Thpool *thpool) {
+
+	// wake up thpool_wait () when the last job is done
+	if (!__atomic_sub_fetch (&thpool->num_jobs_pending, 1, __ATOMIC_ACQ_REL)) {
+		(void) pthread_mutex_lock (thpool->mutex);
+		(void) pthread_cond_broadcast (thpool->threads_all_idle);
+		(void) pthread_mutex_unlock (thpool->mutex);
+	}
+
+}
+
+static bool thpool_has_work (Thpool *thpool) {
+
+	bool has_work = job_queue_size (thpool->job_queue);
+
+	PoolThread *thread = NULL;
+	for (unsigned int i = 0; i < thpool->n_threads && !has_work; i++) {
+		thread = __atomic_load_n (&thpool->threads[i], __ATOMIC_ACQUIRE);
+		if (thread && (thpool_deque_size (&thread->deque) > 0))
+			has_work = true;
+	}
+
+	return has_work;
+
+}
+
+// tries to steal a job from every other thread
+// starting from a different victim every time
+static Job *thpool_steal (PoolThread *thread) {
+
+	Thpool *thpool = thread->thpool;
+
+	Job *job = NULL;
+	PoolThread *victim = NULL;
+	for (unsigned int i = 0; i < thpool->n_threads && !job; i++) {
+		victim = __atomic_load_n (
+			&thpool->threads[(thread->next_victim + i) % thpool->n_threads],
+			__ATOMIC_ACQUIRE
+		);
+
+		if (victim && (victim != thread) && victim->deque.array) {
+			job = (Job *) thpool_deque_steal (&victim->deque);
+		}
+	}
+
+	thread->next_victim += 1;
+
+	return job;
+
+}
+
+// parks the thread in the injector queue until there is more work
+static void thpool_thread_idle (PoolThread *thread) {
+
+	Thpool *thpool = thread->thpool;
+
+	u64 start = thpool_time_ns ();
+
+	(void) __atomic_add_fetch (&thpool->num_threads_sleeping, 1, __ATOMIC_SEQ_CST);
+	__atomic_thread_fence (__ATOMIC_SEQ_CST);
+
+	// jobs pushed to a deque before we were counted
+	// must be seen here, the ones after will signal the queue
+	if (thpool->keep_alive && !thpool_has_work (thpool))
+		job_queue_wait (thpool->job_queue);
+
+	(void) __atomic_sub_fetch (&thpool->num_threads_sleeping, 1, __ATOMIC_SEQ_CST);
+
+	pool_thread_stat_add (&thread->stats.idle_time, thpool_time_ns () - start);
+
+}
+
+static void thread_do_work_stealing (PoolThread *thread) {
+
+	Thpool *thpool = thread->thpool;
+
+	Job *job = NULL;
+	bool stolen = false;
+	while (thpool->keep_alive) {
+		stolen = false;
+
+		// local jobs first, then the injector & finally other threads
+		job = (Job *) thpool_deque_take (&thread->deque);
+		if (!job) job = (Job *) job_queue_pull (thpool->job_queue);
+		if (!job) {
+			job = thpool_steal (thread);
+			stolen = (job != NULL);
+		}
+
+		if (job) {
+			(void) __atomic_add_fetch (&thpool->num_threads_working, 1, __ATOMIC_RELAXED);
+
+			if (job->work)
+				job->work (job->args);
+
+			job_delete (job);
+
+			pool_thread_stat_add (&thread->stats.executed, 1);
+			if (stolen) pool_thread_stat_add (&thread->stats.stolen, 1);
+
+			(void) __atomic_sub_fetch (&thpool->num_threads_working, 1, __ATOMIC_RELAXED);
+
+			thpool_job_done (thpool);
+		}
+
+		else {
+			thpool_thread_idle (thread);
+		}
+	}
+
+}
+
+static void thread_do_shared_queue (PoolThread *thread) {
+
+	Thpool *thpool = thread->thpool;
+
+	u64 start = 0;
+	while (thpool->keep_alive) {
+		start = thpool_time_ns ();
+		job_queue_wait (thpool->job_queue);
+		pool_thread_stat_add (&thread->stats.idle_time, thpool_time_ns () - start);
+
+		if (thpool->keep_alive) {
+			(void) pthread_mutex_lock (thpool->mutex);
+			thpool->num_threads_working += 1;
+			(void) pthread_mutex_unlock (thpool->mutex);
+
+			// get job to execute
+			Job *job = job_queue_pull (thpool->job_queue);
+			if (job) {
+				if (job->work)
+					job->work (job->args);
+
+				job_delete (job);
+
+				pool_thread_stat_add (&thread->stats.executed, 1);
+			}
+
+			(void) pthread_mutex_lock (thpool->mutex);
+
+			thpool->num_threads_working -= 1;
+
+			if (!thpool->num_threads_working)
+				(void) pthread_cond_signal (thpool->threads_all_idle);
+
+			(void) pthread_mutex_unlock (thpool->mutex);
+		}
+	}
+
+}
+
 static void *thread_do (void *thread_ptr) {
 
 	if (thread_ptr) {
 		PoolThread *thread = (PoolThread *) thread_ptr;
 		Thpool *thpool = thread->thpool;
 
+		(void) pthread_setspecific (pool_thread_key, thread);
+
 		// set name
 		if (thpool->namelen) {
 			(void) thread_set_name (
@@ -156,40 +575,35 @@ static void *thread_do (void *thread_ptr) {
 			);
 		}
 
+		// pin the thread before its deque is first touched
+		if (thpool->affinity.type != THREAD_AFFINITY_NONE) {
+			char thread_name[THPOOL_NAME_SIZE + 32] = { 0 };
+			(void) snprintf (
+				thread_name, THPOOL_NAME_SIZE + 32,
+				"thpool-%s-%d", thpool->name, thread->id
+			);
+
+			(void) thread_affinity_apply (
+				&thpool->affinity, (unsigned int) thread->id, thread_name
+			);
+		}
+
+		// stealers only read the array after a job has been pushed
+		if (thpool->work_stealing)
+			(void) thpool_deque_init (&thread->deque);
+
 		// mark thread as alive
 		(void) pthread_mutex_lock (thpool->mutex);
 		thpool->num_threads_alive += 1;
+		(void) pthread_cond_broadcast (thpool->threads_alive);
 		(void) pthread_mutex_unlock (thpool->mutex);
 
-		while (thpool->keep_alive) {
-			bsem_wait (thpool->job_queue->has_jobs);
-			if (thpool->keep_alive) {
-				(void) pthread_mutex_lock (thpool->mutex);
-				thpool->num_threads_working += 1;
-				(void) pthread_mutex_unlock (thpool->mutex);
-
-				// get job to execute
-				Job *job = job_queue_pull (thpool->job_queue);
-				if (job) {
-					if (job->work)
-						job->work (job->args);
-
-					job_delete (job);
-				}
-
-				(void) pthread_mutex_lock (thpool->mutex);
-
-				thpool->num_threads_working -= 1;
-
-				if (!thpool->num_threads_working)
-					(void) pthread_cond_signal (thpool->threads_all_idle);
-
-				(void) pthread_mutex_unlock (thpool->mutex);
-			}
-		}
+		if (thpool->work_stealing) thread_do_work_stealing (thread);
+		else thread_do_shared_queue (thread);
 
 		(void) pthread_mutex_lock (thpool->mutex);
 		thpool->num_threads_alive -= 1;
+		(void) pthread_cond_broadcast (thpool->threads_alive);
 		(void) pthread_mutex_unlock (thpool->mutex);
 	}
 
@@ -215,7 +629,11 @@ Thpool *thpool_create (unsigned int n_threads) {
 			thpool->threads_all_idle = (pthread_cond_t *) malloc (sizeof (pthread_cond_t));
 			(void) pthread_cond_init (thpool->threads_all_idle, NULL);
 
+			thpool->threads_alive = thread_cond_new ();
+
 			thpool->job_queue = job_queue_create (JOB_QUEUE_TYPE_JOBS);
+
+			(void) pthread_once (&pool_thread_once, pool_thread_key_create);
 		}
 
 		else {
@@ -240,12 +658,19 @@ unsigned int thpool_init (Thpool *thpool) {
 		// initialize threads
 		thpool->keep_alive = true;
 		for (unsigned int i = 0; i < thpool->n_threads; i++) {
-			thpool->threads[i] = pool_thread_create (i, thpool);
+			__atomic_store_n (
+				&thpool->threads[i], pool_thread_create (i, thpool), __ATOMIC_RELEASE
+			);
+
 			(void) pool_thread_init (thpool->threads[i]);
 		}
 
 		// wait for threads to initialize
-		while (thpool->num_threads_alive != thpool->n_threads) {}
+		(void) pthread_mutex_lock (thpool->mutex);
+		while (thpool->num_threads_alive != thpool->n_threads) {
+			(void) pthread_cond_wait (thpool->threads_alive, thpool->mutex);
+		}
+		(void) pthread_mutex_unlock (thpool->mutex);
 
 		retval = 0;
 	}
@@ -264,6 +689,38 @@ void thpool_set_name (Thpool *thpool, const char *name) {
 
 }
 
+// enables work stealing between the thpool's threads
+// every thread gets its own deque where the jobs added
+// from inside the thpool are placed, jobs from outside are placed
+// in a global injector queue, and idle threads steal from the others
+// must be called before thpool_init ()
+void thpool_set_work_stealing (Thpool *thpool, bool work_stealing) {
+
+	if (thpool && !thpool->keep_alive) {
+		if (thpool->work_stealing != work_stealing) {
+			// the injector is a lock-free ring
+			// where idle threads are parked
+			job_queue_delete (thpool->job_queue);
+			thpool->job_queue = job_queue_create (
+				work_stealing ? JOB_QUEUE_TYPE_RING : JOB_QUEUE_TYPE_JOBS
+			);
+
+			thpool->work_stealing = work_stealing;
+		}
+	}
+
+}
+
+// sets the cpus where the thpool's threads will run
+// every thread uses its id as its idx for spread & compact affinities
+// must be called before thpool_init ()
+void thpool_set_affinity (Thpool *thpool, const ThreadAffinity *affinity) {
+
+	if (thpool && affinity && !thpool->keep_alive)
+		thpool->affinity = *affinity;
+
+}
+
 // gets the current number of threads that are alive (running) in the thpool
 unsigned int thpool_get_num_threads_alive (Thpool *thpool) {
 
@@ -338,7 +795,35 @@ int thpool_add_work (
 
 	if (thpool && work) {
 		Job *job = job_create (work, args);
-		retval = job_queue_push (thpool->job_queue, job);
+		if (thpool->work_stealing) {
+			(void) __atomic_add_fetch (&thpool->num_jobs_pending, 1, __ATOMIC_ACQ_REL);
+
+			// jobs from our own threads go to their local deque
+			PoolThread *thread = (PoolThread *) pthread_getspecific (pool_thread_key);
+			if (
+				thread && (thread->thpool == thpool)
+				&& !thpool_deque_push (&thread->deque, job)
+			) {
+				// wake up an idle thread so it can steal the job
+				__atomic_thread_fence (__ATOMIC_SEQ_CST);
+				if (__atomic_load_n (&thpool->num_threads_sleeping, __ATOMIC_RELAXED))
+					job_queue_signal (thpool->job_queue);
+
+				retval = 0;
+			}
+
+			else {
+				retval = (int) job_queue_push_existing_job (thpool->job_queue, job);
+				if (retval) {
+					job_delete (job);
+					thpool_job_done (thpool);
+				}
+			}
+		}
+
+		else {
+			retval = job_queue_push_existing_job (thpool->job_queue, job);
+		}
 	}
 
 	return retval;
@@ -351,13 +836,23 @@ void thpool_wait (Thpool *thpool) {
 	if (thpool) {
 		(void) pthread_mutex_lock (thpool->mutex);
 
-		while (
-			thpool->job_queue->queue->size
-			|| thpool->num_threads_working
-		) {
-			(void) pthread_cond_wait (
-				thpool->threads_all_idle, thpool->mutex
-			);
+		if (thpool->work_stealing) {
+			while (__atomic_load_n (&thpool->num_jobs_pending, __ATOMIC_ACQUIRE)) {
+				(void) pthread_cond_wait (
+					thpool->threads_all_idle, thpool->mutex
+				);
+			}
+		}
+
+		else {
+			while (
+				job_queue_size (thpool->job_queue)
+				|| thpool->num_threads_working
+			) {
+				(void) pthread_cond_wait (
+					thpool->threads_all_idle, thpool->mutex
+				);
+			}
 		}
 
 		(void) pthread_mutex_unlock (thpool->mutex);
@@ -365,6 +860,30 @@ void thpool_wait (Thpool *thpool) {
 
 }
 
+// copies the stats of the thread with the matching id
+// returns 0 on success, 1 on error
+unsigned int thpool_get_thread_stats (
+	const Thpool *thpool, const unsigned int thread_id,
+	ThpoolThreadStats *stats
+) {
+
+	unsigned int retval = 1;
+
+	if (thpool && stats && (thread_id < thpool->n_threads)) {
+		const PoolThread *thread = thpool->threads[thread_id];
+		if (thread) {
+			stats->executed = __atomic_load_n (&thread->stats.executed, __ATOMIC_RELAXED);
+			stats->stolen = __atomic_load_n (&thread->stats.stolen, __ATOMIC_RELAXED);
+			stats->idle_time = __atomic_load_n (&thread->stats.idle_time, __ATOMIC_RELAXED);
+
+			retval = 0;
+		}
+	}
+
+	return retval;
+
+}
+
 // destroys the thpool and deletes all of its data
 void thpool_destroy (Thpool *thpool) {
 
@@ -372,22 +891,28 @@ void thpool_destroy (Thpool *thpool) {
 		// end each thread's infinite loop
 		thpool->keep_alive = false;
 
-		// give one second to kill idle threads
-		double timeout = 1.0;
-		time_t start, end;
-		double tpassed = 0.0;
-		(void) time (&start);
-		while ((tpassed < timeout) && thpool->num_threads_alive){
-			bsem_post_all (thpool->job_queue->has_jobs);
-			(void) time (&end);
-			tpassed = difftime (end,start);
-		}
+		// keep waking up the idle threads until all of them have ended
+		struct timespec timeout = { 0 };
+		(void) pthread_mutex_lock (thpool->mutex);
+		while (thpool->num_threads_alive) {
+			(void) pthread_mutex_unlock (thpool->mutex);
+			job_queue_signal_all (thpool->job_queue);
+			(void) pthread_mutex_lock (thpool->mutex);
+
+			if (thpool->num_threads_alive) {
+				(void) clock_gettime (CLOCK_REALTIME, &timeout);
+				timeout.tv_nsec += THPOOL_DESTROY_WAIT_NS;
+				if (timeout.tv_nsec >= 1000000000) {
+					timeout.tv_sec += 1;
+					timeout.tv_nsec -= 1000000000;
+				}
 
-		// poll remaining threads
-		while (thpool->num_threads_alive){
-			bsem_post_all (thpool->job_queue->has_jobs);
-			(void) sleep (1);
+				(void) pthread_cond_timedwait (
+					thpool->threads_alive, thpool->mutex, &timeout
+				);
+			}
 		}
+		(void) pthread_mutex_unlock (thpool->mutex);
 
 		thpool_delete (thpool);
 	}
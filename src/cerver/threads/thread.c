@@ -1,10 +1,14 @@
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 
 #include <stdarg.h>
 
 #include <errno.h>
+#include <dirent.h>
 #include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
 
 #include <sys/prctl.h>
 
@@ -76,6 +80,271 @@ unsigned int thread_set_name (const char *name, ...) {
 
 #pragma endregion
 
+#pragma region affinity
+
+// the cpus the process can run in, ordered for each affinity type
+typedef struct ThreadTopology {
+
+	unsigned int n_cpus;
+	int nodes[THREAD_AFFINITY_MAX_CPUS];
+
+	int compact[THREAD_AFFINITY_MAX_CPUS];
+	int spread[THREAD_AFFINITY_MAX_CPUS];
+
+} ThreadTopology;
+
+static ThreadTopology thread_topology = { 0 };
+static pthread_once_t thread_topology_once = PTHREAD_ONCE_INIT;
+
+const char *thread_affinity_type_to_string (
+	const ThreadAffinityType type
+) {
+
+	switch (type) {
+		#define XX(num, name, string, description) case THREAD_AFFINITY_##name: return #string;
+		THREAD_AFFINITY_MAP(XX)
+		#undef XX
+	}
+
+	return thread_affinity_type_to_string (THREAD_AFFINITY_NONE);
+
+}
+
+const char *thread_affinity_type_description (
+	const ThreadAffinityType type
+) {
+
+	switch (type) {
+		#define XX(num, name, string, description) case THREAD_AFFINITY_##name: return #description;
+		THREAD_AFFINITY_MAP(XX)
+		#undef XX
+	}
+
+	return thread_affinity_type_description (THREAD_AFFINITY_NONE);
+
+}
+
+// sets the affinity type & clears its cpus & offset
+void thread_affinity_init (
+	ThreadAffinity *affinity, const ThreadAffinityType type
+) {
+
+	if (affinity) {
+		affinity->type = type;
+		CPU_ZERO (&affinity->cpus);
+		affinity->offset = 0;
+	}
+
+}
+
+// adds a cpu to be used with THREAD_AFFINITY_CPUS
+void thread_affinity_add_cpu (
+	ThreadAffinity *affinity, const int cpu
+) {
+
+	if (affinity && (cpu >= 0) && (cpu < THREAD_AFFINITY_MAX_CPUS)) {
+		CPU_SET ((size_t) cpu, &affinity->cpus);
+	}
+
+}
+
+// returns the numa node of the cpu, 0 if it can't be found
+int thread_cpu_get_node (const int cpu) {
+
+	int node = 0;
+
+	char path[THREAD_NAME_BUFFER_SIZE] = { 0 };
+	(void) snprintf (
+		path, THREAD_NAME_BUFFER_SIZE - 1,
+		"/sys/devices/system/cpu/cpu%d", cpu
+	);
+
+	// the cpu's directory has a link to its node
+	DIR *dir = opendir (path);
+	if (dir) {
+		struct dirent *entry = NULL;
+		while ((entry = readdir (dir))) {
+			if (
+				!strncmp (entry->d_name, "node", 4)
+				&& (sscanf (entry->d_name + 4, "%d", &node) == 1)
+			) break;
+		}
+
+		(void) closedir (dir);
+	}
+
+	return node;
+
+}
+
+static void thread_topology_init (void) {
+
+	// the main thread's affinity, as other threads might be pinned already
+	cpu_set_t allowed;
+	CPU_ZERO (&allowed);
+	if (sched_getaffinity (getpid (), sizeof (cpu_set_t), &allowed)) {
+		for (int cpu = 0; cpu < (int) sysconf (_SC_NPROCESSORS_ONLN); cpu++)
+			CPU_SET ((size_t) cpu, &allowed);
+	}
+
+	int cpus[THREAD_AFFINITY_MAX_CPUS] = { 0 };
+	unsigned int n_cpus = 0;
+	int max_node = 0;
+	for (int cpu = 0; cpu < THREAD_AFFINITY_MAX_CPUS; cpu++) {
+		if (CPU_ISSET ((size_t) cpu, &allowed)) {
+			cpus[n_cpus] = cpu;
+			thread_topology.nodes[n_cpus] = thread_cpu_get_node (cpu);
+			if (thread_topology.nodes[n_cpus] > max_node)
+				max_node = thread_topology.nodes[n_cpus];
+
+			n_cpus += 1;
+		}
+	}
+
+	// compact fills a node before moving to the next one
+	unsigned int n_compact = 0;
+	for (int node = 0; node <= max_node; node++) {
+		for (unsigned int idx = 0; idx < n_cpus; idx++) {
+			if (thread_topology.nodes[idx] == node)
+				thread_topology.compact[n_compact++] = cpus[idx];
+		}
+	}
+
+	// spread takes the next cpu of every node in turns
+	unsigned int n_spread = 0;
+	for (unsigned int round = 0; n_spread < n_cpus; round++) {
+		for (int node = 0; node <= max_node; node++) {
+			unsigned int count = 0;
+			for (unsigned int idx = 0; idx < n_cpus; idx++) {
+				if (thread_topology.nodes[idx] == node) {
+					if (count == round) {
+						thread_topology.spread[n_spread++] = cpus[idx];
+						break;
+					}
+
+					count += 1;
+				}
+			}
+		}
+	}
+
+	thread_topology.n_cpus = n_cpus;
+
+}
+
+// returns the cpu that matches the thread idx
+// when using spread or compact affinities, -1 on any other case
+int thread_affinity_get_cpu (
+	const ThreadAffinity *affinity, const unsigned int idx
+) {
+
+	int cpu = -1;
+
+	if (affinity) {
+		(void) pthread_once (&thread_topology_once, thread_topology_init);
+
+		if (thread_topology.n_cpus) {
+			const unsigned int pos = (affinity->offset + idx) % thread_topology.n_cpus;
+
+			switch (affinity->type) {
+				case THREAD_AFFINITY_SPREAD: cpu = thread_topology.spread[pos]; break;
+				case THREAD_AFFINITY_COMPACT: cpu = thread_topology.compact[pos]; break;
+
+				default: break;
+			}
+		}
+	}
+
+	return cpu;
+
+}
+
+// sets in dest an explicit THREAD_AFFINITY_CPUS affinity
+// with the cpu that matches the thread idx in affinity
+// explicit & none affinities are copied as they are
+void thread_affinity_resolve (
+	ThreadAffinity *dest,
+	const ThreadAffinity *affinity, const unsigned int idx
+) {
+
+	if (dest && affinity) {
+		const int cpu = thread_affinity_get_cpu (affinity, idx);
+		if (cpu >= 0) {
+			thread_affinity_init (dest, THREAD_AFFINITY_CPUS);
+			thread_affinity_add_cpu (dest, cpu);
+		}
+
+		else {
+			*dest = *affinity;
+		}
+	}
+
+}
+
+// pins the calling thread using the affinity & logs its placement
+// must be called from the thread before it allocates its own data,
+// so its memory pages are first touched in its numa node
+// returns 0 on success or if there is no affinity, 1 on error
+unsigned int thread_affinity_apply (
+	const ThreadAffinity *affinity, const unsigned int idx,
+	const char *name
+) {
+
+	unsigned int retval = 0;
+
+	if (affinity && (affinity->type != THREAD_AFFINITY_NONE)) {
+		cpu_set_t cpus;
+		CPU_ZERO (&cpus);
+
+		int cpu = thread_affinity_get_cpu (affinity, idx);
+		if (affinity->type == THREAD_AFFINITY_CPUS) {
+			cpus = affinity->cpus;
+
+			// a single explicit cpu is reported like the others
+			if (CPU_COUNT (&cpus) == 1) {
+				for (int i = 0; (i < THREAD_AFFINITY_MAX_CPUS) && (cpu < 0); i++) {
+					if (CPU_ISSET ((size_t) i, &cpus)) cpu = i;
+				}
+			}
+		}
+
+		else if (cpu >= 0) CPU_SET ((size_t) cpu, &cpus);
+
+		retval = 1;
+		if (CPU_COUNT (&cpus) && !pthread_setaffinity_np (
+			pthread_self (), sizeof (cpu_set_t), &cpus
+		)) {
+			if (cpu >= 0) {
+				cerver_log_success (
+					"Thread %s placed in cpu %d (node %d)",
+					name ? name : "-", cpu, thread_cpu_get_node (cpu)
+				);
+			}
+
+			else {
+				cerver_log_success (
+					"Thread %s placed in a set of %d cpus",
+					name ? name : "-", CPU_COUNT (&cpus)
+				);
+			}
+
+			retval = 0;
+		}
+
+		else {
+			cerver_log_warning (
+				"Failed to set thread %s %s affinity!",
+				name ? name : "-", thread_affinity_type_to_string (affinity->type)
+			);
+		}
+	}
+
+	return retval;
+
+}
+
+#pragma endregion
+
 #pragma region mutex
 
 // allocates & initializes a new mutex that should be deleted after use
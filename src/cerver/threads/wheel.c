@@ -0,0 +1,707 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <sys/timerfd.h>
+
+#include "cerver/types/types.h"
+
+#include "cerver/threads/thread.h"
+#include "cerver/threads/wheel.h"
+
+#include "cerver/utils/log.h"
+
+static void *timer_wheel_thread (void *wheel_ptr);
+
+const char *wheel_timer_state_to_string (
+	const WheelTimerState state
+) {
+
+	switch (state) {
+		#define XX(num, name, string) case WHEEL_TIMER_STATE_##name: return #string;
+		WHEEL_TIMER_STATE_MAP(XX)
+		#undef XX
+	}
+
+	return wheel_timer_state_to_string (WHEEL_TIMER_STATE_NONE);
+
+}
+
+#pragma region timer
+
+static WheelTimer *wheel_timer_new (void) {
+
+	WheelTimer *timer = (WheelTimer *) malloc (sizeof (WheelTimer));
+	if (timer) {
+		timer->deadline = 0;
+		timer->interval = 0;
+		timer->expires = 0;
+
+		timer->callback = NULL;
+		timer->args = NULL;
+
+		timer->runs = 0;
+
+		timer->state = WHEEL_TIMER_STATE_NONE;
+		timer->waiting = false;
+
+		timer->level = 0;
+		timer->slot = 0;
+
+		timer->prev = NULL;
+		timer->next = NULL;
+	}
+
+	return timer;
+
+}
+
+static void wheel_timer_delete (void *timer_ptr) {
+
+	if (timer_ptr) free (timer_ptr);
+
+}
+
+#pragma endregion
+
+#pragma region wheel
+
+static u64 timer_wheel_time_ns (void) {
+
+	struct timespec now = { 0 };
+	(void) clock_gettime (CLOCK_MONOTONIC, &now);
+
+	return ((u64) now.tv_sec * 1000000000) + (u64) now.tv_nsec;
+
+}
+
+static TimerWheel *timer_wheel_new (void) {
+
+	TimerWheel *wheel = (TimerWheel *) malloc (sizeof (TimerWheel));
+	if (wheel) {
+		(void) memset (wheel, 0, sizeof (TimerWheel));
+
+		wheel->timer_fd = -1;
+	}
+
+	return wheel;
+
+}
+
+void timer_wheel_delete (void *wheel_ptr) {
+
+	if (wheel_ptr) {
+		TimerWheel *wheel = (TimerWheel *) wheel_ptr;
+
+		timer_wheel_stop (wheel);
+
+		WheelTimer *timer = NULL;
+		for (unsigned int level = 0; level < TIMER_WHEEL_LEVELS; level++) {
+			for (unsigned int slot = 0; slot < TIMER_WHEEL_SLOTS; slot++) {
+				while (wheel->slots[level][slot]) {
+					timer = wheel->slots[level][slot];
+					wheel->slots[level][slot] = timer->next;
+
+					wheel_timer_delete (timer);
+				}
+			}
+		}
+
+		if (wheel->timer_fd >= 0) (void) close (wheel->timer_fd);
+
+		thread_mutex_delete (wheel->mutex);
+		thread_cond_delete (wheel->done);
+
+		free (wheel_ptr);
+	}
+
+}
+
+TimerWheel *timer_wheel_create (void) {
+
+	TimerWheel *wheel = timer_wheel_new ();
+	if (wheel) {
+		wheel->timer_fd = timerfd_create (CLOCK_MONOTONIC, TFD_CLOEXEC);
+		if (wheel->timer_fd >= 0) {
+			wheel->start = timer_wheel_time_ns ();
+
+			wheel->mutex = thread_mutex_new ();
+			wheel->done = thread_cond_new ();
+		}
+
+		else {
+			cerver_log_error (
+				"timer_wheel_create () - timerfd_create () has failed!"
+			);
+
+			timer_wheel_delete (wheel);
+			wheel = NULL;
+		}
+	}
+
+	return wheel;
+
+}
+
+void timer_wheel_set_name (
+	TimerWheel *wheel, const char *name
+) {
+
+	if (wheel && name) {
+		(void) strncpy (wheel->name, name, TIMER_WHEEL_NAME_SIZE - 1);
+		wheel->name_len = (unsigned int) strlen (wheel->name);
+	}
+
+}
+
+void timer_wheel_set_affinity (
+	TimerWheel *wheel, const ThreadAffinity *affinity
+) {
+
+	if (wheel && affinity) wheel->affinity = *affinity;
+
+}
+
+unsigned int timer_wheel_size (TimerWheel *wheel) {
+
+	unsigned int size = 0;
+
+	if (wheel) {
+		(void) pthread_mutex_lock (wheel->mutex);
+
+		size = wheel->n_timers;
+
+		(void) pthread_mutex_unlock (wheel->mutex);
+	}
+
+	return size;
+
+}
+
+#pragma endregion
+
+#pragma region internal
+
+// places the timer in the level that covers its distance
+// from the current tick, so it gets cascaded down
+// into the lower levels as its expire tick gets closer
+static void timer_wheel_place (TimerWheel *wheel, WheelTimer *timer) {
+
+	u64 expires = timer->expires;
+	u64 delta = expires - wheel->current;
+
+	unsigned int level = 0;
+	while (
+		(level < (TIMER_WHEEL_LEVELS - 1))
+		&& (delta >> (TIMER_WHEEL_SLOT_BITS * (level + 1)))
+	) level++;
+
+	// too far away, it will be placed again when the last level turns
+	if (delta >> (TIMER_WHEEL_SLOT_BITS * TIMER_WHEEL_LEVELS)) {
+		expires = wheel->current
+			+ ((u64) 1 << (TIMER_WHEEL_SLOT_BITS * TIMER_WHEEL_LEVELS)) - 1;
+	}
+
+	timer->level = level;
+	timer->slot = (unsigned int) (
+		(expires >> (TIMER_WHEEL_SLOT_BITS * level)) & TIMER_WHEEL_SLOTS_MASK
+	);
+
+	timer->prev = NULL;
+	timer->next = wheel->slots[level][timer->slot];
+	if (timer->next) timer->next->prev = timer;
+	wheel->slots[level][timer->slot] = timer;
+
+	wheel->counts[level] += 1;
+	wheel->n_timers += 1;
+
+	timer->state = WHEEL_TIMER_STATE_WAITING;
+
+}
+
+static void timer_wheel_unlink (TimerWheel *wheel, WheelTimer *timer) {
+
+	if (timer->prev) timer->prev->next = timer->next;
+	else wheel->slots[timer->level][timer->slot] = timer->next;
+
+	if (timer->next) timer->next->prev = timer->prev;
+
+	timer->prev = NULL;
+	timer->next = NULL;
+
+	wheel->counts[timer->level] -= 1;
+	wheel->n_timers -= 1;
+
+}
+
+// converts the timer's deadline into a tick after the current one
+static void timer_wheel_schedule (TimerWheel *wheel, WheelTimer *timer) {
+
+	timer->expires = (timer->deadline > wheel->start) ?
+		((timer->deadline - wheel->start) + TIMER_WHEEL_TICK_NS - 1) / TIMER_WHEEL_TICK_NS : 0;
+
+	if (timer->expires <= wheel->current)
+		timer->expires = wheel->current + 1;
+
+	timer_wheel_place (wheel, timer);
+
+}
+
+// returns the next tick in which a timer expires or a level turns
+// returns 0 if there are no timers in the wheel
+static u64 timer_wheel_next_tick (TimerWheel *wheel) {
+
+	u64 next = 0;
+
+	unsigned int shift = 0;
+	u64 base = 0;
+	u64 tick = 0;
+	for (unsigned int level = 0; level < TIMER_WHEEL_LEVELS; level++) {
+		if (wheel->counts[level]) {
+			shift = TIMER_WHEEL_SLOT_BITS * level;
+			base = wheel->current >> shift;
+
+			for (u64 i = 1; i <= TIMER_WHEEL_SLOTS; i++) {
+				if (wheel->slots[level][(base + i) & TIMER_WHEEL_SLOTS_MASK]) {
+					tick = (base + i) << shift;
+					if (!next || (tick < next)) next = tick;
+
+					break;
+				}
+			}
+		}
+	}
+
+	return next;
+
+}
+
+// arms the timerfd with the absolute time of the next tick
+static void timer_wheel_arm (TimerWheel *wheel) {
+
+	u64 next = timer_wheel_next_tick (wheel);
+	if (next != wheel->armed) {
+		struct itimerspec spec = { 0 };
+		if (next) {
+			u64 deadline = wheel->start + (next * TIMER_WHEEL_TICK_NS);
+			spec.it_value.tv_sec = (time_t) (deadline / 1000000000);
+			spec.it_value.tv_nsec = (long) (deadline % 1000000000);
+		}
+
+		(void) timerfd_settime (wheel->timer_fd, TFD_TIMER_ABSTIME, &spec, NULL);
+
+		wheel->armed = next;
+	}
+
+}
+
+// moves the timers of the levels that turn in the current tick
+// into the lower levels, starting from the highest one
+static void timer_wheel_cascade (TimerWheel *wheel) {
+
+	unsigned int turns = 1;
+	while (
+		(turns < TIMER_WHEEL_LEVELS)
+		&& !(wheel->current & (((u64) 1 << (TIMER_WHEEL_SLOT_BITS * turns)) - 1))
+	) turns++;
+
+	unsigned int slot = 0;
+	WheelTimer *timer = NULL;
+	for (unsigned int level = turns - 1; level > 0; level--) {
+		slot = (unsigned int) (
+			(wheel->current >> (TIMER_WHEEL_SLOT_BITS * level)) & TIMER_WHEEL_SLOTS_MASK
+		);
+
+		while (wheel->slots[level][slot]) {
+			timer = wheel->slots[level][slot];
+			timer_wheel_unlink (wheel, timer);
+			timer_wheel_place (wheel, timer);
+		}
+	}
+
+}
+
+// moves the timers that expire in the current tick
+// to the end of the expired list
+static WheelTimer **timer_wheel_expire (
+	TimerWheel *wheel, WheelTimer **tail
+) {
+
+	unsigned int slot = (unsigned int) (wheel->current & TIMER_WHEEL_SLOTS_MASK);
+
+	WheelTimer *timer = NULL;
+	while (wheel->slots[0][slot]) {
+		timer = wheel->slots[0][slot];
+		timer_wheel_unlink (wheel, timer);
+
+		timer->state = WHEEL_TIMER_STATE_RUNNING;
+
+		*tail = timer;
+		tail = &timer->next;
+	}
+
+	return tail;
+
+}
+
+// handles every tick until now & returns the expired timers
+static WheelTimer *timer_wheel_advance (TimerWheel *wheel, const u64 now) {
+
+	WheelTimer *expired = NULL;
+	WheelTimer **tail = &expired;
+
+	u64 span = 0;
+	unsigned int level = 0;
+	while (wheel->current < now) {
+		if (!wheel->n_timers) {
+			wheel->current = now;
+			break;
+		}
+
+		// jump over the ticks of the empty lower levels
+		level = 0;
+		while ((level < (TIMER_WHEEL_LEVELS - 1)) && !wheel->counts[level]) level++;
+
+		if (level) {
+			span = (u64) 1 << (TIMER_WHEEL_SLOT_BITS * level);
+			if (((wheel->current + span) & ~(span - 1)) > now) {
+				wheel->current = now;
+				break;
+			}
+
+			wheel->current = (wheel->current + span) & ~(span - 1);
+		}
+
+		else {
+			wheel->current += 1;
+		}
+
+		timer_wheel_cascade (wheel);
+		tail = timer_wheel_expire (wheel, tail);
+	}
+
+	return expired;
+
+}
+
+// called after the timer's callback has been executed
+static void timer_wheel_timer_done (TimerWheel *wheel, WheelTimer *timer) {
+
+	if (timer->state == WHEEL_TIMER_STATE_CANCELLED) {
+		if (timer->waiting) {
+			timer->state = WHEEL_TIMER_STATE_NONE;
+			(void) pthread_cond_broadcast (wheel->done);
+		}
+
+		else {
+			wheel_timer_delete (timer);
+		}
+	}
+
+	else if (timer->interval) {
+		timer->deadline += timer->interval;
+
+		// skip the runs that have been missed
+		u64 now = timer_wheel_time_ns ();
+		if (timer->deadline <= now) {
+			timer->deadline += (((now - timer->deadline) / timer->interval) + 1)
+				* timer->interval;
+		}
+
+		timer_wheel_schedule (wheel, timer);
+	}
+
+	else {
+		wheel_timer_delete (timer);
+	}
+
+}
+
+static void timer_wheel_run (TimerWheel *wheel) {
+
+	(void) pthread_mutex_lock (wheel->mutex);
+
+	WheelTimer *expired = timer_wheel_advance (
+		wheel, (timer_wheel_time_ns () - wheel->start) / TIMER_WHEEL_TICK_NS
+	);
+
+	(void) pthread_mutex_unlock (wheel->mutex);
+
+	// the callbacks are executed without the lock
+	// so they are able to add & cancel timers
+	WheelTimer *timer = NULL;
+	bool cancelled = false;
+	while (expired) {
+		timer = expired;
+		expired = timer->next;
+		timer->next = NULL;
+
+		(void) pthread_mutex_lock (wheel->mutex);
+		cancelled = (timer->state == WHEEL_TIMER_STATE_CANCELLED);
+		(void) pthread_mutex_unlock (wheel->mutex);
+
+		if (!cancelled) {
+			timer->callback (timer->args);
+			timer->runs += 1;
+		}
+
+		(void) pthread_mutex_lock (wheel->mutex);
+		timer_wheel_timer_done (wheel, timer);
+		(void) pthread_mutex_unlock (wheel->mutex);
+	}
+
+	(void) pthread_mutex_lock (wheel->mutex);
+	timer_wheel_arm (wheel);
+	(void) pthread_mutex_unlock (wheel->mutex);
+
+}
+
+static void *timer_wheel_thread (void *wheel_ptr) {
+
+	TimerWheel *wheel = (TimerWheel *) wheel_ptr;
+
+	if (wheel->name_len) {
+		(void) thread_set_name ("wheel-%s", wheel->name);
+	}
+
+	(void) thread_affinity_apply (&wheel->affinity, 0, wheel->name);
+
+	u64 expirations = 0;
+	while (__atomic_load_n (&wheel->running, __ATOMIC_ACQUIRE)) {
+		// sleeps until the armed deadline
+		if (read (wheel->timer_fd, &expirations, sizeof (u64)) < 0) {
+			if (errno != EINTR) {
+				cerver_log_error (
+					"timer_wheel_thread () - failed to read wheel %s timerfd!",
+					wheel->name
+				);
+
+				break;
+			}
+
+			continue;
+		}
+
+		if (__atomic_load_n (&wheel->running, __ATOMIC_ACQUIRE)) {
+			timer_wheel_run (wheel);
+		}
+	}
+
+	return NULL;
+
+}
+
+#pragma endregion
+
+#pragma region public
+
+unsigned int timer_wheel_start (TimerWheel *wheel) {
+
+	unsigned int retval = 1;
+
+	if (wheel && !wheel->running && !wheel->attached) {
+		__atomic_store_n (&wheel->running, true, __ATOMIC_RELEASE);
+
+		if (!pthread_create (
+			&wheel->thread_id, NULL, timer_wheel_thread, wheel
+		)) {
+			// the timers might have been added before the start
+			(void) pthread_mutex_lock (wheel->mutex);
+			wheel->armed = 0;
+			timer_wheel_arm (wheel);
+			(void) pthread_mutex_unlock (wheel->mutex);
+
+			retval = 0;
+		}
+
+		else {
+			cerver_log_error (
+				"Failed to create timer wheel %s thread!", wheel->name
+			);
+
+			__atomic_store_n (&wheel->running, false, __ATOMIC_RELEASE);
+		}
+	}
+
+	return retval;
+
+}
+
+int timer_wheel_attach (TimerWheel *wheel) {
+
+	int retval = -1;
+
+	if (wheel && !wheel->running) {
+		// the loop might read the timerfd after it has been armed again
+		int flags = fcntl (wheel->timer_fd, F_GETFL, 0);
+		if ((flags >= 0) && !fcntl (wheel->timer_fd, F_SETFL, flags | O_NONBLOCK)) {
+			(void) pthread_mutex_lock (wheel->mutex);
+
+			wheel->thread_id = pthread_self ();
+			wheel->attached = true;
+			__atomic_store_n (&wheel->running, true, __ATOMIC_RELEASE);
+
+			// the timers might have been added before
+			wheel->armed = 0;
+			timer_wheel_arm (wheel);
+
+			(void) pthread_mutex_unlock (wheel->mutex);
+
+			retval = wheel->timer_fd;
+		}
+
+		else {
+			cerver_log_error (
+				"Failed to attach timer wheel %s!", wheel->name
+			);
+		}
+	}
+
+	return retval;
+
+}
+
+void timer_wheel_handle (TimerWheel *wheel) {
+
+	if (wheel) {
+		(void) pthread_mutex_lock (wheel->mutex);
+
+		if (wheel->running) {
+			wheel->thread_id = pthread_self ();
+			wheel->handling = true;
+		}
+
+		const bool handling = wheel->handling;
+
+		(void) pthread_mutex_unlock (wheel->mutex);
+
+		if (handling) {
+			u64 expirations = 0;
+			if (read (wheel->timer_fd, &expirations, sizeof (u64)) < 0) {
+				// armed again after the loop found it readable
+				// the expired timers are still handled
+			}
+
+			timer_wheel_run (wheel);
+
+			(void) pthread_mutex_lock (wheel->mutex);
+			wheel->handling = false;
+			(void) pthread_cond_broadcast (wheel->done);
+			(void) pthread_mutex_unlock (wheel->mutex);
+		}
+	}
+
+}
+
+void timer_wheel_stop (TimerWheel *wheel) {
+
+	if (wheel && wheel->attached) {
+		__atomic_store_n (&wheel->running, false, __ATOMIC_RELEASE);
+
+		(void) pthread_mutex_lock (wheel->mutex);
+
+		// waits for the loop to end executing the expired timers
+		if (!pthread_equal (pthread_self (), wheel->thread_id)) {
+			while (wheel->handling) {
+				(void) pthread_cond_wait (wheel->done, wheel->mutex);
+			}
+		}
+
+		wheel->attached = false;
+		wheel->thread_id = 0;
+
+		(void) pthread_mutex_unlock (wheel->mutex);
+	}
+
+	else if (wheel && wheel->running) {
+		__atomic_store_n (&wheel->running, false, __ATOMIC_RELEASE);
+
+		// wakes up the thread right away
+		(void) pthread_mutex_lock (wheel->mutex);
+
+		struct itimerspec spec = { 0 };
+		spec.it_value.tv_nsec = 1;
+		(void) timerfd_settime (wheel->timer_fd, 0, &spec, NULL);
+		wheel->armed = 0;
+
+		(void) pthread_mutex_unlock (wheel->mutex);
+
+		(void) pthread_join (wheel->thread_id, NULL);
+		wheel->thread_id = 0;
+	}
+
+}
+
+WheelTimer *timer_wheel_add (
+	TimerWheel *wheel,
+	const u64 delay, const u64 interval,
+	Action callback, void *args
+) {
+
+	WheelTimer *timer = NULL;
+
+	if (wheel && callback) {
+		timer = wheel_timer_new ();
+		if (timer) {
+			timer->deadline = timer_wheel_time_ns () + delay;
+			timer->interval = interval;
+
+			timer->callback = callback;
+			timer->args = args;
+
+			(void) pthread_mutex_lock (wheel->mutex);
+
+			timer_wheel_schedule (wheel, timer);
+
+			if (wheel->running) timer_wheel_arm (wheel);
+
+			(void) pthread_mutex_unlock (wheel->mutex);
+		}
+	}
+
+	return timer;
+
+}
+
+void timer_wheel_cancel (
+	TimerWheel *wheel, WheelTimer *timer
+) {
+
+	if (wheel && timer) {
+		(void) pthread_mutex_lock (wheel->mutex);
+
+		switch (timer->state) {
+			case WHEEL_TIMER_STATE_WAITING: {
+				timer_wheel_unlink (wheel, timer);
+				wheel_timer_delete (timer);
+			} break;
+
+			case WHEEL_TIMER_STATE_RUNNING: {
+				timer->state = WHEEL_TIMER_STATE_CANCELLED;
+
+				// the wheel's thread deletes the timer when it is done
+				if (!pthread_equal (pthread_self (), wheel->thread_id)) {
+					timer->waiting = true;
+					while (timer->state == WHEEL_TIMER_STATE_CANCELLED) {
+						(void) pthread_cond_wait (wheel->done, wheel->mutex);
+					}
+
+					wheel_timer_delete (timer);
+				}
+			} break;
+
+			default: break;
+		}
+
+		(void) pthread_mutex_unlock (wheel->mutex);
+	}
+
+}
+
+#pragma endregion
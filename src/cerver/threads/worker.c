@@ -50,6 +50,8 @@ static Worker *worker_new (void) {
 		worker->reference = NULL;
 		worker->remove_reference = NULL;
 
+		thread_affinity_init (&worker->affinity, THREAD_AFFINITY_NONE);
+
 		(void) memset (&worker->mutex, 0, sizeof (pthread_mutex_t));
 	}
 
@@ -104,6 +106,16 @@ void worker_set_name (Worker *worker, const char *name) {
 
 }
 
+// sets the cpus where the worker's thread will run
+// the worker's id is used as its idx for spread & compact affinities
+void worker_set_affinity (
+	Worker *worker, const ThreadAffinity *affinity
+) {
+
+	if (worker && affinity) worker->affinity = *affinity;
+
+}
+
 WorkerState worker_get_state (Worker *worker) {
 
 	WorkerState state = WORKER_STATE_NONE;
@@ -283,7 +295,7 @@ static unsigned int worker_resume_internal (Worker *worker) {
 			worker_set_state (worker, WORKER_STATE_AVAILABLE);
 
 			// signal worker's job queue
-			bsem_post (worker->job_queue->has_jobs);
+			job_queue_signal (worker->job_queue);
 
 			retval = 0;
 		} break;
@@ -328,7 +340,7 @@ static unsigned int worker_stop_internal (Worker *worker) {
 		switch (state) {
 			case WORKER_STATE_AVAILABLE:
 			case WORKER_STATE_WORKING: {
-				bsem_post (worker->job_queue->has_jobs);
+				job_queue_signal (worker->job_queue);
 
 				retval = 0;
 			} break;
@@ -382,7 +394,7 @@ static unsigned int worker_end_internal (Worker *worker) {
 			case WORKER_STATE_AVAILABLE:
 			case WORKER_STATE_WORKING:
 			case WORKER_STATE_STOPPED: {
-				bsem_post (worker->job_queue->has_jobs);
+				job_queue_signal (worker->job_queue);
 
 				retval = 0;
 			} break;
@@ -451,6 +463,8 @@ static void *worker_thread (void *worker_ptr) {
 
 	(void) thread_set_name (worker->name);
 
+	(void) thread_affinity_apply (&worker->affinity, worker->id, worker->name);
+
 	#ifdef THREADS_DEBUG
 	cerver_log_debug (
 		"Worker <%s> state: %s",
@@ -463,7 +477,7 @@ static void *worker_thread (void *worker_ptr) {
 	WorkerState state = WORKER_STATE_NONE;
 	while (state != WORKER_STATE_ENDED) {
 		// wait for work or signal
-		bsem_wait (worker->job_queue->has_jobs);
+		job_queue_wait (worker->job_queue);
 
 		// check if we are still required to do work
 		state = worker_get_state (worker);
@@ -0,0 +1,458 @@
+#include "cerver/types/types.h"
+
+#include "cerver/uring.h"
+
+#ifdef CERVER_IO_URING
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <errno.h>
+
+#include <unistd.h>
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+#include <linux/time_types.h>
+
+static inline int uring_setup_syscall (
+	unsigned int entries, struct io_uring_params *params
+) {
+
+	return (int) syscall (__NR_io_uring_setup, entries, params);
+
+}
+
+static inline int uring_enter_syscall (
+	int ring_fd, unsigned int to_submit, unsigned int min_complete,
+	unsigned int flags, void *arg, size_t arg_size
+) {
+
+	return (int) syscall (
+		__NR_io_uring_enter,
+		ring_fd, to_submit, min_complete, flags, arg, arg_size
+	);
+
+}
+
+static inline int uring_register_syscall (
+	int ring_fd, unsigned int opcode, void *arg, unsigned int n_args
+) {
+
+	return (int) syscall (
+		__NR_io_uring_register, ring_fd, opcode, arg, n_args
+	);
+
+}
+
+static Uring *uring_new (void) {
+
+	Uring *uring = (Uring *) malloc (sizeof (Uring));
+	if (uring) {
+		(void) memset (uring, 0, sizeof (Uring));
+
+		uring->ring_fd = -1;
+	}
+
+	return uring;
+
+}
+
+void uring_delete (void *uring_ptr) {
+
+	if (uring_ptr) {
+		Uring *uring = (Uring *) uring_ptr;
+
+		if (uring->sq.sqes) {
+			(void) munmap (uring->sq.sqes, uring->sq.sqes_size);
+		}
+
+		if (uring->cq.ring_ptr && (uring->cq.ring_ptr != uring->sq.ring_ptr)) {
+			(void) munmap (uring->cq.ring_ptr, uring->cq.ring_size);
+		}
+
+		if (uring->sq.ring_ptr) {
+			(void) munmap (uring->sq.ring_ptr, uring->sq.ring_size);
+		}
+
+		if (uring->ring_fd >= 0) (void) close (uring->ring_fd);
+
+		free (uring);
+	}
+
+}
+
+static u8 uring_map_rings (Uring *uring, const struct io_uring_params *params) {
+
+	UringSq *sq = &uring->sq;
+	UringCq *cq = &uring->cq;
+
+	sq->ring_size = params->sq_off.array + params->sq_entries * sizeof (unsigned int);
+	cq->ring_size = params->cq_off.cqes + params->cq_entries * sizeof (struct io_uring_cqe);
+
+	// both rings can be mapped with a single mmap ()
+	if (params->features & IORING_FEAT_SINGLE_MMAP) {
+		if (cq->ring_size > sq->ring_size) sq->ring_size = cq->ring_size;
+		cq->ring_size = sq->ring_size;
+	}
+
+	sq->ring_ptr = mmap (
+		NULL, sq->ring_size, PROT_READ | PROT_WRITE,
+		MAP_SHARED | MAP_POPULATE, uring->ring_fd, IORING_OFF_SQ_RING
+	);
+
+	if (sq->ring_ptr == MAP_FAILED) {
+		sq->ring_ptr = NULL;
+		return 1;
+	}
+
+	if (params->features & IORING_FEAT_SINGLE_MMAP) {
+		cq->ring_ptr = sq->ring_ptr;
+	}
+
+	else {
+		cq->ring_ptr = mmap (
+			NULL, cq->ring_size, PROT_READ | PROT_WRITE,
+			MAP_SHARED | MAP_POPULATE, uring->ring_fd, IORING_OFF_CQ_RING
+		);
+
+		if (cq->ring_ptr == MAP_FAILED) {
+			cq->ring_ptr = NULL;
+			return 1;
+		}
+	}
+
+	sq->sqes_size = params->sq_entries * sizeof (struct io_uring_sqe);
+	sq->sqes = (struct io_uring_sqe *) mmap (
+		NULL, sq->sqes_size, PROT_READ | PROT_WRITE,
+		MAP_SHARED | MAP_POPULATE, uring->ring_fd, IORING_OFF_SQES
+	);
+
+	if (sq->sqes == MAP_FAILED) {
+		sq->sqes = NULL;
+		return 1;
+	}
+
+	char *sq_ptr = (char *) sq->ring_ptr;
+	sq->khead = (unsigned int *) (sq_ptr + params->sq_off.head);
+	sq->ktail = (unsigned int *) (sq_ptr + params->sq_off.tail);
+	sq->kflags = (unsigned int *) (sq_ptr + params->sq_off.flags);
+	sq->array = (unsigned int *) (sq_ptr + params->sq_off.array);
+	sq->mask = *(unsigned int *) (sq_ptr + params->sq_off.ring_mask);
+	sq->entries = *(unsigned int *) (sq_ptr + params->sq_off.ring_entries);
+	sq->sqe_tail = *sq->ktail;
+
+	// every sqe is always placed in its own slot
+	for (unsigned int idx = 0; idx < sq->entries; idx++) {
+		sq->array[idx] = idx;
+	}
+
+	char *cq_ptr = (char *) cq->ring_ptr;
+	cq->khead = (unsigned int *) (cq_ptr + params->cq_off.head);
+	cq->ktail = (unsigned int *) (cq_ptr + params->cq_off.tail);
+	cq->mask = *(unsigned int *) (cq_ptr + params->cq_off.ring_mask);
+	cq->entries = *(unsigned int *) (cq_ptr + params->cq_off.ring_entries);
+	cq->cqes = (struct io_uring_cqe *) (cq_ptr + params->cq_off.cqes);
+
+	return 0;
+
+}
+
+// creates a new io_uring instance with at least entries sqes
+// and with cq_entries cqes (0 to use the kernel's default)
+// returns a new uring on success, NULL on error
+Uring *uring_create (
+	const unsigned int entries, const unsigned int cq_entries
+) {
+
+	Uring *uring = uring_new ();
+	if (uring) {
+		struct io_uring_params params = { 0 };
+		if (cq_entries) {
+			params.flags |= IORING_SETUP_CQSIZE;
+			params.cq_entries = cq_entries;
+		}
+
+		uring->ring_fd = uring_setup_syscall (entries, &params);
+		if (uring->ring_fd >= 0) {
+			uring->features = params.features;
+
+			if (uring_map_rings (uring, &params)) {
+				uring_delete (uring);
+				uring = NULL;
+			}
+		}
+
+		else {
+			uring_delete (uring);
+			uring = NULL;
+		}
+	}
+
+	return uring;
+
+}
+
+// returns true if the kernel supports every one of the ops
+bool uring_probe_ops (
+	const Uring *uring, const u8 *ops, const unsigned int n_ops
+) {
+
+	bool retval = false;
+
+	const size_t probe_size = sizeof (struct io_uring_probe)
+		+ (256 * sizeof (struct io_uring_probe_op));
+
+	struct io_uring_probe *probe = (struct io_uring_probe *) calloc (1, probe_size);
+	if (probe) {
+		if (!uring_register_syscall (
+			uring->ring_fd, IORING_REGISTER_PROBE, probe, 256
+		)) {
+			retval = true;
+			for (unsigned int idx = 0; idx < n_ops; idx++) {
+				if (
+					(ops[idx] > probe->last_op)
+					|| !(probe->ops[ops[idx]].flags & IO_URING_OP_SUPPORTED)
+				) {
+					retval = false;
+					break;
+				}
+			}
+		}
+
+		free (probe);
+	}
+
+	return retval;
+
+}
+
+// returns the next free sqe cleared to zero
+// returns NULL if the submission queue is full
+struct io_uring_sqe *uring_get_sqe (Uring *uring) {
+
+	struct io_uring_sqe *sqe = NULL;
+
+	UringSq *sq = &uring->sq;
+	const unsigned int head = __atomic_load_n (sq->khead, __ATOMIC_ACQUIRE);
+	if ((sq->sqe_tail - head) < sq->entries) {
+		sqe = &sq->sqes[sq->sqe_tail & sq->mask];
+		(void) memset (sqe, 0, sizeof (struct io_uring_sqe));
+
+		sq->sqe_tail += 1;
+	}
+
+	return sqe;
+
+}
+
+// publishes the prepared sqes so that the kernel can read them
+// returns the number of sqes that are waiting to be submitted
+static inline unsigned int uring_flush_sq (Uring *uring) {
+
+	UringSq *sq = &uring->sq;
+	__atomic_store_n (sq->ktail, sq->sqe_tail, __ATOMIC_RELEASE);
+
+	return sq->sqe_tail - __atomic_load_n (sq->khead, __ATOMIC_ACQUIRE);
+
+}
+
+// makes the prepared sqes visible to the kernel & submits them
+// returns the number of submitted sqes, -errno on error
+int uring_submit (Uring *uring) {
+
+	int retval = 0;
+
+	const unsigned int to_submit = uring_flush_sq (uring);
+	if (to_submit) {
+		retval = uring_enter_syscall (
+			uring->ring_fd, to_submit, 0, 0, NULL, 0
+		);
+
+		if (retval < 0) retval = -errno;
+	}
+
+	return retval;
+
+}
+
+// waits until wait_nr cqes are available
+// or until timeout_ms have passed (-1 to wait forever)
+// it doesn't submit any sqe, so it can be called
+// while other threads are preparing new ones
+// returns 0 on success, -errno on error (-ETIME on timeout)
+int uring_wait (
+	Uring *uring, const unsigned int wait_nr, const int timeout_ms
+) {
+
+	unsigned int flags = IORING_ENTER_GETEVENTS;
+
+	struct __kernel_timespec ts = { 0 };
+	struct io_uring_getevents_arg arg = { 0 };
+	void *arg_ptr = NULL;
+	size_t arg_size = 0;
+
+	if (timeout_ms >= 0) {
+		ts.tv_sec = timeout_ms / 1000;
+		ts.tv_nsec = (long long) (timeout_ms % 1000) * 1000000;
+
+		arg.ts = (u64) (uintptr_t) &ts;
+
+		flags |= IORING_ENTER_EXT_ARG;
+		arg_ptr = &arg;
+		arg_size = sizeof (struct io_uring_getevents_arg);
+	}
+
+	int retval = uring_enter_syscall (
+		uring->ring_fd, 0, wait_nr, flags, arg_ptr, arg_size
+	);
+
+	return (retval < 0) ? -errno : 0;
+
+}
+
+// returns the next available cqe, NULL if there are none
+struct io_uring_cqe *uring_peek_cqe (Uring *uring) {
+
+	struct io_uring_cqe *cqe = NULL;
+
+	UringCq *cq = &uring->cq;
+	const unsigned int head = *cq->khead;
+	if (head != __atomic_load_n (cq->ktail, __ATOMIC_ACQUIRE)) {
+		cqe = &cq->cqes[head & cq->mask];
+	}
+
+	return cqe;
+
+}
+
+// marks the last peeked cqe as consumed
+void uring_cqe_seen (Uring *uring) {
+
+	__atomic_store_n (uring->cq.khead, *uring->cq.khead + 1, __ATOMIC_RELEASE);
+
+}
+
+static UringBufRing *uring_buf_ring_new (void) {
+
+	UringBufRing *buf_ring = (UringBufRing *) malloc (sizeof (UringBufRing));
+	if (buf_ring) {
+		(void) memset (buf_ring, 0, sizeof (UringBufRing));
+	}
+
+	return buf_ring;
+
+}
+
+static void uring_buf_ring_free (UringBufRing *buf_ring) {
+
+	if (buf_ring->ring) (void) munmap (buf_ring->ring, buf_ring->ring_size);
+	if (buf_ring->buffers) free (buf_ring->buffers);
+
+	free (buf_ring);
+
+}
+
+// creates n_buffers (rounded up to a power of two) of buffer_size bytes
+// & registers them in the uring as the group bgid
+// returns a new buffers ring on success, NULL on error
+UringBufRing *uring_buf_ring_create (
+	Uring *uring, const u16 bgid,
+	const unsigned int n_buffers, const size_t buffer_size
+) {
+
+	UringBufRing *buf_ring = uring_buf_ring_new ();
+	if (buf_ring) {
+		unsigned int entries = 1;
+		while ((entries < n_buffers) && (entries < 32768)) entries <<= 1;
+
+		buf_ring->bgid = bgid;
+		buf_ring->mask = (u16) (entries - 1);
+		buf_ring->n_buffers = entries;
+		buf_ring->buffer_size = buffer_size;
+
+		buf_ring->ring_size = entries * sizeof (struct io_uring_buf);
+		void *ring = mmap (
+			NULL, buf_ring->ring_size, PROT_READ | PROT_WRITE,
+			MAP_ANONYMOUS | MAP_PRIVATE, -1, 0
+		);
+
+		buf_ring->ring = (ring != MAP_FAILED) ? (struct io_uring_buf_ring *) ring : NULL;
+		buf_ring->buffers = (char *) malloc (entries * buffer_size);
+
+		if (buf_ring->ring && buf_ring->buffers) {
+			struct io_uring_buf_reg reg = { 0 };
+			reg.ring_addr = (u64) (uintptr_t) buf_ring->ring;
+			reg.ring_entries = entries;
+			reg.bgid = bgid;
+
+			if (!uring_register_syscall (
+				uring->ring_fd, IORING_REGISTER_PBUF_RING, &reg, 1
+			)) {
+				for (unsigned int bid = 0; bid < entries; bid++) {
+					uring_buf_ring_recycle (buf_ring, (u16) bid);
+				}
+			}
+
+			else {
+				uring_buf_ring_free (buf_ring);
+				buf_ring = NULL;
+			}
+		}
+
+		else {
+			uring_buf_ring_free (buf_ring);
+			buf_ring = NULL;
+		}
+	}
+
+	return buf_ring;
+
+}
+
+// unregisters the buffers ring from the uring & deletes it
+void uring_buf_ring_delete (
+	Uring *uring, UringBufRing *buf_ring
+) {
+
+	if (buf_ring) {
+		if (uring) {
+			struct io_uring_buf_reg reg = { 0 };
+			reg.bgid = buf_ring->bgid;
+
+			(void) uring_register_syscall (
+				uring->ring_fd, IORING_UNREGISTER_PBUF_RING, &reg, 1
+			);
+		}
+
+		uring_buf_ring_free (buf_ring);
+	}
+
+}
+
+// returns the buffer that matches the id
+char *uring_buf_ring_get (
+	const UringBufRing *buf_ring, const u16 bid
+) {
+
+	return buf_ring->buffers + ((size_t) bid * buf_ring->buffer_size);
+
+}
+
+// gives the buffer back to the kernel so it can be selected again
+void uring_buf_ring_recycle (
+	UringBufRing *buf_ring, const u16 bid
+) {
+
+	struct io_uring_buf *buf = &buf_ring->ring->bufs[buf_ring->tail & buf_ring->mask];
+	buf->addr = (u64) (uintptr_t) uring_buf_ring_get (buf_ring, bid);
+	buf->len = (u32) buf_ring->buffer_size;
+	buf->bid = bid;
+
+	buf_ring->tail += 1;
+	__atomic_store_n (&buf_ring->ring->tail, buf_ring->tail, __ATOMIC_RELEASE);
+
+}
+
+#endif
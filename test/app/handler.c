@@ -2,6 +2,7 @@
 #include <stdio.h>
 #include <string.h>
 
+#include <cerver/handler.h>
 #include <cerver/packets.h>
 
 #include <cerver/utils/log.h>
@@ -150,4 +151,12 @@ void app_handler (void *packet_ptr) {
 		}
 	}
 
-}
\ No newline at end of file
+}
+
+void app_queued_handler (void *handler_data_ptr) {
+
+	if (handler_data_ptr) {
+		app_handler (((HandlerData *) handler_data_ptr)->packet);
+	}
+
+}
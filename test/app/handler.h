@@ -3,4 +3,8 @@
 
 extern void app_handler (void *packet_ptr);
 
+// used by handlers that are not direct handle
+// as they pass a HandlerData instead of the packet
+extern void app_queued_handler (void *handler_data_ptr);
+
 #endif
\ No newline at end of file
@@ -4,8 +4,26 @@
 #include <stdbool.h>
 
 #include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+
+#include <sys/socket.h>
+#include <sys/time.h>
+
+#include <cerver/collections/dlist.h>
 
 #include <cerver/cerver.h>
+#include <cerver/client.h>
+#include <cerver/connection.h>
+#include <cerver/events.h>
+#include <cerver/fdtable.h>
+#include <cerver/handler.h>
+#include <cerver/packets.h>
+#include <cerver/registry.h>
+#include <cerver/socket.h>
 
 #include "../test.h"
 
@@ -43,6 +61,13 @@ static void test_cerver_base_configuration (void) {
 	cerver_set_receive_buffer_size (cerver, 4096);
 	test_check_int_eq (cerver->receive_buffer_size, 4096, NULL);
 
+	test_check_unsigned_eq (cerver->receive_budget_bytes, CERVER_DEFAULT_RECEIVE_BUDGET_BYTES, NULL);
+	test_check_unsigned_eq (cerver->receive_budget_packets, CERVER_DEFAULT_RECEIVE_BUDGET_PACKETS, NULL);
+
+	cerver_set_receive_budget (cerver, 16384, 32);
+	test_check_unsigned_eq (cerver->receive_budget_bytes, 16384, NULL);
+	test_check_unsigned_eq (cerver->receive_budget_packets, 32, NULL);
+
 	cerver_set_thpool_n_threads (cerver, 4);
 	test_check_int_eq (cerver->n_thpool_threads, 4, NULL);
 
@@ -55,10 +80,402 @@ static void test_cerver_base_configuration (void) {
 	cerver_set_poll_time_out (cerver, 2000);
 	test_check_int_eq (cerver->poll_timeout, 2000, NULL);
 
+	test_check_int_eq (cerver->handler_dispatch, CERVER_HANDLER_DISPATCH_ID, NULL);
+
+	test_check_int_eq (cerver_set_multiple_handlers (cerver, 4), 0, NULL);
+	test_check_bool_eq (cerver->multiple_handlers, true, NULL);
+	test_check_unsigned_eq (cerver->n_handlers, 4, NULL);
+
+	cerver_set_handler_dispatch_policy (cerver, CERVER_HANDLER_DISPATCH_CONNECTION);
+	test_check_int_eq (cerver->handler_dispatch, CERVER_HANDLER_DISPATCH_CONNECTION, NULL);
+	test_check_str_eq (
+		cerver_handler_dispatch_to_string (cerver->handler_dispatch), "Connection", NULL
+	);
+
 	cerver_delete (cerver);
 
 }
 
+#define TEST_UDP_PORT		7101
+
+static unsigned int update_count = 0;
+static bool update_args_deleted = false;
+
+static void test_cerver_update (void *cerver_update_ptr) {
+
+	CerverUpdate *cu = (CerverUpdate *) cerver_update_ptr;
+
+	(void) __atomic_add_fetch ((unsigned int *) cu->args, 1, __ATOMIC_RELAXED);
+
+}
+
+static void test_cerver_update_delete (void *args) {
+
+	update_args_deleted = (args == &update_count);
+
+}
+
+static void *test_cerver_udp_start (void *cerver_ptr) {
+
+	(void) cerver_start ((Cerver *) cerver_ptr);
+
+	return NULL;
+
+}
+
+static void test_cerver_udp (void) {
+
+	Cerver *cerver = cerver_create (
+		CERVER_TYPE_CUSTOM,
+		cerver_name,
+		TEST_UDP_PORT,
+		PROTOCOL_UDP,
+		false,
+		CERVER_DEFAULT_CONNECTION_QUEUE
+	);
+
+	test_check_ptr (cerver);
+	test_check_int_eq (cerver->protocol, PROTOCOL_UDP, NULL);
+	test_check_unsigned_eq (cerver->udp_batch_size, CERVER_DEFAULT_UDP_BATCH_SIZE, NULL);
+	test_check_unsigned_eq (cerver->udp_peer_timeout, CERVER_DEFAULT_UDP_PEER_TIMEOUT, NULL);
+
+	cerver_set_udp_options (cerver, 8, 30);
+	test_check_unsigned_eq (cerver->udp_batch_size, 8, NULL);
+	test_check_unsigned_eq (cerver->udp_peer_timeout, 30, NULL);
+
+	test_check_unsigned_eq (cerver->udp_max_peers, CERVER_DEFAULT_UDP_MAX_PEERS, NULL);
+	cerver_set_udp_max_peers (cerver, 1);
+	test_check_unsigned_eq (cerver->udp_max_peers, 1, NULL);
+
+	cerver_set_thpool_n_threads (cerver, 0);
+	cerver_set_reusable_address_flags (cerver, true);
+	cerver_set_poll_time_out (cerver, 100);
+
+	// the update is executed by the cerver's timers
+	cerver_set_update (
+		cerver,
+		test_cerver_update, &update_count, test_cerver_update_delete,
+		100
+	);
+
+	pthread_t thread_id = 0;
+	test_check_int_eq (pthread_create (&thread_id, NULL, test_cerver_udp_start, cerver), 0, NULL);
+
+	int sock = socket (AF_INET, SOCK_DGRAM, 0);
+	test_check_bool_eq ((sock >= 0), true, NULL);
+
+	struct timeval timeout = { .tv_sec = 1, .tv_usec = 0 };
+	(void) setsockopt (sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof (struct timeval));
+
+	struct sockaddr_in address = { 0 };
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl (INADDR_LOOPBACK);
+	address.sin_port = htons (TEST_UDP_PORT);
+
+	Packet *ping = packet_generate_request (PACKET_TYPE_TEST, 0, NULL, 0);
+	test_check_ptr (ping);
+
+	// two test packets in the same datagram are handled together
+	char datagram[2 * sizeof (PacketHeader)] = { 0 };
+	(void) memcpy (datagram, ping->packet, sizeof (PacketHeader));
+	(void) memcpy (datagram + sizeof (PacketHeader), ping->packet, sizeof (PacketHeader));
+
+	// the cerver may not be ready yet
+	PacketHeader response = { 0 };
+	ssize_t received = 0;
+	for (unsigned int tries = 0; (tries < 5) && (received <= 0); tries++) {
+		(void) sendto (
+			sock, datagram, sizeof (datagram), 0,
+			(const struct sockaddr *) &address, sizeof (struct sockaddr_in)
+		);
+
+		received = recv (sock, &response, sizeof (PacketHeader), 0);
+	}
+
+	test_check_int_eq ((int) received, (int) sizeof (PacketHeader), NULL);
+	test_check_unsigned_eq (response.packet_type, PACKET_TYPE_TEST, NULL);
+
+	received = recv (sock, &response, sizeof (PacketHeader), 0);
+	test_check_int_eq ((int) received, (int) sizeof (PacketHeader), NULL);
+
+	test_check_ptr (cerver->udp);
+
+	// a second peer is ignored as the cerver already has its max peers
+	int other_sock = socket (AF_INET, SOCK_DGRAM, 0);
+	test_check_bool_eq ((other_sock >= 0), true, NULL);
+	(void) setsockopt (other_sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof (struct timeval));
+
+	(void) sendto (
+		other_sock, ping->packet, ping->packet_size, 0,
+		(const struct sockaddr *) &address, sizeof (struct sockaddr_in)
+	);
+
+	received = recv (other_sock, &response, sizeof (PacketHeader), 0);
+	test_check_bool_eq ((received <= 0), true, NULL);
+	test_check_unsigned_eq (cerver->udp->stats.n_peers_refused, 1, NULL);
+	(void) close (other_sock);
+
+	// the peer is removed after it closes its connection
+	Packet *close_connection = packet_generate_request (
+		PACKET_TYPE_CLIENT, CLIENT_PACKET_TYPE_CLOSE_CONNECTION, NULL, 0
+	);
+
+	test_check_ptr (close_connection);
+	(void) sendto (
+		sock, close_connection->packet, close_connection->packet_size, 0,
+		(const struct sockaddr *) &address, sizeof (struct sockaddr_in)
+	);
+
+	for (unsigned int tries = 0; (tries < 30) && cerver->udp->stats.current_peers; tries++)
+		(void) usleep (100000);
+
+	cerver->isRunning = false;
+	(void) pthread_join (thread_id, NULL);
+
+	test_check_unsigned_eq (cerver->udp->stats.current_peers, 0, NULL);
+	test_check_unsigned_eq (cerver->udp->stats.total_peers, 1, NULL);
+	test_check_bool_eq ((cerver->udp->stats.n_datagrams_received >= 2), true, NULL);
+	test_check_bool_eq ((cerver->udp->stats.n_send_batches > 0), true, NULL);
+
+	test_check_ptr (cerver->timers);
+	test_check_ptr (cerver->update_timer);
+	test_check_bool_eq ((__atomic_load_n (&update_count, __ATOMIC_RELAXED) > 0), true, NULL);
+
+	packet_delete (close_connection);
+	packet_delete (ping);
+	(void) close (sock);
+
+	test_check_unsigned_eq (cerver_teardown (cerver), 0, NULL);
+
+	test_check_bool_eq (update_args_deleted, true, NULL);
+
+}
+
+#define TEST_INACTIVE_PORT		7102
+
+static unsigned int clients_dropped = 0;
+
+static void *test_cerver_client_dropped (void *event_data_ptr) {
+
+	(void) __atomic_add_fetch (&clients_dropped, 1, __ATOMIC_RELAXED);
+
+	return NULL;
+
+}
+
+static int test_cerver_inactive_connect (void) {
+
+	int sock = socket (AF_INET, SOCK_STREAM, 0);
+	test_check_bool_eq ((sock >= 0), true, NULL);
+
+	struct timeval timeout = { .tv_sec = 1, .tv_usec = 0 };
+	(void) setsockopt (sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof (struct timeval));
+
+	struct sockaddr_in address = { 0 };
+	address.sin_family = AF_INET;
+	address.sin_addr.s_addr = htonl (INADDR_LOOPBACK);
+	address.sin_port = htons (TEST_INACTIVE_PORT);
+
+	// the cerver may not be ready yet
+	int result = -1;
+	for (unsigned int tries = 0; (tries < 10) && result; tries++) {
+		result = connect (sock, (const struct sockaddr *) &address, sizeof (struct sockaddr_in));
+		if (result) (void) usleep (100000);
+	}
+
+	test_check_int_eq (result, 0, NULL);
+
+	return sock;
+
+}
+
+static void test_cerver_inactive (void) {
+
+	Cerver *cerver = cerver_create (
+		CERVER_TYPE_CUSTOM,
+		cerver_name,
+		TEST_INACTIVE_PORT,
+		PROTOCOL_TCP,
+		false,
+		CERVER_DEFAULT_CONNECTION_QUEUE
+	);
+
+	test_check_ptr (cerver);
+
+	cerver_set_thpool_n_threads (cerver, 0);
+	cerver_set_reusable_address_flags (cerver, true);
+	cerver_set_handler_type (cerver, CERVER_HANDLER_TYPE_EPOLL);
+	cerver_set_poll_time_out (cerver, 100);
+
+	cerver_set_inactive_clients (cerver, 2, 1);
+	test_check_bool_eq (cerver->inactive_clients, true, NULL);
+	test_check_unsigned_eq (cerver->max_inactive_time, 2, NULL);
+	test_check_unsigned_eq (cerver->check_inactive_interval, 1, NULL);
+
+	test_check_unsigned_eq (
+		cerver_event_register (
+			cerver, CERVER_EVENT_CLIENT_DROPPED,
+			test_cerver_client_dropped, NULL, NULL,
+			false, false
+		), 0, NULL
+	);
+
+	pthread_t thread_id = 0;
+	test_check_int_eq (pthread_create (&thread_id, NULL, test_cerver_udp_start, cerver), 0, NULL);
+
+	int idle = test_cerver_inactive_connect ();
+	int active = test_cerver_inactive_connect ();
+
+	Packet *test = packet_generate_request (PACKET_TYPE_TEST, 0, NULL, 0);
+	test_check_ptr (test);
+
+	// only the active client keeps sending packets
+	char buffer[4096] = { 0 };
+	for (unsigned int i = 0; i < 18; i++) {
+		(void) send (active, test->packet, test->packet_size, 0);
+		(void) recv (active, buffer, sizeof (buffer), MSG_DONTWAIT);
+
+		(void) usleep (250000);
+	}
+
+	test_check_ptr (cerver->inactive);
+	test_check_unsigned_eq (cerver->inactive->n_slots, 4, NULL);
+	test_check_unsigned_eq (cerver->inactive->n_clients, 1, NULL);
+	test_check_unsigned_eq (cerver->stats->inactive_clients_dropped, 1, NULL);
+	test_check_unsigned_eq (cerver->stats->current_n_connected_clients, 1, NULL);
+	test_check_unsigned_eq (__atomic_load_n (&clients_dropped, __ATOMIC_RELAXED), 1, NULL);
+
+	// the receive counters are aggregated from the stats shards
+	CerverStats stats = { 0 };
+	cerver_stats_snapshot (cerver, &stats);
+	test_check_unsigned_eq (stats.total_n_packets_received, 18, NULL);
+	test_check_unsigned_eq (stats.received_packets.packets[PACKET_TYPE_TEST], 18, NULL);
+	test_check_bool_eq ((stats.n_packets_sent >= 18), true, NULL);
+	test_check_unsigned_eq (stats.inactive_clients_dropped, 1, NULL);
+	test_check_ptr_eq (stats.shards, NULL);
+
+	// the idle client's connection has been closed
+	ssize_t received = 0;
+	do {
+		received = recv (idle, buffer, sizeof (buffer), 0);
+	} while (received > 0);
+
+	test_check_int_eq ((int) received, 0, NULL);
+
+	cerver->isRunning = false;
+	(void) pthread_join (thread_id, NULL);
+
+	packet_delete (test);
+	(void) close (idle);
+	(void) close (active);
+
+	test_check_unsigned_eq (cerver_teardown (cerver), 0, NULL);
+
+}
+
+static Connection *test_cerver_connection_create (void) {
+
+	Connection *connection = connection_create_empty ();
+	test_check_ptr (connection);
+	test_check_ptr (connection->socket);
+
+	connection->socket->sock_fd = socket (AF_INET, SOCK_STREAM, 0);
+	test_check_int_ne (connection->socket->sock_fd, -1);
+
+	return connection;
+
+}
+
+static void test_cerver_removed_client (void) {
+
+	Cerver *cerver = test_cerver_create ();
+
+	// epoll doesn't need any other structure to unregister connections
+	cerver_set_handler_type (cerver, CERVER_HANDLER_TYPE_EPOLL);
+
+	// these are created when the cerver starts
+	cerver->clients = client_registry_create (client_delete);
+	cerver->fd_table = fd_table_create ();
+	test_check_ptr (cerver->clients);
+	test_check_ptr (cerver->fd_table);
+
+	Client *client = client_create ();
+	test_check_ptr (client);
+	test_check_bool_eq (client->removed, false, NULL);
+	test_check_unsigned_eq (client_registry_insert (cerver->clients, client), 0, NULL);
+
+	FdTableEntry entry = { 0 };
+
+	// a connection can be registered while the client is in the cerver
+	Connection *connection = test_cerver_connection_create ();
+	test_check_unsigned_eq (
+		connection_register_to_registered_client (cerver, client, connection), 0, NULL
+	);
+
+	test_check_ptr_eq (connection->client, client);
+	test_check_unsigned_eq (client->connections->size, 1, NULL);
+	test_check_unsigned_eq (
+		fd_table_get (cerver->fd_table, connection->socket->sock_fd, &entry), 0, NULL
+	);
+
+	test_check_ptr_eq (entry.connection, connection);
+
+	test_check_ptr_eq (client_unregister_from_cerver (cerver, client), client);
+	test_check_bool_eq (client->removed, true, NULL);
+
+	// but not after the client has started to be removed
+	Connection *late = test_cerver_connection_create ();
+	test_check_unsigned_eq (
+		connection_register_to_registered_client (cerver, client, late), 1, NULL
+	);
+
+	test_check_null_ptr (late->client);
+	test_check_unsigned_eq (client->connections->size, 1, NULL);
+	test_check_unsigned_eq (
+		fd_table_get (cerver->fd_table, late->socket->sock_fd, &entry), 1, NULL
+	);
+
+	// deleted sockets are not closed
+	const int sock_fd = connection->socket->sock_fd;
+	(void) close (late->socket->sock_fd);
+
+	connection_delete (late);
+	client_delete (client);
+
+	(void) close (sock_fd);
+
+	test_check_unsigned_eq (cerver_teardown (cerver), 0, NULL);
+
+}
+
+static void test_cerver_sockets_pool (void) {
+
+	Cerver *cerver = test_cerver_create ();
+
+	// this is created when the cerver starts
+	cerver->sockets_pool = dlist_init (socket_delete, NULL);
+	test_check_ptr (cerver->sockets_pool);
+
+	Socket *first = (Socket *) socket_create_empty ();
+	Socket *second = (Socket *) socket_create_empty ();
+
+	test_check_int_eq (cerver_sockets_pool_push (cerver, first), 0, NULL);
+	test_check_int_eq (cerver_sockets_pool_push (cerver, second), 0, NULL);
+
+	// a dropped socket is the last one to be reused
+	test_check_ptr_eq (cerver_sockets_pool_pop (cerver), first);
+	test_check_int_eq (cerver_sockets_pool_push (cerver, first), 0, NULL);
+	test_check_ptr_eq (cerver_sockets_pool_pop (cerver), second);
+	test_check_ptr_eq (cerver_sockets_pool_pop (cerver), first);
+	test_check_null_ptr (cerver_sockets_pool_pop (cerver));
+
+	socket_delete (first);
+	socket_delete (second);
+
+	test_check_unsigned_eq (cerver_teardown (cerver), 0, NULL);
+
+}
+
 int main (int argc, char **argv) {
 
 	srand ((unsigned) time (NULL));
@@ -67,6 +484,14 @@ int main (int argc, char **argv) {
 
 	test_cerver_base_configuration ();
 
+	test_cerver_udp ();
+
+	test_cerver_inactive ();
+
+	test_cerver_removed_client ();
+
+	test_cerver_sockets_pool ();
+
 	(void) printf ("\nDone with CERVER tests!\n\n");
 
 	return 0;
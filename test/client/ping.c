@@ -52,7 +52,7 @@ int main (int argc, const char **argv) {
 	/*** check ***/
 	// check that we received matching responses
 	test_check_unsigned_eq (
-		client->stats->received_packets->n_test_packets,
+		client->stats->received_packets->packets[PACKET_TYPE_TEST],
 		n_sent_packets,
 		NULL
 	);
@@ -29,6 +29,8 @@ int main (int argc, char **argv) {
 
 	(void) collections_tests_dlist ();
 
+	collections_tests_pool ();
+
 	collections_tests_htab ();
 
 	(void) printf ("\nDone with COLLECTIONS tests!\n\n");
@@ -11,6 +11,8 @@
 
 #include <cerver/utils/log.h>
 
+#include "../test.h"
+
 #pragma region integer
 
 typedef struct { int value; } Integer;
@@ -1664,6 +1666,345 @@ static int dlist_test_merge_many (void) {
 
 #pragma endregion
 
+#pragma region intrusive
+
+typedef struct LinkedInteger {
+
+	int value;
+	ListElement link;
+
+} LinkedInteger;
+
+static LinkedInteger *linked_integer_new (int value) {
+
+	LinkedInteger *integer = (LinkedInteger *) malloc (sizeof (LinkedInteger));
+	if (integer) {
+		integer->value = value;
+		dlist_link_init (&integer->link);
+	}
+
+	return integer;
+
+}
+
+static int dlist_test_intrusive (void) {
+
+	cerver_log_raw ("dlist_init_intrusive ()\n");
+
+	DoubleList *dlist = dlist_init_intrusive (
+		free, NULL, dlist_link_offset (LinkedInteger, link)
+	);
+
+	test_check_ptr (dlist);
+	test_check_true (dlist->intrusive);
+
+	LinkedInteger *integers[10] = { 0 };
+	for (int i = 0; i < 10; i++) {
+		integers[i] = linked_integer_new (i);
+		test_check_int_eq (dlist_insert_at_end (dlist, integers[i]), 0, NULL);
+	}
+
+	test_check_unsigned_eq (dlist_size (dlist), 10, NULL);
+
+	// the list uses the element embedded in the data
+	test_check_ptr_eq (dlist_start (dlist), &integers[0]->link);
+	test_check_ptr_eq (dlist_end (dlist), &integers[9]->link);
+	test_check_ptr_eq (dlist_element_data (dlist_start (dlist)), integers[0]);
+	test_check_true (dlist_link_is_linked (&integers[5]->link));
+
+	// linked data can't be inserted again
+	DoubleList *other = dlist_init_intrusive (
+		free, NULL, dlist_link_offset (LinkedInteger, link)
+	);
+
+	test_check_int_eq (dlist_insert_at_end (other, integers[5]), 1, NULL);
+	test_check_int_eq (dlist_insert_at_end (dlist, integers[5]), 1, NULL);
+	test_check_unsigned_eq (dlist_size (other), 0, NULL);
+
+	// removed data can be inserted somewhere else
+	test_check_ptr_eq (dlist_remove_element (dlist, &integers[5]->link), integers[5]);
+	test_check_false (dlist_link_is_linked (&integers[5]->link));
+	test_check_unsigned_eq (dlist_size (dlist), 9, NULL);
+	test_check_ptr_eq (integers[4]->link.next, &integers[6]->link);
+	test_check_ptr_eq (integers[6]->link.prev, &integers[4]->link);
+
+	test_check_int_eq (dlist_insert_at_start (other, integers[5]), 0, NULL);
+	test_check_ptr_eq (dlist_start (other), &integers[5]->link);
+
+	int expected = 0;
+	ListElement *le = NULL;
+	dlist_for_each (dlist, le) {
+		if (expected == 5) expected += 1;
+		test_check_int_eq (((LinkedInteger *) le->data)->value, expected, NULL);
+		expected += 1;
+	}
+
+	// copies always allocate their own elements
+	DoubleList *copy = dlist_copy (dlist);
+	test_check_false (copy->intrusive);
+	test_check_unsigned_eq (dlist_size (copy), 9, NULL);
+	test_check_ptr_eq (dlist_element_data (dlist_start (copy)), integers[0]);
+	dlist_clear_and_delete (copy);
+
+	dlist_delete (other);
+	dlist_delete (dlist);
+
+	cerver_log_raw ("\n----------------------------------------\n");
+
+	return 0;
+
+}
+
+static int dlist_test_intrusive_split (void) {
+
+	cerver_log_raw ("dlist_split_half () with an intrusive list\n");
+
+	DoubleList *dlist = dlist_init_intrusive (
+		free, NULL, dlist_link_offset (LinkedInteger, link)
+	);
+
+	for (int i = 0; i < 10; i++)
+		(void) dlist_insert_at_end_unsafe (dlist, linked_integer_new (i));
+
+	DoubleList *half = dlist_split_half (dlist);
+
+	test_check_ptr (half);
+	test_check_true (half->intrusive);
+	test_check_unsigned_eq (dlist_size (dlist), 5, NULL);
+	test_check_unsigned_eq (dlist_size (half), 5, NULL);
+	test_check_int_eq (((LinkedInteger *) dlist_end (dlist)->data)->value, 4, NULL);
+	test_check_int_eq (((LinkedInteger *) dlist_start (half)->data)->value, 5, NULL);
+	test_check_int_eq (((LinkedInteger *) dlist_end (half)->data)->value, 9, NULL);
+
+	// the elements are moved back without any allocation
+	dlist_merge_two (dlist, half);
+	test_check_unsigned_eq (dlist_size (dlist), 10, NULL);
+	test_check_unsigned_eq (dlist_size (half), 0, NULL);
+
+	int expected = 9;
+	ListElement *le = NULL;
+	dlist_for_each_backwards (dlist, le) {
+		test_check_int_eq (((LinkedInteger *) le->data)->value, expected, NULL);
+		expected -= 1;
+	}
+
+	test_check_int_eq (expected, -1, NULL);
+
+	dlist_delete (half);
+	dlist_delete (dlist);
+
+	cerver_log_raw ("\n----------------------------------------\n");
+
+	return 0;
+
+}
+
+#pragma endregion
+
+#pragma region splice
+
+static void dlist_test_check_values (
+	const DoubleList *dlist, const int *values, const size_t n_values
+) {
+
+	test_check_unsigned_eq (dlist->size, n_values, NULL);
+
+	size_t idx = 0;
+	ListElement *le = NULL;
+	dlist_for_each (dlist, le) {
+		test_check_int_eq (((Integer *) le->data)->value, values[idx], NULL);
+		idx += 1;
+	}
+
+	test_check_unsigned_eq (idx, n_values, NULL);
+
+	// the prev links must match the next links
+	dlist_for_each_backwards (dlist, le) {
+		idx -= 1;
+		test_check_int_eq (((Integer *) le->data)->value, values[idx], NULL);
+	}
+
+	if (n_values) {
+		test_check_null_ptr (dlist_start (dlist)->prev);
+		test_check_null_ptr (dlist_end (dlist)->next);
+	}
+
+	else {
+		test_check_null_ptr (dlist_start (dlist));
+		test_check_null_ptr (dlist_end (dlist));
+	}
+
+}
+
+static int dlist_test_splice (void) {
+
+	cerver_log_raw ("dlist_splice_unsafe ()\n");
+
+	DoubleList *one = dlist_init (integer_delete, integer_comparator);
+	DoubleList *two = dlist_init (integer_delete, integer_comparator);
+
+	for (int i = 0; i < 4; i++) (void) dlist_insert_at_end_unsafe (one, integer_new (i));
+	for (int i = 10; i < 13; i++) (void) dlist_insert_at_end_unsafe (two, integer_new (i));
+
+	// after the first element
+	test_check_int_eq (dlist_splice_unsafe (one, dlist_start (one), two), 0, NULL);
+
+	const int middle[7] = { 0, 10, 11, 12, 1, 2, 3 };
+	dlist_test_check_values (one, middle, 7);
+	dlist_test_check_values (two, NULL, 0);
+
+	// an empty source does nothing
+	test_check_int_eq (dlist_splice_unsafe (one, NULL, two), 0, NULL);
+	dlist_test_check_values (one, middle, 7);
+
+	// at the start & at the end
+	(void) dlist_insert_at_end_unsafe (two, integer_new (-1));
+	test_check_int_eq (dlist_splice_unsafe (one, NULL, two), 0, NULL);
+
+	(void) dlist_insert_at_end_unsafe (two, integer_new (20));
+	test_check_int_eq (dlist_splice_unsafe (one, dlist_end (one), two), 0, NULL);
+
+	const int edges[9] = { -1, 0, 10, 11, 12, 1, 2, 3, 20 };
+	dlist_test_check_values (one, edges, 9);
+
+	// into an empty list
+	test_check_int_eq (dlist_splice_unsafe (two, NULL, one), 0, NULL);
+	dlist_test_check_values (two, edges, 9);
+	dlist_test_check_values (one, NULL, 0);
+
+	// lists with different kinds of elements can't be spliced
+	DoubleList *intrusive = dlist_init_intrusive (
+		free, NULL, dlist_link_offset (LinkedInteger, link)
+	);
+
+	test_check_int_eq (dlist_splice_unsafe (intrusive, NULL, two), 1, NULL);
+	test_check_int_eq (dlist_splice_unsafe (two, NULL, two), 1, NULL);
+	test_check_int_eq (dlist_splice_unsafe (NULL, NULL, two), 1, NULL);
+	dlist_test_check_values (two, edges, 9);
+
+	dlist_delete (intrusive);
+	dlist_delete (two);
+	dlist_delete (one);
+
+	cerver_log_raw ("\n----------------------------------------\n");
+
+	return 0;
+
+}
+
+static int dlist_test_splice_range (void) {
+
+	cerver_log_raw ("dlist_splice_range_unsafe ()\n");
+
+	DoubleList *one = dlist_init (integer_delete, integer_comparator);
+	DoubleList *two = dlist_init (integer_delete, integer_comparator);
+
+	for (int i = 0; i < 6; i++) (void) dlist_insert_at_end_unsafe (one, integer_new (i));
+	for (int i = 10; i < 12; i++) (void) dlist_insert_at_end_unsafe (two, integer_new (i));
+
+	// move 2, 3 & 4 between 10 & 11
+	ListElement *first = dlist_get_element_at (one, 2);
+	ListElement *last = dlist_get_element_at (one, 4);
+	test_check_int_eq (
+		dlist_splice_range_unsafe (two, dlist_start (two), one, first, last, 3), 0, NULL
+	);
+
+	const int one_values[3] = { 0, 1, 5 };
+	const int two_values[5] = { 10, 2, 3, 4, 11 };
+	dlist_test_check_values (one, one_values, 3);
+	dlist_test_check_values (two, two_values, 5);
+
+	// the whole list, including its start & end
+	test_check_int_eq (
+		dlist_splice_range_unsafe (
+			one, dlist_end (one), two, dlist_start (two), dlist_end (two), 5
+		), 0, NULL
+	);
+
+	const int all_values[8] = { 0, 1, 5, 10, 2, 3, 4, 11 };
+	dlist_test_check_values (one, all_values, 8);
+	dlist_test_check_values (two, NULL, 0);
+
+	// the range can't have more elements than the source
+	test_check_int_eq (
+		dlist_splice_range_unsafe (
+			two, NULL, one, dlist_start (one), dlist_start (one), 9
+		), 1, NULL
+	);
+
+	test_check_int_eq (
+		dlist_splice_range_unsafe (two, NULL, one, NULL, NULL, 1), 1, NULL
+	);
+
+	dlist_test_check_values (one, all_values, 8);
+
+	dlist_delete (two);
+	dlist_delete (one);
+
+	cerver_log_raw ("\n----------------------------------------\n");
+
+	return 0;
+
+}
+
+#pragma endregion
+
+#pragma region elements
+
+#define DLIST_TEST_ELEMENTS_THREADS			4
+#define DLIST_TEST_ELEMENTS					(DLIST_ELEMENTS_CHUNK_SIZE * 4)
+
+static void *test_thread_elements (void *args) {
+
+	DoubleList *dlist = dlist_init (NULL, NULL);
+
+	// elements go in & out of the thread's cache & the shared list
+	for (unsigned int round = 0; round < 10; round++) {
+		for (unsigned long i = 1; i <= DLIST_TEST_ELEMENTS; i++)
+			(void) dlist_insert_at_end_unsafe (dlist, (void *) i);
+
+		unsigned long expected = 1;
+		for (ListElement *le = dlist_start (dlist); le; le = le->next) {
+			if ((unsigned long) le->data != expected) abort ();
+			expected += 1;
+		}
+
+		while (dlist_remove_start_unsafe (dlist));
+
+		if (dlist->size) abort ();
+	}
+
+	dlist_delete (dlist);
+
+	return NULL;
+
+}
+
+static int dlist_test_elements_threads (void) {
+
+	cerver_log_raw ("dlist elements from multiple threads\n");
+
+	pthread_t threads[DLIST_TEST_ELEMENTS_THREADS];
+	for (unsigned int i = 0; i < DLIST_TEST_ELEMENTS_THREADS; i++) {
+		test_check_int_eq (
+			pthread_create (&threads[i], NULL, test_thread_elements, NULL), 0, NULL
+		);
+	}
+
+	for (unsigned int i = 0; i < DLIST_TEST_ELEMENTS_THREADS; i++)
+		(void) pthread_join (threads[i], NULL);
+
+	// the elements released by the other threads are used again
+	(void) test_thread_elements (NULL);
+
+	cerver_log_raw ("\n----------------------------------------\n");
+
+	return 0;
+
+}
+
+#pragma endregion
+
 int collections_tests_dlist (void) {
 
 	(void) printf ("Testing COLLECTIONS dlist...\n");
@@ -1730,6 +2071,22 @@ int collections_tests_dlist (void) {
 
 	// TODO:
 
+	/*** intrusive ***/
+
+	res |= dlist_test_intrusive ();
+
+	res |= dlist_test_intrusive_split ();
+
+	/*** splice ***/
+
+	res |= dlist_test_splice ();
+
+	res |= dlist_test_splice_range ();
+
+	/*** elements ***/
+
+	res |= dlist_test_elements_threads ();
+
 	/*** get ***/
 
 	res |= dlist_test_get_at ();
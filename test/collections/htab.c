@@ -272,8 +272,10 @@ static void test_htab_int_remove_multiple (void) {
 	test_check_false (htab_is_not_empty (map));
 
 	// insert a new value
+	// the previous data was deleted when it was removed
 	unsigned int final_value = 18;
 	key = &final_value;
+	data = data_new (final_value, value);
 	int result = htab_insert (
 		map,
 		key, sizeof (unsigned int),
@@ -419,6 +421,143 @@ static void test_htab_int_get_multple (void) {
 
 }
 
+// insert enough values to grow the htab multiple times
+// while removing some of them in the middle of the resizes
+static void test_htab_int_resize (void) {
+
+	Htab *map = test_htab_create ();
+
+	const unsigned int n_values = 10000;
+
+	for (unsigned int i = 0; i < n_values; i++) {
+		test_check_int_eq (
+			htab_insert (map, &i, sizeof (unsigned int), data_new (i, i), sizeof (Data)),
+			0, NULL
+		);
+
+		// every other value gets removed
+		if (i % 2) {
+			void *removed = htab_remove (map, &i, sizeof (unsigned int));
+			test_check_ptr (removed);
+			data_delete (removed);
+		}
+	}
+
+	test_check_unsigned_eq (htab_size (map), n_values / 2, NULL);
+	test_check_true ((map->size >= (n_values / 2)));
+	test_check_true (((map->size & (map->size - 1)) == 0));
+
+	Data *data = NULL;
+	for (unsigned int i = 0; i < n_values; i++) {
+		data = (Data *) htab_get (map, &i, sizeof (unsigned int));
+		if (i % 2) {
+			test_check_null_ptr (data);
+		}
+
+		else {
+			test_check_ptr (data);
+			test_check_unsigned_eq (data->idx, i, NULL);
+		}
+	}
+
+	// keys are unique
+	unsigned int key = 0;
+	Data *duplicated = data_new (key, key);
+	test_check_int_eq (
+		htab_insert (map, &key, sizeof (unsigned int), duplicated, sizeof (Data)),
+		1, NULL
+	);
+
+	data_delete (duplicated);
+
+	htab_destroy (map);
+
+}
+
+// keys that do NOT fit inside the slots
+static void test_htab_large_keys (void) {
+
+	Htab *map = test_htab_create ();
+
+	char key[64] = { 0 };
+	for (unsigned int i = 0; i < 100; i++) {
+		(void) snprintf (key, sizeof (key), "a-very-long-key-that-is-not-inlined-%u", i);
+		test_check_int_eq (
+			htab_insert (map, key, strlen (key), data_new (i, i), sizeof (Data)),
+			0, NULL
+		);
+	}
+
+	test_check_unsigned_eq (htab_size (map), 100, NULL);
+
+	(void) snprintf (key, sizeof (key), "a-very-long-key-that-is-not-inlined-%u", 42);
+	test_check_true (htab_contains_key (map, key, strlen (key)));
+
+	Data *data = (Data *) htab_get (map, key, strlen (key));
+	test_check_ptr (data);
+	test_check_unsigned_eq (data->idx, 42, NULL);
+
+	(void) snprintf (key, sizeof (key), "a-very-long-key-that-is-not-inlined-%u", 420);
+	test_check_false (htab_contains_key (map, key, strlen (key)));
+
+	htab_destroy (map);
+
+}
+
+static size_t test_htab_bad_hash (
+	const void *key, size_t key_size, size_t table_size
+) {
+
+	// every key has the same hash
+	return 0;
+
+}
+
+// every key collides in the same slot
+static void test_htab_custom_hash (void) {
+
+	Htab *map = htab_create (HTAB_DEFAULT_INIT_SIZE, test_htab_bad_hash, data_delete);
+	test_check_ptr (map);
+
+	for (unsigned int i = 0; i < 100; i++) {
+		test_check_int_eq (
+			htab_insert (map, &i, sizeof (unsigned int), data_new (i, i), sizeof (Data)),
+			0, NULL
+		);
+	}
+
+	for (unsigned int i = 0; i < 100; i += 3) {
+		void *removed = htab_remove (map, &i, sizeof (unsigned int));
+		test_check_ptr (removed);
+		data_delete (removed);
+	}
+
+	for (unsigned int i = 0; i < 100; i++) {
+		if (i % 3) test_check_ptr (htab_get (map, &i, sizeof (unsigned int)));
+		else test_check_null_ptr (htab_get (map, &i, sizeof (unsigned int)));
+	}
+
+	htab_destroy (map);
+
+}
+
+static void test_htab_hash (void) {
+
+	unsigned int one = 1;
+	unsigned int two = 2;
+
+	test_check_true ((htab_hash (&one, sizeof (unsigned int)) == htab_hash (&one, sizeof (unsigned int))));
+	test_check_true ((htab_hash (&one, sizeof (unsigned int)) != htab_hash (&two, sizeof (unsigned int))));
+
+	// consecutive fds should spread between the low bits
+	unsigned long long used = 0;
+	for (int fd = 0; fd < 64; fd++)
+		used |= 1ULL << (htab_hash (&fd, sizeof (int)) & 63);
+
+	test_check_true ((__builtin_popcountll (used) >= 32));
+
+}
+
 void collections_tests_htab (void) {
 
 	(void) printf ("Testing COLLECTIONS htab...\n");
@@ -435,6 +574,14 @@ void collections_tests_htab (void) {
 
 	test_htab_int_get_multple ();
 
+	test_htab_int_resize ();
+
+	test_htab_large_keys ();
+
+	test_htab_custom_hash ();
+
+	test_htab_hash ();
+
 	(void) printf ("Done!\n");
 
 }
\ No newline at end of file
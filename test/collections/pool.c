@@ -0,0 +1,284 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include <pthread.h>
+
+#include <cerver/collections/pool.h>
+
+#include "../test.h"
+
+#include "data.h"
+
+#define TEST_POOL_THREADS				4
+#define TEST_POOL_ROUNDS				10000
+#define TEST_POOL_TAKEN					8
+
+static unsigned int test_pool_created = 0;
+static unsigned int test_pool_deleted = 0;
+
+static void *test_pool_data_create (void) {
+
+	(void) __atomic_add_fetch (&test_pool_created, 1, __ATOMIC_RELAXED);
+
+	return data_new (0, 0);
+
+}
+
+static void test_pool_data_delete (void *data_ptr) {
+
+	(void) __atomic_add_fetch (&test_pool_deleted, 1, __ATOMIC_RELAXED);
+
+	data_delete (data_ptr);
+
+}
+
+static void test_pool_create (void) {
+
+	Pool *pool = pool_create (data_delete);
+
+	test_check_ptr (pool);
+	test_check_ptr (pool->magazines_lock);
+	test_check_ptr_eq (pool->destroy, data_delete);
+	test_check_null_ptr (pool->create);
+	test_check_false (pool->produce);
+	test_check_unsigned_eq (pool->max_depot_size, 0, NULL);
+	test_check_unsigned_eq (pool->n_magazines, 0, NULL);
+	test_check_null_ptr (pool->chunks);
+	test_check_unsigned_eq (pool_size (pool), 0, NULL);
+
+	// an empty pool can't produce without a create method
+	test_check_null_ptr (pool_pop (pool));
+	pool_set_produce_if_empty (pool, true);
+	test_check_null_ptr (pool_pop (pool));
+
+	PoolStats stats = { 0 };
+	pool_get_stats (pool, &stats);
+	test_check_unsigned_eq (stats.hits, 0, NULL);
+	test_check_unsigned_eq (stats.misses, 2, NULL);
+	test_check_unsigned_eq (stats.produced, 0, NULL);
+
+	pool_delete (pool);
+
+}
+
+static void test_pool_push_pop (void) {
+
+	Pool *pool = pool_create (data_delete);
+
+	Data *values[POOL_MAGAZINE_SIZE * 3] = { 0 };
+	for (unsigned int i = 0; i < (POOL_MAGAZINE_SIZE * 3); i++) {
+		values[i] = data_new (i, i);
+		test_check_int_eq (pool_push (pool, values[i]), 0, NULL);
+	}
+
+	test_check_unsigned_eq (pool_size (pool), POOL_MAGAZINE_SIZE * 3, NULL);
+	test_check_int_eq (pool_push (pool, NULL), 1, NULL);
+
+	// the last one to be pushed is the first one to be popped
+	for (unsigned int i = (POOL_MAGAZINE_SIZE * 3); i > 0; i--)
+		test_check_ptr_eq (pool_pop (pool), values[i - 1]);
+
+	test_check_null_ptr (pool_pop (pool));
+	test_check_unsigned_eq (pool_size (pool), 0, NULL);
+
+	PoolStats stats = { 0 };
+	pool_get_stats (pool, &stats);
+	test_check_unsigned_eq (stats.hits, POOL_MAGAZINE_SIZE * 3, NULL);
+	test_check_unsigned_eq (stats.misses, 1, NULL);
+
+	for (unsigned int i = 0; i < (POOL_MAGAZINE_SIZE * 3); i++)
+		data_delete (values[i]);
+
+	pool_delete (pool);
+
+}
+
+static void test_pool_produce (void) {
+
+	Pool *pool = pool_create (test_pool_data_delete);
+	pool_set_create (pool, test_pool_data_create);
+	pool_set_produce_if_empty (pool, true);
+
+	test_pool_created = 0;
+	test_pool_deleted = 0;
+
+	test_check_int_eq (pool_init (pool, NULL, 100), 0, NULL);
+	test_check_unsigned_eq (pool_size (pool), 100, NULL);
+	test_check_unsigned_eq (test_pool_created, 100, NULL);
+
+	void *taken[110] = { 0 };
+	for (unsigned int i = 0; i < 110; i++) {
+		taken[i] = pool_pop (pool);
+		test_check_ptr (taken[i]);
+	}
+
+	test_check_unsigned_eq (pool_size (pool), 0, NULL);
+
+	PoolStats stats = { 0 };
+	pool_get_stats (pool, &stats);
+	test_check_unsigned_eq (stats.hits, 100, NULL);
+	test_check_unsigned_eq (stats.misses, 10, NULL);
+	test_check_unsigned_eq (stats.produced, 10, NULL);
+
+	for (unsigned int i = 0; i < 110; i++)
+		test_check_int_eq (pool_push (pool, taken[i]), 0, NULL);
+
+	test_check_unsigned_eq (pool_size (pool), 110, NULL);
+
+	// reset destroys the objects but the pool can still be used
+	pool_reset (pool);
+	test_check_unsigned_eq (pool_size (pool), 0, NULL);
+	test_check_unsigned_eq (test_pool_deleted, 110, NULL);
+
+	taken[0] = pool_pop (pool);
+	test_check_ptr (taken[0]);
+	test_check_int_eq (pool_push (pool, taken[0]), 0, NULL);
+
+	// clear keeps the objects
+	test_pool_deleted = 0;
+	pool_clear (pool);
+	test_check_unsigned_eq (pool_size (pool), 0, NULL);
+	test_check_unsigned_eq (test_pool_deleted, 0, NULL);
+	data_delete (taken[0]);
+
+	pool_delete (pool);
+
+}
+
+static void test_pool_max_depot_size (void) {
+
+	Pool *pool = pool_create (test_pool_data_delete);
+	pool_set_max_depot_size (pool, POOL_MAGAZINE_SIZE * 2);
+
+	test_pool_deleted = 0;
+
+	for (unsigned int i = 0; i < 200; i++)
+		test_check_int_eq (pool_push (pool, data_new (i, i)), 0, NULL);
+
+	// the depot keeps up to its max size & the cache its two magazines
+	const size_t size = pool_size (pool);
+	test_check_unsigned_eq (size, POOL_MAGAZINE_SIZE * 4, NULL);
+	test_check_unsigned_eq (test_pool_deleted, 200 - size, NULL);
+
+	PoolStats stats = { 0 };
+	pool_get_stats (pool, &stats);
+	test_check_unsigned_eq (stats.dropped, 200 - size, NULL);
+
+	// without a destroy method the data still belongs to the caller
+	pool_set_destroy (pool, NULL);
+	Data *data = data_new (0, 0);
+	test_check_int_eq (pool_push (pool, data), 1, NULL);
+	data_delete (data);
+
+	pool_set_destroy (pool, test_pool_data_delete);
+	pool_delete (pool);
+
+	test_check_unsigned_eq (test_pool_deleted, 200, NULL);
+
+}
+
+static void test_pool_chunks_grow (void) {
+
+	// enough objects to make the chunks table grow twice
+	const unsigned int n_values = (
+		POOL_MAGAZINE_SIZE * POOL_CHUNK_MAGAZINES * POOL_CHUNKS_TABLE_SIZE * 3
+	);
+
+	unsigned int *values = (unsigned int *) calloc (n_values, sizeof (unsigned int));
+	test_check_ptr (values);
+
+	Pool *pool = pool_create (NULL);
+
+	for (unsigned int i = 0; i < n_values; i++)
+		test_check_int_eq (pool_push (pool, &values[i]), 0, NULL);
+
+	test_check_unsigned_eq (pool_size (pool), n_values, NULL);
+	test_check_ptr (pool->chunks);
+	test_check_unsigned_eq (pool->chunks->size, POOL_CHUNKS_TABLE_SIZE * 4, NULL);
+	test_check_ptr (pool->chunks->retired_next);
+
+	// magazines from the retired tables can still be used
+	for (unsigned int i = n_values; i > 0; i--)
+		test_check_ptr_eq (pool_pop (pool), &values[i - 1]);
+
+	test_check_unsigned_eq (pool_size (pool), 0, NULL);
+
+	pool_delete (pool);
+
+	free (values);
+
+}
+
+static void *test_pool_thread (void *pool_ptr) {
+
+	Pool *pool = (Pool *) pool_ptr;
+
+	Data *taken[TEST_POOL_TAKEN] = { 0 };
+	for (unsigned int round = 0; round < TEST_POOL_ROUNDS; round++) {
+		const unsigned int n_taken = (round % TEST_POOL_TAKEN) + 1;
+
+		for (unsigned int i = 0; i < n_taken; i++) {
+			taken[i] = (Data *) pool_pop (pool);
+
+			// an object can only be taken by one thread at a time
+			if (__atomic_exchange_n (&taken[i]->value, 1, __ATOMIC_ACQ_REL)) abort ();
+		}
+
+		for (unsigned int i = 0; i < n_taken; i++) {
+			__atomic_store_n (&taken[i]->value, 0, __ATOMIC_RELEASE);
+			(void) pool_push (pool, taken[i]);
+		}
+	}
+
+	return NULL;
+
+}
+
+static void test_pool_threads (void) {
+
+	Pool *pool = pool_create (test_pool_data_delete);
+	pool_set_create (pool, test_pool_data_create);
+	pool_set_produce_if_empty (pool, true);
+
+	test_pool_created = 0;
+	test_pool_deleted = 0;
+
+	pthread_t threads[TEST_POOL_THREADS];
+	for (unsigned int i = 0; i < TEST_POOL_THREADS; i++) {
+		test_check_int_eq (
+			pthread_create (&threads[i], NULL, test_pool_thread, pool), 0, NULL
+		);
+	}
+
+	for (unsigned int i = 0; i < TEST_POOL_THREADS; i++)
+		(void) pthread_join (threads[i], NULL);
+
+	// every object that was produced went back to the pool
+	PoolStats stats = { 0 };
+	pool_get_stats (pool, &stats);
+	test_check_unsigned_eq (stats.produced, test_pool_created, NULL);
+	test_check_unsigned_eq (pool_size (pool), test_pool_created, NULL);
+	test_check_unsigned_eq (stats.misses, stats.produced, NULL);
+
+	pool_delete (pool);
+
+	test_check_unsigned_eq (test_pool_deleted, test_pool_created, NULL);
+
+}
+
+void collections_tests_pool (void) {
+
+	(void) printf ("Testing COLLECTIONS pool...\n");
+
+	test_pool_create ();
+	test_pool_push_pop ();
+	test_pool_produce ();
+	test_pool_max_depot_size ();
+	test_pool_chunks_grow ();
+	test_pool_threads ();
+
+	(void) printf ("Done!\n");
+
+}
@@ -35,12 +35,37 @@ static void test_connection_base_configuration (void) {
 
 }
 
+static void test_connection_send_queue (void) {
+
+	Connection *connection = test_connection_create ();
+
+	test_check_bool_eq (connection->use_send_queue, false, NULL);
+	test_check_null_ptr (connection->send_queue);
+
+	connection_set_send_queue (connection, 0);
+	test_check_bool_eq (connection->use_send_queue, true, NULL);
+	test_check_ptr (connection->send_queue);
+	test_check_unsigned_eq (connection->send_queue->high_water, SEND_QUEUE_DEFAULT_HIGH_WATER, NULL);
+
+	connection_set_send_queue_high_water (connection, 4096, SEND_QUEUE_OVERFLOW_DROP);
+	test_check_unsigned_eq (connection->send_queue->high_water, 4096, NULL);
+	test_check_unsigned_eq (connection->send_queue->overflow, SEND_QUEUE_OVERFLOW_DROP, NULL);
+
+	test_check_bool_eq (connection_send_queue_cork (connection), true, NULL);
+	test_check_bool_eq (connection->send_queue->corked, true, NULL);
+
+	connection_delete (connection);
+
+}
+
 int main (int argc, char **argv) {
 
 	(void) printf ("Testing CONNECTION...\n");
 
 	test_connection_base_configuration ();
 
+	test_connection_send_queue ();
+
 	(void) printf ("\nDone with CONNECTION tests!\n\n");
 
 	return 0;
@@ -0,0 +1,159 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include <cerver/client.h>
+#include <cerver/connection.h>
+#include <cerver/fdtable.h>
+
+#include "test.h"
+
+static void test_fd_table_create (void) {
+
+	FdTable *table = fd_table_create ();
+
+	test_check_ptr (table);
+	test_check_ptr (table->chunks[0]);
+	test_check_ptr (table->lock);
+	test_check_null_ptr (table->chunks[1]);
+
+	FdTableEntry entry = { 0 };
+	for (i32 sock_fd = 0; sock_fd < 16; sock_fd++)
+		test_check_unsigned_eq (fd_table_get (table, sock_fd, &entry), 1, NULL);
+
+	// out of range sock fds are never mapped
+	test_check_unsigned_eq (fd_table_get (table, -1, &entry), 1, NULL);
+	test_check_unsigned_eq (
+		fd_table_get (table, FD_TABLE_CHUNK_SIZE * FD_TABLE_MAX_CHUNKS, &entry), 1, NULL
+	);
+
+	test_check_null_ptr (entry.client);
+	test_check_null_ptr (entry.connection);
+	test_check_unsigned_eq (entry.generation, FD_TABLE_INVALID_GENERATION, NULL);
+
+	fd_table_delete (table);
+
+}
+
+static void test_fd_table_set (void) {
+
+	FdTable *table = fd_table_create ();
+
+	Client client = { 0 };
+	Connection connection = { 0 };
+
+	FdTableEntry entry = { 0 };
+
+	test_check_unsigned_eq (fd_table_set (table, 10, &client, &connection), 0, NULL);
+	test_check_unsigned_eq (fd_table_get (table, 10, &entry), 0, NULL);
+	test_check_ptr_eq (entry.client, &client);
+	test_check_ptr_eq (entry.connection, &connection);
+	test_check_false ((entry.generation & 1));
+
+	// on hold connections don't have a client
+	test_check_unsigned_eq (fd_table_set (table, 11, NULL, &connection), 0, NULL);
+	test_check_unsigned_eq (fd_table_get (table, 11, &entry), 0, NULL);
+	test_check_null_ptr (entry.client);
+	test_check_ptr_eq (entry.connection, &connection);
+
+	// a connection is always required
+	test_check_unsigned_eq (fd_table_set (table, 12, &client, NULL), 1, NULL);
+	test_check_unsigned_eq (fd_table_set (table, -1, &client, &connection), 1, NULL);
+
+	// bigger sock fds get their own chunk
+	const i32 big_fd = (FD_TABLE_CHUNK_SIZE * 3) + 7;
+	test_check_unsigned_eq (fd_table_set (table, big_fd, &client, &connection), 0, NULL);
+	test_check_ptr (table->chunks[3]);
+	test_check_null_ptr (table->chunks[2]);
+	test_check_unsigned_eq (fd_table_get (table, big_fd, &entry), 0, NULL);
+	test_check_ptr_eq (entry.connection, &connection);
+
+	fd_table_delete (table);
+
+}
+
+static void test_fd_table_remove (void) {
+
+	FdTable *table = fd_table_create ();
+
+	Client client = { 0 };
+	Connection on_hold = { 0 };
+	Connection connection = { 0 };
+
+	FdTableEntry entry = { 0 };
+
+	// a connection that leaves on hold after it was registered to a client
+	// can't remove its new entry
+	test_check_unsigned_eq (fd_table_set (table, 5, NULL, &on_hold), 0, NULL);
+	test_check_unsigned_eq (fd_table_set (table, 5, &client, &on_hold), 0, NULL);
+	test_check_unsigned_eq (fd_table_remove (table, 5, NULL, &on_hold), 1, NULL);
+	test_check_unsigned_eq (fd_table_get (table, 5, &entry), 0, NULL);
+	test_check_ptr_eq (entry.client, &client);
+
+	// the sock fd was reused by another connection
+	test_check_unsigned_eq (fd_table_set (table, 5, &client, &connection), 0, NULL);
+	test_check_unsigned_eq (fd_table_remove (table, 5, &client, &on_hold), 1, NULL);
+
+	test_check_unsigned_eq (fd_table_remove (table, 5, &client, &connection), 0, NULL);
+	test_check_unsigned_eq (fd_table_get (table, 5, &entry), 1, NULL);
+	test_check_null_ptr (entry.connection);
+
+	// unknown sock fds are ignored
+	test_check_unsigned_eq (fd_table_remove (table, 6, &client, &connection), 1, NULL);
+	test_check_unsigned_eq (
+		fd_table_remove (table, FD_TABLE_CHUNK_SIZE * 5, &client, &connection), 1, NULL
+	);
+
+	fd_table_delete (table);
+
+}
+
+static void test_fd_table_check (void) {
+
+	FdTable *table = fd_table_create ();
+
+	Client client = { 0 };
+	Connection first = { 0 };
+	Connection second = { 0 };
+
+	FdTableEntry entry = { 0 };
+
+	test_check_unsigned_eq (fd_table_set (table, 8, &client, &first), 0, NULL);
+	test_check_unsigned_eq (fd_table_get (table, 8, &entry), 0, NULL);
+
+	const u32 generation = entry.generation;
+	test_check_true (fd_table_check (table, 8, generation));
+	test_check_false (fd_table_check (table, 8, FD_TABLE_INVALID_GENERATION));
+	test_check_false (fd_table_check (table, 9, generation));
+
+	// the connection is dropped & its sock fd is reused
+	test_check_unsigned_eq (fd_table_remove (table, 8, &client, &first), 0, NULL);
+	test_check_false (fd_table_check (table, 8, generation));
+
+	test_check_unsigned_eq (fd_table_set (table, 8, &client, &second), 0, NULL);
+	test_check_false (fd_table_check (table, 8, generation));
+
+	test_check_unsigned_eq (fd_table_get (table, 8, &entry), 0, NULL);
+	test_check_ptr_eq (entry.connection, &second);
+	test_check_true ((entry.generation != generation));
+	test_check_true (fd_table_check (table, 8, entry.generation));
+
+	fd_table_delete (table);
+
+}
+
+int main (int argc, char **argv) {
+
+	(void) printf ("Testing FD TABLE...\n");
+
+	test_fd_table_create ();
+	test_fd_table_set ();
+	test_fd_table_remove ();
+	test_fd_table_check ();
+
+	(void) printf ("\nDone with FD TABLE tests!\n\n");
+
+	return 0;
+
+}
@@ -94,13 +94,13 @@ static void send_pings (void) {
 
 	// check that we received matching responses
 	if (
-		client->stats->received_packets->n_test_packets
+		client->stats->received_packets->packets[PACKET_TYPE_TEST]
 		!= n_sent_packets
 	) {
 		(void) printf ("\n\n");
 		cerver_log_error (
 			"Responses %lu don't match n_sent_packets %lu!",
-			client->stats->received_packets->n_test_packets,
+			client->stats->received_packets->packets[PACKET_TYPE_TEST],
 			n_sent_packets
 		);
 		(void) printf ("\n\n");
@@ -110,7 +110,7 @@ static void send_pings (void) {
 		(void) printf ("\n\n");
 		cerver_log_success (
 			"Got %lu / %lu responses!",
-			client->stats->received_packets->n_test_packets,
+			client->stats->received_packets->packets[PACKET_TYPE_TEST],
 			n_sent_packets
 		);
 		(void) printf ("\n\n");
@@ -131,13 +131,13 @@ static void send_messages (void) {
 
 	// check that we received matching responses
 	if (
-		client->stats->received_packets->n_app_packets
+		client->stats->received_packets->packets[PACKET_TYPE_APP]
 		!= n_sent_packets
 	) {
 		(void) printf ("\n\n");
 		cerver_log_error (
 			"Responses %lu don't match n_sent_packets %lu!",
-			client->stats->received_packets->n_app_packets,
+			client->stats->received_packets->packets[PACKET_TYPE_APP],
 			n_sent_packets
 		);
 		(void) printf ("\n\n");
@@ -147,7 +147,7 @@ static void send_messages (void) {
 		(void) printf ("\n\n");
 		cerver_log_success (
 			"Got %lu / %lu responses!",
-			client->stats->received_packets->n_app_packets,
+			client->stats->received_packets->packets[PACKET_TYPE_APP],
 			n_sent_packets
 		);
 		(void) printf ("\n\n");
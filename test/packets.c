@@ -9,6 +9,43 @@
 
 #define BUFFER_SIZE			128
 
+#pragma region types
+
+static void test_packets_per_type_count (void) {
+
+	PacketsPerType *packets_per_type = packets_per_type_new ();
+	test_check_ptr (packets_per_type);
+	test_check_unsigned_eq ((size_t) packets_per_type % 64, 0, NULL);
+
+	packets_per_type_count (packets_per_type, PACKET_TYPE_TEST, 0);
+	packets_per_type_count (packets_per_type, PACKET_TYPE_APP, 3);
+	packets_per_type_count (packets_per_type, PACKET_TYPE_APP, 3);
+	packets_per_type_count (packets_per_type, PACKET_TYPE_APP, 1000);
+	packets_per_type_count (packets_per_type, (PacketType) 100, 3);
+	packets_per_type_count_bad (packets_per_type);
+
+	test_check_unsigned_eq (packets_per_type->packets[PACKET_TYPE_TEST], 1, NULL);
+	test_check_unsigned_eq (packets_per_type->packets[PACKET_TYPE_APP], 3, NULL);
+	test_check_unsigned_eq (packets_per_type->packets[PACKETS_UNKNOWN_TYPE], 1, NULL);
+	test_check_unsigned_eq (packets_per_type->packets[PACKET_TYPE_BAD], 1, NULL);
+
+	// only app packets are counted by their request type
+	test_check_unsigned_eq (packets_per_type->app_requests[3], 2, NULL);
+	test_check_unsigned_eq (packets_per_type->app_requests[0], 0, NULL);
+	test_check_unsigned_eq (packets_per_type->app_requests[PACKETS_MAX_REQUEST_TYPES - 1], 1, NULL);
+
+	PacketsPerType total = { 0 };
+	packets_per_type_add (&total, packets_per_type);
+	packets_per_type_add (&total, packets_per_type);
+	test_check_unsigned_eq (total.packets[PACKET_TYPE_APP], 6, NULL);
+	test_check_unsigned_eq (total.app_requests[3], 4, NULL);
+
+	packets_per_type_delete (packets_per_type);
+
+}
+
+#pragma endregion
+
 #pragma region header
 
 static void test_packet_header_create (void) {
@@ -228,6 +265,109 @@ static void test_packets_add_data_multiple (void) {
 
 }
 
+static void test_packets_retain (void) {
+
+	char buffer[BUFFER_SIZE] = { 0 };
+	(void) strncpy (buffer, "This is test with sample text", BUFFER_SIZE - 1);
+
+	Packet *packet = packet_new ();
+
+	test_check_unsigned_eq (packet_set_data_ref (packet, buffer, BUFFER_SIZE), 0, NULL);
+	test_check_ptr_eq (packet->data, buffer);
+	test_check_true (packet->data_ref);
+
+	// simulate a partial read of the packet's data
+	packet->data_ptr = buffer + 8;
+
+	test_check_unsigned_eq (packet_retain (packet), 0, NULL);
+	test_check_ptr (packet->data);
+	test_check_false (packet->data_ref);
+	test_check_unsigned_eq (packet->data_size, BUFFER_SIZE, NULL);
+	test_check_ptr_eq (packet->data_ptr, (char *) packet->data + 8);
+	test_check_ptr_eq (packet->data_end, (char *) packet->data + BUFFER_SIZE);
+
+	// the original buffer can now be safely reused
+	(void) memset (buffer, 0, BUFFER_SIZE);
+	test_check_str_eq ((char *) packet->data, "This is test with sample text", NULL);
+
+	// retaining an owned packet does nothing
+	void *data = packet->data;
+	test_check_unsigned_eq (packet_retain (packet), 0, NULL);
+	test_check_ptr_eq (packet->data, data);
+
+	packet_delete (packet);
+
+	test_check_unsigned_eq (packet_retain (NULL), 1, NULL);
+
+}
+
+static void test_packets_pool_reuse (void) {
+
+	Packet *packet = packet_create_with_data (BUFFER_SIZE);
+	test_check_ptr (packet);
+	test_check_unsigned_eq (packet->data_class, 2, NULL);
+
+	void *packet_ptr = packet;
+	void *data_ptr = packet->data;
+
+	packet_delete (packet);
+
+	PacketsPoolStats before = { 0 };
+	packets_pool_stats (&before);
+
+	// the thread's cache must return the same items
+	packet = packet_create_with_data (BUFFER_SIZE * 2);
+	test_check_ptr_eq ((void *) packet, packet_ptr);
+	test_check_ptr_eq (packet->data, data_ptr);
+	test_check_unsigned_eq (packet->data_class, 2, NULL);
+
+	packet_delete (packet);
+
+	PacketsPoolStats after = { 0 };
+	packets_pool_stats (&after);
+
+	test_check_unsigned_eq (after.hits - before.hits, 2, NULL);
+	test_check_unsigned_eq (after.misses, before.misses, NULL);
+
+	// bigger than the biggest class
+	packet = packet_create_with_data (100000);
+	test_check_ptr (packet);
+	test_check_unsigned_eq (packet->data_class, 0, NULL);
+	packet_delete (packet);
+
+}
+
+static void test_packets_pool_append_data (void) {
+
+	char buffer[BUFFER_SIZE] = { 0 };
+	(void) strncpy (buffer, "1234567890", BUFFER_SIZE - 1);
+
+	Packet *packet = packet_new ();
+	test_check_unsigned_eq (packet_append_data (packet, buffer, 32), 0, NULL);
+	test_check_unsigned_eq (packet->data_class, 1, NULL);
+
+	// still fits in the same class buffer
+	void *data = packet->data;
+	test_check_unsigned_eq (packet_append_data (packet, buffer, 32), 0, NULL);
+	test_check_ptr_eq (packet->data, data);
+	test_check_unsigned_eq (packet->data_size, 64, NULL);
+
+	// moves to the next class keeping the data
+	test_check_unsigned_eq (packet_append_data (packet, buffer, BUFFER_SIZE), 0, NULL);
+	test_check_unsigned_eq (packet->data_class, 2, NULL);
+	test_check_unsigned_eq (packet->data_size, 64 + BUFFER_SIZE, NULL);
+	test_check_str_eq ((char *) packet->data, buffer, NULL);
+	test_check_str_eq ((char *) packet->data + 32, buffer, NULL);
+	test_check_str_eq ((char *) packet->data + 64, buffer, NULL);
+
+	test_check_unsigned_eq (packet_generate (packet), 0, NULL);
+	test_check_unsigned_eq (packet->packet_class, 2, NULL);
+	test_check_unsigned_eq (packet->packet_size, sizeof (PacketHeader) + 64 + BUFFER_SIZE, NULL);
+
+	packet_delete (packet);
+
+}
+
 #pragma endregion
 
 #pragma region public
@@ -521,6 +661,9 @@ int main (int argc, char **argv) {
 
 	(void) printf ("Testing PACKETS...\n");
 
+	// types
+	test_packets_per_type_count ();
+
 	// header
 	test_packet_header_create ();
 	test_packet_header_create_from ();
@@ -531,6 +674,11 @@ int main (int argc, char **argv) {
 	test_packets_add_data_good ();
 	test_packets_add_data_bad ();
 	test_packets_add_data_multiple ();
+	test_packets_retain ();
+
+	// pool
+	test_packets_pool_reuse ();
+	test_packets_pool_append_data ();
 
 	// public
 	test_packets_create_ping ();
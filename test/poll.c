@@ -0,0 +1,202 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include <poll.h>
+
+#include <cerver/poll.h>
+
+#include "test.h"
+
+#define TEST_POLL_MAX_FDS			8
+
+static void test_poll_fds_map_create (void) {
+
+	PollFdsMap *map = poll_fds_map_create (16);
+
+	test_check_ptr (map);
+	test_check_ptr (map->idxs);
+	test_check_unsigned_eq (map->size, 16, NULL);
+
+	for (i32 sock_fd = 0; sock_fd < 16; sock_fd++)
+		test_check_int_eq (poll_fds_map_get (map, sock_fd), -1, NULL);
+
+	// out of range sock fds are never registered
+	test_check_int_eq (poll_fds_map_get (map, -1), -1, NULL);
+	test_check_int_eq (poll_fds_map_get (map, 100), -1, NULL);
+
+	poll_fds_map_delete (map);
+
+}
+
+static void test_poll_fds_register (void) {
+
+	struct pollfd fds[TEST_POLL_MAX_FDS];
+	poll_fds_reset (fds, 0, TEST_POLL_MAX_FDS);
+
+	u32 current_n_fds = 0;
+	PollFdsMap *map = poll_fds_map_create (4);
+
+	// slots are taken from the top of the free slots stack
+	for (i32 i = 0; i < TEST_POLL_MAX_FDS; i++) {
+		test_check_int_eq (
+			poll_fds_register (
+				fds, TEST_POLL_MAX_FDS, &current_n_fds,
+				map,
+				10 + i, POLLIN
+			),
+			i, NULL
+		);
+
+		test_check_int_eq (fds[i].fd, 10 + i, NULL);
+		test_check_int_eq (fds[i].events, POLLIN, NULL);
+		test_check_int_eq (poll_fds_map_get (map, 10 + i), i, NULL);
+	}
+
+	// the map had to grow to hold the bigger sock fds
+	test_check (map->size > 17, NULL);
+	test_check_unsigned_eq (current_n_fds, TEST_POLL_MAX_FDS, NULL);
+
+	// the poll array is full
+	test_check_int_eq (
+		poll_fds_register (
+			fds, TEST_POLL_MAX_FDS, &current_n_fds,
+			map,
+			100, POLLIN
+		),
+		-1, NULL
+	);
+
+	test_check_unsigned_eq (current_n_fds, TEST_POLL_MAX_FDS, NULL);
+	test_check_int_eq (poll_fds_map_get (map, 100), -1, NULL);
+
+	poll_fds_map_delete (map);
+
+}
+
+static void test_poll_fds_unregister (void) {
+
+	struct pollfd fds[TEST_POLL_MAX_FDS];
+	poll_fds_reset (fds, 0, TEST_POLL_MAX_FDS);
+
+	u32 current_n_fds = 0;
+	PollFdsMap *map = poll_fds_map_create (POLL_FDS_MAP_DEFAULT_SIZE);
+
+	for (i32 i = 0; i < 4; i++) {
+		(void) poll_fds_register (
+			fds, TEST_POLL_MAX_FDS, &current_n_fds,
+			map,
+			10 + i, POLLIN
+		);
+	}
+
+	// the slot is freed but no other fd is moved
+	fds[3].revents = POLLIN;
+	test_check_int_eq (poll_fds_unregister (fds, map, 11), 1, NULL);
+	test_check_unsigned_eq (current_n_fds, 4, NULL);
+	test_check_unsigned_eq (map->n_removed, 1, NULL);
+	test_check_int_eq (fds[1].fd, -1, NULL);
+	test_check_int_eq (fds[1].events, 0, NULL);
+	test_check_int_eq (poll_fds_get (fds, 1), -1, NULL);
+	test_check_int_eq (poll_fds_map_get (map, 11), -1, NULL);
+
+	test_check_int_eq (fds[3].fd, 13, NULL);
+	test_check_int_eq (fds[3].revents, POLLIN, NULL);
+	test_check_int_eq (poll_fds_map_get (map, 13), 3, NULL);
+
+	// unknown sock fds are ignored
+	test_check_int_eq (poll_fds_unregister (fds, map, 11), -1, NULL);
+	test_check_unsigned_eq (map->n_removed, 1, NULL);
+
+	// a new fd is placed right after the registered ones
+	test_check_int_eq (
+		poll_fds_register (
+			fds, TEST_POLL_MAX_FDS, &current_n_fds,
+			map,
+			11, POLLIN
+		),
+		4, NULL
+	);
+
+	test_check_unsigned_eq (current_n_fds, 5, NULL);
+
+	poll_fds_map_delete (map);
+
+}
+
+static void test_poll_fds_compact (void) {
+
+	struct pollfd fds[TEST_POLL_MAX_FDS];
+	poll_fds_reset (fds, 0, TEST_POLL_MAX_FDS);
+
+	u32 current_n_fds = 0;
+	PollFdsMap *map = poll_fds_map_create (POLL_FDS_MAP_DEFAULT_SIZE);
+
+	for (i32 i = 0; i < 6; i++) {
+		(void) poll_fds_register (
+			fds, TEST_POLL_MAX_FDS, &current_n_fds,
+			map,
+			10 + i, POLLIN
+		);
+	}
+
+	// nothing to do if no fd has been removed
+	poll_fds_compact (fds, &current_n_fds, map, 0);
+	test_check_unsigned_eq (current_n_fds, 6, NULL);
+
+	// the last fds take the freed slots
+	(void) poll_fds_unregister (fds, map, 11);
+	(void) poll_fds_unregister (fds, map, 12);
+	(void) poll_fds_unregister (fds, map, 15);
+
+	poll_fds_compact (fds, &current_n_fds, map, 0);
+	test_check_unsigned_eq (current_n_fds, 3, NULL);
+	test_check_unsigned_eq (map->n_removed, 0, NULL);
+
+	test_check_int_eq (fds[0].fd, 10, NULL);
+	test_check_int_eq (fds[1].fd, 14, NULL);
+	test_check_int_eq (fds[2].fd, 13, NULL);
+	test_check_int_eq (poll_fds_map_get (map, 10), 0, NULL);
+	test_check_int_eq (poll_fds_map_get (map, 14), 1, NULL);
+	test_check_int_eq (poll_fds_map_get (map, 13), 2, NULL);
+
+	for (u32 i = 3; i < TEST_POLL_MAX_FDS; i++) {
+		test_check_int_eq (fds[i].fd, -1, NULL);
+		test_check_int_eq (fds[i].events, 0, NULL);
+		test_check_int_eq (fds[i].revents, 0, NULL);
+	}
+
+	// slots before first are never moved
+	(void) poll_fds_unregister (fds, map, 10);
+	poll_fds_compact (fds, &current_n_fds, map, 1);
+	test_check_unsigned_eq (current_n_fds, 3, NULL);
+	test_check_int_eq (fds[0].fd, -1, NULL);
+
+	// every fd can be removed
+	(void) poll_fds_unregister (fds, map, 13);
+	(void) poll_fds_unregister (fds, map, 14);
+	poll_fds_compact (fds, &current_n_fds, map, 0);
+	test_check_unsigned_eq (current_n_fds, 0, NULL);
+
+	for (u32 i = 0; i < TEST_POLL_MAX_FDS; i++)
+		test_check_int_eq (fds[i].fd, -1, NULL);
+
+	poll_fds_map_delete (map);
+
+}
+
+int main (int argc, char **argv) {
+
+	(void) printf ("Testing POLL...\n");
+
+	test_poll_fds_map_create ();
+	test_poll_fds_register ();
+	test_poll_fds_unregister ();
+	test_poll_fds_compact ();
+
+	(void) printf ("\nDone with POLL tests!\n\n");
+
+	return 0;
+
+}
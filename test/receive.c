@@ -3,8 +3,20 @@
 #include <string.h>
 #include <stdbool.h>
 
+#include <unistd.h>
+
+#include <sys/epoll.h>
+#include <sys/socket.h>
+
+#include <cerver/cerver.h>
+#include <cerver/connection.h>
+#include <cerver/fdtable.h>
+#include <cerver/handler.h>
+#include <cerver/packets.h>
 #include <cerver/receive.h>
 
+#include <cerver/threads/jobs.h>
+
 #include "test.h"
 
 static void test_receive_error_to_string (void) {
@@ -73,6 +85,207 @@ static void test_receive_handle_create (void) {
 
 }
 
+static void test_cerver_receive_reuse (void) {
+
+	// the same receive is used for multiple connections
+	CerverReceive cr = { 0 };
+
+	Connection *first = connection_new ();
+	Connection *second = connection_new ();
+
+	test_check_ptr (first);
+	test_check_ptr (second);
+
+	cerver_receive_init_full (&cr, RECEIVE_TYPE_NORMAL, NULL, NULL, first);
+
+	test_check_unsigned_eq (cr.type, RECEIVE_TYPE_NORMAL, NULL);
+	test_check_null_ptr (cr.cerver);
+	test_check_ptr_eq (cr.connection, first);
+	test_check_ptr_eq (cr.socket, first->socket);
+	test_check_null_ptr (cr.client);
+
+	cr.lobby = (Lobby *) &cr;
+
+	cerver_receive_init_full (&cr, RECEIVE_TYPE_ON_HOLD, NULL, NULL, second);
+
+	test_check_unsigned_eq (cr.type, RECEIVE_TYPE_ON_HOLD, NULL);
+	test_check_ptr_eq (cr.connection, second);
+	test_check_ptr_eq (cr.socket, second->socket);
+
+	// nothing from the previous connection is kept
+	test_check_null_ptr (cr.admin);
+	test_check_null_ptr (cr.lobby);
+
+	cerver_receive_reset (&cr);
+
+	test_check_unsigned_eq (cr.type, RECEIVE_TYPE_NONE, NULL);
+	test_check_null_ptr (cr.connection);
+	test_check_null_ptr (cr.socket);
+
+	connection_delete (first);
+	connection_delete (second);
+
+}
+
+static void test_handler_jobs_create (
+	Packet **packets, void **jobs, const unsigned int n_jobs
+) {
+
+	for (unsigned int i = 0; i < n_jobs; i++) {
+		packets[i] = packet_new ();
+		test_check_ptr (packets[i]);
+
+		jobs[i] = job_create (NULL, packets[i]);
+		test_check_ptr (jobs[i]);
+	}
+
+}
+
+static void test_handler_jobs_delete (Handler *handler) {
+
+	Job *job = NULL;
+	while ((job = (Job *) job_queue_pull (handler->job_queue))) {
+		packet_delete (job->args);
+		job_delete (job);
+	}
+
+}
+
+static void test_handler_max_queue_depth (void) {
+
+	Packet *packets[6] = { 0 };
+	void *jobs[6] = { 0 };
+	HandlerStats stats = { 0 };
+
+	Handler *handler = handler_create (NULL);
+
+	test_check_ptr (handler);
+	test_check_unsigned_eq (handler->max_queue_depth, HANDLER_DEFAULT_MAX_QUEUE_DEPTH, NULL);
+	test_check_unsigned_eq (handler->overflow, HANDLER_DEFAULT_OVERFLOW, NULL);
+
+	test_check_str_eq (handler_overflow_to_string (HANDLER_OVERFLOW_DROP_OLDEST), "Drop-Oldest", NULL);
+	test_check_str_eq (handler_overflow_to_string (HANDLER_OVERFLOW_PAUSE), "Pause", NULL);
+
+	// without a limit every job is pushed
+	test_handler_jobs_create (packets, jobs, 6);
+	test_check_unsigned_eq (handler_push_jobs (handler, jobs, 6), 0, NULL);
+	test_check_unsigned_eq (handler_get_queue_depth (handler), 6, NULL);
+	test_handler_jobs_delete (handler);
+
+	// the newest jobs don't fit in the queue
+	handler_set_max_queue_depth (handler, 4, HANDLER_OVERFLOW_DROP_NEWEST);
+	test_handler_jobs_create (packets, jobs, 6);
+	test_check_unsigned_eq (handler_push_jobs (handler, jobs, 6), 2, NULL);
+	test_check_unsigned_eq (handler_get_queue_depth (handler), 4, NULL);
+
+	Job *job = (Job *) job_queue_pull (handler->job_queue);
+	test_check_ptr_eq (job->args, packets[0]);
+	packet_delete (job->args);
+	job_delete (job);
+	test_handler_jobs_delete (handler);
+
+	// the oldest jobs in the queue & in the batch are discarded
+	handler_set_max_queue_depth (handler, 4, HANDLER_OVERFLOW_DROP_OLDEST);
+	test_handler_jobs_create (packets, jobs, 3);
+	test_check_unsigned_eq (handler_push_jobs (handler, jobs, 3), 0, NULL);
+	test_handler_jobs_create (packets, jobs, 6);
+	test_check_unsigned_eq (handler_push_jobs (handler, jobs, 6), 2, NULL);
+	test_check_unsigned_eq (handler_get_queue_depth (handler), 4, NULL);
+
+	job = (Job *) job_queue_pull (handler->job_queue);
+	test_check_ptr_eq (job->args, packets[2]);
+	test_check_bool_eq ((job->timestamp > 0), true, NULL);
+	packet_delete (job->args);
+	job_delete (job);
+	test_handler_jobs_delete (handler);
+
+	// a handler that is not running never makes the producer wait
+	handler_set_max_queue_depth (handler, 4, HANDLER_OVERFLOW_PAUSE);
+	test_handler_jobs_create (packets, jobs, 6);
+	test_check_unsigned_eq (handler_push_jobs (handler, jobs, 6), 0, NULL);
+	test_check_unsigned_eq (handler_get_queue_depth (handler), 6, NULL);
+
+	handler_get_stats (handler, &stats);
+	test_check_unsigned_eq (stats.queue_depth, 6, NULL);
+	test_check_unsigned_eq (stats.queue_high_water, 6, NULL);
+	test_check_unsigned_eq (stats.jobs_pushed, 6 + 4 + 3 + 4 + 6, NULL);
+	test_check_unsigned_eq (stats.jobs_dropped, 2 + 3 + 2, NULL);
+	test_check_unsigned_eq (stats.overflows, 3, NULL);
+	test_check_unsigned_eq (stats.jobs_handled, 0, NULL);
+
+	test_handler_jobs_delete (handler);
+
+	handler_delete (handler);
+
+}
+
+static void test_handler_pause_connection (void) {
+
+	Packet *packets[6] = { 0 };
+	void *jobs[6] = { 0 };
+
+	int fds[2] = { -1, -1 };
+	test_check_int_eq (socketpair (AF_UNIX, SOCK_STREAM, 0, fds), 0, NULL);
+
+	Cerver cerver = { 0 };
+	cerver.handler_type = CERVER_HANDLER_TYPE_EPOLL;
+	cerver.fd_table = fd_table_create ();
+	cerver.epoll_fd = epoll_create1 (0);
+	test_check_ptr (cerver.fd_table);
+	test_check_bool_eq ((cerver.epoll_fd >= 0), true, NULL);
+
+	struct sockaddr_storage address = { 0 };
+	Connection *connection = connection_create (fds[0], &address, PROTOCOL_TCP);
+	test_check_ptr (connection);
+	test_check_int_eq (fd_table_set (cerver.fd_table, fds[0], NULL, connection), 0, NULL);
+
+	struct epoll_event event = { 0 };
+	event.events = EPOLLIN | EPOLLET;
+	test_check_int_eq (epoll_ctl (cerver.epoll_fd, EPOLL_CTL_ADD, fds[0], &event), 0, NULL);
+
+	Handler *handler = handler_create (NULL);
+	test_check_ptr (handler);
+	handler->cerver = &cerver;
+	handler_set_max_queue_depth (handler, 4, HANDLER_OVERFLOW_PAUSE);
+
+	// the jobs are kept but only the connection stops reading
+	test_handler_jobs_create (packets, jobs, 6);
+	test_check_unsigned_eq (
+		handler_push_connection_jobs (handler, connection, jobs, 6), 0, NULL
+	);
+
+	test_check_unsigned_eq (handler_get_queue_depth (handler), 6, NULL);
+	test_check_bool_eq (handler_connection_is_paused (connection), true, NULL);
+	test_check_unsigned_eq (handler->paused, 1, NULL);
+
+	test_check_int_eq ((int) write (fds[1], "test", 4), 4, NULL);
+	test_check_int_eq (epoll_wait (cerver.epoll_fd, &event, 1, 0), 0, NULL);
+
+	// a resumed connection gets an event for its pending data
+	test_check_unsigned_eq (
+		cerver_handler_connection_set_reading (&cerver, connection, true), 0, NULL
+	);
+
+	test_check_int_eq (epoll_wait (cerver.epoll_fd, &event, 1, 0), 1, NULL);
+	test_check_bool_eq (((event.events & EPOLLIN) != 0), true, NULL);
+
+	// connections that are unregistered are never resumed
+	handler_connection_unpause (connection);
+	test_check_bool_eq (handler_connection_is_paused (connection), false, NULL);
+	test_check_unsigned_eq (handler->paused, 0, NULL);
+	test_check_unsigned_eq (dlist_size (handler->paused_connections), 0, NULL);
+
+	test_handler_jobs_delete (handler);
+	handler_delete (handler);
+
+	connection_delete (connection);
+	fd_table_delete (cerver.fd_table);
+	(void) close (cerver.epoll_fd);
+	(void) close (fds[0]);
+	(void) close (fds[1]);
+
+}
+
 int main (int argc, char **argv) {
 
 	(void) printf ("Testing RECEIVE HANDLE...\n");
@@ -83,6 +296,12 @@ int main (int argc, char **argv) {
 
 	test_receive_handle_create ();
 
+	test_cerver_receive_reuse ();
+
+	test_handler_max_queue_depth ();
+
+	test_handler_pause_connection ();
+
 	(void) printf ("\nDone with RECEIVE HANDLE tests!\n\n");
 
 	return 0;
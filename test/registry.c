@@ -0,0 +1,319 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include <pthread.h>
+
+#include <cerver/client.h>
+#include <cerver/registry.h>
+
+#include "test.h"
+
+#define TEST_REGISTRY_CLIENTS				1000
+#define TEST_REGISTRY_READERS				4
+
+static unsigned int test_registry_deleted = 0;
+
+static void test_registry_delete_client (void *client_ptr) {
+
+	test_registry_deleted += 1;
+
+	client_delete (client_ptr);
+
+}
+
+static void test_registry_count_client (Client *client, void *args) {
+
+	*((unsigned int *) args) += 1;
+
+}
+
+static Client *test_registry_client_create (const char *session_id) {
+
+	Client *client = client_create ();
+	if (session_id) (void) client_set_session_id (client, session_id);
+
+	return client;
+
+}
+
+static void test_client_registry_create (void) {
+
+	ClientRegistry *registry = client_registry_create (NULL);
+
+	test_check_ptr (registry);
+	test_check_unsigned_eq (client_registry_size (registry), 0, NULL);
+	test_check_unsigned_eq (registry->epoch, 0, NULL);
+
+	for (unsigned int i = 0; i < CLIENT_REGISTRY_SHARDS; i++) {
+		test_check_ptr (registry->ids[i].table);
+		test_check_ptr (registry->sessions[i].table);
+		test_check_unsigned_eq (registry->ids[i].table->size, CLIENT_REGISTRY_SHARD_INIT_SIZE, NULL);
+	}
+
+	test_check_null_ptr (client_registry_get_by_id (registry, 0));
+	test_check_null_ptr (client_registry_get_by_session_id (registry, "session"));
+
+	client_registry_delete (registry);
+
+}
+
+static void test_client_registry_insert (void) {
+
+	ClientRegistry *registry = client_registry_create (client_delete);
+
+	Client *first = test_registry_client_create (NULL);
+	Client *second = test_registry_client_create ("session");
+
+	test_check_unsigned_eq (client_registry_insert (registry, first), 0, NULL);
+	test_check_unsigned_eq (client_registry_insert (registry, second), 0, NULL);
+	test_check_unsigned_eq (client_registry_size (registry), 2, NULL);
+
+	test_check_ptr_eq (client_registry_get_by_id (registry, first->id), first);
+	test_check_ptr_eq (client_registry_get_by_id (registry, second->id), second);
+	test_check_ptr_eq (client_registry_get_by_session_id (registry, "session"), second);
+	test_check_null_ptr (client_registry_get_by_session_id (registry, "other"));
+
+	// the same client can't be registered twice
+	test_check_unsigned_eq (client_registry_insert (registry, first), 1, NULL);
+
+	// neither a different client with an existing session id
+	Client *third = test_registry_client_create ("session");
+	test_check_unsigned_eq (client_registry_insert (registry, third), 1, NULL);
+	test_check_null_ptr (client_registry_get_by_id (registry, third->id));
+	test_check_unsigned_eq (client_registry_size (registry), 2, NULL);
+	client_delete (third);
+
+	client_registry_delete (registry);
+
+}
+
+static void test_client_registry_remove (void) {
+
+	ClientRegistry *registry = client_registry_create (NULL);
+
+	Client *client = test_registry_client_create ("session");
+
+	test_check_unsigned_eq (client_registry_insert (registry, client), 0, NULL);
+	test_check_ptr_eq (client_registry_remove (registry, client), client);
+	test_check_unsigned_eq (client_registry_size (registry), 0, NULL);
+
+	test_check_null_ptr (client_registry_get_by_id (registry, client->id));
+	test_check_null_ptr (client_registry_get_by_session_id (registry, "session"));
+
+	// it has already been removed
+	test_check_null_ptr (client_registry_remove (registry, client));
+
+	// without readers, the removed nodes have already been released
+	for (unsigned int i = 0; i < CLIENT_REGISTRY_EPOCHS; i++)
+		test_check_null_ptr (registry->retired_nodes[i]);
+
+	client_registry_delete (registry);
+
+	client_delete (client);
+
+}
+
+static void test_client_registry_grow (void) {
+
+	ClientRegistry *registry = client_registry_create (test_registry_delete_client);
+
+	Client *clients[TEST_REGISTRY_CLIENTS] = { 0 };
+	char session_id[32] = { 0 };
+	for (unsigned int i = 0; i < TEST_REGISTRY_CLIENTS; i++) {
+		(void) snprintf (session_id, 32, "session-%u", i);
+		clients[i] = test_registry_client_create (session_id);
+
+		test_check_unsigned_eq (client_registry_insert (registry, clients[i]), 0, NULL);
+	}
+
+	test_check_unsigned_eq (client_registry_size (registry), TEST_REGISTRY_CLIENTS, NULL);
+
+	size_t n_nodes = 0;
+	for (unsigned int i = 0; i < CLIENT_REGISTRY_SHARDS; i++) {
+		test_check_true ((registry->ids[i].table->size >= registry->ids[i].count));
+		n_nodes += registry->ids[i].count;
+	}
+
+	test_check_unsigned_eq (n_nodes, TEST_REGISTRY_CLIENTS, NULL);
+
+	for (unsigned int i = 0; i < TEST_REGISTRY_CLIENTS; i++) {
+		(void) snprintf (session_id, 32, "session-%u", i);
+
+		test_check_ptr_eq (client_registry_get_by_id (registry, clients[i]->id), clients[i]);
+		test_check_ptr_eq (client_registry_get_by_session_id (registry, session_id), clients[i]);
+	}
+
+	unsigned int visited = 0;
+	client_registry_for_each (registry, test_registry_count_client, &visited);
+	test_check_unsigned_eq (visited, TEST_REGISTRY_CLIENTS, NULL);
+
+	test_registry_deleted = 0;
+	client_registry_delete (registry);
+	test_check_unsigned_eq (test_registry_deleted, TEST_REGISTRY_CLIENTS, NULL);
+
+}
+
+static void test_client_registry_read (void) {
+
+	ClientRegistry *registry = client_registry_create (NULL);
+
+	Client *client = test_registry_client_create (NULL);
+	test_check_unsigned_eq (client_registry_insert (registry, client), 0, NULL);
+
+	// a reader keeps the removed node until it is done
+	const unsigned int token = client_registry_read_start (registry);
+
+	test_check_ptr_eq (client_registry_remove (registry, client), client);
+
+	bool retired = false;
+	for (unsigned int i = 0; i < CLIENT_REGISTRY_EPOCHS; i++)
+		if (registry->retired_nodes[i]) retired = true;
+
+	test_check_true (retired);
+
+	client_registry_read_end (registry, token);
+
+	// the next write releases it
+	test_check_unsigned_eq (client_registry_insert (registry, client), 0, NULL);
+	test_check_ptr_eq (client_registry_remove (registry, client), client);
+
+	for (unsigned int i = 0; i < CLIENT_REGISTRY_EPOCHS; i++)
+		test_check_null_ptr (registry->retired_nodes[i]);
+
+	client_registry_delete (registry);
+
+	client_delete (client);
+
+}
+
+static void test_client_registry_retire_client (void) {
+
+	ClientRegistry *registry = client_registry_create (test_registry_delete_client);
+	test_registry_deleted = 0;
+
+	Client *client = test_registry_client_create ("session");
+	test_check_unsigned_eq (client_registry_insert (registry, client), 0, NULL);
+
+	// a reader that found the client can keep using it
+	const unsigned int token = client_registry_read_start (registry);
+	test_check_ptr_eq (client_registry_get_by_session_id (registry, "session"), client);
+
+	test_check_ptr_eq (client_registry_remove (registry, client), client);
+	client_registry_retire_client (registry, client);
+
+	test_check_unsigned_eq (test_registry_deleted, 0, NULL);
+	test_check_str_eq (client->session_id->str, "session", NULL);
+
+	client_registry_read_end (registry, token);
+
+	// the next retire releases it
+	Client *other = test_registry_client_create (NULL);
+	client_registry_retire_client (registry, other);
+
+	test_check_unsigned_eq (test_registry_deleted, 2, NULL);
+	for (unsigned int i = 0; i < CLIENT_REGISTRY_EPOCHS; i++)
+		test_check_null_ptr (registry->retired_clients[i]);
+
+	client_registry_delete (registry);
+
+}
+
+typedef struct TestRegistryReader {
+
+	ClientRegistry *registry;
+	Client **clients;
+	bool *done;
+	unsigned int found;
+
+} TestRegistryReader;
+
+static void *test_registry_reader (void *reader_ptr) {
+
+	TestRegistryReader *reader = (TestRegistryReader *) reader_ptr;
+
+	unsigned int visited = 0;
+	while (!__atomic_load_n (reader->done, __ATOMIC_ACQUIRE)) {
+		for (unsigned int i = 0; i < TEST_REGISTRY_CLIENTS; i++) {
+			Client *client = client_registry_get_by_id (
+				reader->registry, reader->clients[i]->id
+			);
+
+			if (client) {
+				// a found client is always the one with the id
+				if (client != reader->clients[i]) abort ();
+				reader->found += 1;
+			}
+		}
+
+		client_registry_for_each (reader->registry, test_registry_count_client, &visited);
+	}
+
+	return NULL;
+
+}
+
+static void test_client_registry_concurrent (void) {
+
+	ClientRegistry *registry = client_registry_create (NULL);
+
+	Client **clients = (Client **) calloc (TEST_REGISTRY_CLIENTS, sizeof (Client *));
+	for (unsigned int i = 0; i < TEST_REGISTRY_CLIENTS; i++)
+		clients[i] = test_registry_client_create (NULL);
+
+	bool done = false;
+	pthread_t threads[TEST_REGISTRY_READERS];
+	TestRegistryReader readers[TEST_REGISTRY_READERS];
+	for (unsigned int i = 0; i < TEST_REGISTRY_READERS; i++) {
+		readers[i].registry = registry;
+		readers[i].clients = clients;
+		readers[i].done = &done;
+		readers[i].found = 0;
+
+		test_check_int_eq (
+			pthread_create (&threads[i], NULL, test_registry_reader, &readers[i]), 0, NULL
+		);
+	}
+
+	// the shards grow & nodes are removed while being read
+	for (unsigned int round = 0; round < 10; round++) {
+		for (unsigned int i = 0; i < TEST_REGISTRY_CLIENTS; i++)
+			test_check_unsigned_eq (client_registry_insert (registry, clients[i]), 0, NULL);
+
+		for (unsigned int i = 0; i < TEST_REGISTRY_CLIENTS; i++)
+			test_check_ptr_eq (client_registry_remove (registry, clients[i]), clients[i]);
+	}
+
+	__atomic_store_n (&done, true, __ATOMIC_RELEASE);
+	for (unsigned int i = 0; i < TEST_REGISTRY_READERS; i++)
+		(void) pthread_join (threads[i], NULL);
+
+	test_check_unsigned_eq (client_registry_size (registry), 0, NULL);
+
+	client_registry_delete (registry);
+
+	for (unsigned int i = 0; i < TEST_REGISTRY_CLIENTS; i++)
+		client_delete (clients[i]);
+
+	free (clients);
+
+}
+
+int main (int argc, char **argv) {
+
+	(void) printf ("Testing CLIENT REGISTRY...\n");
+
+	test_client_registry_create ();
+	test_client_registry_insert ();
+	test_client_registry_remove ();
+	test_client_registry_grow ();
+	test_client_registry_read ();
+	test_client_registry_retire_client ();
+	test_client_registry_concurrent ();
+
+	(void) printf ("\nDone with CLIENT REGISTRY tests!\n\n");
+
+	return 0;
+
+}
@@ -10,12 +10,20 @@
 
 ./test/bin/collections --quiet || { exit 1; }
 
+./test/bin/fdtable || { exit 1; }
+
 ./test/bin/files || { exit 1; }
 
 ./test/bin/packets || { exit 1; }
 
+./test/bin/poll || { exit 1; }
+
 ./test/bin/receive || { exit 1; }
 
+./test/bin/registry || { exit 1; }
+
+./test/bin/send || { exit 1; }
+
 ./test/bin/system || { exit 1; }
 
 ./test/bin/threads || { exit 1; }
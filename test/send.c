@@ -0,0 +1,244 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include <unistd.h>
+
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include <cerver/send.h>
+
+#include "test.h"
+
+static void test_send_queue_overflow_to_string (void) {
+
+	test_check_str_eq (send_queue_overflow_to_string (SEND_QUEUE_OVERFLOW_EVENT), "Event", NULL);
+	test_check_str_eq (send_queue_overflow_to_string (SEND_QUEUE_OVERFLOW_DROP), "Drop", NULL);
+
+	test_check_str_eq (send_queue_overflow_to_string ((SendQueueOverflow) 10), "Event", NULL);
+
+}
+
+static void test_send_queue_create (void) {
+
+	SendQueue *queue = send_queue_create (100, 1024, SEND_QUEUE_OVERFLOW_DROP);
+
+	test_check_ptr (queue);
+	test_check_ptr (queue->buffer);
+	test_check_unsigned_eq (queue->size, 128, NULL);
+	test_check_unsigned_eq (queue->high_water, 1024, NULL);
+	test_check_unsigned_eq (queue->overflow, SEND_QUEUE_OVERFLOW_DROP, NULL);
+	test_check_false (queue->overflowed);
+	test_check_false (queue->closed);
+	test_check_ptr (queue->mutex);
+	test_check_ptr (queue->has_data);
+	test_check_unsigned_eq (send_queue_pending (queue), 0, NULL);
+
+	send_queue_delete (queue);
+
+}
+
+static void test_send_queue_append (void) {
+
+	int fds[2] = { 0 };
+	test_check_int_eq (socketpair (AF_UNIX, SOCK_STREAM, 0, fds), 0, NULL);
+
+	SendQueue *queue = send_queue_create (64, 0, SEND_QUEUE_OVERFLOW_EVENT);
+	test_check_ptr (queue);
+
+	char header[8] = "header-";
+	char data[40] = { 0 };
+	(void) memset (data, 'a', sizeof (data));
+
+	struct iovec iov[2] = {
+		{ .iov_base = header, .iov_len = sizeof (header) },
+		{ .iov_base = data, .iov_len = sizeof (data) }
+	};
+
+	bool high_water = false;
+
+	// both pieces are queued together
+	test_check_unsigned_eq (send_queue_append (queue, iov, 2, &high_water), 0, NULL);
+	test_check_false (high_water);
+	test_check_unsigned_eq (send_queue_pending (queue), 48, NULL);
+
+	test_check_unsigned_eq (send_queue_flush (queue, fds[0], 0), SEND_QUEUE_FLUSH_DONE, NULL);
+	test_check_unsigned_eq (send_queue_pending (queue), 0, NULL);
+	test_check_unsigned_eq (queue->stats.n_writes, 1, NULL);
+
+	char received[128] = { 0 };
+	test_check_int_eq ((int) recv (fds[1], received, sizeof (received), 0), 48, NULL);
+	test_check_int_eq (memcmp (received, header, sizeof (header)), 0, NULL);
+	test_check_int_eq (memcmp (received + sizeof (header), data, sizeof (data)), 0, NULL);
+
+	// the next append wraps around the end of the buffer
+	(void) memset (data, 'b', sizeof (data));
+	test_check_unsigned_eq (send_queue_append (queue, iov, 2, &high_water), 0, NULL);
+	test_check_unsigned_eq (queue->size, 64, NULL);
+
+	// and then the buffer grows keeping the pending data in order
+	test_check_unsigned_eq (send_queue_append (queue, iov, 2, &high_water), 0, NULL);
+	test_check_unsigned_eq (queue->size, 128, NULL);
+	test_check_unsigned_eq (send_queue_pending (queue), 96, NULL);
+	test_check_unsigned_eq (queue->stats.n_packets, 3, NULL);
+	test_check_unsigned_eq (queue->stats.max_pending, 96, NULL);
+
+	test_check_unsigned_eq (send_queue_flush (queue, fds[0], 0), SEND_QUEUE_FLUSH_DONE, NULL);
+	test_check_int_eq ((int) recv (fds[1], received, sizeof (received), 0), 96, NULL);
+	test_check_int_eq (memcmp (received + 48 + sizeof (header), data, sizeof (data)), 0, NULL);
+
+	send_queue_delete (queue);
+
+	(void) close (fds[0]);
+	(void) close (fds[1]);
+
+}
+
+static void test_send_queue_high_water (void) {
+
+	char data[64] = { 0 };
+	struct iovec iov = { .iov_base = data, .iov_len = sizeof (data) };
+
+	bool high_water = false;
+
+	// the data is kept but the event is only reported once
+	SendQueue *queue = send_queue_create (64, 100, SEND_QUEUE_OVERFLOW_EVENT);
+	test_check_ptr (queue);
+
+	test_check_unsigned_eq (send_queue_append (queue, &iov, 1, &high_water), 0, NULL);
+	test_check_false (high_water);
+
+	test_check_unsigned_eq (send_queue_append (queue, &iov, 1, &high_water), 0, NULL);
+	test_check_true (high_water);
+	test_check_true (queue->overflowed);
+
+	test_check_unsigned_eq (send_queue_append (queue, &iov, 1, &high_water), 0, NULL);
+	test_check_false (high_water);
+	test_check_unsigned_eq (queue->stats.n_overflows, 1, NULL);
+	test_check_unsigned_eq (send_queue_pending (queue), 192, NULL);
+
+	send_queue_delete (queue);
+
+	// the data is discarded & the queue stops taking more data
+	queue = send_queue_create (64, 100, SEND_QUEUE_OVERFLOW_DROP);
+	test_check_ptr (queue);
+
+	test_check_unsigned_eq (send_queue_append (queue, &iov, 1, &high_water), 0, NULL);
+	test_check_unsigned_eq (send_queue_append (queue, &iov, 1, &high_water), 1, NULL);
+	test_check_true (high_water);
+	test_check_true (queue->closed);
+	test_check_unsigned_eq (send_queue_pending (queue), 0, NULL);
+
+	test_check_unsigned_eq (send_queue_append (queue, &iov, 1, &high_water), 1, NULL);
+	test_check_false (high_water);
+
+	send_queue_reset (queue);
+	test_check_false (queue->closed);
+	test_check_unsigned_eq (send_queue_append (queue, &iov, 1, &high_water), 0, NULL);
+
+	send_queue_delete (queue);
+
+}
+
+static void test_send_queue_flush_pending (void) {
+
+	int fds[2] = { 0 };
+	test_check_int_eq (socketpair (AF_UNIX, SOCK_STREAM, 0, fds), 0, NULL);
+
+	int sndbuf = 4096;
+	(void) setsockopt (fds[0], SOL_SOCKET, SO_SNDBUF, &sndbuf, sizeof (int));
+
+	SendQueue *queue = send_queue_create (4096, 0, SEND_QUEUE_OVERFLOW_EVENT);
+	test_check_ptr (queue);
+
+	char data[4096] = { 0 };
+	struct iovec iov = { .iov_base = data, .iov_len = sizeof (data) };
+
+	bool high_water = false;
+	for (unsigned int i = 0; i < 256; i++)
+		(void) send_queue_append (queue, &iov, 1, &high_water);
+
+	// nobody is reading from the other end, so the socket gets full
+	test_check_unsigned_eq (send_queue_flush (queue, fds[0], 0), SEND_QUEUE_FLUSH_PENDING, NULL);
+	test_check_bool_eq ((send_queue_pending (queue) > 0), true, NULL);
+
+	(void) close (fds[1]);
+
+	test_check_unsigned_eq (send_queue_flush (queue, fds[0], 0), SEND_QUEUE_FLUSH_FAILED, NULL);
+
+	send_queue_delete (queue);
+
+	(void) close (fds[0]);
+
+}
+
+static void test_send_queue_begin_complete (void) {
+
+	SendQueue *queue = send_queue_create (64, 0, SEND_QUEUE_OVERFLOW_EVENT);
+	test_check_ptr (queue);
+
+	char data[40] = { 0 };
+	(void) memset (data, 'a', sizeof (data));
+	struct iovec data_iov = { .iov_base = data, .iov_len = sizeof (data) };
+
+	bool high_water = false;
+	struct iovec iov[2];
+
+	test_check_int_eq (send_queue_begin (queue, iov), 0, NULL);
+
+	test_check_unsigned_eq (send_queue_append (queue, &data_iov, 1, &high_water), 0, NULL);
+	test_check_int_eq (send_queue_begin (queue, iov), 1, NULL);
+	test_check_true (queue->in_flight);
+	test_check_unsigned_eq (iov[0].iov_len, 40, NULL);
+
+	// only one send can be in flight & the queue can't be flushed meanwhile
+	test_check_int_eq (send_queue_begin (queue, iov), 0, NULL);
+	test_check_unsigned_eq (send_queue_flush (queue, -1, 0), SEND_QUEUE_FLUSH_PENDING, NULL);
+
+	// the buffer grows while the send is in flight
+	test_check_unsigned_eq (send_queue_append (queue, &data_iov, 1, &high_water), 0, NULL);
+	test_check_unsigned_eq (queue->size, 128, NULL);
+	test_check_ptr (queue->retired);
+
+	// a short send keeps the rest of the bytes
+	send_queue_complete (queue, 30);
+	test_check_false (queue->in_flight);
+	test_check_null_ptr (queue->retired);
+	test_check_unsigned_eq (send_queue_pending (queue), 50, NULL);
+
+	test_check_int_eq (send_queue_begin (queue, iov), 1, NULL);
+	test_check_unsigned_eq (iov[0].iov_len, 50, NULL);
+	test_check_int_eq (memcmp (iov[0].iov_base, data, 10), 0, NULL);
+
+	send_queue_complete (queue, 50);
+	test_check_unsigned_eq (send_queue_pending (queue), 0, NULL);
+	test_check_unsigned_eq (queue->stats.n_writes, 2, NULL);
+	test_check_unsigned_eq (queue->stats.bytes_written, 80, NULL);
+
+	send_queue_delete (queue);
+
+}
+
+int main (int argc, char **argv) {
+
+	(void) printf ("Testing SEND QUEUE...\n");
+
+	test_send_queue_overflow_to_string ();
+
+	test_send_queue_create ();
+
+	test_send_queue_append ();
+
+	test_send_queue_high_water ();
+
+	test_send_queue_flush_pending ();
+
+	test_send_queue_begin_complete ();
+
+	(void) printf ("\nDone with SEND QUEUE tests!\n\n");
+
+	return 0;
+
+}
\ No newline at end of file
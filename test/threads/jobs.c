@@ -2,6 +2,8 @@
 #include <stdio.h>
 #include <stdbool.h>
 
+#include <pthread.h>
+
 #include <cerver/threads/jobs.h>
 
 #include "../test.h"
@@ -145,6 +147,7 @@ static void test_job_queue_new (void) {
 	test_check_int_eq (job_queue->type, JOB_QUEUE_TYPE_NONE, NULL);
 	test_check_null_ptr (job_queue->pool);
 	test_check_null_ptr (job_queue->queue);
+	test_check_null_ptr (job_queue->ring);
 	test_check_null_ptr (job_queue->rwmutex);
 	test_check_null_ptr (job_queue->has_jobs);
 	test_check_bool_eq (job_queue->waiting, false, NULL);
@@ -215,6 +218,232 @@ static void test_job_queue_set_handler (void) {
 
 }
 
+static void test_job_queue_create_ring (void) {
+
+	JobQueue *job_queue = job_queue_create (JOB_QUEUE_TYPE_RING);
+
+	test_check_ptr (job_queue);
+	test_check_int_eq (job_queue->type, JOB_QUEUE_TYPE_RING, NULL);
+	test_check_ptr (job_queue->pool);
+	test_check_null_ptr (job_queue->queue);
+	test_check_ptr (job_queue->ring);
+	test_check_unsigned_eq (job_queue->ring->mask, JOB_QUEUE_RING_CAPACITY - 1, NULL);
+	test_check_null_ptr (job_queue->rwmutex);
+	test_check_null_ptr (job_queue->has_jobs);
+	test_check_bool_eq (job_queue->running, false, NULL);
+	test_check_null_ptr (job_queue->handler);
+
+	job_queue_delete (job_queue);
+
+}
+
+static void test_job_queue_ring_push_pull (void) {
+
+	unsigned int values[8] = { 0, 1, 2, 3, 4, 5, 6, 7 };
+
+	// rounded up to 8
+	JobQueue *job_queue = job_queue_create_with_capacity (JOB_QUEUE_TYPE_RING, 5);
+
+	test_check_ptr (job_queue);
+	test_check_unsigned_eq (job_queue->ring->mask, 7, NULL);
+
+	// fill the ring twice to check that cells are reused
+	Job *job = NULL;
+	for (unsigned int lap = 0; lap < 2; lap++) {
+		for (unsigned int i = 0; i < 8; i++) {
+			test_check_unsigned_eq (
+				job_queue_push_job (job_queue, work_method, &values[i]), 0, NULL
+			);
+		}
+
+		test_check_unsigned_eq (job_queue_size (job_queue), 8, NULL);
+
+		// the ring is full
+		test_check_unsigned_eq (
+			job_queue_push_job (job_queue, work_method, &values[0]), 1, NULL
+		);
+
+		for (unsigned int i = 0; i < 8; i++) {
+			job = (Job *) job_queue_pull (job_queue);
+			test_check_ptr (job);
+			test_check_ptr_eq (job->args, &values[i]);
+			job_return (job_queue, job);
+		}
+
+		test_check_null_ptr (job_queue_pull (job_queue));
+		test_check_unsigned_eq (job_queue_size (job_queue), 0, NULL);
+	}
+
+	// requests by id are not supported
+	test_check_unsigned_eq (
+		job_queue_push_job_with_id (job_queue, 1, work_method, &values[0]), 1, NULL
+	);
+
+	test_check_null_ptr (job_queue_request (job_queue, 1));
+
+	// remaining jobs are deleted with the queue
+	test_check_unsigned_eq (
+		job_queue_push_job (job_queue, work_method, &values[0]), 0, NULL
+	);
+
+	job_queue_delete (job_queue);
+
+}
+
+static void test_job_queue_batch_type (const JobQueueType type) {
+
+	unsigned int values[8] = { 0, 1, 2, 3, 4, 5, 6, 7 };
+	void *jobs[8] = { 0 };
+
+	JobQueue *job_queue = job_queue_create_with_capacity (type, 4);
+
+	test_check_ptr (job_queue);
+
+	for (unsigned int i = 0; i < 8; i++)
+		jobs[i] = job_create (work_method, &values[i]);
+
+	// a ring only takes the jobs that fit in it
+	unsigned int pushed = job_queue_push_batch (job_queue, jobs, 8);
+	if (type == JOB_QUEUE_TYPE_RING) {
+		test_check_unsigned_eq (pushed, 4, NULL);
+		for (unsigned int i = pushed; i < 8; i++) job_delete (jobs[i]);
+	}
+
+	else {
+		test_check_unsigned_eq (pushed, 8, NULL);
+	}
+
+	test_check_unsigned_eq (job_queue_size (job_queue), pushed, NULL);
+
+	void *pulled[8] = { 0 };
+
+	// jobs come out in the same order they were pushed
+	test_check_unsigned_eq (job_queue_pull_batch (job_queue, pulled, 3), 3, NULL);
+	unsigned int n_pulled = job_queue_pull_batch (job_queue, &pulled[3], 5);
+	test_check_unsigned_eq (n_pulled, pushed - 3, NULL);
+
+	for (unsigned int i = 0; i < pushed; i++) {
+		test_check_ptr_eq (((Job *) pulled[i])->args, &values[i]);
+		job_delete (pulled[i]);
+	}
+
+	test_check_unsigned_eq (job_queue_pull_batch (job_queue, pulled, 8), 0, NULL);
+	test_check_unsigned_eq (job_queue_push_batch (job_queue, NULL, 8), 0, NULL);
+
+	job_queue_delete (job_queue);
+
+}
+
+static void test_job_queue_push_existing_job (void) {
+
+	unsigned int value = 0;
+
+	JobQueue *job_queue = job_queue_create (JOB_QUEUE_TYPE_JOBS);
+
+	test_check_ptr (job_queue);
+
+	Job *job = job_create (work_method, &value);
+	test_check_unsigned_eq (job_queue_push_existing_job (job_queue, job), 0, NULL);
+	test_check_unsigned_eq (job_queue_push_existing_job (job_queue, NULL), 1, NULL);
+	test_check_unsigned_eq (job_queue_push_existing_job (NULL, job), 1, NULL);
+	test_check_unsigned_eq (job_queue_size (job_queue), 1, NULL);
+
+	test_check_ptr_eq (job_queue_pull (job_queue), job);
+	job_delete (job);
+
+	job_queue_delete (job_queue);
+
+}
+
+static void test_job_queue_batch (void) {
+
+	test_job_queue_batch_type (JOB_QUEUE_TYPE_JOBS);
+	test_job_queue_batch_type (JOB_QUEUE_TYPE_RING);
+
+}
+
+#define RING_PRODUCERS			4
+#define RING_CONSUMERS			4
+#define RING_JOBS				10000
+
+static unsigned int ring_consumed = 0;
+static unsigned long ring_sum = 0;
+
+static void ring_work (void *args) {
+
+	(void) __atomic_add_fetch (&ring_sum, (unsigned long) (size_t) args, __ATOMIC_RELAXED);
+	(void) __atomic_add_fetch (&ring_consumed, 1, __ATOMIC_RELAXED);
+
+}
+
+static void *ring_producer (void *job_queue_ptr) {
+
+	JobQueue *job_queue = (JobQueue *) job_queue_ptr;
+
+	for (size_t i = 1; i <= RING_JOBS; i++) {
+		while (job_queue_push (job_queue, job_create (ring_work, (void *) i)));
+	}
+
+	return NULL;
+
+}
+
+static void *ring_consumer (void *job_queue_ptr) {
+
+	JobQueue *job_queue = (JobQueue *) job_queue_ptr;
+
+	Job *job = NULL;
+	while (job_queue->running) {
+		job_queue_wait (job_queue);
+
+		while ((job = (Job *) job_queue_pull (job_queue))) {
+			job->work (job->args);
+			job_delete (job);
+		}
+	}
+
+	return NULL;
+
+}
+
+static void test_job_queue_ring_threads (void) {
+
+	JobQueue *job_queue = job_queue_create_with_capacity (JOB_QUEUE_TYPE_RING, 64);
+	job_queue->running = true;
+
+	pthread_t consumers[RING_CONSUMERS] = { 0 };
+	for (unsigned int i = 0; i < RING_CONSUMERS; i++)
+		(void) pthread_create (&consumers[i], NULL, ring_consumer, job_queue);
+
+	pthread_t producers[RING_PRODUCERS] = { 0 };
+	for (unsigned int i = 0; i < RING_PRODUCERS; i++)
+		(void) pthread_create (&producers[i], NULL, ring_producer, job_queue);
+
+	for (unsigned int i = 0; i < RING_PRODUCERS; i++)
+		(void) pthread_join (producers[i], NULL);
+
+	while (__atomic_load_n (&ring_consumed, __ATOMIC_RELAXED) < (RING_PRODUCERS * RING_JOBS));
+
+	// wake up parked consumers so they can end
+	job_queue->running = false;
+	job_queue_signal_all (job_queue);
+	for (unsigned int i = 0; i < RING_CONSUMERS; i++) {
+		job_queue_signal_all (job_queue);
+		(void) pthread_join (consumers[i], NULL);
+	}
+
+	test_check_unsigned_eq (ring_consumed, RING_PRODUCERS * RING_JOBS, NULL);
+	test_check_bool_eq (
+		(ring_sum == (unsigned long) RING_PRODUCERS * ((RING_JOBS * (RING_JOBS + 1)) / 2)),
+		true, NULL
+	);
+
+	test_check_unsigned_eq (job_queue_size (job_queue), 0, NULL);
+
+	job_queue_delete (job_queue);
+
+}
+
 void threads_tests_jobs (void) {
 
 	(void) printf ("Testing THREADS jobs...\n");
@@ -234,6 +463,11 @@ void threads_tests_jobs (void) {
 	test_job_queue_create_jobs ();
 	test_job_queue_create_handlers ();
 	test_job_queue_set_handler ();
+	test_job_queue_create_ring ();
+	test_job_queue_ring_push_pull ();
+	test_job_queue_ring_threads ();
+	test_job_queue_batch ();
+	test_job_queue_push_existing_job ();
 
 	(void) printf ("Done!\n");
 
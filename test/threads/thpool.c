@@ -148,6 +148,78 @@ static void test_thpool_add_work (void) {
 
 }
 
+#define THPOOL_WS_JOBS			64
+#define THPOOL_WS_CHILDREN		16
+
+static Thpool *ws_thpool = NULL;
+static unsigned int ws_executed = 0;
+
+static void ws_child_method (void *args) {
+
+	(void) __atomic_add_fetch (&ws_executed, 1, __ATOMIC_RELAXED);
+
+}
+
+// jobs added from inside the thpool go to the thread's deque
+static void ws_parent_method (void *args) {
+
+	for (unsigned int i = 0; i < THPOOL_WS_CHILDREN; i++)
+		(void) thpool_add_work (ws_thpool, ws_child_method, NULL);
+
+	(void) __atomic_add_fetch (&ws_executed, 1, __ATOMIC_RELAXED);
+
+}
+
+static void test_thpool_work_stealing (void) {
+
+	ws_thpool = test_thpool_create ();
+
+	thpool_set_work_stealing (ws_thpool, true);
+	test_check_bool_eq (ws_thpool->work_stealing, true, NULL);
+	test_check_int_eq (ws_thpool->job_queue->type, JOB_QUEUE_TYPE_RING, NULL);
+
+	unsigned int result = thpool_init (ws_thpool);
+	test_check_unsigned_eq (result, 0, NULL);
+	test_check_unsigned_eq (ws_thpool->num_threads_alive, THPOOL_N_THREADS, NULL);
+
+	for (unsigned int i = 0; i < THPOOL_WS_JOBS; i++) {
+		test_check_int_eq (
+			thpool_add_work (ws_thpool, ws_parent_method, NULL), 0, NULL
+		);
+	}
+
+	thpool_wait (ws_thpool);
+
+	test_check_unsigned_eq (
+		ws_executed, THPOOL_WS_JOBS * (THPOOL_WS_CHILDREN + 1), NULL
+	);
+
+	test_check_unsigned_eq (ws_thpool->num_jobs_pending, 0, NULL);
+
+	// every job was executed by exactly one thread
+	ThpoolThreadStats stats = { 0 };
+	u64 executed = 0;
+	u64 stolen = 0;
+	for (unsigned int i = 0; i < THPOOL_N_THREADS; i++) {
+		test_check_unsigned_eq (
+			thpool_get_thread_stats (ws_thpool, i, &stats), 0, NULL
+		);
+
+		executed += stats.executed;
+		stolen += stats.stolen;
+	}
+
+	test_check_unsigned_eq (executed, THPOOL_WS_JOBS * (THPOOL_WS_CHILDREN + 1), NULL);
+	test_check_bool_eq ((stolen <= executed), true, NULL);
+
+	test_check_unsigned_eq (
+		thpool_get_thread_stats (ws_thpool, THPOOL_N_THREADS, &stats), 1, NULL
+	);
+
+	thpool_destroy (ws_thpool);
+
+}
+
 void threads_tests_thpool (void) {
 
 	(void) printf ("Testing THREADS thpool...\n");
@@ -156,6 +228,7 @@ void threads_tests_thpool (void) {
 	test_thpool_is_empty ();
 	test_thpool_init ();
 	test_thpool_add_work ();
+	test_thpool_work_stealing ();
 
 	(void) printf ("Done!\n");
 
@@ -1,7 +1,10 @@
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 #include <stdbool.h>
 
+#include <sched.h>
+
 #include <cerver/threads/thread.h>
 
 #include "threads.h"
@@ -81,6 +84,118 @@ static void test_threads_cond (void) {
 
 }
 
+static void test_threads_affinity_types (void) {
+
+	test_check_str_eq (thread_affinity_type_to_string (THREAD_AFFINITY_NONE), "None", NULL);
+	test_check_str_eq (thread_affinity_type_to_string (THREAD_AFFINITY_CPUS), "Cpus", NULL);
+	test_check_str_eq (thread_affinity_type_to_string (THREAD_AFFINITY_SPREAD), "Spread", NULL);
+	test_check_str_eq (thread_affinity_type_to_string (THREAD_AFFINITY_COMPACT), "Compact", NULL);
+
+	ThreadAffinity affinity;
+	thread_affinity_init (&affinity, THREAD_AFFINITY_NONE);
+	test_check_int_eq (thread_affinity_get_cpu (&affinity, 0), -1, NULL);
+	test_check_unsigned_eq (thread_affinity_apply (&affinity, 0, "test"), 0, NULL);
+
+	thread_affinity_init (&affinity, THREAD_AFFINITY_CPUS);
+	thread_affinity_add_cpu (&affinity, 0);
+	thread_affinity_add_cpu (&affinity, -1);
+	thread_affinity_add_cpu (&affinity, THREAD_AFFINITY_MAX_CPUS);
+	test_check_int_eq (CPU_COUNT (&affinity.cpus), 1, NULL);
+	test_check_int_eq (thread_affinity_get_cpu (&affinity, 0), -1, NULL);
+
+}
+
+static void test_threads_affinity_cpus (void) {
+
+	cpu_set_t allowed;
+	CPU_ZERO (&allowed);
+	test_check_int_eq (sched_getaffinity (0, sizeof (cpu_set_t), &allowed), 0, NULL);
+
+	const unsigned int n_cpus = (unsigned int) CPU_COUNT (&allowed);
+
+	ThreadAffinity spread;
+	thread_affinity_init (&spread, THREAD_AFFINITY_SPREAD);
+
+	ThreadAffinity compact;
+	thread_affinity_init (&compact, THREAD_AFFINITY_COMPACT);
+
+	// every allowed cpu is used once before they wrap around
+	cpu_set_t spread_cpus;
+	CPU_ZERO (&spread_cpus);
+	cpu_set_t compact_cpus;
+	CPU_ZERO (&compact_cpus);
+	for (unsigned int idx = 0; idx < n_cpus; idx++) {
+		int cpu = thread_affinity_get_cpu (&spread, idx);
+		test_check_bool_eq (CPU_ISSET ((size_t) cpu, &allowed), true, NULL);
+		CPU_SET ((size_t) cpu, &spread_cpus);
+
+		cpu = thread_affinity_get_cpu (&compact, idx);
+		test_check_bool_eq (CPU_ISSET ((size_t) cpu, &allowed), true, NULL);
+		CPU_SET ((size_t) cpu, &compact_cpus);
+	}
+
+	test_check_bool_eq (CPU_EQUAL (&spread_cpus, &allowed), true, NULL);
+	test_check_bool_eq (CPU_EQUAL (&compact_cpus, &allowed), true, NULL);
+
+	test_check_int_eq (
+		thread_affinity_get_cpu (&compact, n_cpus),
+		thread_affinity_get_cpu (&compact, 0),
+		NULL
+	);
+
+	// the offset moves the group to the next cpus
+	compact.offset = 1;
+	test_check_int_eq (
+		thread_affinity_get_cpu (&compact, 0),
+		thread_affinity_get_cpu (&compact, n_cpus),
+		NULL
+	);
+
+	compact.offset = 0;
+
+	ThreadAffinity resolved;
+	thread_affinity_resolve (&resolved, &compact, 0);
+	test_check_unsigned_eq (resolved.type, THREAD_AFFINITY_CPUS, NULL);
+	test_check_int_eq (CPU_COUNT (&resolved.cpus), 1, NULL);
+	test_check_bool_eq (
+		CPU_ISSET ((size_t) thread_affinity_get_cpu (&compact, 0), &resolved.cpus),
+		true, NULL
+	);
+
+}
+
+static void *test_thread_affinity (void *affinity_ptr) {
+
+	ThreadAffinity *affinity = (ThreadAffinity *) affinity_ptr;
+
+	test_check_unsigned_eq (thread_affinity_apply (affinity, 0, "test"), 0, NULL);
+
+	cpu_set_t cpus;
+	CPU_ZERO (&cpus);
+	test_check_int_eq (pthread_getaffinity_np (pthread_self (), sizeof (cpu_set_t), &cpus), 0, NULL);
+	test_check_bool_eq (CPU_EQUAL (&cpus, &affinity->cpus), true, NULL);
+
+	test_check_bool_eq (CPU_ISSET ((size_t) sched_getcpu (), &cpus), true, NULL);
+
+	return NULL;
+
+}
+
+static void test_threads_affinity_apply (void) {
+
+	ThreadAffinity compact;
+	thread_affinity_init (&compact, THREAD_AFFINITY_COMPACT);
+
+	ThreadAffinity affinity;
+	thread_affinity_resolve (&affinity, &compact, 0);
+
+	// only the new thread gets pinned
+	pthread_t thread_id = 0;
+	test_check_int_eq (pthread_create (&thread_id, NULL, test_thread_affinity, &affinity), 0, NULL);
+	test_check_int_eq (pthread_join (thread_id, NULL), 0, NULL);
+
+}
+
 static void threads_tests_main (void) {
 
 	(void) printf ("Testing THREADS main...\n");
@@ -88,6 +203,9 @@ static void threads_tests_main (void) {
 	test_threads_detachable ();
 	test_threads_mutex ();
 	test_threads_cond ();
+	test_threads_affinity_types ();
+	test_threads_affinity_cpus ();
+	test_threads_affinity_apply ();
 
 	(void) printf ("Done!\n");
 
@@ -105,6 +223,8 @@ int main (int argc, char **argv) {
 
 	threads_tests_thpool ();
 
+	threads_tests_wheel ();
+
 	threads_tests_worker ();
 
 	(void) printf ("\nDone with THREADS tests!\n\n");
@@ -7,6 +7,8 @@ extern void threads_tests_jobs (void);
 
 extern void threads_tests_thpool (void);
 
+extern void threads_tests_wheel (void);
+
 extern void threads_tests_worker (void);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,256 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+
+#include <unistd.h>
+#include <poll.h>
+
+#include <cerver/threads/wheel.h>
+
+#include "../test.h"
+
+#define WHEEL_NAME				"test-wheel"
+
+#define WHEEL_MS				1000000
+
+typedef struct WheelTest {
+
+	TimerWheel *wheel;
+	WheelTimer *timer;
+
+	unsigned int count;
+	unsigned int max_count;
+
+	unsigned int order[4];
+	unsigned int n_order;
+
+} WheelTest;
+
+static WheelTest wheel_test = { 0 };
+
+static void wheel_test_count (void *args) {
+
+	(void) __atomic_add_fetch (&wheel_test.count, 1, __ATOMIC_RELAXED);
+
+}
+
+static void wheel_test_cancel_self (void *args) {
+
+	if (__atomic_add_fetch (&wheel_test.count, 1, __ATOMIC_RELAXED) == wheel_test.max_count)
+		timer_wheel_cancel (wheel_test.wheel, wheel_test.timer);
+
+}
+
+static void wheel_test_order (void *args) {
+
+	wheel_test.order[wheel_test.n_order] = *(unsigned int *) args;
+	wheel_test.n_order += 1;
+
+}
+
+static TimerWheel *test_timer_wheel_create (void) {
+
+	TimerWheel *wheel = timer_wheel_create ();
+
+	test_check_ptr (wheel);
+
+	test_check_int_ne (wheel->timer_fd, -1);
+	test_check_bool_eq (wheel->running, false, NULL);
+	test_check_unsigned_eq (wheel->current, 0, NULL);
+	test_check_unsigned_eq (wheel->n_timers, 0, NULL);
+
+	test_check_ptr (wheel->mutex);
+	test_check_ptr (wheel->done);
+
+	return wheel;
+
+}
+
+static void test_timer_wheel_set_name (void) {
+
+	TimerWheel *wheel = test_timer_wheel_create ();
+
+	timer_wheel_set_name (wheel, WHEEL_NAME);
+
+	test_check_str_eq (wheel->name, WHEEL_NAME, NULL);
+	test_check_unsigned_eq (wheel->name_len, strlen (WHEEL_NAME), NULL);
+
+	timer_wheel_delete (wheel);
+
+}
+
+static void test_timer_wheel_levels (void) {
+
+	TimerWheel *wheel = test_timer_wheel_create ();
+
+	// 10 ms, 1 sec, 1 min & 10 hours
+	WheelTimer *near = timer_wheel_add (wheel, 10 * (u64) WHEEL_MS, 0, wheel_test_count, NULL);
+	WheelTimer *second = timer_wheel_add (wheel, 1000 * (u64) WHEEL_MS, 0, wheel_test_count, NULL);
+	WheelTimer *minute = timer_wheel_add (wheel, 60000 * (u64) WHEEL_MS, 0, wheel_test_count, NULL);
+	WheelTimer *far = timer_wheel_add (wheel, 36000000 * (u64) WHEEL_MS, 0, wheel_test_count, NULL);
+
+	test_check_unsigned_eq (timer_wheel_size (wheel), 4, NULL);
+
+	test_check_unsigned_eq (near->level, 0, NULL);
+	test_check_unsigned_eq (second->level, 1, NULL);
+	test_check_unsigned_eq (minute->level, 2, NULL);
+	test_check_unsigned_eq (far->level, 3, NULL);
+
+	test_check_unsigned_eq (near->state, WHEEL_TIMER_STATE_WAITING, NULL);
+
+	timer_wheel_cancel (wheel, second);
+	test_check_unsigned_eq (timer_wheel_size (wheel), 3, NULL);
+
+	// the remaining timers are deleted with the wheel
+	timer_wheel_delete (wheel);
+
+}
+
+static void test_timer_wheel_one_shot (void) {
+
+	TimerWheel *wheel = test_timer_wheel_create ();
+	wheel_test.count = 0;
+
+	(void) timer_wheel_add (wheel, 20 * (u64) WHEEL_MS, 0, wheel_test_count, NULL);
+
+	test_check_unsigned_eq (timer_wheel_start (wheel), 0, NULL);
+	test_check_unsigned_eq (timer_wheel_start (wheel), 1, NULL);
+
+	(void) usleep (100000);
+
+	test_check_unsigned_eq (__atomic_load_n (&wheel_test.count, __ATOMIC_RELAXED), 1, NULL);
+	test_check_unsigned_eq (timer_wheel_size (wheel), 0, NULL);
+
+	timer_wheel_delete (wheel);
+
+}
+
+static void test_timer_wheel_periodic (void) {
+
+	TimerWheel *wheel = test_timer_wheel_create ();
+	wheel_test.count = 0;
+
+	test_check_unsigned_eq (timer_wheel_start (wheel), 0, NULL);
+
+	WheelTimer *timer = timer_wheel_add (
+		wheel, 10 * (u64) WHEEL_MS, 10 * (u64) WHEEL_MS, wheel_test_count, NULL
+	);
+
+	(void) usleep (205000);
+
+	timer_wheel_cancel (wheel, timer);
+
+	// deadlines are kept in phase, so there are no missed runs
+	unsigned int count = __atomic_load_n (&wheel_test.count, __ATOMIC_RELAXED);
+	test_check_bool_eq ((count >= 18) && (count <= 21), true, NULL);
+
+	test_check_unsigned_eq (timer_wheel_size (wheel), 0, NULL);
+
+	timer_wheel_stop (wheel);
+	test_check_bool_eq (wheel->running, false, NULL);
+
+	timer_wheel_delete (wheel);
+
+}
+
+static void test_timer_wheel_cancel_self (void) {
+
+	TimerWheel *wheel = test_timer_wheel_create ();
+
+	wheel_test.wheel = wheel;
+	wheel_test.count = 0;
+	wheel_test.max_count = 3;
+
+	wheel_test.timer = timer_wheel_add (
+		wheel, 5 * (u64) WHEEL_MS, 5 * (u64) WHEEL_MS, wheel_test_cancel_self, NULL
+	);
+
+	test_check_unsigned_eq (timer_wheel_start (wheel), 0, NULL);
+
+	(void) usleep (100000);
+
+	test_check_unsigned_eq (__atomic_load_n (&wheel_test.count, __ATOMIC_RELAXED), 3, NULL);
+	test_check_unsigned_eq (timer_wheel_size (wheel), 0, NULL);
+
+	timer_wheel_delete (wheel);
+
+}
+
+static void test_timer_wheel_order (void) {
+
+	TimerWheel *wheel = test_timer_wheel_create ();
+	wheel_test.n_order = 0;
+
+	unsigned int ids[4] = { 0, 1, 2, 3 };
+
+	// spread between different levels
+	(void) timer_wheel_add (wheel, 150 * (u64) WHEEL_MS, 0, wheel_test_order, &ids[3]);
+	(void) timer_wheel_add (wheel, 3 * (u64) WHEEL_MS, 0, wheel_test_order, &ids[0]);
+	(void) timer_wheel_add (wheel, 70 * (u64) WHEEL_MS, 0, wheel_test_order, &ids[2]);
+	(void) timer_wheel_add (wheel, 30 * (u64) WHEEL_MS, 0, wheel_test_order, &ids[1]);
+
+	test_check_unsigned_eq (timer_wheel_start (wheel), 0, NULL);
+
+	(void) usleep (250000);
+
+	timer_wheel_stop (wheel);
+
+	test_check_unsigned_eq (wheel_test.n_order, 4, NULL);
+	for (unsigned int i = 0; i < 4; i++)
+		test_check_unsigned_eq (wheel_test.order[i], i, NULL);
+
+	timer_wheel_delete (wheel);
+
+}
+
+static void test_timer_wheel_attach (void) {
+
+	TimerWheel *wheel = test_timer_wheel_create ();
+	wheel_test.count = 0;
+
+	(void) timer_wheel_add (wheel, 10 * (u64) WHEEL_MS, 0, wheel_test_count, NULL);
+	(void) timer_wheel_add (wheel, 20 * (u64) WHEEL_MS, 0, wheel_test_count, NULL);
+
+	// the calling thread drives the wheel
+	int timer_fd = timer_wheel_attach (wheel);
+	test_check_int_eq (timer_fd, wheel->timer_fd, NULL);
+	test_check_bool_eq (wheel->attached, true, NULL);
+	test_check_unsigned_eq (timer_wheel_start (wheel), 1, NULL);
+	test_check_int_eq (timer_wheel_attach (wheel), -1, NULL);
+
+	struct pollfd fds = { .fd = timer_fd, .events = POLLIN, .revents = 0 };
+	for (unsigned int i = 0; (i < 10) && timer_wheel_size (wheel); i++) {
+		if (poll (&fds, 1, 100) > 0) timer_wheel_handle (wheel);
+	}
+
+	test_check_unsigned_eq (wheel_test.count, 2, NULL);
+	test_check_unsigned_eq (timer_wheel_size (wheel), 0, NULL);
+
+	// nothing has expired, so there is nothing to read
+	timer_wheel_handle (wheel);
+	test_check_unsigned_eq (wheel_test.count, 2, NULL);
+
+	timer_wheel_stop (wheel);
+	test_check_bool_eq (wheel->running, false, NULL);
+	test_check_bool_eq (wheel->attached, false, NULL);
+
+	timer_wheel_delete (wheel);
+
+}
+
+void threads_tests_wheel (void) {
+
+	(void) printf ("Testing THREADS wheel...\n");
+
+	test_timer_wheel_set_name ();
+	test_timer_wheel_levels ();
+	test_timer_wheel_one_shot ();
+	test_timer_wheel_periodic ();
+	test_timer_wheel_cancel_self ();
+	test_timer_wheel_order ();
+	test_timer_wheel_attach ();
+
+	(void) printf ("Done!\n");
+
+}